@@ -12,14 +12,60 @@
 
 #include <string.h>
 
+#include <memory>
+#include <vector>
+
 #include "rtc_base/checks.h"
+#include "rtc_base/criticalsection.h"
 #include "rtc_base/timeutils.h"
 
 namespace webrtc {
+namespace {
+
+// Free buffers beyond this many are deleted, so that a burst of frames does
+// not hold memory for good.
+constexpr size_t kMaxPooledBuffers = 64;
+
+// The buffers of kMaxDataSizeSamples samples that frames take their samples
+// from. Frames on any thread share it.
+class BufferPool {
+ public:
+  int16_t* Acquire() {
+    {
+      rtc::CritScope lock(&crit_);
+      if (!free_buffers_.empty()) {
+        int16_t* buffer = free_buffers_.back().release();
+        free_buffers_.pop_back();
+        return buffer;
+      }
+    }
+    return new int16_t[AudioFrame::kMaxDataSizeSamples];
+  }
+
+  void Release(int16_t* buffer) {
+    std::unique_ptr<int16_t[]> owned_buffer(buffer);
+    rtc::CritScope lock(&crit_);
+    if (free_buffers_.size() < kMaxPooledBuffers)
+      free_buffers_.push_back(std::move(owned_buffer));
+  }
+
+ private:
+  rtc::CriticalSection crit_;
+  std::vector<std::unique_ptr<int16_t[]>> free_buffers_ RTC_GUARDED_BY(crit_);
+};
+
+BufferPool* GetBufferPool() {
+  static BufferPool* const pool = new BufferPool();
+  return pool;
+}
+
+}  // namespace
 
-AudioFrame::AudioFrame() {
-  // Visual Studio doesn't like this in the class definition.
-  static_assert(sizeof(data_) == kMaxDataSizeBytes, "kMaxDataSizeBytes");
+AudioFrame::AudioFrame() = default;
+
+AudioFrame::~AudioFrame() {
+  if (data_)
+    GetBufferPool()->Release(data_);
 }
 
 void AudioFrame::Reset() {
@@ -58,7 +104,7 @@ void AudioFrame::UpdateFrame(uint32_t timestamp,
   const size_t length = samples_per_channel * num_channels;
   RTC_CHECK_LE(length, kMaxDataSizeSamples);
   if (data != nullptr) {
-    memcpy(data_, data, sizeof(int16_t) * length);
+    memcpy(buffer(), data, sizeof(int16_t) * length);
     muted_ = false;
   } else {
     muted_ = true;
@@ -82,7 +128,7 @@ void AudioFrame::CopyFrom(const AudioFrame& src) {
   const size_t length = samples_per_channel_ * num_channels_;
   RTC_CHECK_LE(length, kMaxDataSizeSamples);
   if (!src.muted()) {
-    memcpy(data_, src.data(), sizeof(int16_t) * length);
+    memcpy(buffer(), src.data(), sizeof(int16_t) * length);
     muted_ = false;
   }
 }
@@ -107,7 +153,7 @@ const int16_t* AudioFrame::data() const {
 // See https://bugs.chromium.org/p/webrtc/issues/detail?id=5647.
 int16_t* AudioFrame::mutable_data() {
   if (muted_) {
-    memset(data_, 0, kMaxDataSizeBytes);
+    memset(buffer(), 0, kMaxDataSizeBytes);
     muted_ = false;
   }
   return data_;
@@ -121,6 +167,20 @@ bool AudioFrame::muted() const {
   return muted_;
 }
 
+void AudioFrame::ReleaseBuffer() {
+  muted_ = true;
+  if (data_) {
+    GetBufferPool()->Release(data_);
+    data_ = nullptr;
+  }
+}
+
+int16_t* AudioFrame::buffer() {
+  if (!data_)
+    data_ = GetBufferPool()->Acquire();
+  return data_;
+}
+
 // static
 const int16_t* AudioFrame::empty_data() {
   static int16_t* null_data = new int16_t[kMaxDataSizeSamples]();
@@ -28,6 +28,9 @@ namespace webrtc {
  *   should be prepared for that.
  * - The total number of samples is samples_per_channel_ * num_channels_.
  * - Stereo data is interleaved starting with the left channel.
+ * - The samples are held in a buffer from a pool shared by all frames. A frame
+ *   takes a buffer when it first holds audio, so frames that are never
+ *   unmuted cost little memory.
  */
 class AudioFrame {
  public:
@@ -54,6 +57,7 @@ class AudioFrame {
   };
 
   AudioFrame();
+  ~AudioFrame();
 
   // Resets all members to their default state.
   void Reset();
@@ -95,6 +99,11 @@ class AudioFrame {
   // Frame is muted by default.
   bool muted() const;
 
+  // Mutes the frame and returns its buffer to the pool. For frames that are
+  // kept while not holding audio. Pointers from mutable_data() are invalid
+  // afterwards.
+  void ReleaseBuffer();
+
   // RTP timestamp of the first sample in the AudioFrame.
   uint32_t timestamp_ = 0;
   // Time since the first frame in milliseconds.
@@ -121,7 +130,11 @@ class AudioFrame {
   // buffer per translation unit is to wrap a static in an inline function.
   static const int16_t* empty_data();
 
-  int16_t data_[kMaxDataSizeSamples];
+  // Returns |data_|, taking a buffer from the pool if there is none.
+  int16_t* buffer();
+
+  // Holds kMaxDataSizeSamples samples, or is null.
+  int16_t* data_ = nullptr;
   bool muted_ = true;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(AudioFrame);
@@ -13,6 +13,7 @@
 
 #include <memory>
 
+#include "absl/types/optional.h"
 #include "api/audio/audio_frame.h"
 #include "rtc_base/refcount.h"
 
@@ -48,6 +49,22 @@ class AudioMixer : public rtc::RefCountInterface {
     // with this sample rate or higher will not cause quality loss.
     virtual int PreferredSampleRate() const = 0;
 
+    // The level of the audio that this source is about to deliver, in -dBov
+    // (0 is the loudest and 127 silence), e.g. as signaled in the RTP audio
+    // level header extension. Lets a mixer pick the sources to fetch audio
+    // from before any of it is decoded. Returns nullopt if unknown.
+    virtual absl::optional<int> IncomingAudioLevel() const {
+      return absl::nullopt;
+    }
+
+    // Called instead of GetAudioFrameWithInfo() when the next 10 ms of audio
+    // will not be mixed. Sources that decode audio should advance playout
+    // without decoding.
+    virtual void SkipAudioFrame(int sample_rate_hz) {
+      AudioFrame audio_frame;
+      GetAudioFrameWithInfo(sample_rate_hz, &audio_frame);
+    }
+
     virtual ~Source() {}
   };
 
@@ -59,6 +59,26 @@ TEST(AudioFrameTest, MutedFrameBufferIsZeroed) {
   EXPECT_TRUE(AllSamplesAre(0, frame));
 }
 
+TEST(AudioFrameTest, ReleaseBufferMutesFrame) {
+  AudioFrame frame;
+  int16_t* frame_data = frame.mutable_data();
+  for (size_t i = 0; i < AudioFrame::kMaxDataSizeSamples; i++) {
+    frame_data[i] = 17;
+  }
+  frame.ReleaseBuffer();
+  EXPECT_TRUE(frame.muted());
+  EXPECT_TRUE(AllSamplesAre(0, frame));
+
+  // The buffer is zeroed again when the frame is unmuted, even if it comes
+  // from another frame.
+  AudioFrame other_frame;
+  other_frame.mutable_data();
+  EXPECT_TRUE(AllSamplesAre(0, other_frame));
+  frame.mutable_data();
+  EXPECT_FALSE(frame.muted());
+  EXPECT_TRUE(AllSamplesAre(0, frame));
+}
+
 TEST(AudioFrameTest, UpdateFrame) {
   AudioFrame frame;
   int16_t samples[kNumChannels * kSamplesPerChannel] = {17};
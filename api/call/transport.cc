@@ -18,4 +18,20 @@ PacketOptions::PacketOptions(const PacketOptions&) = default;
 
 PacketOptions::~PacketOptions() = default;
 
+bool Transport::SendRtpFragments(
+    rtc::ArrayView<const rtc::ArrayView<const uint8_t>> fragments,
+    const PacketOptions& options) {
+  size_t length = 0;
+  for (const auto& fragment : fragments)
+    length += fragment.size();
+  if (!fragments.empty() && fragments[0].size() == length)
+    return SendRtp(fragments[0].data(), length, options);
+
+  std::vector<uint8_t> packet;
+  packet.reserve(length);
+  for (const auto& fragment : fragments)
+    packet.insert(packet.end(), fragment.begin(), fragment.end());
+  return SendRtp(packet.data(), packet.size(), options);
+}
+
 }  // namespace webrtc
@@ -15,6 +15,8 @@
 #include <stdint.h>
 #include <vector>
 
+#include "api/array_view.h"
+
 namespace webrtc {
 
 // TODO(holmer): Look into unifying this with the PacketOptions in
@@ -39,6 +41,13 @@ class Transport {
   virtual bool SendRtp(const uint8_t* packet,
                        size_t length,
                        const PacketOptions& options) = 0;
+  // Sends an RTP packet given as consecutive |fragments|, e.g. the header
+  // followed by a payload that is a slice of the encoded frame. Transports
+  // that can send or copy the fragments directly should override this; the
+  // default implementation gathers them and calls SendRtp().
+  virtual bool SendRtpFragments(
+      rtc::ArrayView<const rtc::ArrayView<const uint8_t>> fragments,
+      const PacketOptions& options);
   virtual bool SendRtcp(const uint8_t* packet, size_t length) = 0;
 
  protected:
@@ -46,9 +46,32 @@ I420Buffer::I420Buffer(int width,
       stride_y_(stride_y),
       stride_u_(stride_u),
       stride_v_(stride_v),
-      data_(static_cast<uint8_t*>(
-          AlignedMalloc(I420DataSize(height, stride_y, stride_u, stride_v),
-                        kBufferAlignment))) {
+      data_(static_cast<uint8_t*>(AlignedMalloc(
+                I420DataSize(height, stride_y, stride_u, stride_v),
+                kBufferAlignment)),
+            DataDeleter{&AlignedFree}) {
+  RTC_DCHECK_GT(width, 0);
+  RTC_DCHECK_GT(height, 0);
+  RTC_DCHECK_GE(stride_y, width);
+  RTC_DCHECK_GE(stride_u, (width + 1) / 2);
+  RTC_DCHECK_GE(stride_v, (width + 1) / 2);
+}
+
+I420Buffer::I420Buffer(int width,
+                       int height,
+                       int stride_y,
+                       int stride_u,
+                       int stride_v,
+                       uint8_t* data,
+                       void (*free_data)(void*))
+    : width_(width),
+      height_(height),
+      stride_y_(stride_y),
+      stride_u_(stride_u),
+      stride_v_(stride_v),
+      data_(data, DataDeleter{free_data}) {
+  RTC_DCHECK(data);
+  RTC_DCHECK(free_data);
   RTC_DCHECK_GT(width, 0);
   RTC_DCHECK_GT(height, 0);
   RTC_DCHECK_GE(stride_y, width);
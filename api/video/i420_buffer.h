@@ -97,16 +97,30 @@ class I420Buffer : public I420BufferInterface {
  protected:
   I420Buffer(int width, int height);
   I420Buffer(int width, int height, int stride_y, int stride_u, int stride_v);
+  // Takes ownership of |data|, which must hold all three planes and is
+  // released with |free_data|. Used by buffer pools that manage the memory.
+  I420Buffer(int width,
+             int height,
+             int stride_y,
+             int stride_u,
+             int stride_v,
+             uint8_t* data,
+             void (*free_data)(void*));
 
   ~I420Buffer() override;
 
  private:
+  struct DataDeleter {
+    void operator()(uint8_t* data) const { free_data(data); }
+    void (*free_data)(void*);
+  };
+
   const int width_;
   const int height_;
   const int stride_y_;
   const int stride_u_;
   const int stride_v_;
-  const std::unique_ptr<uint8_t, AlignedFreeDeleter> data_;
+  const std::unique_ptr<uint8_t, DataDeleter> data_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef API_VIDEO_NV12_BUFFER_H_
+#define API_VIDEO_NV12_BUFFER_H_
+
+#include <memory>
+
+#include "api/video/video_frame_buffer.h"
+#include "rtc_base/memory/aligned_malloc.h"
+
+namespace webrtc {
+
+// Plain NV12 buffer in standard memory. Sources that produce NV12 can hand
+// it through capture, scaling and encode without converting it; the
+// conversion to I420 is only done when a sink calls ToI420().
+class NV12Buffer : public NV12BufferInterface {
+ public:
+  static rtc::scoped_refptr<NV12Buffer> Create(int width, int height);
+  static rtc::scoped_refptr<NV12Buffer> Create(int width,
+                                               int height,
+                                               int stride_y,
+                                               int stride_uv);
+
+  // Create a new buffer and copy the pixel data.
+  static rtc::scoped_refptr<NV12Buffer> Copy(const NV12BufferInterface& buffer);
+
+  // Convert and put I420 buffer into a new buffer.
+  static rtc::scoped_refptr<NV12Buffer> Copy(const I420BufferInterface& buffer);
+
+  // VideoFrameBuffer implementation.
+  rtc::scoped_refptr<I420BufferInterface> ToI420() override;
+
+  // Sets both planes to all zeros. See I420Buffer::InitializeData.
+  void InitializeData();
+
+  int width() const override;
+  int height() const override;
+  const uint8_t* DataY() const override;
+  const uint8_t* DataUV() const override;
+
+  int StrideY() const override;
+  int StrideUV() const override;
+
+  uint8_t* MutableDataY();
+  uint8_t* MutableDataUV();
+
+  // Scale the cropped area of |src| to the size of |this| buffer, and
+  // write the result into |this|. A crop without scaling is a plain copy.
+  void CropAndScaleFrom(const NV12BufferInterface& src,
+                        int offset_x,
+                        int offset_y,
+                        int crop_width,
+                        int crop_height);
+
+  // Scale all of |src| to the size of |this| buffer, with no cropping.
+  void ScaleFrom(const NV12BufferInterface& src);
+
+ protected:
+  NV12Buffer(int width, int height);
+  NV12Buffer(int width, int height, int stride_y, int stride_uv);
+
+  ~NV12Buffer() override;
+
+ private:
+  size_t DataSize() const;
+
+  const int width_;
+  const int height_;
+  const int stride_y_;
+  const int stride_uv_;
+  const std::unique_ptr<uint8_t, AlignedFreeDeleter> data_;
+};
+
+}  // namespace webrtc
+
+#endif  // API_VIDEO_NV12_BUFFER_H_
@@ -11,6 +11,8 @@
 #include "api/video/video_stream_encoder_create.h"
 
 #include "absl/memory/memory.h"
+#include "system_wrappers/include/field_trial.h"
+#include "video/encoder_cpu_budget.h"
 #include "video/video_stream_encoder.h"
 
 namespace webrtc {
@@ -22,6 +24,9 @@ std::unique_ptr<VideoStreamEncoderInterface> CreateVideoStreamEncoder(
     rtc::VideoSinkInterface<VideoFrame>* pre_encode_callback) {
   return absl::make_unique<VideoStreamEncoder>(
       number_of_cores, encoder_stats_observer, settings, pre_encode_callback,
-      absl::make_unique<OveruseFrameDetector>(encoder_stats_observer));
+      absl::make_unique<OveruseFrameDetector>(encoder_stats_observer),
+      field_trial::IsEnabled("WebRTC-Video-EncoderCpuBudget")
+          ? EncoderCpuBudget::Global()
+          : nullptr);
 }
 }  // namespace webrtc
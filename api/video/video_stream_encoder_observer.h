@@ -84,6 +84,11 @@ class VideoStreamEncoderObserver : public CpuOveruseMetricsObserver {
 
   virtual void OnSuspendChange(bool is_suspended) = 0;
 
+  // Used to indicate the share of the process-wide encoder CPU budget the
+  // encoder was last initialized with.
+  virtual void OnEncoderCpuBudgetChanged(int cores,
+                                         bool reduced_complexity) = 0;
+
   // TODO(nisse): VideoStreamEncoder wants to query the stats, which makes this
   // not a pure observer. GetInputFrameRate is needed for the cpu adaptation, so
   // can be deleted if that responsibility is moved out to a VideoStreamAdaptor
@@ -22,6 +22,8 @@ namespace webrtc {
 
 // Video codec
 enum class VideoCodecComplexity {
+  // Trades quality for speed, e.g. when the CPU is shared by many encoders.
+  kComplexityLow = -1,
   kComplexityNormal = 0,
   kComplexityHigh = 1,
   kComplexityHigher = 2,
@@ -248,6 +248,14 @@ int AudioReceiveStream::PreferredSampleRate() const {
   return channel_proxy_->PreferredSampleRate();
 }
 
+absl::optional<int> AudioReceiveStream::IncomingAudioLevel() const {
+  return channel_proxy_->IncomingAudioLevel();
+}
+
+void AudioReceiveStream::SkipAudioFrame(int sample_rate_hz) {
+  channel_proxy_->SkipAudioFrame(sample_rate_hz);
+}
+
 int AudioReceiveStream::id() const {
   RTC_DCHECK_RUN_ON(&worker_thread_checker_);
   return config_.rtp.remote_ssrc;
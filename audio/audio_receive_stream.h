@@ -77,6 +77,8 @@ class AudioReceiveStream final : public webrtc::AudioReceiveStream,
                                        AudioFrame* audio_frame) override;
   int Ssrc() const override;
   int PreferredSampleRate() const override;
+  absl::optional<int> IncomingAudioLevel() const override;
+  void SkipAudioFrame(int sample_rate_hz) override;
 
   // Syncable
   int id() const override;
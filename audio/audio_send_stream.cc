@@ -281,6 +281,13 @@ void AudioSendStream::ConfigureStream(
     ReconfigureBitrateObserver(stream, new_config);
   }
   stream->config_ = new_config;
+
+  if (stream->sending_) {
+    // Update AudioState's information about the stream, which depends on the
+    // new config if the stream shares its encoder.
+    stream->audio_state()->AddSendingStream(
+        stream, stream->encoder_sample_rate_hz_, stream->encoder_num_channels_);
+  }
 }
 
 void AudioSendStream::Start() {
@@ -338,6 +345,15 @@ bool AudioSendStream::SendTelephoneEvent(int payload_type,
 void AudioSendStream::SetMuted(bool muted) {
   RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
   channel_proxy_->SetInputMute(muted);
+  if (muted_ == muted) {
+    return;
+  }
+  muted_ = muted;
+  if (sending_) {
+    // Muted and unmuted streams cannot share an encoder.
+    audio_state()->AddSendingStream(this, encoder_sample_rate_hz_,
+                                    encoder_num_channels_);
+  }
 }
 
 webrtc::AudioSendStream::Stats AudioSendStream::GetStats() const {
@@ -484,6 +500,31 @@ const voe::ChannelProxy& AudioSendStream::GetChannelProxy() const {
   return *channel_proxy_.get();
 }
 
+bool AudioSendStream::CanShareEncoderWith(const AudioSendStream& other) const {
+  RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
+  // The audio network adaptor adapts the encoder to the network of a single
+  // stream.
+  return config_.send_codec_spec && other.config_.send_codec_spec &&
+         *config_.send_codec_spec == *other.config_.send_codec_spec &&
+         config_.encoder_factory == other.config_.encoder_factory &&
+         !config_.audio_network_adaptor_config &&
+         !other.config_.audio_network_adaptor_config &&
+         encoder_sample_rate_hz_ == other.encoder_sample_rate_hz_ &&
+         encoder_num_channels_ == other.encoder_num_channels_ &&
+         muted_ == other.muted_;
+}
+
+void AudioSendStream::SetEncodedAudioSubscribers(
+    const std::vector<AudioSendStream*>& subscribers) {
+  RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
+  std::vector<const voe::ChannelProxy*> channel_proxies;
+  for (const AudioSendStream* subscriber : subscribers) {
+    RTC_DCHECK(CanShareEncoderWith(*subscriber));
+    channel_proxies.push_back(subscriber->channel_proxy_.get());
+  }
+  channel_proxy_->SetEncodedAudioSubscribers(channel_proxies);
+}
+
 internal::AudioState* AudioSendStream::audio_state() {
   internal::AudioState* audio_state =
       static_cast<internal::AudioState*>(audio_state_.get());
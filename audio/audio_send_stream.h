@@ -98,6 +98,14 @@ class AudioSendStream final : public webrtc::AudioSendStream,
   RtpState GetRtpState() const;
   const voe::ChannelProxy& GetChannelProxy() const;
 
+  // Returns true if the encoder of this stream can encode the audio of
+  // |other| too, i.e. if the two streams have the same encoder configuration.
+  bool CanShareEncoderWith(const AudioSendStream& other) const;
+  // Lets |subscribers| send the audio that this stream encodes, instead of
+  // encoding it themselves.
+  void SetEncodedAudioSubscribers(
+      const std::vector<AudioSendStream*>& subscribers);
+
  private:
   class TimedTransport;
 
@@ -139,6 +147,7 @@ class AudioSendStream final : public webrtc::AudioSendStream,
   int encoder_sample_rate_hz_ = 0;
   size_t encoder_num_channels_ = 0;
   bool sending_ = false;
+  bool muted_ = false;
 
   BitrateAllocator* const bitrate_allocator_;
   RtpTransportControllerSendInterface* const transport_;
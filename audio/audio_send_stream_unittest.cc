@@ -39,6 +39,7 @@ namespace test {
 namespace {
 
 using testing::_;
+using testing::ElementsAre;
 using testing::Eq;
 using testing::Ne;
 using testing::Invoke;
@@ -517,6 +518,43 @@ TEST(AudioSendStreamTest, ReconfigureTransportCcResetsFirst) {
   send_stream->Reconfigure(new_config);
 }
 
+TEST(AudioSendStreamTest, SharesEncoderWithSameConfig) {
+  ConfigHelper helper1(false, true);
+  ConfigHelper helper2(false, true);
+  helper2.config().encoder_factory = helper1.config().encoder_factory;
+  auto send_stream1 = helper1.CreateAudioSendStream();
+  auto send_stream2 = helper2.CreateAudioSendStream();
+  EXPECT_TRUE(send_stream1->CanShareEncoderWith(*send_stream2));
+  EXPECT_TRUE(send_stream2->CanShareEncoderWith(*send_stream1));
+
+  const voe::ChannelProxy* channel_proxy2 = helper2.channel_proxy();
+  EXPECT_CALL(*helper1.channel_proxy(),
+              SetEncodedAudioSubscribers(ElementsAre(channel_proxy2)));
+  send_stream1->SetEncodedAudioSubscribers({send_stream2.get()});
+}
+
+TEST(AudioSendStreamTest, DoesNotShareEncoderWithOtherCodec) {
+  ConfigHelper helper1(false, true);
+  ConfigHelper helper2(false, true);
+  helper2.config().encoder_factory = helper1.config().encoder_factory;
+  helper2.config().send_codec_spec =
+      AudioSendStream::Config::SendCodecSpec(kIsacPayloadType, kG722Format);
+  auto send_stream1 = helper1.CreateAudioSendStream();
+  auto send_stream2 = helper2.CreateAudioSendStream();
+  EXPECT_FALSE(send_stream1->CanShareEncoderWith(*send_stream2));
+}
+
+TEST(AudioSendStreamTest, DoesNotShareEncoderWithMutedStream) {
+  ConfigHelper helper1(false, true);
+  ConfigHelper helper2(false, true);
+  helper2.config().encoder_factory = helper1.config().encoder_factory;
+  auto send_stream1 = helper1.CreateAudioSendStream();
+  auto send_stream2 = helper2.CreateAudioSendStream();
+  EXPECT_CALL(*helper2.channel_proxy(), SetInputMute(true));
+  send_stream2->SetMuted(true);
+  EXPECT_FALSE(send_stream1->CanShareEncoderWith(*send_stream2));
+}
+
 // Checks that AudioSendStream logs the times at which RTP packets are sent
 // through its interface.
 TEST(AudioSendStreamTest, UpdateLifetime) {
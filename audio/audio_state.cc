@@ -16,18 +16,22 @@
 
 #include "absl/memory/memory.h"
 #include "audio/audio_receive_stream.h"
+#include "audio/audio_send_stream.h"
 #include "modules/audio_device/include/audio_device.h"
 #include "rtc_base/atomicops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/thread.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace webrtc {
 namespace internal {
 
 AudioState::AudioState(const AudioState::Config& config)
     : config_(config),
-      audio_transport_(config_.audio_mixer, config_.audio_processing.get()) {
+      audio_transport_(config_.audio_mixer, config_.audio_processing.get()),
+      shared_encoders_enabled_(
+          field_trial::IsEnabled("WebRTC-Audio-SharedEncoder")) {
   process_thread_checker_.DetachFromThread();
   RTC_DCHECK(config_.audio_mixer);
   RTC_DCHECK(config_.audio_device_module);
@@ -37,6 +41,7 @@ AudioState::~AudioState() {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   RTC_DCHECK(receiving_streams_.empty());
   RTC_DCHECK(sending_streams_.empty());
+  RTC_DCHECK(shared_encoders_.empty());
 }
 
 AudioProcessing* AudioState::audio_processing() {
@@ -192,8 +197,74 @@ void AudioState::UpdateAudioTransportWithSendingStreams() {
     max_sample_rate_hz = std::max(max_sample_rate_hz, kv.second.sample_rate_hz);
     max_num_channels = std::max(max_num_channels, kv.second.num_channels);
   }
+  if (!shared_encoders_enabled_) {
+    audio_transport_.UpdateSendingStreams(std::move(sending_streams),
+                                          max_sample_rate_hz, max_num_channels);
+    return;
+  }
+
+  // Only the streams that own an encoder get the recorded audio.
+  auto shared_encoders = GroupSendingStreamsByEncoder();
+  sending_streams.clear();
+  for (const auto& kv : shared_encoders) {
+    sending_streams.push_back(kv.first);
+  }
+  // A stream that changes groups must neither get audio from an encoder and
+  // encode its own audio at the same time, nor get audio from two encoders.
+  // Hence the encoders stop sending to it before the recorded audio is
+  // redistributed, and start after.
+  for (const auto& kv : shared_encoders_) {
+    auto it = shared_encoders.find(kv.first);
+    if (!kv.second.empty() &&
+        (it == shared_encoders.end() || it->second != kv.second)) {
+      kv.first->SetEncodedAudioSubscribers({});
+    }
+  }
   audio_transport_.UpdateSendingStreams(std::move(sending_streams),
                                         max_sample_rate_hz, max_num_channels);
+  for (const auto& kv : shared_encoders) {
+    auto it = shared_encoders_.find(kv.first);
+    if (!kv.second.empty() &&
+        (it == shared_encoders_.end() || it->second != kv.second)) {
+      kv.first->SetEncodedAudioSubscribers(kv.second);
+    }
+  }
+  shared_encoders_ = std::move(shared_encoders);
+}
+
+std::map<AudioSendStream*, std::vector<AudioSendStream*>>
+AudioState::GroupSendingStreamsByEncoder() const {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  // The streams that already encode for others come first, so that they keep
+  // doing so, and the RTP timestamps of their groups stay continuous.
+  std::vector<AudioSendStream*> streams;
+  for (const auto& kv : shared_encoders_) {
+    if (sending_streams_.count(kv.first) != 0) {
+      streams.push_back(kv.first);
+    }
+  }
+  for (const auto& kv : sending_streams_) {
+    auto* stream = static_cast<AudioSendStream*>(kv.first);
+    if (shared_encoders_.count(stream) == 0) {
+      streams.push_back(stream);
+    }
+  }
+
+  std::map<AudioSendStream*, std::vector<AudioSendStream*>> shared_encoders;
+  for (AudioSendStream* stream : streams) {
+    auto it = std::find_if(
+        shared_encoders.begin(), shared_encoders.end(),
+        [stream](const std::pair<AudioSendStream* const,
+                                 std::vector<AudioSendStream*>>& kv) {
+          return kv.first->CanShareEncoderWith(*stream);
+        });
+    if (it != shared_encoders.end()) {
+      it->second.push_back(stream);
+    } else {
+      shared_encoders.insert({stream, {}});
+    }
+  }
+  return shared_encoders;
 }
 }  // namespace internal
 
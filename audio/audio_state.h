@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "audio/audio_transport_impl.h"
 #include "audio/null_audio_poller.h"
@@ -30,6 +31,8 @@ class AudioReceiveStream;
 
 namespace internal {
 
+class AudioSendStream;
+
 class AudioState final : public webrtc::AudioState {
  public:
   explicit AudioState(const AudioState::Config& config);
@@ -65,6 +68,10 @@ class AudioState final : public webrtc::AudioState {
   rtc::RefCountReleaseStatus Release() const override;
 
   void UpdateAudioTransportWithSendingStreams();
+  // Returns the streams that encode audio, each with the streams that send
+  // the audio it encodes.
+  std::map<internal::AudioSendStream*, std::vector<internal::AudioSendStream*>>
+  GroupSendingStreamsByEncoder() const;
 
   rtc::ThreadChecker thread_checker_;
   rtc::ThreadChecker process_thread_checker_;
@@ -92,6 +99,12 @@ class AudioState final : public webrtc::AudioState {
   };
   std::map<webrtc::AudioSendStream*, StreamProperties> sending_streams_;
 
+  // Streams with the same encoder configuration share one encoder, so that
+  // audio sent on several streams is encoded only once.
+  const bool shared_encoders_enabled_;
+  std::map<internal::AudioSendStream*, std::vector<internal::AudioSendStream*>>
+      shared_encoders_;
+
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(AudioState);
 };
 }  // namespace internal
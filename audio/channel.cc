@@ -27,6 +27,7 @@
 #include "modules/audio_coding/codecs/audio_format_conversion.h"
 #include "modules/audio_device/include/audio_device.h"
 #include "modules/audio_processing/include/audio_processing.h"
+#include "modules/include/module_common_types_public.h"
 #include "modules/pacing/packet_router.h"
 #include "modules/rtp_rtcp/include/receive_statistics.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
@@ -57,6 +58,10 @@ constexpr int64_t kMinRetransmissionWindowMs = 30;
 constexpr int kVoiceEngineMinMinPlayoutDelayMs = 0;
 constexpr int kVoiceEngineMaxMinPlayoutDelayMs = 10000;
 
+// Enough audio levels to cover one second of 20 ms packets, well beyond any
+// jitter buffer delay that matters for speaker selection.
+constexpr size_t kMaxBufferedAudioLevels = 50;
+
 }  // namespace
 
 const int kTelephoneEventAttenuationdB = 10;
@@ -264,11 +269,22 @@ int32_t Channel::SendData(FrameType frameType,
                           size_t payloadSize,
                           const RTPFragmentationHeader* fragmentation) {
   RTC_DCHECK_RUN_ON(encoder_queue_);
+  rtc::CritScope cs(&encoded_audio_subscribers_lock_);
+  int audio_level_dbov = 0;
+  if (_includeAudioLevelIndication || !encoded_audio_subscribers_.empty()) {
+    audio_level_dbov = rms_level_.Average();
+  }
   if (_includeAudioLevelIndication) {
     // Store current audio level in the RTP/RTCP module.
     // The level will be used in combination with voice-activity state
     // (frameType) to add an RTP header extension
-    _rtpRtcpModule->SetAudioLevel(rms_level_.Average());
+    _rtpRtcpModule->SetAudioLevel(audio_level_dbov);
+  }
+
+  for (Channel* subscriber : encoded_audio_subscribers_) {
+    subscriber->SendEncodedAudio(frameType, payloadType, timeStamp,
+                                 payloadData, payloadSize, fragmentation,
+                                 audio_level_dbov);
   }
 
   // Push data from ACM to RTP/RTCP-module to deliver audio frame for
@@ -279,7 +295,8 @@ int32_t Channel::SendData(FrameType frameType,
           // Leaving the time when this frame was
           // received from the capture device as
           // undefined for voice for now.
-          -1, payloadData, payloadSize, fragmentation, nullptr, nullptr)) {
+          -1, payloadData, payloadSize, nullptr, fragmentation, nullptr,
+          nullptr)) {
     RTC_DLOG(LS_ERROR)
         << "Channel::SendData() failed to send data to RTP/RTCP module";
     return -1;
@@ -288,6 +305,30 @@ int32_t Channel::SendData(FrameType frameType,
   return 0;
 }
 
+void Channel::SendEncodedAudio(FrameType frame_type,
+                               uint8_t payload_type,
+                               uint32_t timestamp,
+                               const uint8_t* payload_data,
+                               size_t payload_size,
+                               const RTPFragmentationHeader* fragmentation,
+                               int audio_level_dbov) {
+  // Holding the lock while sending makes StopSend() wait for the packet, like
+  // it waits for the tasks on the encoder queue.
+  rtc::CritScope cs(&encoder_queue_lock_);
+  if (!encoder_queue_is_active_) {
+    return;
+  }
+  if (_includeAudioLevelIndication) {
+    _rtpRtcpModule->SetAudioLevel(audio_level_dbov);
+  }
+  if (!_rtpRtcpModule->SendOutgoingData(frame_type, payload_type, timestamp, -1,
+                                        payload_data, payload_size, nullptr,
+                                        fragmentation, nullptr, nullptr)) {
+    RTC_DLOG(LS_ERROR) << "Channel::SendEncodedAudio() failed to send data to "
+                          "RTP/RTCP module";
+  }
+}
+
 bool Channel::SendRtp(const uint8_t* data,
                       size_t len,
                       const PacketOptions& options) {
@@ -466,6 +507,33 @@ int Channel::PreferredSampleRate() const {
                   audio_coding_->PlayoutFrequency());
 }
 
+absl::optional<int> Channel::IncomingAudioLevel() const {
+  const absl::optional<uint32_t> playout_timestamp =
+      audio_coding_->PlayoutTimestamp();
+  const uint32_t samples_per_10ms = GetRtpTimestampRateHz() / 100;
+  rtc::CritScope cs(&rtp_sources_lock_);
+  if (received_rtp_audio_levels_.empty())
+    return absl::nullopt;
+  if (!playout_timestamp) {
+    // Nothing has been played out yet; the oldest buffered level is the best
+    // guess for what comes out first.
+    return received_rtp_audio_levels_.front().second;
+  }
+  // The mixer asks before pulling the next 10 ms, so report the newest packet
+  // that starts no later than the end of that frame.
+  const uint32_t frame_end = *playout_timestamp + samples_per_10ms;
+  for (auto it = received_rtp_audio_levels_.rbegin();
+       it != received_rtp_audio_levels_.rend(); ++it) {
+    if (IsNewerTimestamp(frame_end, it->first))
+      return it->second;
+  }
+  return received_rtp_audio_levels_.front().second;
+}
+
+void Channel::SkipAudioFrame(int sample_rate_hz) {
+  audio_coding_->SkipPlayoutData10Ms();
+}
+
 Channel::Channel(rtc::TaskQueue* encoder_queue,
                  ProcessThread* module_process_thread,
                  AudioDeviceModule* audio_device_module,
@@ -753,12 +821,24 @@ int32_t Channel::GetRecCodec(CodecInst& codec) {
 }
 
 void Channel::SetBitRate(int bitrate_bps, int64_t probing_interval_ms) {
+  {
+    rtc::CritScope cs(&target_bitrate_lock_);
+    target_bitrate_bps_ = bitrate_bps;
+    probing_interval_ms_ = probing_interval_ms;
+  }
+  // A shared encoder picks up the new target on the encoder queue.
+  if (!HasEncodedAudioSubscribers()) {
+    SetEncoderBitRate(bitrate_bps, probing_interval_ms);
+  }
+  retransmission_rate_limiter_->SetMaxRate(bitrate_bps);
+}
+
+void Channel::SetEncoderBitRate(int bitrate_bps, int64_t probing_interval_ms) {
   audio_coding_->ModifyEncoder([&](std::unique_ptr<AudioEncoder>* encoder) {
     if (*encoder) {
       (*encoder)->OnReceivedUplinkBandwidth(bitrate_bps, probing_interval_ms);
     }
   });
-  retransmission_rate_limiter_->SetMaxRate(bitrate_bps);
 }
 
 void Channel::OnTwccBasedUplinkPacketLossRate(float packet_loss_rate) {
@@ -860,8 +940,12 @@ void Channel::OnRtpPacket(const RtpPacketReceived& packet) {
     rtc::CritScope cs(&rtp_sources_lock_);
     last_received_rtp_timestamp_ = packet.Timestamp();
     last_received_rtp_system_time_ms_ = now_ms;
-    if (has_audio_level)
+    if (has_audio_level) {
       last_received_rtp_audio_level_ = audio_level;
+      received_rtp_audio_levels_.emplace_back(packet.Timestamp(), audio_level);
+      if (received_rtp_audio_levels_.size() > kMaxBufferedAudioLevels)
+        received_rtp_audio_levels_.pop_front();
+    }
     std::vector<uint32_t> csrcs = packet.Csrcs();
     contributing_sources_.Update(now_ms, csrcs);
   }
@@ -1226,7 +1310,10 @@ void Channel::ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input) {
   bool is_muted = InputMute();
   AudioFrameOperations::Mute(audio_input, previous_frame_muted_, is_muted);
 
-  if (_includeAudioLevelIndication) {
+  UpdateSharedEncoderBitRate();
+
+  // The subscribers of a shared encoder send the level of its audio.
+  if (_includeAudioLevelIndication || HasEncodedAudioSubscribers()) {
     size_t length =
         audio_input->samples_per_channel_ * audio_input->num_channels_;
     RTC_CHECK_LE(length, AudioFrame::kMaxDataSizeBytes);
@@ -1254,6 +1341,57 @@ void Channel::ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input) {
   _timeStamp += static_cast<uint32_t>(audio_input->samples_per_channel_);
 }
 
+void Channel::SetEncodedAudioSubscribers(
+    const std::vector<Channel*>& subscribers) {
+  RTC_DCHECK(std::find(subscribers.begin(), subscribers.end(), this) ==
+             subscribers.end());
+  rtc::CritScope cs(&encoded_audio_subscribers_lock_);
+  encoded_audio_subscribers_ = subscribers;
+}
+
+bool Channel::HasEncodedAudioSubscribers() const {
+  rtc::CritScope cs(&encoded_audio_subscribers_lock_);
+  return !encoded_audio_subscribers_.empty();
+}
+
+void Channel::UpdateSharedEncoderBitRate() {
+  int bitrate_bps = 0;
+  int64_t probing_interval_ms = 0;
+  {
+    rtc::CritScope cs(&target_bitrate_lock_);
+    bitrate_bps = target_bitrate_bps_;
+    probing_interval_ms = probing_interval_ms_;
+  }
+  bool shared = false;
+  {
+    rtc::CritScope cs(&encoded_audio_subscribers_lock_);
+    shared = !encoded_audio_subscribers_.empty();
+    for (Channel* subscriber : encoded_audio_subscribers_) {
+      rtc::CritScope subscriber_cs(&subscriber->target_bitrate_lock_);
+      // Channels without a target do not limit the bitrate.
+      const int subscriber_bitrate_bps = subscriber->target_bitrate_bps_;
+      if (subscriber_bitrate_bps > 0 &&
+          (bitrate_bps == 0 || subscriber_bitrate_bps < bitrate_bps)) {
+        bitrate_bps = subscriber_bitrate_bps;
+      }
+    }
+  }
+  if (!shared) {
+    // Goes back to the target of this channel if the encoder was shared.
+    if (shared_encoder_bitrate_bps_ != 0 && bitrate_bps > 0) {
+      SetEncoderBitRate(bitrate_bps, probing_interval_ms);
+    }
+    shared_encoder_bitrate_bps_ = 0;
+    return;
+  }
+  if (bitrate_bps > 0 && bitrate_bps != shared_encoder_bitrate_bps_) {
+    // The encoder is called outside of the locks above, since the ACM calls
+    // SendData() with its own lock held.
+    SetEncoderBitRate(bitrate_bps, probing_interval_ms);
+    shared_encoder_bitrate_bps_ = bitrate_bps;
+  }
+}
+
 void Channel::SetAssociatedSendChannel(Channel* channel) {
   RTC_DCHECK_NE(this, channel);
   rtc::CritScope lock(&assoc_send_channel_lock_);
@@ -11,9 +11,11 @@
 #ifndef AUDIO_CHANNEL_H_
 #define AUDIO_CHANNEL_H_
 
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/types/optional.h"
@@ -265,6 +267,8 @@ class Channel
       AudioFrame* audio_frame);
 
   int PreferredSampleRate() const;
+  absl::optional<int> IncomingAudioLevel() const;
+  void SkipAudioFrame(int sample_rate_hz);
 
   bool Playing() const { return channel_state_.Get().playing; }
   bool Sending() const { return channel_state_.Get().sending; }
@@ -281,6 +285,13 @@ class Channel
   // packet.
   void ProcessAndEncodeAudio(std::unique_ptr<AudioFrame> audio_frame);
 
+  // Lets |subscribers| packetize and send the audio that this channel encodes,
+  // with their own SSRCs and sequence numbers. Used to encode the same audio
+  // only once for channels with the same encoder configuration; the
+  // subscribers must not be given any audio to encode themselves. The shared
+  // encoder runs at the lowest target bitrate of the channels.
+  void SetEncodedAudioSubscribers(const std::vector<Channel*>& subscribers);
+
   // Associate to a send channel.
   // Used for obtaining RTT for a receive-only channel.
   void SetAssociatedSendChannel(Channel* channel);
@@ -330,6 +341,20 @@ class Channel
   // for encoding.
   void ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input);
 
+  void SetEncoderBitRate(int bitrate_bps, int64_t probing_interval_ms);
+  // Called on the encoder task queue of the channel that owns the shared
+  // encoder, to apply the lowest target bitrate of its subscribers.
+  void UpdateSharedEncoderBitRate();
+  bool HasEncodedAudioSubscribers() const;
+  // Sends audio encoded by the shared encoder of another channel.
+  void SendEncodedAudio(FrameType frame_type,
+                        uint8_t payload_type,
+                        uint32_t timestamp,
+                        const uint8_t* payload_data,
+                        size_t payload_size,
+                        const RTPFragmentationHeader* fragmentation,
+                        int audio_level_dbov);
+
   rtc::CriticalSection _callbackCritSect;
   rtc::CriticalSection volume_settings_critsect_;
 
@@ -354,6 +379,12 @@ class Channel
       RTC_GUARDED_BY(&rtp_sources_lock_);
   absl::optional<uint8_t> last_received_rtp_audio_level_
       RTC_GUARDED_BY(&rtp_sources_lock_);
+  // (RTP timestamp, audio level) of the most recently received packets that
+  // carried the audio level header extension, oldest first. Used to report the
+  // level of the audio that is about to be played out rather than the level of
+  // the newest packet, which may be a jitter buffer delay ahead.
+  std::deque<std::pair<uint32_t, uint8_t>> received_rtp_audio_levels_
+      RTC_GUARDED_BY(&rtp_sources_lock_);
 
   std::unique_ptr<AudioCodingModule> audio_coding_;
   AudioSinkInterface* audio_sink_ = nullptr;
@@ -414,6 +445,18 @@ class Channel
   rtc::CriticalSection encoder_queue_lock_;
   bool encoder_queue_is_active_ RTC_GUARDED_BY(encoder_queue_lock_) = false;
   rtc::TaskQueue* encoder_queue_ = nullptr;
+
+  // The last bitrate given to SetBitRate(), or 0 if none.
+  rtc::CriticalSection target_bitrate_lock_;
+  int target_bitrate_bps_ RTC_GUARDED_BY(target_bitrate_lock_) = 0;
+  int64_t probing_interval_ms_ RTC_GUARDED_BY(target_bitrate_lock_) = 0;
+
+  // Channels that send the audio encoded by this channel.
+  rtc::CriticalSection encoded_audio_subscribers_lock_;
+  std::vector<Channel*> encoded_audio_subscribers_
+      RTC_GUARDED_BY(encoded_audio_subscribers_lock_);
+  // The bitrate that the encoder runs at while it is shared, or 0.
+  int shared_encoder_bitrate_bps_ RTC_GUARDED_BY(encoder_queue_) = 0;
 };
 
 }  // namespace voe
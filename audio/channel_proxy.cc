@@ -233,12 +233,32 @@ int ChannelProxy::PreferredSampleRate() const {
   return channel_->PreferredSampleRate();
 }
 
+absl::optional<int> ChannelProxy::IncomingAudioLevel() const {
+  RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
+  return channel_->IncomingAudioLevel();
+}
+
+void ChannelProxy::SkipAudioFrame(int sample_rate_hz) {
+  RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
+  channel_->SkipAudioFrame(sample_rate_hz);
+}
+
 void ChannelProxy::ProcessAndEncodeAudio(
     std::unique_ptr<AudioFrame> audio_frame) {
   RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
   return channel_->ProcessAndEncodeAudio(std::move(audio_frame));
 }
 
+void ChannelProxy::SetEncodedAudioSubscribers(
+    const std::vector<const ChannelProxy*>& subscribers) {
+  RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
+  std::vector<Channel*> channels;
+  for (const ChannelProxy* subscriber : subscribers) {
+    channels.push_back(subscriber->channel_.get());
+  }
+  channel_->SetEncodedAudioSubscribers(channels);
+}
+
 void ChannelProxy::SetTransportOverhead(int transport_overhead_per_packet) {
   RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
   channel_->SetTransportOverhead(transport_overhead_per_packet);
@@ -101,7 +101,11 @@ class ChannelProxy : public RtpPacketSinkInterface {
       int sample_rate_hz,
       AudioFrame* audio_frame);
   virtual int PreferredSampleRate() const;
+  virtual absl::optional<int> IncomingAudioLevel() const;
+  virtual void SkipAudioFrame(int sample_rate_hz);
   virtual void ProcessAndEncodeAudio(std::unique_ptr<AudioFrame> audio_frame);
+  virtual void SetEncodedAudioSubscribers(
+      const std::vector<const ChannelProxy*>& subscribers);
   virtual void SetTransportOverhead(int transport_overhead_per_packet);
   virtual void AssociateSendChannel(const ChannelProxy& send_channel_proxy);
   virtual void DisassociateSendChannel();
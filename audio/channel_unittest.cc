@@ -0,0 +1,256 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/audio/audio_frame.h"
+#include "audio/channel.h"
+#include "call/test/mock_rtp_transport_controller_send.h"
+#include "logging/rtc_event_log/mock/mock_rtc_event_log.h"
+#include "modules/audio_device/include/mock_audio_device.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/utility/include/mock/mock_process_thread.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/mock_audio_encoder.h"
+#include "test/mock_transport.h"
+
+namespace webrtc {
+namespace voe {
+namespace {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+constexpr int kPayloadType = 103;
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kEncodedBytes = 20;
+constexpr size_t kNumStreams = 3;
+constexpr uint32_t kSsrcs[kNumStreams] = {0x11111111, 0x22222222, 0x33333333};
+constexpr int kNumFrames = 10;
+
+class MockTransportFeedbackObserver : public TransportFeedbackObserver {
+ public:
+  MOCK_METHOD4(AddPacket,
+               void(uint32_t ssrc,
+                    uint16_t sequence_number,
+                    size_t length,
+                    const PacedPacketInfo& pacing_info));
+  MOCK_METHOD1(OnTransportFeedback,
+               void(const rtcp::TransportFeedback& feedback));
+};
+
+// Records the SSRC and sequence number of each packet handed to the pacer.
+class RecordingPacketSender : public RtpPacketSender {
+ public:
+  struct Packet {
+    uint32_t ssrc;
+    uint16_t sequence_number;
+  };
+
+  void InsertPacket(Priority priority,
+                    uint32_t ssrc,
+                    uint16_t sequence_number,
+                    int64_t capture_time_ms,
+                    size_t bytes,
+                    bool retransmission) override {
+    rtc::CritScope lock(&crit_);
+    packets_.push_back({ssrc, sequence_number});
+  }
+
+  void SetAccountForAudioPackets(bool account_for_audio) override {}
+
+  std::vector<Packet> PacketsWithSsrc(uint32_t ssrc) const {
+    rtc::CritScope lock(&crit_);
+    std::vector<Packet> packets;
+    for (const Packet& packet : packets_) {
+      if (packet.ssrc == ssrc) {
+        packets.push_back(packet);
+      }
+    }
+    return packets;
+  }
+
+  size_t NumPackets() const {
+    rtc::CritScope lock(&crit_);
+    return packets_.size();
+  }
+
+ private:
+  rtc::CriticalSection crit_;
+  std::vector<Packet> packets_ RTC_GUARDED_BY(crit_);
+};
+
+class ChannelSharedEncoderTest : public ::testing::Test {
+ protected:
+  ChannelSharedEncoderTest() : encoder_queue_("EncoderQueue") {
+    ON_CALL(transport_controller_, packet_router())
+        .WillByDefault(Return(&packet_router_));
+    ON_CALL(transport_controller_, transport_feedback_observer())
+        .WillByDefault(Return(&transport_feedback_observer_));
+    ON_CALL(transport_controller_, packet_sender())
+        .WillByDefault(Return(&packet_sender_));
+    for (size_t i = 0; i < kNumStreams; ++i) {
+      channels_.push_back(absl::make_unique<Channel>(
+          &encoder_queue_, &process_thread_, &audio_device_module_, nullptr,
+          &event_log_));
+      Channel* channel = channels_.back().get();
+      channel->RegisterTransport(&transport_);
+      channel->RegisterSenderCongestionControlObjects(&transport_controller_,
+                                                      nullptr);
+      channel->SetLocalSSRC(kSsrcs[i]);
+
+      auto encoder = absl::make_unique<NiceMock<MockAudioEncoder>>();
+      encoders_[i] = encoder.get();
+      ON_CALL(*encoder, SampleRateHz()).WillByDefault(Return(kSampleRateHz));
+      ON_CALL(*encoder, NumChannels()).WillByDefault(Return(1));
+      ON_CALL(*encoder, RtpTimestampRateHz())
+          .WillByDefault(Return(kSampleRateHz));
+      ON_CALL(*encoder, Num10MsFramesInNextPacket()).WillByDefault(Return(1));
+      ON_CALL(*encoder, Max10MsFramesInAPacket()).WillByDefault(Return(1));
+      ON_CALL(*encoder, EncodeImpl(_, _, _))
+          .WillByDefault(Invoke([](uint32_t timestamp,
+                                   rtc::ArrayView<const int16_t> audio,
+                                   rtc::Buffer* encoded) {
+            encoded->AppendData(kEncodedBytes, [](rtc::ArrayView<uint8_t> d) {
+              std::fill(d.begin(), d.end(), 0);
+              return d.size();
+            });
+            AudioEncoder::EncodedInfo info;
+            info.encoded_bytes = kEncodedBytes;
+            info.encoded_timestamp = timestamp;
+            info.payload_type = kPayloadType;
+            info.speech = true;
+            return info;
+          }));
+      EXPECT_TRUE(channel->SetEncoder(kPayloadType, std::move(encoder)));
+      EXPECT_EQ(0, channel->StartSend());
+    }
+  }
+
+  ~ChannelSharedEncoderTest() override {
+    // Stopping the encoder owner first flushes the frames queued for it while
+    // the subscribers are still sending.
+    for (auto& channel : channels_) {
+      channel->StopSend();
+      channel->ResetSenderCongestionControlObjects();
+    }
+  }
+
+  // Shares the encoder of the first channel with all the others.
+  void ShareEncoder() {
+    std::vector<Channel*> subscribers;
+    for (size_t i = 1; i < kNumStreams; ++i) {
+      subscribers.push_back(channels_[i].get());
+    }
+    channels_[0]->SetEncodedAudioSubscribers(subscribers);
+  }
+
+  void SendFrames(int num_frames) {
+    for (int i = 0; i < num_frames; ++i) {
+      auto frame = absl::make_unique<AudioFrame>();
+      const std::vector<int16_t> audio(kSampleRateHz / 100, 1000);
+      frame->UpdateFrame(0, audio.data(), audio.size(), kSampleRateHz,
+                         AudioFrame::kNormalSpeech, AudioFrame::kVadActive);
+      channels_[0]->ProcessAndEncodeAudio(std::move(frame));
+    }
+    WaitForEncoderQueue();
+  }
+
+  void WaitForEncoderQueue() {
+    rtc::Event done(false, false);
+    encoder_queue_.PostTask([&done] { done.Set(); });
+    ASSERT_TRUE(done.Wait(rtc::Event::kForever));
+  }
+
+  NiceMock<MockProcessThread> process_thread_;
+  NiceMock<test::MockAudioDeviceModule> audio_device_module_;
+  NiceMock<MockRtcEventLog> event_log_;
+  NiceMock<MockTransport> transport_;
+  NiceMock<MockTransportFeedbackObserver> transport_feedback_observer_;
+  RecordingPacketSender packet_sender_;
+  PacketRouter packet_router_;
+  NiceMock<MockRtpTransportControllerSend> transport_controller_;
+  MockAudioEncoder* encoders_[kNumStreams];
+  rtc::TaskQueue encoder_queue_;
+  std::vector<std::unique_ptr<Channel>> channels_;
+};
+
+}  // namespace
+
+TEST_F(ChannelSharedEncoderTest, EncodesOnceForAllStreams) {
+  EXPECT_CALL(*encoders_[0], EncodeImpl(_, _, _)).Times(kNumFrames);
+  for (size_t i = 1; i < kNumStreams; ++i) {
+    EXPECT_CALL(*encoders_[i], EncodeImpl(_, _, _)).Times(0);
+  }
+  ShareEncoder();
+  SendFrames(kNumFrames);
+
+  for (size_t i = 0; i < kNumStreams; ++i) {
+    SCOPED_TRACE(i);
+    const std::vector<RecordingPacketSender::Packet> packets =
+        packet_sender_.PacketsWithSsrc(kSsrcs[i]);
+    ASSERT_EQ(static_cast<size_t>(kNumFrames), packets.size());
+    // Each stream numbers its packets with its own RTP module.
+    for (size_t j = 1; j < packets.size(); ++j) {
+      EXPECT_EQ(static_cast<uint16_t>(packets[j - 1].sequence_number + 1),
+                packets[j].sequence_number);
+    }
+  }
+  EXPECT_EQ(kNumStreams * kNumFrames, packet_sender_.NumPackets());
+}
+
+TEST_F(ChannelSharedEncoderTest, FollowsLowestTargetBitrate) {
+  std::vector<int> owner_bitrates;
+  EXPECT_CALL(*encoders_[0], OnReceivedUplinkBandwidth(_, _))
+      .WillRepeatedly(Invoke(
+          [&owner_bitrates](int bitrate_bps, absl::optional<int64_t>) {
+            owner_bitrates.push_back(bitrate_bps);
+          }));
+
+  channels_[0]->SetBitRate(64000, 0);
+  ShareEncoder();
+  channels_[1]->SetBitRate(24000, 0);
+  channels_[2]->SetBitRate(40000, 0);
+  // A shared encoder picks up new targets when it encodes the next frame.
+  EXPECT_EQ(std::vector<int>({64000}), owner_bitrates);
+  SendFrames(1);
+  EXPECT_EQ(std::vector<int>({64000, 24000}), owner_bitrates);
+
+  // Raising the lowest target moves the encoder to the next lowest one.
+  channels_[1]->SetBitRate(56000, 0);
+  SendFrames(1);
+  EXPECT_EQ(std::vector<int>({64000, 24000, 40000}), owner_bitrates);
+
+  // The target of the owner itself limits the encoder as well.
+  channels_[0]->SetBitRate(32000, 0);
+  SendFrames(1);
+  channels_[0]->SetBitRate(72000, 0);
+  SendFrames(1);
+  EXPECT_EQ(std::vector<int>({64000, 24000, 40000, 32000, 40000}),
+            owner_bitrates);
+
+  // Without subscribers, the encoder goes back to the target of the owner.
+  channels_[0]->SetEncodedAudioSubscribers({});
+  SendFrames(1);
+  EXPECT_EQ(std::vector<int>({64000, 24000, 40000, 32000, 40000, 72000}),
+            owner_bitrates);
+}
+
+}  // namespace voe
+}  // namespace webrtc
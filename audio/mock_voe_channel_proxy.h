@@ -71,12 +71,16 @@ class MockVoEChannelProxy : public voe::ChannelProxy {
                AudioMixer::Source::AudioFrameInfo(int sample_rate_hz,
                                                   AudioFrame* audio_frame));
   MOCK_CONST_METHOD0(PreferredSampleRate, int());
+  MOCK_CONST_METHOD0(IncomingAudioLevel, absl::optional<int>());
+  MOCK_METHOD1(SkipAudioFrame, void(int sample_rate_hz));
   // GMock doesn't like move-only types, like std::unique_ptr.
   virtual void ProcessAndEncodeAudio(std::unique_ptr<AudioFrame> audio_frame) {
     ProcessAndEncodeAudioForMock(&audio_frame);
   }
   MOCK_METHOD1(ProcessAndEncodeAudioForMock,
                void(std::unique_ptr<AudioFrame>* audio_frame));
+  MOCK_METHOD1(SetEncodedAudioSubscribers,
+               void(const std::vector<const ChannelProxy*>& subscribers));
   MOCK_METHOD1(SetTransportOverhead, void(int transport_overhead_per_packet));
   MOCK_METHOD1(AssociateSendChannel,
                void(const ChannelProxy& send_channel_proxy));
@@ -59,8 +59,10 @@
 #include "rtc_base/trace_event.h"
 #include "system_wrappers/include/clock.h"
 #include "system_wrappers/include/cpu_info.h"
+#include "system_wrappers/include/field_trial.h"
 #include "system_wrappers/include/metrics.h"
 #include "video/call_stats.h"
+#include "video/decode_scheduler.h"
 #include "video/send_delay_stats.h"
 #include "video/stats_counter.h"
 #include "video/video_receive_stream.h"
@@ -260,6 +262,10 @@ class Call final : public webrtc::Call,
   const int num_cpu_cores_;
   const std::unique_ptr<ProcessThread> module_process_thread_;
   const std::unique_ptr<CallStats> call_stats_;
+  // Decodes the video receive streams of all Calls in the process on a pool
+  // of threads, instead of a thread per stream. Acquired with the first video
+  // receive stream.
+  DecodeScheduler* decode_scheduler_ = nullptr;
   const std::unique_ptr<BitrateAllocator> bitrate_allocator_;
   Call::Config config_;
   rtc::SequencedTaskChecker configuration_sequence_checker_;
@@ -483,6 +489,9 @@ Call::~Call() {
   }
   UpdateReceiveHistograms();
   UpdateHistograms();
+
+  if (decode_scheduler_)
+    DecodeScheduler::ReleaseShared();
 }
 
 void Call::UpdateHistograms() {
@@ -799,10 +808,15 @@ webrtc::VideoReceiveStream* Call::CreateVideoReceiveStream(
   TRACE_EVENT0("webrtc", "Call::CreateVideoReceiveStream");
   RTC_DCHECK_CALLED_SEQUENTIALLY(&configuration_sequence_checker_);
 
+  if (!decode_scheduler_ &&
+      field_trial::IsEnabled("WebRTC-Video-SharedDecodeThreads")) {
+    decode_scheduler_ = DecodeScheduler::AcquireShared();
+  }
+
   VideoReceiveStream* receive_stream = new VideoReceiveStream(
       &video_receiver_controller_, num_cpu_cores_,
       transport_send_ptr_->packet_router(), std::move(configuration),
-      module_process_thread_.get(), call_stats_.get());
+      module_process_thread_.get(), call_stats_.get(), decode_scheduler_);
 
   const webrtc::VideoReceiveStream::Config& config = receive_stream->config();
   {
@@ -71,6 +71,7 @@ bool RtpDemuxer::AddSink(const RtpDemuxerCriteria& criteria,
   }
 
   RefreshKnownMids();
+  resolved_ssrcs_.Clear();
 
   return true;
 }
@@ -148,11 +149,21 @@ bool RtpDemuxer::RemoveSink(const RtpPacketSinkInterface* sink) {
                        RemoveFromMapByValue(&sink_by_mid_and_rsid_, sink) +
                        RemoveFromMapByValue(&sink_by_rsid_, sink);
   RefreshKnownMids();
+  resolved_ssrcs_.Clear();
   return num_removed > 0;
 }
 
+void RtpDemuxer::set_use_mid(bool use_mid) {
+  use_mid_ = use_mid;
+  resolved_ssrcs_.Clear();
+}
+
 bool RtpDemuxer::OnRtpPacket(const RtpPacketReceived& packet) {
-  RtpPacketSinkInterface* sink = ResolveSink(packet);
+  RtpPacketSinkInterface* sink = ResolveSinkFromCache(packet);
+  if (sink == nullptr) {
+    sink = ResolveSink(packet);
+    CacheResolvedSink(packet.Ssrc(), sink);
+  }
   if (sink != nullptr) {
     sink->OnRtpPacket(packet);
     return true;
@@ -259,6 +270,66 @@ RtpPacketSinkInterface* RtpDemuxer::ResolveSink(
   return ResolveSinkByPayloadType(packet.PayloadType(), ssrc);
 }
 
+RtpPacketSinkInterface* RtpDemuxer::ResolveSinkFromCache(
+    const RtpPacketReceived& packet) const {
+  const ResolvedSsrc* resolved = resolved_ssrcs_.Find(packet.Ssrc());
+  if (resolved == nullptr) {
+    return nullptr;
+  }
+
+  // A MID or RSID that differs from the latched one may rebind the SSRC (or
+  // cause the packet to be dropped), so let ResolveSink() handle it. This uses
+  // the fixed size string type to avoid allocating.
+  if (use_mid_) {
+    Mid packet_mid;
+    if (packet.GetExtension<RtpMid>(&packet_mid) &&
+        packet_mid != resolved->mid) {
+      return nullptr;
+    }
+  }
+  StreamId packet_rsid;
+  bool has_rsid = packet.GetExtension<RepairedRtpStreamId>(&packet_rsid);
+  if (!has_rsid) {
+    has_rsid = packet.GetExtension<RtpStreamId>(&packet_rsid);
+  }
+  if (has_rsid && packet_rsid != resolved->rsid) {
+    return nullptr;
+  }
+
+  return resolved->sink;
+}
+
+void RtpDemuxer::CacheResolvedSink(uint32_t ssrc,
+                                   RtpPacketSinkInterface* sink) {
+  // A dropped packet may still have updated the latched MID or RSID, so any
+  // earlier result for the SSRC must be forgotten.
+  if (sink == nullptr) {
+    resolved_ssrcs_.Erase(ssrc);
+    return;
+  }
+
+  // Only remember sinks that the SSRC was bound to. Once kMaxSsrcBindings is
+  // reached, new SSRCs are not bound, so their packets must keep going through
+  // ResolveSink(). This also bounds the table by the same limit.
+  const auto binding_it = sink_by_ssrc_.find(ssrc);
+  if (binding_it == sink_by_ssrc_.end() || binding_it->second != sink) {
+    resolved_ssrcs_.Erase(ssrc);
+    return;
+  }
+
+  ResolvedSsrc resolved;
+  resolved.sink = sink;
+  const auto mid_it = mid_by_ssrc_.find(ssrc);
+  if (mid_it != mid_by_ssrc_.end()) {
+    resolved.mid = Mid(mid_it->second);
+  }
+  const auto rsid_it = rsid_by_ssrc_.find(ssrc);
+  if (rsid_it != rsid_by_ssrc_.end()) {
+    resolved.rsid = StreamId(rsid_it->second);
+  }
+  resolved_ssrcs_.Insert(ssrc, resolved);
+}
+
 RtpPacketSinkInterface* RtpDemuxer::ResolveSinkByMid(const std::string& mid,
                                                      uint32_t ssrc) {
   const auto it = sink_by_mid_.find(mid);
@@ -17,6 +17,9 @@
 #include <utility>
 #include <vector>
 
+#include "api/rtp_headers.h"
+#include "rtc_base/uint32_hash_map.h"
+
 namespace webrtc {
 
 class RtpPacketReceived;
@@ -81,6 +84,14 @@ struct RtpDemuxerCriteria {
 // In summary, the routing algorithm will always try to first match MID and RSID
 // (including through SSRC binding), match SSRC directly as needed, and use
 // payload types only if all else fails.
+//
+// The outcome of the algorithm above only depends on the added sinks and on
+// what has been learned about the packet's SSRC. Once a packet has been routed,
+// the result is therefore remembered per SSRC in a flat hash table, together
+// with the MID and RSID latched for that SSRC. Subsequent packets with the same
+// SSRC, and either no MID/RSID extensions or the same values, are routed with a
+// single hash lookup and without allocating. Adding or removing sinks
+// invalidates all remembered results.
 class RtpDemuxer {
  public:
   // Maximum number of unique SSRC bindings allowed. This limit is to prevent
@@ -139,9 +150,27 @@ class RtpDemuxer {
 
   // Configure whether to look at the MID header extension when demuxing
   // incoming RTP packets. By default this is enabled.
-  void set_use_mid(bool use_mid) { use_mid_ = use_mid; }
+  void set_use_mid(bool use_mid);
 
  private:
+  // Result of a previous run of ResolveSink() for an SSRC.
+  struct ResolvedSsrc {
+    RtpPacketSinkInterface* sink = nullptr;
+    // MID and RSID latched for the SSRC at the time of resolution, or empty if
+    // none were known.
+    Mid mid;
+    StreamId rsid;
+  };
+
+  // Returns the sink previously resolved for the packet's SSRC if its MID and
+  // RSID extensions (if any) are consistent with what was latched then.
+  // Returns null if the full algorithm needs to run. Does not allocate.
+  RtpPacketSinkInterface* ResolveSinkFromCache(
+      const RtpPacketReceived& packet) const;
+
+  // Updates |resolved_ssrcs_| after ResolveSink() has run for |ssrc|.
+  void CacheResolvedSink(uint32_t ssrc, RtpPacketSinkInterface* sink);
+
   // Returns true if adding a sink with the given criteria would cause conflicts
   // with the existing criteria and should be rejected.
   bool CriteriaWouldConflict(const RtpDemuxerCriteria& criteria) const;
@@ -202,6 +231,10 @@ class RtpDemuxer {
   // resolved by this object.
   std::vector<SsrcBindingObserver*> ssrc_binding_observers_;
 
+  // Fast path lookup table, consulted before running ResolveSink(). Cleared
+  // whenever the sink mappings or |use_mid_| change.
+  Uint32HashMap<ResolvedSsrc> resolved_ssrcs_;
+
   bool use_mid_ = true;
 };
 
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "call/rtp_demuxer.h"
+#include "call/rtp_packet_sink_interface.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumStreams = 500;
+constexpr int kNumRounds = 2000;
+constexpr int kQuickNumRounds = 50;
+
+enum class StreamSignaling { kSsrc, kMid, kMidAndRsid };
+
+class CountingSink : public RtpPacketSinkInterface {
+ public:
+  void OnRtpPacket(const RtpPacketReceived& packet) override { ++count_; }
+  int count() const { return count_; }
+
+ private:
+  int count_ = 0;
+};
+
+std::string MidForStream(int index) {
+  rtc::StringBuilder sb;
+  sb << "m" << index;
+  return sb.str();
+}
+
+// Demuxes packets for |kNumStreams| streams, interleaved round robin as they
+// would be on a busy bundled transport. Returns the average time per packet in
+// nanoseconds; the first packet of each stream, which resolves and latches the
+// sink, is reported separately through |first_packet_ns|.
+double RunDemuxer(StreamSignaling signaling, double* first_packet_ns) {
+  RtpDemuxer demuxer;
+  std::vector<CountingSink> sinks(kNumStreams);
+  RtpPacketReceived::ExtensionManager extensions;
+  extensions.Register<RtpMid>(1);
+  extensions.Register<RtpStreamId>(2);
+
+  std::vector<std::unique_ptr<RtpPacketReceived>> packets;
+  for (int i = 0; i < kNumStreams; ++i) {
+    const uint32_t ssrc = 0x10000 + 7919 * i;
+    RtpDemuxerCriteria criteria;
+    if (signaling == StreamSignaling::kSsrc) {
+      criteria.ssrcs.insert(ssrc);
+    } else {
+      criteria.mid = MidForStream(i);
+      if (signaling == StreamSignaling::kMidAndRsid)
+        criteria.rsid = "r0";
+    }
+    EXPECT_TRUE(demuxer.AddSink(criteria, &sinks[i]));
+
+    auto packet = absl::make_unique<RtpPacketReceived>(&extensions);
+    packet->SetSsrc(ssrc);
+    packet->SetPayloadType(96);
+    if (signaling != StreamSignaling::kSsrc) {
+      // Senders typically repeat the extensions on every packet.
+      packet->SetExtension<RtpMid>(MidForStream(i));
+      if (signaling == StreamSignaling::kMidAndRsid)
+        packet->SetExtension<RtpStreamId>("r0");
+    }
+    packet->SetPayloadSize(1000);
+    packets.push_back(std::move(packet));
+  }
+
+  int64_t start_ns = rtc::TimeNanos();
+  for (const auto& packet : packets)
+    EXPECT_TRUE(demuxer.OnRtpPacket(*packet));
+  *first_packet_ns =
+      static_cast<double>(rtc::TimeNanos() - start_ns) / kNumStreams;
+
+  const int rounds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                         ? kQuickNumRounds
+                         : kNumRounds;
+  start_ns = rtc::TimeNanos();
+  for (int round = 0; round < rounds; ++round) {
+    for (const auto& packet : packets)
+      demuxer.OnRtpPacket(*packet);
+  }
+  const double ns_per_packet =
+      static_cast<double>(rtc::TimeNanos() - start_ns) / (rounds * kNumStreams);
+
+  for (auto& sink : sinks) {
+    EXPECT_EQ(sink.count(), rounds + 1);
+    demuxer.RemoveSink(&sink);
+  }
+  return ns_per_packet;
+}
+
+void RunAndReport(StreamSignaling signaling, const std::string& trace) {
+  double first_packet_ns = 0;
+  double ns_per_packet = RunDemuxer(signaling, &first_packet_ns);
+  test::PrintResult("rtp_demuxer_500_ssrcs", "_first_packet", trace,
+                    first_packet_ns, "ns", false);
+  test::PrintResult("rtp_demuxer_500_ssrcs", "", trace, ns_per_packet, "ns",
+                    true);
+}
+
+}  // namespace
+
+TEST(RtpDemuxerPerformanceTest, SsrcSignaled) {
+  RunAndReport(StreamSignaling::kSsrc, "ssrc");
+}
+
+TEST(RtpDemuxerPerformanceTest, MidSignaled) {
+  RunAndReport(StreamSignaling::kMid, "mid");
+}
+
+TEST(RtpDemuxerPerformanceTest, MidAndRsidSignaled) {
+  RunAndReport(StreamSignaling::kMidAndRsid, "mid_rsid");
+}
+
+}  // namespace webrtc
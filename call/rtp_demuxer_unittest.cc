@@ -1478,6 +1478,162 @@ TEST_F(RtpDemuxerTest, MaliciousPeerCannotCauseMemoryOveruse) {
   }
 }
 
+// The tests below exercise the per-SSRC fast path, which remembers the result
+// of routing a packet. They check that later packets are routed exactly as
+// they would have been without it.
+
+TEST_F(RtpDemuxerTest, RepeatedPacketsWithSameMidNotifyObserverOnce) {
+  const std::string mid = "v";
+  constexpr uint32_t ssrc = 10;
+
+  MockRtpPacketSink sink;
+  AddSinkOnlyMid(mid, &sink);
+
+  MockSsrcBindingObserver observer;
+  RegisterSsrcBindingObserver(&observer);
+
+  EXPECT_CALL(observer, OnSsrcBoundToMid(mid, ssrc)).Times(1);
+  EXPECT_CALL(sink, OnRtpPacket(_)).Times(3);
+  for (int i = 0; i < 3; i++) {
+    auto packet = CreatePacketWithSsrcMid(ssrc, mid);
+    EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+  }
+}
+
+TEST_F(RtpDemuxerTest, RoutedSsrcRebindsWhenPacketCarriesNewRsid) {
+  const std::string rsid1 = "1";
+  const std::string rsid2 = "2";
+  constexpr uint32_t ssrc = 10;
+
+  NiceMock<MockRtpPacketSink> sink1;
+  AddSinkOnlyRsid(rsid1, &sink1);
+  MockRtpPacketSink sink2;
+  AddSinkOnlyRsid(rsid2, &sink2);
+
+  auto packet_rsid1 = CreatePacketWithSsrcRsid(ssrc, rsid1);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_rsid1));
+
+  auto packet_rsid2 = CreatePacketWithSsrcRsid(ssrc, rsid2);
+  auto packet_ssrc_only = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(sink1, OnRtpPacket(_)).Times(0);
+  InSequence sequence;
+  EXPECT_CALL(sink2, OnRtpPacket(SamePacketAs(*packet_rsid2))).Times(1);
+  EXPECT_CALL(sink2, OnRtpPacket(SamePacketAs(*packet_ssrc_only))).Times(1);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_rsid2));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_ssrc_only));
+}
+
+TEST_F(RtpDemuxerTest, DroppedPacketWithNewRsidInvalidatesRoutedSsrc) {
+  const std::string mid = "v";
+  const std::string rsid = "1";
+  const std::string wrong_rsid = "2";
+  constexpr uint32_t ssrc = 10;
+
+  NiceMock<MockRtpPacketSink> sink;
+  AddSinkBothMidRsid(mid, rsid, &sink);
+
+  auto packet = CreatePacketWithSsrcMidRsid(ssrc, mid, rsid);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+
+  // Latches the unknown RSID to the SSRC, so that later packets without
+  // extensions are dropped as well.
+  auto packet_wrong_rsid = CreatePacketWithSsrcMidRsid(ssrc, mid, wrong_rsid);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_wrong_rsid));
+
+  auto packet_ssrc_only = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(sink, OnRtpPacket(_)).Times(0);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_ssrc_only));
+}
+
+TEST_F(RtpDemuxerTest, PacketWithUnknownMidDroppedAfterSsrcWasRouted) {
+  const std::string mid = "v";
+  const std::string unknown_mid = "a";
+  constexpr uint32_t ssrc = 10;
+
+  NiceMock<MockRtpPacketSink> sink;
+  AddSinkOnlyMid(mid, &sink);
+
+  auto packet = CreatePacketWithSsrcMid(ssrc, mid);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+
+  auto packet_unknown_mid = CreatePacketWithSsrcMid(ssrc, unknown_mid);
+  EXPECT_CALL(sink, OnRtpPacket(_)).Times(0);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_unknown_mid));
+}
+
+TEST_F(RtpDemuxerTest, AddingSinkReroutesSsrcPreviouslyRoutedByPayloadType) {
+  const std::string rsid = "1";
+  constexpr uint32_t ssrc = 10;
+  constexpr uint8_t payload_type = 30;
+
+  RtpDemuxerCriteria pt_criteria;
+  pt_criteria.payload_types = {payload_type};
+  NiceMock<MockRtpPacketSink> pt_sink;
+  AddSink(pt_criteria, &pt_sink);
+
+  auto packet = CreatePacketWithSsrcRsid(ssrc, rsid);
+  packet->SetPayloadType(payload_type);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+
+  MockRtpPacketSink rsid_sink;
+  AddSinkOnlyRsid(rsid, &rsid_sink);
+
+  auto packet_ssrc_only = CreatePacketWithSsrc(ssrc);
+  packet_ssrc_only->SetPayloadType(payload_type);
+  EXPECT_CALL(pt_sink, OnRtpPacket(_)).Times(0);
+  EXPECT_CALL(rsid_sink, OnRtpPacket(SamePacketAs(*packet_ssrc_only)))
+      .Times(1);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_ssrc_only));
+}
+
+TEST_F(RtpDemuxerTest, RemovedSinkNoLongerReceivesRoutedSsrc) {
+  constexpr uint32_t ssrc = 10;
+
+  MockRtpPacketSink sink;
+  AddSinkOnlySsrc(ssrc, &sink);
+
+  auto packet = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(sink, OnRtpPacket(_)).Times(1);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+
+  RemoveSink(&sink);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet));
+}
+
+TEST_F(RtpDemuxerTest, SsrcNotBoundDueToLimitIsNotRoutedFromCache) {
+  constexpr uint8_t payload_type = 30;
+  constexpr uint8_t other_payload_type = 31;
+
+  RtpDemuxerCriteria pt_criteria;
+  pt_criteria.payload_types = {payload_type};
+  NiceMock<MockRtpPacketSink> sink;
+  AddSink(pt_criteria, &sink);
+
+  for (int i = 0; i < RtpDemuxer::kMaxSsrcBindings; i++) {
+    auto packet = CreatePacketWithSsrc(i);
+    packet->SetPayloadType(payload_type);
+    EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+  }
+  // Dropping a packet forgets the routing of its SSRC, but not the binding.
+  auto packet_unknown_mid = CreatePacketWithSsrcMid(0, "a");
+  packet_unknown_mid->SetPayloadType(payload_type);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_unknown_mid));
+
+  // The limit has been reached, so the new SSRC is routed by payload type
+  // without being bound to the sink, and has to be resolved again for every
+  // packet.
+  constexpr uint32_t unbound_ssrc = RtpDemuxer::kMaxSsrcBindings;
+  auto packet = CreatePacketWithSsrc(unbound_ssrc);
+  packet->SetPayloadType(payload_type);
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet));
+
+  auto packet_other_payload_type = CreatePacketWithSsrc(unbound_ssrc);
+  packet_other_payload_type->SetPayloadType(other_payload_type);
+  EXPECT_CALL(sink, OnRtpPacket(SamePacketAs(*packet_other_payload_type)))
+      .Times(0);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_other_payload_type));
+}
+
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
 
 TEST_F(RtpDemuxerTest, CriteriaMustBeNonEmpty) {
@@ -0,0 +1,508 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "call/rtp_stream_forwarder.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "call/rtp_transport_controller_send_interface.h"
+#include "modules/include/module_common_types_public.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/fir.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/nack.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/pli.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_generic_frame_descriptor.h"
+#include "modules/rtp_rtcp/source/rtp_generic_frame_descriptor_extension.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+namespace {
+
+constexpr int64_t kBitrateWindowMs = 1000;
+constexpr int64_t kMinKeyFrameRequestIntervalMs = 500;
+constexpr int kVideoPayloadTypeFrequencyKhz = 90;
+constexpr uint16_t kPictureIdMask = 0x7FFF;
+
+// Positions of the fields in a VP8 payload descriptor that need rewriting,
+// see RFC 7741, section 4.2.
+struct Vp8DescriptorFields {
+  absl::optional<size_t> picture_id_pos;
+  bool long_picture_id = false;
+  absl::optional<size_t> tl0_pic_idx_pos;
+};
+
+bool ParseVp8Descriptor(const uint8_t* payload,
+                        size_t size,
+                        Vp8DescriptorFields* fields) {
+  if (size < 1)
+    return false;
+  const bool has_extension = payload[0] & 0x80;
+  if (!has_extension)
+    return true;
+  if (size < 2)
+    return false;
+  const uint8_t extension = payload[1];
+  size_t pos = 2;
+  if (extension & 0x80) {
+    if (size < pos + 1)
+      return false;
+    fields->picture_id_pos = pos;
+    fields->long_picture_id = payload[pos] & 0x80;
+    pos += fields->long_picture_id ? 2 : 1;
+  }
+  if (extension & 0x40) {
+    if (size < pos + 1)
+      return false;
+    fields->tl0_pic_idx_pos = pos;
+  }
+  return true;
+}
+
+uint16_t ReadPictureId(const uint8_t* payload,
+                       const Vp8DescriptorFields& fields) {
+  const uint8_t* data = payload + *fields.picture_id_pos;
+  if (!fields.long_picture_id)
+    return data[0] & 0x7F;
+  return ((data[0] & 0x7F) << 8) | data[1];
+}
+
+void WritePictureId(uint16_t picture_id,
+                    uint8_t* payload,
+                    const Vp8DescriptorFields& fields) {
+  uint8_t* data = payload + *fields.picture_id_pos;
+  if (!fields.long_picture_id) {
+    data[0] = picture_id & 0x7F;
+    return;
+  }
+  data[0] = 0x80 | ((picture_id >> 8) & 0x7F);
+  data[1] = picture_id & 0xFF;
+}
+
+}  // namespace
+
+RtpStreamForwarder::Config::Config() = default;
+RtpStreamForwarder::Config::Config(const Config&) = default;
+RtpStreamForwarder::Config::~Config() = default;
+
+RtpStreamForwarder::RtpStreamForwarder(
+    Clock* clock,
+    const Config& config,
+    Transport* transport,
+    RtpTransportControllerSendInterface* transport_controller,
+    RtcpIntraFrameObserver* intra_frame_observer)
+    : clock_(clock),
+      config_(config),
+      extensions_(config.extensions),
+      transport_(transport),
+      pacer_(transport_controller ? transport_controller->packet_sender()
+                                  : nullptr),
+      packet_router_(transport_controller
+                         ? transport_controller->packet_router()
+                         : nullptr),
+      transport_feedback_observer_(
+          transport_controller
+              ? transport_controller->transport_feedback_observer()
+              : nullptr),
+      intra_frame_observer_(intra_frame_observer),
+      depacketizer_(RtpDepacketizer::Create(config.codec_type)),
+      packet_history_(clock),
+      layer_bitrates_(config.incoming_ssrcs.size(),
+                      RateStatistics(kBitrateWindowMs,
+                                     RateStatistics::kBpsScale)),
+      random_(clock->TimeInMicroseconds()),
+      rtx_sequence_number_(random_.Rand<uint16_t>()) {
+  RTC_DCHECK(transport_);
+  RTC_DCHECK(!config_.incoming_ssrcs.empty());
+  packet_history_.SetStorePacketsStatus(
+      RtpPacketHistory::StorageMode::kStoreAndCull,
+      config_.packet_history_size);
+  if (packet_router_)
+    packet_router_->AddSendPacketSender(config_.ssrc, this);
+}
+
+RtpStreamForwarder::~RtpStreamForwarder() {
+  if (packet_router_)
+    packet_router_->RemoveSendPacketSender(config_.ssrc);
+}
+
+void RtpStreamForwarder::OnRtpPacket(const RtpPacketReceived& packet) {
+  auto ssrc_it = std::find(config_.incoming_ssrcs.begin(),
+                           config_.incoming_ssrcs.end(), packet.Ssrc());
+  if (ssrc_it == config_.incoming_ssrcs.end())
+    return;
+  const size_t layer = ssrc_it - config_.incoming_ssrcs.begin();
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+
+  std::unique_ptr<RtpPacketToSend> forwarded_packet;
+  absl::optional<uint32_t> key_frame_request_ssrc;
+  {
+    rtc::CritScope lock(&crit_);
+    layer_bitrates_[layer].Update(packet.size(), now_ms);
+    if (layer != current_layer_) {
+      if (layer != target_layer_)
+        return;
+      if (!IsKeyFrameStart(packet)) {
+        // Nothing is forwarded until the first key frame.
+        if (!current_layer_ && ShouldRequestKeyFrame(now_ms))
+          key_frame_request_ssrc = packet.Ssrc();
+      } else {
+        SwitchToLayer(layer, packet, now_ms);
+      }
+    } else if (IsNewerSequenceNumber(first_sequence_number_,
+                                     packet.SequenceNumber())) {
+      // Sent before the key frame the layer was switched on.
+      return;
+    }
+
+    if (layer == current_layer_) {
+      forwarded_packet =
+          absl::make_unique<RtpPacketToSend>(&extensions_, IP_PACKET_SIZE);
+      forwarded_packet->SetMarker(packet.Marker());
+      forwarded_packet->SetPayloadType(packet.PayloadType());
+      forwarded_packet->SetSequenceNumber(packet.SequenceNumber() +
+                                          sequence_number_offset_);
+      forwarded_packet->SetTimestamp(packet.Timestamp() + timestamp_offset_);
+      forwarded_packet->SetSsrc(config_.ssrc);
+      forwarded_packet->set_capture_time_ms(packet.arrival_time_ms());
+      CopyHeaderExtensions(packet, forwarded_packet.get());
+      uint8_t* payload =
+          forwarded_packet->AllocatePayload(packet.payload_size());
+      memcpy(payload, packet.payload().data(), packet.payload_size());
+      if (config_.codec_type == kVideoCodecVP8)
+        RewriteVp8PayloadDescriptor(payload, packet.payload_size());
+      // Padding is forwarded too, since the receiver would otherwise see the
+      // sequence numbers it takes as lost.
+      if (packet.padding_size() > 0)
+        forwarded_packet->SetPadding(packet.padding_size(), &random_);
+
+      if (!last_sequence_number_ ||
+          IsNewerTimestamp(forwarded_packet->Timestamp(), last_timestamp_)) {
+        last_timestamp_ = forwarded_packet->Timestamp();
+        last_timestamp_time_ms_ = now_ms;
+      }
+      if (!last_sequence_number_ ||
+          IsNewerSequenceNumber(forwarded_packet->SequenceNumber(),
+                                *last_sequence_number_)) {
+        last_sequence_number_ = forwarded_packet->SequenceNumber();
+      }
+    }
+  }
+
+  if (key_frame_request_ssrc && intra_frame_observer_)
+    intra_frame_observer_->OnReceivedIntraFrameRequest(*key_frame_request_ssrc);
+  if (!forwarded_packet)
+    return;
+
+  if (pacer_) {
+    const uint16_t sequence_number = forwarded_packet->SequenceNumber();
+    const int64_t capture_time_ms = forwarded_packet->capture_time_ms();
+    const size_t size = forwarded_packet->size();
+    packet_history_.PutRtpPacket(std::move(forwarded_packet),
+                                 kAllowRetransmission, absl::nullopt);
+    pacer_->InsertPacket(RtpPacketSender::kNormalPriority, config_.ssrc,
+                         sequence_number, capture_time_ms, size, false);
+  } else {
+    SendPacket(forwarded_packet.get(), false, PacedPacketInfo());
+    packet_history_.PutRtpPacket(std::move(forwarded_packet),
+                                 kAllowRetransmission, now_ms);
+  }
+}
+
+void RtpStreamForwarder::OnBitrateUpdated(uint32_t bitrate_bps) {
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  absl::optional<uint32_t> key_frame_request_ssrc;
+  {
+    rtc::CritScope lock(&crit_);
+    // The highest layer that fits. Layers that are not received are skipped.
+    size_t target_layer = 0;
+    for (size_t layer = 0; layer < layer_bitrates_.size(); ++layer) {
+      absl::optional<uint32_t> layer_bitrate_bps =
+          layer_bitrates_[layer].Rate(now_ms);
+      if (layer_bitrate_bps && *layer_bitrate_bps <= bitrate_bps)
+        target_layer = layer;
+    }
+    if (target_layer != target_layer_) {
+      RTC_LOG(LS_INFO) << "Forwarding layer " << target_layer << " of SSRC "
+                       << config_.ssrc << " at " << bitrate_bps << " bps.";
+      target_layer_ = target_layer;
+      last_key_frame_request_ms_ = -1;
+    }
+    if (target_layer_ != current_layer_ && ShouldRequestKeyFrame(now_ms))
+      key_frame_request_ssrc = config_.incoming_ssrcs[target_layer_];
+  }
+  if (key_frame_request_ssrc && intra_frame_observer_)
+    intra_frame_observer_->OnReceivedIntraFrameRequest(*key_frame_request_ssrc);
+}
+
+bool RtpStreamForwarder::DeliverRtcp(const uint8_t* packet, size_t length) {
+  const uint8_t* const packet_end = packet + length;
+  rtcp::CommonHeader header;
+  for (const uint8_t* next_block = packet; next_block != packet_end;
+       next_block = header.NextPacket()) {
+    if (!header.Parse(next_block, packet_end - next_block))
+      return false;
+    if (header.type() == rtcp::Rtpfb::kPacketType &&
+        header.fmt() == rtcp::Nack::kFeedbackMessageType) {
+      rtcp::Nack nack;
+      if (nack.Parse(header) && nack.media_ssrc() == config_.ssrc)
+        RetransmitPackets(nack.packet_ids());
+    } else if (header.type() == rtcp::Psfb::kPacketType &&
+               header.fmt() == rtcp::Pli::kFeedbackMessageType) {
+      rtcp::Pli pli;
+      if (pli.Parse(header) && pli.media_ssrc() == config_.ssrc)
+        OnReceivedIntraFrameRequest();
+    } else if (header.type() == rtcp::Psfb::kPacketType &&
+               header.fmt() == rtcp::Fir::kFeedbackMessageType) {
+      rtcp::Fir fir;
+      if (!fir.Parse(header))
+        continue;
+      for (const rtcp::Fir::Request& request : fir.requests()) {
+        if (request.ssrc == config_.ssrc) {
+          OnReceivedIntraFrameRequest();
+          break;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void RtpStreamForwarder::OnRttUpdate(int64_t rtt_ms) {
+  packet_history_.SetRtt(rtt_ms);
+}
+
+void RtpStreamForwarder::OnReceivedNack(
+    const std::vector<uint16_t>& sequence_numbers,
+    int64_t rtt_ms) {
+  packet_history_.SetRtt(rtt_ms);
+  RetransmitPackets(sequence_numbers);
+}
+
+void RtpStreamForwarder::RetransmitPackets(
+    const std::vector<uint16_t>& sequence_numbers) {
+  for (uint16_t sequence_number : sequence_numbers) {
+    if (pacer_) {
+      absl::optional<RtpPacketHistory::PacketState> state =
+          packet_history_.GetPacketState(sequence_number, true);
+      if (!state)
+        continue;
+      pacer_->InsertPacket(RtpPacketSender::kNormalPriority, config_.ssrc,
+                           sequence_number, state->capture_time_ms,
+                           state->payload_size + kRtxHeaderSize, true);
+    } else {
+      std::unique_ptr<RtpPacketToSend> packet =
+          packet_history_.GetPacketAndSetSendTime(sequence_number, true);
+      if (packet)
+        SendPacket(packet.get(), true, PacedPacketInfo());
+    }
+  }
+}
+
+void RtpStreamForwarder::OnReceivedIntraFrameRequest() {
+  uint32_t ssrc;
+  {
+    rtc::CritScope lock(&crit_);
+    ssrc = config_.incoming_ssrcs[current_layer_.value_or(target_layer_)];
+  }
+  if (intra_frame_observer_)
+    intra_frame_observer_->OnReceivedIntraFrameRequest(ssrc);
+}
+
+absl::optional<size_t> RtpStreamForwarder::current_layer() const {
+  rtc::CritScope lock(&crit_);
+  return current_layer_;
+}
+
+bool RtpStreamForwarder::TimeToSendPacket(uint32_t ssrc,
+                                          uint16_t sequence_number,
+                                          int64_t capture_time_ms,
+                                          bool retransmission,
+                                          const PacedPacketInfo& cluster_info) {
+  if (ssrc != config_.ssrc)
+    return true;
+  std::unique_ptr<RtpPacketToSend> packet =
+      packet_history_.GetPacketAndSetSendTime(sequence_number,
+                                              retransmission);
+  if (!packet) {
+    // Packet cannot be found or was resent too recently.
+    return true;
+  }
+  return SendPacket(packet.get(), retransmission, cluster_info);
+}
+
+size_t RtpStreamForwarder::TimeToSendPadding(
+    size_t bytes,
+    const PacedPacketInfo& cluster_info) {
+  // Probing is left to the media streams of the sending session.
+  return 0;
+}
+
+void RtpStreamForwarder::CopyHeaderExtensions(
+    const RtpPacketReceived& packet,
+    RtpPacketToSend* forwarded_packet) {
+  RtpGenericFrameDescriptor descriptor;
+  if (packet.GetExtension<RtpGenericFrameDescriptorExtension>(&descriptor))
+    forwarded_packet->SetExtension<RtpGenericFrameDescriptorExtension>(
+        descriptor);
+  VideoRotation rotation;
+  if (packet.GetExtension<VideoOrientation>(&rotation))
+    forwarded_packet->SetExtension<VideoOrientation>(rotation);
+  VideoContentType content_type;
+  if (packet.GetExtension<VideoContentTypeExtension>(&content_type))
+    forwarded_packet->SetExtension<VideoContentTypeExtension>(content_type);
+  PlayoutDelay playout_delay;
+  if (packet.GetExtension<PlayoutDelayLimits>(&playout_delay))
+    forwarded_packet->SetExtension<PlayoutDelayLimits>(playout_delay);
+  // Written in SendPacket(). Reserving fails if not negotiated.
+  forwarded_packet->ReserveExtension<AbsoluteSendTime>();
+  forwarded_packet->ReserveExtension<TransportSequenceNumber>();
+}
+
+bool RtpStreamForwarder::IsKeyFrameStart(const RtpPacketReceived& packet) {
+  RtpGenericFrameDescriptor descriptor;
+  if (packet.GetExtension<RtpGenericFrameDescriptorExtension>(&descriptor)) {
+    return descriptor.FirstPacketInSubFrame() &&
+           descriptor.FrameDependenciesDiffs().empty();
+  }
+  if (packet.payload_size() == 0)
+    return false;
+  RtpDepacketizer::ParsedPayload parsed_payload;
+  if (!depacketizer_->Parse(&parsed_payload, packet.payload().data(),
+                            packet.payload_size())) {
+    return false;
+  }
+  return parsed_payload.frame_type == kVideoFrameKey &&
+         parsed_payload.video_header().is_first_packet_in_frame;
+}
+
+bool RtpStreamForwarder::ShouldRequestKeyFrame(int64_t now_ms) {
+  if (last_key_frame_request_ms_ >= 0 &&
+      now_ms - last_key_frame_request_ms_ < kMinKeyFrameRequestIntervalMs) {
+    return false;
+  }
+  last_key_frame_request_ms_ = now_ms;
+  return true;
+}
+
+void RtpStreamForwarder::SwitchToLayer(size_t layer,
+                                       const RtpPacketReceived& packet,
+                                       int64_t now_ms) {
+  if (last_sequence_number_) {
+    sequence_number_offset_ =
+        *last_sequence_number_ + 1 - packet.SequenceNumber();
+    // Continue the timestamps as if the key frame was captured now.
+    const uint32_t elapsed = std::max<int64_t>(
+        1, (now_ms - last_timestamp_time_ms_) * kVideoPayloadTypeFrequencyKhz);
+    timestamp_offset_ = last_timestamp_ + elapsed - packet.Timestamp();
+  }
+  if (config_.codec_type == kVideoCodecVP8) {
+    Vp8DescriptorFields fields;
+    const uint8_t* payload = packet.payload().data();
+    if (ParseVp8Descriptor(payload, packet.payload_size(), &fields)) {
+      if (fields.picture_id_pos && last_picture_id_) {
+        picture_id_offset_ =
+            (*last_picture_id_ + 1 - ReadPictureId(payload, fields)) &
+            kPictureIdMask;
+      }
+      if (fields.tl0_pic_idx_pos && last_tl0_pic_idx_) {
+        tl0_pic_idx_offset_ =
+            *last_tl0_pic_idx_ + 1 - payload[*fields.tl0_pic_idx_pos];
+      }
+    }
+  }
+  current_layer_ = layer;
+  first_sequence_number_ = packet.SequenceNumber();
+  last_key_frame_request_ms_ = -1;
+}
+
+void RtpStreamForwarder::RewriteVp8PayloadDescriptor(uint8_t* payload,
+                                                     size_t size) {
+  Vp8DescriptorFields fields;
+  if (!ParseVp8Descriptor(payload, size, &fields))
+    return;
+  if (fields.picture_id_pos) {
+    const uint16_t picture_id =
+        (ReadPictureId(payload, fields) + picture_id_offset_) &
+        kPictureIdMask;
+    WritePictureId(picture_id, payload, fields);
+    last_picture_id_ = picture_id;
+  }
+  if (fields.tl0_pic_idx_pos) {
+    payload[*fields.tl0_pic_idx_pos] += tl0_pic_idx_offset_;
+    last_tl0_pic_idx_ = payload[*fields.tl0_pic_idx_pos];
+  }
+}
+
+std::unique_ptr<RtpPacketToSend> RtpStreamForwarder::BuildRtxPacket(
+    const RtpPacketToSend& packet) {
+  auto rtx_payload_type = config_.rtx_payload_types.find(packet.PayloadType());
+  if (rtx_payload_type == config_.rtx_payload_types.end())
+    return nullptr;
+
+  auto rtx_packet = absl::make_unique<RtpPacketToSend>(
+      &extensions_, packet.size() + kRtxHeaderSize);
+  rtx_packet->CopyHeaderFrom(packet);
+  rtx_packet->SetPayloadType(rtx_payload_type->second);
+  rtx_packet->SetSsrc(*config_.rtx_ssrc);
+  {
+    rtc::CritScope lock(&rtx_crit_);
+    rtx_packet->SetSequenceNumber(rtx_sequence_number_++);
+  }
+  uint8_t* rtx_payload =
+      rtx_packet->AllocatePayload(packet.payload_size() + kRtxHeaderSize);
+  // Add OSN (original sequence number).
+  ByteWriter<uint16_t>::WriteBigEndian(rtx_payload, packet.SequenceNumber());
+  memcpy(rtx_payload + kRtxHeaderSize, packet.payload().data(),
+         packet.payload_size());
+  return rtx_packet;
+}
+
+bool RtpStreamForwarder::SendPacket(RtpPacketToSend* packet,
+                                    bool retransmission,
+                                    const PacedPacketInfo& pacing_info) {
+  std::unique_ptr<RtpPacketToSend> rtx_packet;
+  if (retransmission && config_.rtx_ssrc)
+    rtx_packet = BuildRtxPacket(*packet);
+  RtpPacketToSend* packet_to_send = rtx_packet ? rtx_packet.get() : packet;
+
+  PacketOptions options;
+  options.is_retransmit = retransmission;
+  if (packet_to_send->HasExtension<AbsoluteSendTime>()) {
+    packet_to_send->SetExtension<AbsoluteSendTime>(
+        AbsoluteSendTime::MsTo24Bits(clock_->TimeInMilliseconds()));
+  }
+  if (packet_router_ &&
+      packet_to_send->HasExtension<TransportSequenceNumber>()) {
+    options.packet_id = packet_router_->AllocateSequenceNumber();
+    packet_to_send->SetExtension<TransportSequenceNumber>(options.packet_id);
+    if (transport_feedback_observer_) {
+      transport_feedback_observer_->AddPacket(
+          packet_to_send->Ssrc(), options.packet_id,
+          packet_to_send->payload_size() + packet_to_send->padding_size(),
+          pacing_info);
+    }
+  }
+  return transport_->SendRtp(packet_to_send->data(), packet_to_send->size(),
+                             options);
+}
+
+}  // namespace webrtc
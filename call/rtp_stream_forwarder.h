@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef CALL_RTP_STREAM_FORWARDER_H_
+#define CALL_RTP_STREAM_FORWARDER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/call/transport.h"
+#include "api/rtpparameters.h"
+#include "call/rtp_packet_sink_interface.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "modules/pacing/paced_sender.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtp_format.h"
+#include "modules/rtp_rtcp/source/rtp_packet_history.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/random.h"
+#include "rtc_base/rate_statistics.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+class Clock;
+class PacketRouter;
+class RtpPacketToSend;
+class RtpTransportControllerSendInterface;
+
+// Forwards one video stream from a receiving to a sending RTP session without
+// decoding it, as a selective forwarding unit does. Incoming packets are
+// delivered to OnRtpPacket(), e.g. by registering the forwarder as a demuxer
+// sink of the receiving RtpTransport, and are sent on |transport| with SSRC,
+// sequence numbers, timestamps and, for VP8, picture IDs rewritten, so that
+// the receiver sees a single continuous stream. The generic frame descriptor,
+// video rotation, content type and playout delay header extensions are
+// carried over to the ids of |Config::extensions|; the transport sequence
+// number and absolute send time are written when the packet is sent.
+//
+// The stream may be received as several simulcast layers with one SSRC each.
+// The forwarder sends the highest layer whose incoming bitrate fits the
+// bitrate estimate of the receiver, passed to OnBitrateUpdated(). It only
+// switches layer on a key frame of the new layer, which it requests from the
+// sender through |intra_frame_observer|. Key frames are found with the
+// generic frame descriptor if the packets carry it, and otherwise by parsing
+// the payload.
+//
+// Forwarded packets are kept in an RtpPacketHistory, from which NACKs of the
+// receiver are served, over RTX if configured. RTCP of the sending session is
+// passed to DeliverRtcp(), which handles the NACKs and key frame requests for
+// |Config::ssrc|. With a |transport_controller|, the forwarder registers its
+// SSRC with the PacketRouter, which calls TimeToSendPacket() when the pacer
+// releases a packet, and sent packets are reported for transport feedback.
+// Otherwise packets are sent right away.
+class RtpStreamForwarder : public RtpPacketSinkInterface,
+                           public PacedSender::PacketSender {
+ public:
+  struct Config {
+    Config();
+    Config(const Config&);
+    ~Config();
+
+    VideoCodecType codec_type = kVideoCodecVP8;
+    // The SSRCs of the incoming simulcast layers, lowest resolution first.
+    std::vector<uint32_t> incoming_ssrcs;
+    // The SSRC of the outgoing stream, and of its RTX stream.
+    uint32_t ssrc = 0;
+    absl::optional<uint32_t> rtx_ssrc;
+    // Maps media payload types to their RTX payload types.
+    std::map<int, int> rtx_payload_types;
+    // The header extensions negotiated for the outgoing stream.
+    std::vector<RtpExtension> extensions;
+    // Number of sent packets kept for retransmission.
+    size_t packet_history_size = 600;
+  };
+
+  // |transport_controller| and |intra_frame_observer| may be null.
+  RtpStreamForwarder(Clock* clock,
+                     const Config& config,
+                     Transport* transport,
+                     RtpTransportControllerSendInterface* transport_controller,
+                     RtcpIntraFrameObserver* intra_frame_observer);
+  ~RtpStreamForwarder() override;
+
+  // Implements RtpPacketSinkInterface.
+  void OnRtpPacket(const RtpPacketReceived& packet) override;
+
+  // Handles the NACKs and key frame requests for |Config::ssrc| in a compound
+  // RTCP packet of the receiver. Returns false if the packet can't be parsed.
+  bool DeliverRtcp(const uint8_t* packet, size_t length);
+  void OnRttUpdate(int64_t rtt_ms);
+
+  // Selects the layer to forward from the bitrate estimate of the receiver.
+  void OnBitrateUpdated(uint32_t bitrate_bps);
+  // Retransmits packets NACKed by the receiver.
+  void OnReceivedNack(const std::vector<uint16_t>& sequence_numbers,
+                      int64_t rtt_ms);
+  // Passes a key frame request of the receiver on to the sender.
+  void OnReceivedIntraFrameRequest();
+
+  // The index in |incoming_ssrcs| of the layer being forwarded, if any.
+  absl::optional<size_t> current_layer() const;
+
+  // Implements PacedSender::PacketSender, called through the PacketRouter.
+  bool TimeToSendPacket(uint32_t ssrc,
+                        uint16_t sequence_number,
+                        int64_t capture_time_ms,
+                        bool retransmission,
+                        const PacedPacketInfo& cluster_info) override;
+  size_t TimeToSendPadding(size_t bytes,
+                           const PacedPacketInfo& cluster_info) override;
+
+ private:
+  void RetransmitPackets(const std::vector<uint16_t>& sequence_numbers);
+  // Copies the header extensions that describe the frame from |packet|, and
+  // reserves those written at send time.
+  void CopyHeaderExtensions(const RtpPacketReceived& packet,
+                            RtpPacketToSend* forwarded_packet);
+  bool IsKeyFrameStart(const RtpPacketReceived& packet);
+  // Limits the rate of key frame requests to the sender.
+  bool ShouldRequestKeyFrame(int64_t now_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Sets the offsets so that the key frame starting with |packet| continues
+  // the outgoing stream.
+  void SwitchToLayer(size_t layer,
+                     const RtpPacketReceived& packet,
+                     int64_t now_ms) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Rewrites the VP8 picture ID and TL0PICIDX of |payload| in place.
+  void RewriteVp8PayloadDescriptor(uint8_t* payload, size_t size)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  std::unique_ptr<RtpPacketToSend> BuildRtxPacket(
+      const RtpPacketToSend& packet);
+  bool SendPacket(RtpPacketToSend* packet,
+                  bool retransmission,
+                  const PacedPacketInfo& pacing_info);
+
+  Clock* const clock_;
+  const Config config_;
+  const RtpHeaderExtensionMap extensions_;
+  Transport* const transport_;
+  RtpPacketSender* const pacer_;
+  PacketRouter* const packet_router_;
+  TransportFeedbackObserver* const transport_feedback_observer_;
+  RtcpIntraFrameObserver* const intra_frame_observer_;
+  const std::unique_ptr<RtpDepacketizer> depacketizer_;
+  RtpPacketHistory packet_history_;
+
+  rtc::CriticalSection crit_;
+  std::vector<RateStatistics> layer_bitrates_ RTC_GUARDED_BY(crit_);
+  absl::optional<size_t> current_layer_ RTC_GUARDED_BY(crit_);
+  size_t target_layer_ RTC_GUARDED_BY(crit_) = 0;
+  int64_t last_key_frame_request_ms_ RTC_GUARDED_BY(crit_) = -1;
+
+  // Added to the incoming values of |current_layer_|.
+  uint16_t sequence_number_offset_ RTC_GUARDED_BY(crit_) = 0;
+  uint32_t timestamp_offset_ RTC_GUARDED_BY(crit_) = 0;
+  uint16_t picture_id_offset_ RTC_GUARDED_BY(crit_) = 0;
+  uint8_t tl0_pic_idx_offset_ RTC_GUARDED_BY(crit_) = 0;
+  // The incoming sequence number of the first forwarded packet of
+  // |current_layer_|. Older packets of the layer are dropped.
+  uint16_t first_sequence_number_ RTC_GUARDED_BY(crit_) = 0;
+
+  // The most recent outgoing values.
+  absl::optional<uint16_t> last_sequence_number_ RTC_GUARDED_BY(crit_);
+  uint32_t last_timestamp_ RTC_GUARDED_BY(crit_) = 0;
+  int64_t last_timestamp_time_ms_ RTC_GUARDED_BY(crit_) = 0;
+  absl::optional<uint16_t> last_picture_id_ RTC_GUARDED_BY(crit_);
+  absl::optional<uint8_t> last_tl0_pic_idx_ RTC_GUARDED_BY(crit_);
+  Random random_ RTC_GUARDED_BY(crit_);
+
+  rtc::CriticalSection rtx_crit_;
+  uint16_t rtx_sequence_number_ RTC_GUARDED_BY(rtx_crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RtpStreamForwarder);
+};
+
+}  // namespace webrtc
+
+#endif  // CALL_RTP_STREAM_FORWARDER_H_
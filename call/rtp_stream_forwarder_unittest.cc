@@ -0,0 +1,442 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "call/rtp_stream_forwarder.h"
+
+#include <vector>
+
+#include "call/test/mock_rtp_transport_controller_send.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/compound_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/nack.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/pli.h"
+#include "modules/rtp_rtcp/source/rtp_generic_frame_descriptor_extension.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+constexpr uint32_t kLowSsrc = 1000;
+constexpr uint32_t kHighSsrc = 2000;
+constexpr uint32_t kSsrc = 3000;
+constexpr uint32_t kRtxSsrc = 3001;
+constexpr int kPayloadType = 96;
+constexpr int kRtxPayloadType = 97;
+constexpr int kFrameIntervalMs = 33;
+constexpr int kIncomingVideoRotationId = 4;
+constexpr int kIncomingGenericDescriptorId = 5;
+constexpr int kVideoRotationId = 7;
+constexpr int kGenericDescriptorId = 8;
+constexpr int kTransportSequenceNumberId = 9;
+constexpr int kAbsSendTimeId = 10;
+
+class RecordingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* packet,
+               size_t length,
+               const PacketOptions& options) override {
+    packets_.emplace_back();
+    EXPECT_TRUE(packets_.back().Parse(packet, length));
+    retransmissions_.push_back(options.is_retransmit);
+    return true;
+  }
+  bool SendRtcp(const uint8_t* packet, size_t length) override {
+    return false;
+  }
+
+  const std::vector<RtpPacketReceived>& packets() const { return packets_; }
+  const std::vector<bool>& retransmissions() const { return retransmissions_; }
+
+ private:
+  std::vector<RtpPacketReceived> packets_;
+  std::vector<bool> retransmissions_;
+};
+
+class MockRtcpIntraFrameObserver : public RtcpIntraFrameObserver {
+ public:
+  MOCK_METHOD1(OnReceivedIntraFrameRequest, void(uint32_t ssrc));
+};
+
+class MockTransportFeedbackObserver : public TransportFeedbackObserver {
+ public:
+  MOCK_METHOD4(AddPacket,
+               void(uint32_t ssrc,
+                    uint16_t sequence_number,
+                    size_t length,
+                    const PacedPacketInfo& pacing_info));
+  MOCK_METHOD1(OnTransportFeedback,
+               void(const rtcp::TransportFeedback& feedback));
+};
+
+class MockRtpPacketSender : public RtpPacketSender {
+ public:
+  MOCK_METHOD6(InsertPacket,
+               void(Priority priority,
+                    uint32_t ssrc,
+                    uint16_t sequence_number,
+                    int64_t capture_time_ms,
+                    size_t bytes,
+                    bool retransmission));
+};
+
+// The state of one incoming VP8 stream.
+struct IncomingStream {
+  uint32_t ssrc;
+  uint16_t sequence_number;
+  uint32_t timestamp;
+  uint16_t picture_id;
+  uint8_t tl0_pic_idx;
+};
+
+class RtpStreamForwarderTest : public ::testing::Test {
+ protected:
+  RtpStreamForwarderTest()
+      : clock_(123456),
+        low_stream_{kLowSsrc, 100, 1000, 10, 20},
+        high_stream_{kHighSsrc, 60000, 500000, 30000, 200} {
+    config_.incoming_ssrcs = {kLowSsrc, kHighSsrc};
+    config_.ssrc = kSsrc;
+    config_.rtx_ssrc = kRtxSsrc;
+    config_.rtx_payload_types[kPayloadType] = kRtxPayloadType;
+    ON_CALL(transport_controller_, packet_router())
+        .WillByDefault(Return(&packet_router_));
+    ON_CALL(transport_controller_, packet_sender())
+        .WillByDefault(Return(&pacer_));
+    ON_CALL(transport_controller_, transport_feedback_observer())
+        .WillByDefault(Return(&transport_feedback_observer_));
+  }
+
+  void CreateForwarder(bool with_transport_controller) {
+    forwarder_.reset(new RtpStreamForwarder(
+        &clock_, config_, &transport_,
+        with_transport_controller ? &transport_controller_ : nullptr,
+        &intra_frame_observer_));
+  }
+
+  // Delivers a one packet VP8 frame of |size| bytes on |stream|. Header
+  // extensions of the packet are written by |set_extensions|.
+  template <typename SetExtensions>
+  void DeliverFrame(IncomingStream* stream,
+                    bool key_frame,
+                    size_t size,
+                    SetExtensions set_extensions) {
+    RtpPacketReceived packet(&incoming_extensions_);
+    set_extensions(&packet);
+    packet.SetPayloadType(kPayloadType);
+    packet.SetSsrc(stream->ssrc);
+    packet.SetSequenceNumber(stream->sequence_number++);
+    packet.SetTimestamp(stream->timestamp);
+    packet.SetMarker(true);
+    stream->timestamp += 90 * kFrameIntervalMs;
+    uint8_t* payload = packet.AllocatePayload(size);
+    memset(payload, 0, size);
+    // Payload descriptor with X and S bits, a 15 bit picture ID and a
+    // TL0PICIDX.
+    payload[0] = 0x90;
+    payload[1] = 0xC0;
+    payload[2] = 0x80 | (stream->picture_id >> 8);
+    payload[3] = stream->picture_id & 0xFF;
+    payload[4] = stream->tl0_pic_idx++;
+    stream->picture_id = (stream->picture_id + 1) & 0x7FFF;
+    // Payload header, with the P bit cleared for key frames.
+    payload[5] = key_frame ? 0x00 : 0x01;
+    forwarder_->OnRtpPacket(packet);
+  }
+  void DeliverFrame(IncomingStream* stream, bool key_frame, size_t size) {
+    DeliverFrame(stream, key_frame, size, [](RtpPacketReceived*) {});
+  }
+
+  // Delivers one second of frames on both streams, starting with key frames.
+  void DeliverBothStreams(bool start_with_key_frames) {
+    for (int i = 0; i < 1000 / kFrameIntervalMs; ++i) {
+      const bool key_frame = start_with_key_frames && i == 0;
+      DeliverFrame(&low_stream_, key_frame, 400);
+      DeliverFrame(&high_stream_, key_frame, 1200);
+      clock_.AdvanceTimeMilliseconds(kFrameIntervalMs);
+    }
+  }
+
+  static uint16_t PictureId(const RtpPacketReceived& packet) {
+    const uint8_t* payload = packet.payload().data();
+    return ((payload[2] & 0x7F) << 8) | payload[3];
+  }
+  static uint8_t Tl0PicIdx(const RtpPacketReceived& packet) {
+    return packet.payload()[4];
+  }
+
+  SimulatedClock clock_;
+  RtpStreamForwarder::Config config_;
+  RtpHeaderExtensionMap incoming_extensions_;
+  RecordingTransport transport_;
+  NiceMock<MockRtcpIntraFrameObserver> intra_frame_observer_;
+  PacketRouter packet_router_;
+  NiceMock<MockRtpPacketSender> pacer_;
+  NiceMock<MockTransportFeedbackObserver> transport_feedback_observer_;
+  NiceMock<MockRtpTransportControllerSend> transport_controller_;
+  std::unique_ptr<RtpStreamForwarder> forwarder_;
+  IncomingStream low_stream_;
+  IncomingStream high_stream_;
+};
+
+}  // namespace
+
+TEST_F(RtpStreamForwarderTest, ForwardsFromKeyFrameWithRewrittenSsrc) {
+  CreateForwarder(false);
+  EXPECT_CALL(intra_frame_observer_, OnReceivedIntraFrameRequest(kLowSsrc));
+  DeliverFrame(&low_stream_, false, 100);
+  EXPECT_TRUE(transport_.packets().empty());
+  EXPECT_FALSE(forwarder_->current_layer());
+
+  DeliverFrame(&low_stream_, true, 100);
+  DeliverFrame(&low_stream_, false, 100);
+  DeliverFrame(&high_stream_, true, 100);
+  ASSERT_EQ(2u, transport_.packets().size());
+  EXPECT_EQ(0u, *forwarder_->current_layer());
+  for (const RtpPacketReceived& packet : transport_.packets()) {
+    EXPECT_EQ(kSsrc, packet.Ssrc());
+    EXPECT_EQ(kPayloadType, packet.PayloadType());
+    EXPECT_EQ(100u, packet.payload_size());
+  }
+  EXPECT_EQ(static_cast<uint16_t>(transport_.packets()[0].SequenceNumber() + 1),
+            transport_.packets()[1].SequenceNumber());
+  EXPECT_EQ(transport_.packets()[0].Timestamp() + 90 * kFrameIntervalMs,
+            transport_.packets()[1].Timestamp());
+  EXPECT_EQ(PictureId(transport_.packets()[0]) + 1,
+            PictureId(transport_.packets()[1]));
+}
+
+TEST_F(RtpStreamForwarderTest, SwitchesLayerOnKeyFrameWhenBitrateAllows) {
+  CreateForwarder(false);
+  DeliverBothStreams(true);
+  EXPECT_EQ(0u, *forwarder_->current_layer());
+
+  // The high layer is about 300 kbps.
+  EXPECT_CALL(intra_frame_observer_, OnReceivedIntraFrameRequest(kHighSsrc));
+  forwarder_->OnBitrateUpdated(1000000);
+  // Delta frames of the high layer don't switch.
+  DeliverFrame(&high_stream_, false, 1200);
+  DeliverFrame(&low_stream_, false, 400);
+  EXPECT_EQ(0u, *forwarder_->current_layer());
+
+  const RtpPacketReceived last_low_packet = transport_.packets().back();
+  clock_.AdvanceTimeMilliseconds(kFrameIntervalMs);
+  DeliverFrame(&high_stream_, true, 1200);
+  DeliverFrame(&low_stream_, false, 400);
+  EXPECT_EQ(1u, *forwarder_->current_layer());
+  const RtpPacketReceived& key_frame_packet = transport_.packets().back();
+  EXPECT_EQ(1200u, key_frame_packet.payload_size());
+  EXPECT_EQ(kSsrc, key_frame_packet.Ssrc());
+  EXPECT_EQ(static_cast<uint16_t>(last_low_packet.SequenceNumber() + 1),
+            key_frame_packet.SequenceNumber());
+  EXPECT_EQ(last_low_packet.Timestamp() + 90 * kFrameIntervalMs,
+            key_frame_packet.Timestamp());
+  EXPECT_EQ(PictureId(last_low_packet) + 1, PictureId(key_frame_packet));
+  EXPECT_EQ(Tl0PicIdx(last_low_packet) + 1, Tl0PicIdx(key_frame_packet));
+
+  // And back down when the bitrate drops.
+  EXPECT_CALL(intra_frame_observer_, OnReceivedIntraFrameRequest(kLowSsrc));
+  forwarder_->OnBitrateUpdated(200000);
+  DeliverFrame(&low_stream_, true, 400);
+  EXPECT_EQ(0u, *forwarder_->current_layer());
+  EXPECT_EQ(static_cast<uint16_t>(key_frame_packet.SequenceNumber() + 1),
+            transport_.packets().back().SequenceNumber());
+}
+
+TEST_F(RtpStreamForwarderTest, RetransmitsNackedPacketsOverRtx) {
+  CreateForwarder(false);
+  DeliverFrame(&low_stream_, true, 100);
+  DeliverFrame(&low_stream_, false, 100);
+  ASSERT_EQ(2u, transport_.packets().size());
+  const uint16_t nacked_sequence_number =
+      transport_.packets()[0].SequenceNumber();
+
+  forwarder_->OnReceivedNack({nacked_sequence_number}, 10);
+  ASSERT_EQ(3u, transport_.packets().size());
+  const RtpPacketReceived& rtx_packet = transport_.packets()[2];
+  EXPECT_TRUE(transport_.retransmissions()[2]);
+  EXPECT_EQ(kRtxSsrc, rtx_packet.Ssrc());
+  EXPECT_EQ(kRtxPayloadType, rtx_packet.PayloadType());
+  EXPECT_EQ(102u, rtx_packet.payload_size());
+  EXPECT_EQ(nacked_sequence_number,
+            (rtx_packet.payload()[0] << 8) | rtx_packet.payload()[1]);
+
+  // Not again within the RTT.
+  forwarder_->OnReceivedNack({nacked_sequence_number}, 10);
+  EXPECT_EQ(3u, transport_.packets().size());
+}
+
+TEST_F(RtpStreamForwarderTest, SendsThroughPacerAndPacketRouter) {
+  CreateForwarder(true);
+  uint16_t sequence_number = 0;
+  EXPECT_CALL(pacer_, InsertPacket(RtpPacketSender::kNormalPriority, kSsrc, _,
+                                  _, _, false))
+      .WillOnce(Invoke([&](RtpPacketSender::Priority, uint32_t, uint16_t seq,
+                           int64_t, size_t, bool) { sequence_number = seq; }));
+  DeliverFrame(&low_stream_, true, 100);
+  EXPECT_TRUE(transport_.packets().empty());
+
+  EXPECT_TRUE(packet_router_.TimeToSendPacket(kSsrc, sequence_number,
+                                              clock_.TimeInMilliseconds(),
+                                              false, PacedPacketInfo()));
+  ASSERT_EQ(1u, transport_.packets().size());
+  EXPECT_EQ(sequence_number, transport_.packets()[0].SequenceNumber());
+
+  EXPECT_CALL(pacer_, InsertPacket(_, kSsrc, sequence_number, _, _, true));
+  clock_.AdvanceTimeMilliseconds(100);
+  forwarder_->OnReceivedNack({sequence_number}, 10);
+}
+
+TEST_F(RtpStreamForwarderTest, PassesIntraFrameRequestsToSender) {
+  CreateForwarder(false);
+  DeliverBothStreams(true);
+  EXPECT_CALL(intra_frame_observer_, OnReceivedIntraFrameRequest(kLowSsrc));
+  forwarder_->OnReceivedIntraFrameRequest();
+}
+
+TEST_F(RtpStreamForwarderTest, CarriesOverHeaderExtensions) {
+  incoming_extensions_.Register<VideoOrientation>(kIncomingVideoRotationId);
+  incoming_extensions_.Register<RtpGenericFrameDescriptorExtension>(
+      kIncomingGenericDescriptorId);
+  incoming_extensions_.Register<TransportSequenceNumber>(
+      kTransportSequenceNumberId);
+  config_.extensions = {
+      RtpExtension(RtpExtension::kVideoRotationUri, kVideoRotationId),
+      RtpExtension(RtpGenericFrameDescriptorExtension::kUri,
+                   kGenericDescriptorId),
+      RtpExtension(RtpExtension::kTransportSequenceNumberUri,
+                   kTransportSequenceNumberId),
+      RtpExtension(RtpExtension::kAbsSendTimeUri, kAbsSendTimeId)};
+  CreateForwarder(true);
+  EXPECT_CALL(pacer_, InsertPacket(_, kSsrc, _, _, _, false))
+      .WillOnce(Invoke([&](RtpPacketSender::Priority, uint32_t ssrc,
+                           uint16_t seq, int64_t capture_time_ms, size_t,
+                           bool retransmission) {
+        packet_router_.TimeToSendPacket(ssrc, seq, capture_time_ms,
+                                        retransmission, PacedPacketInfo());
+      }));
+  uint16_t reported_transport_sequence_number = 0;
+  EXPECT_CALL(transport_feedback_observer_, AddPacket(kSsrc, _, 100, _))
+      .WillOnce(SaveArg<1>(&reported_transport_sequence_number));
+
+  RtpGenericFrameDescriptor descriptor;
+  descriptor.SetFirstPacketInSubFrame(true);
+  descriptor.SetLastPacketInSubFrame(true);
+  descriptor.SetFrameId(123);
+  DeliverFrame(&low_stream_, true, 100, [&](RtpPacketReceived* packet) {
+    packet->SetExtension<VideoOrientation>(kVideoRotation_90);
+    packet->SetExtension<RtpGenericFrameDescriptorExtension>(descriptor);
+    packet->SetExtension<TransportSequenceNumber>(4321);
+  });
+
+  ASSERT_EQ(1u, transport_.packets().size());
+  const RtpHeaderExtensionMap extensions(config_.extensions);
+  RtpPacketReceived sent_packet(&extensions);
+  ASSERT_TRUE(sent_packet.Parse(transport_.packets()[0].Buffer()));
+  VideoRotation rotation;
+  EXPECT_TRUE(sent_packet.GetExtension<VideoOrientation>(&rotation));
+  EXPECT_EQ(kVideoRotation_90, rotation);
+  RtpGenericFrameDescriptor sent_descriptor;
+  EXPECT_TRUE(sent_packet.GetExtension<RtpGenericFrameDescriptorExtension>(
+      &sent_descriptor));
+  EXPECT_EQ(123, sent_descriptor.FrameId());
+  // The transport sequence number is the one of the sending session.
+  uint16_t transport_sequence_number;
+  EXPECT_TRUE(sent_packet.GetExtension<TransportSequenceNumber>(
+      &transport_sequence_number));
+  EXPECT_EQ(reported_transport_sequence_number, transport_sequence_number);
+  EXPECT_NE(4321, transport_sequence_number);
+  EXPECT_TRUE(sent_packet.HasExtension<AbsoluteSendTime>());
+  EXPECT_EQ(100u, sent_packet.payload_size());
+}
+
+TEST_F(RtpStreamForwarderTest, RetransmitsWithNewTransportSequenceNumber) {
+  incoming_extensions_.Register<TransportSequenceNumber>(
+      kTransportSequenceNumberId);
+  config_.extensions = {
+      RtpExtension(RtpExtension::kTransportSequenceNumberUri,
+                   kTransportSequenceNumberId),
+      RtpExtension(RtpExtension::kAbsSendTimeUri, kAbsSendTimeId)};
+  CreateForwarder(true);
+  ON_CALL(pacer_, InsertPacket(_, kSsrc, _, _, _, _))
+      .WillByDefault(Invoke([&](RtpPacketSender::Priority, uint32_t ssrc,
+                                uint16_t seq, int64_t capture_time_ms, size_t,
+                                bool retransmission) {
+        packet_router_.TimeToSendPacket(ssrc, seq, capture_time_ms,
+                                        retransmission, PacedPacketInfo());
+      }));
+  uint16_t reported_transport_sequence_number = 0;
+  uint16_t reported_rtx_transport_sequence_number = 0;
+  EXPECT_CALL(transport_feedback_observer_, AddPacket(kSsrc, _, 100, _))
+      .WillOnce(SaveArg<1>(&reported_transport_sequence_number));
+  EXPECT_CALL(transport_feedback_observer_, AddPacket(kRtxSsrc, _, 102, _))
+      .WillOnce(SaveArg<1>(&reported_rtx_transport_sequence_number));
+
+  DeliverFrame(&low_stream_, true, 100, [](RtpPacketReceived* packet) {
+    packet->SetExtension<TransportSequenceNumber>(4321);
+  });
+  ASSERT_EQ(1u, transport_.packets().size());
+  clock_.AdvanceTimeMilliseconds(100);
+  forwarder_->OnReceivedNack({transport_.packets()[0].SequenceNumber()}, 10);
+
+  ASSERT_EQ(2u, transport_.packets().size());
+  const RtpHeaderExtensionMap extensions(config_.extensions);
+  RtpPacketReceived rtx_packet(&extensions);
+  ASSERT_TRUE(rtx_packet.Parse(transport_.packets()[1].Buffer()));
+  EXPECT_EQ(kRtxSsrc, rtx_packet.Ssrc());
+  uint16_t transport_sequence_number;
+  EXPECT_TRUE(rtx_packet.GetExtension<TransportSequenceNumber>(
+      &transport_sequence_number));
+  EXPECT_EQ(reported_rtx_transport_sequence_number,
+            transport_sequence_number);
+  EXPECT_NE(reported_transport_sequence_number, transport_sequence_number);
+  uint32_t abs_send_time;
+  EXPECT_TRUE(rtx_packet.GetExtension<AbsoluteSendTime>(&abs_send_time));
+  EXPECT_EQ(AbsoluteSendTime::MsTo24Bits(clock_.TimeInMilliseconds()),
+            abs_send_time);
+}
+
+TEST_F(RtpStreamForwarderTest, HandlesRtcpForItsSsrc) {
+  CreateForwarder(false);
+  DeliverFrame(&low_stream_, true, 100);
+  ASSERT_EQ(1u, transport_.packets().size());
+  const uint16_t sequence_number = transport_.packets()[0].SequenceNumber();
+
+  rtcp::Nack other_nack;
+  other_nack.SetMediaSsrc(kSsrc + 1);
+  other_nack.SetPacketIds({sequence_number});
+  rtcp::Nack nack;
+  nack.SetMediaSsrc(kSsrc);
+  nack.SetPacketIds({sequence_number});
+  rtcp::Pli pli;
+  pli.SetMediaSsrc(kSsrc);
+  rtcp::CompoundPacket compound;
+  compound.Append(&other_nack);
+  compound.Append(&nack);
+  compound.Append(&pli);
+  rtc::Buffer rtcp_packet = compound.Build();
+
+  EXPECT_CALL(intra_frame_observer_, OnReceivedIntraFrameRequest(kLowSsrc));
+  EXPECT_TRUE(forwarder_->DeliverRtcp(rtcp_packet.data(), rtcp_packet.size()));
+  ASSERT_EQ(2u, transport_.packets().size());
+  EXPECT_EQ(kRtxSsrc, transport_.packets()[1].Ssrc());
+}
+
+}  // namespace webrtc
@@ -328,8 +328,9 @@ EncodedImageCallback::Result RtpVideoSender::OnEncodedImage(
   bool send_result = rtp_modules_[stream_index]->SendOutgoingData(
       encoded_image._frameType, rtp_config_.payload_type,
       encoded_image.Timestamp(), encoded_image.capture_time_ms_,
-      encoded_image._buffer, encoded_image._length, fragmentation,
-      &rtp_video_header, &frame_id);
+      encoded_image._buffer, encoded_image._length,
+      &encoded_image.shared_buffer_, fragmentation, &rtp_video_header,
+      &frame_id);
   if (!send_result)
     return Result(Result::ERROR_SEND_FAILED);
 
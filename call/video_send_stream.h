@@ -62,6 +62,10 @@ class VideoSendStream {
     int encode_frame_rate = 0;
     int avg_encode_time_ms = 0;
     int encode_usage_percent = 0;
+    // The share of the process-wide encoder CPU budget, if it is enabled, the
+    // encoder was last initialized with.
+    int encoder_cpu_budget_cores = 0;
+    bool encoder_cpu_budget_reduced_complexity = false;
     uint32_t frames_encoded = 0;
     uint32_t frames_dropped_by_capturer = 0;
     uint32_t frames_dropped_by_encoder_queue = 0;
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+// Returns the sum of the four 32-bit lanes of |x|.
+static inline int32_t HorizontalSum(__m128i x) {
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+// Returns the shifted products of the eight samples in |x| and |y|, summed in
+// pairs.
+static inline __m128i ShiftedProducts(__m128i x, __m128i y, __m128i shift) {
+  const __m128i low = _mm_mullo_epi16(x, y);
+  const __m128i high = _mm_mulhi_epi16(x, y);
+  return _mm_add_epi32(_mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift),
+                       _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift));
+}
+
+// Like the SSE2 version, sums the products after shifting each of them, in 32
+// bits, so the result is bit-exact. Works on 16 samples at a time, and on
+// eight for the remainder.
+static inline int32_t DotProductWithShiftAVX2(const int16_t* vector1,
+                                              const int16_t* vector2,
+                                              size_t length,
+                                              int right_shifts) {
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  __m256i sum = _mm256_setzero_si256();
+  __m128i sum128;
+  size_t i = 0;
+
+  if (right_shifts == 0) {
+    // The sum of two products only overflows for -32768 * -32768 twice, which
+    // wraps around to the same result.
+    for (; i + 16 <= length; i += 16) {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)&vector1[i]);
+      const __m256i y = _mm256_loadu_si256((const __m256i*)&vector2[i]);
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, y));
+    }
+    sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                           _mm256_extracti128_si256(sum, 1));
+    if (i + 8 <= length) {
+      const __m128i x = _mm_loadu_si128((const __m128i*)&vector1[i]);
+      const __m128i y = _mm_loadu_si128((const __m128i*)&vector2[i]);
+      sum128 = _mm_add_epi32(sum128, _mm_madd_epi16(x, y));
+      i += 8;
+    }
+  } else {
+    for (; i + 16 <= length; i += 16) {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)&vector1[i]);
+      const __m256i y = _mm256_loadu_si256((const __m256i*)&vector2[i]);
+      const __m256i low = _mm256_mullo_epi16(x, y);
+      const __m256i high = _mm256_mulhi_epi16(x, y);
+      sum = _mm256_add_epi32(
+          sum, _mm256_sra_epi32(_mm256_unpacklo_epi16(low, high), shift));
+      sum = _mm256_add_epi32(
+          sum, _mm256_sra_epi32(_mm256_unpackhi_epi16(low, high), shift));
+    }
+    sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                           _mm256_extracti128_si256(sum, 1));
+    if (i + 8 <= length) {
+      sum128 = _mm_add_epi32(
+          sum128,
+          ShiftedProducts(_mm_loadu_si128((const __m128i*)&vector1[i]),
+                          _mm_loadu_si128((const __m128i*)&vector2[i]),
+                          shift));
+      i += 8;
+    }
+  }
+
+  int32_t corr = HorizontalSum(sum128);
+  for (; i < length; i++) {
+    corr += (vector1[i] * vector2[i]) >> right_shifts;
+  }
+  return corr;
+}
+
+// AVX2 version of WebRtcSpl_CrossCorrelation() for x86 platforms.
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2) {
+  size_t i = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    *cross_correlation++ =
+        DotProductWithShiftAVX2(seq1, seq2, dim_seq, right_shifts);
+    seq2 += step_seq2;
+  }
+}
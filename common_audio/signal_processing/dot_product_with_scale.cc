@@ -11,11 +11,33 @@
 #include "common_audio/signal_processing/dot_product_with_scale.h"
 
 #include "rtc_base/numerics/safe_conversions.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
 
 int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
                                       const int16_t* vector2,
                                       size_t length,
                                       int scaling) {
+#if defined(WEBRTC_ENABLE_AVX2)
+  static const bool has_avx2 = WebRtc_GetCPUInfo(kAVX2) != 0;
+  if (has_avx2) {
+    return WebRtcSpl_DotProductWithScaleAVX2(vector1, vector2, length,
+                                             scaling);
+  }
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  static const bool has_sse2 = WebRtc_GetCPUInfo(kSSE2) != 0;
+  if (has_sse2) {
+    return WebRtcSpl_DotProductWithScaleSSE2(vector1, vector2, length,
+                                             scaling);
+  }
+#endif
+  return WebRtcSpl_DotProductWithScaleC(vector1, vector2, length, scaling);
+}
+
+int32_t WebRtcSpl_DotProductWithScaleC(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling) {
   int64_t sum = 0;
   size_t i = 0;
 
@@ -14,11 +14,16 @@
 #include <stdint.h>
 #include <string.h>
 
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Calculates the dot product between two (int16_t) vectors.
+// Calculates the dot product between two (int16_t) vectors. Uses the AVX2 or
+// SSE2 version when the CPU supports it, which gives the same results as the C
+// version.
 //
 // Input:
 //      - vector1       : Vector 1
@@ -34,6 +39,23 @@ int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
                                       size_t length,
                                       int scaling);
 
+int32_t WebRtcSpl_DotProductWithScaleC(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_DotProductWithScaleSSE2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling);
+#endif
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_DotProductWithScaleAVX2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling);
+#endif
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/signal_processing/dot_product_with_scale.h"
+
+#include <immintrin.h>
+
+// Adds the sign extended 32-bit lanes of |x| to the 64-bit lanes of |sum|.
+static inline __m256i AddWidened(__m256i sum, __m256i x) {
+  const __m256i low = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x));
+  const __m256i high = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1));
+  return _mm256_add_epi64(_mm256_add_epi64(sum, low), high);
+}
+
+// AVX2 version of WebRtcSpl_DotProductWithScale() for x86 platforms. Like the
+// C version, shifts each product and sums in 64 bits, so the result is
+// bit-exact.
+int32_t WebRtcSpl_DotProductWithScaleAVX2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling) {
+  const __m128i shift = _mm_cvtsi32_si128(scaling);
+  __m256i sum = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 16 <= length; i += 16) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)&vector1[i]);
+    const __m256i y = _mm256_loadu_si256((const __m256i*)&vector2[i]);
+    const __m256i low = _mm256_mullo_epi16(x, y);
+    const __m256i high = _mm256_mulhi_epi16(x, y);
+    sum = AddWidened(
+        sum, _mm256_sra_epi32(_mm256_unpacklo_epi16(low, high), shift));
+    sum = AddWidened(
+        sum, _mm256_sra_epi32(_mm256_unpackhi_epi16(low, high), shift));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, sum);
+  int64_t total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < length; i++) {
+    total += (vector1[i] * vector2[i]) >> scaling;
+  }
+
+  if (total > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (total < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t)total;
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/signal_processing/dot_product_with_scale.h"
+
+#include <emmintrin.h>
+
+// Adds the sign extended 32-bit lanes of |x| to the 64-bit lanes of |sum|.
+static inline __m128i AddWidened(__m128i sum, __m128i x) {
+  const __m128i sign = _mm_srai_epi32(x, 31);
+  sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(x, sign));
+  return _mm_add_epi64(sum, _mm_unpackhi_epi32(x, sign));
+}
+
+// SSE2 version of WebRtcSpl_DotProductWithScale() for x86 platforms. Like the
+// C version, shifts each product and sums in 64 bits, so the result is
+// bit-exact.
+int32_t WebRtcSpl_DotProductWithScaleSSE2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling) {
+  const __m128i shift = _mm_cvtsi32_si128(scaling);
+  __m128i sum = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)&vector1[i]);
+    const __m128i y = _mm_loadu_si128((const __m128i*)&vector2[i]);
+    const __m128i low = _mm_mullo_epi16(x, y);
+    const __m128i high = _mm_mulhi_epi16(x, y);
+    sum = AddWidened(sum, _mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift));
+    sum = AddWidened(sum, _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift));
+  }
+
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, sum);
+  int64_t total = lanes[0] + lanes[1];
+  for (; i < length; i++) {
+    total += (vector1[i] * vector2[i]) >> scaling;
+  }
+
+  if (total > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (total < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t)total;
+}
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <immintrin.h>
+#include <stddef.h>
+
+// The longest filter that the AVX2 version handles. Longer filters use the C
+// version.
+#define MAX_AVX2_COEFFICIENTS 16
+
+// Returns the products of the filter with the samples ending at |data_in| in
+// the low 128-bit lane, and with those ending at |data_in| + |offset| in the
+// high lane, summed in pairs.
+static inline __m256i FilterProducts(const int16_t* data_in,
+                                     size_t offset,
+                                     const __m256i* reversed_coefficients,
+                                     size_t num_blocks,
+                                     size_t coefficients_length) {
+  // The oldest sample that the filter uses.
+  const int16_t* x = data_in - (coefficients_length - 1);
+  __m256i sum = _mm256_madd_epi16(
+      _mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)x)),
+          _mm_loadu_si128((const __m128i*)(x + offset)), 1),
+      reversed_coefficients[0]);
+  if (num_blocks > 1) {
+    sum = _mm256_add_epi32(
+        sum, _mm256_madd_epi16(
+                 _mm256_inserti128_si256(
+                     _mm256_castsi128_si256(
+                         _mm_loadu_si128((const __m128i*)(x + 8))),
+                     _mm_loadu_si128((const __m128i*)(x + offset + 8)), 1),
+                 reversed_coefficients[1]));
+  }
+  return sum;
+}
+
+// AVX2 version of WebRtcSpl_DownsampleFast() for x86 platforms. Computes eight
+// output samples at a time, two in each filter pass, with the filter reversed
+// so that it applies to consecutive input samples. The sums wrap around on
+// overflow like in the C version, so the output is bit-exact.
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length == 0 || coefficients_length == 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (coefficients_length > MAX_AVX2_COEFFICIENTS) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  // Padded with zeros to whole blocks of eight, and repeated in both 128-bit
+  // lanes.
+  const size_t num_blocks = (coefficients_length + 7) / 8;
+  int16_t reversed[MAX_AVX2_COEFFICIENTS] = {0};
+  for (j = 0; j < coefficients_length; j++) {
+    reversed[coefficients_length - 1 - j] = coefficients[j];
+  }
+  __m256i reversed_coefficients[MAX_AVX2_COEFFICIENTS / 8];
+  for (j = 0; j < num_blocks; j++) {
+    reversed_coefficients[j] = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i*)&reversed[8 * j]));
+  }
+
+  // The zero padded blocks read past the newest sample of the filter. Those
+  // reads have to stay within |data_in|.
+  const size_t overread = 8 * num_blocks - coefficients_length;
+  const size_t offset = 4 * factor;
+  const __m256i round = _mm256_set1_epi32(2048);  // 0.5 in Q12.
+  i = delay;
+  for (; i + 7 * factor + overread < data_in_length && i + 7 * factor < endpos;
+       i += 8 * factor) {
+    // Output k is in the low lane of pk and output k + 4 in the high lane.
+    const __m256i p0 = FilterProducts(&data_in[i], offset,
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    const __m256i p1 = FilterProducts(&data_in[i + factor], offset,
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    const __m256i p2 = FilterProducts(&data_in[i + 2 * factor], offset,
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    const __m256i p3 = FilterProducts(&data_in[i + 3 * factor], offset,
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    // The horizontal adds leave the sum of pk in lane k of each 128-bit half,
+    // that is, outputs 0 to 3 in the low half and 4 to 7 in the high half.
+    __m256i out_s32 = _mm256_hadd_epi32(_mm256_hadd_epi32(p0, p1),
+                                        _mm256_hadd_epi32(p2, p3));
+    out_s32 = _mm256_srai_epi32(_mm256_add_epi32(out_s32, round), 12);  // Q0.
+    // Saturates and stores the output.
+    _mm_storeu_si128((__m128i*)data_out,
+                     _mm_packs_epi32(_mm256_castsi256_si128(out_s32),
+                                     _mm256_extracti128_si256(out_s32, 1)));
+    data_out += 8;
+  }
+
+  for (; i < endpos; i += factor) {
+    int32_t out_s32 = 2048;  // Round value, 0.5 in Q12.
+
+    for (j = 0; j < coefficients_length; j++) {
+      out_s32 += coefficients[j] * data_in[(ptrdiff_t) i - (ptrdiff_t) j];
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    *data_out++ = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
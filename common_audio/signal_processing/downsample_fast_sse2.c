@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <emmintrin.h>
+#include <stddef.h>
+
+// The longest filter that the SSE2 version handles. Longer filters use the C
+// version.
+#define MAX_SSE2_COEFFICIENTS 16
+
+// Returns the products of the filter with the samples ending at |data_in|,
+// summed in pairs.
+static inline __m128i FilterProducts(const int16_t* data_in,
+                                     const __m128i* reversed_coefficients,
+                                     size_t num_blocks,
+                                     size_t coefficients_length) {
+  // The oldest sample that the filter uses.
+  const int16_t* x = data_in - (coefficients_length - 1);
+  __m128i sum = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)x),
+                               reversed_coefficients[0]);
+  if (num_blocks > 1) {
+    sum = _mm_add_epi32(sum,
+                        _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(x + 8)),
+                                       reversed_coefficients[1]));
+  }
+  return sum;
+}
+
+// SSE2 version of WebRtcSpl_DownsampleFast() for x86 platforms. Computes four
+// output samples at a time, with the filter reversed so that it applies to
+// consecutive input samples. The sums wrap around on overflow like in the C
+// version, so the output is bit-exact.
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length == 0 || coefficients_length == 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (coefficients_length > MAX_SSE2_COEFFICIENTS) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  // Padded with zeros to whole blocks of eight.
+  const size_t num_blocks = (coefficients_length + 7) / 8;
+  int16_t reversed[MAX_SSE2_COEFFICIENTS] = {0};
+  for (j = 0; j < coefficients_length; j++) {
+    reversed[coefficients_length - 1 - j] = coefficients[j];
+  }
+  __m128i reversed_coefficients[MAX_SSE2_COEFFICIENTS / 8];
+  for (j = 0; j < num_blocks; j++) {
+    reversed_coefficients[j] =
+        _mm_loadu_si128((const __m128i*)&reversed[8 * j]);
+  }
+
+  // The zero padded blocks read past the newest sample of the filter. Those
+  // reads have to stay within |data_in|.
+  const size_t overread = 8 * num_blocks - coefficients_length;
+  const __m128i round = _mm_set1_epi32(2048);  // 0.5 in Q12.
+  i = delay;
+  for (; i + 3 * factor + overread < data_in_length && i + 3 * factor < endpos;
+       i += 4 * factor) {
+    const __m128i p0 = FilterProducts(&data_in[i], reversed_coefficients,
+                                      num_blocks, coefficients_length);
+    const __m128i p1 = FilterProducts(&data_in[i + factor],
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    const __m128i p2 = FilterProducts(&data_in[i + 2 * factor],
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    const __m128i p3 = FilterProducts(&data_in[i + 3 * factor],
+                                      reversed_coefficients, num_blocks,
+                                      coefficients_length);
+    // Transposes and adds, so that lane k holds the sum of pk.
+    const __m128i p01 = _mm_add_epi32(_mm_unpacklo_epi32(p0, p1),
+                                      _mm_unpackhi_epi32(p0, p1));
+    const __m128i p23 = _mm_add_epi32(_mm_unpacklo_epi32(p2, p3),
+                                      _mm_unpackhi_epi32(p2, p3));
+    __m128i out_s32 = _mm_add_epi32(_mm_unpacklo_epi64(p01, p23),
+                                    _mm_unpackhi_epi64(p01, p23));
+    out_s32 = _mm_srai_epi32(_mm_add_epi32(out_s32, round), 12);  // Q0.
+    // Saturates and stores the output.
+    _mm_storel_epi64((__m128i*)data_out, _mm_packs_epi32(out_s32, out_s32));
+    data_out += 4;
+  }
+
+  for (; i < endpos; i += factor) {
+    int32_t out_s32 = 2048;  // Round value, 0.5 in Q12.
+
+    for (j = 0; j < coefficients_length; j++) {
+      out_s32 += coefficients[j] * data_in[(ptrdiff_t) i - (ptrdiff_t) j];
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    *data_out++ = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
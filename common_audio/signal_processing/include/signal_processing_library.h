@@ -19,6 +19,8 @@
 
 #include <string.h>
 #include "common_audio/signal_processing/dot_product_with_scale.h"
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
 
 // Macros specific for the fixed point implementation
 #define WEBRTC_SPL_WORD16_MAX 32767
@@ -101,8 +103,9 @@ extern "C" {
 
 // Initialize SPL. Currently it contains only function pointer initialization.
 // If the underlying platform is known to be ARM-Neon (WEBRTC_HAS_NEON defined),
-// the pointers will be assigned to code optimized for Neon; otherwise, generic
-// C code will be assigned.
+// the pointers will be assigned to code optimized for Neon. On x86, some are
+// assigned to code optimized for AVX2 or SSE2, whichever is the widest that the
+// CPU supports. Otherwise, generic C code will be assigned.
 // Note that this function MUST be called in any application that uses SPL
 // functions.
 void WebRtcSpl_Init(void);
@@ -531,6 +534,24 @@ void WebRtcSpl_CrossCorrelationNeon(int32_t* cross_correlation,
                                     int right_shifts,
                                     int step_seq2);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2);
+#endif
+#if defined(WEBRTC_ENABLE_AVX2)
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2);
+#endif
 #if defined(MIPS32_LE)
 void WebRtcSpl_CrossCorrelation_mips(int32_t* cross_correlation,
                                      const int16_t* seq1,
@@ -682,6 +703,26 @@ int WebRtcSpl_DownsampleFastNeon(const int16_t* data_in,
                                  int factor,
                                  size_t delay);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay);
+#endif
+#if defined(WEBRTC_ENABLE_AVX2)
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay);
+#endif
 #if defined(MIPS32_LE)
 int WebRtcSpl_DownsampleFast_mips(const int16_t* data_in,
                                   size_t data_in_length,
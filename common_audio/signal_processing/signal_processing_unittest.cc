@@ -9,9 +9,12 @@
  */
 
 #include <algorithm>
+#include <vector>
 
 #include "common_audio/signal_processing/include/signal_processing_library.h"
+#include "rtc_base/random.h"
 #include "rtc_base/strings/string_builder.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
 #include "test/gtest.h"
 
 static const size_t kVector16Size = 9;
@@ -497,7 +500,7 @@ TEST_F(SplTest, CrossCorrelationTest) {
   const int32_t kExpected[kCrossCorrelationDimension] = {-266947903, -15579555,
                                                          -171282001};
   const int32_t* expected = kExpected;
-#if !defined(MIPS32_LE)
+#if defined(WEBRTC_HAS_NEON)
   const int32_t kExpectedNeon[kCrossCorrelationDimension] = {
       -266947901, -15579553, -171281999};
   if (WebRtcSpl_CrossCorrelation != WebRtcSpl_CrossCorrelationC) {
@@ -624,3 +627,152 @@ TEST_F(SplTest, Resample48WithSaturationTest) {
     EXPECT_EQ(kRefValue16kHz2, out_vector_w16[i]);
   }
 }
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Fills |vector| with random samples of at most |max_amplitude|, and with
+// runs of the extreme values.
+static void FillRandom(webrtc::Random* random,
+                       int16_t max_amplitude,
+                       std::vector<int16_t>* vector) {
+  for (int16_t& sample : *vector) {
+    sample = static_cast<int16_t>(random->Rand(-max_amplitude, max_amplitude));
+  }
+  for (size_t i = 0; i + 4 < vector->size(); i += 16) {
+    std::fill(vector->begin() + i, vector->begin() + i + 4,
+              random->Rand<bool>() ? max_amplitude : -max_amplitude);
+  }
+}
+
+// Checks that |cross_correlation| gives the same results as the C version.
+static void ExpectCrossCorrelationBitExact(CrossCorrelation cross_correlation) {
+  webrtc::Random random(0x5ea2);
+  const size_t kDimCrossCorrelation = 10;
+  for (int right_shifts = 0; right_shifts <= 6; ++right_shifts) {
+    // Keeps the 32-bit sums of the C version from overflowing.
+    const int16_t max_amplitude = right_shifts == 6 ? 32767 : 4096;
+    for (size_t dim_seq = 0; dim_seq <= 64; ++dim_seq) {
+      for (int step_seq2 : {-1, 1, 2}) {
+        std::vector<int16_t> seq1(dim_seq);
+        std::vector<int16_t> seq2_buffer(dim_seq + 3 * kDimCrossCorrelation);
+        FillRandom(&random, max_amplitude, &seq1);
+        FillRandom(&random, max_amplitude, &seq2_buffer);
+        const int16_t* seq2 = &seq2_buffer[kDimCrossCorrelation];
+        int32_t expected[kDimCrossCorrelation];
+        int32_t actual[kDimCrossCorrelation];
+        WebRtcSpl_CrossCorrelationC(expected, seq1.data(), seq2, dim_seq,
+                                    kDimCrossCorrelation, right_shifts,
+                                    step_seq2);
+        cross_correlation(actual, seq1.data(), seq2, dim_seq,
+                          kDimCrossCorrelation, right_shifts, step_seq2);
+        for (size_t i = 0; i < kDimCrossCorrelation; ++i) {
+          EXPECT_EQ(expected[i], actual[i]);
+        }
+      }
+    }
+  }
+}
+
+// Checks that |downsample_fast| gives the same results as the C version.
+static void ExpectDownsampleFastBitExact(DownsampleFast downsample_fast) {
+  webrtc::Random random(0xd0f5);
+  for (size_t coefficients_length = 1; coefficients_length <= 20;
+       ++coefficients_length) {
+    for (int factor = 1; factor <= 6; ++factor) {
+      for (size_t data_out_length = 1; data_out_length <= 21;
+           data_out_length += 4) {
+        const size_t delay = random.Rand(0, 3);
+        const size_t order = coefficients_length - 1;
+        // The filter state precedes the input.
+        const size_t data_in_length =
+            delay + factor * (data_out_length - 1) + 1 + random.Rand(0, 2);
+        std::vector<int16_t> data_in(order + data_in_length);
+        std::vector<int16_t> coefficients(coefficients_length);
+        FillRandom(&random, 32767, &data_in);
+        // Keeps the 32-bit sums of the C version from overflowing.
+        FillRandom(&random, 2048, &coefficients);
+        std::vector<int16_t> expected(data_out_length);
+        std::vector<int16_t> actual(data_out_length);
+        EXPECT_EQ(0, WebRtcSpl_DownsampleFastC(
+                         &data_in[order], data_in_length, expected.data(),
+                         data_out_length, coefficients.data(),
+                         coefficients_length, factor, delay));
+        EXPECT_EQ(0, downsample_fast(&data_in[order], data_in_length,
+                                     actual.data(), data_out_length,
+                                     coefficients.data(), coefficients_length,
+                                     factor, delay));
+        EXPECT_EQ(expected, actual);
+      }
+    }
+  }
+}
+
+typedef int32_t (*DotProductWithScale)(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling);
+
+// Checks that |dot_product| gives the same results as the C version.
+static void ExpectDotProductWithScaleBitExact(
+    DotProductWithScale dot_product) {
+  webrtc::Random random(0xe9e7);
+  for (int scaling = 0; scaling <= 4; ++scaling) {
+    for (size_t length = 0; length <= 80; ++length) {
+      std::vector<int16_t> vector1(length);
+      std::vector<int16_t> vector2(length);
+      FillRandom(&random, 32767, &vector1);
+      FillRandom(&random, 32767, &vector2);
+      EXPECT_EQ(WebRtcSpl_DotProductWithScaleC(vector1.data(), vector2.data(),
+                                               length, scaling),
+                dot_product(vector1.data(), vector2.data(), length, scaling));
+    }
+  }
+  // Saturates like the C version.
+  const std::vector<int16_t> minimum(4000, WEBRTC_SPL_WORD16_MIN);
+  EXPECT_EQ(WEBRTC_SPL_WORD32_MAX,
+            dot_product(minimum.data(), minimum.data(), minimum.size(), 0));
+}
+
+TEST_F(SplTest, CrossCorrelationSSE2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    return;
+  }
+  ExpectCrossCorrelationBitExact(WebRtcSpl_CrossCorrelationSSE2);
+}
+
+TEST_F(SplTest, DownsampleFastSSE2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    return;
+  }
+  ExpectDownsampleFastBitExact(WebRtcSpl_DownsampleFastSSE2);
+}
+
+TEST_F(SplTest, DotProductWithScaleSSE2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    return;
+  }
+  ExpectDotProductWithScaleBitExact(WebRtcSpl_DotProductWithScaleSSE2);
+}
+
+#if defined(WEBRTC_ENABLE_AVX2)
+TEST_F(SplTest, CrossCorrelationAVX2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    return;
+  }
+  ExpectCrossCorrelationBitExact(WebRtcSpl_CrossCorrelationAVX2);
+}
+
+TEST_F(SplTest, DownsampleFastAVX2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    return;
+  }
+  ExpectDownsampleFastBitExact(WebRtcSpl_DownsampleFastAVX2);
+}
+
+TEST_F(SplTest, DotProductWithScaleAVX2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    return;
+  }
+  ExpectDotProductWithScaleBitExact(WebRtcSpl_DotProductWithScaleAVX2);
+}
+#endif  // defined(WEBRTC_ENABLE_AVX2)
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
@@ -9,7 +9,7 @@
  */
 
 /* The global function contained in this file initializes SPL function
- * pointers, currently only for ARM platforms.
+ * pointers, currently for ARM, MIPS and x86 platforms.
  *
  * Some code came from common/rtcd.c in the WebM project.
  */
@@ -44,6 +44,24 @@ static void InitPointersToC(void) {
 }
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+/* Initialize function pointers to the SSE2 version, where there is one. */
+static void InitPointersToSSE2(void) {
+  InitPointersToC();
+  WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationSSE2;
+  WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastSSE2;
+}
+#endif
+
+#if defined(WEBRTC_ENABLE_AVX2)
+/* Initialize function pointers to the AVX2 version, where there is one. */
+static void InitPointersToAVX2(void) {
+  InitPointersToSSE2();
+  WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationAVX2;
+  WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastAVX2;
+}
+#endif
+
 #if defined(WEBRTC_HAS_NEON)
 /* Initialize function pointers to the Neon version. */
 static void InitPointersToNeon(void) {
@@ -87,6 +105,18 @@ static void InitFunctionPointers(void) {
   InitPointersToNeon();
 #elif defined(MIPS32_LE)
   InitPointersToMIPS();
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    InitPointersToAVX2();
+    return;
+  }
+#endif
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    InitPointersToSSE2();
+  } else {
+    InitPointersToC();
+  }
 #else
   InitPointersToC();
 #endif  /* WEBRTC_HAS_NEON */
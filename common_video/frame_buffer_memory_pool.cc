@@ -0,0 +1,197 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/include/frame_buffer_memory_pool.h"
+
+#include <string.h>
+
+#include <new>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/memory/aligned_malloc.h"
+
+namespace webrtc {
+
+namespace {
+
+// The smallest size class is 2^12 bytes, 4 kB.
+constexpr int kMinSizeClassLog2 = 12;
+constexpr size_t kDefaultGlobalMaxCachedBytes = 256 * 1024 * 1024;
+
+}  // namespace
+
+// Stored in front of every block, so that Free() only needs the pointer.
+struct FrameBufferMemoryPool::BlockHeader {
+  FrameBufferMemoryPool* pool;
+  // kNumSizeClasses for blocks too large to be cached.
+  int size_class;
+  size_t size;
+};
+
+constexpr int FrameBufferMemoryPool::kNumSizeClasses;
+constexpr int FrameBufferMemoryPool::kSlotsPerSizeClass;
+const size_t FrameBufferMemoryPool::kAlignment;
+
+// static
+FrameBufferMemoryPool* FrameBufferMemoryPool::Global() {
+  static FrameBufferMemoryPool* const pool =
+      new FrameBufferMemoryPool(kDefaultGlobalMaxCachedBytes);
+  return pool;
+}
+
+FrameBufferMemoryPool::FrameBufferMemoryPool(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes) {
+  for (auto& slots : free_blocks_) {
+    for (std::atomic<uint8_t*>& slot : slots)
+      slot.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+FrameBufferMemoryPool::~FrameBufferMemoryPool() {
+  Trim(0);
+  RTC_DCHECK_EQ(0u, allocated_bytes_.load());
+}
+
+// static
+int FrameBufferMemoryPool::SizeClass(size_t size) {
+  if (size <= (size_t{1} << kMinSizeClassLog2))
+    return 0;
+  // |size| is in (2^log2, 2^(log2 + 1)], which is split into four classes.
+  int log2 = kMinSizeClassLog2;
+  while ((size_t{1} << (log2 + 1)) < size)
+    ++log2;
+  const size_t step = size_t{1} << (log2 - 2);
+  const size_t sub_class = (size - (size_t{1} << log2) + step - 1) / step;
+  const int size_class =
+      (log2 - kMinSizeClassLog2) * 4 + static_cast<int>(sub_class);
+  return size_class < kNumSizeClasses ? size_class : kNumSizeClasses;
+}
+
+// static
+size_t FrameBufferMemoryPool::SizeClassBytes(int size_class) {
+  RTC_DCHECK_LT(size_class, kNumSizeClasses);
+  return (size_t{1} << (kMinSizeClassLog2 + size_class / 4)) *
+         (4 + size_class % 4) / 4;
+}
+
+// static
+size_t FrameBufferMemoryPool::BlockSize(const void* data) {
+  RTC_DCHECK(data);
+  return reinterpret_cast<const BlockHeader*>(
+             static_cast<const uint8_t*>(data) - kAlignment)
+      ->size;
+}
+
+uint8_t* FrameBufferMemoryPool::Allocate(size_t size, bool zero_initialize) {
+  RTC_DCHECK_GT(size, 0);
+  const int size_class = SizeClass(size);
+  if (size_class < kNumSizeClasses) {
+    for (std::atomic<uint8_t*>& slot : free_blocks_[size_class]) {
+      // Skip empty slots without writing to them.
+      if (slot.load(std::memory_order_relaxed) == nullptr)
+        continue;
+      uint8_t* data = slot.exchange(nullptr, std::memory_order_acquire);
+      if (data) {
+        const size_t block_size = BlockSize(data);
+        cached_bytes_.fetch_sub(block_size, std::memory_order_relaxed);
+        allocated_bytes_.fetch_add(block_size, std::memory_order_relaxed);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return data;
+      }
+    }
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  static_assert(sizeof(BlockHeader) <= kAlignment,
+                "The block header must fit in front of an aligned block.");
+  const size_t block_size =
+      size_class < kNumSizeClasses ? SizeClassBytes(size_class) : size;
+  uint8_t* block = static_cast<uint8_t*>(
+      AlignedMalloc(kAlignment + block_size, kAlignment));
+  RTC_CHECK(block);
+  new (block) BlockHeader{this, size_class, block_size};
+  uint8_t* data = block + kAlignment;
+  if (zero_initialize)
+    memset(data, 0, block_size);
+  allocated_bytes_.fetch_add(block_size, std::memory_order_relaxed);
+  return data;
+}
+
+// static
+void FrameBufferMemoryPool::Free(void* data) {
+  if (!data)
+    return;
+  uint8_t* block = static_cast<uint8_t*>(data) - kAlignment;
+  reinterpret_cast<BlockHeader*>(block)->pool->Release(
+      static_cast<uint8_t*>(data));
+}
+
+void FrameBufferMemoryPool::Release(uint8_t* data) {
+  const BlockHeader* header =
+      reinterpret_cast<const BlockHeader*>(data - kAlignment);
+  RTC_DCHECK_EQ(this, header->pool);
+  allocated_bytes_.fetch_sub(header->size, std::memory_order_relaxed);
+  if (header->size_class < kNumSizeClasses) {
+    // Reserve room under the cap first, so that concurrent frees cannot
+    // together exceed it.
+    const size_t cached_bytes =
+        cached_bytes_.fetch_add(header->size, std::memory_order_relaxed) +
+        header->size;
+    if (cached_bytes <= max_cached_bytes_.load(std::memory_order_relaxed)) {
+      for (std::atomic<uint8_t*>& slot : free_blocks_[header->size_class]) {
+        uint8_t* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, data,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+          return;
+        }
+      }
+    }
+    cached_bytes_.fetch_sub(header->size, std::memory_order_relaxed);
+  }
+  ReleaseToSystem(data);
+}
+
+void FrameBufferMemoryPool::ReleaseToSystem(uint8_t* data) {
+  released_blocks_.fetch_add(1, std::memory_order_relaxed);
+  AlignedFree(data - kAlignment);
+}
+
+void FrameBufferMemoryPool::Trim(size_t max_cached_bytes) {
+  // Release the largest blocks first.
+  for (int size_class = kNumSizeClasses - 1; size_class >= 0; --size_class) {
+    for (std::atomic<uint8_t*>& slot : free_blocks_[size_class]) {
+      if (cached_bytes_.load(std::memory_order_relaxed) <= max_cached_bytes)
+        return;
+      uint8_t* data = slot.exchange(nullptr, std::memory_order_acquire);
+      if (data) {
+        cached_bytes_.fetch_sub(BlockSize(data), std::memory_order_relaxed);
+        ReleaseToSystem(data);
+      }
+    }
+  }
+}
+
+void FrameBufferMemoryPool::SetMaxCachedBytes(size_t max_cached_bytes) {
+  max_cached_bytes_.store(max_cached_bytes, std::memory_order_relaxed);
+  Trim(max_cached_bytes);
+}
+
+FrameBufferMemoryPool::Stats FrameBufferMemoryPool::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.released_blocks = released_blocks_.load(std::memory_order_relaxed);
+  stats.cached_bytes = cached_bytes_.load(std::memory_order_relaxed);
+  stats.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/include/frame_buffer_memory_pool.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+constexpr size_t kMaxCachedBytes = 16 * 1024 * 1024;
+constexpr size_t k720pI420Size = 1280 * 720 * 3 / 2;
+}  // namespace
+
+TEST(FrameBufferMemoryPoolTest, ReusesFreedBlock) {
+  FrameBufferMemoryPool pool(kMaxCachedBytes);
+  uint8_t* data = pool.Allocate(k720pI420Size, false);
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(data) %
+                    FrameBufferMemoryPool::kAlignment);
+  EXPECT_GE(FrameBufferMemoryPool::BlockSize(data), k720pI420Size);
+  FrameBufferMemoryPool::Free(data);
+
+  EXPECT_EQ(data, pool.Allocate(k720pI420Size, false));
+  FrameBufferMemoryPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(0u, stats.cached_bytes);
+  EXPECT_EQ(FrameBufferMemoryPool::BlockSize(data), stats.allocated_bytes);
+  FrameBufferMemoryPool::Free(data);
+}
+
+TEST(FrameBufferMemoryPoolTest, SimilarSizesShareSizeClass) {
+  FrameBufferMemoryPool pool(kMaxCachedBytes);
+  uint8_t* data = pool.Allocate(k720pI420Size, false);
+  FrameBufferMemoryPool::Free(data);
+  // A few rows less, as after cropping to a slightly different aspect ratio.
+  EXPECT_EQ(data, pool.Allocate(1280 * 704 * 3 / 2, false));
+  FrameBufferMemoryPool::Free(data);
+
+  // Much smaller blocks do not take the large one.
+  uint8_t* small_data = pool.Allocate(320 * 180 * 3 / 2, false);
+  EXPECT_NE(data, small_data);
+  EXPECT_EQ(1u, pool.GetStats().hits);
+  FrameBufferMemoryPool::Free(small_data);
+}
+
+TEST(FrameBufferMemoryPoolTest, ZeroInitializesNewBlocks) {
+  FrameBufferMemoryPool pool(kMaxCachedBytes);
+  uint8_t* data = pool.Allocate(1000, true);
+  for (size_t i = 0; i < FrameBufferMemoryPool::BlockSize(data); ++i)
+    EXPECT_EQ(0, data[i]);
+  FrameBufferMemoryPool::Free(data);
+}
+
+TEST(FrameBufferMemoryPoolTest, CachesAtMostMaxCachedBytes) {
+  FrameBufferMemoryPool pool(2 * k720pI420Size);
+  std::vector<uint8_t*> blocks;
+  for (int i = 0; i < 4; ++i)
+    blocks.push_back(pool.Allocate(k720pI420Size, false));
+  for (uint8_t* data : blocks)
+    FrameBufferMemoryPool::Free(data);
+
+  FrameBufferMemoryPool::Stats stats = pool.GetStats();
+  EXPECT_LE(stats.cached_bytes, 2 * k720pI420Size);
+  EXPECT_GT(stats.cached_bytes, 0u);
+  EXPECT_GE(stats.released_blocks, 2u);
+  EXPECT_EQ(0u, stats.allocated_bytes);
+}
+
+TEST(FrameBufferMemoryPoolTest, TrimReleasesCachedBlocks) {
+  FrameBufferMemoryPool pool(kMaxCachedBytes);
+  uint8_t* large = pool.Allocate(k720pI420Size, false);
+  uint8_t* small = pool.Allocate(320 * 180 * 3 / 2, false);
+  const size_t small_size = FrameBufferMemoryPool::BlockSize(small);
+  FrameBufferMemoryPool::Free(large);
+  FrameBufferMemoryPool::Free(small);
+
+  // The large block goes first.
+  pool.Trim(small_size);
+  FrameBufferMemoryPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(small_size, stats.cached_bytes);
+  EXPECT_EQ(1u, stats.released_blocks);
+
+  pool.SetMaxCachedBytes(0);
+  EXPECT_EQ(0u, pool.GetStats().cached_bytes);
+  EXPECT_EQ(2u, pool.GetStats().released_blocks);
+  // Nothing is cached any more.
+  FrameBufferMemoryPool::Free(pool.Allocate(1000, false));
+  EXPECT_EQ(0u, pool.GetStats().cached_bytes);
+}
+
+TEST(FrameBufferMemoryPoolTest, ConcurrentAllocateAndFree) {
+  FrameBufferMemoryPool pool(kMaxCachedBytes);
+  constexpr int kNumThreads = 4;
+  auto run = [](void* obj) {
+    FrameBufferMemoryPool* pool = static_cast<FrameBufferMemoryPool*>(obj);
+    for (int i = 0; i < 1000; ++i) {
+      uint8_t* data = pool->Allocate(k720pI420Size / (1 + i % 3), false);
+      data[0] = static_cast<uint8_t>(i);
+      FrameBufferMemoryPool::Free(data);
+    }
+  };
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(new rtc::PlatformThread(run, &pool, "pool_thread"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+
+  FrameBufferMemoryPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(0u, stats.allocated_bytes);
+  EXPECT_EQ(kNumThreads * 1000u, stats.hits + stats.misses);
+}
+
+}  // namespace webrtc
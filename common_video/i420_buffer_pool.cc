@@ -10,17 +10,56 @@
 
 #include "common_video/include/i420_buffer_pool.h"
 
+#include <utility>
+
 #include "rtc_base/checks.h"
 
 namespace webrtc {
 
+namespace {
+
+// An I420Buffer with memory from a FrameBufferMemoryPool, which counts itself
+// as pending in the I420BufferPool that created it.
+class SharedMemoryI420Buffer : public I420Buffer {
+ public:
+  SharedMemoryI420Buffer(
+      int width,
+      int height,
+      uint8_t* data,
+      std::shared_ptr<std::atomic<size_t>> num_pending_buffers)
+      : I420Buffer(width,
+                   height,
+                   width,
+                   (width + 1) / 2,
+                   (width + 1) / 2,
+                   data,
+                   &FrameBufferMemoryPool::Free),
+        num_pending_buffers_(std::move(num_pending_buffers)) {
+    ++*num_pending_buffers_;
+  }
+
+ protected:
+  ~SharedMemoryI420Buffer() override { --*num_pending_buffers_; }
+
+ private:
+  const std::shared_ptr<std::atomic<size_t>> num_pending_buffers_;
+};
+
+}  // namespace
+
 I420BufferPool::I420BufferPool() : I420BufferPool(false) {}
 I420BufferPool::I420BufferPool(bool zero_initialize)
     : I420BufferPool(zero_initialize, std::numeric_limits<size_t>::max()) {}
 I420BufferPool::I420BufferPool(bool zero_initialize,
                                size_t max_number_of_buffers)
+    : I420BufferPool(zero_initialize, max_number_of_buffers, nullptr) {}
+I420BufferPool::I420BufferPool(bool zero_initialize,
+                               size_t max_number_of_buffers,
+                               FrameBufferMemoryPool* memory_pool)
     : zero_initialize_(zero_initialize),
-      max_number_of_buffers_(max_number_of_buffers) {}
+      max_number_of_buffers_(max_number_of_buffers),
+      memory_pool_(memory_pool),
+      num_pending_buffers_(std::make_shared<std::atomic<size_t>>(0)) {}
 I420BufferPool::~I420BufferPool() = default;
 
 void I420BufferPool::Release() {
@@ -30,6 +69,16 @@ void I420BufferPool::Release() {
 rtc::scoped_refptr<I420Buffer> I420BufferPool::CreateBuffer(int width,
                                                             int height) {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  if (memory_pool_) {
+    if (*num_pending_buffers_ >= max_number_of_buffers_)
+      return nullptr;
+    const int chroma_width = (width + 1) / 2;
+    const size_t size = width * height + 2 * chroma_width * ((height + 1) / 2);
+    return new rtc::RefCountedObject<SharedMemoryI420Buffer>(
+        width, height, memory_pool_->Allocate(size, zero_initialize_),
+        num_pending_buffers_);
+  }
+
   // Release buffers with wrong resolution.
   for (auto it = buffers_.begin(); it != buffers_.end();) {
     if ((*it)->width() != width || (*it)->height() != height)
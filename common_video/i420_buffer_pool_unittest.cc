@@ -8,6 +8,9 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
+#include <limits>
 #include <string>
 
 #include "common_video/include/i420_buffer_pool.h"
@@ -70,4 +73,46 @@ TEST(TestI420BufferPool, MaxNumberOfBuffers) {
   EXPECT_EQ(nullptr, pool.CreateBuffer(16, 16).get());
 }
 
+TEST(TestI420BufferPool, SharedMemoryIsReusedAcrossPools) {
+  FrameBufferMemoryPool memory_pool(1024 * 1024);
+  I420BufferPool pool1(false, std::numeric_limits<size_t>::max(),
+                       &memory_pool);
+  I420BufferPool pool2(false, std::numeric_limits<size_t>::max(),
+                       &memory_pool);
+  rtc::scoped_refptr<I420BufferInterface> buffer = pool1.CreateBuffer(64, 64);
+  EXPECT_EQ(64, buffer->width());
+  EXPECT_EQ(64, buffer->height());
+  EXPECT_EQ(64, buffer->StrideY());
+  EXPECT_EQ(32, buffer->StrideU());
+  const uint8_t* y_ptr = buffer->DataY();
+  buffer = nullptr;
+  // A similar resolution from another pool gets the same memory.
+  buffer = pool2.CreateBuffer(62, 64);
+  EXPECT_EQ(y_ptr, buffer->DataY());
+  EXPECT_EQ(1u, memory_pool.GetStats().hits);
+}
+
+TEST(TestI420BufferPool, SharedMemoryMaxNumberOfBuffers) {
+  FrameBufferMemoryPool memory_pool(1024 * 1024);
+  I420BufferPool pool(false, 1, &memory_pool);
+  rtc::scoped_refptr<I420BufferInterface> buffer1 = pool.CreateBuffer(16, 16);
+  EXPECT_NE(nullptr, buffer1.get());
+  EXPECT_EQ(nullptr, pool.CreateBuffer(16, 16).get());
+  buffer1 = nullptr;
+  EXPECT_NE(nullptr, pool.CreateBuffer(16, 16).get());
+}
+
+TEST(TestI420BufferPool, SharedMemoryFrameValidAfterPoolDestruction) {
+  FrameBufferMemoryPool memory_pool(1024 * 1024);
+  rtc::scoped_refptr<I420Buffer> buffer;
+  {
+    I420BufferPool pool(true, 1, &memory_pool);
+    buffer = pool.CreateBuffer(16, 16);
+  }
+  EXPECT_EQ(0, buffer->DataY()[0]);
+  memset(buffer->MutableDataY(), 0xA5, 16 * buffer->StrideY());
+  buffer = nullptr;
+  EXPECT_EQ(0u, memory_pool.GetStats().allocated_bytes);
+}
+
 }  // namespace webrtc
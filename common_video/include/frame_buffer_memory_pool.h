@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INCLUDE_FRAME_BUFFER_MEMORY_POOL_H_
+#define COMMON_VIDEO_INCLUDE_FRAME_BUFFER_MEMORY_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "rtc_base/constructormagic.h"
+
+namespace webrtc {
+
+// Memory for frame buffers, shared by the buffer pools of many decoders and
+// scalers. Block sizes are rounded up to size classes, four per power of two,
+// so that a block freed by a stream at one resolution can be reused by a
+// stream at a similar resolution. Every size class keeps its free blocks in a
+// fixed number of slots that are taken and filled with atomic operations, so
+// allocating and freeing never takes a lock.
+//
+// The pool caches at most |max_cached_bytes| of free blocks. Blocks freed
+// beyond that, or of sizes larger than the largest size class, are returned
+// to the system. Trim() releases cached blocks, e.g. when memory is low.
+//
+// A pool must outlive the blocks it has handed out.
+class FrameBufferMemoryPool {
+ public:
+  struct Stats {
+    // Allocations served from a cached block, and from the system.
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Blocks returned to the system on Free() or Trim().
+    uint64_t released_blocks = 0;
+    // Bytes of free blocks in the pool, and of blocks handed out.
+    size_t cached_bytes = 0;
+    size_t allocated_bytes = 0;
+  };
+
+  // Blocks are aligned to this many bytes.
+  static const size_t kAlignment = 64;
+
+  // Returns the pool shared by the whole process. It caches up to 256 MB.
+  static FrameBufferMemoryPool* Global();
+
+  explicit FrameBufferMemoryPool(size_t max_cached_bytes);
+  ~FrameBufferMemoryPool();
+
+  // Returns a block of at least |size| bytes, aligned to kAlignment. If
+  // |zero_initialize| is set and the block has to be allocated, it is zeroed.
+  // Cached blocks are not zeroed.
+  uint8_t* Allocate(size_t size, bool zero_initialize);
+
+  // Returns |data|, which was returned by Allocate() of any pool, to the pool
+  // it was allocated from. The signature matches a plain deleter function.
+  static void Free(void* data);
+
+  // Returns the usable size of a block returned by Allocate().
+  static size_t BlockSize(const void* data);
+
+  // Releases cached blocks until at most |max_cached_bytes| are cached.
+  void Trim(size_t max_cached_bytes);
+  // Changes the cap and trims the pool to it.
+  void SetMaxCachedBytes(size_t max_cached_bytes);
+
+  Stats GetStats() const;
+
+ private:
+  struct BlockHeader;
+
+  static constexpr int kNumSizeClasses = 64;
+  static constexpr int kSlotsPerSizeClass = 32;
+
+  static int SizeClass(size_t size);
+  static size_t SizeClassBytes(int size_class);
+
+  void Release(uint8_t* data);
+  void ReleaseToSystem(uint8_t* data);
+
+  std::atomic<size_t> max_cached_bytes_;
+  std::atomic<uint8_t*> free_blocks_[kNumSizeClasses][kSlotsPerSizeClass];
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> released_blocks_{0};
+  std::atomic<size_t> cached_bytes_{0};
+  std::atomic<size_t> allocated_bytes_{0};
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(FrameBufferMemoryPool);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INCLUDE_FRAME_BUFFER_MEMORY_POOL_H_
@@ -11,10 +11,13 @@
 #ifndef COMMON_VIDEO_INCLUDE_I420_BUFFER_POOL_H_
 #define COMMON_VIDEO_INCLUDE_I420_BUFFER_POOL_H_
 
+#include <atomic>
 #include <limits>
 #include <list>
+#include <memory>
 
 #include "api/video/i420_buffer.h"
+#include "common_video/include/frame_buffer_memory_pool.h"
 #include "rtc_base/race_checker.h"
 #include "rtc_base/refcountedobject.h"
 
@@ -27,11 +30,18 @@ namespace webrtc {
 // changes, old buffers will be purged from the pool.
 // Note that CreateBuffer will crash if more than kMaxNumberOfFramesBeforeCrash
 // are created. This is to prevent memory leaks where frames are not returned.
+//
+// A pool constructed with a FrameBufferMemoryPool keeps no buffers of its own.
+// Its buffers take their memory from, and return it to, the shared pool, so
+// that memory is reused across streams and resolution changes.
 class I420BufferPool {
  public:
   I420BufferPool();
   explicit I420BufferPool(bool zero_initialize);
   I420BufferPool(bool zero_initialze, size_t max_number_of_buffers);
+  I420BufferPool(bool zero_initialize,
+                 size_t max_number_of_buffers,
+                 FrameBufferMemoryPool* memory_pool);
   ~I420BufferPool();
 
   // Returns a buffer from the pool. If no suitable buffer exist in the pool
@@ -57,6 +67,11 @@ class I420BufferPool {
   const bool zero_initialize_;
   // Max number of buffers this pool can have pending.
   const size_t max_number_of_buffers_;
+  // If set, the memory of the buffers comes from this pool instead.
+  FrameBufferMemoryPool* const memory_pool_;
+  // The number of pending buffers with memory from |memory_pool_|. Shared
+  // with the buffers, which may outlive this pool.
+  const std::shared_ptr<std::atomic<size_t>> num_pending_buffers_;
 };
 
 }  // namespace webrtc
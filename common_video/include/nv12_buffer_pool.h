@@ -0,0 +1,56 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INCLUDE_NV12_BUFFER_POOL_H_
+#define COMMON_VIDEO_INCLUDE_NV12_BUFFER_POOL_H_
+
+#include <limits>
+#include <list>
+
+#include "api/video/nv12_buffer.h"
+#include "rtc_base/race_checker.h"
+#include "rtc_base/refcountedobject.h"
+
+namespace webrtc {
+
+// The NV12 counterpart of I420BufferPool: the memory of a buffer returned
+// from CreateBuffer is returned to the pool when the buffer is destructed,
+// and buffers of another resolution are purged from the pool.
+class NV12BufferPool {
+ public:
+  NV12BufferPool();
+  NV12BufferPool(bool zero_initialize, size_t max_number_of_buffers);
+  ~NV12BufferPool();
+
+  // Returns a buffer from the pool. If no suitable buffer exist in the pool
+  // and there are less than |max_number_of_buffers| pending, a buffer is
+  // created. Returns null otherwise.
+  rtc::scoped_refptr<NV12Buffer> CreateBuffer(int width, int height);
+  // Clears buffers_ and detaches the thread checker so that it can be reused
+  // later from another thread.
+  void Release();
+
+ private:
+  // Explicitly use a RefCountedObject to get access to HasOneRef,
+  // needed by the pool to check exclusive access.
+  using PooledNV12Buffer = rtc::RefCountedObject<NV12Buffer>;
+
+  rtc::RaceChecker race_checker_;
+  std::list<rtc::scoped_refptr<PooledNV12Buffer>> buffers_;
+  // If true, newly allocated buffers are zero-initialized. Recycled buffers
+  // are not zero'd before reuse.
+  const bool zero_initialize_;
+  // Max number of buffers this pool can have pending.
+  const size_t max_number_of_buffers_;
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INCLUDE_NV12_BUFFER_POOL_H_
@@ -21,6 +21,7 @@
 #include "api/video/video_rotation.h"
 #include "api/video/video_timing.h"
 #include "common_types.h"  // NOLINT(build/include)
+#include "rtc_base/copyonwritebuffer.h"
 
 namespace webrtc {
 
@@ -67,6 +68,10 @@ class EncodedImage {
   uint8_t* _buffer;
   size_t _length;
   size_t _size;
+  // Set by encoders that keep their output in a refcounted buffer, with
+  // |_buffer| pointing into it, so that the RTP packets of the frame can
+  // reference the payload instead of copying it.
+  rtc::CopyOnWriteBuffer shared_buffer_;
   VideoRotation rotation_ = kVideoRotation_0;
   VideoContentType content_type_ = VideoContentType::UNSPECIFIED;
   bool _completeFrame = false;
@@ -91,8 +96,7 @@ class EncodedImage {
 
  private:
   uint32_t timestamp_rtp_ = 0;
-  // -1 means not set. Use a plain int rather than optional, to keep this class
-  // copyable with memcpy.
+  // -1 means not set.
   int spatial_index_ = -1;
 };
 
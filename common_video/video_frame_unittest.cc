@@ -13,6 +13,7 @@
 
 #include "api/video/i010_buffer.h"
 #include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
 #include "api/video/video_frame.h"
 #include "rtc_base/bind.h"
 #include "rtc_base/timeutils.h"
@@ -409,6 +410,48 @@ INSTANTIATE_TEST_CASE_P(,
                         ::testing::Values(VideoFrameBuffer::Type::kI420,
                                           VideoFrameBuffer::Type::kI010));
 
+TEST(TestNV12Buffer, CopiesFromAndConvertsToI420) {
+  rtc::scoped_refptr<I420BufferInterface> i420_buffer =
+      CreateGradient(VideoFrameBuffer::Type::kI420, 200, 100)->ToI420();
+  rtc::scoped_refptr<NV12Buffer> nv12_buffer = NV12Buffer::Copy(*i420_buffer);
+  EXPECT_EQ(VideoFrameBuffer::Type::kNV12, nv12_buffer->type());
+  EXPECT_EQ(100, nv12_buffer->ChromaWidth());
+  EXPECT_EQ(50, nv12_buffer->ChromaHeight());
+  EXPECT_TRUE(test::FrameBufsEqual(i420_buffer, nv12_buffer->ToI420()));
+  EXPECT_TRUE(test::FrameBufsEqual(
+      i420_buffer, NV12Buffer::Copy(*nv12_buffer->GetNV12())->ToI420()));
+}
+
+TEST(TestNV12Buffer, Scale) {
+  rtc::scoped_refptr<NV12Buffer> buf = NV12Buffer::Copy(
+      *CreateGradient(VideoFrameBuffer::Type::kI420, 200, 100)->ToI420());
+
+  // Pure scaling, no cropping.
+  rtc::scoped_refptr<NV12Buffer> scaled_buffer = NV12Buffer::Create(150, 75);
+  scaled_buffer->ScaleFrom(*buf);
+  CheckCrop(*scaled_buffer->ToI420(), 0.0, 0.0, 1.0, 1.0);
+}
+
+TEST(TestNV12Buffer, CropXNotCenter) {
+  rtc::scoped_refptr<NV12Buffer> buf = NV12Buffer::Copy(
+      *CreateGradient(VideoFrameBuffer::Type::kI420, 200, 100)->ToI420());
+
+  // Non-center cropping, no scaling.
+  rtc::scoped_refptr<NV12Buffer> cropped_buffer = NV12Buffer::Create(100, 100);
+  cropped_buffer->CropAndScaleFrom(*buf, 25, 0, 100, 100);
+  CheckCrop(*cropped_buffer->ToI420(), 0.125, 0.0, 0.5, 1.0);
+}
+
+TEST(TestNV12Buffer, CropAndScale) {
+  rtc::scoped_refptr<NV12Buffer> buf = NV12Buffer::Copy(
+      *CreateGradient(VideoFrameBuffer::Type::kI420, 100, 200)->ToI420());
+
+  // Crop the center half and scale it down.
+  rtc::scoped_refptr<NV12Buffer> scaled_buffer = NV12Buffer::Create(50, 50);
+  scaled_buffer->CropAndScaleFrom(*buf, 0, 50, 100, 100);
+  CheckCrop(*scaled_buffer->ToI420(), 0.0, 0.25, 1.0, 0.5);
+}
+
 class TestPlanarYuvBufferRotate
     : public ::testing::TestWithParam<
           std::tuple<webrtc::VideoRotation, VideoFrameBuffer::Type>> {};
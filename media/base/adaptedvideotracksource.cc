@@ -11,15 +11,27 @@
 #include "media/base/adaptedvideotracksource.h"
 
 #include "api/video/i420_buffer.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace rtc {
 
-AdaptedVideoTrackSource::AdaptedVideoTrackSource() {
+namespace {
+// Lets the broadcaster adapt frames for every sink, instead of this source
+// adapting to the most restrictive wants of all sinks.
+const char kAdaptFramesForSinksFieldTrial[] =
+    "WebRTC-Video-BroadcasterAdaptFramesForSinks";
+}  // namespace
+
+AdaptedVideoTrackSource::AdaptedVideoTrackSource()
+    : broadcaster_(
+          webrtc::field_trial::IsEnabled(kAdaptFramesForSinksFieldTrial)) {
   thread_checker_.DetachFromThread();
 }
 
 AdaptedVideoTrackSource::AdaptedVideoTrackSource(int required_alignment)
-    : video_adapter_(required_alignment) {
+    : video_adapter_(required_alignment),
+      broadcaster_(
+          webrtc::field_trial::IsEnabled(kAdaptFramesForSinksFieldTrial)) {
   thread_checker_.DetachFromThread();
 }
 AdaptedVideoTrackSource::~AdaptedVideoTrackSource() = default;
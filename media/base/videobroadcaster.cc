@@ -10,15 +10,26 @@
 
 #include "media/base/videobroadcaster.h"
 
+#include <algorithm>
 #include <limits>
 
+#include "absl/memory/memory.h"
 #include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "common_video/include/frame_buffer_memory_pool.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/timeutils.h"
 
 namespace rtc {
 
-VideoBroadcaster::VideoBroadcaster() {
+VideoBroadcaster::VideoBroadcaster() : VideoBroadcaster(false) {}
+
+VideoBroadcaster::VideoBroadcaster(bool adapt_frames_for_sinks)
+    : adapt_frames_for_sinks_(adapt_frames_for_sinks),
+      scaled_buffer_pool_(false,
+                          std::numeric_limits<size_t>::max(),
+                          webrtc::FrameBufferMemoryPool::Global()) {
   thread_checker_.DetachFromThread();
 }
 VideoBroadcaster::~VideoBroadcaster() = default;
@@ -30,6 +41,14 @@ void VideoBroadcaster::AddOrUpdateSink(
   RTC_DCHECK(sink != nullptr);
   rtc::CritScope cs(&sinks_and_wants_lock_);
   VideoSourceBase::AddOrUpdateSink(sink, wants);
+  if (adapt_frames_for_sinks_) {
+    std::unique_ptr<cricket::VideoAdapter>& adapter = adapters_[sink];
+    if (!adapter)
+      adapter = absl::make_unique<cricket::VideoAdapter>();
+    adapter->OnResolutionFramerateRequest(
+        wants.target_pixel_count, wants.max_pixel_count,
+        wants.max_framerate_fps);
+  }
   UpdateWants();
 }
 
@@ -39,6 +58,7 @@ void VideoBroadcaster::RemoveSink(
   RTC_DCHECK(sink != nullptr);
   rtc::CritScope cs(&sinks_and_wants_lock_);
   VideoSourceBase::RemoveSink(sink);
+  adapters_.erase(sink);
   UpdateWants();
 }
 
@@ -54,6 +74,7 @@ VideoSinkWants VideoBroadcaster::wants() const {
 
 void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
   rtc::CritScope cs(&sinks_and_wants_lock_);
+  std::vector<ScaledBuffer> scaled_buffers;
   for (auto& sink_pair : sink_pairs()) {
     if (sink_pair.wants.rotation_applied &&
         frame.rotation() != webrtc::kVideoRotation_0) {
@@ -68,6 +89,14 @@ void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
       sink_pair.sink->OnFrame(
           webrtc::VideoFrame(GetBlackFrameBuffer(frame.width(), frame.height()),
                              frame.rotation(), frame.timestamp_us()));
+    } else if (adapt_frames_for_sinks_) {
+      absl::optional<webrtc::VideoFrame> adapted_frame =
+          AdaptFrameForSink(sink_pair.sink, frame, &scaled_buffers);
+      if (adapted_frame) {
+        sink_pair.sink->OnFrame(*adapted_frame);
+      } else {
+        sink_pair.sink->OnDiscardedFrame();
+      }
     } else {
       sink_pair.sink->OnFrame(frame);
     }
@@ -83,6 +112,38 @@ void VideoBroadcaster::OnDiscardedFrame() {
 void VideoBroadcaster::UpdateWants() {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
 
+  if (adapt_frames_for_sinks_) {
+    // The sinks are adapted for here, so the source only needs to fulfill
+    // the least restrictive wants.
+    VideoSinkWants wants;
+    wants.rotation_applied = false;
+    wants.max_pixel_count = 0;
+    wants.max_framerate_fps = 0;
+    bool all_sinks_have_target = true;
+    for (auto& sink : sink_pairs()) {
+      wants.rotation_applied |= sink.wants.rotation_applied;
+      wants.max_pixel_count =
+          std::max(wants.max_pixel_count, sink.wants.max_pixel_count);
+      wants.max_framerate_fps =
+          std::max(wants.max_framerate_fps, sink.wants.max_framerate_fps);
+      if (!sink.wants.target_pixel_count) {
+        all_sinks_have_target = false;
+      } else if (!wants.target_pixel_count ||
+                 *sink.wants.target_pixel_count > *wants.target_pixel_count) {
+        wants.target_pixel_count = sink.wants.target_pixel_count;
+      }
+    }
+    if (sink_pairs().empty()) {
+      wants = VideoSinkWants();
+    } else if (!all_sinks_have_target) {
+      wants.target_pixel_count.reset();
+    } else if (*wants.target_pixel_count >= wants.max_pixel_count) {
+      wants.target_pixel_count.emplace(wants.max_pixel_count);
+    }
+    current_wants_ = wants;
+    return;
+  }
+
   VideoSinkWants wants;
   wants.rotation_applied = false;
   for (auto& sink : sink_pairs()) {
@@ -129,4 +190,66 @@ VideoBroadcaster::GetBlackFrameBuffer(int width, int height) {
   return black_frame_buffer_;
 }
 
+absl::optional<webrtc::VideoFrame> VideoBroadcaster::AdaptFrameForSink(
+    VideoSinkInterface<webrtc::VideoFrame>* sink,
+    const webrtc::VideoFrame& frame,
+    std::vector<ScaledBuffer>* scaled_buffers) {
+  auto adapter_it = adapters_.find(sink);
+  RTC_DCHECK(adapter_it != adapters_.end());
+  int cropped_width;
+  int cropped_height;
+  int out_width;
+  int out_height;
+  if (!adapter_it->second->AdaptFrameResolution(
+          frame.width(), frame.height(),
+          frame.timestamp_us() * rtc::kNumNanosecsPerMicrosec, &cropped_width,
+          &cropped_height, &out_width, &out_height)) {
+    return absl::nullopt;
+  }
+  if (out_width == frame.width() && out_height == frame.height())
+    return frame;
+
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
+  for (const ScaledBuffer& scaled_buffer : *scaled_buffers) {
+    if (scaled_buffer.cropped_width == cropped_width &&
+        scaled_buffer.cropped_height == cropped_height &&
+        scaled_buffer.buffer->width() == out_width &&
+        scaled_buffer.buffer->height() == out_height) {
+      buffer = scaled_buffer.buffer;
+      break;
+    }
+  }
+  if (!buffer) {
+    const int offset_x = (frame.width() - cropped_width) / 2;
+    const int offset_y = (frame.height() - cropped_height) / 2;
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> source_buffer =
+        frame.video_frame_buffer();
+    if (source_buffer->type() == webrtc::VideoFrameBuffer::Type::kNV12) {
+      rtc::scoped_refptr<webrtc::NV12Buffer> scaled =
+          webrtc::NV12Buffer::Create(out_width, out_height);
+      scaled->CropAndScaleFrom(*source_buffer->GetNV12(), offset_x, offset_y,
+                               cropped_width, cropped_height);
+      buffer = scaled;
+    } else {
+      rtc::scoped_refptr<webrtc::I420Buffer> scaled =
+          scaled_buffer_pool_.CreateBuffer(out_width, out_height);
+      scaled->CropAndScaleFrom(*source_buffer->ToI420(), offset_x, offset_y,
+                               cropped_width, cropped_height);
+      buffer = scaled;
+    }
+    scaled_buffers->push_back(ScaledBuffer{cropped_width, cropped_height,
+                                           buffer});
+  }
+
+  webrtc::VideoFrame::Builder builder;
+  builder.set_video_frame_buffer(buffer)
+      .set_timestamp_us(frame.timestamp_us())
+      .set_timestamp_rtp(frame.timestamp())
+      .set_ntp_time_ms(frame.ntp_time_ms())
+      .set_rotation(frame.rotation());
+  if (frame.color_space())
+    builder.set_color_space(*frame.color_space());
+  return builder.build();
+}
+
 }  // namespace rtc
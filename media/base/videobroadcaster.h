@@ -11,12 +11,15 @@
 #ifndef MEDIA_BASE_VIDEOBROADCASTER_H_
 #define MEDIA_BASE_VIDEOBROADCASTER_H_
 
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "api/video/video_frame.h"
 #include "api/video/video_sink_interface.h"
+#include "common_video/include/i420_buffer_pool.h"
+#include "media/base/videoadapter.h"
 #include "media/base/videosourcebase.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/thread_checker.h"
@@ -29,10 +32,20 @@ namespace rtc {
 // Sinks must be added and removed on one and only one thread.
 // Video frames can be broadcasted on any thread. I.e VideoBroadcaster::OnFrame
 // can be called on any thread.
+//
+// By default the source is asked to fulfill the most restrictive wants of all
+// sinks, and every sink gets the same frames. A broadcaster that adapts frames
+// for its sinks instead asks the source for the least restrictive wants, and
+// adapts resolution and frame rate for every sink with its own VideoAdapter.
+// Every distinct resolution is scaled only once per frame, and the scaled
+// buffer is shared between the sinks that want it. That saves the repeated
+// scaling when one source feeds many sinks, e.g. one camera track sent on
+// many PeerConnections.
 class VideoBroadcaster : public VideoSourceBase,
                          public VideoSinkInterface<webrtc::VideoFrame> {
  public:
   VideoBroadcaster();
+  explicit VideoBroadcaster(bool adapt_frames_for_sinks);
   ~VideoBroadcaster() override;
   void AddOrUpdateSink(VideoSinkInterface<webrtc::VideoFrame>* sink,
                        const VideoSinkWants& wants) override;
@@ -54,16 +67,40 @@ class VideoBroadcaster : public VideoSourceBase,
   void OnDiscardedFrame() override;
 
  protected:
+  // A buffer scaled for some sink, during the delivery of one frame.
+  struct ScaledBuffer {
+    int cropped_width;
+    int cropped_height;
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
+  };
+
   void UpdateWants() RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
   const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& GetBlackFrameBuffer(
       int width,
       int height) RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
+  // Returns |frame| cropped and scaled as the adapter of |sink| wants, or
+  // absl::nullopt if the adapter drops it. Buffers already scaled for another
+  // sink are taken from |scaled_buffers|, new ones are added to it.
+  absl::optional<webrtc::VideoFrame> AdaptFrameForSink(
+      VideoSinkInterface<webrtc::VideoFrame>* sink,
+      const webrtc::VideoFrame& frame,
+      std::vector<ScaledBuffer>* scaled_buffers)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
 
   ThreadChecker thread_checker_;
   rtc::CriticalSection sinks_and_wants_lock_;
 
+  const bool adapt_frames_for_sinks_;
   VideoSinkWants current_wants_ RTC_GUARDED_BY(sinks_and_wants_lock_);
   rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer_;
+  // The adapters of the sinks, if |adapt_frames_for_sinks_|.
+  std::map<VideoSinkInterface<webrtc::VideoFrame>*,
+           std::unique_ptr<cricket::VideoAdapter>>
+      adapters_ RTC_GUARDED_BY(sinks_and_wants_lock_);
+  // Takes the memory of scaled buffers from the process-wide frame buffer
+  // memory pool, since their resolutions differ between sinks.
+  webrtc::I420BufferPool scaled_buffer_pool_
+      RTC_GUARDED_BY(sinks_and_wants_lock_);
 };
 
 }  // namespace rtc
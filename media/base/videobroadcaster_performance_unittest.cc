@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "api/video/video_frame.h"
+#include "media/base/videobroadcaster.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kViewerWidth = 640;
+constexpr int kViewerHeight = 360;
+constexpr int kFramerate = 30;
+constexpr int kNumFrames = 300;
+constexpr int kQuickNumFrames = 10;
+constexpr int kMaxNumViewers = 8;
+
+// A viewer that wants 360p. Like a VideoStreamEncoder configured for 360p, it
+// scales larger frames itself.
+class ViewerSink : public VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    if (frame.width() == kViewerWidth && frame.height() == kViewerHeight)
+      return;
+    rtc::scoped_refptr<webrtc::I420Buffer> scaled =
+        webrtc::I420Buffer::Create(kViewerWidth, kViewerHeight);
+    scaled->ScaleFrom(*frame.video_frame_buffer()->ToI420());
+  }
+};
+
+// Broadcasts a 720p clip to |num_viewers| 360p viewers and returns the CPU
+// time spent per frame, in ms.
+double BroadcastClip(bool adapt_frames_for_sinks, int num_viewers) {
+  VideoBroadcaster broadcaster(adapt_frames_for_sinks);
+  VideoSinkWants wants;
+  wants.max_pixel_count = kViewerWidth * kViewerHeight;
+  std::vector<std::unique_ptr<ViewerSink>> viewers;
+  for (int i = 0; i < num_viewers; ++i) {
+    viewers.emplace_back(new ViewerSink());
+    broadcaster.AddOrUpdateSink(viewers.back().get(), wants);
+  }
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer =
+      webrtc::I420Buffer::Create(kWidth, kHeight);
+  webrtc::I420Buffer::SetBlack(buffer);
+  const int num_frames = webrtc::field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  const int64_t start_cpu_time_ns = GetProcessCpuTimeNanos();
+  for (int i = 0; i < num_frames; ++i) {
+    broadcaster.OnFrame(webrtc::VideoFrame(
+        buffer, webrtc::kVideoRotation_0,
+        i * rtc::kNumMicrosecsPerSec / kFramerate));
+  }
+  const int64_t cpu_time_ns = GetProcessCpuTimeNanos() - start_cpu_time_ns;
+
+  for (const auto& viewer : viewers)
+    broadcaster.RemoveSink(viewer.get());
+  return static_cast<double>(cpu_time_ns) / rtc::kNumNanosecsPerMillisec /
+         num_frames;
+}
+
+void ReportCpuPerAdditionalViewer(bool adapt_frames_for_sinks,
+                                  const std::string& trace) {
+  const double one_viewer_ms = BroadcastClip(adapt_frames_for_sinks, 1);
+  const double max_viewers_ms =
+      BroadcastClip(adapt_frames_for_sinks, kMaxNumViewers);
+  webrtc::test::PrintResult("broadcast_720p_to_360p_cpu_per_frame", "", trace,
+                            max_viewers_ms, "ms", false);
+  webrtc::test::PrintResult(
+      "broadcast_720p_to_360p_cpu_per_additional_viewer", "", trace,
+      (max_viewers_ms - one_viewer_ms) / (kMaxNumViewers - 1), "ms", true);
+}
+
+}  // namespace
+
+TEST(VideoBroadcasterPerformanceTest, ScalePerViewer) {
+  ReportCpuPerAdditionalViewer(false, "scale_per_viewer");
+}
+
+TEST(VideoBroadcasterPerformanceTest, AdaptFramesForSinks) {
+  ReportCpuPerAdditionalViewer(true, "adapt_frames_for_sinks");
+}
+
+}  // namespace rtc
@@ -10,11 +10,13 @@
 
 #include <limits>
 
+#include "absl/types/optional.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
 #include "media/base/fakevideorenderer.h"
 #include "media/base/videobroadcaster.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/timeutils.h"
 
 using rtc::VideoBroadcaster;
 using rtc::VideoSinkWants;
@@ -192,3 +194,131 @@ TEST(VideoBroadcasterTest, SinkWantsBlackFrames) {
   EXPECT_TRUE(sink2.black_frame());
   EXPECT_EQ(30, sink2.timestamp_us());
 }
+
+namespace {
+
+class LastFrameSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    last_frame_.emplace(frame);
+    ++num_frames_;
+  }
+  void OnDiscardedFrame() override { ++num_discarded_frames_; }
+
+  const webrtc::VideoFrame& last_frame() const { return *last_frame_; }
+  int num_frames() const { return num_frames_; }
+  int num_discarded_frames() const { return num_discarded_frames_; }
+
+ private:
+  absl::optional<webrtc::VideoFrame> last_frame_;
+  int num_frames_ = 0;
+  int num_discarded_frames_ = 0;
+};
+
+webrtc::VideoFrame Create720pFrame(int64_t timestamp_us) {
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(1280, 720));
+  webrtc::I420Buffer::SetBlack(buffer);
+  return webrtc::VideoFrame(buffer, webrtc::kVideoRotation_0, timestamp_us);
+}
+
+}  // namespace
+
+TEST(VideoBroadcasterTest, AdaptFramesForSinksAppliesMaxOfSinkWants) {
+  VideoBroadcaster broadcaster(true /* adapt_frames_for_sinks */);
+
+  FakeVideoRenderer sink1;
+  VideoSinkWants wants1;
+  wants1.max_pixel_count = 640 * 360;
+  wants1.target_pixel_count = 640 * 360;
+  wants1.max_framerate_fps = 15;
+  broadcaster.AddOrUpdateSink(&sink1, wants1);
+
+  FakeVideoRenderer sink2;
+  VideoSinkWants wants2;
+  wants2.max_pixel_count = 1280 * 720;
+  wants2.target_pixel_count = 960 * 540;
+  wants2.max_framerate_fps = 30;
+  broadcaster.AddOrUpdateSink(&sink2, wants2);
+
+  EXPECT_EQ(1280 * 720, broadcaster.wants().max_pixel_count);
+  EXPECT_EQ(960 * 540, *broadcaster.wants().target_pixel_count);
+  EXPECT_EQ(30, broadcaster.wants().max_framerate_fps);
+
+  // A sink without a target lets the source pick any resolution.
+  FakeVideoRenderer sink3;
+  broadcaster.AddOrUpdateSink(&sink3, VideoSinkWants());
+  EXPECT_EQ(std::numeric_limits<int>::max(),
+            broadcaster.wants().max_pixel_count);
+  EXPECT_FALSE(broadcaster.wants().target_pixel_count);
+
+  broadcaster.RemoveSink(&sink3);
+  broadcaster.RemoveSink(&sink2);
+  EXPECT_EQ(640 * 360, broadcaster.wants().max_pixel_count);
+  EXPECT_EQ(15, broadcaster.wants().max_framerate_fps);
+}
+
+TEST(VideoBroadcasterTest, AdaptFramesForSinksScalesForEachSink) {
+  VideoBroadcaster broadcaster(true /* adapt_frames_for_sinks */);
+
+  FakeVideoRenderer sink1;
+  VideoSinkWants wants1;
+  wants1.max_pixel_count = 640 * 360;
+  broadcaster.AddOrUpdateSink(&sink1, wants1);
+
+  FakeVideoRenderer sink2;
+  broadcaster.AddOrUpdateSink(&sink2, VideoSinkWants());
+
+  broadcaster.OnFrame(Create720pFrame(10));
+  EXPECT_EQ(640, sink1.width());
+  EXPECT_EQ(360, sink1.height());
+  EXPECT_EQ(10, sink1.timestamp_us());
+  EXPECT_TRUE(sink1.black_frame());
+  EXPECT_EQ(1280, sink2.width());
+  EXPECT_EQ(720, sink2.height());
+}
+
+TEST(VideoBroadcasterTest, AdaptFramesForSinksSharesScaledBuffers) {
+  VideoBroadcaster broadcaster(true /* adapt_frames_for_sinks */);
+
+  VideoSinkWants wants;
+  wants.max_pixel_count = 640 * 360;
+  LastFrameSink sink1;
+  LastFrameSink sink2;
+  broadcaster.AddOrUpdateSink(&sink1, wants);
+  broadcaster.AddOrUpdateSink(&sink2, wants);
+  LastFrameSink sink3;
+  wants.max_pixel_count = 320 * 180;
+  broadcaster.AddOrUpdateSink(&sink3, wants);
+
+  webrtc::VideoFrame frame = Create720pFrame(10);
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(640, sink1.last_frame().width());
+  EXPECT_EQ(sink1.last_frame().video_frame_buffer(),
+            sink2.last_frame().video_frame_buffer());
+  EXPECT_EQ(320, sink3.last_frame().width());
+  EXPECT_NE(sink1.last_frame().video_frame_buffer(),
+            sink3.last_frame().video_frame_buffer());
+  EXPECT_NE(frame.video_frame_buffer(),
+            sink1.last_frame().video_frame_buffer());
+}
+
+TEST(VideoBroadcasterTest, AdaptFramesForSinksAppliesFramerateOfEachSink) {
+  VideoBroadcaster broadcaster(true /* adapt_frames_for_sinks */);
+
+  LastFrameSink sink1;
+  VideoSinkWants wants1;
+  wants1.max_framerate_fps = 15;
+  broadcaster.AddOrUpdateSink(&sink1, wants1);
+  LastFrameSink sink2;
+  broadcaster.AddOrUpdateSink(&sink2, VideoSinkWants());
+
+  const int64_t kFrameIntervalUs = rtc::kNumMicrosecsPerSec / 30;
+  for (int i = 0; i < 30; ++i)
+    broadcaster.OnFrame(Create720pFrame(i * kFrameIntervalUs));
+
+  EXPECT_EQ(30, sink2.num_frames());
+  EXPECT_EQ(0, sink2.num_discarded_frames());
+  EXPECT_NEAR(15, sink1.num_frames(), 1);
+  EXPECT_EQ(30, sink1.num_frames() + sink1.num_discarded_frames());
+}
@@ -11,15 +11,20 @@
 #include "media/engine/simulcast_encoder_adapter.h"
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <utility>
 
 #include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
 #include "api/video/video_bitrate_allocation.h"
 #include "api/video_codecs/video_encoder_factory.h"
 #include "media/engine/scopedvideoencoder.h"
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/refcountedobject.h"
 #include "system_wrappers/include/clock.h"
 #include "system_wrappers/include/field_trial.h"
 #include "third_party/libyuv/include/libyuv/scale.h"
@@ -31,6 +36,13 @@ const unsigned int kDefaultMaxQp = 56;
 // Max qp for lowest spatial resolution when doing simulcast.
 const unsigned int kLowestResMaxQp = 45;
 
+const char kParallelEncodingFieldTrial[] =
+    "WebRTC-Video-ParallelSimulcastEncoding";
+
+// The longest time the encoder queue waits for the streams that are encoded
+// on other queues. The output of a stream that takes longer is dropped.
+const int kMaxParallelEncodeWaitMs = 100;
+
 absl::optional<unsigned int> GetScreenshareBoostedQpValue() {
   std::string experiment_group =
       webrtc::field_trial::FindFullName("WebRTC-BoostedScreenshareQp");
@@ -96,6 +108,32 @@ int VerifyCodec(const webrtc::VideoCodec* inst) {
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+// Scales |src| to |width| x |height|. NV12 is kept as NV12, so that encoders
+// taking NV12 do not need a conversion. Everything else is scaled as I420.
+rtc::scoped_refptr<webrtc::VideoFrameBuffer> ScaleBuffer(
+    const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& src,
+    int width,
+    int height) {
+  if (src->type() == webrtc::VideoFrameBuffer::Type::kNV12) {
+    rtc::scoped_refptr<webrtc::NV12Buffer> dst_buffer =
+        webrtc::NV12Buffer::Create(width, height);
+    dst_buffer->ScaleFrom(*src->GetNV12());
+    return dst_buffer;
+  }
+  rtc::scoped_refptr<webrtc::I420BufferInterface> src_buffer = src->ToI420();
+  rtc::scoped_refptr<webrtc::I420Buffer> dst_buffer =
+      webrtc::I420Buffer::Create(width, height);
+  libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
+                    src_buffer->DataU(), src_buffer->StrideU(),
+                    src_buffer->DataV(), src_buffer->StrideV(),
+                    src_buffer->width(), src_buffer->height(),
+                    dst_buffer->MutableDataY(), dst_buffer->StrideY(),
+                    dst_buffer->MutableDataU(), dst_buffer->StrideU(),
+                    dst_buffer->MutableDataV(), dst_buffer->StrideV(), width,
+                    height, libyuv::kFilterBilinear);
+  return dst_buffer;
+}
+
 // An EncodedImageCallback implementation that forwards on calls to a
 // SimulcastEncoderAdapter, but with the stream index it's registered with as
 // the first parameter to Encoded.
@@ -121,6 +159,35 @@ class AdapterEncodedImageCallback : public webrtc::EncodedImageCallback {
 
 namespace webrtc {
 
+// The state of the streams of one frame that are encoded on other queues.
+// Shared with the encode tasks, as they may outlive the wait for them.
+struct SimulcastEncoderAdapter::ParallelEncode : public rtc::RefCountInterface {
+  ParallelEncode(const CodecSpecificInfo* codec_specific_info,
+                 const std::vector<FrameType>& frame_types)
+      : frame_types(frame_types) {
+    if (codec_specific_info)
+      this->codec_specific_info = *codec_specific_info;
+  }
+
+  void Encode(VideoEncoder* encoder, const VideoFrame& frame) {
+    const int result = encoder->Encode(
+        frame, codec_specific_info ? &*codec_specific_info : nullptr,
+        &frame_types);
+    if (result != WEBRTC_VIDEO_CODEC_OK) {
+      int expected = WEBRTC_VIDEO_CODEC_OK;
+      first_error.compare_exchange_strong(expected, result);
+    }
+    if (--num_pending == 0)
+      done_event.Set();
+  }
+
+  absl::optional<CodecSpecificInfo> codec_specific_info;
+  const std::vector<FrameType> frame_types;
+  std::atomic<int> num_pending{0};
+  std::atomic<int> first_error{WEBRTC_VIDEO_CODEC_OK};
+  rtc::Event done_event{false, false};
+};
+
 SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory,
                                                  const SdpVideoFormat& format)
     : inited_(0),
@@ -128,7 +195,9 @@ SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory,
       video_format_(format),
       encoded_complete_callback_(nullptr),
       implementation_name_("SimulcastEncoderAdapter"),
-      experimental_boosted_screenshare_qp_(GetScreenshareBoostedQpValue()) {
+      experimental_boosted_screenshare_qp_(GetScreenshareBoostedQpValue()),
+      parallel_encoding_enabled_(
+          webrtc::field_trial::IsEnabled(kParallelEncodingFieldTrial)) {
   RTC_DCHECK(factory_);
 
   // The adapter is typically created on the worker thread, but operated on
@@ -146,6 +215,9 @@ SimulcastEncoderAdapter::~SimulcastEncoderAdapter() {
 int SimulcastEncoderAdapter::Release() {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&encoder_queue_);
 
+  WaitForLateEncodes();
+  encode_queues_.clear();
+
   while (!streaminfos_.empty()) {
     std::unique_ptr<VideoEncoder> encoder =
         std::move(streaminfos_.back().encoder);
@@ -270,6 +342,19 @@ int SimulcastEncoderAdapter::InitEncode(const VideoCodec* inst,
   // To save memory, don't store encoders that we don't use.
   DestroyStoredEncoders();
 
+  size_t num_encode_queues = 0;
+  if (parallel_encoding_enabled_ && doing_simulcast) {
+    num_encode_queues = static_cast<size_t>(
+        std::min(number_of_streams, number_of_cores) - 1);
+  }
+  if (encode_queues_.size() != num_encode_queues) {
+    encode_queues_.clear();
+    for (size_t i = 0; i < num_encode_queues; ++i) {
+      encode_queues_.emplace_back(new rtc::TaskQueue(
+          "SimulcastEncodeQueue", rtc::TaskQueue::Priority::HIGH));
+    }
+  }
+
   rtc::AtomicOps::ReleaseStore(&inited_, 1);
 
   return WEBRTC_VIDEO_CODEC_OK;
@@ -288,6 +373,8 @@ int SimulcastEncoderAdapter::Encode(
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
 
+  WaitForLateEncodes();
+
   // All active streams should generate a key frame if
   // a key frame is requested by any stream.
   bool send_key_frame = false;
@@ -307,6 +394,18 @@ int SimulcastEncoderAdapter::Encode(
     }
   }
 
+  if (!encode_queues_.empty() && input_image.video_frame_buffer()->type() !=
+                                     VideoFrameBuffer::Type::kNative) {
+    for (StreamInfo& stream_info : streaminfos_) {
+      if (send_key_frame && stream_info.send_stream)
+        stream_info.key_frame_request = false;
+    }
+    return EncodeInParallel(
+        input_image, codec_specific_info,
+        std::vector<FrameType>(
+            1, send_key_frame ? kVideoFrameKey : kVideoFrameDelta));
+  }
+
   int src_width = input_image.width();
   int src_height = input_image.height();
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
@@ -344,18 +443,8 @@ int SimulcastEncoderAdapter::Encode(
         return ret;
       }
     } else {
-      rtc::scoped_refptr<I420Buffer> dst_buffer =
-          I420Buffer::Create(dst_width, dst_height);
-      rtc::scoped_refptr<I420BufferInterface> src_buffer =
-          input_image.video_frame_buffer()->ToI420();
-      libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
-                        src_buffer->DataU(), src_buffer->StrideU(),
-                        src_buffer->DataV(), src_buffer->StrideV(), src_width,
-                        src_height, dst_buffer->MutableDataY(),
-                        dst_buffer->StrideY(), dst_buffer->MutableDataU(),
-                        dst_buffer->StrideU(), dst_buffer->MutableDataV(),
-                        dst_buffer->StrideV(), dst_width, dst_height,
-                        libyuv::kFilterBilinear);
+      rtc::scoped_refptr<VideoFrameBuffer> dst_buffer =
+          ScaleBuffer(input_image.video_frame_buffer(), dst_width, dst_height);
 
       int ret = streaminfos_[stream_idx].encoder->Encode(
           VideoFrame(dst_buffer, input_image.timestamp(),
@@ -370,6 +459,123 @@ int SimulcastEncoderAdapter::Encode(
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+int SimulcastEncoderAdapter::EncodeInParallel(
+    const VideoFrame& input_image,
+    const CodecSpecificInfo* codec_specific_info,
+    const std::vector<FrameType>& frame_types) {
+  // Scale the frames of all streams first, from the highest resolution down.
+  // Every stream is scaled from the next larger one, which is cheaper than
+  // scaling each of them from the input.
+  std::vector<absl::optional<VideoFrame>> frames(streaminfos_.size());
+  rtc::scoped_refptr<VideoFrameBuffer> src_buffer;
+  for (size_t i = streaminfos_.size(); i-- > 0;) {
+    if (!streaminfos_[i].send_stream)
+      continue;
+    const int dst_width = streaminfos_[i].width;
+    const int dst_height = streaminfos_[i].height;
+    if (dst_width == input_image.width() &&
+        dst_height == input_image.height()) {
+      frames[i] = input_image;
+      continue;
+    }
+    if (!src_buffer || src_buffer->width() < dst_width ||
+        src_buffer->height() < dst_height) {
+      src_buffer = input_image.video_frame_buffer();
+    }
+    rtc::scoped_refptr<VideoFrameBuffer> dst_buffer =
+        ScaleBuffer(src_buffer, dst_width, dst_height);
+    frames[i] = VideoFrame(dst_buffer, input_image.timestamp(),
+                           input_image.render_time_ms(),
+                           webrtc::kVideoRotation_0);
+    src_buffer = dst_buffer;
+  }
+
+  {
+    rtc::CritScope lock(&outputs_crit_);
+    RTC_DCHECK(held_outputs_.empty());
+    hold_outputs_ = true;
+  }
+
+  // The highest resolution stream, which takes longest, is encoded here. The
+  // others always go to the same queue, so that an encoder is not used on
+  // more than one thread at a time.
+  rtc::scoped_refptr<ParallelEncode> parallel_encode(
+      new rtc::RefCountedObject<ParallelEncode>(codec_specific_info,
+                                                frame_types));
+  size_t last_stream_idx = streaminfos_.size();
+  for (size_t i = 0; i < streaminfos_.size(); ++i) {
+    if (frames[i])
+      last_stream_idx = i;
+  }
+  for (size_t i = 0; i < last_stream_idx; ++i) {
+    if (frames[i])
+      ++parallel_encode->num_pending;
+  }
+  const bool posted = parallel_encode->num_pending > 0;
+  for (size_t i = 0; i < last_stream_idx; ++i) {
+    if (!frames[i])
+      continue;
+    VideoEncoder* encoder = streaminfos_[i].encoder.get();
+    const VideoFrame frame = *frames[i];
+    encode_queues_[i % encode_queues_.size()]->PostTask(
+        [parallel_encode, encoder, frame] {
+          parallel_encode->Encode(encoder, frame);
+        });
+  }
+  int result = WEBRTC_VIDEO_CODEC_OK;
+  if (last_stream_idx < streaminfos_.size()) {
+    result = streaminfos_[last_stream_idx].encoder->Encode(
+        *frames[last_stream_idx], codec_specific_info, &frame_types);
+  }
+  if (posted && !parallel_encode->done_event.Wait(kMaxParallelEncodeWaitMs)) {
+    RTC_LOG(LS_WARNING) << "Simulcast streams took longer than "
+                        << kMaxParallelEncodeWaitMs
+                        << " ms to encode, dropping their output.";
+    late_encode_ = parallel_encode;
+  }
+
+  std::vector<std::unique_ptr<EncodedOutput>> outputs;
+  {
+    rtc::CritScope lock(&outputs_crit_);
+    hold_outputs_ = false;
+    drop_outputs_ = late_encode_.get() != nullptr;
+    outputs.swap(held_outputs_);
+  }
+  std::stable_sort(outputs.begin(), outputs.end(),
+                   [](const std::unique_ptr<EncodedOutput>& a,
+                      const std::unique_ptr<EncodedOutput>& b) {
+                     return a->stream_idx < b->stream_idx;
+                   });
+  for (const auto& output : outputs) {
+    DeliverEncodedImage(
+        output->stream_idx, output->encoded_image,
+        &output->codec_specific_info,
+        output->fragmentation ? &*output->fragmentation : nullptr);
+  }
+
+  // Errors of the streams that are still encoding are not reported.
+  if (result == WEBRTC_VIDEO_CODEC_OK)
+    result = parallel_encode->first_error;
+  return result;
+}
+
+void SimulcastEncoderAdapter::WaitForLateEncodes() {
+  if (!late_encode_)
+    return;
+  late_encode_->done_event.Wait(rtc::Event::kForever);
+  late_encode_ = nullptr;
+
+  std::vector<size_t> dropped_streams;
+  {
+    rtc::CritScope lock(&outputs_crit_);
+    drop_outputs_ = false;
+    dropped_streams.swap(dropped_streams_);
+  }
+  // The next frames of these streams may refer to the dropped ones.
+  for (size_t stream_idx : dropped_streams)
+    streaminfos_[stream_idx].key_frame_request = true;
+}
+
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&encoder_queue_);
@@ -380,6 +586,7 @@ int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
 int SimulcastEncoderAdapter::SetChannelParameters(uint32_t packet_loss,
                                                   int64_t rtt) {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&encoder_queue_);
+  WaitForLateEncodes();
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
     streaminfos_[stream_idx].encoder->SetChannelParameters(packet_loss, rtt);
   }
@@ -418,6 +625,7 @@ int SimulcastEncoderAdapter::SetRateAllocation(
 
   codec_.maxFramerate = new_framerate;
 
+  WaitForLateEncodes();
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
     uint32_t stream_bitrate_kbps =
         bitrate.GetSpatialLayerSum(stream_idx) / 1000;
@@ -450,6 +658,48 @@ EncodedImageCallback::Result SimulcastEncoderAdapter::OnEncodedImage(
     const EncodedImage& encodedImage,
     const CodecSpecificInfo* codecSpecificInfo,
     const RTPFragmentationHeader* fragmentation) {
+  {
+    rtc::CritScope lock(&outputs_crit_);
+    if (hold_outputs_) {
+      held_outputs_.emplace_back(new EncodedOutput(
+          stream_idx, encodedImage, codecSpecificInfo, fragmentation));
+      return EncodedImageCallback::Result(EncodedImageCallback::Result::OK);
+    }
+    if (drop_outputs_) {
+      // Delivering it now would put it after the later frames of the other
+      // streams, and on the wrong thread.
+      dropped_streams_.push_back(stream_idx);
+      return EncodedImageCallback::Result(
+          EncodedImageCallback::Result::ERROR_SEND_FAILED);
+    }
+  }
+  return DeliverEncodedImage(stream_idx, encodedImage, codecSpecificInfo,
+                             fragmentation);
+}
+
+SimulcastEncoderAdapter::EncodedOutput::EncodedOutput(
+    size_t stream_index,
+    const EncodedImage& image,
+    const CodecSpecificInfo* info,
+    const RTPFragmentationHeader* fragmentation_header)
+    : stream_idx(stream_index),
+      data(image._buffer, image._buffer + image._length),
+      encoded_image(image),
+      codec_specific_info(*info) {
+  // The encoder may reuse its buffer once it has returned.
+  encoded_image._buffer = data.data();
+  encoded_image._size = data.size();
+  if (fragmentation_header) {
+    fragmentation.emplace();
+    fragmentation->CopyFrom(*fragmentation_header);
+  }
+}
+
+EncodedImageCallback::Result SimulcastEncoderAdapter::DeliverEncodedImage(
+    size_t stream_idx,
+    const EncodedImage& encodedImage,
+    const CodecSpecificInfo* codecSpecificInfo,
+    const RTPFragmentationHeader* fragmentation) {
   EncodedImage stream_image(encodedImage);
   CodecSpecificInfo stream_codec_specific = *codecSpecificInfo;
   stream_codec_specific.codec_name = implementation_name_.c_str();
@@ -22,7 +22,11 @@
 #include "media/engine/webrtcvideoencoderfactory.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "rtc_base/atomicops.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/sequenced_task_checker.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
 
@@ -33,6 +37,10 @@ class VideoEncoderFactory;
 // webrtc::VideoEncoder instances with the given VideoEncoderFactory.
 // The object is created and destroyed on the worker thread, but all public
 // interfaces should be called from the encoder task queue.
+// With the field trial WebRTC-Video-ParallelSimulcastEncoding, the streams
+// are encoded at the same time on a few task queues when there is more than
+// one core, and each stream is scaled from the next larger one. The encoded
+// images are still delivered in stream order, from the lowest resolution up.
 class SimulcastEncoderAdapter : public VideoEncoder {
  public:
   explicit SimulcastEncoderAdapter(VideoEncoderFactory* factory,
@@ -87,6 +95,39 @@ class SimulcastEncoderAdapter : public VideoEncoder {
     bool send_stream;
   };
 
+  // The output of an encoder, held back while the streams are encoded in
+  // parallel.
+  struct EncodedOutput {
+    EncodedOutput(size_t stream_idx,
+                  const EncodedImage& encoded_image,
+                  const CodecSpecificInfo* codec_specific_info,
+                  const RTPFragmentationHeader* fragmentation);
+
+    const size_t stream_idx;
+    std::vector<uint8_t> data;
+    EncodedImage encoded_image;
+    CodecSpecificInfo codec_specific_info;
+    absl::optional<RTPFragmentationHeader> fragmentation;
+  };
+
+  struct ParallelEncode;
+
+  // Encodes the streams to send on |encode_queues_| and the calling thread.
+  int EncodeInParallel(const VideoFrame& input_image,
+                       const CodecSpecificInfo* codec_specific_info,
+                       const std::vector<FrameType>& frame_types);
+
+  // Waits for the streams that EncodeInParallel() stopped waiting for, so that
+  // their encoders are not used on two threads at once, and requests key
+  // frames on the streams whose output was dropped.
+  void WaitForLateEncodes();
+
+  EncodedImageCallback::Result DeliverEncodedImage(
+      size_t stream_idx,
+      const EncodedImage& encoded_image,
+      const CodecSpecificInfo* codec_specific_info,
+      const RTPFragmentationHeader* fragmentation);
+
   // Populate the codec settings for each simulcast stream.
   void PopulateStreamCodec(const webrtc::VideoCodec& inst,
                            int stream_index,
@@ -114,6 +155,25 @@ class SimulcastEncoderAdapter : public VideoEncoder {
   std::stack<std::unique_ptr<VideoEncoder>> stored_encoders_;
 
   const absl::optional<unsigned int> experimental_boosted_screenshare_qp_;
+
+  const bool parallel_encoding_enabled_;
+  // Encode the streams, apart from the highest resolution one which is
+  // encoded on the encoder task queue. Only used if there is more than one
+  // stream and core.
+  std::vector<std::unique_ptr<rtc::TaskQueue>> encode_queues_;
+  // The streams of the last frame that were still encoding when
+  // EncodeInParallel() returned.
+  rtc::scoped_refptr<ParallelEncode> late_encode_;
+
+  rtc::CriticalSection outputs_crit_;
+  // Set while the streams are encoded in parallel.
+  bool hold_outputs_ RTC_GUARDED_BY(outputs_crit_) = false;
+  // Set while |late_encode_| is pending. Its output is dropped, as it would
+  // arrive off the encoder queue and after later frames of other streams.
+  bool drop_outputs_ RTC_GUARDED_BY(outputs_crit_) = false;
+  std::vector<size_t> dropped_streams_ RTC_GUARDED_BY(outputs_crit_);
+  std::vector<std::unique_ptr<EncodedOutput>> held_outputs_
+      RTC_GUARDED_BY(outputs_crit_);
 };
 
 }  // namespace webrtc
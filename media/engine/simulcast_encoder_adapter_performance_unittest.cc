@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/video/video_frame.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "media/engine/internalencoderfactory.h"
+#include "media/engine/simulcast_encoder_adapter.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "modules/video_coding/utility/simulcast_rate_allocator.h"
+#include "modules/video_coding/utility/simulcast_test_fixture_impl.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/field_trial.h"
+#include "test/frame_generator.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kFramerate = 30;
+constexpr int kBitrateKbps = 2500;
+constexpr int kNumFrames = 300;
+constexpr int kQuickNumFrames = 10;
+constexpr int kTemporalLayerProfile[3] = {1, 1, 1};
+
+// Measures the time from handing a captured frame to the adapter until the
+// encoded image of the last stream is delivered for packetization.
+class LatencyMeter : public EncodedImageCallback {
+ public:
+  explicit LatencyMeter(size_t num_streams) : num_streams_(num_streams) {}
+
+  void StartFrame() {
+    capture_time_us_ = rtc::TimeMicros();
+    num_delivered_ = 0;
+  }
+
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    if (++num_delivered_ == num_streams_) {
+      total_latency_us_ += rtc::TimeMicros() - capture_time_us_;
+      ++num_frames_;
+    }
+    return Result(Result::OK);
+  }
+
+  double AverageLatencyMs() const {
+    return num_frames_ == 0 ? 0.0
+                            : total_latency_us_ / 1000.0 / num_frames_;
+  }
+
+ private:
+  const size_t num_streams_;
+  int64_t capture_time_us_ = 0;
+  size_t num_delivered_ = 0;
+  int64_t total_latency_us_ = 0;
+  int num_frames_ = 0;
+};
+
+// Encodes a 720p clip in three VP8 simulcast streams and returns the average
+// capture to packetization latency in ms.
+double EncodeSimulcastClip() {
+  VideoCodec codec;
+  test::SimulcastTestFixtureImpl::DefaultSettings(
+      &codec, kTemporalLayerProfile, kVideoCodecVP8);
+  codec.width = kWidth;
+  codec.height = kHeight;
+  codec.maxFramerate = kFramerate;
+  codec.startBitrate = kBitrateKbps;
+  codec.maxBitrate = kBitrateKbps;
+
+  InternalEncoderFactory encoder_factory;
+  SimulcastEncoderAdapter adapter(&encoder_factory, SdpVideoFormat("VP8"));
+  LatencyMeter latency_meter(codec.numberOfSimulcastStreams);
+  adapter.RegisterEncodeCompleteCallback(&latency_meter);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter.InitEncode(&codec, CpuInfo::DetectNumberOfCores(),
+                               1200 /* max payload size */));
+  SimulcastRateAllocator rate_allocator(codec);
+  adapter.SetRateAllocation(
+      rate_allocator.GetAllocation(kBitrateKbps * 1000, kFramerate),
+      kFramerate);
+
+  std::unique_ptr<test::FrameGenerator> frame_generator =
+      test::FrameGenerator::CreateSquareGenerator(
+          kWidth, kHeight, test::FrameGenerator::OutputType::I420,
+          absl::nullopt);
+  const int num_frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  for (int i = 0; i < num_frames; ++i) {
+    VideoFrame* frame = frame_generator->NextFrame();
+    frame->set_timestamp(static_cast<uint32_t>((i + 1) * 90000 / kFramerate));
+    std::vector<FrameType> frame_types(
+        codec.numberOfSimulcastStreams,
+        i == 0 ? kVideoFrameKey : kVideoFrameDelta);
+    latency_meter.StartFrame();
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              adapter.Encode(*frame, nullptr, &frame_types));
+  }
+  adapter.Release();
+  return latency_meter.AverageLatencyMs();
+}
+
+}  // namespace
+
+TEST(SimulcastEncoderAdapterPerformanceTest, SequentialEncoding) {
+  test::PrintResult("simulcast_720p_capture_to_packetize", "", "sequential",
+                    EncodeSimulcastClip(), "ms", true);
+}
+
+TEST(SimulcastEncoderAdapterPerformanceTest, ParallelEncoding) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-ParallelSimulcastEncoding/Enabled/");
+  test::PrintResult("simulcast_720p_capture_to_packetize", "", "parallel",
+                    EncodeSimulcastClip(), "ms", true);
+}
+
+}  // namespace webrtc
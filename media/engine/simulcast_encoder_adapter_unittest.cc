@@ -9,6 +9,7 @@
  */
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -23,12 +24,17 @@
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "modules/video_coding/utility/simulcast_test_fixture_impl.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread_types.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/field_trial.h"
 #include "test/function_video_decoder_factory.h"
 #include "test/function_video_encoder_factory.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
 using ::testing::_;
+using ::testing::Invoke;
 using ::testing::Return;
 
 namespace webrtc {
@@ -38,6 +44,7 @@ namespace {
 
 constexpr int kDefaultWidth = 1280;
 constexpr int kDefaultHeight = 720;
+constexpr int kDefaultTimeoutMs = 5000;
 
 std::unique_ptr<SimulcastTestFixture> CreateSpecificSimulcastTestFixture(
     VideoEncoderFactory* internal_encoder_factory) {
@@ -341,6 +348,7 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
     last_encoded_image_height_ = encoded_image._encodedHeight;
     last_encoded_image_simulcast_index_ =
         encoded_image.SpatialIndex().value_or(-1);
+    encoded_simulcast_indices_.push_back(last_encoded_image_simulcast_index_);
 
     return Result(Result::OK, encoded_image.Timestamp());
   }
@@ -440,6 +448,7 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
   int last_encoded_image_width_;
   int last_encoded_image_height_;
   int last_encoded_image_simulcast_index_;
+  std::vector<int> encoded_simulcast_indices_;
   std::unique_ptr<SimulcastRateAllocator> rate_allocator_;
 };
 
@@ -872,6 +881,131 @@ TEST_F(TestSimulcastEncoderAdapterFake, TestFailureReturnCodesFromEncodeCalls) {
             adapter_->Encode(input_frame, nullptr, &frame_types));
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake, EncodesStreamsInParallelInStreamOrder) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-ParallelSimulcastEncoding/Enabled/");
+  adapter_.reset();
+  helper_.reset(new TestSimulcastEncoderAdapterFakeHelper());
+  adapter_.reset(helper_->CreateMockEncoderAdapter());
+  SimulcastTestFixtureImpl::DefaultSettings(
+      &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
+      kVideoCodecVP8);
+  rate_allocator_.reset(new SimulcastRateAllocator(codec_));
+  const uint32_t target_bitrate =
+      1000 * (codec_.simulcastStream[0].targetBitrate +
+              codec_.simulcastStream[1].targetBitrate +
+              codec_.simulcastStream[2].minBitrate);
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, 3, 1200));
+  adapter_->RegisterEncodeCompleteCallback(this);
+  adapter_->SetRateAllocation(
+      rate_allocator_->GetAllocation(target_bitrate, 30), 30);
+
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+  const rtc::PlatformThreadRef calling_thread = rtc::CurrentThreadRef();
+  for (size_t i = 0; i < encoders.size(); ++i) {
+    MockVideoEncoder* encoder = encoders[i];
+    EXPECT_CALL(*encoder, Encode(_, _, _))
+        .WillOnce(Invoke([encoder, i, calling_thread](
+                             const VideoFrame& frame,
+                             const CodecSpecificInfo* codec_specific_info,
+                             const std::vector<FrameType>* frame_types) {
+          EXPECT_EQ(encoder->codec().width, frame.width());
+          EXPECT_EQ(encoder->codec().height, frame.height());
+          // Only the highest resolution stream is encoded on the calling
+          // thread.
+          EXPECT_EQ(i == 2, rtc::IsThreadRefEqual(rtc::CurrentThreadRef(),
+                                                  calling_thread));
+          // Let the lower resolution streams finish last.
+          SleepMs(10 * (2 - i));
+          encoder->SendEncodedImage(frame.width(), frame.height());
+          return WEBRTC_VIDEO_CODEC_OK;
+        }));
+  }
+
+  rtc::scoped_refptr<I420Buffer> input_buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  input_buffer->InitializeData();
+  VideoFrame input_frame(input_buffer, 0, 0, webrtc::kVideoRotation_0);
+  std::vector<FrameType> frame_types(3, kVideoFrameKey);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, nullptr, &frame_types));
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), encoded_simulcast_indices_);
+}
+
+TEST_F(TestSimulcastEncoderAdapterFake, DoesNotWaitLongForSlowParallelStream) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-ParallelSimulcastEncoding/Enabled/");
+  adapter_.reset();
+  helper_.reset(new TestSimulcastEncoderAdapterFakeHelper());
+  adapter_.reset(helper_->CreateMockEncoderAdapter());
+  SimulcastTestFixtureImpl::DefaultSettings(
+      &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
+      kVideoCodecVP8);
+  rate_allocator_.reset(new SimulcastRateAllocator(codec_));
+  const uint32_t target_bitrate =
+      1000 * (codec_.simulcastStream[0].targetBitrate +
+              codec_.simulcastStream[1].targetBitrate +
+              codec_.simulcastStream[2].minBitrate);
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, 3, 1200));
+  adapter_->RegisterEncodeCompleteCallback(this);
+  adapter_->SetRateAllocation(
+      rate_allocator_->GetAllocation(target_bitrate, 30), 30);
+
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+  rtc::Event continue_event(false, false);
+  std::atomic<bool> slow_stream_done(false);
+  for (size_t i = 0; i < encoders.size(); ++i) {
+    MockVideoEncoder* encoder = encoders[i];
+    EXPECT_CALL(*encoder, Encode(_, _, _))
+        .WillOnce(Invoke([encoder, i, &continue_event, &slow_stream_done](
+                             const VideoFrame& frame,
+                             const CodecSpecificInfo* codec_specific_info,
+                             const std::vector<FrameType>* frame_types) {
+          // The lowest resolution stream is stuck until the adapter has
+          // returned, and then takes a while longer.
+          if (i == 0) {
+            EXPECT_TRUE(continue_event.Wait(kDefaultTimeoutMs));
+            SleepMs(50);
+          }
+          encoder->SendEncodedImage(frame.width(), frame.height());
+          if (i == 0)
+            slow_stream_done = true;
+          return WEBRTC_VIDEO_CODEC_OK;
+        }))
+        .WillOnce(Invoke([encoder, &slow_stream_done](
+                             const VideoFrame& frame,
+                             const CodecSpecificInfo* codec_specific_info,
+                             const std::vector<FrameType>* frame_types) {
+          EXPECT_TRUE(slow_stream_done);
+          // The slow stream may refer to its dropped frame otherwise.
+          EXPECT_EQ(kVideoFrameKey, (*frame_types)[0]);
+          encoder->SendEncodedImage(frame.width(), frame.height());
+          return WEBRTC_VIDEO_CODEC_OK;
+        }));
+  }
+
+  rtc::scoped_refptr<I420Buffer> input_buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  input_buffer->InitializeData();
+  VideoFrame input_frame(input_buffer, 0, 0, webrtc::kVideoRotation_0);
+  std::vector<FrameType> frame_types(3, kVideoFrameKey);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, nullptr, &frame_types));
+  EXPECT_EQ(std::vector<int>({1, 2}), encoded_simulcast_indices_);
+
+  // The slow stream is done before its encoder is used again, and its late
+  // output is dropped.
+  continue_event.Set();
+  adapter_->SetRateAllocation(
+      rate_allocator_->GetAllocation(target_bitrate, 30), 30);
+  EXPECT_TRUE(slow_stream_done);
+  EXPECT_EQ(std::vector<int>({1, 2}), encoded_simulcast_indices_);
+
+  frame_types.assign(3, kVideoFrameDelta);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, nullptr, &frame_types));
+  EXPECT_EQ(std::vector<int>({1, 2, 0, 1, 2}), encoded_simulcast_indices_);
+}
+
 TEST_F(TestSimulcastEncoderAdapterFake, TestInitFailureCleansUpEncoders) {
   SimulcastTestFixtureImpl::DefaultSettings(
       &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
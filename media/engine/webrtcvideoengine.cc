@@ -1489,6 +1489,19 @@ bool WebRtcVideoChannel::SendRtp(const uint8_t* data,
   return MediaChannel::SendPacket(&packet, rtc_options);
 }
 
+bool WebRtcVideoChannel::SendRtpFragments(
+    rtc::ArrayView<const rtc::ArrayView<const uint8_t>> fragments,
+    const webrtc::PacketOptions& options) {
+  // SRTP protects the packet in place, so this is where a payload referenced
+  // from the encoded frame is finally copied.
+  rtc::CopyOnWriteBuffer packet(0, kMaxRtpPacketLen);
+  for (const auto& fragment : fragments)
+    packet.AppendData(fragment.data(), fragment.size());
+  rtc::PacketOptions rtc_options;
+  rtc_options.packet_id = options.packet_id;
+  return MediaChannel::SendPacket(&packet, rtc_options);
+}
+
 bool WebRtcVideoChannel::SendRtcp(const uint8_t* data, size_t len) {
   rtc::CopyOnWriteBuffer packet(data, len, kMaxRtpPacketLen);
   return MediaChannel::SendRtcp(&packet, rtc::PacketOptions());
@@ -435,6 +435,9 @@ class WebRtcVideoChannel : public VideoMediaChannel, public webrtc::Transport {
   bool SendRtp(const uint8_t* data,
                size_t len,
                const webrtc::PacketOptions& options) override;
+  bool SendRtpFragments(
+      rtc::ArrayView<const rtc::ArrayView<const uint8_t>> fragments,
+      const webrtc::PacketOptions& options) override;
   bool SendRtcp(const uint8_t* data, size_t len) override;
 
   static std::vector<VideoCodecSettings> MapCodecs(
@@ -35,13 +35,10 @@ namespace webrtc {
 namespace acm2 {
 
 AcmReceiver::AcmReceiver(const AudioCodingModule::Config& config)
-    : last_audio_buffer_(new int16_t[AudioFrame::kMaxDataSizeSamples]),
-      neteq_(NetEq::Create(config.neteq_config, config.decoder_factory)),
+    : neteq_(NetEq::Create(config.neteq_config, config.decoder_factory)),
       clock_(config.clock),
       resampled_last_output_frame_(true) {
   RTC_DCHECK(clock_);
-  memset(last_audio_buffer_.get(), 0,
-         sizeof(int16_t) * AudioFrame::kMaxDataSizeSamples);
 }
 
 AcmReceiver::~AcmReceiver() = default;
@@ -135,10 +132,16 @@ int AcmReceiver::GetAudio(int desired_freq_hz,
       (desired_freq_hz != -1) && (current_sample_rate_hz != desired_freq_hz);
 
   if (need_resampling && !resampled_last_output_frame_) {
-    // Prime the resampler with the last frame.
+    // Prime the resampler with the last frame, or with silence if there was
+    // less audio.
+    const size_t last_audio_length =
+        static_cast<size_t>(current_sample_rate_hz / 100) *
+        audio_frame->num_channels_;
+    if (last_audio_buffer_.size() < last_audio_length)
+      last_audio_buffer_.resize(last_audio_length, 0);
     int16_t temp_output[AudioFrame::kMaxDataSizeSamples];
     int samples_per_channel_int = resampler_.Resample10Msec(
-        last_audio_buffer_.get(), current_sample_rate_hz, desired_freq_hz,
+        last_audio_buffer_.data(), current_sample_rate_hz, desired_freq_hz,
         audio_frame->num_channels_, AudioFrame::kMaxDataSizeSamples,
         temp_output);
     if (samples_per_channel_int < 0) {
@@ -171,17 +174,26 @@ int AcmReceiver::GetAudio(int desired_freq_hz,
   } else {
     resampled_last_output_frame_ = false;
     // We might end up here ONLY if codec is changed.
-  }
 
-  // Store current audio in |last_audio_buffer_| for next time.
-  memcpy(last_audio_buffer_.get(), audio_frame->data(),
-         sizeof(int16_t) * audio_frame->samples_per_channel_ *
-             audio_frame->num_channels_);
+    // Store current audio in |last_audio_buffer_|, to prime the resampler
+    // with if the next frame is resampled.
+    last_audio_buffer_.assign(
+        audio_frame->data(),
+        audio_frame->data() +
+            audio_frame->samples_per_channel_ * audio_frame->num_channels_);
+  }
 
   call_stats_.DecodedByNetEq(audio_frame->speech_type_, *muted);
   return 0;
 }
 
+void AcmReceiver::SkipAudio() {
+  rtc::CritScope lock(&crit_sect_);
+  neteq_->SkipAudio();
+  // The resampler is primed again when audio is next resampled.
+  resampled_last_output_frame_ = false;
+}
+
 void AcmReceiver::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
   neteq_->SetCodecs(codecs);
 }
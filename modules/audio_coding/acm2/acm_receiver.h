@@ -78,6 +78,9 @@ class AcmReceiver {
   //
   int GetAudio(int desired_freq_hz, AudioFrame* audio_frame, bool* muted);
 
+  // Advances the playout by 10 ms without decoding. See NetEq::SkipAudio().
+  void SkipAudio();
+
   // Replace the current set of decoders with the specified set.
   void SetCodecs(const std::map<int, SdpAudioFormat>& codecs);
 
@@ -276,7 +279,9 @@ class AcmReceiver {
   absl::optional<CodecInst> last_audio_decoder_ RTC_GUARDED_BY(crit_sect_);
   absl::optional<SdpAudioFormat> last_audio_format_ RTC_GUARDED_BY(crit_sect_);
   ACMResampler resampler_ RTC_GUARDED_BY(crit_sect_);
-  std::unique_ptr<int16_t[]> last_audio_buffer_ RTC_GUARDED_BY(crit_sect_);
+  // The last output that was not resampled. Sized for it, rather than for
+  // the largest AudioFrame.
+  std::vector<int16_t> last_audio_buffer_ RTC_GUARDED_BY(crit_sect_);
   CallStatistics call_stats_ RTC_GUARDED_BY(crit_sect_);
   const std::unique_ptr<NetEq> neteq_;  // NetEq is thread-safe; no lock needed.
   const Clock* const clock_;
@@ -621,6 +621,13 @@ class AudioCodingModule {
                                   AudioFrame* audio_frame,
                                   bool* muted) = 0;
 
+  ///////////////////////////////////////////////////////////////////////////
+  // void SkipPlayoutData10Ms()
+  // Advances the playout by 10 milliseconds without decoding, for when the
+  // audio would not be used. See NetEq::SkipAudio().
+  //
+  virtual void SkipPlayoutData10Ms() = 0;
+
   ///////////////////////////////////////////////////////////////////////////
   //   Codec specific
   //
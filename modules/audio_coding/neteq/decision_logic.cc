@@ -198,6 +198,18 @@ void DecisionLogic::ExpandDecision(Operations operation) {
   }
 }
 
+void DecisionLogic::UpdateBufferLevelWhileSkipping(
+    const SyncBuffer& sync_buffer,
+    const Expand& expand,
+    size_t decoder_frame_length,
+    Modes prev_mode) {
+  const size_t samples_left =
+      sync_buffer.FutureLength() - expand.overlap_length();
+  const size_t cur_size_samples =
+      samples_left + packet_buffer_.NumSamplesInBuffer(decoder_frame_length);
+  FilterBufferLevel(cur_size_samples, prev_mode);
+}
+
 void DecisionLogic::FilterBufferLevel(size_t buffer_size_samples,
                                       Modes prev_mode) {
   // Do not update buffer history if currently playing CNG since it will bias
@@ -84,6 +84,15 @@ class DecisionLogic final {
                          size_t generated_noise_samples,
                          bool* reset_decoder);
 
+  // Updates the buffer level filter for an output block that was skipped
+  // instead of played out, so that the filtered level keeps tracking the
+  // buffer while GetDecision is not called. The arguments are the same as
+  // for GetDecision.
+  void UpdateBufferLevelWhileSkipping(const SyncBuffer& sync_buffer,
+                                      const Expand& expand,
+                                      size_t decoder_frame_length,
+                                      Modes prev_mode);
+
   // These methods test the |cng_state_| for different conditions.
   bool CngRfc3389On() const { return cng_state_ == kCngRfc3389On; }
   bool CngOff() const { return cng_state_ == kCngOff; }
@@ -154,6 +154,13 @@ class NetEq {
       bool* muted,
       absl::optional<Operations> action_override = absl::nullopt) = 0;
 
+  // Advances the playout by 10 ms without decoding, as if the audio had been
+  // played out. Packets that are too late to be played out after this are
+  // discarded; the others remain buffered, so that the jitter buffer keeps
+  // its timing. The decoder is reset before it decodes again. Useful for
+  // streams whose audio is not used for the moment.
+  virtual void SkipAudio() = 0;
+
   // Replaces the current set of decoders with the given one.
   virtual void SetCodecs(const std::map<int, SdpAudioFormat>& codecs) = 0;
 
@@ -223,6 +223,33 @@ int NetEqImpl::GetAudio(AudioFrame* audio_frame,
   return kOK;
 }
 
+void NetEqImpl::SkipAudio() {
+  TRACE_EVENT0("webrtc", "NetEqImpl::SkipAudio");
+  rtc::CritScope lock(&crit_sect_);
+  last_decoded_timestamps_.clear();
+  tick_timer_->Increment();
+  stats_.IncreaseCounter(output_size_samples_, fs_hz_);
+  if (first_packet_)
+    return;
+  // Keep the filtered buffer level current, so that the first decision after
+  // skipping acts on the actual buffer and not the level from before. This
+  // sees the buffer as GetDecision would have before playing out the block.
+  decision_logic_->UpdateBufferLevelWhileSkipping(
+      *sync_buffer_, *expand_, decoder_frame_length_, last_mode_);
+  // Move the end of |sync_buffer_| along with the playout, so that decoding
+  // resumes with the packets that are due by then.
+  const uint32_t samples = static_cast<uint32_t>(output_size_samples_);
+  playout_timestamp_ += samples;
+  sync_buffer_->IncreaseEndTimestamp(samples);
+  packet_buffer_->DiscardOldPackets(sync_buffer_->end_timestamp(), 5 * fs_hz_,
+                                    &stats_);
+  // Packets older than the skipped audio are late, just as if it had been
+  // played out, and must not feed the delay manager.
+  timestamp_ = sync_buffer_->end_timestamp();
+  // The decoder state no longer matches the next packet.
+  reset_decoder_ = true;
+}
+
 void NetEqImpl::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
   rtc::CritScope lock(&crit_sect_);
   const std::vector<int> changed_payload_types =
@@ -1299,6 +1326,7 @@ int NetEqImpl::Decode(PacketList* packet_list,
                       Operations* operation,
                       int* decoded_length,
                       AudioDecoder::SpeechType* speech_type) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::Decode");
   *speech_type = AudioDecoder::kSpeech;
 
   // When packet_list is empty, we may be in kCodecInternalCng mode, and for
@@ -1495,6 +1523,7 @@ void NetEqImpl::DoNormal(const int16_t* decoded_buffer,
                          size_t decoded_length,
                          AudioDecoder::SpeechType speech_type,
                          bool play_dtmf) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoNormal");
   assert(normal_.get());
   normal_->Process(decoded_buffer, decoded_length, last_mode_,
                    algorithm_buffer_.get());
@@ -1518,6 +1547,7 @@ void NetEqImpl::DoMerge(int16_t* decoded_buffer,
                         size_t decoded_length,
                         AudioDecoder::SpeechType speech_type,
                         bool play_dtmf) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoMerge");
   assert(merge_.get());
   size_t new_length =
       merge_->Process(decoded_buffer, decoded_length, algorithm_buffer_.get());
@@ -1589,6 +1619,7 @@ bool NetEqImpl::DoCodecPlc() {
 }
 
 int NetEqImpl::DoExpand(bool play_dtmf) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoExpand");
   while ((sync_buffer_->FutureLength() - expand_->overlap_length()) <
          output_size_samples_) {
     algorithm_buffer_->Clear();
@@ -1631,6 +1662,7 @@ int NetEqImpl::DoAccelerate(int16_t* decoded_buffer,
                             AudioDecoder::SpeechType speech_type,
                             bool play_dtmf,
                             bool fast_accelerate) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoAccelerate");
   const size_t required_samples =
       static_cast<size_t>(240 * fs_mult_);  // Must have 30 ms.
   size_t borrowed_samples_per_channel = 0;
@@ -1703,6 +1735,7 @@ int NetEqImpl::DoPreemptiveExpand(int16_t* decoded_buffer,
                                   size_t decoded_length,
                                   AudioDecoder::SpeechType speech_type,
                                   bool play_dtmf) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoPreemptiveExpand");
   const size_t required_samples =
       static_cast<size_t>(240 * fs_mult_);  // Must have 30 ms.
   size_t num_channels = algorithm_buffer_->Channels();
@@ -1766,6 +1799,7 @@ int NetEqImpl::DoPreemptiveExpand(int16_t* decoded_buffer,
 }
 
 int NetEqImpl::DoRfc3389Cng(PacketList* packet_list, bool play_dtmf) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoRfc3389Cng");
   if (!packet_list->empty()) {
     // Must have exactly one SID frame at this point.
     assert(packet_list->size() == 1);
@@ -1799,6 +1833,7 @@ int NetEqImpl::DoRfc3389Cng(PacketList* packet_list, bool play_dtmf) {
 
 void NetEqImpl::DoCodecInternalCng(const int16_t* decoded_buffer,
                                    size_t decoded_length) {
+  TRACE_EVENT0("webrtc", "NetEqImpl::DoCodecInternalCng");
   RTC_DCHECK(normal_.get());
   normal_->Process(decoded_buffer, decoded_length, last_mode_,
                    algorithm_buffer_.get());
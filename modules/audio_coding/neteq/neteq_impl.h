@@ -136,6 +136,8 @@ class NetEqImpl : public webrtc::NetEq {
       bool* muted,
       absl::optional<Operations> action_override = absl::nullopt) override;
 
+  void SkipAudio() override;
+
   void SetCodecs(const std::map<int, SdpAudioFormat>& codecs) override;
 
   int RegisterPayloadType(NetEqDecoder codec,
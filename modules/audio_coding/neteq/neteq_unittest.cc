@@ -1632,6 +1632,83 @@ TEST_F(NetEqDecodingTest, LastDecodedTimestampsTwoDecoded) {
             neteq_->LastDecodedTimestamps());
 }
 
+// Verifies that skipped audio is not decoded, that the packets that are due
+// are dropped, and that decoding resumes in time once audio is fetched again.
+TEST_F(NetEqDecodingTest, SkipAudio) {
+  constexpr size_t kSamples = 10 * 16;
+  constexpr size_t kPayloadBytes = kSamples * 2;
+  uint8_t payload[kPayloadBytes] = {0};
+  RTPHeader rtp_info;
+  AudioFrame output;
+  bool muted;
+  int frame_index = 0;
+  auto insert_packet = [&] {
+    PopulateRtpInfo(frame_index, frame_index * kSamples, &rtp_info);
+    ASSERT_EQ(0, neteq_->InsertPacket(rtp_info, payload, 0));
+    ++frame_index;
+  };
+
+  for (int i = 0; i < 50; ++i) {
+    insert_packet();
+    ASSERT_EQ(0, neteq_->GetAudio(&output, &muted));
+  }
+  int num_packets;
+  int max_num_packets;
+  neteq_->PacketBufferStatistics(&num_packets, &max_num_packets);
+  const int num_buffered_packets = num_packets;
+  absl::optional<uint32_t> playout_timestamp = neteq_->GetPlayoutTimestamp();
+  ASSERT_TRUE(playout_timestamp);
+
+  for (int i = 0; i < 100; ++i) {
+    insert_packet();
+    neteq_->SkipAudio();
+    EXPECT_TRUE(neteq_->LastDecodedTimestamps().empty());
+  }
+  neteq_->PacketBufferStatistics(&num_packets, &max_num_packets);
+  EXPECT_LE(num_packets, num_buffered_packets + 1);
+
+  insert_packet();
+  ASSERT_EQ(0, neteq_->GetAudio(&output, &muted));
+  EXPECT_FALSE(neteq_->LastDecodedTimestamps().empty());
+  EXPECT_EQ(AudioFrame::kNormalSpeech, output.speech_type_);
+  // The playout has moved on by the skipped audio too.
+  EXPECT_EQ(*playout_timestamp + 101 * kSamples,
+            *neteq_->GetPlayoutTimestamp());
+}
+
+// The filtered buffer level must follow the buffer while audio is skipped.
+TEST_F(NetEqDecodingTest, SkipAudioUpdatesFilteredBufferLevel) {
+  constexpr size_t kSamples = 10 * 16;
+  constexpr size_t kPayloadBytes = kSamples * 2;
+  uint8_t payload[kPayloadBytes] = {0};
+  RTPHeader rtp_info;
+  AudioFrame output;
+  bool muted;
+  int frame_index = 0;
+  auto insert_packet = [&] {
+    PopulateRtpInfo(frame_index, frame_index * kSamples, &rtp_info);
+    ASSERT_EQ(0, neteq_->InsertPacket(rtp_info, payload, 0));
+    ++frame_index;
+  };
+
+  for (int i = 0; i < 50; ++i) {
+    insert_packet();
+    ASSERT_EQ(0, neteq_->GetAudio(&output, &muted));
+  }
+  const int steady_delay_ms = neteq_->FilteredCurrentDelayMs();
+
+  // Packets now arrive in bursts of five, so that the buffer holds a few of
+  // them at all times.
+  for (int i = 0; i < 100; ++i) {
+    if (i % 5 == 0) {
+      for (int j = 0; j < 5; ++j)
+        insert_packet();
+    }
+    neteq_->SkipAudio();
+  }
+  EXPECT_GT(neteq_->FilteredCurrentDelayMs(), steady_delay_ms + 10);
+}
+
 TEST_F(NetEqDecodingTest, TestConcealmentEvents) {
   const int kNumConcealmentEvents = 19;
   const size_t kSamples = 10 * 16;
@@ -8,13 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-// This is the implementation of the PacketBuffer class. It is mostly based on
-// an STL list. The list is kept sorted at all times so that the next packet to
-// decode is at the beginning of the list.
+// This is the implementation of the PacketBuffer class. It is based on a ring
+// of preallocated packets. The ring is kept sorted at all times so that the
+// next packet to decode is at the front.
 
 #include "modules/audio_coding/neteq/packet_buffer.h"
 
-#include <algorithm>  // find_if()
+#include <algorithm>  // max()
 
 #include "api/audio_codecs/audio_decoder.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
@@ -24,17 +24,6 @@
 
 namespace webrtc {
 namespace {
-// Predicate used when inserting packets in the buffer list.
-// Operator() returns true when |packet| goes before |new_packet|.
-class NewTimestampIsLarger {
- public:
-  explicit NewTimestampIsLarger(const Packet& new_packet)
-      : new_packet_(new_packet) {}
-  bool operator()(const Packet& packet) { return (new_packet_ >= packet); }
-
- private:
-  const Packet& new_packet_;
-};
 
 // Returns true if both payload types are known to the decoder database, and
 // have the same sample rate.
@@ -59,7 +48,11 @@ void LogPacketDiscarded(int codec_level, StatisticsCalculator* stats) {
 
 PacketBuffer::PacketBuffer(size_t max_number_of_packets,
                            const TickTimer* tick_timer)
-    : max_number_of_packets_(max_number_of_packets), tick_timer_(tick_timer) {}
+    : max_number_of_packets_(max_number_of_packets),
+      // A full buffer is flushed before inserting, so there is always room for
+      // one packet.
+      slots_(std::max<size_t>(max_number_of_packets, 1)),
+      tick_timer_(tick_timer) {}
 
 // Destructor. All packets in the buffer will be destroyed.
 PacketBuffer::~PacketBuffer() {
@@ -68,11 +61,14 @@ PacketBuffer::~PacketBuffer() {
 
 // Flush the buffer. All packets in the buffer will be destroyed.
 void PacketBuffer::Flush() {
-  buffer_.clear();
+  for (size_t i = 0; i < size_; ++i)
+    PacketAt(i) = Packet();
+  first_ = 0;
+  size_ = 0;
 }
 
 bool PacketBuffer::Empty() const {
-  return buffer_.empty();
+  return size_ == 0;
 }
 
 int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
@@ -88,36 +84,43 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
 
   packet.waiting_time = tick_timer_->GetNewStopwatch();
 
-  if (buffer_.size() >= max_number_of_packets_) {
+  if (size_ >= max_number_of_packets_) {
     // Buffer is full. Flush it.
     Flush();
     RTC_LOG(LS_WARNING) << "Packet buffer flushed";
     return_val = kFlushed;
   }
 
-  // Get an iterator pointing to the place in the buffer where the new packet
-  // should be inserted. The list is searched from the back, since the most
-  // likely case is that the new packet should be near the end of the list.
-  PacketList::reverse_iterator rit = std::find_if(
-      buffer_.rbegin(), buffer_.rend(), NewTimestampIsLarger(packet));
-
-  // The new packet is to be inserted to the right of |rit|. If it has the same
-  // timestamp as |rit|, which has a higher priority, do not insert the new
-  // packet to list.
-  if (rit != buffer_.rend() && packet.timestamp == rit->timestamp) {
+  // Find the place in the buffer where the new packet should be inserted, i.e.
+  // after the last packet that goes before it. The buffer is searched from the
+  // back, since the most likely case is that the new packet should be near the
+  // end of the buffer.
+  size_t index = size_;
+  while (index > 0 && !(packet >= PacketAt(index - 1)))
+    --index;
+
+  // The new packet is to be inserted after |index| - 1. If it has the same
+  // timestamp as that packet, which has a higher priority, do not insert the
+  // new packet.
+  if (index > 0 && packet.timestamp == PacketAt(index - 1).timestamp) {
     LogPacketDiscarded(packet.priority.codec_level, stats);
     return return_val;
   }
 
-  // The new packet is to be inserted to the left of |it|. If it has the same
-  // timestamp as |it|, which has a lower priority, replace |it| with the new
-  // packet.
-  PacketList::iterator it = rit.base();
-  if (it != buffer_.end() && packet.timestamp == it->timestamp) {
-    LogPacketDiscarded(it->priority.codec_level, stats);
-    it = buffer_.erase(it);
+  // The new packet is to be inserted before |index|. If it has the same
+  // timestamp as that packet, which has a lower priority, replace it with the
+  // new packet.
+  if (index < size_ && packet.timestamp == PacketAt(index).timestamp) {
+    LogPacketDiscarded(PacketAt(index).priority.codec_level, stats);
+    PacketAt(index) = std::move(packet);
+    return return_val;
   }
-  buffer_.insert(it, std::move(packet));  // Insert the packet at that position.
+
+  // Make room by moving the later packets one slot back.
+  for (size_t i = size_; i > index; --i)
+    PacketAt(i) = std::move(PacketAt(i - 1));
+  PacketAt(index) = std::move(packet);
+  ++size_;
 
   return return_val;
 }
@@ -175,7 +178,7 @@ int PacketBuffer::NextTimestamp(uint32_t* next_timestamp) const {
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  *next_timestamp = buffer_.front().timestamp;
+  *next_timestamp = PacketAt(0).timestamp;
   return kOK;
 }
 
@@ -187,11 +190,10 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  PacketList::const_iterator it;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
-    if (it->timestamp >= timestamp) {
+  for (size_t i = 0; i < size_; ++i) {
+    if (PacketAt(i).timestamp >= timestamp) {
       // Found a packet matching the search.
-      *next_timestamp = it->timestamp;
+      *next_timestamp = PacketAt(i).timestamp;
       return kOK;
     }
   }
@@ -199,7 +201,7 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
 }
 
 const Packet* PacketBuffer::PeekNextPacket() const {
-  return buffer_.empty() ? nullptr : &buffer_.front();
+  return Empty() ? nullptr : &PacketAt(0);
 }
 
 absl::optional<Packet> PacketBuffer::GetNextPacket() {
@@ -208,10 +210,11 @@ absl::optional<Packet> PacketBuffer::GetNextPacket() {
     return absl::nullopt;
   }
 
-  absl::optional<Packet> packet(std::move(buffer_.front()));
+  absl::optional<Packet> packet(std::move(PacketAt(0)));
   // Assert that the packet sanity checks in InsertPacket method works.
   RTC_DCHECK(!packet->empty());
-  buffer_.pop_front();
+  first_ = (first_ + 1) % slots_.size();
+  --size_;
 
   return packet;
 }
@@ -221,17 +224,19 @@ int PacketBuffer::DiscardNextPacket(StatisticsCalculator* stats) {
     return kBufferEmpty;
   }
   // Assert that the packet sanity checks in InsertPacket method works.
-  const Packet& packet = buffer_.front();
+  Packet& packet = PacketAt(0);
   RTC_DCHECK(!packet.empty());
   LogPacketDiscarded(packet.priority.codec_level, stats);
-  buffer_.pop_front();
+  packet = Packet();
+  first_ = (first_ + 1) % slots_.size();
+  --size_;
   return kOK;
 }
 
 void PacketBuffer::DiscardOldPackets(uint32_t timestamp_limit,
                                      uint32_t horizon_samples,
                                      StatisticsCalculator* stats) {
-  buffer_.remove_if([timestamp_limit, horizon_samples, stats](const Packet& p) {
+  RemovePacketsIf([timestamp_limit, horizon_samples, stats](const Packet& p) {
     if (timestamp_limit == p.timestamp ||
         !IsObsoleteTimestamp(p.timestamp, timestamp_limit, horizon_samples)) {
       return false;
@@ -248,7 +253,7 @@ void PacketBuffer::DiscardAllOldPackets(uint32_t timestamp_limit,
 
 void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
                                                  StatisticsCalculator* stats) {
-  buffer_.remove_if([payload_type, stats](const Packet& p) {
+  RemovePacketsIf([payload_type, stats](const Packet& p) {
     if (p.payload_type != payload_type) {
       return false;
     }
@@ -258,13 +263,14 @@ void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
 }
 
 size_t PacketBuffer::NumPacketsInBuffer() const {
-  return buffer_.size();
+  return size_;
 }
 
 size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
   size_t num_samples = 0;
   size_t last_duration = last_decoded_length;
-  for (const Packet& packet : buffer_) {
+  for (size_t i = 0; i < size_; ++i) {
+    const Packet& packet = PacketAt(i);
     if (packet.frame) {
       // TODO(hlundin): Verify that it's fine to count all packets and remove
       // this check.
@@ -284,7 +290,8 @@ size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
 bool PacketBuffer::ContainsDtxOrCngPacket(
     const DecoderDatabase* decoder_database) const {
   RTC_DCHECK(decoder_database);
-  for (const Packet& packet : buffer_) {
+  for (size_t i = 0; i < size_; ++i) {
+    const Packet& packet = PacketAt(i);
     if ((packet.frame && packet.frame->IsDtxPacket()) ||
         decoder_database->IsComfortNoise(packet.payload_type)) {
       return true;
@@ -294,8 +301,34 @@ bool PacketBuffer::ContainsDtxOrCngPacket(
 }
 
 void PacketBuffer::BufferStat(int* num_packets, int* max_num_packets) const {
-  *num_packets = static_cast<int>(buffer_.size());
+  *num_packets = static_cast<int>(size_);
   *max_num_packets = static_cast<int>(max_number_of_packets_);
 }
 
+Packet& PacketBuffer::PacketAt(size_t index) {
+  RTC_DCHECK_LT(index, slots_.size());
+  return slots_[(first_ + index) % slots_.size()];
+}
+
+const Packet& PacketBuffer::PacketAt(size_t index) const {
+  RTC_DCHECK_LT(index, slots_.size());
+  return slots_[(first_ + index) % slots_.size()];
+}
+
+template <typename Predicate>
+void PacketBuffer::RemovePacketsIf(Predicate predicate) {
+  size_t num_kept = 0;
+  for (size_t i = 0; i < size_; ++i) {
+    if (predicate(PacketAt(i)))
+      continue;
+    if (num_kept != i)
+      PacketAt(num_kept) = std::move(PacketAt(i));
+    ++num_kept;
+  }
+  // Delete the removed packets, and what is left of the moved ones.
+  for (size_t i = num_kept; i < size_; ++i)
+    PacketAt(i) = Packet();
+  size_ = num_kept;
+}
+
 }  // namespace webrtc
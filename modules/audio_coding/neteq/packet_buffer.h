@@ -11,6 +11,8 @@
 #ifndef MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 #define MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
 #include "modules/audio_coding/neteq/packet.h"
@@ -23,7 +25,9 @@ class DecoderDatabase;
 class StatisticsCalculator;
 class TickTimer;
 
-// This is the actual buffer holding the packets before decoding.
+// This is the actual buffer holding the packets before decoding. The packets
+// are kept in timestamp order in a ring of preallocated slots, so that
+// inserting and extracting packets does not allocate memory.
 class PacketBuffer {
  public:
   enum BufferReturnCodes {
@@ -142,8 +146,21 @@ class PacketBuffer {
   }
 
  private:
+  // Returns the |index|th packet from the front of the buffer.
+  Packet& PacketAt(size_t index);
+  const Packet& PacketAt(size_t index) const;
+
+  // Removes the packets for which |predicate| returns true, keeping the order
+  // of the others.
+  template <typename Predicate>
+  void RemovePacketsIf(Predicate predicate);
+
   size_t max_number_of_packets_;
-  PacketList buffer_;
+  // A ring of at least |max_number_of_packets_| slots, of which |size_|
+  // slots from |first_| hold packets.
+  std::vector<Packet> slots_;
+  size_t first_ = 0;
+  size_t size_ = 0;
   const TickTimer* tick_timer_;
   RTC_DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
@@ -434,6 +434,41 @@ TEST(PacketBuffer, Reordering) {
   EXPECT_CALL(decoder_database, Die());  // Called when object is deleted.
 }
 
+// Inserts swapped pairs of packets and extracts them again, many more packets
+// than the buffer holds, so that the packets wrap around the end of the
+// buffer's storage.
+TEST(PacketBuffer, ReorderingAcrossWrapAround) {
+  TickTimer tick_timer;
+  PacketBuffer buffer(5, &tick_timer);  // 5 packets.
+  const uint32_t start_ts = 0xFFFFFF00;  // Also wraps the timestamp.
+  const uint32_t ts_increment = 10;
+  PacketGenerator gen(0xFFF0, start_ts, 0, ts_increment);
+  const int payload_len = 10;
+  StrictMock<MockStatisticsCalculator> mock_stats;
+
+  uint32_t current_ts = start_ts;
+  for (int i = 0; i < 50; ++i) {
+    Packet first = gen.NextPacket(payload_len);
+    Packet second = gen.NextPacket(payload_len);
+    Packet third = gen.NextPacket(payload_len);
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(second), &mock_stats));
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(third), &mock_stats));
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(first), &mock_stats));
+    EXPECT_EQ(3u, buffer.NumPacketsInBuffer());
+
+    for (int j = 0; j < 3; ++j) {
+      const absl::optional<Packet> packet = buffer.GetNextPacket();
+      ASSERT_TRUE(packet);
+      EXPECT_EQ(current_ts, packet->timestamp);
+      current_ts += ts_increment;
+    }
+    EXPECT_TRUE(buffer.Empty());
+  }
+}
+
 // The test first inserts a packet with narrow-band CNG, then a packet with
 // wide-band speech. The expected behavior of the packet buffer is to detect a
 // change in sample rate, even though no speech packet has been inserted before,
@@ -30,6 +30,23 @@ TEST(NetEqPerformanceTest, Run) {
                             "ms", true);
 }
 
+// Runs a test where every other packet is lost, so that most of the time is
+// spent in expand and merge.
+TEST(NetEqPerformanceTest, RunExpandHeavy) {
+  const int kSimulationTimeMs = 10000000;
+  const int kQuickSimulationTimeMs = 100000;
+  const int kLossPeriod = 2;        // Drop every other packet.
+  const double kDriftFactor = 0.0;  // No clock drift.
+  int64_t runtime = webrtc::test::NetEqPerformanceTest::Run(
+      webrtc::field_trial::IsEnabled("WebRTC-QuickPerfTest")
+          ? kQuickSimulationTimeMs
+          : kSimulationTimeMs,
+      kLossPeriod, kDriftFactor);
+  ASSERT_GT(runtime, 0);
+  webrtc::test::PrintResult("neteq_performance", "", "50_pl_0_drift", runtime,
+                            "ms", true);
+}
+
 // Runs a test with neither packet losses nor clock drift, to put
 // emphasis on the "good-weather" code path, which is presumably much
 // more lightweight.
@@ -47,3 +64,24 @@ TEST(NetEqPerformanceTest, RunClean) {
   webrtc::test::PrintResult("neteq_performance", "", "0_pl_0_drift", runtime,
                             "ms", true);
 }
+
+// Runs 1000 NetEq instances side by side, as on a server that receives many
+// streams, to measure the cost of inserting and extracting packets when the
+// instances do not stay in the CPU caches.
+TEST(NetEqPerformanceTest, RunThousandInstances) {
+  const int kNumInstances = 1000;
+  const int kSimulationTimeMs = 10000;
+  const int kQuickSimulationTimeMs = 100;
+  double insert_packet_us;
+  double get_audio_us;
+  ASSERT_TRUE(webrtc::test::NetEqPerformanceTest::RunInstances(
+      kNumInstances,
+      webrtc::field_trial::IsEnabled("WebRTC-QuickPerfTest")
+          ? kQuickSimulationTimeMs
+          : kSimulationTimeMs,
+      &insert_packet_us, &get_audio_us));
+  webrtc::test::PrintResult("neteq_insert_packet", "", "1000_instances",
+                            insert_packet_us, "us", true);
+  webrtc::test::PrintResult("neteq_get_audio", "", "1000_instances",
+                            get_audio_us, "us", true);
+}
@@ -0,0 +1,188 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "modules/audio_coding/neteq/tools/audio_sink.h"
+#include "modules/audio_coding/neteq/tools/neteq_event_log_input.h"
+#include "modules/audio_coding/neteq/tools/neteq_operation_profiler.h"
+#include "modules/audio_coding/neteq/tools/neteq_packet_source_input.h"
+#include "modules/audio_coding/neteq/tools/neteq_test.h"
+#include "modules/audio_coding/neteq/tools/rtp_file_source.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/timeutils.h"
+#include "test/testsupport/perf_test.h"
+
+DEFINE_int(num_streams,
+           0,
+           "The number of NetEq instances to run. The input files are "
+           "assigned to them in turn. Defaults to one per input file");
+DEFINE_int(duration_ms,
+           0,
+           "Ends each stream after this much simulated time. Defaults to the "
+           "length of its input file");
+DEFINE_int(audio_level, 1, "Extension ID for audio level (RFC 6464)");
+DEFINE_int(abs_send_time, 3, "Extension ID for absolute sender time");
+DEFINE_int(transport_seq_no, 5, "Extension ID for transport sequence number");
+DEFINE_string(output, "", "Writes the results as JSON to this file");
+DEFINE_bool(help, false, "Prints this message");
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr char kOperationPrefix[] = "NetEqImpl::";
+// The NetEq API calls, which include the time of the other operations.
+constexpr char kInsertPacket[] = "NetEqImpl::InsertPacket";
+constexpr char kGetAudio[] = "NetEqImpl::GetAudio";
+
+struct Stream {
+  std::unique_ptr<NetEqTest> test;
+  int64_t simulation_time_ms = 0;
+  bool finished = false;
+};
+
+std::unique_ptr<NetEqInput> CreateInput(const std::string& file_name) {
+  const NetEqPacketSourceInput::RtpHeaderExtensionMap rtp_ext_map = {
+      {FLAG_audio_level, kRtpExtensionAudioLevel},
+      {FLAG_abs_send_time, kRtpExtensionAbsoluteSendTime},
+      {FLAG_transport_seq_no, kRtpExtensionTransportSequenceNumber}};
+  if (RtpFileSource::ValidRtpDump(file_name) ||
+      RtpFileSource::ValidPcap(file_name)) {
+    return std::unique_ptr<NetEqInput>(
+        new NetEqRtpDumpInput(file_name, rtp_ext_map));
+  }
+  return std::unique_ptr<NetEqInput>(
+      new NetEqEventLogInput(file_name, rtp_ext_map));
+}
+
+// Runs the streams on simulated time, advancing all of them by one GetAudio
+// event in turn so that they progress side by side. Returns the simulated
+// time of all streams together, in ms.
+int64_t RunStreams(std::vector<Stream>* streams) {
+  int64_t total_simulation_time_ms = 0;
+  bool all_finished = false;
+  for (int64_t now_ms = 0; !all_finished; now_ms += 10) {
+    all_finished = true;
+    for (Stream& stream : *streams) {
+      while (!stream.finished && stream.simulation_time_ms <= now_ms) {
+        const NetEqSimulator::SimulationStepResult result =
+            stream.test->RunToNextGetAudio();
+        stream.simulation_time_ms += result.simulation_step_ms;
+        total_simulation_time_ms += result.simulation_step_ms;
+        stream.finished =
+            result.is_simulation_finished ||
+            (FLAG_duration_ms > 0 &&
+             stream.simulation_time_ms >= FLAG_duration_ms);
+      }
+      all_finished &= stream.finished;
+    }
+  }
+  return total_simulation_time_ms;
+}
+
+// Prints the time per call and the share of the time in NetEq of every
+// operation, and the time it takes to process a second of audio.
+void ReportResults(
+    const std::map<std::string, NetEqOperationProfiler::OperationStats>& stats,
+    int num_streams,
+    int64_t run_time_ns,
+    int64_t simulation_time_ms) {
+  int64_t neteq_time_ns = 0;
+  for (const char* api_call : {kInsertPacket, kGetAudio}) {
+    auto it = stats.find(api_call);
+    if (it != stats.end())
+      neteq_time_ns += it->second.total_time_ns;
+  }
+
+  const std::string trace = std::to_string(num_streams) + "_streams";
+  for (const auto& operation : stats) {
+    std::string name = operation.first;
+    if (name.compare(0, strlen(kOperationPrefix), kOperationPrefix) != 0)
+      continue;
+    name = name.substr(strlen(kOperationPrefix));
+    const NetEqOperationProfiler::OperationStats& op = operation.second;
+    PrintResult("neteq_" + name + "_calls", "", trace, op.calls, "count",
+                false);
+    PrintResult("neteq_" + name + "_time_per_call", "", trace,
+                op.total_time_ns / 1000.0 / op.calls, "us", false);
+    if (neteq_time_ns > 0) {
+      PrintResult("neteq_" + name + "_time_share", "", trace,
+                  100.0 * op.total_time_ns / neteq_time_ns, "%", false);
+    }
+  }
+  if (simulation_time_ms > 0) {
+    // Includes reading the input files.
+    PrintResult("neteq_time_per_audio_second", "", trace,
+                run_time_ns / 1e3 / simulation_time_ms, "ms", true);
+    PrintResult("neteq_api_time_per_audio_second", "", trace,
+                neteq_time_ns / 1e3 / simulation_time_ms, "ms", true);
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage =
+      "Tool for measuring the CPU usage of NetEq, decoding several RTP dump "
+      "or RtcEventLog files with many NetEq instances at once.\n"
+      "Run " +
+      program_name +
+      " --help for usage.\n"
+      "Example usage:\n" +
+      program_name +
+      " --num_streams=100 --output=results.json input1.rtp input2.rtp\n";
+  if (rtc::FlagList::SetFlagsFromCommandLine(&argc, argv, true)) {
+    return 1;
+  }
+  if (FLAG_help || argc < 2) {
+    std::cout << usage;
+    rtc::FlagList::Print(nullptr, false);
+    return 0;
+  }
+  const int num_inputs = argc - 1;
+  const int num_streams = FLAG_num_streams > 0 ? FLAG_num_streams : num_inputs;
+
+  std::vector<webrtc::test::Stream> streams(num_streams);
+  for (int i = 0; i < num_streams; ++i) {
+    const std::string file_name = argv[1 + i % num_inputs];
+    std::unique_ptr<webrtc::test::NetEqInput> input =
+        webrtc::test::CreateInput(file_name);
+    RTC_CHECK(!input->ended()) << "Input file is empty: " << file_name;
+    streams[i].test.reset(new webrtc::test::NetEqTest(
+        webrtc::NetEq::Config(), webrtc::test::NetEqTest::StandardDecoderMap(),
+        webrtc::test::NetEqTest::ExtDecoderMap(), std::move(input),
+        std::unique_ptr<webrtc::test::AudioSink>(
+            new webrtc::test::VoidAudioSink()),
+        webrtc::test::NetEqTest::Callbacks()));
+  }
+
+  webrtc::test::NetEqOperationProfiler profiler;
+  const int64_t start_ns = rtc::TimeNanos();
+  const int64_t simulation_time_ms = webrtc::test::RunStreams(&streams);
+  const int64_t run_time_ns = rtc::TimeNanos() - start_ns;
+  webrtc::test::ReportResults(profiler.GetStats(), num_streams, run_time_ns,
+                              simulation_time_ms);
+  if (strlen(FLAG_output) > 0) {
+    webrtc::test::WritePerfResults(FLAG_output);
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/neteq/tools/neteq_operation_profiler.h"
+
+#include <string.h>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/event_tracer.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+NetEqOperationProfiler* g_profiler = nullptr;
+
+const unsigned char kEnabled = 1;
+const unsigned char kDisabled = 0;
+
+}  // namespace
+
+NetEqOperationProfiler::NetEqOperationProfiler() {
+  RTC_CHECK(!g_profiler) << "Only one profiler can exist at a time";
+  g_profiler = this;
+  SetupEventTracer(&GetCategoryEnabled, &AddTraceEvent);
+}
+
+NetEqOperationProfiler::~NetEqOperationProfiler() {
+  SetupEventTracer(nullptr, nullptr);
+  g_profiler = nullptr;
+}
+
+std::map<std::string, NetEqOperationProfiler::OperationStats>
+NetEqOperationProfiler::GetStats() const {
+  std::map<std::string, OperationStats> stats;
+  for (const auto& operation : stats_) {
+    OperationStats& merged = stats[operation.first];
+    merged.calls += operation.second.calls;
+    merged.total_time_ns += operation.second.total_time_ns;
+  }
+  return stats;
+}
+
+const unsigned char* NetEqOperationProfiler::GetCategoryEnabled(
+    const char* name) {
+  return strcmp(name, "webrtc") == 0 ? &kEnabled : &kDisabled;
+}
+
+void NetEqOperationProfiler::AddTraceEvent(
+    char phase,
+    const unsigned char* category_enabled,
+    const char* name,
+    unsigned long long id,
+    int num_args,
+    const char** arg_names,
+    const unsigned char* arg_types,
+    const unsigned long long* arg_values,
+    unsigned char flags) {
+  const int64_t now_ns = rtc::TimeNanos();
+  if (phase == TRACE_EVENT_PHASE_BEGIN) {
+    g_profiler->open_scopes_.emplace_back(name, now_ns);
+  } else if (phase == TRACE_EVENT_PHASE_END) {
+    // Scopes close in reverse order, unless they were opened before the
+    // profiler was installed.
+    if (g_profiler->open_scopes_.empty() ||
+        g_profiler->open_scopes_.back().first != name) {
+      return;
+    }
+    OperationStats& stats = g_profiler->stats_[name];
+    ++stats.calls;
+    stats.total_time_ns += now_ns - g_profiler->open_scopes_.back().second;
+    g_profiler->open_scopes_.pop_back();
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
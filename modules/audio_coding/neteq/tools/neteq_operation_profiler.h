@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_OPERATION_PROFILER_H_
+#define MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_OPERATION_PROFILER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/constructormagic.h"
+
+namespace webrtc {
+namespace test {
+
+// Measures the time spent in the operations of NetEqImpl, such as Decode and
+// DoExpand, by installing itself as the event tracer and timing the
+// TRACE_EVENT0 scopes of the "webrtc" category. Only one profiler can exist
+// at a time, and the traced code must run on a single thread.
+class NetEqOperationProfiler {
+ public:
+  struct OperationStats {
+    int64_t calls = 0;
+    // Including the time of nested operations.
+    int64_t total_time_ns = 0;
+  };
+
+  NetEqOperationProfiler();
+  ~NetEqOperationProfiler();
+
+  // Returns the stats of the operations that were called, by name.
+  std::map<std::string, OperationStats> GetStats() const;
+
+ private:
+  static const unsigned char* GetCategoryEnabled(const char* name);
+  static void AddTraceEvent(char phase,
+                            const unsigned char* category_enabled,
+                            const char* name,
+                            unsigned long long id,
+                            int num_args,
+                            const char** arg_names,
+                            const unsigned char* arg_types,
+                            const unsigned long long* arg_values,
+                            unsigned char flags);
+
+  // Keyed by the name pointers, which are string literals.
+  std::map<const char*, OperationStats> stats_;
+  // The names and start times of the scopes that are open.
+  std::vector<std::pair<const char*, int64_t>> open_scopes_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(NetEqOperationProfiler);
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_OPERATION_PROFILER_H_
@@ -10,6 +10,11 @@
 
 #include "modules/audio_coding/neteq/tools/neteq_performance_test.h"
 
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
 #include "api/audio/audio_frame.h"
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "common_types.h"  // NOLINT(build/include)
@@ -18,6 +23,7 @@
 #include "modules/audio_coding/neteq/tools/audio_loop.h"
 #include "modules/audio_coding/neteq/tools/rtp_generator.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/timeutils.h"
 #include "system_wrappers/include/clock.h"
 #include "test/testsupport/fileutils.h"
 
@@ -126,5 +132,98 @@ int64_t NetEqPerformanceTest::Run(int runtime_ms,
   return end_time_ms - start_time_ms;
 }
 
+bool NetEqPerformanceTest::RunInstances(int num_instances,
+                                        int runtime_ms,
+                                        double* insert_packet_us,
+                                        double* get_audio_us) {
+  const int kSampRateHz = 32000;
+  const webrtc::NetEqDecoder kDecoderType =
+      webrtc::NetEqDecoder::kDecoderPCM16Bswb32kHz;
+  const std::string kDecoderName = "pcm16-swb32";
+  const int kPayloadType = 95;
+  const int kPacketSizeMs = 20;
+  const size_t kPacketSizeSamples = kPacketSizeMs * kSampRateHz / 1000;
+  const int kOutputBlockSizeMs = 10;
+
+  NetEq::Config config;
+  config.sample_rate_hz = kSampRateHz;
+  auto decoder_factory = CreateBuiltinAudioDecoderFactory();
+  std::vector<std::unique_ptr<NetEq>> neteqs;
+  for (int i = 0; i < num_instances; ++i) {
+    neteqs.emplace_back(NetEq::Create(config, decoder_factory));
+    if (neteqs.back()->RegisterPayloadType(kDecoderType, kDecoderName,
+                                           kPayloadType) != 0) {
+      return false;
+    }
+  }
+
+  // All packets carry the same 1 kHz tone.
+  int16_t input_samples[kPacketSizeSamples];
+  for (size_t i = 0; i < kPacketSizeSamples; ++i) {
+    input_samples[i] = static_cast<int16_t>(
+        8000 * sin(2 * M_PI * 1000 * i / static_cast<double>(kSampRateHz)));
+  }
+  uint8_t input_payload[kPacketSizeSamples * sizeof(int16_t)];
+  WebRtcPcm16b_Encode(input_samples, kPacketSizeSamples, input_payload);
+
+  auto insert_packet = [&](int packet_index) {
+    RTPHeader rtp_header;
+    rtp_header.payloadType = kPayloadType;
+    rtp_header.sequenceNumber = static_cast<uint16_t>(packet_index);
+    rtp_header.timestamp =
+        static_cast<uint32_t>(packet_index * kPacketSizeSamples);
+    for (int i = 0; i < num_instances; ++i) {
+      rtp_header.ssrc = i;
+      if (neteqs[i]->InsertPacket(rtp_header, input_payload,
+                                  rtp_header.timestamp) != NetEq::kOK) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  int64_t insert_packet_time_us = 0;
+  int64_t get_audio_time_us = 0;
+  int num_insert_packet_calls = 0;
+  int num_get_audio_calls = 0;
+  AudioFrame out_frame;
+  for (int time_ms = 0; time_ms < runtime_ms; time_ms += kOutputBlockSizeMs) {
+    if (time_ms % kPacketSizeMs == 0) {
+      const int packet_index = time_ms / kPacketSizeMs;
+      const int64_t start_us = rtc::TimeMicros();
+      bool ok = true;
+      if (packet_index % 5 == 4) {
+        ok = insert_packet(packet_index) && insert_packet(packet_index - 1);
+        num_insert_packet_calls += 2 * num_instances;
+      } else if (packet_index % 5 != 3) {
+        ok = insert_packet(packet_index);
+        num_insert_packet_calls += num_instances;
+      }
+      insert_packet_time_us += rtc::TimeMicros() - start_us;
+      if (!ok)
+        return false;
+    }
+
+    const int64_t start_us = rtc::TimeMicros();
+    for (const auto& neteq : neteqs) {
+      bool muted;
+      if (neteq->GetAudio(&out_frame, &muted) != NetEq::kOK)
+        return false;
+    }
+    get_audio_time_us += rtc::TimeMicros() - start_us;
+    num_get_audio_calls += num_instances;
+  }
+
+  *insert_packet_us = num_insert_packet_calls > 0
+                          ? static_cast<double>(insert_packet_time_us) /
+                                num_insert_packet_calls
+                          : 0;
+  *get_audio_us = num_get_audio_calls > 0
+                      ? static_cast<double>(get_audio_time_us) /
+                            num_get_audio_calls
+                      : 0;
+  return true;
+}
+
 }  // namespace test
 }  // namespace webrtc
@@ -24,6 +24,16 @@ class NetEqPerformanceTest {
   //   |drift_factor|: clock drift in [0, 1].
   // Returns the runtime in ms.
   static int64_t Run(int runtime_ms, int lossrate, double drift_factor);
+
+  // Runs |num_instances| NetEq instances side by side on one thread, for
+  // |runtime_ms| of audio. Each receives a clean stream of 20 ms packets, of
+  // which every fifth arrives after the next one. Writes the average time per
+  // InsertPacket() and per GetAudio() call in microseconds to
+  // |insert_packet_us| and |get_audio_us|. Returns false on error.
+  static bool RunInstances(int num_instances,
+                           int runtime_ms,
+                           double* insert_packet_us,
+                           double* get_audio_us);
 };
 
 }  // namespace test
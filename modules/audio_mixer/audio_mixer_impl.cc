@@ -11,14 +11,17 @@
 #include "modules/audio_mixer/audio_mixer_impl.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iterator>
 #include <utility>
 
 #include "modules/audio_mixer/audio_frame_manipulator.h"
 #include "modules/audio_mixer/default_output_rate_calculator.h"
+#include "rtc_base/event.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/refcountedobject.h"
+#include "rtc_base/timeutils.h"
 
 namespace webrtc {
 namespace {
@@ -90,14 +93,71 @@ AudioMixerImpl::SourceStatusList::const_iterator FindSourceInList(
 }
 }  // namespace
 
+// The audio of one source, fetched on a worker thread.
+struct AudioMixerImpl::DecodeSlot {
+  enum State : int64_t {
+    // Not part of a mix, or its audio has been mixed.
+    kIdle,
+    // A thread is fetching its audio.
+    kDecoding,
+    // The audio is in |audio_frame|.
+    kDone,
+    // Waiting for a thread to fetch its audio, for the mix with the number
+    // that is added to kQueued. Workers of earlier mixes leave it alone.
+    kQueued,
+  };
+
+  explicit DecodeSlot(Source* audio_source)
+      : audio_source(audio_source), decoded(false, false) {}
+
+  Source* const audio_source;
+  std::atomic<int64_t> state{kIdle};
+  AudioFrame audio_frame;
+  Source::AudioFrameInfo audio_frame_info = Source::AudioFrameInfo::kError;
+  // Whether the source skips its audio instead. Written before queuing.
+  bool skip = false;
+  // Set when a thread is done fetching audio, for RemoveSource() to wait on.
+  rtc::Event decoded;
+};
+
+// The slots to fetch audio for in one Mix() call. Shared with the workers,
+// which may still be running when the mixing thread has given up waiting.
+struct AudioMixerImpl::DecodeRound {
+  DecodeRound(int64_t queued_state, int sample_rate_hz)
+      : queued_state(queued_state),
+        sample_rate_hz(sample_rate_hz),
+        done(false, false) {}
+
+  // The state of the slots queued for this round.
+  const int64_t queued_state;
+  const int sample_rate_hz;
+  std::vector<std::shared_ptr<DecodeSlot>> slots;
+  std::atomic<size_t> next_slot{0};
+  std::atomic<size_t> num_pending{0};
+  // Set when all slots have been handled.
+  rtc::Event done;
+};
+
 AudioMixerImpl::AudioMixerImpl(
     std::unique_ptr<OutputRateCalculator> output_rate_calculator,
-    bool use_limiter)
+    bool use_limiter,
+    const ParallelDecodingConfig& parallel_decoding,
+    const SourceSelectionConfig& source_selection)
     : output_rate_calculator_(std::move(output_rate_calculator)),
       output_frequency_(0),
       sample_size_(0),
       audio_source_list_(),
-      frame_combiner_(use_limiter) {}
+      frame_combiner_(use_limiter),
+      source_selection_(source_selection),
+      decode_deadline_ms_(parallel_decoding.deadline_ms),
+      num_decode_rounds_(0) {
+  RTC_DCHECK_GE(parallel_decoding.num_worker_threads, 0);
+  RTC_DCHECK_GE(source_selection.num_selected_sources, 0);
+  for (int i = 0; i < parallel_decoding.num_worker_threads; ++i) {
+    decode_queues_.emplace_back(new rtc::TaskQueue(
+        "AudioMixerDecodeQueue", rtc::TaskQueue::Priority::HIGH));
+  }
+}
 
 AudioMixerImpl::~AudioMixerImpl() {}
 
@@ -110,9 +170,27 @@ rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create() {
 rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
     std::unique_ptr<OutputRateCalculator> output_rate_calculator,
     bool use_limiter) {
+  return Create(std::move(output_rate_calculator), use_limiter,
+                ParallelDecodingConfig());
+}
+
+rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
+    std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+    bool use_limiter,
+    const ParallelDecodingConfig& parallel_decoding) {
+  return Create(std::move(output_rate_calculator), use_limiter,
+                parallel_decoding, SourceSelectionConfig());
+}
+
+rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
+    std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+    bool use_limiter,
+    const ParallelDecodingConfig& parallel_decoding,
+    const SourceSelectionConfig& source_selection) {
   return rtc::scoped_refptr<AudioMixerImpl>(
       new rtc::RefCountedObject<AudioMixerImpl>(
-          std::move(output_rate_calculator), use_limiter));
+          std::move(output_rate_calculator), use_limiter, parallel_decoding,
+          source_selection));
 }
 
 void AudioMixerImpl::Mix(size_t number_of_channels,
@@ -161,6 +239,8 @@ bool AudioMixerImpl::AddSource(Source* audio_source) {
              audio_source_list_.end())
       << "Source already added to mixer";
   audio_source_list_.emplace_back(new SourceStatus(audio_source, false, 0));
+  if (!decode_queues_.empty())
+    audio_source_list_.back()->decode_slot.reset(new DecodeSlot(audio_source));
   return true;
 }
 
@@ -169,6 +249,16 @@ void AudioMixerImpl::RemoveSource(Source* audio_source) {
   rtc::CritScope lock(&crit_);
   const auto iter = FindSourceInList(audio_source, &audio_source_list_);
   RTC_DCHECK(iter != audio_source_list_.end()) << "Source not present in mixer";
+  DecodeSlot* decode_slot = (*iter)->decode_slot.get();
+  if (decode_slot) {
+    // The source may be deleted once removed, so make sure that no worker
+    // fetches audio from it.
+    int64_t state = decode_slot->state.load();
+    if (state >= DecodeSlot::kQueued)
+      decode_slot->state.compare_exchange_strong(state, DecodeSlot::kIdle);
+    while (decode_slot->state.load() == DecodeSlot::kDecoding)
+      decode_slot->decoded.Wait(rtc::Event::kForever);
+  }
   audio_source_list_.erase(iter);
 }
 
@@ -178,19 +268,73 @@ AudioFrameList AudioMixerImpl::GetAudioFromSources() {
   std::vector<SourceFrame> audio_source_mixing_data_list;
   std::vector<SourceFrame> ramp_list;
 
-  // Get audio from the audio sources and put it in the SourceFrame vector.
-  for (auto& source_and_status : audio_source_list_) {
-    const auto audio_frame_info =
-        source_and_status->audio_source->GetAudioFrameWithInfo(
-            OutputFrequency(), &source_and_status->audio_frame);
-
-    if (audio_frame_info == Source::AudioFrameInfo::kError) {
-      RTC_LOG_F(LS_WARNING) << "failed to GetAudioFrameWithInfo() from source";
-      continue;
+  // Only the frames that may still be mixed keep their buffer, so that few
+  // buffers are in use however many sources there are.
+  std::vector<size_t> mixable_frames;
+  auto add_source_frame = [&](SourceStatus* source_status,
+                              AudioFrame* audio_frame, bool muted) {
+    audio_source_mixing_data_list.emplace_back(source_status, audio_frame,
+                                               muted);
+    if (muted) {
+      audio_frame->ReleaseBuffer();
+      return;
+    }
+    mixable_frames.push_back(audio_source_mixing_data_list.size() - 1);
+    if (mixable_frames.size() <=
+        static_cast<size_t>(kMaximumAmountOfMixedAudioSources)) {
+      return;
+    }
+    const auto mixed_last = std::max_element(
+        mixable_frames.begin(), mixable_frames.end(), [&](size_t a, size_t b) {
+          return ShouldMixBefore(audio_source_mixing_data_list[a],
+                                 audio_source_mixing_data_list[b]);
+        });
+    SourceFrame& unmixed = audio_source_mixing_data_list[*mixed_last];
+    unmixed.muted = true;
+    unmixed.audio_frame->ReleaseBuffer();
+    mixable_frames.erase(mixed_last);
+  };
+
+  if (source_selection_.num_selected_sources > 0)
+    SelectSources();
+
+  if (!decode_queues_.empty()) {
+    // Sources that miss the deadline are not mixed this time.
+    for (auto& source_and_status : audio_source_list_)
+      source_and_status->is_mixed = false;
+
+    std::vector<std::pair<SourceStatus*, Source::AudioFrameInfo>> results;
+    GetAudioInParallel(&results);
+    for (const auto& result : results) {
+      if (result.second == Source::AudioFrameInfo::kError) {
+        RTC_LOG_F(LS_WARNING)
+            << "failed to GetAudioFrameWithInfo() from source";
+        continue;
+      }
+      add_source_frame(result.first, &result.first->decode_slot->audio_frame,
+                       result.second == Source::AudioFrameInfo::kMuted);
+    }
+  } else {
+    // Get audio from the audio sources and put it in the SourceFrame vector.
+    for (auto& source_and_status : audio_source_list_) {
+      if (!source_and_status->is_selected) {
+        source_and_status->audio_source->SkipAudioFrame(OutputFrequency());
+        source_and_status->audio_frame.ReleaseBuffer();
+        source_and_status->is_mixed = false;
+        continue;
+      }
+      const auto audio_frame_info =
+          source_and_status->audio_source->GetAudioFrameWithInfo(
+              OutputFrequency(), &source_and_status->audio_frame);
+
+      if (audio_frame_info == Source::AudioFrameInfo::kError) {
+        RTC_LOG_F(LS_WARNING)
+            << "failed to GetAudioFrameWithInfo() from source";
+        continue;
+      }
+      add_source_frame(source_and_status.get(), &source_and_status->audio_frame,
+                       audio_frame_info == Source::AudioFrameInfo::kMuted);
     }
-    audio_source_mixing_data_list.emplace_back(
-        source_and_status.get(), &source_and_status->audio_frame,
-        audio_frame_info == Source::AudioFrameInfo::kMuted);
   }
 
   // Sort frames by sorting function.
@@ -221,6 +365,117 @@ AudioFrameList AudioMixerImpl::GetAudioFromSources() {
   return result;
 }
 
+void AudioMixerImpl::SelectSources() {
+  // Pairs of loudness in dB and source.
+  std::vector<std::pair<int, SourceStatus*>> ranked_sources;
+  for (auto& source_and_status : audio_source_list_) {
+    const absl::optional<int> level =
+        source_and_status->audio_source->IncomingAudioLevel();
+    if (!level) {
+      source_and_status->is_selected = true;
+      continue;
+    }
+    const int loudness_db =
+        -*level + (source_and_status->is_selected
+                       ? source_selection_.hysteresis_db
+                       : 0);
+    ranked_sources.emplace_back(loudness_db, source_and_status.get());
+  }
+
+  const size_t num_loudest =
+      std::min(static_cast<size_t>(source_selection_.num_selected_sources),
+               ranked_sources.size());
+  std::partial_sort(ranked_sources.begin(),
+                    ranked_sources.begin() + num_loudest, ranked_sources.end(),
+                    [](const std::pair<int, SourceStatus*>& a,
+                       const std::pair<int, SourceStatus*>& b) {
+                      return a.first > b.first;
+                    });
+
+  const int hangover_rounds =
+      source_selection_.hangover_ms / kFrameDurationInMs;
+  for (size_t i = 0; i < ranked_sources.size(); ++i) {
+    SourceStatus* source_status = ranked_sources[i].second;
+    if (i < num_loudest) {
+      source_status->rounds_since_loudest = 0;
+    } else if (source_status->rounds_since_loudest <= hangover_rounds) {
+      ++source_status->rounds_since_loudest;
+    }
+    source_status->is_selected =
+        source_status->rounds_since_loudest <= hangover_rounds;
+  }
+}
+
+void AudioMixerImpl::GetAudioInParallel(
+    std::vector<std::pair<SourceStatus*, Source::AudioFrameInfo>>* results) {
+  const int64_t deadline_ms = rtc::TimeMillis() + decode_deadline_ms_;
+  std::shared_ptr<DecodeRound> round = std::make_shared<DecodeRound>(
+      DecodeSlot::kQueued + num_decode_rounds_++, OutputFrequency());
+  for (auto& source_and_status : audio_source_list_) {
+    DecodeSlot* decode_slot = source_and_status->decode_slot.get();
+    // A source that was late for an earlier mix is not asked for more audio
+    // until the late audio has been mixed, so that none of it is lost.
+    const int64_t state = decode_slot->state.load();
+    if (state == DecodeSlot::kDecoding || state == DecodeSlot::kDone)
+      continue;
+    decode_slot->skip = !source_and_status->is_selected;
+    decode_slot->state.store(round->queued_state);
+    round->slots.push_back(source_and_status->decode_slot);
+  }
+  round->num_pending.store(round->slots.size());
+
+  // The mixing thread only waits, so that a slow source cannot hold it up
+  // past the deadline.
+  const size_t num_workers =
+      std::min(decode_queues_.size(), round->slots.size());
+  for (size_t i = 0; i < num_workers; ++i)
+    decode_queues_[i]->PostTask([round] { RunDecodeRound(round.get()); });
+
+  const int64_t remaining_ms = deadline_ms - rtc::TimeMillis();
+  if (round->num_pending.load() > 0 && remaining_ms > 0)
+    round->done.Wait(static_cast<int>(remaining_ms));
+
+  for (auto& source_and_status : audio_source_list_) {
+    DecodeSlot* decode_slot = source_and_status->decode_slot.get();
+    // Sources that no thread has started on are skipped by the workers.
+    int64_t queued = round->queued_state;
+    if (decode_slot->state.compare_exchange_strong(queued, DecodeSlot::kIdle))
+      continue;
+    int64_t done = DecodeSlot::kDone;
+    if (decode_slot->state.compare_exchange_strong(done, DecodeSlot::kIdle)) {
+      if (decode_slot->skip) {
+        decode_slot->audio_frame.ReleaseBuffer();
+      } else {
+        results->emplace_back(source_and_status.get(),
+                              decode_slot->audio_frame_info);
+      }
+    }
+  }
+}
+
+// static
+void AudioMixerImpl::RunDecodeRound(DecodeRound* round) {
+  for (size_t i = round->next_slot++; i < round->slots.size();
+       i = round->next_slot++) {
+    DecodeSlot* decode_slot = round->slots[i].get();
+    int64_t queued = round->queued_state;
+    if (decode_slot->state.compare_exchange_strong(queued,
+                                                   DecodeSlot::kDecoding)) {
+      if (decode_slot->skip) {
+        decode_slot->audio_source->SkipAudioFrame(round->sample_rate_hz);
+      } else {
+        decode_slot->audio_frame_info =
+            decode_slot->audio_source->GetAudioFrameWithInfo(
+                round->sample_rate_hz, &decode_slot->audio_frame);
+      }
+      decode_slot->state.store(DecodeSlot::kDone);
+      decode_slot->decoded.Set();
+    }
+    if (--round->num_pending == 0)
+      round->done.Set();
+  }
+}
+
 bool AudioMixerImpl::GetAudioSourceMixabilityStatusForTest(
     AudioMixerImpl::Source* audio_source) const {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
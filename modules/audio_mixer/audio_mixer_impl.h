@@ -12,6 +12,7 @@
 #define MODULES_AUDIO_MIXER_AUDIO_MIXER_IMPL_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "api/audio/audio_mixer.h"
@@ -19,6 +20,7 @@
 #include "modules/audio_mixer/output_rate_calculator.h"
 #include "rtc_base/race_checker.h"
 #include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/task_queue.h"
 #include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
@@ -26,6 +28,9 @@ namespace webrtc {
 typedef std::vector<AudioFrame*> AudioFrameList;
 
 class AudioMixerImpl : public AudioMixer {
+ private:
+  struct DecodeSlot;
+
  public:
   struct SourceStatus {
     SourceStatus(Source* audio_source, bool is_mixed, float gain)
@@ -34,8 +39,17 @@ class AudioMixerImpl : public AudioMixer {
     bool is_mixed = false;
     float gain = 0.0f;
 
+    // Whether audio is fetched from the source, when sources are selected.
+    bool is_selected = true;
+    int rounds_since_loudest = 0;
+
     // A frame that will be passed to audio_source->GetAudioFrameWithInfo.
     AudioFrame audio_frame;
+
+    // Used instead of |audio_frame| when audio is fetched on worker threads.
+    // Shared with the workers, which may still fetch audio after the source
+    // has been left out of a mix.
+    std::shared_ptr<DecodeSlot> decode_slot;
   };
 
   using SourceStatusList = std::vector<std::unique_ptr<SourceStatus>>;
@@ -44,12 +58,48 @@ class AudioMixerImpl : public AudioMixer {
   static const int kFrameDurationInMs = 10;
   static const int kMaximumAmountOfMixedAudioSources = 3;
 
+  // Fetching audio from the sources on worker threads. Helps mixers with many
+  // sources, which typically decode audio in GetAudioFrameWithInfo().
+  struct ParallelDecodingConfig {
+    // The number of worker threads. With none, audio is fetched on the
+    // mixing thread.
+    int num_worker_threads = 0;
+    // Sources that have not delivered audio this long after Mix() was called
+    // are left out of that mix.
+    int deadline_ms = 5;
+  };
+
+  // Fetching audio only from the sources that are likely to be mixed, ranked
+  // by Source::IncomingAudioLevel(). The other sources skip their audio,
+  // which saves decoding it.
+  struct SourceSelectionConfig {
+    // Audio is fetched from this many of the loudest sources, and from the
+    // recently loud ones. With none, audio is fetched from all sources.
+    int num_selected_sources = 0;
+    // A source takes the place of one of the loudest only if it is louder by
+    // this much.
+    int hysteresis_db = 6;
+    // Sources stay selected this long after they were among the loudest.
+    int hangover_ms = 1000;
+  };
+
   static rtc::scoped_refptr<AudioMixerImpl> Create();
 
   static rtc::scoped_refptr<AudioMixerImpl> Create(
       std::unique_ptr<OutputRateCalculator> output_rate_calculator,
       bool use_limiter);
 
+  static rtc::scoped_refptr<AudioMixerImpl> Create(
+      std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+      bool use_limiter,
+      const ParallelDecodingConfig& parallel_decoding);
+
+  static rtc::scoped_refptr<AudioMixerImpl> Create(
+      std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+      bool use_limiter,
+      const ParallelDecodingConfig& parallel_decoding,
+      const SourceSelectionConfig& source_selection);
+
   ~AudioMixerImpl() override;
 
   // AudioMixer functions
@@ -67,9 +117,13 @@ class AudioMixerImpl : public AudioMixer {
 
  protected:
   AudioMixerImpl(std::unique_ptr<OutputRateCalculator> output_rate_calculator,
-                 bool use_limiter);
+                 bool use_limiter,
+                 const ParallelDecodingConfig& parallel_decoding,
+                 const SourceSelectionConfig& source_selection);
 
  private:
+  struct DecodeRound;
+
   // Set mixing frequency through OutputFrequencyCalculator.
   void CalculateOutputFrequency();
   // Get mixing frequency.
@@ -80,6 +134,19 @@ class AudioMixerImpl : public AudioMixer {
   // kMaximumAmountOfMixedAudioSources audio sources.
   AudioFrameList GetAudioFromSources() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
+  // Updates |is_selected| of the sources in audio_source_list_.
+  void SelectSources() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Fetches audio from the sources on the worker threads until all sources
+  // have delivered or the deadline has passed. Sources that are not selected
+  // skip their audio. Returns the sources that delivered, with the info of
+  // the frame in their |decode_slot|.
+  void GetAudioInParallel(
+      std::vector<std::pair<SourceStatus*, Source::AudioFrameInfo>>* results)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Fetches audio for the slots of |round| until none are left.
+  static void RunDecodeRound(DecodeRound* round);
+
   // Add/remove the MixerAudioSource to the specified
   // MixerAudioSource list.
   bool AddAudioSourceToList(Source* audio_source,
@@ -104,6 +171,13 @@ class AudioMixerImpl : public AudioMixer {
   // Component that handles actual adding of audio frames.
   FrameCombiner frame_combiner_ RTC_GUARDED_BY(race_checker_);
 
+  const SourceSelectionConfig source_selection_;
+
+  const int decode_deadline_ms_;
+  int64_t num_decode_rounds_ RTC_GUARDED_BY(crit_);
+  // Declared last, so that the workers are stopped first on destruction.
+  std::vector<std::unique_ptr<rtc::TaskQueue>> decode_queues_;
+
   RTC_DISALLOW_COPY_AND_ASSIGN(AudioMixerImpl);
 };
 }  // namespace webrtc
@@ -20,6 +20,7 @@
 #include "modules/audio_mixer/default_output_rate_calculator.h"
 #include "rtc_base/bind.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
 #include "rtc_base/strings/string_builder.h"
 #include "rtc_base/task_queue_for_test.h"
 #include "test/gmock.h"
@@ -77,6 +78,8 @@ class MockMixerAudioSource : public testing::NiceMock<AudioMixer::Source> {
 
   MOCK_CONST_METHOD0(PreferredSampleRate, int());
   MOCK_CONST_METHOD0(Ssrc, int());
+  MOCK_CONST_METHOD0(IncomingAudioLevel, absl::optional<int>());
+  MOCK_METHOD1(SkipAudioFrame, void(int sample_rate_hz));
 
   AudioFrame* fake_frame() { return &fake_frame_; }
   AudioFrameInfo fake_info() { return fake_audio_frame_info_; }
@@ -530,4 +533,177 @@ TEST(AudioMixer, AnyRateIsPossibleWithNoLimiter) {
     }
   }
 }
+
+rtc::scoped_refptr<AudioMixerImpl> CreateParallelMixer(int deadline_ms) {
+  AudioMixerImpl::ParallelDecodingConfig parallel_decoding;
+  parallel_decoding.num_worker_threads = 2;
+  parallel_decoding.deadline_ms = deadline_ms;
+  return AudioMixerImpl::Create(
+      std::unique_ptr<OutputRateCalculator>(new DefaultOutputRateCalculator()),
+      true, parallel_decoding);
+}
+
+TEST(AudioMixer, ParallelDecodingMixesLargestEnergy) {
+  constexpr int kAudioSources = 20;
+  const auto mixer = CreateParallelMixer(1000);
+
+  MockMixerAudioSource participants[kAudioSources];
+  for (int i = 0; i < kAudioSources; ++i) {
+    ResetFrame(participants[i].fake_frame());
+    participants[i].fake_frame()->mutable_data()[80] = i;
+    EXPECT_TRUE(mixer->AddSource(&participants[i]));
+    EXPECT_CALL(participants[i], GetAudioFrameWithInfo(kDefaultSampleRateHz, _))
+        .Times(Exactly(2));
+  }
+
+  mixer->Mix(1, &frame_for_mixing);
+  mixer->Mix(1, &frame_for_mixing);
+
+  for (int i = 0; i < kAudioSources; ++i) {
+    EXPECT_EQ(i >= kAudioSources -
+                       AudioMixerImpl::kMaximumAmountOfMixedAudioSources,
+              mixer->GetAudioSourceMixabilityStatusForTest(&participants[i]))
+        << "Mixing status of AudioSource #" << i << " wrong.";
+  }
+}
+
+TEST(AudioMixer, ParallelDecodingLeavesOutLateSource) {
+  const auto mixer = CreateParallelMixer(10);
+  MockMixerAudioSource fast_source;
+  MockMixerAudioSource slow_source;
+  ResetFrame(fast_source.fake_frame());
+  ResetFrame(slow_source.fake_frame());
+  EXPECT_TRUE(mixer->AddSource(&fast_source));
+  EXPECT_TRUE(mixer->AddSource(&slow_source));
+
+  rtc::Event release_slow_source(false, false);
+  rtc::Event slow_source_done(false, false);
+  EXPECT_CALL(slow_source, GetAudioFrameWithInfo(_, _))
+      .WillOnce(Invoke([&](int sample_rate_hz, AudioFrame* audio_frame) {
+        release_slow_source.Wait(rtc::Event::kForever);
+        ResetFrame(audio_frame);
+        slow_source_done.Set();
+        return AudioMixer::Source::AudioFrameInfo::kNormal;
+      }));
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&fast_source));
+  EXPECT_FALSE(mixer->GetAudioSourceMixabilityStatusForTest(&slow_source));
+
+  // The late audio is mixed next time, without asking for more.
+  release_slow_source.Set();
+  ASSERT_TRUE(slow_source_done.Wait(1000));
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&fast_source));
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&slow_source));
+}
+
+TEST(AudioMixer, ParallelDecodingRemoveSourceWaitsForLateSource) {
+  const auto mixer = CreateParallelMixer(10);
+  MockMixerAudioSource fast_source;
+  std::unique_ptr<MockMixerAudioSource> slow_source(new MockMixerAudioSource());
+  EXPECT_TRUE(mixer->AddSource(&fast_source));
+  EXPECT_TRUE(mixer->AddSource(slow_source.get()));
+
+  rtc::Event slow_source_started(false, false);
+  EXPECT_CALL(*slow_source, GetAudioFrameWithInfo(_, _))
+      .WillOnce(Invoke([&](int sample_rate_hz, AudioFrame* audio_frame) {
+        slow_source_started.Set();
+        // Longer than the deadline.
+        rtc::Event(false, false).Wait(50);
+        ResetFrame(audio_frame);
+        return AudioMixer::Source::AudioFrameInfo::kNormal;
+      }));
+  mixer->Mix(1, &frame_for_mixing);
+  ASSERT_TRUE(slow_source_started.Wait(1000));
+
+  // Deleting the source once it is removed must be safe.
+  mixer->RemoveSource(slow_source.get());
+  slow_source.reset();
+  mixer->Mix(1, &frame_for_mixing);
+}
+
+rtc::scoped_refptr<AudioMixerImpl> CreateSelectingMixer(
+    int num_selected_sources,
+    int num_worker_threads) {
+  AudioMixerImpl::ParallelDecodingConfig parallel_decoding;
+  parallel_decoding.num_worker_threads = num_worker_threads;
+  parallel_decoding.deadline_ms = 1000;
+  AudioMixerImpl::SourceSelectionConfig source_selection;
+  source_selection.num_selected_sources = num_selected_sources;
+  source_selection.hangover_ms = 0;
+  return AudioMixerImpl::Create(
+      std::unique_ptr<OutputRateCalculator>(new DefaultOutputRateCalculator()),
+      true, parallel_decoding, source_selection);
+}
+
+TEST(AudioMixer, SourceSelectionSkipsQuietSources) {
+  constexpr int kAudioSources = 6;
+  constexpr int kSelectedSources = 2;
+  for (int num_worker_threads : {0, 2}) {
+    SCOPED_TRACE(num_worker_threads);
+    const auto mixer =
+        CreateSelectingMixer(kSelectedSources, num_worker_threads);
+    MockMixerAudioSource participants[kAudioSources];
+    for (int i = 0; i < kAudioSources; ++i) {
+      ResetFrame(participants[i].fake_frame());
+      EXPECT_TRUE(mixer->AddSource(&participants[i]));
+      // Source 0 is the loudest.
+      ON_CALL(participants[i], IncomingAudioLevel()).WillByDefault(Return(i));
+      const bool selected = i < kSelectedSources;
+      EXPECT_CALL(participants[i], GetAudioFrameWithInfo(_, _))
+          .Times(selected ? 1 : 0);
+      EXPECT_CALL(participants[i], SkipAudioFrame(kDefaultSampleRateHz))
+          .Times(selected ? 0 : 1);
+    }
+
+    mixer->Mix(1, &frame_for_mixing);
+
+    for (int i = 0; i < kAudioSources; ++i) {
+      EXPECT_EQ(i < kSelectedSources,
+                mixer->GetAudioSourceMixabilityStatusForTest(&participants[i]));
+    }
+  }
+}
+
+TEST(AudioMixer, SourceSelectionKeepsSelectedSourcesWithinHysteresis) {
+  const auto mixer = CreateSelectingMixer(1, 0);
+  MockMixerAudioSource selected_source;
+  MockMixerAudioSource other_source;
+  ResetFrame(selected_source.fake_frame());
+  ResetFrame(other_source.fake_frame());
+  EXPECT_TRUE(mixer->AddSource(&selected_source));
+  EXPECT_TRUE(mixer->AddSource(&other_source));
+  absl::optional<int> selected_level = 30;
+  absl::optional<int> other_level = 40;
+  ON_CALL(selected_source, IncomingAudioLevel())
+      .WillByDefault(Invoke([&] { return selected_level; }));
+  ON_CALL(other_source, IncomingAudioLevel())
+      .WillByDefault(Invoke([&] { return other_level; }));
+
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&selected_source));
+  EXPECT_FALSE(mixer->GetAudioSourceMixabilityStatusForTest(&other_source));
+
+  // Slightly louder is not enough.
+  other_level = 27;
+  EXPECT_CALL(other_source, GetAudioFrameWithInfo(_, _)).Times(0);
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&selected_source));
+
+  // Sources without a level are always selected.
+  other_level = absl::nullopt;
+  EXPECT_CALL(other_source, GetAudioFrameWithInfo(_, _)).Times(1);
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&other_source));
+  testing::Mock::VerifyAndClearExpectations(&other_source);
+
+  // A much louder source takes the place of the selected one.
+  selected_level = 30;
+  other_level = 10;
+  EXPECT_CALL(selected_source, GetAudioFrameWithInfo(_, _)).Times(0);
+  EXPECT_CALL(selected_source, SkipAudioFrame(_)).Times(1);
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_FALSE(mixer->GetAudioSourceMixabilityStatusForTest(&selected_source));
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&other_source));
+}
 }  // namespace webrtc
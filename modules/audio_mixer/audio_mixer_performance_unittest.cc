@@ -0,0 +1,265 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "api/audio_codecs/L16/audio_encoder_L16.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/audio_codecs/opus/audio_encoder_opus.h"
+#include "modules/audio_coding/neteq/include/neteq.h"
+#include "modules/audio_mixer/audio_mixer_impl.h"
+#include "modules/audio_mixer/default_output_rate_calculator.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/numerics/mathutils.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr int kSamplesPer10Ms = kSampleRateHz / 100;
+constexpr int kPayloadType = 111;
+constexpr int kPacketDurationMs = 20;
+// Two seconds of audio, which the sources play in a loop.
+constexpr int kNumPackets = 100;
+constexpr int kNumMixes = 1000;
+constexpr int kQuickNumMixes = 10;
+// The number of sources that talk at the same time. Who talks changes every
+// second.
+constexpr int kNumTalkingSources = 3;
+constexpr int kTalkPeriodPackets = 1000 / kPacketDurationMs;
+// In -dBov, as in the RTP audio level header extension.
+constexpr int kTalkingLevel = 20;
+constexpr int kSilentLevel = 127;
+
+// The codecs the sources receive. L16 has next to no decoding cost, so it
+// shows the cost of NetEq and of mixing alone.
+enum class Codec { kOpus, kL16 };
+
+SdpAudioFormat CodecFormat(Codec codec) {
+  return codec == Codec::kOpus ? SdpAudioFormat("opus", kSampleRateHz, 2)
+                               : SdpAudioFormat("L16", kSampleRateHz, 1);
+}
+
+std::string CodecName(Codec codec) {
+  return codec == Codec::kOpus ? "opus" : "l16";
+}
+
+std::unique_ptr<AudioEncoder> CreateEncoder(Codec codec) {
+  if (codec == Codec::kOpus) {
+    AudioEncoderOpusConfig config;
+    config.frame_size_ms = kPacketDurationMs;
+    return AudioEncoderOpus::MakeAudioEncoder(config, kPayloadType);
+  }
+  AudioEncoderL16::Config config;
+  config.sample_rate_hz = kSampleRateHz;
+  config.frame_size_ms = kPacketDurationMs;
+  return AudioEncoderL16::MakeAudioEncoder(config, kPayloadType);
+}
+
+// Packets of a 440 Hz tone at varying level, or of silence. Shared by all
+// sources.
+std::vector<rtc::Buffer> EncodePackets(Codec codec, bool silent) {
+  std::unique_ptr<AudioEncoder> encoder = CreateEncoder(codec);
+
+  std::vector<rtc::Buffer> packets;
+  std::vector<int16_t> audio(kSamplesPer10Ms);
+  uint32_t rtp_timestamp = 0;
+  int sample = 0;
+  while (packets.size() < kNumPackets) {
+    for (int16_t& value : audio) {
+      const double t = static_cast<double>(sample++) / kSampleRateHz;
+      const double amplitude = silent ? 0 : 8000 * (1 + std::sin(2 * M_PI * t));
+      value = static_cast<int16_t>(amplitude * std::sin(2 * M_PI * 440 * t));
+    }
+    rtc::Buffer packet;
+    encoder->Encode(rtp_timestamp, audio, &packet);
+    rtp_timestamp += kSamplesPer10Ms;
+    if (!packet.empty())
+      packets.push_back(std::move(packet));
+  }
+  return packets;
+}
+
+// A source that decodes with NetEq, like a receive stream does. Packets arrive
+// in time, one for every other mix, with the audio level of the talking or the
+// silent packets.
+class NetEqSource : public AudioMixer::Source {
+ public:
+  NetEqSource(int ssrc,
+              int num_sources,
+              const SdpAudioFormat& format,
+              const std::vector<rtc::Buffer>* talking_packets,
+              const std::vector<rtc::Buffer>* silent_packets,
+              const rtc::scoped_refptr<AudioDecoderFactory>& decoder_factory)
+      : ssrc_(ssrc),
+        num_sources_(num_sources),
+        talking_packets_(talking_packets),
+        silent_packets_(silent_packets),
+        neteq_(NetEq::Create(NetEq::Config(), decoder_factory)) {
+    neteq_->RegisterPayloadType(kPayloadType, format);
+  }
+
+  AudioFrameInfo GetAudioFrameWithInfo(int sample_rate_hz,
+                                       AudioFrame* audio_frame) override {
+    MaybeInsertPacket();
+    bool muted;
+    if (neteq_->GetAudio(audio_frame, &muted) != NetEq::kOK)
+      return AudioFrameInfo::kError;
+    return muted ? AudioFrameInfo::kMuted : AudioFrameInfo::kNormal;
+  }
+
+  void SkipAudioFrame(int sample_rate_hz) override {
+    MaybeInsertPacket();
+    neteq_->SkipAudio();
+  }
+
+  absl::optional<int> IncomingAudioLevel() const override {
+    return audio_level_;
+  }
+
+  int Ssrc() const override { return ssrc_; }
+  int PreferredSampleRate() const override { return kSampleRateHz; }
+
+ private:
+  void MaybeInsertPacket() {
+    if (num_calls_++ % (kPacketDurationMs / 10) != 0)
+      return;
+    const int talk_period = sequence_number_ / kTalkPeriodPackets;
+    const bool talking =
+        (ssrc_ + talk_period) % num_sources_ < kNumTalkingSources;
+    const std::vector<rtc::Buffer>& packets =
+        talking ? *talking_packets_ : *silent_packets_;
+    RTPHeader header;
+    header.payloadType = kPayloadType;
+    header.ssrc = ssrc_;
+    header.sequenceNumber = sequence_number_++;
+    header.timestamp = rtp_timestamp_;
+    const rtc::Buffer& packet = packets[header.sequenceNumber % packets.size()];
+    neteq_->InsertPacket(header, packet, rtp_timestamp_);
+    rtp_timestamp_ += kPacketDurationMs * kSampleRateHz / 1000;
+    audio_level_ = talking ? kTalkingLevel : kSilentLevel;
+  }
+
+  const int ssrc_;
+  const int num_sources_;
+  const std::vector<rtc::Buffer>* const talking_packets_;
+  const std::vector<rtc::Buffer>* const silent_packets_;
+  const std::unique_ptr<NetEq> neteq_;
+  int num_calls_ = 0;
+  uint16_t sequence_number_ = 0;
+  uint32_t rtp_timestamp_ = 0;
+  absl::optional<int> audio_level_;
+};
+
+struct MixTimes {
+  double p99_us;
+  double mean_us;
+};
+
+// Mixes |num_sources| sources and returns the times that Mix() takes.
+MixTimes MixSources(
+    Codec codec,
+    int num_sources,
+    const AudioMixerImpl::ParallelDecodingConfig& parallel_decoding,
+    const AudioMixerImpl::SourceSelectionConfig& source_selection) {
+  const std::vector<rtc::Buffer> talking_packets = EncodePackets(codec, false);
+  const std::vector<rtc::Buffer> silent_packets = EncodePackets(codec, true);
+  rtc::scoped_refptr<AudioDecoderFactory> decoder_factory =
+      CreateBuiltinAudioDecoderFactory();
+  std::vector<std::unique_ptr<NetEqSource>> sources;
+  for (int i = 0; i < num_sources; ++i) {
+    sources.emplace_back(new NetEqSource(i, num_sources, CodecFormat(codec),
+                                         &talking_packets, &silent_packets,
+                                         decoder_factory));
+  }
+
+  rtc::scoped_refptr<AudioMixerImpl> mixer = AudioMixerImpl::Create(
+      std::unique_ptr<OutputRateCalculator>(new DefaultOutputRateCalculator()),
+      true, parallel_decoding, source_selection);
+  for (const auto& source : sources)
+    mixer->AddSource(source.get());
+
+  const int num_mixes = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                            ? kQuickNumMixes
+                            : kNumMixes;
+  std::vector<int64_t> mix_times_us;
+  AudioFrame mixed_frame;
+  for (int i = 0; i < num_mixes; ++i) {
+    const int64_t start_us = rtc::TimeMicros();
+    mixer->Mix(1, &mixed_frame);
+    mix_times_us.push_back(rtc::TimeMicros() - start_us);
+  }
+
+  for (const auto& source : sources)
+    mixer->RemoveSource(source.get());
+  std::sort(mix_times_us.begin(), mix_times_us.end());
+  MixTimes mix_times;
+  mix_times.p99_us = mix_times_us[mix_times_us.size() * 99 / 100];
+  mix_times.mean_us =
+      std::accumulate(mix_times_us.begin(), mix_times_us.end(), 0.0) /
+      mix_times_us.size();
+  return mix_times;
+}
+
+// Reports the 99th percentile of the time per mix, and the average time per
+// mix and source, which is the CPU time per participant when mixing on one
+// thread.
+void RunAndReport(
+    const AudioMixerImpl::ParallelDecodingConfig& parallel_decoding,
+    const AudioMixerImpl::SourceSelectionConfig& source_selection,
+    const std::string& modifier) {
+  for (Codec codec : {Codec::kOpus, Codec::kL16}) {
+    for (int num_sources : {50, 100, 200}) {
+      const std::string trace =
+          std::to_string(num_sources) + "_" + CodecName(codec) + "_sources";
+      const MixTimes mix_times = MixSources(
+          codec, num_sources, parallel_decoding, source_selection);
+      test::PrintResult("audio_mixer_mix_p99", modifier, trace,
+                        mix_times.p99_us, "us", false);
+      test::PrintResult("audio_mixer_mix_per_source", modifier, trace,
+                        mix_times.mean_us / num_sources, "us", false);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(AudioMixerPerformanceTest, MixManySources) {
+  RunAndReport(AudioMixerImpl::ParallelDecodingConfig(),
+               AudioMixerImpl::SourceSelectionConfig(), "_sequential");
+}
+
+TEST(AudioMixerPerformanceTest, MixManySourcesInParallel) {
+  AudioMixerImpl::ParallelDecodingConfig parallel_decoding;
+  parallel_decoding.num_worker_threads =
+      std::max(1, static_cast<int>(CpuInfo::DetectNumberOfCores()) - 1);
+  RunAndReport(parallel_decoding, AudioMixerImpl::SourceSelectionConfig(),
+               "_parallel");
+}
+
+TEST(AudioMixerPerformanceTest, MixManySourcesWithSourceSelection) {
+  AudioMixerImpl::SourceSelectionConfig source_selection;
+  source_selection.num_selected_sources =
+      AudioMixerImpl::kMaximumAmountOfMixedAudioSources;
+  RunAndReport(AudioMixerImpl::ParallelDecodingConfig(), source_selection,
+               "_selected");
+}
+
+}  // namespace webrtc
@@ -16,7 +16,6 @@
 
 #include "api/array_view.h"
 #include "audio/utility/audio_frame_operations.h"
-#include "common_audio/include/audio_util.h"
 #include "modules/audio_mixer/audio_frame_manipulator.h"
 #include "modules/audio_mixer/audio_mixer_impl.h"
 #include "modules/audio_processing/include/audio_processing.h"
@@ -72,23 +71,19 @@ void MixFewFramesWithNoLimiter(const std::vector<AudioFrame*>& mix_list,
             audio_frame_for_mixing->mutable_data());
 }
 
-std::array<OneChannelBuffer, kMaximumAmountOfChannels> MixToFloatFrame(
-    const std::vector<AudioFrame*>& mix_list,
-    size_t samples_per_channel,
-    size_t number_of_channels) {
-  // Convert to FloatS16 and mix.
-  using OneChannelBuffer = std::array<float, kMaximumChannelSize>;
-  std::array<OneChannelBuffer, kMaximumAmountOfChannels> mixing_buffer{};
-
-  for (size_t i = 0; i < mix_list.size(); ++i) {
-    const AudioFrame* const frame = mix_list[i];
-    for (size_t j = 0; j < number_of_channels; ++j) {
-      for (size_t k = 0; k < samples_per_channel; ++k) {
-        mixing_buffer[j][k] += frame->data()[number_of_channels * k + j];
-      }
-    }
+void MixToFloatFrame(const MixingMath& mixing_math,
+                     const std::vector<AudioFrame*>& mix_list,
+                     AudioFrameView<float> mixing_buffer_view) {
+  // Mix in int32, which is exact, and convert to FloatS16 once.
+  std::array<int32_t, kMaximumAmountOfChannels * kMaximumChannelSize> mixed{};
+  const size_t size = mixing_buffer_view.num_channels() *
+                      mixing_buffer_view.samples_per_channel();
+  const rtc::ArrayView<int32_t> mixed_view(mixed.data(), size);
+  for (const AudioFrame* frame : mix_list) {
+    mixing_math.Accumulate(rtc::ArrayView<const int16_t>(frame->data(), size),
+                           mixed_view);
   }
-  return mixing_buffer;
+  mixing_math.DeinterleaveToFloatS16(mixed_view, mixing_buffer_view);
 }
 
 void RunLimiter(AudioFrameView<float> mixing_buffer_view,
@@ -100,24 +95,25 @@ void RunLimiter(AudioFrameView<float> mixing_buffer_view,
 }
 
 // Both interleaves and rounds.
-void InterleaveToAudioFrame(AudioFrameView<const float> mixing_buffer_view,
+void InterleaveToAudioFrame(const MixingMath& mixing_math,
+                            AudioFrameView<const float> mixing_buffer_view,
                             AudioFrame* audio_frame_for_mixing) {
-  const size_t number_of_channels = mixing_buffer_view.num_channels();
-  const size_t samples_per_channel = mixing_buffer_view.samples_per_channel();
-  // Put data in the result frame.
-  for (size_t i = 0; i < number_of_channels; ++i) {
-    for (size_t j = 0; j < samples_per_channel; ++j) {
-      audio_frame_for_mixing->mutable_data()[number_of_channels * j + i] =
-          FloatS16ToS16(mixing_buffer_view.channel(i)[j]);
-    }
-  }
+  const size_t size = mixing_buffer_view.num_channels() *
+                      mixing_buffer_view.samples_per_channel();
+  mixing_math.InterleaveToS16(
+      mixing_buffer_view,
+      rtc::ArrayView<int16_t>(audio_frame_for_mixing->mutable_data(), size));
 }
 }  // namespace
 
 FrameCombiner::FrameCombiner(bool use_limiter)
+    : FrameCombiner(use_limiter, DetectMixingOptimization()) {}
+
+FrameCombiner::FrameCombiner(bool use_limiter, MixingOptimization optimization)
     : data_dumper_(new ApmDataDumper(0)),
       limiter_(data_dumper_.get(), "AudioMixer"),
-      use_limiter_(use_limiter) {
+      use_limiter_(use_limiter),
+      mixing_math_(optimization) {
   limiter_.SetGain(0.f);
 }
 
@@ -154,10 +150,8 @@ void FrameCombiner::Combine(const std::vector<AudioFrame*>& mix_list,
     return;
   }
 
-  std::array<OneChannelBuffer, kMaximumAmountOfChannels> mixing_buffer =
-      MixToFloatFrame(mix_list, samples_per_channel, number_of_channels);
-
   // Put float data in an AudioFrameView.
+  std::array<OneChannelBuffer, kMaximumAmountOfChannels> mixing_buffer;
   std::array<float*, kMaximumAmountOfChannels> channel_pointers{};
   for (size_t i = 0; i < number_of_channels; ++i) {
     channel_pointers[i] = &mixing_buffer[i][0];
@@ -165,11 +159,14 @@ void FrameCombiner::Combine(const std::vector<AudioFrame*>& mix_list,
   AudioFrameView<float> mixing_buffer_view(
       &channel_pointers[0], number_of_channels, samples_per_channel);
 
+  MixToFloatFrame(mixing_math_, mix_list, mixing_buffer_view);
+
   if (use_limiter_) {
     RunLimiter(mixing_buffer_view, &limiter_);
   }
 
-  InterleaveToAudioFrame(mixing_buffer_view, audio_frame_for_mixing);
+  InterleaveToAudioFrame(mixing_math_, mixing_buffer_view,
+                         audio_frame_for_mixing);
 }
 
 void FrameCombiner::LogMixingStats(const std::vector<AudioFrame*>& mix_list,
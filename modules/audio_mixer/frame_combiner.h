@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "api/audio/audio_frame.h"
+#include "modules/audio_mixer/mixing_math.h"
 #include "modules/audio_processing/agc2/fixed_gain_controller.h"
 
 namespace webrtc {
@@ -25,6 +26,7 @@ class FrameCombiner {
  public:
   enum class LimiterType { kNoLimiter, kApmAgcLimiter, kApmAgc2Limiter };
   explicit FrameCombiner(bool use_limiter);
+  FrameCombiner(bool use_limiter, MixingOptimization optimization);
   ~FrameCombiner();
 
   // Combine several frames into one. Assumes sample_rate,
@@ -47,6 +49,7 @@ class FrameCombiner {
   std::unique_ptr<ApmDataDumper> data_dumper_;
   FixedGainController limiter_;
   const bool use_limiter_;
+  const MixingMath mixing_math_;
   mutable int uma_logging_counter_ = 0;
 };
 }  // namespace webrtc
@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/audio/audio_frame.h"
+#include "modules/audio_mixer/frame_combiner.h"
+#include "modules/audio_mixer/mixing_math.h"
+#include "rtc_base/random.h"
+#include "rtc_base/system/arch.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kSamplesPerChannel = kSampleRateHz / 100;
+constexpr size_t kNumChannels = 2;
+constexpr int kNumCombines = 10000;
+constexpr int kQuickNumCombines = 10;
+
+// Combines |num_inputs| 48 kHz stereo frames of noise with the limiter
+// enabled. Returns the average time per Combine() in microseconds.
+double CombineFrames(MixingOptimization optimization, size_t num_inputs) {
+  Random random(42);
+  std::vector<std::unique_ptr<AudioFrame>> frames;
+  std::vector<AudioFrame*> mix_list;
+  for (size_t i = 0; i < num_inputs; ++i) {
+    frames.emplace_back(new AudioFrame());
+    AudioFrame* frame = frames.back().get();
+    frame->UpdateFrame(0, nullptr, kSamplesPerChannel, kSampleRateHz,
+                       AudioFrame::kNormalSpeech, AudioFrame::kVadActive,
+                       kNumChannels);
+    int16_t* data = frame->mutable_data();
+    for (size_t k = 0; k < kSamplesPerChannel * kNumChannels; ++k)
+      data[k] = static_cast<int16_t>(random.Rand(-8000, 8000));
+    mix_list.push_back(frame);
+  }
+
+  FrameCombiner combiner(true, optimization);
+  AudioFrame mixed_frame;
+  const int num_combines = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                               ? kQuickNumCombines
+                               : kNumCombines;
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < num_combines; ++i) {
+    combiner.Combine(mix_list, kNumChannels, kSampleRateHz, mix_list.size(),
+                     &mixed_frame);
+  }
+  return static_cast<double>(rtc::TimeMicros() - start_us) / num_combines;
+}
+
+void RunInputSweep(MixingOptimization optimization,
+                   const std::string& implementation) {
+  for (size_t num_inputs : {3, 8, 16, 32}) {
+    test::PrintResult("frame_combiner_combine", "",
+                      implementation + "_" + std::to_string(num_inputs) +
+                          "_stereo_inputs",
+                      CombineFrames(optimization, num_inputs), "us", true);
+  }
+}
+
+}  // namespace
+
+TEST(FrameCombinerPerformanceTest, InputSweep) {
+  RunInputSweep(DetectMixingOptimization(), "optimized");
+}
+
+TEST(FrameCombinerPerformanceTest, ScalarInputSweep) {
+  RunInputSweep(MixingOptimization::kNone, "scalar");
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+TEST(FrameCombinerPerformanceTest, Sse2InputSweep) {
+  if (WebRtc_GetCPUInfo(kSSE2) != 0)
+    RunInputSweep(MixingOptimization::kSse2, "sse2");
+}
+#endif
+
+#if defined(WEBRTC_ENABLE_AVX2)
+TEST(FrameCombinerPerformanceTest, Avx2InputSweep) {
+  if (WebRtc_GetCPUInfo(kAVX2) != 0)
+    RunInputSweep(MixingOptimization::kAvx2, "avx2");
+}
+#endif
+
+}  // namespace webrtc
@@ -0,0 +1,276 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_mixer/mixing_math.h"
+
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
+#include "common_audio/include/audio_util.h"
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+constexpr float kMinS16 = -32768.f;
+constexpr float kMaxS16 = 32767.f;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Rounds half away from zero, after clamping to the int16 range.
+__m128i RoundToS16Range(__m128 x) {
+  const __m128 clamped =
+      _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(kMinS16)), _mm_set1_ps(kMaxS16));
+  const __m128 half = _mm_or_ps(_mm_and_ps(clamped, _mm_set1_ps(-0.f)),
+                                _mm_set1_ps(0.5f));
+  return _mm_cvttps_epi32(_mm_add_ps(clamped, half));
+}
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+// Rounds half away from zero and saturates.
+int16x4_t RoundToS16(float32x4_t x) {
+  const float32x4_t clamped =
+      vminq_f32(vmaxq_f32(x, vdupq_n_f32(kMinS16)), vdupq_n_f32(kMaxS16));
+  const uint32x4_t sign =
+      vandq_u32(vreinterpretq_u32_f32(clamped), vdupq_n_u32(0x80000000));
+  const float32x4_t half = vreinterpretq_f32_u32(
+      vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+  return vqmovn_s32(vcvtq_s32_f32(vaddq_f32(clamped, half)));
+}
+#endif
+
+}  // namespace
+
+MixingOptimization DetectMixingOptimization() {
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    return MixingOptimization::kAvx2;
+  }
+#endif
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2) != 0) {
+    return MixingOptimization::kSse2;
+  }
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+  return MixingOptimization::kNeon;
+#endif
+
+  return MixingOptimization::kNone;
+}
+
+void MixingMath::Accumulate(rtc::ArrayView<const int16_t> frame,
+                            rtc::ArrayView<int32_t> accumulator) const {
+  RTC_DCHECK_EQ(frame.size(), accumulator.size());
+  const size_t size = frame.size();
+  size_t i = 0;
+  switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case MixingOptimization::kAvx2:
+      i = AccumulateAVX2(frame, accumulator);
+      break;
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    case MixingOptimization::kSse2:
+      for (; i + 8 <= size; i += 8) {
+        const __m128i x =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&frame[i]));
+        // Sign extends by shifting the duplicated samples.
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        __m128i* sum = reinterpret_cast<__m128i*>(&accumulator[i]);
+        _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), low));
+        _mm_storeu_si128(sum + 1,
+                         _mm_add_epi32(_mm_loadu_si128(sum + 1), high));
+      }
+      break;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case MixingOptimization::kNeon:
+      for (; i + 8 <= size; i += 8) {
+        const int16x8_t x = vld1q_s16(&frame[i]);
+        vst1q_s32(&accumulator[i],
+                  vaddw_s16(vld1q_s32(&accumulator[i]), vget_low_s16(x)));
+        vst1q_s32(&accumulator[i + 4],
+                  vaddw_s16(vld1q_s32(&accumulator[i + 4]), vget_high_s16(x)));
+      }
+      break;
+#endif
+    default:
+      break;
+  }
+  for (; i < size; ++i) {
+    accumulator[i] += frame[i];
+  }
+}
+
+void MixingMath::DeinterleaveToFloatS16(rtc::ArrayView<const int32_t> samples,
+                                        AudioFrameView<float> output) const {
+  const size_t num_channels = output.num_channels();
+  const size_t samples_per_channel = output.samples_per_channel();
+  RTC_DCHECK_EQ(samples.size(), num_channels * samples_per_channel);
+  size_t k = 0;
+  if (num_channels == 1) {
+    float* const out = output.channel(0).data();
+    switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case MixingOptimization::kAvx2:
+        k = DeinterleaveToFloatS16AVX2(samples, output);
+        break;
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      case MixingOptimization::kSse2:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          const __m128i x =
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[k]));
+          _mm_storeu_ps(&out[k], _mm_cvtepi32_ps(x));
+        }
+        break;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+      case MixingOptimization::kNeon:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          vst1q_f32(&out[k], vcvtq_f32_s32(vld1q_s32(&samples[k])));
+        }
+        break;
+#endif
+      default:
+        break;
+    }
+  } else if (num_channels == 2) {
+    float* const left = output.channel(0).data();
+    float* const right = output.channel(1).data();
+    switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case MixingOptimization::kAvx2:
+        k = DeinterleaveToFloatS16AVX2(samples, output);
+        break;
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      case MixingOptimization::kSse2:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          const __m128i* const x =
+              reinterpret_cast<const __m128i*>(&samples[2 * k]);
+          const __m128 a = _mm_cvtepi32_ps(_mm_loadu_si128(x));
+          const __m128 b = _mm_cvtepi32_ps(_mm_loadu_si128(x + 1));
+          _mm_storeu_ps(&left[k],
+                        _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+          _mm_storeu_ps(&right[k],
+                        _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        break;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+      case MixingOptimization::kNeon:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          const int32x4x2_t x = vld2q_s32(&samples[2 * k]);
+          vst1q_f32(&left[k], vcvtq_f32_s32(x.val[0]));
+          vst1q_f32(&right[k], vcvtq_f32_s32(x.val[1]));
+        }
+        break;
+#endif
+      default:
+        break;
+    }
+  }
+  for (; k < samples_per_channel; ++k) {
+    for (size_t j = 0; j < num_channels; ++j) {
+      output.channel(j)[k] = samples[num_channels * k + j];
+    }
+  }
+}
+
+void MixingMath::InterleaveToS16(AudioFrameView<const float> input,
+                                 rtc::ArrayView<int16_t> samples) const {
+  const size_t num_channels = input.num_channels();
+  const size_t samples_per_channel = input.samples_per_channel();
+  RTC_DCHECK_EQ(samples.size(), num_channels * samples_per_channel);
+  size_t k = 0;
+  if (num_channels == 1) {
+    const float* const in = input.channel(0).data();
+    switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case MixingOptimization::kAvx2:
+        k = InterleaveToS16AVX2(input, samples);
+        break;
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      case MixingOptimization::kSse2:
+        for (; k + 8 <= samples_per_channel; k += 8) {
+          const __m128i low = RoundToS16Range(_mm_loadu_ps(&in[k]));
+          const __m128i high = RoundToS16Range(_mm_loadu_ps(&in[k + 4]));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(&samples[k]),
+                           _mm_packs_epi32(low, high));
+        }
+        break;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+      case MixingOptimization::kNeon:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          vst1_s16(&samples[k], RoundToS16(vld1q_f32(&in[k])));
+        }
+        break;
+#endif
+      default:
+        break;
+    }
+  } else if (num_channels == 2) {
+    const float* const left = input.channel(0).data();
+    const float* const right = input.channel(1).data();
+    switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case MixingOptimization::kAvx2:
+        k = InterleaveToS16AVX2(input, samples);
+        break;
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+      case MixingOptimization::kSse2:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          const __m128 l = _mm_loadu_ps(&left[k]);
+          const __m128 r = _mm_loadu_ps(&right[k]);
+          const __m128i low = RoundToS16Range(_mm_unpacklo_ps(l, r));
+          const __m128i high = RoundToS16Range(_mm_unpackhi_ps(l, r));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(&samples[2 * k]),
+                           _mm_packs_epi32(low, high));
+        }
+        break;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+      case MixingOptimization::kNeon:
+        for (; k + 4 <= samples_per_channel; k += 4) {
+          int16x4x2_t x;
+          x.val[0] = RoundToS16(vld1q_f32(&left[k]));
+          x.val[1] = RoundToS16(vld1q_f32(&right[k]));
+          vst2_s16(&samples[2 * k], x);
+        }
+        break;
+#endif
+      default:
+        break;
+    }
+  }
+  for (; k < samples_per_channel; ++k) {
+    for (size_t j = 0; j < num_channels; ++j) {
+      samples[num_channels * k + j] = FloatS16ToS16(input.channel(j)[k]);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_MIXER_MIXING_MATH_H_
+#define MODULES_AUDIO_MIXER_MIXING_MATH_H_
+
+#include <stdint.h>
+
+#include "api/array_view.h"
+#include "modules/audio_processing/include/audio_frame_view.h"
+
+namespace webrtc {
+
+enum class MixingOptimization { kNone, kSse2, kAvx2, kNeon };
+
+// Returns the best optimization that the CPU supports.
+MixingOptimization DetectMixingOptimization();
+
+// Provides optimizations for the sample conversions and the accumulation done
+// when mixing interleaved int16 frames. All optimizations give the same
+// results.
+class MixingMath {
+ public:
+  explicit MixingMath(MixingOptimization optimization)
+      : optimization_(optimization) {}
+
+  // Adds the samples of |frame| to |accumulator|. The sum of up to 65536
+  // frames cannot overflow.
+  void Accumulate(rtc::ArrayView<const int16_t> frame,
+                  rtc::ArrayView<int32_t> accumulator) const;
+
+  // Converts the interleaved |samples| to FloatS16 and writes them to the
+  // channels of |output|.
+  void DeinterleaveToFloatS16(rtc::ArrayView<const int32_t> samples,
+                              AudioFrameView<float> output) const;
+
+  // Interleaves the channels of |input| to |samples|, rounding and
+  // saturating like FloatS16ToS16().
+  void InterleaveToS16(AudioFrameView<const float> input,
+                       rtc::ArrayView<int16_t> samples) const;
+
+ private:
+#if defined(WEBRTC_ENABLE_AVX2)
+  // The AVX2 versions are in a separate translation unit, since only that one
+  // is built with AVX2 instructions enabled. They return the number of samples
+  // (per channel, for the channel conversions) that they processed; the rest
+  // is left to the scalar code.
+  size_t AccumulateAVX2(rtc::ArrayView<const int16_t> frame,
+                        rtc::ArrayView<int32_t> accumulator) const;
+  size_t DeinterleaveToFloatS16AVX2(rtc::ArrayView<const int32_t> samples,
+                                    AudioFrameView<float> output) const;
+  size_t InterleaveToS16AVX2(AudioFrameView<const float> input,
+                             rtc::ArrayView<int16_t> samples) const;
+#endif
+
+  const MixingOptimization optimization_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_MIXER_MIXING_MATH_H_
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_mixer/mixing_math.h"
+
+#include <immintrin.h>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+constexpr float kMinS16 = -32768.f;
+constexpr float kMaxS16 = 32767.f;
+
+// Rounds half away from zero, after clamping to the int16 range. Same as the
+// SSE2 version, eight samples at a time.
+__m256i RoundToS16Range(__m256 x) {
+  const __m256 clamped = _mm256_min_ps(
+      _mm256_max_ps(x, _mm256_set1_ps(kMinS16)), _mm256_set1_ps(kMaxS16));
+  const __m256 half = _mm256_or_ps(
+      _mm256_and_ps(clamped, _mm256_set1_ps(-0.f)), _mm256_set1_ps(0.5f));
+  return _mm256_cvttps_epi32(_mm256_add_ps(clamped, half));
+}
+
+}  // namespace
+
+size_t MixingMath::AccumulateAVX2(rtc::ArrayView<const int16_t> frame,
+                                  rtc::ArrayView<int32_t> accumulator) const {
+  RTC_DCHECK_EQ(frame.size(), accumulator.size());
+  const size_t size = frame.size();
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&frame[i]));
+    const __m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x));
+    const __m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1));
+    __m256i* sum = reinterpret_cast<__m256i*>(&accumulator[i]);
+    _mm256_storeu_si256(sum, _mm256_add_epi32(_mm256_loadu_si256(sum), low));
+    _mm256_storeu_si256(sum + 1,
+                        _mm256_add_epi32(_mm256_loadu_si256(sum + 1), high));
+  }
+  return i;
+}
+
+size_t MixingMath::DeinterleaveToFloatS16AVX2(
+    rtc::ArrayView<const int32_t> samples,
+    AudioFrameView<float> output) const {
+  const size_t num_channels = output.num_channels();
+  const size_t samples_per_channel = output.samples_per_channel();
+  size_t k = 0;
+  if (num_channels == 1) {
+    float* const out = output.channel(0).data();
+    for (; k + 8 <= samples_per_channel; k += 8) {
+      const __m256i x =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&samples[k]));
+      _mm256_storeu_ps(&out[k], _mm256_cvtepi32_ps(x));
+    }
+  } else if (num_channels == 2) {
+    float* const left = output.channel(0).data();
+    float* const right = output.channel(1).data();
+    for (; k + 8 <= samples_per_channel; k += 8) {
+      const __m256i* const x =
+          reinterpret_cast<const __m256i*>(&samples[2 * k]);
+      const __m256 a = _mm256_cvtepi32_ps(_mm256_loadu_si256(x));
+      const __m256 b = _mm256_cvtepi32_ps(_mm256_loadu_si256(x + 1));
+      // The shuffles work within 128-bit lanes, so they give the channels in
+      // the order (0-1, 4-5, 2-3, 6-7), which the permutes put right.
+      const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      const __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      _mm256_storeu_ps(&left[k],
+                       _mm256_castpd_ps(_mm256_permute4x64_pd(
+                           _mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+      _mm256_storeu_ps(&right[k],
+                       _mm256_castpd_ps(_mm256_permute4x64_pd(
+                           _mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+  }
+  return k;
+}
+
+size_t MixingMath::InterleaveToS16AVX2(AudioFrameView<const float> input,
+                                       rtc::ArrayView<int16_t> samples) const {
+  const size_t num_channels = input.num_channels();
+  const size_t samples_per_channel = input.samples_per_channel();
+  size_t k = 0;
+  if (num_channels == 1) {
+    const float* const in = input.channel(0).data();
+    for (; k + 16 <= samples_per_channel; k += 16) {
+      const __m256i low = RoundToS16Range(_mm256_loadu_ps(&in[k]));
+      const __m256i high = RoundToS16Range(_mm256_loadu_ps(&in[k + 8]));
+      // The pack works within 128-bit lanes, so the halves of |low| and
+      // |high| come out interleaved and are permuted back in order.
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(&samples[k]),
+          _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high),
+                                   _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+  } else if (num_channels == 2) {
+    const float* const left = input.channel(0).data();
+    const float* const right = input.channel(1).data();
+    for (; k + 8 <= samples_per_channel; k += 8) {
+      const __m256 l = _mm256_loadu_ps(&left[k]);
+      const __m256 r = _mm256_loadu_ps(&right[k]);
+      // Within each 128-bit lane, the unpacks and the pack cancel out each
+      // other's reordering, so the samples come out interleaved in order.
+      const __m256i low = RoundToS16Range(_mm256_unpacklo_ps(l, r));
+      const __m256i high = RoundToS16Range(_mm256_unpackhi_ps(l, r));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(&samples[2 * k]),
+                          _mm256_packs_epi32(low, high));
+    }
+  }
+  return k;
+}
+
+}  // namespace webrtc
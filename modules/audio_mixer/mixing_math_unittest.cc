@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_mixer/mixing_math.h"
+
+#include <array>
+#include <vector>
+
+#include "common_audio/include/audio_util.h"
+#include "rtc_base/arraysize.h"
+#include "rtc_base/random.h"
+#include "rtc_base/system/arch.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+// Returns the scalar code and every optimization that the CPU supports.
+std::vector<MixingOptimization> SupportedOptimizations() {
+  std::vector<MixingOptimization> optimizations = {MixingOptimization::kNone};
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2) != 0)
+    optimizations.push_back(MixingOptimization::kSse2);
+#endif
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0)
+    optimizations.push_back(MixingOptimization::kAvx2);
+#endif
+#if defined(WEBRTC_HAS_NEON)
+  optimizations.push_back(MixingOptimization::kNeon);
+#endif
+  return optimizations;
+}
+
+// Odd, so that the optimized versions also process a tail.
+constexpr size_t kSamplesPerChannel = 487;
+
+std::vector<int16_t> RandomSamples(size_t size, Random* random) {
+  std::vector<int16_t> samples(size);
+  for (int16_t& sample : samples)
+    sample = static_cast<int16_t>(random->Rand(-32768, 32767));
+  return samples;
+}
+
+// Values around the int16 limits and halfway between integers, where the
+// rounding and the saturation matter.
+std::vector<float> EdgeCaseFloats(size_t size, Random* random) {
+  const float kEdgeCases[] = {0.f,      0.5f,      -0.5f,     1.5f,
+                              -1.5f,    32766.5f,  -32767.5f, 32767.f,
+                              -32768.f, 32767.49f, 40000.f,   -40000.f};
+  std::vector<float> values(size);
+  for (size_t i = 0; i < size; ++i) {
+    values[i] = i % 2 == 0 ? kEdgeCases[(i / 2) % arraysize(kEdgeCases)]
+                           : random->Rand(-36000, 36000) + 0.5f;
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST(MixingMath, AccumulateIsExact) {
+  for (MixingOptimization optimization : SupportedOptimizations()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    const MixingMath mixing_math(optimization);
+    Random random(42);
+    const size_t size = 2 * kSamplesPerChannel;
+    std::vector<int32_t> accumulator(size, 0);
+    std::vector<int32_t> expected(size, 0);
+    for (int i = 0; i < 32; ++i) {
+      const std::vector<int16_t> frame = RandomSamples(size, &random);
+      mixing_math.Accumulate(frame, accumulator);
+      for (size_t k = 0; k < size; ++k)
+        expected[k] += frame[k];
+    }
+    EXPECT_EQ(expected, accumulator);
+  }
+}
+
+TEST(MixingMath, DeinterleaveToFloatS16) {
+  for (MixingOptimization optimization : SupportedOptimizations()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    const MixingMath mixing_math(optimization);
+    Random random(42);
+    for (size_t num_channels : {1, 2, 3}) {
+      SCOPED_TRACE(num_channels);
+      std::vector<int32_t> samples(num_channels * kSamplesPerChannel);
+      for (int32_t& sample : samples)
+        sample = random.Rand(-1000000, 1000000);
+
+      std::array<std::vector<float>, 3> channels;
+      std::array<float*, 3> channel_pointers;
+      for (size_t j = 0; j < num_channels; ++j) {
+        channels[j].resize(kSamplesPerChannel);
+        channel_pointers[j] = channels[j].data();
+      }
+      mixing_math.DeinterleaveToFloatS16(
+          samples, AudioFrameView<float>(channel_pointers.data(), num_channels,
+                                         kSamplesPerChannel));
+      for (size_t k = 0; k < kSamplesPerChannel; ++k) {
+        for (size_t j = 0; j < num_channels; ++j) {
+          EXPECT_EQ(static_cast<float>(samples[num_channels * k + j]),
+                    channels[j][k]);
+        }
+      }
+    }
+  }
+}
+
+TEST(MixingMath, InterleaveToS16RoundsAndSaturatesLikeFloatS16ToS16) {
+  for (MixingOptimization optimization : SupportedOptimizations()) {
+    SCOPED_TRACE(static_cast<int>(optimization));
+    const MixingMath mixing_math(optimization);
+    Random random(42);
+    for (size_t num_channels : {1, 2, 3}) {
+      SCOPED_TRACE(num_channels);
+      std::array<std::vector<float>, 3> channels;
+      std::array<const float*, 3> channel_pointers;
+      for (size_t j = 0; j < num_channels; ++j) {
+        channels[j] = EdgeCaseFloats(kSamplesPerChannel, &random);
+        channel_pointers[j] = channels[j].data();
+      }
+      std::vector<int16_t> samples(num_channels * kSamplesPerChannel);
+      mixing_math.InterleaveToS16(
+          AudioFrameView<const float>(channel_pointers.data(), num_channels,
+                                      kSamplesPerChannel),
+          samples);
+      for (size_t k = 0; k < kSamplesPerChannel; ++k) {
+        for (size_t j = 0; j < num_channels; ++j) {
+          EXPECT_EQ(FloatS16ToS16(channels[j][k]),
+                    samples[num_channels * k + j]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace webrtc
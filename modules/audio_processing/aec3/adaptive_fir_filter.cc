@@ -538,6 +538,11 @@ void AdaptiveFirFilter::Filter(const RenderBuffer& render_buffer,
                                FftData* S) const {
   RTC_DCHECK(S);
   switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Aec3Optimization::kAvx2:
+      aec3::ApplyFilter_AVX2(render_buffer, H_, S);
+      break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
     case Aec3Optimization::kSse2:
       aec3::ApplyFilter_SSE2(render_buffer, H_, S);
@@ -560,6 +565,11 @@ void AdaptiveFirFilter::Adapt(const RenderBuffer& render_buffer,
 
   // Adapt the filter.
   switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Aec3Optimization::kAvx2:
+      aec3::AdaptPartitions_AVX2(render_buffer, G, H_);
+      break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
     case Aec3Optimization::kSse2:
       aec3::AdaptPartitions_SSE2(render_buffer, G, H_);
@@ -579,6 +589,12 @@ void AdaptiveFirFilter::Adapt(const RenderBuffer& render_buffer,
 
   // Update the frequency response and echo return loss for the filter.
   switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Aec3Optimization::kAvx2:
+      aec3::UpdateFrequencyResponse_AVX2(H_, &H2_);
+      aec3::UpdateErlEstimator_AVX2(H2_, &erl_);
+      break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
     case Aec3Optimization::kSse2:
       aec3::UpdateFrequencyResponse_SSE2(H_, &H2_);
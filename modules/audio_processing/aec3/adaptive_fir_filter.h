@@ -40,6 +40,11 @@ void UpdateFrequencyResponse_SSE2(
     rtc::ArrayView<const FftData> H,
     std::vector<std::array<float, kFftLengthBy2Plus1>>* H2);
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+void UpdateFrequencyResponse_AVX2(
+    rtc::ArrayView<const FftData> H,
+    std::vector<std::array<float, kFftLengthBy2Plus1>>* H2);
+#endif
 
 // Computes and stores the echo return loss estimate of the filter, which is the
 // sum of the partition frequency responses.
@@ -56,6 +61,11 @@ void UpdateErlEstimator_SSE2(
     const std::vector<std::array<float, kFftLengthBy2Plus1>>& H2,
     std::array<float, kFftLengthBy2Plus1>* erl);
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+void UpdateErlEstimator_AVX2(
+    const std::vector<std::array<float, kFftLengthBy2Plus1>>& H2,
+    std::array<float, kFftLengthBy2Plus1>* erl);
+#endif
 
 // Adapts the filter partitions.
 void AdaptPartitions(const RenderBuffer& render_buffer,
@@ -71,6 +81,11 @@ void AdaptPartitions_SSE2(const RenderBuffer& render_buffer,
                           const FftData& G,
                           rtc::ArrayView<FftData> H);
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+void AdaptPartitions_AVX2(const RenderBuffer& render_buffer,
+                          const FftData& G,
+                          rtc::ArrayView<FftData> H);
+#endif
 
 // Produces the filter output.
 void ApplyFilter(const RenderBuffer& render_buffer,
@@ -86,6 +101,11 @@ void ApplyFilter_SSE2(const RenderBuffer& render_buffer,
                       rtc::ArrayView<const FftData> H,
                       FftData* S);
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+void ApplyFilter_AVX2(const RenderBuffer& render_buffer,
+                      rtc::ArrayView<const FftData> H,
+                      FftData* S);
+#endif
 
 }  // namespace aec3
 
@@ -16,7 +16,6 @@
 #include <functional>
 #include <numeric>
 
-#include "modules/audio_processing/utility/ooura_fft.h"
 #include "rtc_base/numerics/safe_minmax.h"
 
 namespace webrtc {
@@ -33,7 +33,6 @@ class SuppressionFilter {
 
  private:
   const int sample_rate_hz_;
-  const OouraFft ooura_fft_;
   const Aec3Fft fft_;
   std::vector<std::array<float, kFftLengthBy2>> e_output_old_;
   RTC_DISALLOW_COPY_AND_ASSIGN(SuppressionFilter);
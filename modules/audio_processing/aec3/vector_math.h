@@ -41,6 +41,11 @@ class VectorMath {
   // Elementwise square root.
   void Sqrt(rtc::ArrayView<float> x) {
     switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case Aec3Optimization::kAvx2:
+        SqrtAVX2(x);
+        break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
       case Aec3Optimization::kSse2: {
         const int x_size = static_cast<int>(x.size());
@@ -115,6 +120,11 @@ class VectorMath {
     RTC_DCHECK_EQ(z.size(), x.size());
     RTC_DCHECK_EQ(z.size(), y.size());
     switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case Aec3Optimization::kAvx2:
+        MultiplyAVX2(x, y, z);
+        break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
       case Aec3Optimization::kSse2: {
         const int x_size = static_cast<int>(x.size());
@@ -161,6 +171,11 @@ class VectorMath {
   void Accumulate(rtc::ArrayView<const float> x, rtc::ArrayView<float> z) {
     RTC_DCHECK_EQ(z.size(), x.size());
     switch (optimization_) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case Aec3Optimization::kAvx2:
+        AccumulateAVX2(x, z);
+        break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
       case Aec3Optimization::kSse2: {
         const int x_size = static_cast<int>(x.size());
@@ -204,6 +219,16 @@ class VectorMath {
   }
 
  private:
+#if defined(WEBRTC_ENABLE_AVX2)
+  // The AVX2 versions are in a separate translation unit, since only that one
+  // is built with AVX2 instructions enabled.
+  void SqrtAVX2(rtc::ArrayView<float> x);
+  void MultiplyAVX2(rtc::ArrayView<const float> x,
+                    rtc::ArrayView<const float> y,
+                    rtc::ArrayView<float> z);
+  void AccumulateAVX2(rtc::ArrayView<const float> x, rtc::ArrayView<float> z);
+#endif
+
   Aec3Optimization optimization_;
 };
 
@@ -143,4 +143,70 @@ TEST(VectorMath, Accumulate) {
 }
 #endif
 
+#if defined(WEBRTC_ENABLE_AVX2)
+
+TEST(VectorMath, SqrtAvx2) {
+  if (WebRtc_GetCPUInfo(kAVX2) != 0 && WebRtc_GetCPUInfo(kFMA3) != 0) {
+    std::array<float, kFftLengthBy2Plus1> x;
+    std::array<float, kFftLengthBy2Plus1> z;
+    std::array<float, kFftLengthBy2Plus1> z_avx2;
+
+    for (size_t k = 0; k < x.size(); ++k) {
+      x[k] = (2.f / 3.f) * k;
+    }
+
+    std::copy(x.begin(), x.end(), z.begin());
+    aec3::VectorMath(Aec3Optimization::kNone).Sqrt(z);
+    std::copy(x.begin(), x.end(), z_avx2.begin());
+    aec3::VectorMath(Aec3Optimization::kAvx2).Sqrt(z_avx2);
+    EXPECT_EQ(z, z_avx2);
+    for (size_t k = 0; k < z.size(); ++k) {
+      EXPECT_FLOAT_EQ(z[k], z_avx2[k]);
+      EXPECT_FLOAT_EQ(sqrtf(x[k]), z_avx2[k]);
+    }
+  }
+}
+
+TEST(VectorMath, MultiplyAvx2) {
+  if (WebRtc_GetCPUInfo(kAVX2) != 0 && WebRtc_GetCPUInfo(kFMA3) != 0) {
+    std::array<float, kFftLengthBy2Plus1> x;
+    std::array<float, kFftLengthBy2Plus1> y;
+    std::array<float, kFftLengthBy2Plus1> z;
+    std::array<float, kFftLengthBy2Plus1> z_avx2;
+
+    for (size_t k = 0; k < x.size(); ++k) {
+      x[k] = k;
+      y[k] = (2.f / 3.f) * k;
+    }
+
+    aec3::VectorMath(Aec3Optimization::kNone).Multiply(x, y, z);
+    aec3::VectorMath(Aec3Optimization::kAvx2).Multiply(x, y, z_avx2);
+    for (size_t k = 0; k < z.size(); ++k) {
+      EXPECT_FLOAT_EQ(z[k], z_avx2[k]);
+      EXPECT_FLOAT_EQ(x[k] * y[k], z_avx2[k]);
+    }
+  }
+}
+
+TEST(VectorMath, AccumulateAvx2) {
+  if (WebRtc_GetCPUInfo(kAVX2) != 0 && WebRtc_GetCPUInfo(kFMA3) != 0) {
+    std::array<float, kFftLengthBy2Plus1> x;
+    std::array<float, kFftLengthBy2Plus1> z;
+    std::array<float, kFftLengthBy2Plus1> z_avx2;
+
+    for (size_t k = 0; k < x.size(); ++k) {
+      x[k] = k;
+      z[k] = z_avx2[k] = 2.f * k;
+    }
+
+    aec3::VectorMath(Aec3Optimization::kNone).Accumulate(x, z);
+    aec3::VectorMath(Aec3Optimization::kAvx2).Accumulate(x, z_avx2);
+    for (size_t k = 0; k < z.size(); ++k) {
+      EXPECT_FLOAT_EQ(z[k], z_avx2[k]);
+      EXPECT_FLOAT_EQ(x[k] + 2.f * x[k], z_avx2[k]);
+    }
+  }
+}
+#endif
+
 }  // namespace webrtc
@@ -35,7 +35,7 @@ std::array<float, kHalfFrameSize> ComputeHalfVorbisWindow() {
 
 BandAnalysisFft::BandAnalysisFft()
     : half_window_(ComputeHalfVorbisWindow()),
-      fft_(static_cast<int>(input_buf_.size())) {}
+      fft_(kFrameSize20ms24kHz) {}
 
 BandAnalysisFft::~BandAnalysisFft() = default;
 
@@ -46,12 +46,18 @@ void BandAnalysisFft::ForwardFft(rtc::ArrayView<const float> samples,
   // Apply windowing.
   RTC_DCHECK_EQ(input_buf_.size(), 2 * half_window_.size());
   for (size_t i = 0; i < input_buf_.size() / 2; ++i) {
-    input_buf_[i].real(samples[i] * half_window_[i]);
+    input_buf_[i] = samples[i] * half_window_[i];
     size_t j = kFrameSize20ms24kHz - i - 1;
-    input_buf_[j].real(samples[j] * half_window_[i]);
+    input_buf_[j] = samples[j] * half_window_[i];
+  }
+  fft_.Forward(input_buf_, output_re_, output_im_);
+  // Scale and fill in the upper half of the spectrum by conjugate symmetry.
+  constexpr float kScale = 1.f / kFrameSize20ms24kHz;
+  dst[0] = {kScale * output_re_[0], 0.f};
+  for (size_t i = 1; i < output_re_.size(); ++i) {
+    dst[i] = {kScale * output_re_[i], kScale * output_im_[i]};
+    dst[kFrameSize20ms24kHz - i] = std::conj(dst[i]);
   }
-  fft_.ForwardFft(kFrameSize20ms24kHz, input_buf_.data(), kFrameSize20ms24kHz,
-                  dst.data());
 }
 
 }  // namespace rnn_vad
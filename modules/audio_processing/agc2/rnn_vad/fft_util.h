@@ -16,7 +16,7 @@
 
 #include "api/array_view.h"
 #include "modules/audio_processing/agc2/rnn_vad/common.h"
-#include "third_party/rnnoise/src/kiss_fft.h"
+#include "modules/audio_processing/utility/real_fft.h"
 
 namespace webrtc {
 namespace rnn_vad {
@@ -33,7 +33,9 @@ class BandAnalysisFft {
   BandAnalysisFft& operator=(const BandAnalysisFft&) = delete;
   ~BandAnalysisFft();
   // Applies a windowing function to |samples|, computes the real forward FFT
-  // and writes the result in |dst|.
+  // and writes the result in |dst|, scaled by 1 / kFrameSize20ms24kHz. All the
+  // kFrameSize20ms24kHz coefficients are written, including those that follow
+  // from the conjugate symmetry of the spectrum.
   void ForwardFft(rtc::ArrayView<const float> samples,
                   rtc::ArrayView<std::complex<float>> dst);
 
@@ -41,8 +43,10 @@ class BandAnalysisFft {
   static_assert((kFrameSize20ms24kHz & 1) == 0,
                 "kFrameSize20ms24kHz must be even.");
   const std::array<float, kFrameSize20ms24kHz / 2> half_window_;
-  std::array<std::complex<float>, kFrameSize20ms24kHz> input_buf_{};
-  rnnoise::KissFft fft_;
+  std::array<float, kFrameSize20ms24kHz> input_buf_{};
+  std::array<float, kFrameSize20ms24kHz / 2 + 1> output_re_{};
+  std::array<float, kFrameSize20ms24kHz / 2 + 1> output_im_{};
+  const RealFft fft_;
 };
 
 }  // namespace rnn_vad
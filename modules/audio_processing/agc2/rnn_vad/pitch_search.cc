@@ -14,7 +14,7 @@ namespace webrtc {
 namespace rnn_vad {
 
 PitchEstimator::PitchEstimator()
-    : fft_(RealFourier::Create(kAutoCorrelationFftOrder)),
+    : fft_(size_t{1} << kAutoCorrelationFftOrder),
       pitch_buf_decimated_(kBufSize12kHz),
       pitch_buf_decimated_view_(pitch_buf_decimated_.data(), kBufSize12kHz),
       auto_corr_(kNumInvertedLags12kHz),
@@ -31,7 +31,7 @@ PitchInfo PitchEstimator::Estimate(
   Decimate2x(pitch_buf, pitch_buf_decimated_view_);
   // Compute auto-correlation terms.
   ComputePitchAutoCorrelation(pitch_buf_decimated_view_, kMaxPitch12kHz,
-                              auto_corr_view_, fft_.get());
+                              auto_corr_view_, &fft_);
 
   // Search for pitch at 12 kHz.
   std::array<size_t, 2> pitch_candidates_inv_lags = FindBestPitchPeriods(
@@ -11,14 +11,13 @@
 #ifndef MODULES_AUDIO_PROCESSING_AGC2_RNN_VAD_PITCH_SEARCH_H_
 #define MODULES_AUDIO_PROCESSING_AGC2_RNN_VAD_PITCH_SEARCH_H_
 
-#include <memory>
 #include <vector>
 
 #include "api/array_view.h"
-#include "common_audio/real_fourier.h"
 #include "modules/audio_processing/agc2/rnn_vad/common.h"
 #include "modules/audio_processing/agc2/rnn_vad/pitch_info.h"
 #include "modules/audio_processing/agc2/rnn_vad/pitch_search_internal.h"
+#include "modules/audio_processing/utility/real_fft.h"
 
 namespace webrtc {
 namespace rnn_vad {
@@ -36,7 +35,7 @@ class PitchEstimator {
 
  private:
   PitchInfo last_pitch_48kHz_;
-  std::unique_ptr<RealFourier> fft_;
+  const RealFft fft_;
   std::vector<float> pitch_buf_decimated_;
   rtc::ArrayView<float, kBufSize12kHz> pitch_buf_decimated_view_;
   std::vector<float> auto_corr_;
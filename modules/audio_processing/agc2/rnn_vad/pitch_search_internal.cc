@@ -210,7 +210,7 @@ void ComputePitchAutoCorrelation(
     rtc::ArrayView<const float, kBufSize12kHz> pitch_buf,
     size_t max_pitch_period,
     rtc::ArrayView<float, kNumInvertedLags12kHz> auto_corr,
-    webrtc::RealFourier* fft) {
+    const RealFft* fft) {
   RTC_DCHECK_GT(max_pitch_period, auto_corr.size());
   RTC_DCHECK_LT(max_pitch_period, pitch_buf.size());
   RTC_DCHECK(fft);
@@ -218,9 +218,8 @@ void ComputePitchAutoCorrelation(
   constexpr size_t time_domain_fft_length = 1 << kAutoCorrelationFftOrder;
   constexpr size_t freq_domain_fft_length = time_domain_fft_length / 2 + 1;
 
-  RTC_DCHECK_EQ(RealFourier::FftLength(fft->order()), time_domain_fft_length);
-  RTC_DCHECK_EQ(RealFourier::ComplexLength(fft->order()),
-                freq_domain_fft_length);
+  RTC_DCHECK_EQ(fft->fft_size(), time_domain_fft_length);
+  RTC_DCHECK_EQ(fft->num_bins(), freq_domain_fft_length);
 
   // Cross-correlation of y_i=pitch_buf[i:i+convolution_length] and
   // x=pitch_buf[-convolution_length:] is equivalent to convolution of
@@ -244,19 +243,26 @@ void ComputePitchAutoCorrelation(
             x.begin());
 
   // Shift to frequency domain.
-  std::array<std::complex<float>, freq_domain_fft_length> X{};
-  std::array<std::complex<float>, freq_domain_fft_length> H{};
-  fft->Forward(&x[0], &X[0]);
-  fft->Forward(&h[0], &H[0]);
-
-  // Convolve in frequency domain.
-  for (size_t i = 0; i < X.size(); ++i) {
-    X[i] *= H[i];
+  std::array<float, freq_domain_fft_length> X_re;
+  std::array<float, freq_domain_fft_length> X_im;
+  std::array<float, freq_domain_fft_length> H_re;
+  std::array<float, freq_domain_fft_length> H_im;
+  fft->Forward(x, X_re, X_im);
+  fft->Forward(h, H_re, H_im);
+
+  // Convolve in frequency domain. The scaling of the inverse transform by its
+  // length is compensated here.
+  constexpr float kScale = 1.f / time_domain_fft_length;
+  for (size_t i = 0; i < X_re.size(); ++i) {
+    const float re = X_re[i] * H_re[i] - X_im[i] * H_im[i];
+    const float im = X_re[i] * H_im[i] + X_im[i] * H_re[i];
+    X_re[i] = kScale * re;
+    X_im[i] = kScale * im;
   }
 
   // Shift back to time domain.
   std::array<float, time_domain_fft_length> x_conv_h;
-  fft->Inverse(&X[0], &x_conv_h[0]);
+  fft->Inverse(X_re, X_im, x_conv_h);
 
   // Collect the result.
   std::copy(x_conv_h.begin() + convolution_length - 1,
@@ -9,7 +9,6 @@
  */
 
 #include "modules/audio_processing/agc2/rnn_vad/pitch_search_internal.h"
-#include "common_audio/real_fourier.h"
 
 #include <array>
 #include <tuple>
@@ -127,10 +126,9 @@ TEST(RnnVadTest, ComputePitchAutoCorrelationBitExactness) {
   {
     // TODO(bugs.webrtc.org/8948): Add when the issue is fixed.
     // FloatingPointExceptionObserver fpe_observer;
-    std::unique_ptr<RealFourier> fft =
-        RealFourier::Create(kAutoCorrelationFftOrder);
+    const RealFft fft(size_t{1} << kAutoCorrelationFftOrder);
     ComputePitchAutoCorrelation(pitch_buf_decimated, kMaxPitch12kHz,
-                                computed_output, fft.get());
+                                computed_output, &fft);
   }
   auto auto_corr_view = test_data.GetPitchBufAutoCorrCoeffsView();
   ExpectNearAbsolute({auto_corr_view.data(), auto_corr_view.size()},
@@ -148,10 +146,9 @@ TEST(RnnVadTest, ComputePitchAutoCorrelationConstantBuffer) {
   {
     // TODO(bugs.webrtc.org/8948): Add when the issue is fixed.
     // FloatingPointExceptionObserver fpe_observer;
-    std::unique_ptr<RealFourier> fft =
-        RealFourier::Create(kAutoCorrelationFftOrder);
+    const RealFft fft(size_t{1} << kAutoCorrelationFftOrder);
     ComputePitchAutoCorrelation(pitch_buf_decimated, kMaxPitch12kHz,
-                                computed_output, fft.get());
+                                computed_output, &fft);
   }
 
   // The expected output is constantly the length of the fixed 'x'
@@ -33,28 +33,17 @@ void RemoveDcLevel(rtc::ArrayView<float> x) {
   }
 }
 
-void PowerSpectrum(const OouraFft* ooura_fft,
+void PowerSpectrum(const RealFft* fft,
                    rtc::ArrayView<const float> x,
                    rtc::ArrayView<float> spectrum) {
   RTC_DCHECK_EQ(65, spectrum.size());
   RTC_DCHECK_EQ(128, x.size());
-  float X[128];
-  std::copy(x.data(), x.data() + x.size(), X);
-  ooura_fft->Fft(X);
-
-  float* X_p = X;
-  RTC_DCHECK_EQ(X_p, &X[0]);
-  spectrum[0] = (*X_p) * (*X_p);
-  ++X_p;
-  RTC_DCHECK_EQ(X_p, &X[1]);
-  spectrum[64] = (*X_p) * (*X_p);
-  for (int k = 1; k < 64; ++k) {
-    ++X_p;
-    RTC_DCHECK_EQ(X_p, &X[2 * k]);
-    spectrum[k] = (*X_p) * (*X_p);
-    ++X_p;
-    RTC_DCHECK_EQ(X_p, &X[2 * k + 1]);
-    spectrum[k] += (*X_p) * (*X_p);
+  float X_re[65];
+  float X_im[65];
+  fft->Forward(x, X_re, X_im);
+
+  for (int k = 0; k < 65; ++k) {
+    spectrum[k] = X_re[k] * X_re[k] + X_im[k] * X_im[k];
   }
 }
 
@@ -109,7 +98,8 @@ void SignalClassifier::FrameExtender::ExtendFrame(
 SignalClassifier::SignalClassifier(ApmDataDumper* data_dumper)
     : data_dumper_(data_dumper),
       down_sampler_(data_dumper_),
-      noise_spectrum_estimator_(data_dumper_) {
+      noise_spectrum_estimator_(data_dumper_),
+      fft_(128) {
   Initialize(48000);
 }
 SignalClassifier::~SignalClassifier() {}
@@ -135,7 +125,7 @@ SignalClassifier::SignalType SignalClassifier::Analyze(
   frame_extender_->ExtendFrame(downsampled_frame, extended_frame);
   RemoveDcLevel(extended_frame);
   float signal_spectrum[65];
-  PowerSpectrum(&ooura_fft_, extended_frame, signal_spectrum);
+  PowerSpectrum(&fft_, extended_frame, signal_spectrum);
 
   // Classify the signal based on the estimate of the noise spectrum and the
   // signal spectrum estimate.
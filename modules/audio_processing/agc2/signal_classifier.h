@@ -17,7 +17,7 @@
 #include "api/array_view.h"
 #include "modules/audio_processing/agc2/down_sampler.h"
 #include "modules/audio_processing/agc2/noise_spectrum_estimator.h"
-#include "modules/audio_processing/utility/ooura_fft.h"
+#include "modules/audio_processing/utility/real_fft.h"
 #include "rtc_base/constructormagic.h"
 
 namespace webrtc {
@@ -58,7 +58,7 @@ class SignalClassifier {
   int initialization_frames_left_;
   int consistent_classification_counter_;
   SignalType last_signal_type_;
-  const OouraFft ooura_fft_;
+  const RealFft fft_;
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(SignalClassifier);
 };
 
@@ -16,12 +16,15 @@
 #include <vector>
 
 #include "api/array_view.h"
+#include "api/audio/echo_canceller3_factory.h"
+#include "modules/audio_processing/aec3/aec3_common.h"
 #include "modules/audio_processing/test/test_utils.h"
 #include "rtc_base/atomicops.h"
 #include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/random.h"
 #include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
 #include "system_wrappers/include/event_wrapper.h"
 #include "test/gtest.h"
 #include "test/testsupport/perf_test.h"
@@ -43,9 +46,53 @@ enum class SettingsType {
   kDefaultApmMobile,
   kAllSubmodulesTurnedOff,
   kDefaultApmDesktopWithoutDelayAgnostic,
-  kDefaultApmDesktopWithoutExtendedFilter
+  kDefaultApmDesktopWithoutExtendedFilter,
+  kDefaultApmDesktopAndEchoCanceller3
 };
 
+// The CPU feature detection of the platform.
+const WebRtc_CPUInfo kGetCpuInfo = WebRtc_GetCPUInfo;
+
+// CPU feature detection that hides the features that AVX2 code needs.
+int GetCpuInfoWithoutAvx2(CPUFeature feature) {
+  return feature == kAVX2 || feature == kFMA3 ? 0 : kGetCpuInfo(feature);
+}
+
+// Returns a CPU feature detection for which DetectOptimization() selects
+// |optimization|, if the CPU supports it.
+WebRtc_CPUInfo CpuInfoForAec3Optimization(Aec3Optimization optimization) {
+  switch (optimization) {
+    case Aec3Optimization::kNone:
+      return WebRtc_GetCPUInfoNoASM;
+    case Aec3Optimization::kSse2:
+      return GetCpuInfoWithoutAvx2;
+    default:
+      return kGetCpuInfo;
+  }
+}
+
+// Returns whether AEC3 can be made to use |optimization| on this platform.
+bool Aec3OptimizationAvailable(Aec3Optimization optimization) {
+  WebRtc_GetCPUInfo = CpuInfoForAec3Optimization(optimization);
+  const bool available = DetectOptimization() == optimization;
+  WebRtc_GetCPUInfo = kGetCpuInfo;
+  return available;
+}
+
+std::string Aec3OptimizationName(Aec3Optimization optimization) {
+  switch (optimization) {
+    case Aec3Optimization::kNone:
+      return "NoOptimization";
+    case Aec3Optimization::kSse2:
+      return "Sse2";
+    case Aec3Optimization::kAvx2:
+      return "Avx2";
+    case Aec3Optimization::kNeon:
+      return "Neon";
+  }
+  return "";
+}
+
 // Variables related to the audio data and formats.
 struct AudioFrameData {
   explicit AudioFrameData(size_t max_frame_size) {
@@ -75,6 +122,13 @@ struct SimulationConfig {
       : sample_rate_hz(sample_rate_hz),
         simulation_settings(simulation_settings) {}
 
+  SimulationConfig(int sample_rate_hz,
+                   SettingsType simulation_settings,
+                   Aec3Optimization aec3_optimization)
+      : sample_rate_hz(sample_rate_hz),
+        simulation_settings(simulation_settings),
+        aec3_optimization(aec3_optimization) {}
+
   static std::vector<SimulationConfig> GenerateSimulationConfigs() {
     std::vector<SimulationConfig> simulation_configs;
 #ifndef WEBRTC_ANDROID
@@ -90,6 +144,21 @@ struct SimulationConfig {
         simulation_configs.push_back(SimulationConfig(sample_rate, settings));
       }
     }
+
+    // Times AEC3 with each of the optimizations that the CPU supports.
+    const Aec3Optimization aec3_optimizations[] = {
+        Aec3Optimization::kNone, Aec3Optimization::kSse2,
+        Aec3Optimization::kAvx2, Aec3Optimization::kNeon};
+
+    for (auto sample_rate : desktop_sample_rates) {
+      for (auto optimization : aec3_optimizations) {
+        if (Aec3OptimizationAvailable(optimization)) {
+          simulation_configs.push_back(SimulationConfig(
+              sample_rate, SettingsType::kDefaultApmDesktopAndEchoCanceller3,
+              optimization));
+        }
+      }
+    }
 #endif
 
     const SettingsType mobile_settings[] = {SettingsType::kDefaultApmMobile};
@@ -123,12 +192,18 @@ struct SimulationConfig {
       case SettingsType::kDefaultApmDesktopWithoutExtendedFilter:
         description = "DefaultApmDesktopWithoutExtendedFilter";
         break;
+      case SettingsType::kDefaultApmDesktopAndEchoCanceller3:
+        description = "DefaultApmDesktopAndEchoCanceller3_" +
+                      Aec3OptimizationName(aec3_optimization);
+        break;
     }
     return description;
   }
 
   int sample_rate_hz = 16000;
   SettingsType simulation_settings = SettingsType::kDefaultApmDesktop;
+  // The AEC3 optimization to use with kDefaultApmDesktopAndEchoCanceller3.
+  Aec3Optimization aec3_optimization = Aec3Optimization::kNone;
 };
 
 // Handler for the frame counters.
@@ -433,7 +508,10 @@ class CallSimulator : public ::testing::TestWithParam<SimulationConfig> {
   static const int32_t kTestTimeout = 3 * 10 * kMinNumFramesToProcess;
 
   // ::testing::TestWithParam<> implementation.
-  void TearDown() override { StopThreads(); }
+  void TearDown() override {
+    StopThreads();
+    WebRtc_GetCPUInfo = kGetCpuInfo;
+  }
 
   // Stop all running threads.
   void StopThreads() {
@@ -443,8 +521,9 @@ class CallSimulator : public ::testing::TestWithParam<SimulationConfig> {
 
   // Simulator and APM setup.
   void SetUp() override {
-    // Lambda function for setting the default APM runtime settings for desktop.
-    auto set_default_desktop_apm_runtime_settings = [](AudioProcessing* apm) {
+    // Lambda function for setting the default APM runtime settings for desktop,
+    // except for the echo canceller.
+    auto set_default_desktop_apm_submodule_settings = [](AudioProcessing* apm) {
       ASSERT_EQ(apm->kNoError, apm->level_estimator()->Enable(true));
       ASSERT_EQ(apm->kNoError, apm->gain_control()->Enable(true));
       ASSERT_EQ(apm->kNoError,
@@ -452,6 +531,11 @@ class CallSimulator : public ::testing::TestWithParam<SimulationConfig> {
       ASSERT_EQ(apm->kNoError, apm->gain_control()->Enable(true));
       ASSERT_EQ(apm->kNoError, apm->noise_suppression()->Enable(true));
       ASSERT_EQ(apm->kNoError, apm->voice_detection()->Enable(true));
+    };
+
+    // Lambda function for setting the default APM runtime settings for desktop.
+    auto set_default_desktop_apm_runtime_settings = [&](AudioProcessing* apm) {
+      set_default_desktop_apm_submodule_settings(apm);
       AudioProcessing::Config apm_config = apm->GetConfig();
       apm_config.echo_canceller.enabled = true;
       apm_config.echo_canceller.mobile_mode = false;
@@ -537,6 +621,22 @@ class CallSimulator : public ::testing::TestWithParam<SimulationConfig> {
         apm_->SetExtraOptions(config);
         break;
       }
+      case SettingsType::kDefaultApmDesktopAndEchoCanceller3: {
+        // AEC3 detects the optimization whenever APM reinitializes, so the
+        // detection is kept in place until the end of the test.
+        WebRtc_GetCPUInfo =
+            CpuInfoForAec3Optimization(simulation_config_.aec3_optimization);
+        apm_.reset(AudioProcessingBuilder()
+                       .SetEchoControlFactory(
+                           std::unique_ptr<EchoControlFactory>(
+                               new EchoCanceller3Factory()))
+                       .Create());
+        ASSERT_TRUE(!!apm_);
+        // AEC3 replaces AEC2, so AEC2 is never enabled and the timings only
+        // cover the AEC3 kernels.
+        set_default_desktop_apm_submodule_settings(apm_.get());
+        break;
+      }
     }
 
     render_thread_state_.reset(new TimedThreadApiProcessor(
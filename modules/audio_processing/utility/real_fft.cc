@@ -0,0 +1,621 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/utility/real_fft.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/system/arch.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
+namespace webrtc {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Sines and cosines of the angles used by the radix-3 and radix-5 butterflies,
+// in degrees.
+constexpr float kSin60 = 0.866025403784438647f;
+constexpr float kCos72 = 0.309016994374947424f;
+constexpr float kSin72 = 0.951056516295153572f;
+constexpr float kCos144 = -0.809016994374947424f;
+constexpr float kSin144 = 0.587785252292473129f;
+
+// Operations on four floats in plain C++, for the platforms without SIMD.
+struct GenericOps {
+  struct Vec {
+    float v[4];
+  };
+
+  static Vec Load(const float* src) {
+    return {{src[0], src[1], src[2], src[3]}};
+  }
+  static void Store(float* dst, const Vec& a) {
+    std::copy(a.v, a.v + 4, dst);
+  }
+  static Vec Set(float a) { return {{a, a, a, a}}; }
+  static Vec Add(const Vec& a, const Vec& b) {
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2],
+             a.v[3] + b.v[3]}};
+  }
+  static Vec Sub(const Vec& a, const Vec& b) {
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2],
+             a.v[3] - b.v[3]}};
+  }
+  static Vec Mul(const Vec& a, const Vec& b) {
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2],
+             a.v[3] * b.v[3]}};
+  }
+  // Returns the elements of |a| in reverse order.
+  static Vec Reverse(const Vec& a) {
+    return {{a.v[3], a.v[2], a.v[1], a.v[0]}};
+  }
+  // Transposes the 4x4 matrix with the rows |r0|, ..., |r3|.
+  static void Transpose(Vec* r0, Vec* r1, Vec* r2, Vec* r3) {
+    Vec* rows[4] = {r0, r1, r2, r3};
+    for (int i = 0; i < 4; ++i) {
+      for (int j = i + 1; j < 4; ++j) {
+        std::swap(rows[i]->v[j], rows[j]->v[i]);
+      }
+    }
+  }
+  // Splits the eight consecutive values in |a| and |b| into the ones at even
+  // and at odd positions.
+  static void Deinterleave(const Vec& a, const Vec& b, Vec* even, Vec* odd) {
+    *even = {{a.v[0], a.v[2], b.v[0], b.v[2]}};
+    *odd = {{a.v[1], a.v[3], b.v[1], b.v[3]}};
+  }
+  // Inverse of Deinterleave().
+  static void Interleave(const Vec& even, const Vec& odd, Vec* a, Vec* b) {
+    *a = {{even.v[0], odd.v[0], even.v[1], odd.v[1]}};
+    *b = {{even.v[2], odd.v[2], even.v[3], odd.v[3]}};
+  }
+};
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// The operations of GenericOps, with SSE2.
+struct Sse2Ops {
+  using Vec = __m128;
+
+  static Vec Load(const float* src) { return _mm_loadu_ps(src); }
+  static void Store(float* dst, Vec a) { _mm_storeu_ps(dst, a); }
+  static Vec Set(float a) { return _mm_set1_ps(a); }
+  static Vec Add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+  static Vec Sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+  static Vec Mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+  static Vec Reverse(Vec a) {
+    return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 1, 2, 3));
+  }
+  static void Transpose(Vec* r0, Vec* r1, Vec* r2, Vec* r3) {
+    _MM_TRANSPOSE4_PS(*r0, *r1, *r2, *r3);
+  }
+  static void Deinterleave(Vec a, Vec b, Vec* even, Vec* odd) {
+    *even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    *odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+  }
+  static void Interleave(Vec even, Vec odd, Vec* a, Vec* b) {
+    *a = _mm_unpacklo_ps(even, odd);
+    *b = _mm_unpackhi_ps(even, odd);
+  }
+};
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+// The operations of GenericOps, with NEON.
+struct NeonOps {
+  using Vec = float32x4_t;
+
+  static Vec Load(const float* src) { return vld1q_f32(src); }
+  static void Store(float* dst, Vec a) { vst1q_f32(dst, a); }
+  static Vec Set(float a) { return vdupq_n_f32(a); }
+  static Vec Add(Vec a, Vec b) { return vaddq_f32(a, b); }
+  static Vec Sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+  static Vec Mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+  static Vec Reverse(Vec a) {
+    const float32x4_t swapped_pairs = vrev64q_f32(a);
+    return vcombine_f32(vget_high_f32(swapped_pairs),
+                        vget_low_f32(swapped_pairs));
+  }
+  static void Transpose(Vec* r0, Vec* r1, Vec* r2, Vec* r3) {
+    const float32x4x2_t r01 = vtrnq_f32(*r0, *r1);
+    const float32x4x2_t r23 = vtrnq_f32(*r2, *r3);
+    *r0 = vcombine_f32(vget_low_f32(r01.val[0]), vget_low_f32(r23.val[0]));
+    *r1 = vcombine_f32(vget_low_f32(r01.val[1]), vget_low_f32(r23.val[1]));
+    *r2 = vcombine_f32(vget_high_f32(r01.val[0]), vget_high_f32(r23.val[0]));
+    *r3 = vcombine_f32(vget_high_f32(r01.val[1]), vget_high_f32(r23.val[1]));
+  }
+  static void Deinterleave(Vec a, Vec b, Vec* even, Vec* odd) {
+    const float32x4x2_t unzipped = vuzpq_f32(a, b);
+    *even = unzipped.val[0];
+    *odd = unzipped.val[1];
+  }
+  static void Interleave(Vec even, Vec odd, Vec* a, Vec* b) {
+    const float32x4x2_t zipped = vzipq_f32(even, odd);
+    *a = zipped.val[0];
+    *b = zipped.val[1];
+  }
+};
+#endif
+
+// Replaces the kRadix values in |re| and |im| by their DFT.
+template <typename Ops, int kRadix>
+struct Butterfly;
+
+template <typename Ops>
+struct Butterfly<Ops, 2> {
+  using Vec = typename Ops::Vec;
+  static void Compute(Vec* re, Vec* im) {
+    const Vec a_re = re[0];
+    const Vec a_im = im[0];
+    re[0] = Ops::Add(a_re, re[1]);
+    im[0] = Ops::Add(a_im, im[1]);
+    re[1] = Ops::Sub(a_re, re[1]);
+    im[1] = Ops::Sub(a_im, im[1]);
+  }
+};
+
+template <typename Ops>
+struct Butterfly<Ops, 3> {
+  using Vec = typename Ops::Vec;
+  static void Compute(Vec* re, Vec* im) {
+    const Vec half = Ops::Set(0.5f);
+    const Vec sin1 = Ops::Set(kSin60);
+    const Vec sum_re = Ops::Add(re[1], re[2]);
+    const Vec sum_im = Ops::Add(im[1], im[2]);
+    const Vec diff_re = Ops::Mul(sin1, Ops::Sub(re[1], re[2]));
+    const Vec diff_im = Ops::Mul(sin1, Ops::Sub(im[1], im[2]));
+    const Vec mid_re = Ops::Sub(re[0], Ops::Mul(half, sum_re));
+    const Vec mid_im = Ops::Sub(im[0], Ops::Mul(half, sum_im));
+    re[0] = Ops::Add(re[0], sum_re);
+    im[0] = Ops::Add(im[0], sum_im);
+    re[1] = Ops::Add(mid_re, diff_im);
+    im[1] = Ops::Sub(mid_im, diff_re);
+    re[2] = Ops::Sub(mid_re, diff_im);
+    im[2] = Ops::Add(mid_im, diff_re);
+  }
+};
+
+template <typename Ops>
+struct Butterfly<Ops, 4> {
+  using Vec = typename Ops::Vec;
+  static void Compute(Vec* re, Vec* im) {
+    const Vec t0_re = Ops::Add(re[0], re[2]);
+    const Vec t0_im = Ops::Add(im[0], im[2]);
+    const Vec t1_re = Ops::Sub(re[0], re[2]);
+    const Vec t1_im = Ops::Sub(im[0], im[2]);
+    const Vec t2_re = Ops::Add(re[1], re[3]);
+    const Vec t2_im = Ops::Add(im[1], im[3]);
+    const Vec t3_re = Ops::Sub(re[1], re[3]);
+    const Vec t3_im = Ops::Sub(im[1], im[3]);
+    re[0] = Ops::Add(t0_re, t2_re);
+    im[0] = Ops::Add(t0_im, t2_im);
+    re[1] = Ops::Add(t1_re, t3_im);
+    im[1] = Ops::Sub(t1_im, t3_re);
+    re[2] = Ops::Sub(t0_re, t2_re);
+    im[2] = Ops::Sub(t0_im, t2_im);
+    re[3] = Ops::Sub(t1_re, t3_im);
+    im[3] = Ops::Add(t1_im, t3_re);
+  }
+};
+
+template <typename Ops>
+struct Butterfly<Ops, 5> {
+  using Vec = typename Ops::Vec;
+  static void Compute(Vec* re, Vec* im) {
+    const Vec cos1 = Ops::Set(kCos72);
+    const Vec cos2 = Ops::Set(kCos144);
+    const Vec sin1 = Ops::Set(kSin72);
+    const Vec sin2 = Ops::Set(kSin144);
+    const Vec t1_re = Ops::Add(re[1], re[4]);
+    const Vec t1_im = Ops::Add(im[1], im[4]);
+    const Vec t2_re = Ops::Add(re[2], re[3]);
+    const Vec t2_im = Ops::Add(im[2], im[3]);
+    const Vec t3_re = Ops::Sub(re[1], re[4]);
+    const Vec t3_im = Ops::Sub(im[1], im[4]);
+    const Vec t4_re = Ops::Sub(re[2], re[3]);
+    const Vec t4_im = Ops::Sub(im[2], im[3]);
+    const Vec m1_re = Ops::Add(
+        re[0], Ops::Add(Ops::Mul(cos1, t1_re), Ops::Mul(cos2, t2_re)));
+    const Vec m1_im = Ops::Add(
+        im[0], Ops::Add(Ops::Mul(cos1, t1_im), Ops::Mul(cos2, t2_im)));
+    const Vec m2_re = Ops::Add(
+        re[0], Ops::Add(Ops::Mul(cos2, t1_re), Ops::Mul(cos1, t2_re)));
+    const Vec m2_im = Ops::Add(
+        im[0], Ops::Add(Ops::Mul(cos2, t1_im), Ops::Mul(cos1, t2_im)));
+    const Vec n1_re = Ops::Add(Ops::Mul(sin1, t3_re), Ops::Mul(sin2, t4_re));
+    const Vec n1_im = Ops::Add(Ops::Mul(sin1, t3_im), Ops::Mul(sin2, t4_im));
+    const Vec n2_re = Ops::Sub(Ops::Mul(sin2, t3_re), Ops::Mul(sin1, t4_re));
+    const Vec n2_im = Ops::Sub(Ops::Mul(sin2, t3_im), Ops::Mul(sin1, t4_im));
+    re[0] = Ops::Add(re[0], Ops::Add(t1_re, t2_re));
+    im[0] = Ops::Add(im[0], Ops::Add(t1_im, t2_im));
+    re[1] = Ops::Add(m1_re, n1_im);
+    im[1] = Ops::Sub(m1_im, n1_re);
+    re[2] = Ops::Add(m2_re, n2_im);
+    im[2] = Ops::Sub(m2_im, n2_re);
+    re[3] = Ops::Sub(m2_re, n2_im);
+    im[3] = Ops::Add(m2_im, n2_re);
+    re[4] = Ops::Sub(m1_re, n1_im);
+    im[4] = Ops::Add(m1_im, n1_re);
+  }
+};
+
+// Multiplies |re| and |im| by the twiddle factor |w_re| + i * |w_im|.
+template <typename Ops>
+void MultiplyTwiddle(typename Ops::Vec w_re,
+                     typename Ops::Vec w_im,
+                     typename Ops::Vec* re,
+                     typename Ops::Vec* im) {
+  const typename Ops::Vec product_re =
+      Ops::Sub(Ops::Mul(*re, w_re), Ops::Mul(*im, w_im));
+  *im = Ops::Add(Ops::Mul(*re, w_im), Ops::Mul(*im, w_re));
+  *re = product_re;
+}
+
+// First radix-4 pass of the complex FFT, where the stride is one. Reads the
+// input with interleaved real and imaginary parts, computes the butterflies of
+// four consecutive groups at a time and transposes the results to write them
+// in order.
+template <typename Ops>
+void FirstRadix4Pass(size_t num_groups,
+                     const float* twiddles_re,
+                     const float* twiddles_im,
+                     const float* x,
+                     float* y_re,
+                     float* y_im) {
+  using Vec = typename Ops::Vec;
+  const size_t m = num_groups;
+  RTC_DCHECK_EQ(0, m % 4);
+  for (size_t p = 0; p < m; p += 4) {
+    Vec re[4];
+    Vec im[4];
+    Ops::Deinterleave(Ops::Load(&x[2 * p]), Ops::Load(&x[2 * p + 4]), &re[0],
+                      &im[0]);
+    Ops::Deinterleave(Ops::Load(&x[2 * (p + m)]),
+                      Ops::Load(&x[2 * (p + m) + 4]), &re[1], &im[1]);
+    Ops::Deinterleave(Ops::Load(&x[2 * (p + 2 * m)]),
+                      Ops::Load(&x[2 * (p + 2 * m) + 4]), &re[2], &im[2]);
+    Ops::Deinterleave(Ops::Load(&x[2 * (p + 3 * m)]),
+                      Ops::Load(&x[2 * (p + 3 * m) + 4]), &re[3], &im[3]);
+    Butterfly<Ops, 4>::Compute(re, im);
+    MultiplyTwiddle<Ops>(Ops::Load(&twiddles_re[p]),
+                         Ops::Load(&twiddles_im[p]), &re[1], &im[1]);
+    MultiplyTwiddle<Ops>(Ops::Load(&twiddles_re[m + p]),
+                         Ops::Load(&twiddles_im[m + p]), &re[2], &im[2]);
+    MultiplyTwiddle<Ops>(Ops::Load(&twiddles_re[2 * m + p]),
+                         Ops::Load(&twiddles_im[2 * m + p]), &re[3], &im[3]);
+    Ops::Transpose(&re[0], &re[1], &re[2], &re[3]);
+    Ops::Transpose(&im[0], &im[1], &im[2], &im[3]);
+    float* out_re = &y_re[4 * p];
+    float* out_im = &y_im[4 * p];
+    Ops::Store(&out_re[0], re[0]);
+    Ops::Store(&out_im[0], im[0]);
+    Ops::Store(&out_re[4], re[1]);
+    Ops::Store(&out_im[4], im[1]);
+    Ops::Store(&out_re[8], re[2]);
+    Ops::Store(&out_im[8], im[2]);
+    Ops::Store(&out_re[12], re[3]);
+    Ops::Store(&out_im[12], im[3]);
+  }
+}
+
+// Pass of the complex FFT with a stride that is a multiple of four, where the
+// butterflies of each group are computed for four sequences at a time.
+template <typename Ops, int kRadix>
+void RadixPass(size_t stride,
+               size_t num_groups,
+               const float* twiddles_re,
+               const float* twiddles_im,
+               const float* x_re,
+               const float* x_im,
+               float* y_re,
+               float* y_im) {
+  using Vec = typename Ops::Vec;
+  const size_t s = stride;
+  const size_t m = num_groups;
+  RTC_DCHECK_EQ(0, s % 4);
+  for (size_t p = 0; p < m; ++p) {
+    Vec w_re[kRadix];
+    Vec w_im[kRadix];
+    for (size_t j = 1; j < kRadix; ++j) {
+      w_re[j] = Ops::Set(twiddles_re[(j - 1) * m + p]);
+      w_im[j] = Ops::Set(twiddles_im[(j - 1) * m + p]);
+    }
+    const float* group_re = &x_re[s * p];
+    const float* group_im = &x_im[s * p];
+    float* out_re = &y_re[s * kRadix * p];
+    float* out_im = &y_im[s * kRadix * p];
+    for (size_t q = 0; q < s; q += 4) {
+      Vec re[kRadix];
+      Vec im[kRadix];
+      for (size_t t = 0; t < kRadix; ++t) {
+        re[t] = Ops::Load(&group_re[q + t * s * m]);
+        im[t] = Ops::Load(&group_im[q + t * s * m]);
+      }
+      Butterfly<Ops, kRadix>::Compute(re, im);
+      // The twiddle factors of the first group are all one.
+      if (p > 0) {
+        for (size_t j = 1; j < kRadix; ++j) {
+          MultiplyTwiddle<Ops>(w_re[j], w_im[j], &re[j], &im[j]);
+        }
+      }
+      for (size_t j = 0; j < kRadix; ++j) {
+        Ops::Store(&out_re[q + j * s], re[j]);
+        Ops::Store(&out_im[q + j * s], im[j]);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+constexpr size_t RealFft::kMaxFftSize;
+
+bool RealFft::IsSupportedSize(size_t fft_size) {
+  if (fft_size == 0 || fft_size % 32 != 0 || fft_size > kMaxFftSize) {
+    return false;
+  }
+  for (size_t factor : {2, 3, 5}) {
+    while (fft_size % factor == 0) {
+      fft_size /= factor;
+    }
+  }
+  return fft_size == 1;
+}
+
+RealFft::RealFft(size_t fft_size) : fft_size_(fft_size) {
+  RTC_CHECK(IsSupportedSize(fft_size)) << "Unsupported FFT size: " << fft_size;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  use_sse2_ = (WebRtc_GetCPUInfo(kSSE2) != 0);
+#else
+  use_sse2_ = false;
+#endif
+
+  // The first pass is radix-4, which the supported sizes allow, followed by as
+  // many radix-4 passes as possible.
+  const size_t complex_fft_size = fft_size / 2;
+  std::vector<int> radices = {4};
+  size_t remaining_size = complex_fft_size / 4;
+  for (int radix : {4, 2, 3, 5}) {
+    while (remaining_size % radix == 0) {
+      radices.push_back(radix);
+      remaining_size /= radix;
+    }
+  }
+  RTC_DCHECK_EQ(1, remaining_size);
+
+  size_t size = complex_fft_size;
+  size_t stride = 1;
+  for (int radix : radices) {
+    const size_t num_groups = size / radix;
+    passes_.push_back({radix, stride, num_groups, twiddles_re_.size()});
+    for (int j = 1; j < radix; ++j) {
+      for (size_t p = 0; p < num_groups; ++p) {
+        const double angle = -2.0 * kPi * j * p / size;
+        twiddles_re_.push_back(static_cast<float>(std::cos(angle)));
+        twiddles_im_.push_back(static_cast<float>(std::sin(angle)));
+      }
+    }
+    size = num_groups;
+    stride *= radix;
+  }
+
+  split_cos_.resize(complex_fft_size);
+  split_sin_.resize(complex_fft_size);
+  for (size_t k = 0; k < complex_fft_size; ++k) {
+    const double angle = 2.0 * kPi * k / fft_size;
+    split_cos_[k] = static_cast<float>(0.5 * std::cos(angle));
+    split_sin_[k] = static_cast<float>(0.5 * std::sin(angle));
+  }
+}
+
+RealFft::~RealFft() = default;
+
+void RealFft::Forward(rtc::ArrayView<const float> x,
+                      rtc::ArrayView<float> re,
+                      rtc::ArrayView<float> im) const {
+  RTC_DCHECK_EQ(fft_size_, x.size());
+  RTC_DCHECK_EQ(num_bins(), re.size());
+  RTC_DCHECK_EQ(num_bins(), im.size());
+#if defined(WEBRTC_HAS_NEON)
+  ForwardWithOps<NeonOps>(x.data(), re.data(), im.data());
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  if (use_sse2_) {
+    ForwardWithOps<Sse2Ops>(x.data(), re.data(), im.data());
+  } else {
+    ForwardWithOps<GenericOps>(x.data(), re.data(), im.data());
+  }
+#else
+  ForwardWithOps<GenericOps>(x.data(), re.data(), im.data());
+#endif
+}
+
+void RealFft::Inverse(rtc::ArrayView<const float> re,
+                      rtc::ArrayView<const float> im,
+                      rtc::ArrayView<float> x) const {
+  RTC_DCHECK_EQ(num_bins(), re.size());
+  RTC_DCHECK_EQ(num_bins(), im.size());
+  RTC_DCHECK_EQ(fft_size_, x.size());
+#if defined(WEBRTC_HAS_NEON)
+  InverseWithOps<NeonOps>(re.data(), im.data(), x.data());
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  if (use_sse2_) {
+    InverseWithOps<Sse2Ops>(re.data(), im.data(), x.data());
+  } else {
+    InverseWithOps<GenericOps>(re.data(), im.data(), x.data());
+  }
+#else
+  InverseWithOps<GenericOps>(re.data(), im.data(), x.data());
+#endif
+}
+
+template <typename Ops>
+void RealFft::ComplexFft(const float* z,
+                         float* buffer,
+                         float** re,
+                         float** im) const {
+  const size_t m = fft_size_ / 2;
+  float* x_re = &buffer[0];
+  float* x_im = &buffer[m];
+  float* y_re = &buffer[2 * m];
+  float* y_im = &buffer[3 * m];
+  RTC_DCHECK(!passes_.empty());
+  RTC_DCHECK_EQ(1, passes_[0].stride);
+  RTC_DCHECK_EQ(4, passes_[0].radix);
+  FirstRadix4Pass<Ops>(passes_[0].num_groups, &twiddles_re_[0],
+                       &twiddles_im_[0], z, x_re, x_im);
+  for (size_t i = 1; i < passes_.size(); ++i) {
+    const Pass& pass = passes_[i];
+    const float* twiddles_re = &twiddles_re_[pass.twiddles_offset];
+    const float* twiddles_im = &twiddles_im_[pass.twiddles_offset];
+    switch (pass.radix) {
+      case 2:
+        RadixPass<Ops, 2>(pass.stride, pass.num_groups, twiddles_re,
+                          twiddles_im, x_re, x_im, y_re, y_im);
+        break;
+      case 3:
+        RadixPass<Ops, 3>(pass.stride, pass.num_groups, twiddles_re,
+                          twiddles_im, x_re, x_im, y_re, y_im);
+        break;
+      case 4:
+        RadixPass<Ops, 4>(pass.stride, pass.num_groups, twiddles_re,
+                          twiddles_im, x_re, x_im, y_re, y_im);
+        break;
+      case 5:
+        RadixPass<Ops, 5>(pass.stride, pass.num_groups, twiddles_re,
+                          twiddles_im, x_re, x_im, y_re, y_im);
+        break;
+      default:
+        RTC_NOTREACHED();
+    }
+    std::swap(x_re, y_re);
+    std::swap(x_im, y_im);
+  }
+  *re = x_re;
+  *im = x_im;
+}
+
+// The even and odd samples are transformed as the real and imaginary parts of
+// a complex signal Z of half the length. The spectrum of the real signal is
+// then X[k] = (Z[k] + Z*[M - k]) / 2 - i * W^k * (Z[k] - Z*[M - k]) / 2, where
+// M is the length of Z and W = exp(-2 * pi * i / fft_size()).
+template <typename Ops>
+void RealFft::ForwardWithOps(const float* x, float* re, float* im) const {
+  using Vec = typename Ops::Vec;
+  const size_t m = fft_size_ / 2;
+  float buffer[2 * kMaxFftSize];
+  float* z_re;
+  float* z_im;
+  ComplexFft<Ops>(x, buffer, &z_re, &z_im);
+
+  re[0] = z_re[0] + z_im[0];
+  im[0] = 0.f;
+  re[m] = z_re[0] - z_im[0];
+  im[m] = 0.f;
+  const Vec kHalf = Ops::Set(0.5f);
+  size_t k = 1;
+  for (; k + 4 <= m; k += 4) {
+    const Vec a_re = Ops::Load(&z_re[k]);
+    const Vec a_im = Ops::Load(&z_im[k]);
+    const Vec b_re = Ops::Reverse(Ops::Load(&z_re[m - k - 3]));
+    const Vec b_im = Ops::Reverse(Ops::Load(&z_im[m - k - 3]));
+    const Vec c = Ops::Load(&split_cos_[k]);
+    const Vec s = Ops::Load(&split_sin_[k]);
+    const Vec sum_re = Ops::Add(a_re, b_re);
+    const Vec diff_re = Ops::Sub(a_re, b_re);
+    const Vec sum_im = Ops::Add(a_im, b_im);
+    const Vec diff_im = Ops::Sub(a_im, b_im);
+    Ops::Store(&re[k], Ops::Sub(Ops::Add(Ops::Mul(kHalf, sum_re),
+                                         Ops::Mul(c, sum_im)),
+                                Ops::Mul(s, diff_re)));
+    Ops::Store(&im[k], Ops::Sub(Ops::Sub(Ops::Mul(kHalf, diff_im),
+                                         Ops::Mul(c, diff_re)),
+                                Ops::Mul(s, sum_im)));
+  }
+  for (; k < m; ++k) {
+    const float sum_re = z_re[k] + z_re[m - k];
+    const float diff_re = z_re[k] - z_re[m - k];
+    const float sum_im = z_im[k] + z_im[m - k];
+    const float diff_im = z_im[k] - z_im[m - k];
+    re[k] = 0.5f * sum_re + split_cos_[k] * sum_im - split_sin_[k] * diff_re;
+    im[k] = 0.5f * diff_im - split_cos_[k] * diff_re - split_sin_[k] * sum_im;
+  }
+}
+
+// Inverts the steps of ForwardWithOps(). The inverse complex FFT is computed
+// as a forward one, with the real and imaginary parts swapped at its input and
+// output.
+template <typename Ops>
+void RealFft::InverseWithOps(const float* re, const float* im, float* x) const {
+  using Vec = typename Ops::Vec;
+  const size_t m = fft_size_ / 2;
+  // Z with swapped real and imaginary parts, interleaved.
+  float z[kMaxFftSize];
+  z[0] = re[0] - re[m];
+  z[1] = re[0] + re[m];
+  size_t k = 1;
+  for (; k + 4 <= m; k += 4) {
+    const Vec a_re = Ops::Load(&re[k]);
+    const Vec a_im = Ops::Load(&im[k]);
+    const Vec b_re = Ops::Reverse(Ops::Load(&re[m - k - 3]));
+    const Vec b_im = Ops::Reverse(Ops::Load(&im[m - k - 3]));
+    const Vec c = Ops::Load(&split_cos_[k]);
+    const Vec s = Ops::Load(&split_sin_[k]);
+    const Vec c2 = Ops::Add(c, c);
+    const Vec s2 = Ops::Add(s, s);
+    const Vec sum_re = Ops::Add(a_re, b_re);
+    const Vec diff_re = Ops::Sub(a_re, b_re);
+    const Vec sum_im = Ops::Add(a_im, b_im);
+    const Vec diff_im = Ops::Sub(a_im, b_im);
+    const Vec z_re = Ops::Sub(Ops::Sub(sum_re, Ops::Mul(s2, diff_re)),
+                              Ops::Mul(c2, sum_im));
+    const Vec z_im = Ops::Sub(Ops::Add(diff_im, Ops::Mul(c2, diff_re)),
+                              Ops::Mul(s2, sum_im));
+    Vec z_low;
+    Vec z_high;
+    Ops::Interleave(z_im, z_re, &z_low, &z_high);
+    Ops::Store(&z[2 * k], z_low);
+    Ops::Store(&z[2 * k + 4], z_high);
+  }
+  for (; k < m; ++k) {
+    const float sum_re = re[k] + re[m - k];
+    const float diff_re = re[k] - re[m - k];
+    const float sum_im = im[k] + im[m - k];
+    const float diff_im = im[k] - im[m - k];
+    const float c2 = 2.f * split_cos_[k];
+    const float s2 = 2.f * split_sin_[k];
+    z[2 * k] = diff_im + c2 * diff_re - s2 * sum_im;
+    z[2 * k + 1] = sum_re - s2 * diff_re - c2 * sum_im;
+  }
+
+  float buffer[2 * kMaxFftSize];
+  float* y_re;
+  float* y_im;
+  ComplexFft<Ops>(z, buffer, &y_re, &y_im);
+
+  for (size_t n = 0; n < m; n += 4) {
+    Vec x_low;
+    Vec x_high;
+    Ops::Interleave(Ops::Load(&y_im[n]), Ops::Load(&y_re[n]), &x_low,
+                    &x_high);
+    Ops::Store(&x[2 * n], x_low);
+    Ops::Store(&x[2 * n + 4], x_high);
+  }
+}
+
+}  // namespace webrtc
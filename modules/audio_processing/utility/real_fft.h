@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_UTILITY_REAL_FFT_H_
+#define MODULES_AUDIO_PROCESSING_UTILITY_REAL_FFT_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "api/array_view.h"
+
+namespace webrtc {
+
+// FFT of real signals, used by AGC2 and its RNN VAD. A transform of N samples
+// is computed as a complex FFT of N / 2 points, which is split in radix-4, -2,
+// -3 and -5 passes that process four values at a time. SSE2 or NEON is used
+// for this when available.
+class RealFft {
+ public:
+  // The longest supported transform.
+  static constexpr size_t kMaxFftSize = 1024;
+
+  // Returns true if transforms of |fft_size| samples are supported, which is
+  // the case for the multiples of 32 up to kMaxFftSize with no prime factors
+  // other than 2, 3 and 5 (e.g., 64, 128, 256, 480, 512 and 960).
+  static bool IsSupportedSize(size_t fft_size);
+
+  explicit RealFft(size_t fft_size);
+  RealFft(const RealFft&) = delete;
+  RealFft& operator=(const RealFft&) = delete;
+  ~RealFft();
+
+  size_t fft_size() const { return fft_size_; }
+  // Number of bins in the spectrum, from DC to the Nyquist frequency.
+  size_t num_bins() const { return fft_size_ / 2 + 1; }
+
+  // Computes X[k] = sum_n x[n] * exp(-2 * pi * i * k * n / fft_size()) for the
+  // num_bins() lowest bins and writes their real and imaginary parts to |re|
+  // and |im|.
+  void Forward(rtc::ArrayView<const float> x,
+               rtc::ArrayView<float> re,
+               rtc::ArrayView<float> im) const;
+
+  // Computes the inverse of Forward(), scaled by fft_size(). The imaginary
+  // parts of the DC and Nyquist bins are ignored.
+  void Inverse(rtc::ArrayView<const float> re,
+               rtc::ArrayView<const float> im,
+               rtc::ArrayView<float> x) const;
+
+ private:
+  // A pass of the complex FFT, which computes |num_groups| DFTs of |radix|
+  // points on each of |stride| interleaved sequences.
+  struct Pass {
+    int radix;
+    size_t stride;
+    size_t num_groups;
+    // Offset of the twiddle factors of the pass in |twiddles_re_| and
+    // |twiddles_im_|, stored as (radix - 1) rows of |num_groups| values.
+    size_t twiddles_offset;
+  };
+
+  // The transforms, for operations on four floats defined by |Ops|.
+  template <typename Ops>
+  void ForwardWithOps(const float* x, float* re, float* im) const;
+  template <typename Ops>
+  void InverseWithOps(const float* re, const float* im, float* x) const;
+  // Computes the complex FFT of the fft_size() / 2 values in |z|, which holds
+  // their real and imaginary parts interleaved. Uses the 2 * fft_size() values
+  // in |buffer| for the passes, and points |*re| and |*im| to the real and
+  // imaginary parts of the result in it.
+  template <typename Ops>
+  void ComplexFft(const float* z, float* buffer, float** re, float** im) const;
+
+  const size_t fft_size_;
+  bool use_sse2_;
+  std::vector<Pass> passes_;
+  std::vector<float> twiddles_re_;
+  std::vector<float> twiddles_im_;
+  // Halved cosine and sine of 2 * pi * k / fft_size() for k < fft_size() / 2,
+  // used to split the complex FFT into the spectrum of the real signal.
+  std::vector<float> split_cos_;
+  std::vector<float> split_sin_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_UTILITY_REAL_FFT_H_
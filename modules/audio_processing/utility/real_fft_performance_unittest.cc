@@ -0,0 +1,240 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/utility/real_fft.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common_audio/real_fourier.h"
+#include "modules/audio_processing/utility/ooura_fft.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+#include "third_party/rnnoise/src/kiss_fft.h"
+
+namespace webrtc {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kNumBatches = 200;
+constexpr size_t kNumCallsPerBatch = 500;
+
+// Time per call of a transform and of the one it is compared to, in us.
+struct TimesPerCallUs {
+  double fft;
+  double reference;
+};
+
+// Times |fft| and |reference| in alternating batches of calls, so that both
+// see the same load on the machine, and returns the median times per call.
+TimesPerCallUs CompareTimePerCallUs(const std::function<void()>& fft,
+                                    const std::function<void()>& reference) {
+  std::vector<double> fft_us;
+  std::vector<double> reference_us;
+  for (size_t i = 0; i < kNumBatches; ++i) {
+    const int64_t start_ns = rtc::TimeNanos();
+    for (size_t j = 0; j < kNumCallsPerBatch; ++j) {
+      fft();
+    }
+    const int64_t middle_ns = rtc::TimeNanos();
+    for (size_t j = 0; j < kNumCallsPerBatch; ++j) {
+      reference();
+    }
+    const int64_t end_ns = rtc::TimeNanos();
+    fft_us.push_back((middle_ns - start_ns) / 1000.0 / kNumCallsPerBatch);
+    reference_us.push_back((end_ns - middle_ns) / 1000.0 / kNumCallsPerBatch);
+  }
+  std::nth_element(fft_us.begin(), fft_us.begin() + kNumBatches / 2,
+                   fft_us.end());
+  std::nth_element(reference_us.begin(),
+                   reference_us.begin() + kNumBatches / 2, reference_us.end());
+  return {fft_us[kNumBatches / 2], reference_us[kNumBatches / 2]};
+}
+
+void PrintResults(const std::string& direction,
+                  const std::string& trace,
+                  const TimesPerCallUs& times) {
+  ASSERT_GT(times.fft, 0.0);
+  test::PrintResult("real_fft_" + direction + "_time_per_call", "", trace,
+                    times.fft, "us", false);
+  test::PrintResult("reference_fft_" + direction + "_time_per_call", "", trace,
+                    times.reference, "us", false);
+  test::PrintResult("real_fft_" + direction + "_speedup", "", trace,
+                    times.reference / times.fft, "x", true);
+}
+
+// Real transform computed, as usual with a complex FFT, by a KissFft of half
+// the length on the even and odd samples, followed by a split step. This is
+// the reference for the sizes that are not powers of 2.
+class KissFftReal {
+ public:
+  explicit KissFftReal(size_t fft_size)
+      : fft_size_(fft_size),
+        fft_(static_cast<int>(fft_size / 2)),
+        z_(fft_size / 2),
+        spectrum_(fft_size / 2) {
+    for (size_t k = 0; k < fft_size / 2; ++k) {
+      twiddles_.push_back(std::polar(1.f, static_cast<float>(
+                                              -2.0 * kPi * k / fft_size)));
+    }
+  }
+
+  void Forward(const std::vector<float>& x,
+               std::vector<float>* re,
+               std::vector<float>* im) {
+    const size_t m = fft_size_ / 2;
+    for (size_t n = 0; n < m; ++n) {
+      z_[n] = {x[2 * n], x[2 * n + 1]};
+    }
+    fft_.ForwardFft(m, z_.data(), m, spectrum_.data());
+    (*re)[0] = spectrum_[0].real() + spectrum_[0].imag();
+    (*im)[0] = 0.f;
+    (*re)[m] = spectrum_[0].real() - spectrum_[0].imag();
+    (*im)[m] = 0.f;
+    for (size_t k = 1; k < m; ++k) {
+      const std::complex<float> a = spectrum_[k];
+      const std::complex<float> b = std::conj(spectrum_[m - k]);
+      const std::complex<float> x_k =
+          0.5f * (a + b) -
+          0.5f * std::complex<float>(0.f, 1.f) * twiddles_[k] * (a - b);
+      (*re)[k] = x_k.real();
+      (*im)[k] = x_k.imag();
+    }
+  }
+
+  void Inverse(const std::vector<float>& re,
+               const std::vector<float>& im,
+               std::vector<float>* x) {
+    const size_t m = fft_size_ / 2;
+    spectrum_[0] = {re[0] + re[m], re[0] - re[m]};
+    for (size_t k = 1; k < m; ++k) {
+      const std::complex<float> a(re[k], im[k]);
+      const std::complex<float> b(re[m - k], -im[m - k]);
+      spectrum_[k] = (a + b) + std::complex<float>(0.f, 1.f) *
+                                   std::conj(twiddles_[k]) * (a - b);
+    }
+    fft_.ReverseFft(m, spectrum_.data(), m, z_.data());
+    for (size_t n = 0; n < m; ++n) {
+      (*x)[2 * n] = z_[n].real();
+      (*x)[2 * n + 1] = z_[n].imag();
+    }
+  }
+
+ private:
+  const size_t fft_size_;
+  rnnoise::KissFft fft_;
+  std::vector<std::complex<float>> twiddles_;
+  std::vector<std::complex<float>> z_;
+  std::vector<std::complex<float>> spectrum_;
+};
+
+std::vector<float> RandomVector(size_t size, Random* random_generator) {
+  std::vector<float> v(size);
+  for (float& value : v) {
+    value = 2.f * random_generator->Rand<float>() - 1.f;
+  }
+  return v;
+}
+
+}  // namespace
+
+// Compares the forward and inverse transforms with OouraFft at 128 points.
+TEST(RealFftPerformanceTest, CompareWithOouraFft) {
+  constexpr size_t kFftSize = 128;
+  constexpr size_t kNumBins = kFftSize / 2 + 1;
+  Random random_generator(42U);
+  const std::vector<float> x = RandomVector(kFftSize, &random_generator);
+  const RealFft fft(kFftSize);
+  const OouraFft ooura_fft;
+  std::array<float, kFftSize> buffer;
+  std::array<float, kNumBins> re;
+  std::array<float, kNumBins> im;
+  fft.Forward(x, re, im);
+
+  PrintResults("forward", "ooura_fft_128_samples",
+               CompareTimePerCallUs(
+                   [&] { fft.Forward(x, re, im); },
+                   [&] {
+                     std::copy(x.begin(), x.end(), buffer.begin());
+                     ooura_fft.Fft(buffer.data());
+                   }));
+  PrintResults("inverse", "ooura_fft_128_samples",
+               CompareTimePerCallUs(
+                   [&] { fft.Inverse(re, im, buffer); },
+                   [&] {
+                     std::copy(x.begin(), x.end(), buffer.begin());
+                     ooura_fft.InverseFft(buffer.data());
+                   }));
+}
+
+// Compares the forward and inverse transforms with RealFourier for powers of 2,
+// and with a real transform built on KissFft for the other sizes.
+TEST(RealFftPerformanceTest, CompareWithOtherRealFfts) {
+  Random random_generator(42U);
+  for (size_t fft_size : {64, 256, 480, 512, 960}) {
+    const std::string trace = std::to_string(fft_size) + "_samples";
+    const RealFft fft(fft_size);
+    const std::vector<float> x = RandomVector(fft_size, &random_generator);
+    std::vector<float> re(fft.num_bins());
+    std::vector<float> im(fft.num_bins());
+    std::vector<float> y(fft_size);
+    fft.Forward(x, re, im);
+    auto forward = [&] { fft.Forward(x, re, im); };
+    auto inverse = [&] { fft.Inverse(re, im, y); };
+
+    if ((fft_size & (fft_size - 1)) == 0) {
+      int order = 0;
+      while ((size_t{1} << order) < fft_size) {
+        ++order;
+      }
+      const std::unique_ptr<RealFourier> reference_fft =
+          RealFourier::Create(order);
+      RealFourier::fft_real_scoper buffer =
+          RealFourier::AllocRealBuffer(static_cast<int>(fft_size));
+      RealFourier::fft_cplx_scoper spectrum = RealFourier::AllocCplxBuffer(
+          static_cast<int>(RealFourier::ComplexLength(order)));
+      std::copy(x.begin(), x.end(), buffer.get());
+      reference_fft->Forward(buffer.get(), spectrum.get());
+      PrintResults("forward", trace,
+                   CompareTimePerCallUs(forward, [&] {
+                     reference_fft->Forward(buffer.get(), spectrum.get());
+                   }));
+      PrintResults("inverse", trace,
+                   CompareTimePerCallUs(inverse, [&] {
+                     reference_fft->Inverse(spectrum.get(), buffer.get());
+                   }));
+    } else {
+      KissFftReal reference_fft(fft_size);
+      std::vector<float> reference_re(fft.num_bins());
+      std::vector<float> reference_im(fft.num_bins());
+      std::vector<float> reference_y(fft_size);
+      reference_fft.Forward(x, &reference_re, &reference_im);
+      PrintResults("forward", trace,
+                   CompareTimePerCallUs(forward, [&] {
+                     reference_fft.Forward(x, &reference_re, &reference_im);
+                   }));
+      PrintResults("inverse", trace,
+                   CompareTimePerCallUs(inverse, [&] {
+                     reference_fft.Inverse(reference_re, reference_im,
+                                           &reference_y);
+                   }));
+    }
+  }
+}
+
+}  // namespace webrtc
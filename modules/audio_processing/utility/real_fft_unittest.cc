@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/utility/real_fft.h"
+
+#include <cmath>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kFftSizes[] = {64, 128, 256, 480, 512, 960};
+
+std::vector<float> RandomVector(size_t size, Random* random_generator) {
+  std::vector<float> v(size);
+  for (float& value : v) {
+    value = 2.f * random_generator->Rand<float>() - 1.f;
+  }
+  return v;
+}
+
+// Computes the lowest fft_size / 2 + 1 bins of the DFT of |x| in double
+// precision.
+void ReferenceForward(const std::vector<float>& x,
+                      std::vector<double>* re,
+                      std::vector<double>* im) {
+  const size_t fft_size = x.size();
+  re->assign(fft_size / 2 + 1, 0.0);
+  im->assign(fft_size / 2 + 1, 0.0);
+  for (size_t k = 0; k < re->size(); ++k) {
+    for (size_t n = 0; n < fft_size; ++n) {
+      const double angle = -2.0 * kPi * ((k * n) % fft_size) / fft_size;
+      (*re)[k] += x[n] * std::cos(angle);
+      (*im)[k] += x[n] * std::sin(angle);
+    }
+  }
+}
+
+// Computes the inverse DFT, scaled by the FFT size, of the conjugate symmetric
+// spectrum whose lowest bins are |re| and |im|.
+std::vector<double> ReferenceInverse(const std::vector<float>& re,
+                                     const std::vector<float>& im) {
+  const size_t fft_size = 2 * (re.size() - 1);
+  std::vector<double> x(fft_size, 0.0);
+  for (size_t n = 0; n < fft_size; ++n) {
+    x[n] = re[0] + ((n % 2 == 0) ? re[fft_size / 2] : -re[fft_size / 2]);
+    for (size_t k = 1; k < fft_size / 2; ++k) {
+      const double angle = 2.0 * kPi * ((k * n) % fft_size) / fft_size;
+      x[n] += 2.0 * (re[k] * std::cos(angle) - im[k] * std::sin(angle));
+    }
+  }
+  return x;
+}
+
+}  // namespace
+
+TEST(RealFft, SupportedSizes) {
+  for (size_t fft_size : kFftSizes) {
+    EXPECT_TRUE(RealFft::IsSupportedSize(fft_size));
+  }
+  EXPECT_TRUE(RealFft::IsSupportedSize(32));
+  EXPECT_TRUE(RealFft::IsSupportedSize(RealFft::kMaxFftSize));
+  EXPECT_FALSE(RealFft::IsSupportedSize(0));
+  EXPECT_FALSE(RealFft::IsSupportedSize(16));
+  EXPECT_FALSE(RealFft::IsSupportedSize(240));
+  EXPECT_FALSE(RealFft::IsSupportedSize(448));
+  EXPECT_FALSE(RealFft::IsSupportedSize(2 * RealFft::kMaxFftSize));
+}
+
+// Verifies that the forward transform matches the DFT.
+TEST(RealFft, ForwardMatchesDft) {
+  Random random_generator(42U);
+  for (size_t fft_size : kFftSizes) {
+    SCOPED_TRACE(fft_size);
+    RealFft fft(fft_size);
+    ASSERT_EQ(fft_size / 2 + 1, fft.num_bins());
+    const std::vector<float> x = RandomVector(fft_size, &random_generator);
+    std::vector<float> re(fft.num_bins());
+    std::vector<float> im(fft.num_bins());
+    fft.Forward(x, re, im);
+
+    std::vector<double> expected_re;
+    std::vector<double> expected_im;
+    ReferenceForward(x, &expected_re, &expected_im);
+    const float tolerance = 1e-6f * fft_size;
+    for (size_t k = 0; k < fft.num_bins(); ++k) {
+      EXPECT_NEAR(expected_re[k], re[k], tolerance);
+      EXPECT_NEAR(expected_im[k], im[k], tolerance);
+    }
+    EXPECT_EQ(0.f, im[0]);
+    EXPECT_EQ(0.f, im[fft_size / 2]);
+  }
+}
+
+// Verifies that the inverse transform matches the inverse DFT.
+TEST(RealFft, InverseMatchesDft) {
+  Random random_generator(42U);
+  for (size_t fft_size : kFftSizes) {
+    SCOPED_TRACE(fft_size);
+    RealFft fft(fft_size);
+    const std::vector<float> re =
+        RandomVector(fft.num_bins(), &random_generator);
+    std::vector<float> im = RandomVector(fft.num_bins(), &random_generator);
+    std::vector<float> x(fft_size);
+    fft.Inverse(re, im, x);
+
+    // The imaginary parts of the DC and Nyquist bins are ignored.
+    im[0] = 0.f;
+    im[fft_size / 2] = 0.f;
+    const std::vector<double> expected_x = ReferenceInverse(re, im);
+    const float tolerance = 1e-6f * fft_size;
+    for (size_t n = 0; n < fft_size; ++n) {
+      EXPECT_NEAR(expected_x[n], x[n], tolerance);
+    }
+  }
+}
+
+// Verifies that the inverse transform undoes the forward one, up to the
+// scaling by the FFT size.
+TEST(RealFft, InverseOfForward) {
+  Random random_generator(42U);
+  for (size_t fft_size : kFftSizes) {
+    SCOPED_TRACE(fft_size);
+    RealFft fft(fft_size);
+    const std::vector<float> x = RandomVector(fft_size, &random_generator);
+    std::vector<float> re(fft.num_bins());
+    std::vector<float> im(fft.num_bins());
+    std::vector<float> y(fft_size);
+    fft.Forward(x, re, im);
+    fft.Inverse(re, im, y);
+    for (size_t n = 0; n < fft_size; ++n) {
+      EXPECT_NEAR(x[n], y[n] / fft_size, 1e-6f);
+    }
+  }
+}
+
+#if GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
+
+TEST(RealFft, UnsupportedSize) {
+  EXPECT_DEATH(RealFft(100), "");
+}
+
+#endif
+
+}  // namespace webrtc
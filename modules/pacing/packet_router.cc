@@ -38,6 +38,7 @@ PacketRouter::PacketRouter()
 
 PacketRouter::~PacketRouter() {
   RTC_DCHECK(rtp_send_modules_.empty());
+  RTC_DCHECK(send_packet_senders_.empty());
   RTC_DCHECK(rtcp_feedback_senders_.empty());
   RTC_DCHECK(sender_remb_candidates_.empty());
   RTC_DCHECK(receiver_remb_candidates_.empty());
@@ -73,6 +74,21 @@ void PacketRouter::RemoveSendRtpModule(RtpRtcp* rtp_module) {
   }
 }
 
+void PacketRouter::AddSendPacketSender(
+    uint32_t ssrc,
+    PacedSender::PacketSender* packet_sender) {
+  rtc::CritScope cs(&modules_crit_);
+  RTC_DCHECK(packet_sender);
+  bool inserted = send_packet_senders_.emplace(ssrc, packet_sender).second;
+  RTC_DCHECK(inserted) << "SSRC " << ssrc << " already has a packet sender.";
+}
+
+void PacketRouter::RemoveSendPacketSender(uint32_t ssrc) {
+  rtc::CritScope cs(&modules_crit_);
+  size_t removed = send_packet_senders_.erase(ssrc);
+  RTC_DCHECK_EQ(removed, 1);
+}
+
 void PacketRouter::AddReceiveRtpModule(RtcpFeedbackSenderInterface* rtcp_sender,
                                        bool remb_candidate) {
   rtc::CritScope cs(&modules_crit_);
@@ -119,6 +135,12 @@ bool PacketRouter::TimeToSendPacket(uint32_t ssrc,
                                           pacing_info);
     }
   }
+  auto it = send_packet_senders_.find(ssrc);
+  if (it != send_packet_senders_.end()) {
+    return it->second->TimeToSendPacket(ssrc, sequence_number,
+                                        capture_timestamp, retransmission,
+                                        pacing_info);
+  }
   return true;
 }
 
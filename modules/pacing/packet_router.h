@@ -12,6 +12,7 @@
 #define MODULES_PACING_PACKET_ROUTER_H_
 
 #include <list>
+#include <map>
 #include <vector>
 
 #include "common_types.h"  // NOLINT(build/include)
@@ -46,6 +47,13 @@ class PacketRouter : public PacedSender::PacketSender,
   void AddSendRtpModule(RtpRtcp* rtp_module, bool remb_candidate);
   void RemoveSendRtpModule(RtpRtcp* rtp_module);
 
+  // Routes the paced packets of |ssrc| to |packet_sender|, for senders that
+  // don't use an RtpRtcp module, such as an RtpStreamForwarder. Padding is
+  // only sent on the RtpRtcp modules.
+  void AddSendPacketSender(uint32_t ssrc,
+                           PacedSender::PacketSender* packet_sender);
+  void RemoveSendPacketSender(uint32_t ssrc);
+
   void AddReceiveRtpModule(RtcpFeedbackSenderInterface* rtcp_sender,
                            bool remb_candidate);
   void RemoveReceiveRtpModule(RtcpFeedbackSenderInterface* rtcp_sender);
@@ -94,6 +102,9 @@ class PacketRouter : public PacedSender::PacketSender,
   rtc::CriticalSection modules_crit_;
   // Rtp and Rtcp modules of the rtp senders.
   std::list<RtpRtcp*> rtp_send_modules_ RTC_GUARDED_BY(modules_crit_);
+  // Packet senders without an RtpRtcp module, by SSRC.
+  std::map<uint32_t, PacedSender::PacketSender*> send_packet_senders_
+      RTC_GUARDED_BY(modules_crit_);
   // The last module used to send media.
   RtpRtcp* last_send_module_ RTC_GUARDED_BY(modules_crit_);
   // Rtcp modules of the rtp receivers.
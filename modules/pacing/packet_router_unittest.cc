@@ -43,6 +43,18 @@ using ::testing::SaveArg;
 constexpr int kProbeMinProbes = 5;
 constexpr int kProbeMinBytes = 1000;
 
+class MockPacketSender : public PacedSender::PacketSender {
+ public:
+  MOCK_METHOD5(TimeToSendPacket,
+               bool(uint32_t ssrc,
+                    uint16_t sequence_number,
+                    int64_t capture_time_ms,
+                    bool retransmission,
+                    const PacedPacketInfo& pacing_info));
+  MOCK_METHOD2(TimeToSendPadding,
+               size_t(size_t bytes, const PacedPacketInfo& pacing_info));
+};
+
 }  // namespace
 
 TEST(PacketRouterTest, Sanity_NoModuleRegistered_TimeToSendPacket) {
@@ -175,6 +187,44 @@ TEST(PacketRouterTest, TimeToSendPacket) {
   packet_router.RemoveSendRtpModule(&rtp_2);
 }
 
+TEST(PacketRouterTest, TimeToSendPacketOnPacketSender) {
+  PacketRouter packet_router;
+  NiceMock<MockRtpRtcp> rtp;
+  MockPacketSender packet_sender;
+  const uint32_t kModuleSsrc = 1234;
+  const uint32_t kSenderSsrc = 4567;
+  ON_CALL(rtp, SendingMedia()).WillByDefault(Return(true));
+  ON_CALL(rtp, SSRC()).WillByDefault(Return(kModuleSsrc));
+  packet_router.AddSendRtpModule(&rtp, false);
+  packet_router.AddSendPacketSender(kSenderSsrc, &packet_sender);
+
+  EXPECT_CALL(rtp, TimeToSendPacket(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(packet_sender,
+              TimeToSendPacket(kSenderSsrc, 17, 7890, true,
+                               Field(&PacedPacketInfo::probe_cluster_id, 1)))
+      .WillOnce(Return(false));
+  EXPECT_FALSE(packet_router.TimeToSendPacket(
+      kSenderSsrc, 17, 7890, true,
+      PacedPacketInfo(1, kProbeMinProbes, kProbeMinBytes)));
+
+  EXPECT_CALL(rtp, TimeToSendPacket(kModuleSsrc, _, _, _, _))
+      .WillOnce(Return(true));
+  EXPECT_CALL(packet_sender, TimeToSendPacket(_, _, _, _, _)).Times(0);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(kModuleSsrc, 18, 7890, false,
+                                             PacedPacketInfo()));
+
+  // Padding is only sent on the modules.
+  EXPECT_CALL(packet_sender, TimeToSendPadding(_, _)).Times(0);
+  packet_router.TimeToSendPadding(1000, PacedPacketInfo());
+
+  packet_router.RemoveSendPacketSender(kSenderSsrc);
+  EXPECT_CALL(packet_sender, TimeToSendPacket(_, _, _, _, _)).Times(0);
+  EXPECT_TRUE(packet_router.TimeToSendPacket(kSenderSsrc, 19, 7890, false,
+                                             PacedPacketInfo()));
+
+  packet_router.RemoveSendRtpModule(&rtp);
+}
+
 TEST(PacketRouterTest, TimeToSendPadding) {
   PacketRouter packet_router;
 
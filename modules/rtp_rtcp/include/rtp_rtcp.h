@@ -23,6 +23,7 @@
 #include "modules/rtp_rtcp/include/flexfec_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "rtc_base/deprecation.h"
 
 namespace webrtc {
@@ -226,6 +227,8 @@ class RtpRtcp : public Module, public RtcpFeedbackSenderInterface {
   // |timestamp|     - timestamp of frame to send
   // |payload_data|  - payload buffer of frame to send
   // |payload_size|  - size of payload buffer to send
+  // |payload_buffer| - if not null, a shared buffer holding the payload, which
+  //                   the packets may then reference instead of copying it
   // |fragmentation| - fragmentation offset data for fragmented frames such
   //                   as layers or RED
   // |transport_frame_id_out| - set to RTP timestamp.
@@ -236,6 +239,7 @@ class RtpRtcp : public Module, public RtcpFeedbackSenderInterface {
                                 int64_t capture_time_ms,
                                 const uint8_t* payload_data,
                                 size_t payload_size,
+                                const rtc::CopyOnWriteBuffer* payload_buffer,
                                 const RTPFragmentationHeader* fragmentation,
                                 const RTPVideoHeader* rtp_video_header,
                                 uint32_t* transport_frame_id_out) = 0;
@@ -205,7 +205,8 @@ class RtpRtcpRtxNackTest : public ::testing::Test {
       RTPVideoHeader video_header;
       EXPECT_TRUE(rtp_rtcp_module_->SendOutgoingData(
           webrtc::kVideoFrameDelta, kPayloadType, timestamp, timestamp / 90,
-          payload_data, payload_data_length, nullptr, &video_header, nullptr));
+          payload_data, payload_data_length, nullptr, nullptr, &video_header,
+          nullptr));
       // Min required delay until retransmit = 5 + RTT ms (RTT = 0).
       fake_clock.AdvanceTimeMilliseconds(5);
       int length = BuildNackList(nack_list);
@@ -254,7 +255,8 @@ TEST_F(RtpRtcpRtxNackTest, LongNackList) {
     RTPVideoHeader video_header;
     EXPECT_TRUE(rtp_rtcp_module_->SendOutgoingData(
         webrtc::kVideoFrameDelta, kPayloadType, timestamp, timestamp / 90,
-        payload_data, payload_data_length, nullptr, &video_header, nullptr));
+        payload_data, payload_data_length, nullptr, nullptr, &video_header,
+        nullptr));
     // Prepare next frame.
     timestamp += 3000;
     fake_clock.AdvanceTimeMilliseconds(33);
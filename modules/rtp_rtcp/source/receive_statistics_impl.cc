@@ -36,18 +36,18 @@ StreamStatisticianImpl::StreamStatisticianImpl(
     StreamDataCountersCallback* rtp_callback)
     : ssrc_(ssrc),
       clock_(clock),
-      incoming_bitrate_(kStatisticsProcessIntervalMs,
-                        RateStatistics::kBpsScale),
       max_reordering_threshold_(kDefaultMaxReorderingThreshold),
       enable_retransmit_detection_(enable_retransmit_detection),
+      incoming_bitrate_(kStatisticsProcessIntervalMs,
+                        RateStatistics::kBpsScale),
       jitter_q4_(0),
-      cumulative_loss_(0),
       last_receive_time_ms_(0),
       last_received_timestamp_(0),
       received_seq_first_(0),
       received_seq_max_(0),
       received_seq_wraps_(0),
       received_packet_overhead_(12),
+      cumulative_loss_(0),
       last_report_inorder_packets_(0),
       last_report_old_packets_(0),
       last_report_seq_max_(0),
@@ -58,24 +58,23 @@ StreamStatisticianImpl::~StreamStatisticianImpl() = default;
 
 void StreamStatisticianImpl::IncomingPacket(const RTPHeader& header,
                                             size_t packet_length) {
-  StreamDataCounters counters;
-  {
-    rtc::CritScope cs(&stream_lock_);
-
-    bool retransmitted =
-        enable_retransmit_detection_ && IsRetransmitOfOldPacket(header);
-    counters = UpdateCounters(header, packet_length, retransmitted);
-  }
-  rtp_callback_->DataCountersUpdated(counters, ssrc_);
+  RTC_DCHECK_RUNS_SERIALIZED(&packet_race_checker_);
+  bool retransmitted =
+      enable_retransmit_detection_.load(std::memory_order_relaxed) &&
+      IsRetransmitOfOldPacket(header);
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  UpdateCounters(header, packet_length, retransmitted, now_ms);
+  PublishSnapshot(now_ms);
+  rtp_callback_->DataCountersUpdated(receive_counters_, ssrc_);
 }
 
-StreamDataCounters StreamStatisticianImpl::UpdateCounters(
-    const RTPHeader& header,
-    size_t packet_length,
-    bool retransmitted) {
+void StreamStatisticianImpl::UpdateCounters(const RTPHeader& header,
+                                            size_t packet_length,
+                                            bool retransmitted,
+                                            int64_t now_ms) {
   bool in_order = InOrderPacketInternal(header.sequenceNumber);
   RTC_DCHECK_EQ(ssrc_, header.ssrc);
-  incoming_bitrate_.Update(packet_length, clock_->TimeInMilliseconds());
+  incoming_bitrate_.Update(packet_length, now_ms);
   receive_counters_.transmitted.AddPacket(packet_length, header);
   if (!in_order && retransmitted) {
     receive_counters_.retransmitted.AddPacket(packet_length, header);
@@ -83,7 +82,7 @@ StreamDataCounters StreamStatisticianImpl::UpdateCounters(
 
   if (receive_counters_.transmitted.packets == 1) {
     received_seq_first_ = header.sequenceNumber;
-    receive_counters_.first_packet_time_ms = clock_->TimeInMilliseconds();
+    receive_counters_.first_packet_time_ms = now_ms;
   }
 
   // Count only the new packets received. That is, if packets 1, 2, 3, 5, 4, 6
@@ -110,7 +109,7 @@ StreamDataCounters StreamStatisticianImpl::UpdateCounters(
     }
     last_received_timestamp_ = header.timestamp;
     last_receive_time_ntp_ = receive_time;
-    last_receive_time_ms_ = clock_->TimeInMilliseconds();
+    last_receive_time_ms_ = now_ms;
   }
 
   size_t packet_oh = header.headerLength + header.paddingLength;
@@ -118,7 +117,19 @@ StreamDataCounters StreamStatisticianImpl::UpdateCounters(
   // Our measured overhead. Filter from RFC 5104 4.2.1.2:
   // avg_OH (new) = 15/16*avg_OH (old) + 1/16*pckt_OH,
   received_packet_overhead_ = (15 * received_packet_overhead_ + packet_oh) >> 4;
-  return receive_counters_;
+}
+
+void StreamStatisticianImpl::PublishSnapshot(int64_t now_ms) {
+  Snapshot snapshot;
+  snapshot.counters = receive_counters_;
+  snapshot.last_receive_time_ntp_ms = last_receive_time_ntp_.ToMs();
+  snapshot.bitrate_time_ms = now_ms;
+  snapshot.bitrate_bps = incoming_bitrate_.Rate(now_ms).value_or(0);
+  snapshot.jitter_q4 = jitter_q4_;
+  snapshot.received_seq_first = received_seq_first_;
+  snapshot.received_seq_max = received_seq_max_;
+  snapshot.received_seq_wraps = received_seq_wraps_;
+  snapshot_.Store(snapshot);
 }
 
 void StreamStatisticianImpl::UpdateJitter(const RTPHeader& header,
@@ -144,32 +155,29 @@ void StreamStatisticianImpl::UpdateJitter(const RTPHeader& header,
 
 void StreamStatisticianImpl::FecPacketReceived(const RTPHeader& header,
                                                size_t packet_length) {
-  StreamDataCounters counters;
-  {
-    rtc::CritScope cs(&stream_lock_);
-    receive_counters_.fec.AddPacket(packet_length, header);
-    counters = receive_counters_;
-  }
-  rtp_callback_->DataCountersUpdated(counters, ssrc_);
+  RTC_DCHECK_RUNS_SERIALIZED(&packet_race_checker_);
+  receive_counters_.fec.AddPacket(packet_length, header);
+  PublishSnapshot(clock_->TimeInMilliseconds());
+  rtp_callback_->DataCountersUpdated(receive_counters_, ssrc_);
 }
 
 void StreamStatisticianImpl::SetMaxReorderingThreshold(
     int max_reordering_threshold) {
-  rtc::CritScope cs(&stream_lock_);
-  max_reordering_threshold_ = max_reordering_threshold;
+  max_reordering_threshold_.store(max_reordering_threshold,
+                                  std::memory_order_relaxed);
 }
 
 void StreamStatisticianImpl::EnableRetransmitDetection(bool enable) {
-  rtc::CritScope cs(&stream_lock_);
-  enable_retransmit_detection_ = enable;
+  enable_retransmit_detection_.store(enable, std::memory_order_relaxed);
 }
 
 bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
                                            bool reset) {
+  const Snapshot snapshot = snapshot_.Load();
   {
-    rtc::CritScope cs(&stream_lock_);
-    if (received_seq_first_ == 0 &&
-        receive_counters_.transmitted.payload_bytes == 0) {
+    rtc::CritScope cs(&report_lock_);
+    if (snapshot.received_seq_first == 0 &&
+        snapshot.counters.transmitted.payload_bytes == 0) {
       // We have not received anything.
       return false;
     }
@@ -184,7 +192,7 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
       return true;
     }
 
-    *statistics = CalculateRtcpStatistics();
+    *statistics = CalculateRtcpStatistics(snapshot);
   }
 
   rtcp_callback_->StatisticsUpdated(*statistics, ssrc_);
@@ -193,47 +201,49 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
 
 bool StreamStatisticianImpl::GetActiveStatisticsAndReset(
     RtcpStatistics* statistics) {
+  const Snapshot snapshot = snapshot_.Load();
+  if (clock_->CurrentNtpInMilliseconds() - snapshot.last_receive_time_ntp_ms >=
+      kStatisticsTimeoutMs) {
+    // Not active.
+    return false;
+  }
+  if (snapshot.received_seq_first == 0 &&
+      snapshot.counters.transmitted.payload_bytes == 0) {
+    // We have not received anything.
+    return false;
+  }
   {
-    rtc::CritScope cs(&stream_lock_);
-    if (clock_->CurrentNtpInMilliseconds() - last_receive_time_ntp_.ToMs() >=
-        kStatisticsTimeoutMs) {
-      // Not active.
-      return false;
-    }
-    if (received_seq_first_ == 0 &&
-        receive_counters_.transmitted.payload_bytes == 0) {
-      // We have not received anything.
-      return false;
-    }
-
-    *statistics = CalculateRtcpStatistics();
+    rtc::CritScope cs(&report_lock_);
+    *statistics = CalculateRtcpStatistics(snapshot);
   }
 
   rtcp_callback_->StatisticsUpdated(*statistics, ssrc_);
   return true;
 }
 
-RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
+RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics(
+    const Snapshot& snapshot) {
+  const StreamDataCounters& counters = snapshot.counters;
   RtcpStatistics stats;
 
   if (last_report_inorder_packets_ == 0) {
     // First time we send a report.
-    last_report_seq_max_ = received_seq_first_ - 1;
+    last_report_seq_max_ = snapshot.received_seq_first - 1;
   }
 
   // Calculate fraction lost.
-  uint16_t exp_since_last = (received_seq_max_ - last_report_seq_max_);
+  uint16_t exp_since_last = (snapshot.received_seq_max - last_report_seq_max_);
 
-  if (last_report_seq_max_ > received_seq_max_) {
+  if (last_report_seq_max_ > snapshot.received_seq_max) {
     // Can we assume that the seq_num can't go decrease over a full RTCP period?
     exp_since_last = 0;
   }
 
   // Number of received RTP packets since last report, counts all packets but
   // not re-transmissions.
-  uint32_t rec_since_last = (receive_counters_.transmitted.packets -
-                             receive_counters_.retransmitted.packets) -
-                            last_report_inorder_packets_;
+  uint32_t rec_since_last =
+      (counters.transmitted.packets - counters.retransmitted.packets) -
+      last_report_inorder_packets_;
 
   // With NACK we don't know the expected retransmissions during the last
   // second. We know how many "old" packets we have received. We just count
@@ -245,7 +255,7 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   // re-transmitted. We use RTT to decide if a packet is re-ordered or
   // re-transmitted.
   uint32_t retransmitted_packets =
-      receive_counters_.retransmitted.packets - last_report_old_packets_;
+      counters.retransmitted.packets - last_report_old_packets_;
   rec_since_last += retransmitted_packets;
 
   int32_t missing = 0;
@@ -264,50 +274,56 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   cumulative_loss_ += missing;
   stats.packets_lost = cumulative_loss_;
   stats.extended_highest_sequence_number =
-      (received_seq_wraps_ << 16) + received_seq_max_;
+      (snapshot.received_seq_wraps << 16) + snapshot.received_seq_max;
   // Note: internal jitter value is in Q4 and needs to be scaled by 1/16.
-  stats.jitter = jitter_q4_ >> 4;
+  stats.jitter = snapshot.jitter_q4 >> 4;
 
   // Store this report.
   last_reported_statistics_ = stats;
 
   // Only for report blocks in RTCP SR and RR.
-  last_report_inorder_packets_ = receive_counters_.transmitted.packets -
-                                 receive_counters_.retransmitted.packets;
-  last_report_old_packets_ = receive_counters_.retransmitted.packets;
-  last_report_seq_max_ = received_seq_max_;
+  last_report_inorder_packets_ =
+      counters.transmitted.packets - counters.retransmitted.packets;
+  last_report_old_packets_ = counters.retransmitted.packets;
+  last_report_seq_max_ = snapshot.received_seq_max;
   BWE_TEST_LOGGING_PLOT_WITH_SSRC(1, "cumulative_loss_pkts",
                                   clock_->TimeInMilliseconds(),
                                   cumulative_loss_, ssrc_);
   BWE_TEST_LOGGING_PLOT_WITH_SSRC(
       1, "received_seq_max_pkts", clock_->TimeInMilliseconds(),
-      (received_seq_max_ - received_seq_first_), ssrc_);
+      (snapshot.received_seq_max - snapshot.received_seq_first), ssrc_);
 
   return stats;
 }
 
 void StreamStatisticianImpl::GetDataCounters(size_t* bytes_received,
                                              uint32_t* packets_received) const {
-  rtc::CritScope cs(&stream_lock_);
+  const StreamDataCounters counters = snapshot_.Load().counters;
   if (bytes_received) {
-    *bytes_received = receive_counters_.transmitted.payload_bytes +
-                      receive_counters_.transmitted.header_bytes +
-                      receive_counters_.transmitted.padding_bytes;
+    *bytes_received = counters.transmitted.payload_bytes +
+                      counters.transmitted.header_bytes +
+                      counters.transmitted.padding_bytes;
   }
   if (packets_received) {
-    *packets_received = receive_counters_.transmitted.packets;
+    *packets_received = counters.transmitted.packets;
   }
 }
 
 void StreamStatisticianImpl::GetReceiveStreamDataCounters(
     StreamDataCounters* data_counters) const {
-  rtc::CritScope cs(&stream_lock_);
-  *data_counters = receive_counters_;
+  *data_counters = snapshot_.Load().counters;
 }
 
 uint32_t StreamStatisticianImpl::BitrateReceived() const {
-  rtc::CritScope cs(&stream_lock_);
-  return incoming_bitrate_.Rate(clock_->TimeInMilliseconds()).value_or(0);
+  const Snapshot snapshot = snapshot_.Load();
+  // The rate estimator belongs to the writer, so the rate can't be brought up
+  // to date here. Once the window has passed without packets, report zero
+  // like the estimator itself would.
+  if (clock_->TimeInMilliseconds() - snapshot.bitrate_time_ms >=
+      kStatisticsProcessIntervalMs) {
+    return 0;
+  }
+  return snapshot.bitrate_bps;
 }
 
 bool StreamStatisticianImpl::IsRetransmitOfOldPacket(
@@ -351,7 +367,9 @@ bool StreamStatisticianImpl::InOrderPacketInternal(
   } else {
     // If we have a restart of the remote side this packet is still in order.
     return !IsNewerSequenceNumber(
-        sequence_number, received_seq_max_ - max_reordering_threshold_);
+        sequence_number,
+        received_seq_max_ -
+            max_reordering_threshold_.load(std::memory_order_relaxed));
   }
 }
 
@@ -362,8 +380,8 @@ ReceiveStatistics* ReceiveStatistics::Create(Clock* clock) {
 ReceiveStatisticsImpl::ReceiveStatisticsImpl(Clock* clock)
     : clock_(clock),
       last_returned_ssrc_(0),
-      rtcp_stats_callback_(NULL),
-      rtp_stats_callback_(NULL) {}
+      rtcp_stats_callback_(nullptr),
+      rtp_stats_callback_(nullptr) {}
 
 ReceiveStatisticsImpl::~ReceiveStatisticsImpl() {
   while (!statisticians_.empty()) {
@@ -372,39 +390,47 @@ ReceiveStatisticsImpl::~ReceiveStatisticsImpl() {
   }
 }
 
-void ReceiveStatisticsImpl::IncomingPacket(const RTPHeader& header,
-                                           size_t packet_length) {
+StreamStatisticianImpl* ReceiveStatisticsImpl::FindStatisticianForPacket(
+    uint32_t ssrc,
+    bool create) {
+  StreamStatisticianImpl** cached = packet_statisticians_.Find(ssrc);
+  if (cached)
+    return *cached;
   StreamStatisticianImpl* impl;
   {
     rtc::CritScope cs(&receive_statistics_lock_);
-    auto it = statisticians_.find(header.ssrc);
+    auto it = statisticians_.find(ssrc);
     if (it != statisticians_.end()) {
       impl = it->second;
-    } else {
+    } else if (create) {
       impl = new StreamStatisticianImpl(
-          header.ssrc, clock_, /* enable_retransmit_detection = */ false, this,
-          this);
-      statisticians_[header.ssrc] = impl;
+          ssrc, clock_, /* enable_retransmit_detection = */ false, this, this);
+      statisticians_[ssrc] = impl;
+    } else {
+      return nullptr;
     }
   }
-  // StreamStatisticianImpl instance is created once and only destroyed when
-  // this whole ReceiveStatisticsImpl is destroyed. StreamStatisticianImpl has
-  // it's own locking so don't hold receive_statistics_lock_ (potential
-  // deadlock).
-  impl->IncomingPacket(header, packet_length);
+  // StreamStatisticianImpl instances are only destroyed together with this
+  // object, so the cached pointer stays valid.
+  packet_statisticians_.Insert(ssrc, impl);
+  return impl;
+}
+
+void ReceiveStatisticsImpl::IncomingPacket(const RTPHeader& header,
+                                           size_t packet_length) {
+  RTC_DCHECK_RUNS_SERIALIZED(&packet_race_checker_);
+  FindStatisticianForPacket(header.ssrc, /*create=*/true)
+      ->IncomingPacket(header, packet_length);
 }
 
 void ReceiveStatisticsImpl::FecPacketReceived(const RTPHeader& header,
                                               size_t packet_length) {
-  StreamStatisticianImpl* impl;
-  {
-    rtc::CritScope cs(&receive_statistics_lock_);
-    auto it = statisticians_.find(header.ssrc);
-    // Ignore FEC if it is the first packet.
-    if (it == statisticians_.end())
-      return;
-    impl = it->second;
-  }
+  RTC_DCHECK_RUNS_SERIALIZED(&packet_race_checker_);
+  StreamStatisticianImpl* impl =
+      FindStatisticianForPacket(header.ssrc, /*create=*/false);
+  // Ignore FEC if it is the first packet.
+  if (!impl)
+    return;
   impl->FecPacketReceived(header, packet_length);
 }
 
@@ -442,7 +468,7 @@ void ReceiveStatisticsImpl::EnableRetransmitDetection(uint32_t ssrc,
 
 void ReceiveStatisticsImpl::RegisterRtcpStatisticsCallback(
     RtcpStatisticsCallback* callback) {
-  rtc::CritScope cs(&receive_statistics_lock_);
+  rtc::CritScope cs(&rtcp_callback_lock_);
   if (callback != NULL)
     assert(rtcp_stats_callback_ == NULL);
   rtcp_stats_callback_ = callback;
@@ -450,20 +476,20 @@ void ReceiveStatisticsImpl::RegisterRtcpStatisticsCallback(
 
 void ReceiveStatisticsImpl::StatisticsUpdated(const RtcpStatistics& statistics,
                                               uint32_t ssrc) {
-  rtc::CritScope cs(&receive_statistics_lock_);
+  rtc::CritScope cs(&rtcp_callback_lock_);
   if (rtcp_stats_callback_)
     rtcp_stats_callback_->StatisticsUpdated(statistics, ssrc);
 }
 
 void ReceiveStatisticsImpl::CNameChanged(const char* cname, uint32_t ssrc) {
-  rtc::CritScope cs(&receive_statistics_lock_);
+  rtc::CritScope cs(&rtcp_callback_lock_);
   if (rtcp_stats_callback_)
     rtcp_stats_callback_->CNameChanged(cname, ssrc);
 }
 
 void ReceiveStatisticsImpl::RegisterRtpStatisticsCallback(
     StreamDataCountersCallback* callback) {
-  rtc::CritScope cs(&receive_statistics_lock_);
+  rtc::CritScope cs(&rtp_callback_lock_);
   if (callback != NULL)
     assert(rtp_stats_callback_ == NULL);
   rtp_stats_callback_ = callback;
@@ -471,7 +497,7 @@ void ReceiveStatisticsImpl::RegisterRtpStatisticsCallback(
 
 void ReceiveStatisticsImpl::DataCountersUpdated(const StreamDataCounters& stats,
                                                 uint32_t ssrc) {
-  rtc::CritScope cs(&receive_statistics_lock_);
+  rtc::CritScope cs(&rtp_callback_lock_);
   if (rtp_stats_callback_) {
     rtp_stats_callback_->DataCountersUpdated(stats, ssrc);
   }
@@ -479,13 +505,9 @@ void ReceiveStatisticsImpl::DataCountersUpdated(const StreamDataCounters& stats,
 
 std::vector<rtcp::ReportBlock> ReceiveStatisticsImpl::RtcpReportBlocks(
     size_t max_blocks) {
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians;
-  {
-    rtc::CritScope cs(&receive_statistics_lock_);
-    statisticians = statisticians_;
-  }
+  rtc::CritScope cs(&receive_statistics_lock_);
   std::vector<rtcp::ReportBlock> result;
-  result.reserve(std::min(max_blocks, statisticians.size()));
+  result.reserve(std::min(max_blocks, statisticians_.size()));
   auto add_report_block = [&result](uint32_t media_ssrc,
                                     StreamStatisticianImpl* statistician) {
     // Do we have receive statistics to send?
@@ -505,11 +527,11 @@ std::vector<rtcp::ReportBlock> ReceiveStatisticsImpl::RtcpReportBlocks(
     block.SetJitter(stats.jitter);
   };
 
-  const auto start_it = statisticians.upper_bound(last_returned_ssrc_);
+  const auto start_it = statisticians_.upper_bound(last_returned_ssrc_);
   for (auto it = start_it;
-       result.size() < max_blocks && it != statisticians.end(); ++it)
+       result.size() < max_blocks && it != statisticians_.end(); ++it)
     add_report_block(it->first, it->second);
-  for (auto it = statisticians.begin();
+  for (auto it = statisticians_.begin();
        result.size() < max_blocks && it != start_it; ++it)
     add_report_block(it->first, it->second);
 
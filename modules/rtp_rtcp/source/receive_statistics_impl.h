@@ -14,15 +14,26 @@
 #include "modules/rtp_rtcp/include/receive_statistics.h"
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <vector>
 
 #include "rtc_base/criticalsection.h"
+#include "rtc_base/race_checker.h"
 #include "rtc_base/rate_statistics.h"
+#include "rtc_base/synchronization/seqlock.h"
+#include "rtc_base/uint32_hash_map.h"
 #include "system_wrappers/include/ntp_time.h"
 
 namespace webrtc {
 
+// Per-packet updates (IncomingPacket() and FecPacketReceived()) are made by a
+// single writer, normally the network thread, and take no locks shared with
+// readers. After each packet the writer publishes a snapshot of the counters
+// through a SeqLock; all getters read that snapshot, so readers on other
+// threads (stats, RTCP timers) never block the writer. State that only readers
+// modify, i.e. what was included in the last RTCP report, is guarded by
+// |report_lock_|, which the writer never takes.
 class StreamStatisticianImpl : public StreamStatistician {
  public:
   StreamStatisticianImpl(uint32_t ssrc,
@@ -39,61 +50,82 @@ class StreamStatisticianImpl : public StreamStatistician {
                        uint32_t* packets_received) const override;
   void GetReceiveStreamDataCounters(
       StreamDataCounters* data_counters) const override;
+  // Returns the rate published with the latest packet, or 0 if no packet was
+  // received during the last rate window.
   uint32_t BitrateReceived() const override;
 
+  // Must not be called concurrently with each other.
   void IncomingPacket(const RTPHeader& rtp_header, size_t packet_length);
   void FecPacketReceived(const RTPHeader& header, size_t packet_length);
+
   void SetMaxReorderingThreshold(int max_reordering_threshold);
   void EnableRetransmitDetection(bool enable);
 
  private:
+  // What readers need from the writer, published after every packet.
+  struct Snapshot {
+    StreamDataCounters counters;
+    int64_t last_receive_time_ntp_ms = 0;
+    int64_t bitrate_time_ms = 0;
+    uint32_t bitrate_bps = 0;
+    uint32_t jitter_q4 = 0;
+    uint16_t received_seq_first = 0;
+    uint16_t received_seq_max = 0;
+    uint16_t received_seq_wraps = 0;
+  };
+
   bool IsRetransmitOfOldPacket(const RTPHeader& header) const
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(packet_race_checker_);
   bool InOrderPacketInternal(uint16_t sequence_number) const
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
-  RtcpStatistics CalculateRtcpStatistics()
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(packet_race_checker_);
+  RtcpStatistics CalculateRtcpStatistics(const Snapshot& snapshot)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(report_lock_);
   void UpdateJitter(const RTPHeader& header, NtpTime receive_time)
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
-  StreamDataCounters UpdateCounters(const RTPHeader& rtp_header,
-                                    size_t packet_length,
-                                    bool retransmitted)
-      RTC_EXCLUSIVE_LOCKS_REQUIRED(stream_lock_);
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(packet_race_checker_);
+  void UpdateCounters(const RTPHeader& rtp_header,
+                      size_t packet_length,
+                      bool retransmitted,
+                      int64_t now_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(packet_race_checker_);
+  void PublishSnapshot(int64_t now_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(packet_race_checker_);
 
   const uint32_t ssrc_;
   Clock* const clock_;
-  rtc::CriticalSection stream_lock_;
-  RateStatistics incoming_bitrate_ RTC_GUARDED_BY(&stream_lock_);
-  // In number of packets or sequence numbers.
-  int max_reordering_threshold_ RTC_GUARDED_BY(&stream_lock_);
-  bool enable_retransmit_detection_ RTC_GUARDED_BY(&stream_lock_);
-
-  // Stats on received RTP packets.
-  uint32_t jitter_q4_ RTC_GUARDED_BY(&stream_lock_);
-  uint32_t cumulative_loss_ RTC_GUARDED_BY(&stream_lock_);
-
-  int64_t last_receive_time_ms_ RTC_GUARDED_BY(&stream_lock_);
-  NtpTime last_receive_time_ntp_ RTC_GUARDED_BY(&stream_lock_);
-  uint32_t last_received_timestamp_ RTC_GUARDED_BY(&stream_lock_);
-  uint16_t received_seq_first_ RTC_GUARDED_BY(&stream_lock_);
-  uint16_t received_seq_max_ RTC_GUARDED_BY(&stream_lock_);
-  uint16_t received_seq_wraps_ RTC_GUARDED_BY(&stream_lock_);
-
-  // Current counter values.
-  size_t received_packet_overhead_ RTC_GUARDED_BY(&stream_lock_);
-  StreamDataCounters receive_counters_ RTC_GUARDED_BY(&stream_lock_);
-
-  // Counter values when we sent the last report.
-  uint32_t last_report_inorder_packets_ RTC_GUARDED_BY(&stream_lock_);
-  uint32_t last_report_old_packets_ RTC_GUARDED_BY(&stream_lock_);
-  uint16_t last_report_seq_max_ RTC_GUARDED_BY(&stream_lock_);
-  RtcpStatistics last_reported_statistics_ RTC_GUARDED_BY(&stream_lock_);
-
-  // stream_lock_ shouldn't be held when calling callbacks.
+  std::atomic<int> max_reordering_threshold_;
+  std::atomic<bool> enable_retransmit_detection_;
+
+  // Owned by the writer.
+  rtc::RaceChecker packet_race_checker_;
+  RateStatistics incoming_bitrate_ RTC_GUARDED_BY(packet_race_checker_);
+  uint32_t jitter_q4_ RTC_GUARDED_BY(packet_race_checker_);
+  int64_t last_receive_time_ms_ RTC_GUARDED_BY(packet_race_checker_);
+  NtpTime last_receive_time_ntp_ RTC_GUARDED_BY(packet_race_checker_);
+  uint32_t last_received_timestamp_ RTC_GUARDED_BY(packet_race_checker_);
+  uint16_t received_seq_first_ RTC_GUARDED_BY(packet_race_checker_);
+  uint16_t received_seq_max_ RTC_GUARDED_BY(packet_race_checker_);
+  uint16_t received_seq_wraps_ RTC_GUARDED_BY(packet_race_checker_);
+  size_t received_packet_overhead_ RTC_GUARDED_BY(packet_race_checker_);
+  StreamDataCounters receive_counters_ RTC_GUARDED_BY(packet_race_checker_);
+
+  SeqLock<Snapshot> snapshot_;
+
+  // Counter values when we sent the last report. Owned by the readers.
+  rtc::CriticalSection report_lock_;
+  uint32_t cumulative_loss_ RTC_GUARDED_BY(report_lock_);
+  uint32_t last_report_inorder_packets_ RTC_GUARDED_BY(report_lock_);
+  uint32_t last_report_old_packets_ RTC_GUARDED_BY(report_lock_);
+  uint16_t last_report_seq_max_ RTC_GUARDED_BY(report_lock_);
+  RtcpStatistics last_reported_statistics_ RTC_GUARDED_BY(report_lock_);
+
+  // report_lock_ shouldn't be held when calling callbacks.
   RtcpStatisticsCallback* const rtcp_callback_;
   StreamDataCountersCallback* const rtp_callback_;
 };
 
+// Statisticians are found through a flat hash map private to the packet
+// writer. The shared, lock protected map is only consulted the first time a
+// packet for an SSRC is seen, and by readers.
 class ReceiveStatisticsImpl : public ReceiveStatistics,
                               public RtcpStatisticsCallback,
                               public StreamDataCountersCallback {
@@ -126,13 +158,30 @@ class ReceiveStatisticsImpl : public ReceiveStatistics,
   void DataCountersUpdated(const StreamDataCounters& counters,
                            uint32_t ssrc) override;
 
+  // Returns the statistician for |ssrc| from the writer's cache, falling back
+  // to the shared map. Creates it if |create| is true.
+  StreamStatisticianImpl* FindStatisticianForPacket(uint32_t ssrc, bool create)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(packet_race_checker_);
+
   Clock* const clock_;
-  rtc::CriticalSection receive_statistics_lock_;
-  uint32_t last_returned_ssrc_;
-  std::map<uint32_t, StreamStatisticianImpl*> statisticians_;
+  rtc::RaceChecker packet_race_checker_;
+  Uint32HashMap<StreamStatisticianImpl*> packet_statisticians_
+      RTC_GUARDED_BY(packet_race_checker_);
 
-  RtcpStatisticsCallback* rtcp_stats_callback_;
-  StreamDataCountersCallback* rtp_stats_callback_;
+  rtc::CriticalSection receive_statistics_lock_;
+  uint32_t last_returned_ssrc_ RTC_GUARDED_BY(receive_statistics_lock_);
+  std::map<uint32_t, StreamStatisticianImpl*> statisticians_
+      RTC_GUARDED_BY(receive_statistics_lock_);
+
+  // Callbacks are invoked with their lock held, so that unregistering one
+  // waits for calls in progress. The writer only takes |rtp_callback_lock_|,
+  // which readers don't use.
+  rtc::CriticalSection rtcp_callback_lock_;
+  RtcpStatisticsCallback* rtcp_stats_callback_
+      RTC_GUARDED_BY(rtcp_callback_lock_);
+  rtc::CriticalSection rtp_callback_lock_;
+  StreamDataCountersCallback* rtp_stats_callback_
+      RTC_GUARDED_BY(rtp_callback_lock_);
 };
 }  // namespace webrtc
 #endif  // MODULES_RTP_RTCP_SOURCE_RECEIVE_STATISTICS_IMPL_H_
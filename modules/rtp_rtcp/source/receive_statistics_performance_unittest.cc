@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modules/rtp_rtcp/include/receive_statistics.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumStreams = 32;
+constexpr int kNumRounds = 20000;
+constexpr int kQuickNumRounds = 500;
+constexpr size_t kPacketSize = 1200;
+
+uint32_t SsrcForStream(int index) {
+  return 0x1000 + 131 * index;
+}
+
+// Polls all the getters that stats collection and the RTCP sender use, in
+// bursts, until stopped.
+class StatsReader {
+ public:
+  StatsReader(ReceiveStatistics* receive_statistics, rtc::Event* stop)
+      : receive_statistics_(receive_statistics),
+        stop_(stop),
+        thread_(&StatsReader::Run, this, "StatsReader") {}
+
+  void Start() { thread_.Start(); }
+  void Stop() { thread_.Stop(); }
+  int64_t num_reads() const { return num_reads_; }
+
+ private:
+  static void Run(void* obj) { static_cast<StatsReader*>(obj)->Poll(); }
+
+  void Poll() {
+    // The pause between bursts keeps readers from starving the writer if
+    // they get a higher scheduling priority.
+    do {
+      for (int burst = 0; burst < 10; ++burst) {
+        receive_statistics_->RtcpReportBlocks(31);
+        for (int i = 0; i < kNumStreams; ++i) {
+          StreamStatistician* statistician =
+              receive_statistics_->GetStatistician(SsrcForStream(i));
+          if (!statistician)
+            continue;
+          RtcpStatistics rtcp_stats;
+          StreamDataCounters counters;
+          statistician->GetStatistics(&rtcp_stats, /*reset=*/false);
+          statistician->GetReceiveStreamDataCounters(&counters);
+          statistician->BitrateReceived();
+          ++num_reads_;
+        }
+      }
+    } while (!stop_->Wait(1));
+  }
+
+  ReceiveStatistics* const receive_statistics_;
+  rtc::Event* const stop_;
+  rtc::PlatformThread thread_;
+  int64_t num_reads_ = 0;
+};
+
+// Feeds packets for |kNumStreams| interleaved streams while |num_readers|
+// threads poll the statistics. Returns the average time per packet in
+// nanoseconds and the number of reads made by all readers.
+double RunWriter(int num_readers, int64_t* num_reads) {
+  std::unique_ptr<ReceiveStatistics> receive_statistics(
+      ReceiveStatistics::Create(Clock::GetRealTimeClock()));
+  std::vector<RTPHeader> headers(kNumStreams);
+  for (int i = 0; i < kNumStreams; ++i) {
+    headers[i].ssrc = SsrcForStream(i);
+    headers[i].sequenceNumber = 1;
+    headers[i].headerLength = 12;
+    headers[i].payload_type_frequency = 90000;
+    // Create all statisticians before measuring.
+    receive_statistics->IncomingPacket(headers[i], kPacketSize);
+  }
+
+  rtc::Event stop(/*manual_reset=*/true, /*initially_signaled=*/false);
+  std::vector<std::unique_ptr<StatsReader>> readers;
+  for (int i = 0; i < num_readers; ++i) {
+    readers.emplace_back(new StatsReader(receive_statistics.get(), &stop));
+    readers.back()->Start();
+  }
+
+  const int rounds = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                         ? kQuickNumRounds
+                         : kNumRounds;
+  int64_t start_ns = rtc::TimeNanos();
+  for (int round = 0; round < rounds; ++round) {
+    for (RTPHeader& header : headers) {
+      ++header.sequenceNumber;
+      header.timestamp += 3000;
+      receive_statistics->IncomingPacket(header, kPacketSize);
+    }
+  }
+  const double ns_per_packet =
+      static_cast<double>(rtc::TimeNanos() - start_ns) / (rounds * kNumStreams);
+
+  stop.Set();
+  *num_reads = 0;
+  for (auto& reader : readers) {
+    reader->Stop();
+    *num_reads += reader->num_reads();
+  }
+  return ns_per_packet;
+}
+
+void RunAndReport(int num_readers, const std::string& trace) {
+  int64_t num_reads = 0;
+  double ns_per_packet = RunWriter(num_readers, &num_reads);
+  test::PrintResult("receive_statistics_incoming_packet", "", trace,
+                    ns_per_packet, "ns", true);
+  if (num_readers > 0) {
+    test::PrintResult("receive_statistics_stream_reads", "", trace,
+                      static_cast<double>(num_reads), "count", false);
+  }
+}
+
+}  // namespace
+
+TEST(ReceiveStatisticsPerformanceTest, IncomingPacketWithoutReaders) {
+  RunAndReport(0, "no_readers");
+}
+
+TEST(ReceiveStatisticsPerformanceTest, IncomingPacketWithFourReaders) {
+  RunAndReport(4, "4_readers");
+}
+
+}  // namespace webrtc
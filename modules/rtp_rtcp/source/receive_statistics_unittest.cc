@@ -12,6 +12,8 @@
 #include <vector>
 
 #include "modules/rtp_rtcp/include/receive_statistics.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
 #include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -428,5 +430,142 @@ TEST_F(ReceiveStatisticsTest, RtpCallbacksFecFirst) {
   callback.Matches(2, kSsrc1, expected);
 }
 
+TEST_F(ReceiveStatisticsTest, CountsFecOnStatisticianCreatedBeforeFirstPacket) {
+  receive_statistics_->EnableRetransmitDetection(kSsrc1, true);
+  StreamStatistician* statistician =
+      receive_statistics_->GetStatistician(kSsrc1);
+  ASSERT_TRUE(statistician != nullptr);
+
+  receive_statistics_->FecPacketReceived(header1_, kPacketSize1);
+  receive_statistics_->IncomingPacket(header1_, kPacketSize1);
+  EXPECT_EQ(statistician, receive_statistics_->GetStatistician(kSsrc1));
+
+  StreamDataCounters counters;
+  statistician->GetReceiveStreamDataCounters(&counters);
+  EXPECT_EQ(1u, counters.fec.packets);
+  EXPECT_EQ(1u, counters.transmitted.packets);
+}
+
+TEST_F(ReceiveStatisticsTest, BitrateReceivedDropsToZeroWithoutPackets) {
+  receive_statistics_->IncomingPacket(header1_, kPacketSize1);
+  ++header1_.sequenceNumber;
+  clock_.AdvanceTimeMilliseconds(100);
+  receive_statistics_->IncomingPacket(header1_, kPacketSize1);
+  StreamStatistician* statistician =
+      receive_statistics_->GetStatistician(kSsrc1);
+  ASSERT_TRUE(statistician != nullptr);
+  EXPECT_GT(statistician->BitrateReceived(), 0u);
+
+  clock_.AdvanceTimeMilliseconds(1000);
+  EXPECT_EQ(0u, statistician->BitrateReceived());
+}
+
+struct ConcurrentReader {
+  ReceiveStatistics* receive_statistics;
+  rtc::Event* stop;
+  int inconsistent_reads = 0;
+};
+
+void ReadCountersUntilStopped(void* obj) {
+  ConcurrentReader* reader = static_cast<ConcurrentReader*>(obj);
+  do {
+    for (int i = 0; i < 100; ++i) {
+      reader->receive_statistics->RtcpReportBlocks(1);
+      StreamStatistician* statistician =
+          reader->receive_statistics->GetStatistician(kSsrc1);
+      if (!statistician)
+        continue;
+      StreamDataCounters counters;
+      statistician->GetReceiveStreamDataCounters(&counters);
+      if (counters.transmitted.payload_bytes !=
+          counters.transmitted.packets * kPacketSize1) {
+        ++reader->inconsistent_reads;
+      }
+    }
+  } while (!reader->stop->Wait(1));
+}
+
+TEST_F(ReceiveStatisticsTest, ConcurrentReadersSeeConsistentCounters) {
+  constexpr int kNumReaders = 4;
+  rtc::Event stop(/*manual_reset=*/true, /*initially_signaled=*/false);
+  std::vector<std::unique_ptr<ConcurrentReader>> readers;
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumReaders; ++i) {
+    readers.emplace_back(new ConcurrentReader());
+    readers.back()->receive_statistics = receive_statistics_.get();
+    readers.back()->stop = &stop;
+    threads.emplace_back(new rtc::PlatformThread(
+        &ReadCountersUntilStopped, readers.back().get(), "StatsReader"));
+    threads.back()->Start();
+  }
+
+  for (int i = 0; i < 20000; ++i) {
+    receive_statistics_->IncomingPacket(header1_, kPacketSize1);
+    ++header1_.sequenceNumber;
+    header1_.timestamp += 3000;
+  }
+
+  stop.Set();
+  for (int i = 0; i < kNumReaders; ++i) {
+    threads[i]->Stop();
+    EXPECT_EQ(0, readers[i]->inconsistent_reads);
+  }
+  uint32_t packets_received = 0;
+  receive_statistics_->GetStatistician(kSsrc1)->GetDataCounters(
+      nullptr, &packets_received);
+  EXPECT_EQ(20000u, packets_received);
+}
+
+// Blocks in DataCountersUpdated() until released.
+class BlockingRtpCallback : public StreamDataCountersCallback {
+ public:
+  void DataCountersUpdated(const StreamDataCounters& counters,
+                           uint32_t ssrc) override {
+    entered.Set();
+    release.Wait(rtc::Event::kForever);
+  }
+
+  rtc::Event entered{false, false};
+  rtc::Event release{false, false};
+};
+
+struct CallbackTestState {
+  ReceiveStatistics* receive_statistics;
+  RTPHeader header;
+  rtc::Event unregistered{false, false};
+};
+
+void DeliverPacket(void* obj) {
+  CallbackTestState* state = static_cast<CallbackTestState*>(obj);
+  state->receive_statistics->IncomingPacket(state->header, kPacketSize1);
+}
+
+void UnregisterRtpCallback(void* obj) {
+  CallbackTestState* state = static_cast<CallbackTestState*>(obj);
+  state->receive_statistics->RegisterRtpStatisticsCallback(nullptr);
+  state->unregistered.Set();
+}
+
+TEST_F(ReceiveStatisticsTest, UnregisteringWaitsForCallbackInProgress) {
+  BlockingRtpCallback callback;
+  receive_statistics_->RegisterRtpStatisticsCallback(&callback);
+  CallbackTestState state;
+  state.receive_statistics = receive_statistics_.get();
+  state.header = header1_;
+
+  rtc::PlatformThread packet_thread(&DeliverPacket, &state, "Packet");
+  packet_thread.Start();
+  ASSERT_TRUE(callback.entered.Wait(1000));
+  rtc::PlatformThread unregister_thread(&UnregisterRtpCallback, &state,
+                                        "Unregister");
+  unregister_thread.Start();
+  // The callback must stay registered while it runs.
+  EXPECT_FALSE(state.unregistered.Wait(50));
+  callback.release.Set();
+  EXPECT_TRUE(state.unregistered.Wait(1000));
+  packet_thread.Stop();
+  unregister_thread.Stop();
+}
+
 }  // namespace
 }  // namespace webrtc
@@ -58,6 +58,15 @@ bool RtcpTransceiverConfig::Validate() const {
                       << "ms between reports should be positive.";
     return false;
   }
+  if (max_feedback_delay_ms < 0) {
+    RTC_LOG(LS_ERROR) << debug_id << "feedback delay " << max_feedback_delay_ms
+                      << "ms shouldn't be negative.";
+    return false;
+  }
+  if (max_feedback_delay_ms > 0 && !task_queue) {
+    RTC_LOG(LS_ERROR) << debug_id << "missing task queue for delayed feedback";
+    return false;
+  }
   if (schedule_periodic_compound_packets && !task_queue) {
     RTC_LOG(LS_ERROR) << debug_id
                       << "missing task queue for periodic compound packets";
@@ -90,6 +90,20 @@ struct RtcpTransceiverConfig {
   // Period between periodic compound packets.
   int report_period_ms = 1000;
 
+  // Maximum number of report blocks to include in a compound packet. When more
+  // than 31 (the most a single receiver report can carry) are allowed, several
+  // receiver reports are stacked, so that one periodic packet reports on many
+  // remote streams. Streams that do not fit are reported in later packets.
+  size_t max_report_blocks = 31;
+
+  // If positive, NACK, PLI and FIR requests are not sent right away, but
+  // collected for up to this many milliseconds and then sent for all media
+  // ssrcs together in as few packets as |max_packet_size| allows. Pending
+  // requests are also sent along with any compound packet sent before that.
+  // A packet that is nacked again while pending is nacked only once.
+  // Requires |task_queue|.
+  int max_feedback_delay_ms = 0;
+
   //
   // Flags for features and experiments.
   //
@@ -10,6 +10,9 @@
 
 #include "modules/rtp_rtcp/source/rtcp_transceiver_impl.h"
 
+#include <algorithm>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #include "absl/memory/memory.h"
@@ -43,6 +46,31 @@ struct SenderReportTimes {
   NtpTime remote_sent_time;
 };
 
+// Runs |closure| once unless canceled before.
+template <typename Closure>
+class CancelableOneShotTask final : public rtc::BaseCancelableTask {
+ public:
+  explicit CancelableOneShotTask(Closure&& closure)
+      : closure_(std::forward<Closure>(closure)) {}
+
+ private:
+  bool Run() override {
+    if (!Canceled())
+      closure_();
+    return true;
+  }
+
+  typename std::remove_const<
+      typename std::remove_reference<Closure>::type>::type closure_;
+};
+
+template <typename Closure>
+std::unique_ptr<rtc::BaseCancelableTask> CreateCancelableOneShotTask(
+    Closure&& closure) {
+  return absl::make_unique<CancelableOneShotTask<Closure>>(
+      std::forward<Closure>(closure));
+}
+
 }  // namespace
 
 struct RtcpTransceiverImpl::RemoteSenderState {
@@ -53,8 +81,6 @@ struct RtcpTransceiverImpl::RemoteSenderState {
 
 // Helper to put several RTCP packets into lower layer datagram composing
 // Compound or Reduced-Size RTCP packet, as defined by RFC 5506 section 2.
-// TODO(danilchap): When in compound mode and packets are so many that several
-// compound RTCP packets need to be generated, ensure each packet is compound.
 class RtcpTransceiverImpl::PacketSender {
  public:
   PacketSender(rtcp::RtcpPacket::PacketReadyCallback callback,
@@ -67,9 +93,23 @@ class RtcpTransceiverImpl::PacketSender {
   // Appends a packet to pending compound packet.
   // Sends rtcp compound packet if buffer was already full and resets buffer.
   void AppendPacket(const rtcp::RtcpPacket& packet) {
+    if (compound_prefix_ && index_ > 0 &&
+        index_ + packet.BlockLength() > max_packet_size_) {
+      // Start the next datagram with a receiver report to keep it compound.
+      Send();
+      compound_prefix_->Create(buffer_, &index_, max_packet_size_, callback_);
+    }
     packet.Create(buffer_, &index_, max_packet_size_, callback_);
   }
 
+  // Once called, every datagram that has to be started for packets appended
+  // later begins with an empty receiver report from |sender_ssrc|, so that
+  // each of them is a valid compound packet.
+  void KeepCompound(uint32_t sender_ssrc) {
+    compound_prefix_.emplace();
+    compound_prefix_->SetSenderSsrc(sender_ssrc);
+  }
+
   // Sends pending rtcp compound packet.
   void Send() {
     if (index_ > 0) {
@@ -83,6 +123,7 @@ class RtcpTransceiverImpl::PacketSender {
  private:
   const rtcp::RtcpPacket::PacketReadyCallback callback_;
   const size_t max_packet_size_;
+  absl::optional<rtcp::ReceiverReport> compound_prefix_;
   size_t index_ = 0;
   uint8_t buffer_[IP_PACKET_SIZE];
 };
@@ -99,6 +140,7 @@ RtcpTransceiverImpl::~RtcpTransceiverImpl() {
   // after TaskQueue. In that case there is no need to Cancel periodic task.
   if (config_.task_queue == rtc::TaskQueue::Current()) {
     periodic_task_handle_.Cancel();
+    pending_feedback_task_handle_.Cancel();
   }
 }
 
@@ -124,6 +166,14 @@ void RtcpTransceiverImpl::RemoveMediaReceiverRtcpObserver(
 }
 
 void RtcpTransceiverImpl::SetReadyToSend(bool ready) {
+  if (ready_to_send_ && !ready && pending_feedback_scheduled_) {
+    // Feedback is time sensitive, there is no point to send it late.
+    pending_feedback_task_handle_.Cancel();
+    pending_feedback_scheduled_ = false;
+    pending_nacks_.clear();
+    pending_plis_.clear();
+    pending_fir_requests_.clear();
+  }
   if (config_.schedule_periodic_compound_packets) {
     if (ready_to_send_ && !ready)
       periodic_task_handle_.Cancel();
@@ -185,6 +235,13 @@ void RtcpTransceiverImpl::SendNack(uint32_t ssrc,
   RTC_DCHECK(!sequence_numbers.empty());
   if (!ready_to_send_)
     return;
+  if (config_.max_feedback_delay_ms > 0) {
+    // Packets that are already waiting to be nacked are not nacked twice.
+    pending_nacks_[ssrc].insert(sequence_numbers.begin(),
+                                sequence_numbers.end());
+    ScheduleSendPendingFeedback();
+    return;
+  }
   rtcp::Nack nack;
   nack.SetSenderSsrc(config_.feedback_ssrc);
   nack.SetMediaSsrc(ssrc);
@@ -195,6 +252,13 @@ void RtcpTransceiverImpl::SendNack(uint32_t ssrc,
 void RtcpTransceiverImpl::SendPictureLossIndication(uint32_t ssrc) {
   if (!ready_to_send_)
     return;
+  if (config_.max_feedback_delay_ms > 0) {
+    if (std::find(pending_plis_.begin(), pending_plis_.end(), ssrc) ==
+        pending_plis_.end())
+      pending_plis_.push_back(ssrc);
+    ScheduleSendPendingFeedback();
+    return;
+  }
   rtcp::Pli pli;
   pli.SetSenderSsrc(config_.feedback_ssrc);
   pli.SetMediaSsrc(ssrc);
@@ -206,6 +270,13 @@ void RtcpTransceiverImpl::SendFullIntraRequest(
   RTC_DCHECK(!ssrcs.empty());
   if (!ready_to_send_)
     return;
+  if (config_.max_feedback_delay_ms > 0) {
+    for (uint32_t media_ssrc : ssrcs)
+      pending_fir_requests_.emplace_back(
+          media_ssrc, remote_senders_[media_ssrc].fir_sequence_number++);
+    ScheduleSendPendingFeedback();
+    return;
+  }
   rtcp::Fir fir;
   fir.SetSenderSsrc(config_.feedback_ssrc);
   for (uint32_t media_ssrc : ssrcs)
@@ -347,10 +418,22 @@ void RtcpTransceiverImpl::CreateCompoundPacket(PacketSender* sender) {
   RTC_DCHECK(sender->IsEmpty());
   const uint32_t sender_ssrc = config_.feedback_ssrc;
   int64_t now_us = rtc::TimeMicros();
-  rtcp::ReceiverReport receiver_report;
-  receiver_report.SetSenderSsrc(sender_ssrc);
-  receiver_report.SetReportBlocks(CreateReportBlocks(now_us));
-  sender->AppendPacket(receiver_report);
+  // A receiver report carries a limited number of report blocks, stack several
+  // when there are more. Send at least one to make the packet compound.
+  std::vector<rtcp::ReportBlock> report_blocks = CreateReportBlocks(now_us);
+  auto report_blocks_it = report_blocks.begin();
+  do {
+    size_t num_blocks =
+        std::min<size_t>(report_blocks.end() - report_blocks_it,
+                         rtcp::ReceiverReport::kMaxNumberOfReportBlocks);
+    rtcp::ReceiverReport receiver_report;
+    receiver_report.SetSenderSsrc(sender_ssrc);
+    receiver_report.SetReportBlocks(std::vector<rtcp::ReportBlock>(
+        report_blocks_it, report_blocks_it + num_blocks));
+    sender->AppendPacket(receiver_report);
+    report_blocks_it += num_blocks;
+  } while (report_blocks_it != report_blocks.end());
+  sender->KeepCompound(sender_ssrc);
 
   if (!config_.cname.empty()) {
     rtcp::Sdes sdes;
@@ -384,6 +467,7 @@ void RtcpTransceiverImpl::SendPeriodicCompoundPacket() {
   };
   PacketSender sender(send_packet, config_.max_packet_size);
   CreateCompoundPacket(&sender);
+  AppendPendingFeedback(&sender);
   sender.Send();
 }
 
@@ -406,15 +490,76 @@ void RtcpTransceiverImpl::SendImmediateFeedback(
     ReschedulePeriodicCompoundPackets();
 }
 
+void RtcpTransceiverImpl::ScheduleSendPendingFeedback() {
+  if (pending_feedback_scheduled_)
+    return;
+  pending_feedback_scheduled_ = true;
+  auto task = CreateCancelableOneShotTask([this] {
+    RTC_DCHECK(ready_to_send_);
+    SendPendingFeedback();
+  });
+  pending_feedback_task_handle_ = task->GetCancellationHandle();
+  config_.task_queue->PostDelayedTask(std::move(task),
+                                      config_.max_feedback_delay_ms);
+}
+
+void RtcpTransceiverImpl::SendPendingFeedback() {
+  auto send_packet = [this](rtc::ArrayView<const uint8_t> packet) {
+    config_.outgoing_transport->SendRtcp(packet.data(), packet.size());
+  };
+  PacketSender sender(send_packet, config_.max_packet_size);
+  if (config_.rtcp_mode == RtcpMode::kCompound)
+    CreateCompoundPacket(&sender);
+  AppendPendingFeedback(&sender);
+  sender.Send();
+
+  if (config_.rtcp_mode == RtcpMode::kCompound)
+    ReschedulePeriodicCompoundPackets();
+}
+
+void RtcpTransceiverImpl::AppendPendingFeedback(PacketSender* sender) {
+  if (!pending_feedback_scheduled_)
+    return;
+  // Feedback is sent now, so the scheduled task has nothing left to do.
+  pending_feedback_task_handle_.Cancel();
+  pending_feedback_scheduled_ = false;
+
+  const uint32_t sender_ssrc = config_.feedback_ssrc;
+  for (const auto& media_ssrc_and_nacks : pending_nacks_) {
+    const auto& sequence_numbers = media_ssrc_and_nacks.second;
+    rtcp::Nack nack;
+    nack.SetSenderSsrc(sender_ssrc);
+    nack.SetMediaSsrc(media_ssrc_and_nacks.first);
+    nack.SetPacketIds(std::vector<uint16_t>(sequence_numbers.begin(),
+                                            sequence_numbers.end()));
+    sender->AppendPacket(nack);
+  }
+  pending_nacks_.clear();
+
+  for (uint32_t media_ssrc : pending_plis_) {
+    rtcp::Pli pli;
+    pli.SetSenderSsrc(sender_ssrc);
+    pli.SetMediaSsrc(media_ssrc);
+    sender->AppendPacket(pli);
+  }
+  pending_plis_.clear();
+
+  if (!pending_fir_requests_.empty()) {
+    rtcp::Fir fir;
+    fir.SetSenderSsrc(sender_ssrc);
+    for (const rtcp::Fir::Request& request : pending_fir_requests_)
+      fir.AddRequestTo(request.ssrc, request.seq_nr);
+    sender->AppendPacket(fir);
+    pending_fir_requests_.clear();
+  }
+}
+
 std::vector<rtcp::ReportBlock> RtcpTransceiverImpl::CreateReportBlocks(
     int64_t now_us) {
   if (!config_.receive_statistics)
     return {};
-  // TODO(danilchap): Support sending more than
-  // |ReceiverReport::kMaxNumberOfReportBlocks| per compound rtcp packet.
   std::vector<rtcp::ReportBlock> report_blocks =
-      config_.receive_statistics->RtcpReportBlocks(
-          rtcp::ReceiverReport::kMaxNumberOfReportBlocks);
+      config_.receive_statistics->RtcpReportBlocks(config_.max_report_blocks);
   uint32_t last_sr = 0;
   uint32_t last_delay = 0;
   for (rtcp::ReportBlock& report_block : report_blocks) {
@@ -13,6 +13,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -20,16 +21,21 @@
 #include "api/array_view.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/dlrr.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/fir.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/remb.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/target_bitrate.h"
 #include "modules/rtp_rtcp/source/rtcp_transceiver_config.h"
 #include "rtc_base/cancelable_task_handle.h"
+#include "rtc_base/numerics/sequence_number_util.h"
 #include "system_wrappers/include/ntp_time.h"
 
 namespace webrtc {
 //
 // Manage incoming and outgoing rtcp messages for multiple BUNDLED streams.
+// Report blocks, REMB and (optionally, see
+// RtcpTransceiverConfig::max_feedback_delay_ms) NACK, PLI and FIR for all
+// streams are aggregated into shared compound or reduced-size packets.
 //
 // This class is not thread-safe.
 class RtcpTransceiverImpl {
@@ -86,6 +92,11 @@ class RtcpTransceiverImpl {
   // Sends RTCP packets.
   void SendPeriodicCompoundPacket();
   void SendImmediateFeedback(const rtcp::RtcpPacket& rtcp_packet);
+  // Used when feedback is delayed, see config_.max_feedback_delay_ms.
+  void ScheduleSendPendingFeedback();
+  void SendPendingFeedback();
+  // Appends and clears all queued feedback.
+  void AppendPendingFeedback(PacketSender* sender);
   // Generate Report Blocks to be send in Sender or Receiver Report.
   std::vector<rtcp::ReportBlock> CreateReportBlocks(int64_t now_us);
 
@@ -97,6 +108,15 @@ class RtcpTransceiverImpl {
   // needed.
   std::map<uint32_t, RemoteSenderState> remote_senders_;
   rtc::CancelableTaskHandle periodic_task_handle_;
+
+  // Feedback waiting to be sent together, keyed by media ssrc. The nacked
+  // sequence numbers are kept oldest first, as NackModule lists them.
+  std::map<uint32_t, std::set<uint16_t, DescendingSeqNumComp<uint16_t>>>
+      pending_nacks_;
+  std::vector<uint32_t> pending_plis_;
+  std::vector<rtcp::Fir::Request> pending_fir_requests_;
+  bool pending_feedback_scheduled_ = false;
+  rtc::CancelableTaskHandle pending_feedback_task_handle_;
 };
 
 }  // namespace webrtc
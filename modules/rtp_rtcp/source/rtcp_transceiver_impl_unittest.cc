@@ -18,7 +18,11 @@
 #include "modules/rtp_rtcp/mocks/mock_rtcp_rtt_stats.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/app.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/bye.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
 #include "modules/rtp_rtcp/source/rtcp_packet/compound_packet.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/nack.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/pli.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
 #include "modules/rtp_rtcp/source/time_util.h"
 #include "rtc_base/event.h"
 #include "rtc_base/fakeclock.h"
@@ -47,7 +51,11 @@ using ::webrtc::RtcpTransceiverImpl;
 using ::webrtc::SaturatedUsToCompactNtp;
 using ::webrtc::TimeMicrosToNtp;
 using ::webrtc::rtcp::Bye;
+using ::webrtc::rtcp::CommonHeader;
 using ::webrtc::rtcp::CompoundPacket;
+using ::webrtc::rtcp::Nack;
+using ::webrtc::rtcp::Pli;
+using ::webrtc::rtcp::ReceiverReport;
 using ::webrtc::rtcp::ReportBlock;
 using ::webrtc::rtcp::SenderReport;
 using ::webrtc::test::RtcpPacketParser;
@@ -124,6 +132,60 @@ class RtcpParserTransport : public webrtc::Transport {
   int num_packets_ = 0;
 };
 
+// Counts datagrams and some of the rtcp packets inside them, and records
+// whether every datagram was a compound packet.
+class RtcpCountingTransport : public webrtc::Transport {
+ public:
+  RtcpCountingTransport() : sent_rtcp_(false, false) {}
+
+  int num_datagrams() const { return num_datagrams_; }
+  int num_report_blocks() const { return num_report_blocks_; }
+  int num_nacks() const { return num_nacks_; }
+  int num_plis() const { return num_plis_; }
+  bool all_compound() const { return all_compound_; }
+
+  bool WaitPacket() { return sent_rtcp_.Wait(kAlmostForeverMs); }
+
+ private:
+  bool SendRtcp(const uint8_t* data, size_t size) override {
+    ++num_datagrams_;
+    bool first = true;
+    CommonHeader header;
+    for (const uint8_t* next = data; next != data + size;
+         next = header.NextPacket()) {
+      EXPECT_TRUE(header.Parse(next, data + size - next));
+      if (first && header.type() != ReceiverReport::kPacketType)
+        all_compound_ = false;
+      first = false;
+      if (header.type() == ReceiverReport::kPacketType) {
+        ReceiverReport receiver_report;
+        EXPECT_TRUE(receiver_report.Parse(header));
+        num_report_blocks_ += receiver_report.report_blocks().size();
+      } else if (header.type() == Nack::kPacketType &&
+                 header.fmt() == Nack::kFeedbackMessageType) {
+        ++num_nacks_;
+      } else if (header.type() == Pli::kPacketType &&
+                 header.fmt() == Pli::kFeedbackMessageType) {
+        ++num_plis_;
+      }
+    }
+    sent_rtcp_.Set();
+    return true;
+  }
+
+  bool SendRtp(const uint8_t*, size_t, const webrtc::PacketOptions&) override {
+    ADD_FAILURE() << "RtcpTransciver shouldn't send rtp packets.";
+    return true;
+  }
+
+  rtc::Event sent_rtcp_;
+  int num_datagrams_ = 0;
+  int num_report_blocks_ = 0;
+  int num_nacks_ = 0;
+  int num_plis_ = 0;
+  bool all_compound_ = true;
+};
+
 RtcpTransceiverConfig DefaultTestConfig() {
   // RtcpTransceiverConfig default constructor sets default values for prod.
   // Test doesn't need to support all key features: Default test config returns
@@ -1012,4 +1074,238 @@ TEST(RtcpTransceiverImplTest, IgnoresUnknownSsrcInDlrr) {
   rtcp_transceiver.ReceivePacket(raw_packet, time_us + 100000);
 }
 
+std::vector<ReportBlock> CreateReportBlocks(size_t num_blocks) {
+  std::vector<ReportBlock> report_blocks(num_blocks);
+  for (size_t i = 0; i < num_blocks; ++i)
+    report_blocks[i].SetMediaSsrc(1000 + i);
+  return report_blocks;
+}
+
+TEST(RtcpTransceiverImplTest, StacksReceiverReportsForManyRemoteStreams) {
+  const size_t kNumRemoteStreams = 200;
+  MockReceiveStatisticsProvider receive_statistics;
+  EXPECT_CALL(receive_statistics, RtcpReportBlocks(kNumRemoteStreams))
+      .WillOnce(Return(CreateReportBlocks(kNumRemoteStreams)));
+  RtcpCountingTransport transport;
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.receive_statistics = &receive_statistics;
+  config.max_report_blocks = kNumRemoteStreams;
+  RtcpTransceiverImpl rtcp_transceiver(config);
+
+  rtcp_transceiver.SendCompoundPacket();
+
+  EXPECT_EQ(transport.num_report_blocks(),
+            static_cast<int>(kNumRemoteStreams));
+  // A receiver report with 31 report blocks takes 752 bytes, so only one of
+  // those fits into a 1200 bytes datagram. The last receiver report, with the
+  // remaining 14 blocks, shares a datagram with one of them.
+  EXPECT_EQ(transport.num_datagrams(), 6);
+  EXPECT_TRUE(transport.all_compound());
+}
+
+TEST(RtcpTransceiverImplTest, EveryDatagramIsCompoundWhenFeedbackOverflows) {
+  const uint32_t kNumRemoteStreams = 200;
+  RtcpCountingTransport transport;
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.rtcp_mode = webrtc::RtcpMode::kCompound;
+  // Large enough to exercise the queuing, the task itself never runs.
+  config.max_feedback_delay_ms = 1000;
+  rtc::TaskQueue queue("rtcp");
+  config.task_queue = &queue;
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    RtcpTransceiverImpl rtcp_transceiver(config);
+    for (uint32_t ssrc = 0; ssrc < kNumRemoteStreams; ++ssrc)
+      rtcp_transceiver.SendNack(1000 + ssrc, {1, 2, 3});
+    EXPECT_EQ(transport.num_datagrams(), 0);
+    rtcp_transceiver.SendCompoundPacket();
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(kAlmostForeverMs));
+
+  EXPECT_EQ(transport.num_nacks(), static_cast<int>(kNumRemoteStreams));
+  EXPECT_GT(transport.num_datagrams(), 1);
+  EXPECT_TRUE(transport.all_compound());
+}
+
+TEST(RtcpTransceiverImplTest, MergesDelayedNacksForSameMediaSsrc) {
+  const uint32_t kRemoteSsrc = 4321;
+  RtcpPacketParser rtcp_parser;
+  RtcpParserTransport transport(&rtcp_parser);
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.max_feedback_delay_ms = 1000;
+  rtc::TaskQueue queue("rtcp");
+  config.task_queue = &queue;
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    RtcpTransceiverImpl rtcp_transceiver(config);
+    rtcp_transceiver.SendNack(kRemoteSsrc, {10, 11});
+    rtcp_transceiver.SendNack(kRemoteSsrc, {15});
+    rtcp_transceiver.SendCompoundPacket();
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(kAlmostForeverMs));
+
+  EXPECT_EQ(transport.num_packets(), 1);
+  EXPECT_EQ(rtcp_parser.nack()->num_packets(), 1);
+  EXPECT_EQ(rtcp_parser.nack()->media_ssrc(), kRemoteSsrc);
+  EXPECT_THAT(rtcp_parser.nack()->packet_ids(), ElementsAre(10, 11, 15));
+}
+
+TEST(RtcpTransceiverImplTest, DelayedNacksDoNotRepeatPendingSequenceNumbers) {
+  const uint32_t kRemoteSsrc = 4321;
+  RtcpPacketParser rtcp_parser;
+  RtcpParserTransport transport(&rtcp_parser);
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.max_feedback_delay_ms = 1000;
+  rtc::TaskQueue queue("rtcp");
+  config.task_queue = &queue;
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    RtcpTransceiverImpl rtcp_transceiver(config);
+    rtcp_transceiver.SendNack(kRemoteSsrc, {10, 11});
+    rtcp_transceiver.SendNack(kRemoteSsrc, {11, 12});
+    rtcp_transceiver.SendCompoundPacket();
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(kAlmostForeverMs));
+
+  EXPECT_EQ(rtcp_parser.nack()->num_packets(), 1);
+  EXPECT_THAT(rtcp_parser.nack()->packet_ids(), ElementsAre(10, 11, 12));
+}
+
+TEST(RtcpTransceiverImplTest, DelayedNacksAreSentInSequenceNumberOrder) {
+  const uint32_t kRemoteSsrc = 4321;
+  RtcpPacketParser rtcp_parser;
+  RtcpParserTransport transport(&rtcp_parser);
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.max_feedback_delay_ms = 1000;
+  rtc::TaskQueue queue("rtcp");
+  config.task_queue = &queue;
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    RtcpTransceiverImpl rtcp_transceiver(config);
+    rtcp_transceiver.SendNack(kRemoteSsrc, {15, 11});
+    rtcp_transceiver.SendNack(kRemoteSsrc, {2, 0xffff, 12});
+    rtcp_transceiver.SendCompoundPacket();
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(kAlmostForeverMs));
+
+  EXPECT_EQ(rtcp_parser.nack()->num_packets(), 1);
+  EXPECT_THAT(rtcp_parser.nack()->packet_ids(),
+              ElementsAre(0xffff, 2, 11, 12, 15));
+}
+
+TEST(RtcpTransceiverImplTest, SendsDelayedFeedbackOnceAfterDelay) {
+  const uint32_t kRemoteSsrc = 4321;
+  RtcpPacketParser rtcp_parser;
+  RtcpParserTransport transport(&rtcp_parser);
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.rtcp_mode = webrtc::RtcpMode::kReducedSize;
+  config.schedule_periodic_compound_packets = false;
+  config.max_feedback_delay_ms = 10;
+  rtc::TaskQueue queue("rtcp");
+  config.task_queue = &queue;
+  absl::optional<RtcpTransceiverImpl> rtcp_transceiver;
+
+  queue.PostTask([&] {
+    rtcp_transceiver.emplace(config);
+    rtcp_transceiver->SendPictureLossIndication(kRemoteSsrc);
+  });
+  // Wait for several delays to check the pending feedback task does not
+  // repeat itself.
+  rtc::Event waiter(false, false);
+  waiter.Wait(10 * config.max_feedback_delay_ms);
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    rtcp_transceiver.reset();
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(kAlmostForeverMs));
+  EXPECT_EQ(transport.num_packets(), 1);
+  EXPECT_EQ(rtcp_parser.pli()->num_packets(), 1);
+}
+
+TEST(RtcpTransceiverImplTest, DropsDelayedFeedbackWhenTransportGoesDown) {
+  const uint32_t kRemoteSsrc = 4321;
+  RtcpPacketParser rtcp_parser;
+  RtcpParserTransport transport(&rtcp_parser);
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.max_feedback_delay_ms = 1000;
+  rtc::TaskQueue queue("rtcp");
+  config.task_queue = &queue;
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    RtcpTransceiverImpl rtcp_transceiver(config);
+    rtcp_transceiver.SendPictureLossIndication(kRemoteSsrc);
+    rtcp_transceiver.SendPictureLossIndication(kRemoteSsrc);
+    rtcp_transceiver.SetReadyToSend(false);
+    rtcp_transceiver.SetReadyToSend(true);
+    rtcp_transceiver.SendCompoundPacket();
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(kAlmostForeverMs));
+
+  // Feedback queued before the transport went down is dropped.
+  EXPECT_EQ(transport.num_packets(), 1);
+  EXPECT_EQ(rtcp_parser.pli()->num_packets(), 0);
+}
+
+// Measures how many datagrams are needed to send one NACK and one PLI for each
+// of many remote streams, with and without aggregation.
+int NumDatagramsForFeedback(webrtc::RtcpMode rtcp_mode,
+                            int max_feedback_delay_ms) {
+  const uint32_t kNumRemoteStreams = 200;
+  rtc::TaskQueue queue("rtcp");
+  RtcpCountingTransport transport;
+  RtcpTransceiverConfig config = DefaultTestConfig();
+  config.outgoing_transport = &transport;
+  config.rtcp_mode = rtcp_mode;
+  config.max_feedback_delay_ms = max_feedback_delay_ms;
+  config.task_queue = &queue;
+  absl::optional<RtcpTransceiverImpl> rtcp_transceiver;
+
+  queue.PostTask([&] {
+    rtcp_transceiver.emplace(config);
+    for (uint32_t ssrc = 0; ssrc < kNumRemoteStreams; ++ssrc) {
+      rtcp_transceiver->SendNack(1000 + ssrc, {1, 5, 9});
+      rtcp_transceiver->SendPictureLossIndication(1000 + ssrc);
+    }
+  });
+  EXPECT_TRUE(transport.WaitPacket());
+
+  rtc::Event done(false, false);
+  queue.PostTask([&] {
+    rtcp_transceiver.reset();
+    done.Set();
+  });
+  EXPECT_TRUE(done.Wait(kAlmostForeverMs));
+  EXPECT_EQ(transport.num_nacks(), static_cast<int>(kNumRemoteStreams));
+  EXPECT_EQ(transport.num_plis(), static_cast<int>(kNumRemoteStreams));
+  return transport.num_datagrams();
+}
+
+TEST(RtcpTransceiverImplTest, AggregatedFeedbackReducesNumberOfDatagrams) {
+  // Immediate feedback: one datagram per message.
+  EXPECT_EQ(NumDatagramsForFeedback(webrtc::RtcpMode::kCompound, 0), 400);
+  EXPECT_EQ(NumDatagramsForFeedback(webrtc::RtcpMode::kReducedSize, 0), 400);
+  // 200 NACKs of 16 bytes and 200 PLIs of 12 bytes, 1200 bytes per datagram.
+  EXPECT_LE(NumDatagramsForFeedback(webrtc::RtcpMode::kCompound, 5), 6);
+  EXPECT_LE(NumDatagramsForFeedback(webrtc::RtcpMode::kReducedSize, 5), 5);
+}
+
 }  // namespace
@@ -10,6 +10,8 @@
 
 #include "modules/rtp_rtcp/source/rtp_format.h"
 
+#include <string.h>
+
 #include <utility>
 
 #include "absl/memory/memory.h"
@@ -17,6 +19,7 @@
 #include "modules/rtp_rtcp/source/rtp_format_video_generic.h"
 #include "modules/rtp_rtcp/source/rtp_format_vp8.h"
 #include "modules/rtp_rtcp/source/rtp_format_vp9.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -54,6 +57,25 @@ std::unique_ptr<RtpPacketizer> RtpPacketizer::Create(
   }
 }
 
+void RtpPacketizer::SetPayloadBuffer(rtc::CopyOnWriteBuffer buffer) {
+  payload_buffer_ = std::move(buffer);
+}
+
+uint8_t* RtpPacketizer::WritePayload(RtpPacketToSend* packet,
+                                     size_t header_size,
+                                     rtc::ArrayView<const uint8_t> data) const {
+  const uint8_t* begin = payload_buffer_.cdata();
+  if (!data.empty() && begin != nullptr && data.data() >= begin &&
+      data.data() + data.size() <= begin + payload_buffer_.size()) {
+    return packet->SetPayloadWithReference(
+        header_size, payload_buffer_, data.data() - begin, data.size());
+  }
+  uint8_t* buffer = packet->AllocatePayload(header_size + data.size());
+  if (buffer)
+    memcpy(buffer + header_size, data.data(), data.size());
+  return buffer;
+}
+
 std::vector<int> RtpPacketizer::SplitAboutEqually(
     int payload_len,
     const PayloadSizeLimits& limits) {
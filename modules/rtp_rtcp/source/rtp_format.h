@@ -20,6 +20,7 @@
 #include "modules/include/module_common_types.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/copyonwritebuffer.h"
 
 namespace webrtc {
 class RtpPacketToSend;
@@ -50,10 +51,26 @@ class RtpPacketizer {
   // Returns true on success, false otherwise.
   virtual bool NextPacket(RtpPacketToSend* packet) = 0;
 
+  // Lets the packetizer reference slices of |buffer| from the packets it
+  // produces instead of copying them. |buffer| must hold the payload given to
+  // Create(). Must be called before the first NextPacket().
+  void SetPayloadBuffer(rtc::CopyOnWriteBuffer buffer);
+
   // Split payload_len into sum of integers with respect to |limits|.
   // Returns empty vector on failure.
   static std::vector<int> SplitAboutEqually(int payload_len,
                                             const PayloadSizeLimits& limits);
+
+ protected:
+  // Sets the payload of |packet| to |header_size| bytes of payload header,
+  // to be written through the returned pointer, followed by |data|. |data| is
+  // referenced when it lies within the payload buffer and copied otherwise.
+  uint8_t* WritePayload(RtpPacketToSend* packet,
+                        size_t header_size,
+                        rtc::ArrayView<const uint8_t> data) const;
+
+ private:
+  rtc::CopyOnWriteBuffer payload_buffer_;
 };
 
 // TODO(sprang): Update the depacketizer to return a std::unqie_ptr with a copy
@@ -327,9 +327,9 @@ bool RtpPacketizerH264::NextPacket(RtpPacketToSend* rtp_packet) {
   PacketUnit packet = packets_.front();
   if (packet.first_fragment && packet.last_fragment) {
     // Single NAL unit packet.
-    size_t bytes_to_send = packet.source_fragment.length;
-    uint8_t* buffer = rtp_packet->AllocatePayload(bytes_to_send);
-    memcpy(buffer, packet.source_fragment.buffer, bytes_to_send);
+    WritePayload(rtp_packet, 0,
+                 rtc::MakeArrayView(packet.source_fragment.buffer,
+                                    packet.source_fragment.length));
     packets_.pop();
     input_fragments_.pop_front();
   } else if (packet.aggregated) {
@@ -393,11 +393,11 @@ void RtpPacketizerH264::NextFragmentPacket(RtpPacketToSend* rtp_packet) {
   uint8_t type = packet->header & kTypeMask;
   fu_header |= type;
   const Fragment& fragment = packet->source_fragment;
-  uint8_t* buffer =
-      rtp_packet->AllocatePayload(kFuAHeaderSize + fragment.length);
+  uint8_t* buffer = WritePayload(
+      rtp_packet, kFuAHeaderSize,
+      rtc::MakeArrayView(fragment.buffer, fragment.length));
   buffer[0] = fu_indicator;
   buffer[1] = fu_header;
-  memcpy(buffer + kFuAHeaderSize, fragment.buffer, fragment.length);
   if (packet->last_fragment)
     input_fragments_.pop_front();
   packets_.pop();
@@ -0,0 +1,150 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_format.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/copyonwritebuffer.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kKeyFrameSize = 1024 * 1024;
+constexpr int kNumFrames = 200;
+constexpr int kQuickNumFrames = 5;
+constexpr size_t kMaxPacketSize = 1200;
+constexpr uint8_t kAbsoluteSendTimeId = 1;
+
+// Where the packets get their payload from.
+enum class PayloadSource {
+  // Copied into every packet, as when FEC is enabled.
+  kCopied,
+  // Referenced from the shared buffer that the encoder wrote the frame to.
+  kReferencedEncoderBuffer,
+};
+
+struct KeyFrameStats {
+  double time_us;
+  // Bytes of payload that are copied, from the codec's output buffer to the
+  // socket buffer.
+  size_t copied_payload_bytes;
+};
+
+// Encodes 1MB VP8 key frames, i.e. copies them out of the codec's own output
+// buffer as the encoder wrappers do, and packetizes them into a packet
+// history. Then takes every packet through the same steps as a paced send:
+// the packet is copied out of the history, its send time extension is
+// rewritten, which copies the packet's own buffer, and it is gathered into
+// the socket buffer. Returns the averages per frame.
+KeyFrameStats PacketizeKeyFrames(PayloadSource source) {
+  std::vector<uint8_t> codec_output(kKeyFrameSize);
+  for (size_t i = 0; i < kKeyFrameSize; ++i)
+    codec_output[i] = static_cast<uint8_t>(i * 7);
+
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<AbsoluteSendTime>(kAbsoluteSendTimeId);
+  RtpPacketToSend packet_template(&extensions, kMaxPacketSize);
+  packet_template.SetPayloadType(96);
+  packet_template.SetSsrc(0x12345678);
+  packet_template.SetExtension<AbsoluteSendTime>(0);
+
+  RTPVideoHeaderVP8 vp8_header;
+  vp8_header.InitRTPVideoHeaderVP8();
+  RTPVideoHeader video_header;
+  video_header.video_type_header = vp8_header;
+  RtpPacketizer::PayloadSizeLimits limits;
+  limits.max_payload_len = kMaxPacketSize - packet_template.headers_size();
+
+  uint8_t socket_buffer[kMaxPacketSize];
+  size_t bytes_sent = 0;
+  size_t copied_payload_bytes = 0;
+  const int frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                         ? kQuickNumFrames
+                         : kNumFrames;
+  rtc::CopyOnWriteBuffer encoded(0, kKeyFrameSize);
+  // Packets wait in the history until the pacer sends them, and stay there
+  // until the next frame for retransmissions.
+  std::vector<std::unique_ptr<RtpPacketToSend>> history;
+  int64_t start_us = rtc::TimeMicros();
+  for (int frame = 0; frame < frames; ++frame) {
+    // Same as the encoder: Clear() moves on to a new buffer if the packets of
+    // the previous frame still reference it.
+    encoded.Clear();
+    encoded.AppendData(codec_output.data(), codec_output.size());
+    copied_payload_bytes += encoded.size();
+    rtc::ArrayView<const uint8_t> payload(encoded.cdata(), encoded.size());
+    std::unique_ptr<RtpPacketizer> packetizer = RtpPacketizer::Create(
+        kVideoCodecVP8, payload, limits, video_header, kVideoFrameKey,
+        nullptr);
+    if (source == PayloadSource::kReferencedEncoderBuffer)
+      packetizer->SetPayloadBuffer(encoded);
+
+    history.clear();
+    history.reserve(packetizer->NumPackets());
+    auto packet = absl::make_unique<RtpPacketToSend>(packet_template);
+    while (packetizer->NextPacket(packet.get())) {
+      history.push_back(std::move(packet));
+      packet = absl::make_unique<RtpPacketToSend>(packet_template);
+    }
+
+    for (const auto& stored : history) {
+      // The payload held in the packet's own buffer was copied there by the
+      // packetizer and is copied again by the header rewrite.
+      copied_payload_bytes +=
+          2 * (stored->GetFragments()[0].size() - stored->headers_size());
+      RtpPacketToSend to_send(*stored);
+      to_send.SetExtension<AbsoluteSendTime>(frame);
+      size_t length = 0;
+      for (const auto& fragment : to_send.GetFragments()) {
+        memcpy(socket_buffer + length, fragment.data(), fragment.size());
+        length += fragment.size();
+      }
+      bytes_sent += length;
+      copied_payload_bytes += to_send.payload_size();
+    }
+  }
+  const double us_per_frame =
+      static_cast<double>(rtc::TimeMicros() - start_us) / frames;
+  EXPECT_GT(bytes_sent, frames * kKeyFrameSize);
+  return {us_per_frame, copied_payload_bytes / frames};
+}
+
+void RunAndReport(PayloadSource source, const std::string& trace) {
+  const KeyFrameStats stats = PacketizeKeyFrames(source);
+  test::PrintResult("packetize_1mb_key_frame", "", trace, stats.time_us, "us",
+                    true);
+  test::PrintResult("packetize_1mb_key_frame_copied_payload", "", trace,
+                    stats.copied_payload_bytes, "bytes", true);
+}
+
+}  // namespace
+
+TEST(RtpPacketizerPerformanceTest, KeyFrameWithCopiedPayload) {
+  RunAndReport(PayloadSource::kCopied, "copied_payload");
+}
+
+TEST(RtpPacketizerPerformanceTest, KeyFrameReferencingEncoderBuffer) {
+  RunAndReport(PayloadSource::kReferencedEncoderBuffer,
+               "referenced_encoder_buffer");
+}
+
+}  // namespace webrtc
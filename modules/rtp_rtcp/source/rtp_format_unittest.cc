@@ -12,7 +12,10 @@
 
 #include <memory>
 #include <numeric>
+#include <vector>
 
+#include "modules/rtp_rtcp/source/rtp_format_video_generic.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -20,6 +23,7 @@ namespace webrtc {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::Le;
 using ::testing::Gt;
 using ::testing::Each;
@@ -270,5 +274,62 @@ TEST(RtpPacketizerSplitAboutEqually, CanPutSinglePayloadByteInOnePacket) {
   EXPECT_THAT(RtpPacketizer::SplitAboutEqually(1, limits), ElementsAre(1));
 }
 
+// Packetizes |frame| with the generic packetizer and returns the packets.
+std::vector<RtpPacketToSend> PacketizeGeneric(
+    const rtc::CopyOnWriteBuffer& frame,
+    bool set_payload_buffer) {
+  RtpPacketizer::PayloadSizeLimits limits;
+  limits.max_payload_len = 100;
+  std::unique_ptr<RtpPacketizer> packetizer = RtpPacketizer::Create(
+      kVideoCodecGeneric, rtc::MakeArrayView(frame.cdata(), frame.size()),
+      limits, RTPVideoHeader(), kVideoFrameKey, nullptr);
+  if (set_payload_buffer)
+    packetizer->SetPayloadBuffer(frame);
+  std::vector<RtpPacketToSend> packets;
+  RtpPacketToSend packet(nullptr);
+  while (packetizer->NextPacket(&packet))
+    packets.push_back(packet);
+  return packets;
+}
+
+rtc::CopyOnWriteBuffer MakeFrame(size_t size) {
+  rtc::CopyOnWriteBuffer frame(size);
+  for (size_t i = 0; i < size; ++i)
+    frame[i] = static_cast<uint8_t>(i);
+  return frame;
+}
+
+TEST(RtpPacketizerPayloadBuffer, PacketsReferenceSlicesOfPayloadBuffer) {
+  const rtc::CopyOnWriteBuffer frame = MakeFrame(1000);
+  std::vector<RtpPacketToSend> packets = PacketizeGeneric(frame, true);
+  ASSERT_THAT(packets, SizeIs(11));
+
+  const uint8_t* expected_slice = frame.cdata();
+  for (const RtpPacketToSend& packet : packets) {
+    RtpPacket::Fragments fragments = packet.GetFragments();
+    // Only the generic payload header is stored in the packet itself.
+    EXPECT_EQ(fragments[0].size(), packet.headers_size() + 1);
+    EXPECT_EQ(fragments[1].data(), expected_slice);
+    expected_slice += fragments[1].size();
+  }
+  EXPECT_EQ(expected_slice, frame.cdata() + frame.size());
+}
+
+TEST(RtpPacketizerPayloadBuffer, SerializesSameAsCopiedPayload) {
+  const rtc::CopyOnWriteBuffer frame = MakeFrame(1000);
+  std::vector<RtpPacketToSend> referenced = PacketizeGeneric(frame, true);
+  std::vector<RtpPacketToSend> copied = PacketizeGeneric(frame, false);
+  ASSERT_EQ(referenced.size(), copied.size());
+
+  for (size_t i = 0; i < copied.size(); ++i) {
+    EXPECT_TRUE(copied[i].GetFragments()[1].empty());
+    std::vector<uint8_t> serialized;
+    for (const auto& fragment : referenced[i].GetFragments())
+      serialized.insert(serialized.end(), fragment.begin(), fragment.end());
+    EXPECT_THAT(serialized,
+                ElementsAreArray(copied[i].data(), copied[i].size()));
+  }
+}
+
 }  // namespace
 }  // namespace webrtc
@@ -46,13 +46,12 @@ bool RtpPacketizerGeneric::NextPacket(RtpPacketToSend* packet) {
 
   size_t next_packet_payload_len = *current_packet_;
 
-  uint8_t* out_ptr =
-      packet->AllocatePayload(header_size_ + next_packet_payload_len);
+  uint8_t* out_ptr = WritePayload(
+      packet, header_size_,
+      remaining_payload_.subview(0, next_packet_payload_len));
   RTC_CHECK(out_ptr);
 
   memcpy(out_ptr, header_, header_size_);
-  memcpy(out_ptr + header_size_, remaining_payload_.data(),
-         next_packet_payload_len);
 
   // Remove first-packet bit, following packets are intermediate.
   header_[0] &= ~RtpFormatVideoGeneric::kFirstPacketBit;
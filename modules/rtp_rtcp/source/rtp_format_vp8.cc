@@ -193,11 +193,11 @@ bool RtpPacketizerVp8::NextPacket(RtpPacketToSend* packet) {
   size_t packet_payload_len = *current_packet_;
   ++current_packet_;
 
-  uint8_t* buffer = packet->AllocatePayload(hdr_.size() + packet_payload_len);
+  uint8_t* buffer = WritePayload(
+      packet, hdr_.size(), remaining_payload_.subview(0, packet_payload_len));
   RTC_CHECK(buffer);
 
   memcpy(buffer, hdr_.data(), hdr_.size());
-  memcpy(buffer + hdr_.size(), remaining_payload_.data(), packet_payload_len);
 
   remaining_payload_ = remaining_payload_.subview(packet_payload_len);
   hdr_[0] &= (~kSBit);  //  Clear 'Start of partition' bit.
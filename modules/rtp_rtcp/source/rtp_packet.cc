@@ -83,6 +83,7 @@ bool RtpPacket::Parse(const uint8_t* buffer, size_t buffer_size) {
     Clear();
     return false;
   }
+  ClearPayloadReference();
   buffer_.SetData(buffer, buffer_size);
   RTC_DCHECK_EQ(size(), buffer_size);
   return true;
@@ -98,18 +99,19 @@ bool RtpPacket::Parse(rtc::CopyOnWriteBuffer buffer) {
     return false;
   }
   size_t buffer_size = buffer.size();
+  ClearPayloadReference();
   buffer_ = std::move(buffer);
   RTC_DCHECK_EQ(size(), buffer_size);
   return true;
 }
 
 std::vector<uint32_t> RtpPacket::Csrcs() const {
-  size_t num_csrc = data()[0] & 0x0F;
+  size_t num_csrc = buffer_.cdata()[0] & 0x0F;
   RTC_DCHECK_GE(capacity(), kFixedHeaderSize + num_csrc * 4);
   std::vector<uint32_t> csrcs(num_csrc);
   for (size_t i = 0; i < num_csrc; ++i) {
-    csrcs[i] =
-        ByteReader<uint32_t>::ReadBigEndian(&data()[kFixedHeaderSize + i * 4]);
+    csrcs[i] = ByteReader<uint32_t>::ReadBigEndian(
+        &buffer_.cdata()[kFixedHeaderSize + i * 4]);
   }
   return csrcs;
 }
@@ -126,8 +128,9 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   extensions_ = packet.extensions_;
   extension_entries_ = packet.extension_entries_;
   extensions_size_ = packet.extensions_size_;
-  buffer_.SetData(packet.data(), packet.headers_size());
+  buffer_.SetData(packet.buffer_.cdata(), packet.headers_size());
   // Reset payload and padding.
+  ClearPayloadReference();
   payload_size_ = 0;
   padding_size_ = 0;
 }
@@ -135,16 +138,16 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
 void RtpPacket::SetMarker(bool marker_bit) {
   marker_ = marker_bit;
   if (marker_) {
-    WriteAt(1, data()[1] | 0x80);
+    WriteAt(1, buffer_.cdata()[1] | 0x80);
   } else {
-    WriteAt(1, data()[1] & 0x7F);
+    WriteAt(1, buffer_.cdata()[1] & 0x7F);
   }
 }
 
 void RtpPacket::SetPayloadType(uint8_t payload_type) {
   RTC_DCHECK_LE(payload_type, 0x7Fu);
   payload_type_ = payload_type;
-  WriteAt(1, (data()[1] & 0x80) | payload_type);
+  WriteAt(1, (buffer_.cdata()[1] & 0x80) | payload_type);
 }
 
 void RtpPacket::SetSequenceNumber(uint16_t seq_no) {
@@ -169,7 +172,8 @@ void RtpPacket::SetCsrcs(rtc::ArrayView<const uint32_t> csrcs) {
   RTC_DCHECK_LE(csrcs.size(), 0x0fu);
   RTC_DCHECK_LE(kFixedHeaderSize + 4 * csrcs.size(), capacity());
   payload_offset_ = kFixedHeaderSize + 4 * csrcs.size();
-  WriteAt(0, (data()[0] & 0xF0) | rtc::dchecked_cast<uint8_t>(csrcs.size()));
+  WriteAt(0, (buffer_.cdata()[0] & 0xF0) |
+                 rtc::dchecked_cast<uint8_t>(csrcs.size()));
   size_t offset = kFixedHeaderSize;
   for (uint32_t csrc : csrcs) {
     ByteWriter<uint32_t>::WriteBigEndian(WriteAt(offset), csrc);
@@ -207,7 +211,7 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
     return nullptr;
   }
 
-  size_t num_csrc = data()[0] & 0x0F;
+  size_t num_csrc = buffer_.cdata()[0] & 0x0F;
   size_t extensions_offset = kFixedHeaderSize + (num_csrc * 4) + 4;
   size_t new_extensions_size = extensions_size_ + kOneByteHeaderSize + length;
   if (extensions_offset + new_extensions_size > capacity()) {
@@ -219,7 +223,7 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
   // All checks passed, write down the extension headers.
   if (extensions_size_ == 0) {
     RTC_DCHECK_EQ(payload_offset_, kFixedHeaderSize + (num_csrc * 4));
-    WriteAt(0, data()[0] | 0x10);  // Set extension bit.
+    WriteAt(0, buffer_.cdata()[0] | 0x10);  // Set extension bit.
     // Profile specific ID always set to OneByteExtensionHeader.
     ByteWriter<uint16_t>::WriteBigEndian(WriteAt(extensions_offset - 4),
                                          kOneByteExtensionId);
@@ -254,12 +258,58 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
 uint8_t* RtpPacket::AllocatePayload(size_t size_bytes) {
   // Reset payload size to 0. If CopyOnWrite buffer_ was shared, this will cause
   // reallocation and memcpy. Keeping just header reduces memcpy size.
+  ClearPayloadReference();
   SetPayloadSize(0);
   return SetPayloadSize(size_bytes);
 }
 
+uint8_t* RtpPacket::SetPayloadWithReference(
+    size_t inline_size,
+    const rtc::CopyOnWriteBuffer& source,
+    size_t offset,
+    size_t size) {
+  RTC_DCHECK_EQ(padding_size_, 0);
+  RTC_DCHECK_LE(offset + size, source.size());
+  if (payload_offset_ + inline_size + size > capacity()) {
+    RTC_LOG(LS_WARNING) << "Cannot set payload, not enough space in buffer.";
+    return nullptr;
+  }
+  uint8_t* inline_payload = AllocatePayload(inline_size);
+  RTC_DCHECK(inline_payload);
+  if (size > 0) {
+    payload_reference_ = source;
+    payload_reference_offset_ = offset;
+    payload_reference_size_ = size;
+    payload_size_ += size;
+  }
+  return inline_payload;
+}
+
+uint8_t* RtpPacket::SetEncapsulatedPayload(size_t header_size,
+                                           const RtpPacket& packet) {
+  const size_t inline_payload_size =
+      packet.payload_size_ - packet.payload_reference_size_;
+  uint8_t* buffer = SetPayloadWithReference(
+      header_size + inline_payload_size, packet.payload_reference_,
+      packet.payload_reference_offset_, packet.payload_reference_size_);
+  if (buffer) {
+    memcpy(buffer + header_size,
+           packet.buffer_.cdata() + packet.payload_offset_,
+           inline_payload_size);
+  }
+  return buffer;
+}
+
+RtpPacket::Fragments RtpPacket::GetFragments() const {
+  return {{rtc::MakeArrayView(buffer_.cdata(), buffer_.size()),
+           rtc::MakeArrayView(
+               payload_reference_.cdata() + payload_reference_offset_,
+               payload_reference_size_)}};
+}
+
 uint8_t* RtpPacket::SetPayloadSize(size_t size_bytes) {
   RTC_DCHECK_EQ(padding_size_, 0);
+  FlattenPayloadReference();
   if (payload_offset_ + size_bytes > capacity()) {
     RTC_LOG(LS_WARNING) << "Cannot set payload, not enough space in buffer.";
     return nullptr;
@@ -271,6 +321,7 @@ uint8_t* RtpPacket::SetPayloadSize(size_t size_bytes) {
 
 bool RtpPacket::SetPadding(uint8_t size_bytes, Random* random) {
   RTC_DCHECK(random);
+  FlattenPayloadReference();
   if (payload_offset_ + payload_size_ + size_bytes > capacity()) {
     RTC_LOG(LS_WARNING) << "Cannot set padding size " << size_bytes << ", only "
                         << (capacity() - payload_offset_ - payload_size_)
@@ -286,9 +337,9 @@ bool RtpPacket::SetPadding(uint8_t size_bytes, Random* random) {
       WriteAt(offset, random->Rand<uint8_t>());
     }
     WriteAt(padding_end - 1, padding_size_);
-    WriteAt(0, data()[0] | 0x20);  // Set padding bit.
+    WriteAt(0, buffer_.cdata()[0] | 0x20);  // Set padding bit.
   } else {
-    WriteAt(0, data()[0] & ~0x20);  // Clear padding bit.
+    WriteAt(0, buffer_.cdata()[0] & ~0x20);  // Clear padding bit.
   }
   return true;
 }
@@ -304,12 +355,30 @@ void RtpPacket::Clear() {
   padding_size_ = 0;
   extensions_size_ = 0;
   extension_entries_.clear();
+  ClearPayloadReference();
 
   memset(WriteAt(0), 0, kFixedHeaderSize);
   buffer_.SetSize(kFixedHeaderSize);
   WriteAt(0, kRtpVersion << 6);
 }
 
+void RtpPacket::FlattenPayloadReference() {
+  if (payload_reference_size_ == 0)
+    return;
+  RTC_DCHECK_EQ(padding_size_, 0);
+  RTC_DCHECK_EQ(buffer_.size(),
+                payload_offset_ + payload_size_ - payload_reference_size_);
+  buffer_.AppendData(payload_reference_.cdata() + payload_reference_offset_,
+                     payload_reference_size_);
+  ClearPayloadReference();
+}
+
+void RtpPacket::ClearPayloadReference() {
+  payload_reference_ = rtc::CopyOnWriteBuffer();
+  payload_reference_offset_ = 0;
+  payload_reference_size_ = 0;
+}
+
 bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
   if (size < kFixedHeaderSize) {
     return false;
@@ -444,7 +513,7 @@ rtc::ArrayView<const uint8_t> RtpPacket::FindExtension(
   if (extension_info == nullptr) {
     return nullptr;
   }
-  return rtc::MakeArrayView(data() + extension_info->offset,
+  return rtc::MakeArrayView(buffer_.cdata() + extension_info->offset,
                             extension_info->length);
 }
 
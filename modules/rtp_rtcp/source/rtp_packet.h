@@ -10,11 +10,13 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 
+#include <array>
 #include <vector>
 
 #include "api/array_view.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "rtc_base/checks.h"
 #include "rtc_base/copyonwritebuffer.h"
 
 namespace webrtc {
@@ -63,20 +65,34 @@ class RtpPacket {
   // Payload.
   size_t payload_size() const { return payload_size_; }
   size_t padding_size() const { return padding_size_; }
+  // payload(), Buffer() and data() are only available while no part of the
+  // payload is referenced (see SetPayloadWithReference). Use GetFragments()
+  // for packets that may reference their payload.
   rtc::ArrayView<const uint8_t> payload() const {
     return rtc::MakeArrayView(data() + payload_offset_, payload_size_);
   }
 
   // Buffer.
-  rtc::CopyOnWriteBuffer Buffer() const { return buffer_; }
+  rtc::CopyOnWriteBuffer Buffer() const {
+    RTC_DCHECK_EQ(payload_reference_size_, 0);
+    return buffer_;
+  }
   size_t capacity() const { return buffer_.capacity(); }
   size_t size() const {
     return payload_offset_ + payload_size_ + padding_size_;
   }
-  const uint8_t* data() const { return buffer_.cdata(); }
+  const uint8_t* data() const {
+    RTC_DCHECK_EQ(payload_reference_size_, 0);
+    return buffer_.cdata();
+  }
   size_t FreeCapacity() const { return capacity() - size(); }
   size_t MaxPayloadSize() const { return capacity() - headers_size(); }
 
+  // The serialized packet as the packet's own buffer followed by the
+  // referenced part of the payload, which is empty if there is none.
+  using Fragments = std::array<rtc::ArrayView<const uint8_t>, 2>;
+  Fragments GetFragments() const;
+
   // Reset fields and buffer.
   void Clear();
 
@@ -110,6 +126,19 @@ class RtpPacket {
   uint8_t* SetPayloadSize(size_t size_bytes);
   // Same as SetPayloadSize but doesn't guarantee to keep current payload.
   uint8_t* AllocatePayload(size_t size_bytes);
+  // Sets a payload of |inline_size| bytes, written by the caller through the
+  // returned pointer, followed by |size| bytes of |source| starting at
+  // |offset|. The latter are not copied; |source| is kept alive by the packet
+  // and its copies. Returns nullptr on failure.
+  uint8_t* SetPayloadWithReference(size_t inline_size,
+                                   const rtc::CopyOnWriteBuffer& source,
+                                   size_t offset,
+                                   size_t size);
+  // Sets a payload of |header_size| bytes, written by the caller through the
+  // returned pointer, followed by the payload of |packet|, e.g. to build an
+  // RTX packet. The part of the payload that |packet| references is
+  // referenced rather than copied. Returns nullptr on failure.
+  uint8_t* SetEncapsulatedPayload(size_t header_size, const RtpPacket& packet);
   bool SetPadding(uint8_t size_bytes, Random* random);
 
  private:
@@ -146,6 +175,12 @@ class RtpPacket {
   // to write raw extension to or an empty view on failure.
   rtc::ArrayView<uint8_t> AllocateExtension(ExtensionType type, size_t length);
 
+  // Appends the referenced part of the payload, if any, to |buffer_|.
+  void FlattenPayloadReference();
+  // Drops the referenced part of the payload without updating
+  // |payload_size_|.
+  void ClearPayloadReference();
+
   uint8_t* WriteAt(size_t offset) { return buffer_.data() + offset; }
   void WriteAt(size_t offset, uint8_t byte) { buffer_.data()[offset] = byte; }
 
@@ -162,7 +197,13 @@ class RtpPacket {
   ExtensionManager extensions_;
   std::vector<ExtensionInfo> extension_entries_;
   size_t extensions_size_ = 0;  // Unaligned.
+  // Header and the part of the payload that is not referenced.
   rtc::CopyOnWriteBuffer buffer_;
+  // Tail of the payload that is a slice of a shared buffer, typically the
+  // encoded frame. Never set together with padding.
+  rtc::CopyOnWriteBuffer payload_reference_;
+  size_t payload_reference_offset_ = 0;
+  size_t payload_reference_size_ = 0;
 };
 
 template <typename Extension>
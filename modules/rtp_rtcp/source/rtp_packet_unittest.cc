@@ -265,6 +265,117 @@ TEST(RtpPacketTest, CreateUnalignedPadding) {
   EXPECT_EQ(packet.size(), packet.capacity());
 }
 
+TEST(RtpPacketTest, CreateWithReferencedPayload) {
+  const uint8_t kFrame[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const rtc::CopyOnWriteBuffer frame(kFrame);
+  RtpPacketToSend packet(nullptr);
+  packet.SetPayloadType(kPayloadType);
+  packet.SetSequenceNumber(kSeqNum);
+  packet.SetTimestamp(kTimestamp);
+  packet.SetSsrc(kSsrc);
+
+  uint8_t* inline_payload = packet.SetPayloadWithReference(1, frame, 2, 4);
+  ASSERT_TRUE(inline_payload);
+  inline_payload[0] = 0xab;
+  EXPECT_EQ(packet.payload_size(), 5u);
+  EXPECT_EQ(packet.size(), sizeof(kMinimumPacket) + 5);
+
+  RtpPacket::Fragments fragments = packet.GetFragments();
+  ASSERT_EQ(fragments[0].size(), sizeof(kMinimumPacket) + 1);
+  EXPECT_THAT(fragments[0].subview(0, sizeof(kMinimumPacket)),
+              ElementsAreArray(kMinimumPacket));
+  EXPECT_EQ(fragments[0][sizeof(kMinimumPacket)], 0xab);
+  EXPECT_EQ(fragments[1].data(), frame.cdata() + 2);
+  EXPECT_EQ(fragments[1].size(), 4u);
+}
+
+TEST(RtpPacketTest, EncapsulatedPayloadKeepsReference) {
+  const uint8_t kFrame[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const rtc::CopyOnWriteBuffer frame(kFrame);
+  RtpPacketToSend packet(nullptr);
+  uint8_t* inline_payload = packet.SetPayloadWithReference(1, frame, 2, 4);
+  ASSERT_TRUE(inline_payload);
+  inline_payload[0] = 0xab;
+
+  RtpPacketToSend rtx_packet(nullptr);
+  uint8_t* rtx_payload = rtx_packet.SetEncapsulatedPayload(2, packet);
+  ASSERT_TRUE(rtx_payload);
+  rtx_payload[0] = 0x12;
+  rtx_payload[1] = 0x34;
+
+  EXPECT_EQ(rtx_packet.payload_size(), 7u);
+  RtpPacket::Fragments fragments = rtx_packet.GetFragments();
+  const uint8_t kExpectedInlinePayload[] = {0x12, 0x34, 0xab};
+  EXPECT_THAT(fragments[0].subview(rtx_packet.headers_size()),
+              ElementsAreArray(kExpectedInlinePayload));
+  EXPECT_EQ(fragments[1].data(), frame.cdata() + 2);
+  EXPECT_EQ(fragments[1].size(), 4u);
+}
+
+TEST(RtpPacketTest, EncapsulatedPayloadWithoutReference) {
+  const uint8_t kPayload[] = {1, 2, 3};
+  RtpPacketToSend packet(nullptr);
+  uint8_t* payload = packet.AllocatePayload(sizeof(kPayload));
+  ASSERT_TRUE(payload);
+  memcpy(payload, kPayload, sizeof(kPayload));
+
+  RtpPacketToSend rtx_packet(nullptr);
+  uint8_t* rtx_payload = rtx_packet.SetEncapsulatedPayload(1, packet);
+  ASSERT_TRUE(rtx_payload);
+  rtx_payload[0] = 0xff;
+
+  const uint8_t kExpectedPayload[] = {0xff, 1, 2, 3};
+  EXPECT_TRUE(rtx_packet.GetFragments()[1].empty());
+  EXPECT_THAT(rtx_packet.payload(), ElementsAreArray(kExpectedPayload));
+}
+
+TEST(RtpPacketTest, CopiesShareReferencedPayload) {
+  const rtc::CopyOnWriteBuffer frame(1000);
+  RtpPacketToSend packet(nullptr);
+  packet.SetSequenceNumber(kSeqNum);
+  ASSERT_TRUE(packet.SetPayloadWithReference(0, frame, 0, frame.size()));
+
+  RtpPacketToSend copy(packet);
+  copy.SetSequenceNumber(kSeqNum + 1);
+
+  EXPECT_EQ(copy.GetFragments()[1].data(), frame.cdata());
+  EXPECT_EQ(packet.GetFragments()[1].data(), frame.cdata());
+  EXPECT_EQ(packet.SequenceNumber(), kSeqNum);
+  EXPECT_EQ(copy.size(), packet.size());
+}
+
+TEST(RtpPacketTest, ReferencedPayloadMustFitCapacity) {
+  const rtc::CopyOnWriteBuffer frame(100);
+  RtpPacketToSend packet(nullptr, sizeof(kMinimumPacket) + 50);
+  EXPECT_FALSE(packet.SetPayloadWithReference(1, frame, 0, 50));
+  EXPECT_TRUE(packet.SetPayloadWithReference(1, frame, 0, 49));
+  EXPECT_EQ(packet.size(), packet.capacity());
+}
+
+TEST(RtpPacketTest, AllocatePayloadDropsReferencedPayload) {
+  const rtc::CopyOnWriteBuffer frame(100);
+  RtpPacketToSend packet(nullptr);
+  ASSERT_TRUE(packet.SetPayloadWithReference(2, frame, 0, 50));
+  ASSERT_TRUE(packet.AllocatePayload(10));
+  EXPECT_EQ(packet.payload_size(), 10u);
+  EXPECT_TRUE(packet.GetFragments()[1].empty());
+  EXPECT_EQ(packet.GetFragments()[0].size(), packet.size());
+}
+
+TEST(RtpPacketTest, PaddingAfterReferencedPayload) {
+  const uint8_t kFrame[] = {1, 2, 3};
+  const rtc::CopyOnWriteBuffer frame(kFrame);
+  RtpPacketToSend packet(nullptr);
+  ASSERT_TRUE(packet.SetPayloadWithReference(0, frame, 0, 3));
+  Random random(0x123456789);
+  ASSERT_TRUE(packet.SetPadding(4, &random));
+
+  EXPECT_EQ(packet.size(), sizeof(kMinimumPacket) + 3 + 4);
+  EXPECT_TRUE(packet.GetFragments()[1].empty());
+  EXPECT_THAT(packet.payload(), ElementsAreArray(kFrame));
+  EXPECT_EQ(packet.data()[packet.size() - 1], 4);
+}
+
 TEST(RtpPacketTest, ParseMinimum) {
   RtpPacketReceived packet;
   EXPECT_TRUE(packet.Parse(kMinimumPacket, sizeof(kMinimumPacket)));
@@ -400,6 +400,7 @@ bool ModuleRtpRtcpImpl::SendOutgoingData(
     int64_t capture_time_ms,
     const uint8_t* payload_data,
     size_t payload_size,
+    const rtc::CopyOnWriteBuffer* payload_buffer,
     const RTPFragmentationHeader* fragmentation,
     const RTPVideoHeader* rtp_video_header,
     uint32_t* transport_frame_id_out) {
@@ -420,8 +421,8 @@ bool ModuleRtpRtcpImpl::SendOutgoingData(
   }
   return rtp_sender_->SendOutgoingData(
       frame_type, payload_type, time_stamp, capture_time_ms, payload_data,
-      payload_size, fragmentation, rtp_video_header, transport_frame_id_out,
-      expected_retransmission_time_ms);
+      payload_size, payload_buffer, fragmentation, rtp_video_header,
+      transport_frame_id_out, expected_retransmission_time_ms);
 }
 
 bool ModuleRtpRtcpImpl::TimeToSendPacket(uint32_t ssrc,
@@ -123,6 +123,7 @@ class ModuleRtpRtcpImpl : public RtpRtcp, public RTCPReceiver::ModuleRtpRtcp {
                         int64_t capture_time_ms,
                         const uint8_t* payload_data,
                         size_t payload_size,
+                        const rtc::CopyOnWriteBuffer* payload_buffer,
                         const RTPFragmentationHeader* fragmentation,
                         const RTPVideoHeader* rtp_video_header,
                         uint32_t* transport_frame_id_out) override;
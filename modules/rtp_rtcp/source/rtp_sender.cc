@@ -401,6 +401,7 @@ bool RTPSender::SendOutgoingData(FrameType frame_type,
                                  int64_t capture_time_ms,
                                  const uint8_t* payload_data,
                                  size_t payload_size,
+                                 const rtc::CopyOnWriteBuffer* payload_buffer,
                                  const RTPFragmentationHeader* fragmentation,
                                  const RTPVideoHeader* rtp_header,
                                  uint32_t* transport_frame_id_out,
@@ -468,8 +469,8 @@ bool RTPSender::SendOutgoingData(FrameType frame_type,
 
     result = video_->SendVideo(video_type, frame_type, payload_type,
                                rtp_timestamp, capture_time_ms, payload_data,
-                               payload_size, fragmentation, rtp_header,
-                               expected_retransmission_time_ms);
+                               payload_size, payload_buffer, fragmentation,
+                               rtp_header, expected_retransmission_time_ms);
   }
 
   rtc::CritScope cs(&statistics_crit_);
@@ -709,9 +710,14 @@ bool RTPSender::SendPacketToNetwork(const RtpPacketToSend& packet,
   int bytes_sent = -1;
   if (transport_) {
     UpdateRtpOverhead(packet);
-    bytes_sent = transport_->SendRtp(packet.data(), packet.size(), options)
-                     ? static_cast<int>(packet.size())
-                     : -1;
+    // Hand a payload referenced from the encoded frame to the transport
+    // without serializing the packet first.
+    RtpPacket::Fragments fragments = packet.GetFragments();
+    const bool sent =
+        fragments[1].empty()
+            ? transport_->SendRtp(packet.data(), packet.size(), options)
+            : transport_->SendRtpFragments(fragments, options);
+    bytes_sent = sent ? static_cast<int>(packet.size()) : -1;
     if (event_log_ && bytes_sent > 0) {
       event_log_->Log(absl::make_unique<RtcEventRtpPacketOutgoing>(
           packet, pacing_info.probe_cluster_id));
@@ -1279,16 +1285,14 @@ std::unique_ptr<RtpPacketToSend> RTPSender::BuildRtxPacket(
     }
   }
 
+  // Add original payload data, still referencing the encoded frame if the
+  // original packet does.
   uint8_t* rtx_payload =
-      rtx_packet->AllocatePayload(packet.payload_size() + kRtxHeaderSize);
+      rtx_packet->SetEncapsulatedPayload(kRtxHeaderSize, packet);
   RTC_DCHECK(rtx_payload);
   // Add OSN (original sequence number).
   ByteWriter<uint16_t>::WriteBigEndian(rtx_payload, packet.SequenceNumber());
 
-  // Add original payload data.
-  auto payload = packet.payload();
-  memcpy(rtx_payload + kRtxHeaderSize, payload.data(), payload.size());
-
   // Add original application data.
   rtx_packet->set_application_data(packet.application_data());
 
@@ -30,6 +30,7 @@
 #include "modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "modules/rtp_rtcp/source/rtp_utility.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/deprecation.h"
 #include "rtc_base/random.h"
@@ -109,6 +110,7 @@ class RTPSender {
                         int64_t capture_time_ms,
                         const uint8_t* payload_data,
                         size_t payload_size,
+                        const rtc::CopyOnWriteBuffer* payload_buffer,
                         const RTPFragmentationHeader* fragmentation,
                         const RTPVideoHeader* rtp_header,
                         uint32_t* transport_frame_id_out,
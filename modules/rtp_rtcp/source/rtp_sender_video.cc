@@ -325,6 +325,7 @@ bool RTPSenderVideo::SendVideo(enum VideoCodecType video_type,
                                int64_t capture_time_ms,
                                const uint8_t* payload_data,
                                size_t payload_size,
+                               const rtc::CopyOnWriteBuffer* payload_buffer,
                                const RTPFragmentationHeader* fragmentation,
                                const RTPVideoHeader* video_header,
                                int64_t expected_retransmission_time_ms) {
@@ -368,6 +369,15 @@ bool RTPSenderVideo::SendVideo(enum VideoCodecType video_type,
     retransmission_settings = retransmission_settings_;
   }
 
+  // Unless FEC needs the serialized packets anyway, let the packets reference
+  // the payload in the encoder's shared buffer, so that it is not copied by
+  // the packetizer, for RTX or when the pacer rewrites the headers.
+  const bool reference_payload =
+      !red_enabled && !flexfec_enabled() && payload_buffer &&
+      payload_data >= payload_buffer->cdata() &&
+      payload_data + payload_size <=
+          payload_buffer->cdata() + payload_buffer->size();
+
   // Maximum size of packet including rtp headers.
   // Extra space left in case packet will be resent using fec or rtx.
   int packet_capacity = rtp_sender_->MaxRtpPacketSize() - fec_packet_overhead -
@@ -411,6 +421,8 @@ bool RTPSenderVideo::SendVideo(enum VideoCodecType video_type,
   std::unique_ptr<RtpPacketizer> packetizer = RtpPacketizer::Create(
       video_type, rtc::MakeArrayView(payload_data, payload_size), limits,
       *video_header, frame_type, fragmentation);
+  if (reference_payload)
+    packetizer->SetPayloadBuffer(*payload_buffer);
 
   const uint8_t temporal_id = GetTemporalId(*video_header);
   StorageType storage = GetStorageType(temporal_id, retransmission_settings,
@@ -22,6 +22,7 @@
 #include "modules/rtp_rtcp/source/rtp_sender.h"
 #include "modules/rtp_rtcp/source/rtp_utility.h"
 #include "modules/rtp_rtcp/source/ulpfec_generator.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/onetimeevent.h"
 #include "rtc_base/rate_statistics.h"
@@ -54,6 +55,7 @@ class RTPSenderVideo {
                  int64_t capture_time_ms,
                  const uint8_t* payload_data,
                  size_t payload_size,
+                 const rtc::CopyOnWriteBuffer* payload_buffer,
                  const RTPFragmentationHeader* fragmentation,
                  const RTPVideoHeader* video_header,
                  int64_t expected_retransmission_time_ms);
@@ -160,7 +160,7 @@ TEST_F(RtpRtcpAudioTest, Basic) {
   // Should fail since we have not registered the payload type.
   EXPECT_FALSE(module1_->SendOutgoingData(webrtc::kAudioFrameSpeech,
                                           kPcmuPayloadType, 0, -1, nullptr, 0,
-                                          nullptr, nullptr, nullptr));
+                                          nullptr, nullptr, nullptr, nullptr));
 
   CodecInst voice_codec = {};
   voice_codec.pltype = kPcmuPayloadType;
@@ -169,9 +169,9 @@ TEST_F(RtpRtcpAudioTest, Basic) {
   memcpy(voice_codec.plname, "PCMU", 5);
   RegisterPayload(voice_codec);
 
-  EXPECT_TRUE(module1_->SendOutgoingData(webrtc::kAudioFrameSpeech,
-                                         kPcmuPayloadType, 0, -1, kTestPayload,
-                                         4, nullptr, nullptr, nullptr));
+  EXPECT_TRUE(module1_->SendOutgoingData(
+      webrtc::kAudioFrameSpeech, kPcmuPayloadType, 0, -1, kTestPayload, 4,
+      nullptr, nullptr, nullptr, nullptr));
 
   EXPECT_EQ(kSsrc, rtp_receiver2_->SSRC());
   uint32_t timestamp;
@@ -217,7 +217,7 @@ TEST_F(RtpRtcpAudioTest, DTMF) {
   for (; timeStamp <= 250 * 160; timeStamp += 160) {
     EXPECT_TRUE(module1_->SendOutgoingData(
         webrtc::kAudioFrameSpeech, kPcmuPayloadType, timeStamp, -1,
-        kTestPayload, 4, nullptr, nullptr, nullptr));
+        kTestPayload, 4, nullptr, nullptr, nullptr, nullptr));
     fake_clock_.AdvanceTimeMilliseconds(20);
     module1_->Process();
   }
@@ -226,7 +226,7 @@ TEST_F(RtpRtcpAudioTest, DTMF) {
   for (; timeStamp <= 740 * 160; timeStamp += 160) {
     EXPECT_TRUE(module1_->SendOutgoingData(
         webrtc::kAudioFrameSpeech, kPcmuPayloadType, timeStamp, -1,
-        kTestPayload, 4, nullptr, nullptr, nullptr));
+        kTestPayload, 4, nullptr, nullptr, nullptr, nullptr));
     fake_clock_.AdvanceTimeMilliseconds(20);
     module1_->Process();
   }
@@ -261,7 +261,7 @@ TEST_F(RtpRtcpAudioTest, ComfortNoise) {
     int64_t receive_time_ms;
     EXPECT_TRUE(module1_->SendOutgoingData(
         webrtc::kAudioFrameSpeech, kPcmuPayloadType, in_timestamp, -1,
-        kTestPayload, 4, nullptr, nullptr, nullptr));
+        kTestPayload, 4, nullptr, nullptr, nullptr, nullptr));
 
     EXPECT_EQ(kSsrc, rtp_receiver2_->SSRC());
     EXPECT_TRUE(
@@ -273,7 +273,7 @@ TEST_F(RtpRtcpAudioTest, ComfortNoise) {
 
     EXPECT_TRUE(module1_->SendOutgoingData(
         webrtc::kAudioFrameCN, c.payload_type, in_timestamp, -1, kTestPayload,
-        1, nullptr, nullptr, nullptr));
+        1, nullptr, nullptr, nullptr, nullptr));
 
     EXPECT_EQ(kSsrc, rtp_receiver2_->SSRC());
     EXPECT_TRUE(
@@ -103,7 +103,8 @@ class RtpRtcpRtcpTest : public ::testing::Test {
     const uint8_t test[9] = "testtest";
     EXPECT_EQ(true,
               module1_->SendOutgoingData(webrtc::kAudioFrameSpeech, 96, 0, -1,
-                                         test, 8, nullptr, nullptr, nullptr));
+                                         test, 8, nullptr, nullptr, nullptr,
+                                         nullptr));
   }
 
   const std::vector<uint32_t> kCsrcs = {1234, 2345};
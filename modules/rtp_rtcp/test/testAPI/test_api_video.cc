@@ -128,7 +128,7 @@ TEST_F(RtpRtcpVideoTest, BasicVideo) {
   RTPVideoHeader video_header;
   EXPECT_TRUE(video_module_->SendOutgoingData(
       kVideoFrameDelta, 123, timestamp, timestamp / 90, video_frame_,
-      payload_data_length_, nullptr, &video_header, nullptr));
+      payload_data_length_, nullptr, nullptr, &video_header, nullptr));
 }
 
 TEST_F(RtpRtcpVideoTest, PaddingOnlyFrames) {
@@ -22,12 +22,14 @@ extern "C" {
 
 #include "api/video/color_space.h"
 #include "api/video/i420_buffer.h"
+#include "common_video/include/frame_buffer_memory_pool.h"
 #include "common_video/include/video_frame_buffer.h"
 #include "modules/video_coding/codecs/h264/h264_color_space.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/keep_ref_until_done.h"
 #include "rtc_base/logging.h"
+#include "system_wrappers/include/field_trial.h"
 #include "system_wrappers/include/metrics.h"
 
 namespace webrtc {
@@ -39,6 +41,8 @@ const AVPixelFormat kPixelFormatFullRange = AV_PIX_FMT_YUVJ420P;
 const size_t kYPlaneIndex = 0;
 const size_t kUPlaneIndex = 1;
 const size_t kVPlaneIndex = 2;
+const char kSharedFrameBufferPoolFieldTrial[] =
+    "WebRTC-Video-SharedFrameBufferPool";
 
 // Used by histograms. Values of entries should not be changed.
 enum H264DecoderImplEvent {
@@ -139,11 +143,15 @@ void H264DecoderImpl::AVFreeBuffer2(void* opaque, uint8_t* data) {
   delete video_frame;
 }
 
-H264DecoderImpl::H264DecoderImpl() : pool_(true),
-                                     decoded_image_callback_(nullptr),
-                                     has_reported_init_(false),
-                                     has_reported_error_(false) {
-}
+H264DecoderImpl::H264DecoderImpl()
+    : pool_(true,
+            std::numeric_limits<size_t>::max(),
+            field_trial::IsEnabled(kSharedFrameBufferPoolFieldTrial)
+                ? FrameBufferMemoryPool::Global()
+                : nullptr),
+      decoded_image_callback_(nullptr),
+      has_reported_init_(false),
+      has_reported_error_(false) {}
 
 H264DecoderImpl::~H264DecoderImpl() {
   Release();
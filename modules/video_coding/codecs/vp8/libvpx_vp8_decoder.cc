@@ -12,6 +12,7 @@
 #include <string>
 
 #include "absl/memory/memory.h"
+#include "common_video/include/frame_buffer_memory_pool.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "modules/video_coding/codecs/vp8/libvpx_vp8_decoder.h"
 #include "rtc_base/checks.h"
@@ -31,6 +32,8 @@ constexpr int kVp8ErrorPropagationTh = 30;
 constexpr long kDecodeDeadlineRealtime = 1;  // NOLINT
 
 const char kVp8PostProcArmFieldTrial[] = "WebRTC-VP8-Postproc-Config-Arm";
+const char kSharedFrameBufferPoolFieldTrial[] =
+    "WebRTC-Video-SharedFrameBufferPool";
 
 void GetPostProcParamsFromFieldTrialGroup(
     LibvpxVp8Decoder::DeblockParams* deblock_params) {
@@ -53,6 +56,15 @@ void GetPostProcParamsFromFieldTrialGroup(
   *deblock_params = params;
 }
 
+// Returns the number of threads to decode |width|x|height| frames with: two
+// for 720p, scaled with the pixel count from there, so one for 360p and four
+// for 1080p. Low resolutions get a single thread, as they are typically
+// decoded next to many other streams.
+int NumberOfDecoderThreads(int width, int height, int number_of_cores) {
+  int num_threads = std::max(1, 2 * width * height / (1280 * 720));
+  return std::min(num_threads, std::max(number_of_cores, 1));
+}
+
 }  // namespace
 
 std::unique_ptr<VP8Decoder> VP8Decoder::Create() {
@@ -86,7 +98,11 @@ class LibvpxVp8Decoder::QpSmoother {
 LibvpxVp8Decoder::LibvpxVp8Decoder()
     : use_postproc_arm_(
           webrtc::field_trial::IsEnabled(kVp8PostProcArmFieldTrial)),
-      buffer_pool_(false, 300 /* max_number_of_buffers*/),
+      buffer_pool_(false,
+                   300 /* max_number_of_buffers*/,
+                   field_trial::IsEnabled(kSharedFrameBufferPoolFieldTrial)
+                       ? FrameBufferMemoryPool::Global()
+                       : nullptr),
       decode_complete_callback_(NULL),
       inited_(false),
       decoder_(NULL),
@@ -94,6 +110,8 @@ LibvpxVp8Decoder::LibvpxVp8Decoder()
       last_frame_width_(0),
       last_frame_height_(0),
       key_frame_required_(true),
+      number_of_cores_(1),
+      num_threads_(1),
       qp_smoother_(use_postproc_arm_ ? new QpSmoother() : nullptr) {
   if (use_postproc_arm_)
     GetPostProcParamsFromFieldTrialGroup(&deblock_);
@@ -105,6 +123,14 @@ LibvpxVp8Decoder::~LibvpxVp8Decoder() {
 }
 
 int LibvpxVp8Decoder::InitDecode(const VideoCodec* inst, int number_of_cores) {
+  number_of_cores_ = number_of_cores;
+  if (!inst)
+    return InitDecoder(1);
+  return InitDecoder(
+      NumberOfDecoderThreads(inst->width, inst->height, number_of_cores_));
+}
+
+int LibvpxVp8Decoder::InitDecoder(int num_threads) {
   int ret_val = Release();
   if (ret_val < 0) {
     return ret_val;
@@ -114,8 +140,7 @@ int LibvpxVp8Decoder::InitDecode(const VideoCodec* inst, int number_of_cores) {
     memset(decoder_, 0, sizeof(*decoder_));
   }
   vpx_codec_dec_cfg_t cfg;
-  // Setting number of threads to a constant value (1)
-  cfg.threads = 1;
+  cfg.threads = num_threads;
   cfg.h = cfg.w = 0;  // set after decode
 
 #if defined(WEBRTC_ARCH_ARM) || defined(WEBRTC_ARCH_ARM64) || \
@@ -132,6 +157,7 @@ int LibvpxVp8Decoder::InitDecode(const VideoCodec* inst, int number_of_cores) {
   }
 
   propagation_cnt_ = -1;
+  num_threads_ = num_threads;
   inited_ = true;
 
   // Always start with a complete key frame.
@@ -156,6 +182,20 @@ int LibvpxVp8Decoder::Decode(const EncodedImage& input_image,
     return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
   }
 
+  // A complete key frame does not depend on any decoder state, so the decoder
+  // can be re-created there with a thread count that fits the resolution.
+  if (input_image._frameType == kVideoFrameKey && input_image._completeFrame &&
+      input_image._encodedWidth > 0 && input_image._encodedHeight > 0) {
+    int num_threads = NumberOfDecoderThreads(input_image._encodedWidth,
+                                             input_image._encodedHeight,
+                                             number_of_cores_);
+    if (num_threads != num_threads_) {
+      int ret_val = InitDecoder(num_threads);
+      if (ret_val != WEBRTC_VIDEO_CODEC_OK)
+        return ret_val;
+    }
+  }
+
 // Post process configurations.
 #if defined(WEBRTC_ARCH_ARM) || defined(WEBRTC_ARCH_ARM64) || \
     defined(WEBRTC_ANDROID)
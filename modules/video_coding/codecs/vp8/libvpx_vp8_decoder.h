@@ -50,6 +50,8 @@ class LibvpxVp8Decoder : public VP8Decoder {
 
  private:
   class QpSmoother;
+  // Creates the libvpx decoder, decoding on |num_threads| threads.
+  int InitDecoder(int num_threads);
   int ReturnFrame(const vpx_image_t* img,
                   uint32_t timeStamp,
                   int64_t ntp_time_ms,
@@ -65,6 +67,10 @@ class LibvpxVp8Decoder : public VP8Decoder {
   int last_frame_width_;
   int last_frame_height_;
   bool key_frame_required_;
+  // The number of cores given to InitDecode, and the number of threads the
+  // decoder currently uses.
+  int number_of_cores_;
+  int num_threads_;
   DeblockParams deblock_;
   const std::unique_ptr<QpSmoother> qp_smoother_;
 };
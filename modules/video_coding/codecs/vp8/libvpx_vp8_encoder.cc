@@ -18,6 +18,7 @@
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "modules/video_coding/utility/simulcast_utility.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "rtc_base/timeutils.h"
 #include "rtc_base/trace_event.h"
 #include "system_wrappers/include/field_trial.h"
@@ -178,11 +179,7 @@ LibvpxVp8Encoder::~LibvpxVp8Encoder() {
 int LibvpxVp8Encoder::Release() {
   int ret_val = WEBRTC_VIDEO_CODEC_OK;
 
-  while (!encoded_images_.empty()) {
-    EncodedImage& image = encoded_images_.back();
-    delete[] image._buffer;
-    encoded_images_.pop_back();
-  }
+  encoded_images_.clear();
   while (!encoders_.empty()) {
     vpx_codec_ctx_t& encoder = encoders_.back();
     if (inited_) {
@@ -376,12 +373,10 @@ int LibvpxVp8Encoder::InitEncode(const VideoCodec* inst,
   }
   for (int i = 0; i < number_of_streams; ++i) {
     // allocate memory for encoded image
-    if (encoded_images_[i]._buffer != NULL) {
-      delete[] encoded_images_[i]._buffer;
-    }
-    encoded_images_[i]._size =
-        CalcBufferSize(VideoType::kI420, codec_.width, codec_.height);
-    encoded_images_[i]._buffer = new uint8_t[encoded_images_[i]._size];
+    encoded_images_[i].shared_buffer_ = rtc::CopyOnWriteBuffer(
+        0, CalcBufferSize(VideoType::kI420, codec_.width, codec_.height));
+    encoded_images_[i]._buffer = encoded_images_[i].shared_buffer_.data();
+    encoded_images_[i]._size = encoded_images_[i].shared_buffer_.capacity();
     encoded_images_[i]._completeFrame = true;
   }
   // populate encoder configuration with default values
@@ -427,6 +422,9 @@ int LibvpxVp8Encoder::InitEncode(const VideoCodec* inst,
 
   // Allow the user to set the complexity for the base stream.
   switch (inst->VP8().complexity) {
+    case VideoCodecComplexity::kComplexityLow:
+      cpu_speed_[0] = -8;
+      break;
     case VideoCodecComplexity::kComplexityHigh:
       cpu_speed_[0] = -5;
       break;
@@ -670,6 +668,55 @@ uint32_t LibvpxVp8Encoder::FrameDropThreshold(size_t spatial_idx) const {
   return enable_frame_dropping ? 30 : 0;
 }
 
+rtc::scoped_refptr<VideoFrameBuffer> LibvpxVp8Encoder::PrepareInputImage(
+    const rtc::scoped_refptr<VideoFrameBuffer>& buffer) {
+  // Since we are extracting raw pointers from |buffer| to |raw_images_[0]|,
+  // the resolution of these frames must match.
+  RTC_DCHECK_EQ(buffer->width(), raw_images_[0].d_w);
+  RTC_DCHECK_EQ(buffer->height(), raw_images_[0].d_h);
+
+#if defined(RTC_LIBVPX_SUPPORTS_NV12)
+  // The downscaled images of the other encoders are I420, so NV12 is only
+  // passed through without internal simulcast.
+  const vpx_img_fmt_t fmt =
+      buffer->type() == VideoFrameBuffer::Type::kNV12 && encoders_.size() == 1
+          ? VPX_IMG_FMT_NV12
+          : VPX_IMG_FMT_I420;
+  if (raw_images_[0].fmt != fmt) {
+    // Re-wrap the image for the new format, the planes are set below.
+    vpx_img_wrap(&raw_images_[0], fmt, raw_images_[0].d_w, raw_images_[0].d_h,
+                 1, NULL);
+  }
+
+  // Image in vpx_image_t format.
+  // Input image is const. VP8's raw image is not defined as const.
+  if (fmt == VPX_IMG_FMT_NV12) {
+    const NV12BufferInterface* nv12_buffer = buffer->GetNV12();
+    raw_images_[0].planes[VPX_PLANE_Y] =
+        const_cast<uint8_t*>(nv12_buffer->DataY());
+    raw_images_[0].planes[VPX_PLANE_U] =
+        const_cast<uint8_t*>(nv12_buffer->DataUV());
+    raw_images_[0].planes[VPX_PLANE_V] = raw_images_[0].planes[VPX_PLANE_U] + 1;
+    raw_images_[0].stride[VPX_PLANE_Y] = nv12_buffer->StrideY();
+    raw_images_[0].stride[VPX_PLANE_U] = nv12_buffer->StrideUV();
+    raw_images_[0].stride[VPX_PLANE_V] = nv12_buffer->StrideUV();
+    return buffer;
+  }
+#endif  // defined(RTC_LIBVPX_SUPPORTS_NV12)
+
+  rtc::scoped_refptr<I420BufferInterface> i420_buffer = buffer->ToI420();
+  raw_images_[0].planes[VPX_PLANE_Y] =
+      const_cast<uint8_t*>(i420_buffer->DataY());
+  raw_images_[0].planes[VPX_PLANE_U] =
+      const_cast<uint8_t*>(i420_buffer->DataU());
+  raw_images_[0].planes[VPX_PLANE_V] =
+      const_cast<uint8_t*>(i420_buffer->DataV());
+  raw_images_[0].stride[VPX_PLANE_Y] = i420_buffer->StrideY();
+  raw_images_[0].stride[VPX_PLANE_U] = i420_buffer->StrideU();
+  raw_images_[0].stride[VPX_PLANE_V] = i420_buffer->StrideV();
+  return i420_buffer;
+}
+
 int LibvpxVp8Encoder::Encode(const VideoFrame& frame,
                              const CodecSpecificInfo* codec_specific_info,
                              const std::vector<FrameType>* frame_types) {
@@ -681,25 +728,9 @@ int LibvpxVp8Encoder::Encode(const VideoFrame& frame,
   if (encoded_complete_callback_ == NULL)
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
 
-  rtc::scoped_refptr<I420BufferInterface> input_image =
-      frame.video_frame_buffer()->ToI420();
-  // Since we are extracting raw pointers from |input_image| to
-  // |raw_images_[0]|, the resolution of these frames must match.
-  RTC_DCHECK_EQ(input_image->width(), raw_images_[0].d_w);
-  RTC_DCHECK_EQ(input_image->height(), raw_images_[0].d_h);
-
-  // Image in vpx_image_t format.
-  // Input image is const. VP8's raw image is not defined as const.
-  raw_images_[0].planes[VPX_PLANE_Y] =
-      const_cast<uint8_t*>(input_image->DataY());
-  raw_images_[0].planes[VPX_PLANE_U] =
-      const_cast<uint8_t*>(input_image->DataU());
-  raw_images_[0].planes[VPX_PLANE_V] =
-      const_cast<uint8_t*>(input_image->DataV());
-
-  raw_images_[0].stride[VPX_PLANE_Y] = input_image->StrideY();
-  raw_images_[0].stride[VPX_PLANE_U] = input_image->StrideU();
-  raw_images_[0].stride[VPX_PLANE_V] = input_image->StrideV();
+  // Keeps the pixel data referenced by |raw_images_[0]| alive during encode.
+  rtc::scoped_refptr<VideoFrameBuffer> input_image =
+      PrepareInputImage(frame.video_frame_buffer());
 
   for (size_t i = 1; i < encoders_.size(); ++i) {
     // Scale the image down a number of times by downsampling factor
@@ -846,7 +877,11 @@ int LibvpxVp8Encoder::GetEncodedPartitions(
        ++encoder_idx, --stream_idx) {
     vpx_codec_iter_t iter = NULL;
     int part_idx = 0;
-    encoded_images_[encoder_idx]._length = 0;
+    // The packets of earlier frames may still reference the buffer, in which
+    // case Clear() moves on to a new buffer instead of overwriting it.
+    rtc::CopyOnWriteBuffer& buffer =
+        encoded_images_[encoder_idx].shared_buffer_;
+    buffer.Clear();
     encoded_images_[encoder_idx]._frameType = kVideoFrameDelta;
     RTPFragmentationHeader frag_info;
     // kTokenPartitions is number of bits used.
@@ -858,23 +893,13 @@ int LibvpxVp8Encoder::GetEncodedPartitions(
            NULL) {
       switch (pkt->kind) {
         case VPX_CODEC_CX_FRAME_PKT: {
-          size_t length = encoded_images_[encoder_idx]._length;
-          if (pkt->data.frame.sz + length >
-              encoded_images_[encoder_idx]._size) {
-            uint8_t* buffer = new uint8_t[pkt->data.frame.sz + length];
-            memcpy(buffer, encoded_images_[encoder_idx]._buffer, length);
-            delete[] encoded_images_[encoder_idx]._buffer;
-            encoded_images_[encoder_idx]._buffer = buffer;
-            encoded_images_[encoder_idx]._size = pkt->data.frame.sz + length;
-          }
-          memcpy(&encoded_images_[encoder_idx]._buffer[length],
-                 pkt->data.frame.buf, pkt->data.frame.sz);
+          size_t length = buffer.size();
+          buffer.AppendData(static_cast<const uint8_t*>(pkt->data.frame.buf),
+                            pkt->data.frame.sz);
           frag_info.fragmentationOffset[part_idx] = length;
           frag_info.fragmentationLength[part_idx] = pkt->data.frame.sz;
           frag_info.fragmentationPlType[part_idx] = 0;  // not known here
           frag_info.fragmentationTimeDiff[part_idx] = 0;
-          encoded_images_[encoder_idx]._length += pkt->data.frame.sz;
-          assert(length <= encoded_images_[encoder_idx]._size);
           ++part_idx;
           break;
         }
@@ -894,6 +919,9 @@ int LibvpxVp8Encoder::GetEncodedPartitions(
         break;
       }
     }
+    encoded_images_[encoder_idx]._buffer = buffer.data();
+    encoded_images_[encoder_idx]._length = buffer.size();
+    encoded_images_[encoder_idx]._size = buffer.capacity();
     encoded_images_[encoder_idx].SetTimestamp(input_image.timestamp());
     encoded_images_[encoder_idx].capture_time_ms_ =
         input_image.render_time_ms();
@@ -86,6 +86,12 @@ class LibvpxVp8Encoder : public VP8Encoder {
 
   uint32_t FrameDropThreshold(size_t spatial_idx) const;
 
+  // Points |raw_images_[0]| at the pixel data of |buffer|. If libvpx supports
+  // NV12, NV12 is handed to it as is if there is a single encoder. Everything
+  // else is converted to I420. Returns the buffer that owns the pixel data.
+  rtc::scoped_refptr<VideoFrameBuffer> PrepareInputImage(
+      const rtc::scoped_refptr<VideoFrameBuffer>& buffer);
+
   const bool use_gf_boost_;
 
   EncodedImageCallback* encoded_complete_callback_;
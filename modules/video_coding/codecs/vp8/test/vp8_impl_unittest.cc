@@ -12,6 +12,7 @@
 
 #include <memory>
 
+#include "api/video/nv12_buffer.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "modules/video_coding/codecs/test/video_codec_unittest.h"
 #include "modules/video_coding/codecs/vp8/include/vp8.h"
@@ -268,6 +269,25 @@ TEST_F(TestVp8Impl, MAYBE_AlignedStrideEncodeDecode) {
   EXPECT_EQ(kTestNtpTimeMs, decoded_frame->ntp_time_ms());
 }
 
+TEST_F(TestVp8Impl, EncodesNV12Input) {
+  VideoFrame* input_frame = NextInputFrame();
+  VideoFrame nv12_frame(
+      NV12Buffer::Copy(*input_frame->video_frame_buffer()->ToI420()),
+      kInitialTimestampRtp, 0, kVideoRotation_0);
+  EncodedImage encoded_frame;
+  CodecSpecificInfo codec_specific_info;
+  EncodeAndWaitForFrame(nv12_frame, &encoded_frame, &codec_specific_info);
+
+  encoded_frame._frameType = kVideoFrameKey;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            decoder_->Decode(encoded_frame, false, nullptr, -1));
+  std::unique_ptr<VideoFrame> decoded_frame;
+  absl::optional<uint8_t> decoded_qp;
+  ASSERT_TRUE(WaitForDecodedFrame(&decoded_frame, &decoded_qp));
+  ASSERT_TRUE(decoded_frame);
+  EXPECT_GT(I420PSNR(input_frame, decoded_frame.get()), 36);
+}
+
 #if defined(WEBRTC_ANDROID)
 #define MAYBE_DecodeWithACompleteKeyFrame DISABLED_DecodeWithACompleteKeyFrame
 #else
@@ -10,6 +10,7 @@
 
 #include "api/video/color_space.h"
 #include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "media/base/vp9_profile.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
@@ -134,6 +135,26 @@ TEST_F(TestVp9Impl, EncodeDecode) {
   EXPECT_EQ(ColorSpace::RangeID::kLimited, color_space.range());
 }
 
+TEST_F(TestVp9Impl, EncodesNV12Input) {
+  VideoFrame* input_frame = NextInputFrame();
+  VideoFrame nv12_frame(
+      NV12Buffer::Copy(*input_frame->video_frame_buffer()->ToI420()),
+      input_frame->timestamp(), 0, kVideoRotation_0);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder_->Encode(nv12_frame, nullptr, nullptr));
+  EncodedImage encoded_frame;
+  CodecSpecificInfo codec_specific_info;
+  ASSERT_TRUE(WaitForEncodedFrame(&encoded_frame, &codec_specific_info));
+  encoded_frame._frameType = kVideoFrameKey;
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            decoder_->Decode(encoded_frame, false, nullptr, 0));
+  std::unique_ptr<VideoFrame> decoded_frame;
+  absl::optional<uint8_t> decoded_qp;
+  ASSERT_TRUE(WaitForDecodedFrame(&decoded_frame, &decoded_qp));
+  ASSERT_TRUE(decoded_frame);
+  EXPECT_GT(I420PSNR(input_frame, decoded_frame.get()), 36);
+}
+
 // We only test the encoder here, since the decoded frame rotation is set based
 // on the CVO RTP header extension in VCMDecodedFrameCallback::Decoded.
 // TODO(brandtr): Consider passing through the rotation flag through the decoder
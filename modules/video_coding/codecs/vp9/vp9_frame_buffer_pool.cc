@@ -21,18 +21,41 @@
 
 namespace webrtc {
 
+Vp9FrameBufferPool::Vp9FrameBuffer::Vp9FrameBuffer(
+    FrameBufferMemoryPool* memory_pool)
+    : memory_pool_(memory_pool) {}
+
+Vp9FrameBufferPool::Vp9FrameBuffer::~Vp9FrameBuffer() {
+  FrameBufferMemoryPool::Free(pooled_data_);
+}
+
 uint8_t* Vp9FrameBufferPool::Vp9FrameBuffer::GetData() {
-  return data_.data<uint8_t>();
+  return memory_pool_ ? pooled_data_ : data_.data<uint8_t>();
 }
 
 size_t Vp9FrameBufferPool::Vp9FrameBuffer::GetDataSize() const {
-  return data_.size();
+  return memory_pool_ ? pooled_size_ : data_.size();
 }
 
 void Vp9FrameBufferPool::Vp9FrameBuffer::SetSize(size_t size) {
-  data_.SetSize(size);
+  if (!memory_pool_) {
+    data_.SetSize(size);
+    return;
+  }
+  if (!pooled_data_ || FrameBufferMemoryPool::BlockSize(pooled_data_) < size) {
+    FrameBufferMemoryPool::Free(pooled_data_);
+    pooled_data_ = memory_pool_->Allocate(size, false /* zero_initialize */);
+  }
+  pooled_size_ = size;
 }
 
+Vp9FrameBufferPool::Vp9FrameBufferPool() : Vp9FrameBufferPool(nullptr) {}
+
+Vp9FrameBufferPool::Vp9FrameBufferPool(FrameBufferMemoryPool* memory_pool)
+    : memory_pool_(memory_pool) {}
+
+Vp9FrameBufferPool::~Vp9FrameBufferPool() = default;
+
 bool Vp9FrameBufferPool::InitializeVpxUsePool(
     vpx_codec_ctx* vpx_codec_context) {
   RTC_DCHECK(vpx_codec_context);
@@ -67,7 +90,8 @@ Vp9FrameBufferPool::GetFrameBuffer(size_t min_size) {
     }
     // Otherwise create one.
     if (available_buffer == nullptr) {
-      available_buffer = new rtc::RefCountedObject<Vp9FrameBuffer>();
+      available_buffer =
+          new rtc::RefCountedObject<Vp9FrameBuffer>(memory_pool_);
       allocated_buffers_.push_back(available_buffer);
       if (allocated_buffers_.size() > max_num_buffers_) {
         RTC_LOG(LS_WARNING)
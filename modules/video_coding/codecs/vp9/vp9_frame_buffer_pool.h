@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "common_video/include/frame_buffer_memory_pool.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/refcount.h"
@@ -50,21 +51,39 @@ namespace webrtc {
 //
 //    // Destroying the codec will make libvpx release any buffers it was using.
 //    vpx_codec_destroy(decoder_ctx);
+//
+// A pool constructed with a FrameBufferMemoryPool takes the memory of its
+// buffers from the shared pool, and returns it there when the buffers are
+// deleted, e.g. on ClearPool().
 class Vp9FrameBufferPool {
  public:
   class Vp9FrameBuffer : public rtc::RefCountInterface {
    public:
+    explicit Vp9FrameBuffer(FrameBufferMemoryPool* memory_pool);
+
     uint8_t* GetData();
     size_t GetDataSize() const;
     void SetSize(size_t size);
 
     virtual bool HasOneRef() const = 0;
 
+   protected:
+    ~Vp9FrameBuffer() override;
+
    private:
-    // Data as an easily resizable buffer.
+    FrameBufferMemoryPool* const memory_pool_;
+    // Data as an easily resizable buffer, if there is no |memory_pool_|.
     rtc::Buffer data_;
+    // Otherwise a block from |memory_pool_|, of which |pooled_size_| bytes are
+    // used.
+    uint8_t* pooled_data_ = nullptr;
+    size_t pooled_size_ = 0;
   };
 
+  Vp9FrameBufferPool();
+  explicit Vp9FrameBufferPool(FrameBufferMemoryPool* memory_pool);
+  ~Vp9FrameBufferPool();
+
   // Configures libvpx to, in the specified context, use this memory pool for
   // buffers used to decompress frames. This is only supported for VP9.
   bool InitializeVpxUsePool(vpx_codec_ctx* vpx_codec_context);
@@ -101,6 +120,8 @@ class Vp9FrameBufferPool {
                                        vpx_codec_frame_buffer* fb);
 
  private:
+  // If set, the memory of the buffers comes from this pool.
+  FrameBufferMemoryPool* const memory_pool_;
   // Protects |allocated_buffers_|.
   rtc::CriticalSection buffers_lock_;
   // All buffers, in use or ready to be recycled.
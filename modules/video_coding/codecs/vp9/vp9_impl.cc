@@ -32,10 +32,14 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/timeutils.h"
 #include "rtc_base/trace_event.h"
+#include "system_wrappers/include/field_trial.h"
 
 namespace webrtc {
 
 namespace {
+const char kSharedFrameBufferPoolFieldTrial[] =
+    "WebRTC-Video-SharedFrameBufferPool";
+
 // Only positive speeds, range for real-time coding currently is: 5 - 8.
 // Lower means slower/better quality, higher means fastest/lower quality.
 int GetCpuSpeed(int width, int height) {
@@ -50,6 +54,15 @@ int GetCpuSpeed(int width, int height) {
     return 7;
 #endif
 }
+
+// Returns the number of threads to decode |width|x|height| frames with: two
+// for 720p, scaled with the pixel count from there, so one for 360p and four
+// for 1080p. libvpx splits the work between tile columns and loop filter rows.
+int NumberOfDecoderThreads(int width, int height, int number_of_cores) {
+  int num_threads = std::max(1, 2 * width * height / (1280 * 720));
+  return std::min(num_threads, std::max(number_of_cores, 1));
+}
+
 // Helper class for extracting VP9 colorspace.
 ColorSpace ExtractVP9ColorSpace(vpx_color_space_t space_t,
                                 vpx_color_range_t range_t,
@@ -446,6 +459,10 @@ int VP9EncoderImpl::InitEncode(const VideoCodec* inst,
       NumberOfThreads(config_->g_w, config_->g_h, number_of_cores);
 
   cpu_speed_ = GetCpuSpeed(config_->g_w, config_->g_h);
+  if (inst->VP9().complexity == VideoCodecComplexity::kComplexityLow) {
+    // The fastest real-time speed.
+    cpu_speed_ = 8;
+  }
 
   is_flexible_mode_ = inst->VP9().flexibleMode;
 
@@ -722,11 +739,43 @@ int VP9EncoderImpl::Encode(const VideoFrame& input_image,
   // Keep reference to buffer until encode completes.
   rtc::scoped_refptr<I420BufferInterface> i420_buffer;
   rtc::scoped_refptr<I010BufferInterface> i010_buffer;
+#if defined(RTC_LIBVPX_SUPPORTS_NV12)
+  rtc::scoped_refptr<NV12BufferInterface> nv12_buffer;
+#endif
   switch (profile_) {
     case VP9Profile::kProfile0: {
-      i420_buffer = input_image.video_frame_buffer()->ToI420();
+#if defined(RTC_LIBVPX_SUPPORTS_NV12)
+      // We can inject kNV12 frames directly for encode. All other formats
+      // are converted to I420.
+      const vpx_img_fmt img_fmt =
+          input_image.video_frame_buffer()->type() ==
+                  VideoFrameBuffer::Type::kNV12
+              ? VPX_IMG_FMT_NV12
+              : VPX_IMG_FMT_I420;
+      if (raw_->fmt != img_fmt) {
+        // Re-wrap the image for the new format, the planes are set below.
+        // Wrapping |raw_| in place would clear its self_allocd flag and leak
+        // it, so a new wrapper is allocated instead.
+        const unsigned int width = raw_->d_w;
+        const unsigned int height = raw_->d_h;
+        vpx_img_free(raw_);
+        raw_ = vpx_img_wrap(nullptr, img_fmt, width, height, 1, nullptr);
+      }
       // Image in vpx_image_t format.
       // Input image is const. VPX's raw image is not defined as const.
+      if (img_fmt == VPX_IMG_FMT_NV12) {
+        nv12_buffer = input_image.video_frame_buffer()->GetNV12();
+        raw_->planes[VPX_PLANE_Y] = const_cast<uint8_t*>(nv12_buffer->DataY());
+        raw_->planes[VPX_PLANE_U] =
+            const_cast<uint8_t*>(nv12_buffer->DataUV());
+        raw_->planes[VPX_PLANE_V] = raw_->planes[VPX_PLANE_U] + 1;
+        raw_->stride[VPX_PLANE_Y] = nv12_buffer->StrideY();
+        raw_->stride[VPX_PLANE_U] = nv12_buffer->StrideUV();
+        raw_->stride[VPX_PLANE_V] = nv12_buffer->StrideUV();
+        break;
+      }
+#endif  // defined(RTC_LIBVPX_SUPPORTS_NV12)
+      i420_buffer = input_image.video_frame_buffer()->ToI420();
       raw_->planes[VPX_PLANE_Y] = const_cast<uint8_t*>(i420_buffer->DataY());
       raw_->planes[VPX_PLANE_U] = const_cast<uint8_t*>(i420_buffer->DataU());
       raw_->planes[VPX_PLANE_V] = const_cast<uint8_t*>(i420_buffer->DataV());
@@ -1139,10 +1188,16 @@ std::unique_ptr<VP9Decoder> VP9Decoder::Create() {
 }
 
 VP9DecoderImpl::VP9DecoderImpl()
-    : decode_complete_callback_(nullptr),
+    : frame_buffer_pool_(
+          field_trial::IsEnabled(kSharedFrameBufferPoolFieldTrial)
+              ? FrameBufferMemoryPool::Global()
+              : nullptr),
+      decode_complete_callback_(nullptr),
       inited_(false),
       decoder_(nullptr),
-      key_frame_required_(true) {}
+      key_frame_required_(true),
+      number_of_cores_(1),
+      num_threads_(1) {}
 
 VP9DecoderImpl::~VP9DecoderImpl() {
   inited_ = true;  // in order to do the actual release
@@ -1158,6 +1213,14 @@ VP9DecoderImpl::~VP9DecoderImpl() {
 }
 
 int VP9DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
+  number_of_cores_ = number_of_cores;
+  if (!inst)
+    return InitDecoder(1);
+  return InitDecoder(
+      NumberOfDecoderThreads(inst->width, inst->height, number_of_cores_));
+}
+
+int VP9DecoderImpl::InitDecoder(int num_threads) {
   int ret_val = Release();
   if (ret_val < 0) {
     return ret_val;
@@ -1166,8 +1229,7 @@ int VP9DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
     decoder_ = new vpx_codec_ctx_t;
   }
   vpx_codec_dec_cfg_t cfg;
-  // Setting number of threads to a constant value (1)
-  cfg.threads = 1;
+  cfg.threads = num_threads;
   cfg.h = cfg.w = 0;  // set after decode
   vpx_codec_flags_t flags = 0;
   if (vpx_codec_dec_init(decoder_, vpx_codec_vp9_dx(), &cfg, flags)) {
@@ -1178,6 +1240,7 @@ int VP9DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
     return WEBRTC_VIDEO_CODEC_MEMORY;
   }
 
+  num_threads_ = num_threads;
   inited_ = true;
   // Always start with a complete key frame.
   key_frame_required_ = true;
@@ -1194,6 +1257,21 @@ int VP9DecoderImpl::Decode(const EncodedImage& input_image,
   if (decode_complete_callback_ == nullptr) {
     return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
   }
+  // A complete key frame of the lowest spatial layer does not depend on any
+  // decoder state, so the decoder can be re-created there with a thread count
+  // that fits the resolution. Only that frame carries the resolution.
+  if (input_image._frameType == kVideoFrameKey && input_image._completeFrame &&
+      input_image.SpatialIndex().value_or(0) == 0 &&
+      input_image._encodedWidth > 0 && input_image._encodedHeight > 0) {
+    int num_threads = NumberOfDecoderThreads(input_image._encodedWidth,
+                                             input_image._encodedHeight,
+                                             number_of_cores_);
+    if (num_threads != num_threads_) {
+      int ret_val = InitDecoder(num_threads);
+      if (ret_val != WEBRTC_VIDEO_CODEC_OK)
+        return ret_val;
+    }
+  }
   // Always start with a complete key frame.
   if (key_frame_required_) {
     if (input_image._frameType != kVideoFrameKey)
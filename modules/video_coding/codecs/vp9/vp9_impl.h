@@ -162,6 +162,8 @@ class VP9DecoderImpl : public VP9Decoder {
   const char* ImplementationName() const override;
 
  private:
+  // Creates the libvpx decoder, decoding on |num_threads| threads.
+  int InitDecoder(int num_threads);
   int ReturnFrame(const vpx_image_t* img,
                   uint32_t timestamp,
                   int64_t ntp_time_ms,
@@ -173,6 +175,10 @@ class VP9DecoderImpl : public VP9Decoder {
   bool inited_;
   vpx_codec_ctx_t* decoder_;
   bool key_frame_required_;
+  // The number of cores given to InitDecode, and the number of threads the
+  // decoder currently uses.
+  int number_of_cores_;
+  int num_threads_;
 };
 }  // namespace webrtc
 
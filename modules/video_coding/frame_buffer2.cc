@@ -32,27 +32,53 @@ namespace {
 constexpr int kMaxFramesBuffered = 600;
 
 // Max number of decoded frame info that will be saved.
-constexpr int kMaxFramesHistory = 50;
+constexpr size_t kMaxFramesHistory = 50;
+
+// The number of picture ids the frame table covers initially and at most.
+// The table grows when frames arrive out of its range. Frames that still do
+// not fit are kept in a map, so the table only bounds the fast path and not
+// how many frames are buffered.
+constexpr size_t kInitialPictureCapacity = 128;
+constexpr size_t kMaxPictureCapacity = 4096;
+
+// The max number of spatial layers of a picture in the frame table.
+constexpr size_t kMaxLayersPerPicture = 8;
 
 // The time it's allowed for a frame to be late to its rendering prediction and
 // still be rendered.
 constexpr int kMaxAllowedFrameDelayMs = 5;
 
 constexpr int64_t kLogNonDecodedIntervalMs = 5000;
+
+size_t TableIndex(const VideoLayerFrameId& id,
+                  size_t picture_capacity,
+                  size_t layers_per_picture) {
+  RTC_DCHECK_GE(id.picture_id, 0);
+  RTC_DCHECK_LT(id.spatial_layer, layers_per_picture);
+  return static_cast<size_t>(id.picture_id & (picture_capacity - 1)) *
+             layers_per_picture +
+         id.spatial_layer;
+}
 }  // namespace
 
 FrameBuffer::FrameBuffer(Clock* clock,
                          VCMJitterEstimator* jitter_estimator,
                          VCMTiming* timing,
                          VCMReceiveStatisticsCallback* stats_callback)
-    : clock_(clock),
+    : frames_(kInitialPictureCapacity),
+      picture_capacity_(kInitialPictureCapacity),
+      layers_per_picture_(1),
+      first_picture_id_(0),
+      newest_picture_id_(0),
+      num_frame_infos_(0),
+      decoded_history_(kMaxFramesHistory),
+      decoded_history_begin_(0),
+      clock_(clock),
       new_continuous_frame_event_(false, false),
       jitter_estimator_(jitter_estimator),
       timing_(timing),
       inter_frame_delay_(clock_->TimeInMilliseconds()),
       last_decoded_frame_timestamp_(0),
-      last_decoded_frame_it_(frames_.end()),
-      last_continuous_frame_it_(frames_.end()),
       num_frames_history_(0),
       num_frames_buffered_(0),
       stopped_(false),
@@ -80,57 +106,12 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
       if (stopped_)
         return kStopped;
 
-      wait_ms = max_wait_time_ms;
-
       // Need to hold |crit_| in order to use |frames_|, therefore we
-      // set it here in the loop instead of outside the loop in order to not
-      // acquire the lock unnecesserily.
-      next_frame_it_ = frames_.end();
-
-      // |frame_it| points to the first frame after the
-      // |last_decoded_frame_it_|.
-      auto frame_it = frames_.end();
-      if (last_decoded_frame_it_ == frames_.end()) {
-        frame_it = frames_.begin();
-      } else {
-        frame_it = last_decoded_frame_it_;
-        ++frame_it;
-      }
-
-      // |continuous_end_it| points to the first frame after the
-      // |last_continuous_frame_it_|.
-      auto continuous_end_it = last_continuous_frame_it_;
-      if (continuous_end_it != frames_.end())
-        ++continuous_end_it;
-
-      for (; frame_it != continuous_end_it && frame_it != frames_.end();
-           ++frame_it) {
-        if (!frame_it->second.continuous ||
-            frame_it->second.num_missing_decodable > 0) {
-          continue;
-        }
-
-        EncodedFrame* frame = frame_it->second.frame.get();
-
-        if (keyframe_required && !frame->is_keyframe())
-          continue;
-
-        next_frame_it_ = frame_it;
-        if (frame->RenderTime() == -1)
-          frame->SetRenderTime(
-              timing_->RenderTimeMs(frame->Timestamp(), now_ms));
-        wait_ms = timing_->MaxWaitingTime(frame->RenderTime(), now_ms);
-
-        // This will cause the frame buffer to prefer high framerate rather
-        // than high resolution in the case of the decoder not decoding fast
-        // enough and the stream has multiple spatial and temporal layers.
-        // For multiple temporal layers it may cause non-base layer frames to be
-        // skipped if they are late.
-        if (wait_ms < -kMaxAllowedFrameDelayMs)
-          continue;
-
-        break;
-      }
+      // look for the next frame here in the loop instead of outside the loop
+      // in order to not acquire the lock unnecesserily.
+      wait_ms = FindNextFrame(now_ms, keyframe_required);
+      if (!next_frame_)
+        wait_ms = max_wait_time_ms;
     }  // rtc::Critscope lock(&crit_);
 
     wait_ms = std::min<int64_t>(wait_ms, latest_return_time_ms - now_ms);
@@ -140,77 +121,14 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
   {
     rtc::CritScope lock(&crit_);
     now_ms = clock_->TimeInMilliseconds();
-    if (next_frame_it_ != frames_.end()) {
-      std::unique_ptr<EncodedFrame> frame =
-          std::move(next_frame_it_->second.frame);
-
-      if (!frame->delayed_by_retransmission()) {
-        int64_t frame_delay;
-
-        if (inter_frame_delay_.CalculateDelay(frame->Timestamp(), &frame_delay,
-                                              frame->ReceivedTime())) {
-          jitter_estimator_->UpdateEstimate(frame_delay, frame->size());
-        }
-
-        float rtt_mult = protection_mode_ == kProtectionNackFEC ? 0.0 : 1.0;
-        if (RttMultExperiment::RttMultEnabled()) {
-          rtt_mult = RttMultExperiment::GetRttMultValue();
-        }
-        timing_->SetJitterDelay(jitter_estimator_->GetJitterEstimate(rtt_mult));
-        timing_->UpdateCurrentDelay(frame->RenderTime(), now_ms);
-      } else {
-        if (RttMultExperiment::RttMultEnabled() ||
-            webrtc::field_trial::IsEnabled("WebRTC-AddRttToPlayoutDelay"))
-          jitter_estimator_->FrameNacked();
-      }
-
-      // Gracefully handle bad RTP timestamps and render time issues.
-      if (HasBadRenderTiming(*frame, now_ms)) {
-        jitter_estimator_->Reset();
-        timing_->Reset();
-        frame->SetRenderTime(timing_->RenderTimeMs(frame->Timestamp(), now_ms));
-      }
-
-      UpdateJitterDelay();
-      UpdateTimingFrameInfo();
-      PropagateDecodability(next_frame_it_->second);
-
-      // Sanity check for RTP timestamp monotonicity.
-      if (last_decoded_frame_it_ != frames_.end()) {
-        const VideoLayerFrameId& last_decoded_frame_key =
-            last_decoded_frame_it_->first;
-        const VideoLayerFrameId& frame_key = next_frame_it_->first;
-
-        const bool frame_is_higher_spatial_layer_of_last_decoded_frame =
-            last_decoded_frame_timestamp_ == frame->Timestamp() &&
-            last_decoded_frame_key.picture_id == frame_key.picture_id &&
-            last_decoded_frame_key.spatial_layer < frame_key.spatial_layer;
-
-        if (AheadOrAt(last_decoded_frame_timestamp_, frame->Timestamp()) &&
-            !frame_is_higher_spatial_layer_of_last_decoded_frame) {
-          // TODO(brandtr): Consider clearing the entire buffer when we hit
-          // these conditions.
-          RTC_LOG(LS_WARNING)
-              << "Frame with (timestamp:picture_id:spatial_id) ("
-              << frame->Timestamp() << ":" << frame->id.picture_id << ":"
-              << static_cast<int>(frame->id.spatial_layer) << ")"
-              << " sent to decoder after frame with"
-              << " (timestamp:picture_id:spatial_id) ("
-              << last_decoded_frame_timestamp_ << ":"
-              << last_decoded_frame_key.picture_id << ":"
-              << static_cast<int>(last_decoded_frame_key.spatial_layer) << ").";
-        }
-      }
-
-      AdvanceLastDecodedFrame(next_frame_it_);
-      last_decoded_frame_timestamp_ = frame->Timestamp();
-      *frame_out = std::move(frame);
+    if (next_frame_) {
+      *frame_out = GetNextFrame(now_ms);
       return kFrameFound;
     }
   }
 
   if (latest_return_time_ms - now_ms > 0) {
-    // If |next_frame_it_ == frames_.end()| and there is still time left, it
+    // If |next_frame_| is not set and there is still time left, it
     // means that the frame buffer was cleared as the thread in this function
     // was waiting to acquire |crit_| in order to return. Wait for the
     // remaining time and then return.
@@ -220,6 +138,129 @@ FrameBuffer::ReturnReason FrameBuffer::NextFrame(
   return kTimeout;
 }
 
+FrameBuffer::ReturnReason FrameBuffer::TryNextFrame(
+    std::unique_ptr<EncodedFrame>* frame_out,
+    int64_t* wait_ms_out,
+    bool keyframe_required) {
+  TRACE_EVENT0("webrtc", "FrameBuffer::TryNextFrame");
+  rtc::CritScope lock(&crit_);
+  if (stopped_)
+    return kStopped;
+
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  const int64_t wait_ms = FindNextFrame(now_ms, keyframe_required);
+  if (!next_frame_) {
+    *wait_ms_out = -1;
+    return kTimeout;
+  }
+  if (wait_ms > 0) {
+    *wait_ms_out = wait_ms;
+    return kTimeout;
+  }
+  *frame_out = GetNextFrame(now_ms);
+  return kFrameFound;
+}
+
+int64_t FrameBuffer::FindNextFrame(int64_t now_ms, bool keyframe_required) {
+  int64_t wait_ms = 0;
+  next_frame_.reset();
+
+  // Only frames that are continuous and whose references have been
+  // decoded are candidates, so there is no need to look at any others.
+  for (const VideoLayerFrameId& id : ready_frames_) {
+    FrameInfo* info = FindFrameInfo(id);
+    RTC_DCHECK(info && info->frame);
+    EncodedFrame* frame = info->frame.get();
+
+    if (keyframe_required && !frame->is_keyframe())
+      continue;
+
+    next_frame_ = id;
+    if (frame->RenderTime() == -1)
+      frame->SetRenderTime(timing_->RenderTimeMs(frame->Timestamp(), now_ms));
+    wait_ms = timing_->MaxWaitingTime(frame->RenderTime(), now_ms);
+
+    // This will cause the frame buffer to prefer high framerate rather
+    // than high resolution in the case of the decoder not decoding fast
+    // enough and the stream has multiple spatial and temporal layers.
+    // For multiple temporal layers it may cause non-base layer frames to be
+    // skipped if they are late.
+    if (wait_ms < -kMaxAllowedFrameDelayMs)
+      continue;
+
+    break;
+  }
+  return wait_ms;
+}
+
+std::unique_ptr<EncodedFrame> FrameBuffer::GetNextFrame(int64_t now_ms) {
+  RTC_DCHECK(next_frame_);
+  const VideoLayerFrameId frame_key = *next_frame_;
+  FrameInfo* info = FindFrameInfo(frame_key);
+  RTC_DCHECK(info && info->frame);
+  std::unique_ptr<EncodedFrame> frame = std::move(info->frame);
+
+  if (!frame->delayed_by_retransmission()) {
+    int64_t frame_delay;
+
+    if (inter_frame_delay_.CalculateDelay(frame->Timestamp(), &frame_delay,
+                                          frame->ReceivedTime())) {
+      jitter_estimator_->UpdateEstimate(frame_delay, frame->size());
+    }
+
+    float rtt_mult = protection_mode_ == kProtectionNackFEC ? 0.0 : 1.0;
+    if (RttMultExperiment::RttMultEnabled()) {
+      rtt_mult = RttMultExperiment::GetRttMultValue();
+    }
+    timing_->SetJitterDelay(jitter_estimator_->GetJitterEstimate(rtt_mult));
+    timing_->UpdateCurrentDelay(frame->RenderTime(), now_ms);
+  } else {
+    if (RttMultExperiment::RttMultEnabled() ||
+        webrtc::field_trial::IsEnabled("WebRTC-AddRttToPlayoutDelay"))
+      jitter_estimator_->FrameNacked();
+  }
+
+  // Gracefully handle bad RTP timestamps and render time issues.
+  if (HasBadRenderTiming(*frame, now_ms)) {
+    jitter_estimator_->Reset();
+    timing_->Reset();
+    frame->SetRenderTime(timing_->RenderTimeMs(frame->Timestamp(), now_ms));
+  }
+
+  UpdateJitterDelay();
+  UpdateTimingFrameInfo();
+  PropagateDecodability(*info);
+
+  // Sanity check for RTP timestamp monotonicity.
+  if (last_decoded_frame_) {
+    const VideoLayerFrameId& last_decoded_frame_key = *last_decoded_frame_;
+
+    const bool frame_is_higher_spatial_layer_of_last_decoded_frame =
+        last_decoded_frame_timestamp_ == frame->Timestamp() &&
+        last_decoded_frame_key.picture_id == frame_key.picture_id &&
+        last_decoded_frame_key.spatial_layer < frame_key.spatial_layer;
+
+    if (AheadOrAt(last_decoded_frame_timestamp_, frame->Timestamp()) &&
+        !frame_is_higher_spatial_layer_of_last_decoded_frame) {
+      // TODO(brandtr): Consider clearing the entire buffer when we hit
+      // these conditions.
+      RTC_LOG(LS_WARNING)
+          << "Frame with (timestamp:picture_id:spatial_id) ("
+          << frame->Timestamp() << ":" << frame->id.picture_id << ":"
+          << static_cast<int>(frame->id.spatial_layer) << ")"
+          << " sent to decoder after frame with"
+          << " (timestamp:picture_id:spatial_id) ("
+          << last_decoded_frame_timestamp_ << ":"
+          << last_decoded_frame_key.picture_id << ":"
+          << static_cast<int>(last_decoded_frame_key.spatial_layer) << ").";
+    }
+  }
+
+  AdvanceLastDecodedFrame(frame_key);
+  last_decoded_frame_timestamp_ = frame->Timestamp();
+  return frame;
+}
+
 bool FrameBuffer::HasBadRenderTiming(const EncodedFrame& frame,
                                      int64_t now_ms) {
   // Assume that render timing errors are due to changes in the video stream.
@@ -316,9 +357,7 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
   rtc::CritScope lock(&crit_);
 
   int64_t last_continuous_picture_id =
-      last_continuous_frame_it_ == frames_.end()
-          ? -1
-          : last_continuous_frame_it_->first.picture_id;
+      last_continuous_frame_ ? last_continuous_frame_->picture_id : -1;
 
   if (!ValidReferences(*frame)) {
     RTC_LOG(LS_WARNING) << "Frame with (picture_id:spatial_id) ("
@@ -346,8 +385,7 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
     }
   }
 
-  if (last_decoded_frame_it_ != frames_.end() &&
-      id <= last_decoded_frame_it_->first) {
+  if (last_decoded_frame_ && id <= *last_decoded_frame_) {
     if (AheadOf(frame->Timestamp(), last_decoded_frame_timestamp_) &&
         frame->is_keyframe()) {
       // If this frame has a newer timestamp but an earlier picture id then we
@@ -364,28 +402,16 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
                           << id.picture_id << ":"
                           << static_cast<int>(id.spatial_layer)
                           << ") inserted after frame ("
-                          << last_decoded_frame_it_->first.picture_id << ":"
+                          << last_decoded_frame_->picture_id << ":"
                           << static_cast<int>(
-                                 last_decoded_frame_it_->first.spatial_layer)
+                                 last_decoded_frame_->spatial_layer)
                           << ") was handed off for decoding, dropping frame.";
       return last_continuous_picture_id;
     }
   }
 
-  // Test if inserting this frame would cause the order of the frames to become
-  // ambiguous (covering more than half the interval of 2^16). This can happen
-  // when the picture id make large jumps mid stream.
-  if (!frames_.empty() && id < frames_.begin()->first &&
-      frames_.rbegin()->first < id) {
-    RTC_LOG(LS_WARNING)
-        << "A jump in picture id was detected, clearing buffer.";
-    ClearFramesAndHistory();
-    last_continuous_picture_id = -1;
-  }
-
-  auto info = frames_.emplace(id, FrameInfo()).first;
-
-  if (info->second.frame) {
+  FrameInfo* info = EmplaceFrameInfo(id);
+  if (info->frame) {
     RTC_LOG(LS_WARNING) << "Frame with (picture_id:spatial_id) ("
                         << id.picture_id << ":"
                         << static_cast<int>(id.spatial_layer)
@@ -393,17 +419,20 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
     return last_continuous_picture_id;
   }
 
-  if (!UpdateFrameInfoWithIncomingFrame(*frame, info))
+  if (!UpdateFrameInfoWithIncomingFrame(*frame))
     return last_continuous_picture_id;
   UpdatePlayoutDelays(*frame);
 
-  info->second.frame = std::move(frame);
+  // Registering the dependencies may have moved the entry.
+  info = FindFrameInfo(id);
+  RTC_DCHECK(info);
+  info->frame = std::move(frame);
   ++num_frames_buffered_;
 
-  if (info->second.num_missing_continuous == 0) {
-    info->second.continuous = true;
-    PropagateContinuity(info);
-    last_continuous_picture_id = last_continuous_frame_it_->first.picture_id;
+  if (info->num_missing_continuous == 0) {
+    info->continuous = true;
+    PropagateContinuity(id);
+    last_continuous_picture_id = last_continuous_frame_->picture_id;
 
     // Since we now have new continuous frames there might be a better frame
     // to return from NextFrame. Signal that thread so that it again can choose
@@ -414,35 +443,221 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
   return last_continuous_picture_id;
 }
 
-void FrameBuffer::PropagateContinuity(FrameMap::iterator start) {
+FrameBuffer::FrameInfo* FrameBuffer::FindFrameInfo(
+    const VideoLayerFrameId& id) {
+  if (id.picture_id >= first_picture_id_ &&
+      id.picture_id - first_picture_id_ <
+          static_cast<int64_t>(picture_capacity_) &&
+      id.spatial_layer < layers_per_picture_) {
+    FrameInfo& info =
+        frames_[TableIndex(id, picture_capacity_, layers_per_picture_)];
+    if (info.id == id)
+      return &info;
+  }
+  if (overflow_frames_.empty())
+    return nullptr;
+  auto it = overflow_frames_.find(id);
+  return it != overflow_frames_.end() ? &it->second : nullptr;
+}
+
+FrameBuffer::FrameInfo* FrameBuffer::EmplaceFrameInfo(
+    const VideoLayerFrameId& id) {
+  if (!overflow_frames_.empty()) {
+    auto it = overflow_frames_.find(id);
+    if (it != overflow_frames_.end())
+      return &it->second;
+  }
+
+  bool fits_in_table = id.spatial_layer < kMaxLayersPerPicture;
+  if (fits_in_table && num_frame_infos_ > 0 &&
+      id.picture_id < first_picture_id_) {
+    // Newer frames are not moved out of the table to make room for older
+    // frames.
+    fits_in_table = newest_picture_id_ - id.picture_id <
+                    static_cast<int64_t>(kMaxPictureCapacity);
+  }
+  if (!fits_in_table) {
+    FrameInfo& info = overflow_frames_[id];
+    info.id = id;
+    return &info;
+  }
+
+  if (id.spatial_layer >= layers_per_picture_)
+    ResizeFrameTable(picture_capacity_, id.spatial_layer + 1);
+
+  if (num_frame_infos_ == 0) {
+    first_picture_id_ = id.picture_id;
+    newest_picture_id_ = id.picture_id;
+  } else if (id.picture_id < first_picture_id_) {
+    const int64_t span = newest_picture_id_ - id.picture_id;
+    size_t capacity = picture_capacity_;
+    while (span >= static_cast<int64_t>(capacity))
+      capacity *= 2;
+    if (capacity != picture_capacity_)
+      ResizeFrameTable(capacity, layers_per_picture_);
+    first_picture_id_ = id.picture_id;
+  } else if (id.picture_id - first_picture_id_ >=
+             static_cast<int64_t>(picture_capacity_)) {
+    if (id.picture_id - first_picture_id_ >=
+        static_cast<int64_t>(kMaxPictureCapacity)) {
+      MoveFramesToOverflowBefore(VideoLayerFrameId(
+          id.picture_id - static_cast<int64_t>(kMaxPictureCapacity) + 1, 0));
+      if (num_frame_infos_ == 0)
+        first_picture_id_ = id.picture_id;
+    }
+    size_t capacity = picture_capacity_;
+    while (id.picture_id - first_picture_id_ >= static_cast<int64_t>(capacity))
+      capacity *= 2;
+    if (capacity != picture_capacity_)
+      ResizeFrameTable(capacity, layers_per_picture_);
+  }
+  newest_picture_id_ = std::max(newest_picture_id_, id.picture_id);
+
+  FrameInfo& info =
+      frames_[TableIndex(id, picture_capacity_, layers_per_picture_)];
+  if (info.id != id) {
+    RTC_DCHECK_LT(info.id.picture_id, 0);
+    info.id = id;
+    ++num_frame_infos_;
+  }
+  return &info;
+}
+
+void FrameBuffer::MoveFramesToOverflowBefore(const VideoLayerFrameId& id) {
+  TRACE_EVENT0("webrtc", "FrameBuffer::MoveFramesToOverflowBefore");
+  const int64_t num_pictures =
+      std::min<int64_t>(id.picture_id - first_picture_id_ + 1,
+                        static_cast<int64_t>(picture_capacity_));
+  for (int64_t i = 0; i < num_pictures && num_frame_infos_ > 0; ++i) {
+    const size_t index =
+        static_cast<size_t>((first_picture_id_ + i) & (picture_capacity_ - 1)) *
+        layers_per_picture_;
+    for (size_t layer = 0; layer < layers_per_picture_; ++layer) {
+      FrameInfo* info = &frames_[index + layer];
+      if (info->id.picture_id >= 0 && info->id < id) {
+        overflow_frames_[info->id] = std::move(*info);
+        *info = FrameInfo();
+        --num_frame_infos_;
+      }
+    }
+  }
+  first_picture_id_ = std::max(first_picture_id_, id.picture_id);
+}
+
+void FrameBuffer::ResizeFrameTable(size_t picture_capacity,
+                                   size_t layers_per_picture) {
+  TRACE_EVENT0("webrtc", "FrameBuffer::ResizeFrameTable");
+  RTC_DCHECK_GE(picture_capacity, picture_capacity_);
+  RTC_DCHECK_LE(picture_capacity, kMaxPictureCapacity);
+  RTC_DCHECK_GE(layers_per_picture, layers_per_picture_);
+  RTC_DCHECK_LE(layers_per_picture, kMaxLayersPerPicture);
+  std::vector<FrameInfo> frames(picture_capacity * layers_per_picture);
+  for (FrameInfo& info : frames_) {
+    if (info.id.picture_id >= 0) {
+      frames[TableIndex(info.id, picture_capacity, layers_per_picture)] =
+          std::move(info);
+    }
+  }
+  frames_ = std::move(frames);
+  picture_capacity_ = picture_capacity;
+  layers_per_picture_ = layers_per_picture;
+}
+
+void FrameBuffer::EraseFramesBefore(const VideoLayerFrameId& id) {
+  const int64_t num_pictures =
+      std::min<int64_t>(id.picture_id - first_picture_id_ + 1,
+                        static_cast<int64_t>(picture_capacity_));
+  for (int64_t i = 0; i < num_pictures && num_frame_infos_ > 0; ++i) {
+    const size_t index =
+        static_cast<size_t>((first_picture_id_ + i) & (picture_capacity_ - 1)) *
+        layers_per_picture_;
+    for (size_t layer = 0; layer < layers_per_picture_; ++layer) {
+      FrameInfo* info = &frames_[index + layer];
+      if (info->id.picture_id >= 0 && info->id < id)
+        EraseFrameInfo(info);
+    }
+  }
+  first_picture_id_ = std::max(first_picture_id_, id.picture_id);
+
+  while (!overflow_frames_.empty() && overflow_frames_.begin()->first < id)
+    EraseFrameInfo(&overflow_frames_.begin()->second);
+}
+
+void FrameBuffer::EraseFrameInfo(FrameInfo* info) {
+  if (info->frame) {
+    --num_frames_buffered_;
+    if (info->continuous && info->num_missing_decodable == 0) {
+      auto it = std::lower_bound(ready_frames_.begin(), ready_frames_.end(),
+                                 info->id);
+      RTC_DCHECK(it != ready_frames_.end() && *it == info->id);
+      ready_frames_.erase(it);
+    }
+  }
+  if (next_frame_ == info->id)
+    next_frame_.reset();
+
+  if (!overflow_frames_.empty()) {
+    auto it = overflow_frames_.find(info->id);
+    if (it != overflow_frames_.end() && &it->second == info) {
+      overflow_frames_.erase(it);
+      return;
+    }
+  }
+  *info = FrameInfo();
+  --num_frame_infos_;
+}
+
+void FrameBuffer::MaybeAddToReadyFrames(const FrameInfo& info) {
+  if (!info.frame || !info.continuous || info.num_missing_decodable > 0)
+    return;
+  auto it =
+      std::lower_bound(ready_frames_.begin(), ready_frames_.end(), info.id);
+  if (it == ready_frames_.end() || *it != info.id)
+    ready_frames_.insert(it, info.id);
+}
+
+bool FrameBuffer::WasDecoded(const VideoLayerFrameId& id) const {
+  // Frames usually reference recently decoded frames, so search from the
+  // most recent one.
+  for (size_t i = num_frames_history_; i > 0; --i) {
+    if (decoded_history_[(decoded_history_begin_ + i - 1) %
+                         kMaxFramesHistory] == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FrameBuffer::PropagateContinuity(const VideoLayerFrameId& start) {
   TRACE_EVENT0("webrtc", "FrameBuffer::PropagateContinuity");
-  RTC_DCHECK(start->second.continuous);
-  if (last_continuous_frame_it_ == frames_.end())
-    last_continuous_frame_it_ = start;
+  RTC_DCHECK(FindFrameInfo(start)->continuous);
+  if (!last_continuous_frame_)
+    last_continuous_frame_ = start;
 
-  std::queue<FrameMap::iterator> continuous_frames;
+  std::queue<VideoLayerFrameId> continuous_frames;
   continuous_frames.push(start);
 
   // A simple BFS to traverse continuous frames.
   while (!continuous_frames.empty()) {
-    auto frame = continuous_frames.front();
+    FrameInfo* frame = FindFrameInfo(continuous_frames.front());
     continuous_frames.pop();
 
-    if (last_continuous_frame_it_->first < frame->first)
-      last_continuous_frame_it_ = frame;
+    if (*last_continuous_frame_ < frame->id)
+      last_continuous_frame_ = frame->id;
+    MaybeAddToReadyFrames(*frame);
 
     // Loop through all dependent frames, and if that frame no longer has
     // any unfulfilled dependencies then that frame is continuous as well.
-    for (size_t d = 0; d < frame->second.num_dependent_frames; ++d) {
-      auto frame_ref = frames_.find(frame->second.dependent_frames[d]);
-      RTC_DCHECK(frame_ref != frames_.end());
+    for (size_t d = 0; d < frame->num_dependent_frames; ++d) {
+      FrameInfo* frame_ref = FindFrameInfo(frame->dependent_frames[d]);
+      RTC_DCHECK(frame_ref);
 
       // TODO(philipel): Look into why we've seen this happen.
-      if (frame_ref != frames_.end()) {
-        --frame_ref->second.num_missing_continuous;
-        if (frame_ref->second.num_missing_continuous == 0) {
-          frame_ref->second.continuous = true;
-          continuous_frames.push(frame_ref);
+      if (frame_ref) {
+        --frame_ref->num_missing_continuous;
+        if (frame_ref->num_missing_continuous == 0) {
+          frame_ref->continuous = true;
+          continuous_frames.push(frame_ref->id);
         }
       }
     }
@@ -453,48 +668,47 @@ void FrameBuffer::PropagateDecodability(const FrameInfo& info) {
   TRACE_EVENT0("webrtc", "FrameBuffer::PropagateDecodability");
   RTC_CHECK(info.num_dependent_frames < FrameInfo::kMaxNumDependentFrames);
   for (size_t d = 0; d < info.num_dependent_frames; ++d) {
-    auto ref_info = frames_.find(info.dependent_frames[d]);
-    RTC_DCHECK(ref_info != frames_.end());
+    FrameInfo* ref_info = FindFrameInfo(info.dependent_frames[d]);
+    RTC_DCHECK(ref_info);
     // TODO(philipel): Look into why we've seen this happen.
-    if (ref_info != frames_.end()) {
-      RTC_DCHECK_GT(ref_info->second.num_missing_decodable, 0U);
-      --ref_info->second.num_missing_decodable;
+    if (ref_info) {
+      RTC_DCHECK_GT(ref_info->num_missing_decodable, 0U);
+      --ref_info->num_missing_decodable;
+      MaybeAddToReadyFrames(*ref_info);
     }
   }
 }
 
-void FrameBuffer::AdvanceLastDecodedFrame(FrameMap::iterator decoded) {
+void FrameBuffer::AdvanceLastDecodedFrame(const VideoLayerFrameId& decoded) {
   TRACE_EVENT0("webrtc", "FrameBuffer::AdvanceLastDecodedFrame");
-  if (last_decoded_frame_it_ == frames_.end()) {
-    last_decoded_frame_it_ = frames_.begin();
-  } else {
-    RTC_DCHECK(last_decoded_frame_it_->first < decoded->first);
-    ++last_decoded_frame_it_;
-  }
+  RTC_DCHECK(!last_decoded_frame_ || *last_decoded_frame_ < decoded);
   --num_frames_buffered_;
-  ++num_frames_history_;
-
-  // First, delete non-decoded frames from the history.
-  while (last_decoded_frame_it_ != decoded) {
-    if (last_decoded_frame_it_->second.frame)
-      --num_frames_buffered_;
-    last_decoded_frame_it_ = frames_.erase(last_decoded_frame_it_);
-  }
 
-  // Then remove old history if we have too much history saved.
-  if (num_frames_history_ > kMaxFramesHistory) {
-    frames_.erase(frames_.begin());
-    --num_frames_history_;
+  // First, delete non-decoded frames before the decoded frame. Since frames
+  // are decoded in order, the decoded frame is then the first ready frame.
+  EraseFramesBefore(decoded);
+  RTC_DCHECK(!ready_frames_.empty() && ready_frames_.front() == decoded);
+  ready_frames_.erase(ready_frames_.begin());
+  EraseFrameInfo(FindFrameInfo(decoded));
+
+  // Then save it in the history, replacing the oldest entry if the history is
+  // full.
+  if (num_frames_history_ < kMaxFramesHistory) {
+    decoded_history_[(decoded_history_begin_ + num_frames_history_) %
+                     kMaxFramesHistory] = decoded;
+    ++num_frames_history_;
+  } else {
+    decoded_history_[decoded_history_begin_] = decoded;
+    decoded_history_begin_ = (decoded_history_begin_ + 1) % kMaxFramesHistory;
   }
+  last_decoded_frame_ = decoded;
 }
 
-bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
-                                                   FrameMap::iterator info) {
+bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame) {
   TRACE_EVENT0("webrtc", "FrameBuffer::UpdateFrameInfoWithIncomingFrame");
   const VideoLayerFrameId& id = frame.id;
 
-  RTC_DCHECK(last_decoded_frame_it_ == frames_.end() ||
-             last_decoded_frame_it_->first < info->first);
+  RTC_DCHECK(!last_decoded_frame_ || *last_decoded_frame_ < id);
 
   // In this function we determine how many missing dependencies this |frame|
   // has to become continuous/decodable. If a frame that this |frame| depend
@@ -513,14 +727,12 @@ bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
   // Find all dependencies that have not yet been fulfilled.
   for (size_t i = 0; i < frame.num_references; ++i) {
     VideoLayerFrameId ref_key(frame.references[i], frame.id.spatial_layer);
-    auto ref_info = frames_.find(ref_key);
 
     // Does |frame| depend on a frame earlier than the last decoded one?
-    if (last_decoded_frame_it_ != frames_.end() &&
-        ref_key <= last_decoded_frame_it_->first) {
+    if (last_decoded_frame_ && ref_key <= *last_decoded_frame_) {
       // Was that frame decoded? If not, this |frame| will never become
       // decodable.
-      if (ref_info == frames_.end()) {
+      if (!WasDecoded(ref_key)) {
         int64_t now_ms = clock_->TimeInMilliseconds();
         if (last_log_non_decoded_ms_ + kLogNonDecodedIntervalMs < now_ms) {
           RTC_LOG(LS_WARNING)
@@ -533,8 +745,8 @@ bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
         return false;
       }
     } else {
-      bool ref_continuous =
-          ref_info != frames_.end() && ref_info->second.continuous;
+      const FrameInfo* ref_info = FindFrameInfo(ref_key);
+      bool ref_continuous = ref_info && ref_info->continuous;
       not_yet_fulfilled_dependencies.push_back({ref_key, ref_continuous});
     }
   }
@@ -542,29 +754,35 @@ bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
   // Does |frame| depend on the lower spatial layer?
   if (frame.inter_layer_predicted) {
     VideoLayerFrameId ref_key(frame.id.picture_id, frame.id.spatial_layer - 1);
-    auto ref_info = frames_.find(ref_key);
+    const FrameInfo* ref_info = FindFrameInfo(ref_key);
 
+    bool lower_layer_decoded = last_decoded_frame_ == ref_key;
     bool lower_layer_continuous =
-        ref_info != frames_.end() && ref_info->second.continuous;
-    bool lower_layer_decoded = last_decoded_frame_it_ != frames_.end() &&
-                               last_decoded_frame_it_->first == ref_key;
+        lower_layer_decoded || (ref_info && ref_info->continuous);
 
-    if (!lower_layer_continuous || !lower_layer_decoded) {
+    if (!lower_layer_decoded) {
       not_yet_fulfilled_dependencies.push_back(
           {ref_key, lower_layer_continuous});
     }
   }
 
-  info->second.num_missing_continuous = not_yet_fulfilled_dependencies.size();
-  info->second.num_missing_decodable = not_yet_fulfilled_dependencies.size();
+  // At this point we know we want to insert this frame, so here we
+  // intentionally get or create the FrameInfo for each dependency. Since that
+  // may move the entries, it is done before any of them are updated.
+  for (const Dependency& dep : not_yet_fulfilled_dependencies)
+    EmplaceFrameInfo(dep.id);
+
+  FrameInfo* info = FindFrameInfo(id);
+  RTC_DCHECK(info);
+  info->num_missing_continuous = not_yet_fulfilled_dependencies.size();
+  info->num_missing_decodable = not_yet_fulfilled_dependencies.size();
 
   for (const Dependency& dep : not_yet_fulfilled_dependencies) {
     if (dep.continuous)
-      --info->second.num_missing_continuous;
+      --info->num_missing_continuous;
 
-    // At this point we know we want to insert this frame, so here we
-    // intentionally get or create the FrameInfo for this dependency.
-    FrameInfo* dep_info = &frames_[dep.id];
+    FrameInfo* dep_info = FindFrameInfo(dep.id);
+    RTC_DCHECK(dep_info);
 
     if (dep_info->num_dependent_frames <
         (FrameInfo::kMaxNumDependentFrames - 1)) {
@@ -612,15 +830,24 @@ void FrameBuffer::UpdateTimingFrameInfo() {
 void FrameBuffer::ClearFramesAndHistory() {
   TRACE_EVENT0("webrtc", "FrameBuffer::ClearFramesAndHistory");
   frames_.clear();
-  last_decoded_frame_it_ = frames_.end();
-  last_continuous_frame_it_ = frames_.end();
-  next_frame_it_ = frames_.end();
+  frames_.resize(kInitialPictureCapacity);
+  picture_capacity_ = kInitialPictureCapacity;
+  layers_per_picture_ = 1;
+  num_frame_infos_ = 0;
+  overflow_frames_.clear();
+  ready_frames_.clear();
+  decoded_history_begin_ = 0;
+  last_decoded_frame_.reset();
+  last_continuous_frame_.reset();
+  next_frame_.reset();
   num_frames_history_ = 0;
   num_frames_buffered_ = 0;
 }
 
 FrameBuffer::FrameInfo::FrameInfo() = default;
 FrameBuffer::FrameInfo::FrameInfo(FrameInfo&&) = default;
+FrameBuffer::FrameInfo& FrameBuffer::FrameInfo::operator=(FrameInfo&&) =
+    default;
 FrameBuffer::FrameInfo::~FrameInfo() = default;
 
 }  // namespace video_coding
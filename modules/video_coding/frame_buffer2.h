@@ -15,7 +15,9 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/types/optional.h"
 #include "api/video/encoded_frame.h"
 #include "modules/video_coding/include/video_coding_defines.h"
 #include "modules/video_coding/inter_frame_delay.h"
@@ -62,6 +64,19 @@ class FrameBuffer {
                          std::unique_ptr<EncodedFrame>* frame_out,
                          bool keyframe_required = false);
 
+  // Non-blocking version of NextFrame, for callers that do the waiting
+  // themselves.
+  //  - If a frame is due for decoding it will return kFrameFound and set
+  //    |frame_out| to the resulting frame.
+  //  - Otherwise it will return kTimeout and set |wait_ms_out| to the time
+  //    until the next frame is due, or to -1 if there is no decodable frame.
+  //    A new frame may become decodable whenever InsertFrame returns a picture
+  //    id other than -1.
+  //  - If the FrameBuffer is stopped then it will return kStopped.
+  ReturnReason TryNextFrame(std::unique_ptr<EncodedFrame>* frame_out,
+                            int64_t* wait_ms_out,
+                            bool keyframe_required = false);
+
   // Tells the FrameBuffer which protection mode that is in use. Affects
   // the frame timing.
   // TODO(philipel): Remove this when new timing calculations has been
@@ -83,15 +98,18 @@ class FrameBuffer {
   struct FrameInfo {
     FrameInfo();
     FrameInfo(FrameInfo&&);
+    FrameInfo& operator=(FrameInfo&&);
     ~FrameInfo();
 
     // The maximum number of frames that can depend on this frame.
     static constexpr size_t kMaxNumDependentFrames = 8;
 
+    // The id of the frame this entry belongs to. The picture id is -1 if the
+    // entry is unused.
+    VideoLayerFrameId id;
+
     // Which other frames that have direct unfulfilled dependencies
     // on this frame.
-    // TODO(philipel): Add simple modify/access functions to prevent adding too
-    // many |dependent_frames|.
     VideoLayerFrameId dependent_frames[kMaxNumDependentFrames];
     size_t num_dependent_frames = 0;
 
@@ -113,7 +131,15 @@ class FrameBuffer {
     std::unique_ptr<EncodedFrame> frame;
   };
 
-  using FrameMap = std::map<VideoLayerFrameId, FrameInfo>;
+  // Sets |next_frame_| to the frame that should be decoded next, if any, and
+  // returns the time until it should be decoded.
+  int64_t FindNextFrame(int64_t now_ms, bool keyframe_required)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Takes |next_frame_| out of the buffer and updates the timing and the
+  // decodability of the frames that depend on it.
+  std::unique_ptr<EncodedFrame> GetNextFrame(int64_t now_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Check that the references of |frame| are valid.
   bool ValidReferences(const EncodedFrame& frame) const;
@@ -123,25 +149,59 @@ class FrameBuffer {
   void UpdatePlayoutDelays(const EncodedFrame& frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
+  // Returns the entry of |id| in |frames_| or |overflow_frames_|, or nullptr
+  // if there is none.
+  FrameInfo* FindFrameInfo(const VideoLayerFrameId& id)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Returns the entry of |id|, creating it if needed. Invalidates pointers to
+  // other entries.
+  FrameInfo* EmplaceFrameInfo(const VideoLayerFrameId& id)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Moves the entries of |frames_| with an id lower than |id| to
+  // |overflow_frames_|.
+  void MoveFramesToOverflowBefore(const VideoLayerFrameId& id)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Resizes |frames_| so that it holds |picture_capacity| pictures of
+  // |layers_per_picture| spatial layers each, keeping all entries.
+  void ResizeFrameTable(size_t picture_capacity, size_t layers_per_picture)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Removes all entries with an id lower than |id|, from both tables.
+  void EraseFramesBefore(const VideoLayerFrameId& id)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  void EraseFrameInfo(FrameInfo* info) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Adds the frame of |info| to |ready_frames_| if it is continuous and all
+  // its references have been decoded.
+  void MaybeAddToReadyFrames(const FrameInfo& info)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Returns true if |id| is one of the last decoded frames.
+  bool WasDecoded(const VideoLayerFrameId& id) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Update all directly dependent and indirectly dependent frames and mark
   // them as continuous if all their references has been fulfilled.
-  void PropagateContinuity(FrameMap::iterator start)
+  void PropagateContinuity(const VideoLayerFrameId& start)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Marks the frame as decoded and updates all directly dependent frames.
   void PropagateDecodability(const FrameInfo& info)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
-  // Advances |last_decoded_frame_it_| to |decoded| and removes old
-  // frame info.
-  void AdvanceLastDecodedFrame(FrameMap::iterator decoded)
+  // Makes |decoded| the last decoded frame, and removes it and all frames
+  // before it from |frames_|.
+  void AdvanceLastDecodedFrame(const VideoLayerFrameId& decoded)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Update the corresponding FrameInfo of |frame| and all FrameInfos that
   // |frame| references.
   // Return false if |frame| will never be decodable, true otherwise.
-  bool UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
-                                        FrameMap::iterator info)
+  bool UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   void UpdateJitterDelay() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
@@ -153,7 +213,33 @@ class FrameBuffer {
   bool HasBadRenderTiming(const EncodedFrame& frame, int64_t now_ms)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
-  FrameMap frames_ RTC_GUARDED_BY(crit_);
+  // The frames that have not been decoded yet, and placeholders for frames
+  // they reference that have not been received yet. The table is a ring
+  // indexed by picture id, with |layers_per_picture_| consecutive entries per
+  // picture, covering |picture_capacity_| picture ids from
+  // |first_picture_id_|.
+  std::vector<FrameInfo> frames_ RTC_GUARDED_BY(crit_);
+  size_t picture_capacity_ RTC_GUARDED_BY(crit_);
+  size_t layers_per_picture_ RTC_GUARDED_BY(crit_);
+  int64_t first_picture_id_ RTC_GUARDED_BY(crit_);
+  int64_t newest_picture_id_ RTC_GUARDED_BY(crit_);
+  // The number of used entries in |frames_|.
+  size_t num_frame_infos_ RTC_GUARDED_BY(crit_);
+  // Entries that do not fit in |frames_|, because they are too far behind the
+  // newest picture or have a high spatial layer. The number of frames is only
+  // limited by kMaxFramesBuffered, so these are kept like any other.
+  std::map<VideoLayerFrameId, FrameInfo> overflow_frames_ RTC_GUARDED_BY(crit_);
+
+  // Frames that are continuous and whose references have all been decoded,
+  // in decoding order. The next frame to decode is the first frame in this
+  // list that is not too late.
+  std::vector<VideoLayerFrameId> ready_frames_ RTC_GUARDED_BY(crit_);
+
+  // The ids of the last decoded frames, with the most recent one at
+  // |decoded_history_[(decoded_history_begin_ + num_frames_history_ - 1) %
+  // kMaxFramesHistory]|.
+  std::vector<VideoLayerFrameId> decoded_history_ RTC_GUARDED_BY(crit_);
+  size_t decoded_history_begin_ RTC_GUARDED_BY(crit_);
 
   rtc::CriticalSection crit_;
   Clock* const clock_;
@@ -162,10 +248,11 @@ class FrameBuffer {
   VCMTiming* const timing_ RTC_GUARDED_BY(crit_);
   VCMInterFrameDelay inter_frame_delay_ RTC_GUARDED_BY(crit_);
   uint32_t last_decoded_frame_timestamp_ RTC_GUARDED_BY(crit_);
-  FrameMap::iterator last_decoded_frame_it_ RTC_GUARDED_BY(crit_);
-  FrameMap::iterator last_continuous_frame_it_ RTC_GUARDED_BY(crit_);
-  FrameMap::iterator next_frame_it_ RTC_GUARDED_BY(crit_);
-  int num_frames_history_ RTC_GUARDED_BY(crit_);
+  absl::optional<VideoLayerFrameId> last_decoded_frame_ RTC_GUARDED_BY(crit_);
+  absl::optional<VideoLayerFrameId> last_continuous_frame_
+      RTC_GUARDED_BY(crit_);
+  absl::optional<VideoLayerFrameId> next_frame_ RTC_GUARDED_BY(crit_);
+  size_t num_frames_history_ RTC_GUARDED_BY(crit_);
   int num_frames_buffered_ RTC_GUARDED_BY(crit_);
   bool stopped_ RTC_GUARDED_BY(crit_);
   VCMVideoProtection protection_mode_ RTC_GUARDED_BY(crit_);
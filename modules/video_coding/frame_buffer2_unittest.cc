@@ -600,5 +600,119 @@ TEST_F(TestFrameBuffer2, DontUpdateOnUndecodableFrame) {
   ExtractFrame(0, true);
 }
 
+TEST_F(TestFrameBuffer2, LargePictureIdGapsBetweenBufferedFrames) {
+  EXPECT_EQ(0, InsertFrame(0, 0, 1000, false));
+  EXPECT_EQ(0, InsertFrame(2000, 0, 3000, false, 1000));
+  EXPECT_EQ(2000, InsertFrame(1000, 0, 2000, false, 0));
+  EXPECT_EQ(3000, InsertFrame(3000, 0, 4000, false, 2000));
+  for (int i = 0; i < 4; ++i)
+    ExtractFrame();
+
+  CheckFrame(0, 0, 0);
+  CheckFrame(1, 1000, 0);
+  CheckFrame(2, 2000, 0);
+  CheckFrame(3, 3000, 0);
+}
+
+TEST_F(TestFrameBuffer2, KeepFramesFarBehindNewestFrame) {
+  EXPECT_EQ(1, InsertFrame(1, 0, 1000, false));
+  EXPECT_EQ(2, InsertFrame(2, 0, 2000, false, 1));
+  // Frames that are more than 4096 picture ids older than the newest frame
+  // are still buffered and decoded in order.
+  EXPECT_EQ(10000, InsertFrame(10000, 0, 3000, false));
+  EXPECT_EQ(10000, InsertFrame(3, 0, 2500, false, 2));
+  for (int i = 0; i < 4; ++i)
+    ExtractFrame();
+
+  CheckFrame(0, 1, 0);
+  CheckFrame(1, 2, 0);
+  CheckFrame(2, 3, 0);
+  CheckFrame(3, 10000, 0);
+}
+
+TEST_F(TestFrameBuffer2, FiveSpatialLayers) {
+  uint16_t pid = Rand();
+  uint32_t ts = Rand();
+
+  // The frame table starts out with a single layer per picture, and is
+  // extended with more layers while frames are buffered.
+  for (int i = 0; i < 2; ++i) {
+    for (uint8_t layer = 0; layer < 5; ++layer) {
+      if (i == 0)
+        InsertFrame(pid, layer, ts, layer > 0);
+      else
+        InsertFrame(pid + i, layer, ts + i * kFps10, layer > 0, pid + i - 1);
+    }
+  }
+  for (int i = 0; i < 10; ++i)
+    ExtractFrame();
+
+  for (int i = 0; i < 2; ++i) {
+    for (uint8_t layer = 0; layer < 5; ++layer)
+      CheckFrame(i * 5 + layer, pid + i, layer);
+  }
+}
+
+TEST_F(TestFrameBuffer2, TenSpatialLayers) {
+  uint16_t pid = Rand();
+  uint32_t ts = Rand();
+
+  for (uint8_t layer = 0; layer < 10; ++layer)
+    InsertFrame(pid, layer, ts, layer > 0);
+  for (uint8_t layer = 0; layer < 10; ++layer)
+    InsertFrame(pid + 1, layer, ts + kFps10, layer > 0, pid);
+  for (int i = 0; i < 20; ++i)
+    ExtractFrame();
+
+  for (int i = 0; i < 2; ++i) {
+    for (uint8_t layer = 0; layer < 10; ++layer)
+      CheckFrame(i * 10 + layer, pid + i, layer);
+  }
+}
+
+TEST_F(TestFrameBuffer2, TryNextFrameOnEmptyBuffer) {
+  std::unique_ptr<EncodedFrame> frame;
+  int64_t wait_ms = 0;
+  EXPECT_EQ(FrameBuffer::ReturnReason::kTimeout,
+            buffer_->TryNextFrame(&frame, &wait_ms));
+  EXPECT_FALSE(frame);
+  EXPECT_EQ(-1, wait_ms);
+}
+
+TEST_F(TestFrameBuffer2, TryNextFrameWaitsUntilFrameIsDue) {
+  uint16_t pid = Rand();
+  uint32_t ts = Rand();
+
+  InsertFrame(pid, 0, ts, false);
+  std::unique_ptr<EncodedFrame> frame;
+  int64_t wait_ms = 0;
+  EXPECT_EQ(FrameBuffer::ReturnReason::kTimeout,
+            buffer_->TryNextFrame(&frame, &wait_ms));
+  EXPECT_FALSE(frame);
+  ASSERT_GT(wait_ms, 0);
+
+  clock_.AdvanceTimeMilliseconds(wait_ms);
+  EXPECT_EQ(FrameBuffer::ReturnReason::kFrameFound,
+            buffer_->TryNextFrame(&frame, &wait_ms));
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(pid, frame->id.picture_id);
+
+  // The frame is gone once it has been returned.
+  frame.reset();
+  EXPECT_EQ(FrameBuffer::ReturnReason::kTimeout,
+            buffer_->TryNextFrame(&frame, &wait_ms));
+  EXPECT_EQ(-1, wait_ms);
+}
+
+TEST_F(TestFrameBuffer2, TryNextFrameWhenStopped) {
+  InsertFrame(Rand(), 0, Rand(), false);
+  buffer_->Stop();
+  std::unique_ptr<EncodedFrame> frame;
+  int64_t wait_ms = 0;
+  EXPECT_EQ(FrameBuffer::ReturnReason::kStopped,
+            buffer_->TryNextFrame(&frame, &wait_ms));
+  EXPECT_FALSE(frame);
+}
+
 }  // namespace video_coding
 }  // namespace webrtc
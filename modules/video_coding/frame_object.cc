@@ -27,6 +27,7 @@ RtpFrameObject::RtpFrameObject(PacketBuffer* packet_buffer,
       first_seq_num_(first_seq_num),
       last_seq_num_(last_seq_num),
       received_time_(received_time),
+      buffer_capacity_(0),
       times_nacked_(times_nacked) {
   VCMPacket* first_packet = packet_buffer_->GetPacket(first_seq_num);
   RTC_CHECK(first_packet);
@@ -59,7 +60,7 @@ RtpFrameObject::RtpFrameObject(PacketBuffer* packet_buffer,
   else
     _size = frame_size;
 
-  _buffer = new uint8_t[_size];
+  _buffer = packet_buffer_->AcquireBitstreamBuffer(_size, &buffer_capacity_);
   _length = frame_size;
 
   bool bitstream_copied = GetBitstream(_buffer);
@@ -139,6 +140,16 @@ bool RtpFrameObject::GetBitstream(uint8_t* destination) const {
   return packet_buffer_->GetBitstream(*this, destination);
 }
 
+std::unique_ptr<uint8_t[]> RtpFrameObject::TakeBitstreamBuffer(
+    size_t* capacity) {
+  std::unique_ptr<uint8_t[]> buffer(_buffer);
+  *capacity = buffer_capacity_;
+  _buffer = nullptr;
+  _size = 0;
+  _length = 0;
+  return buffer;
+}
+
 int64_t RtpFrameObject::ReceivedTime() const {
   return received_time_;
 }
@@ -11,6 +11,8 @@
 #ifndef MODULES_VIDEO_CODING_FRAME_OBJECT_H_
 #define MODULES_VIDEO_CODING_FRAME_OBJECT_H_
 
+#include <memory>
+
 #include "absl/types/optional.h"
 #include "api/video/encoded_frame.h"
 #include "common_types.h"  // NOLINT(build/include)
@@ -44,12 +46,19 @@ class RtpFrameObject : public EncodedFrame {
   absl::optional<FrameMarking> GetFrameMarking() const;
 
  private:
+  friend PacketBuffer;
+
+  // Hands the bitstream buffer over to the caller, which allows the packet
+  // buffer to reuse it for a later frame.
+  std::unique_ptr<uint8_t[]> TakeBitstreamBuffer(size_t* capacity);
+
   rtc::scoped_refptr<PacketBuffer> packet_buffer_;
   enum FrameType frame_type_;
   VideoCodecType codec_type_;
   uint16_t first_seq_num_;
   uint16_t last_seq_num_;
   int64_t received_time_;
+  size_t buffer_capacity_;
 
   // Equal to times nacked of the packet with the highet times nacked
   // belonging to this frame.
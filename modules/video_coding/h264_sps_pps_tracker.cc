@@ -118,6 +118,15 @@ H264SpsPpsTracker::PacketAction H264SpsPpsTracker::CopyAndFixBitstream(
   RTC_CHECK(!append_sps_pps ||
             (sps != sps_data_.end() && pps != pps_data_.end()));
 
+  // A payload that references the buffer it was received in and only needs a
+  // start code in front of it is left in place. The packet buffer inserts the
+  // start code when the frame is assembled.
+  if (packet->payload_buffer.size() > 0 && !append_sps_pps &&
+      h264_header.packetization_type != kH264StapA) {
+    packet->insertStartCode = video_header.is_first_packet_in_frame;
+    return kInsert;
+  }
+
   // Calculate how much space we need for the rest of the bitstream.
   size_t required_size = 0;
 
@@ -211,6 +220,7 @@ H264SpsPpsTracker::PacketAction H264SpsPpsTracker::CopyAndFixBitstream(
 
   packet->dataPtr = buffer;
   packet->sizeBytes = required_size;
+  packet->payload_buffer = rtc::CopyOnWriteBuffer();
   return kInsert;
 }
 
@@ -31,6 +31,10 @@ class H264SpsPpsTracker {
   H264SpsPpsTracker();
   ~H264SpsPpsTracker();
 
+  // Copies the payload of |packet| into a new buffer with start codes (and
+  // SPS/PPS for keyframes, if supplied out of band) inserted. Payloads that
+  // reference |packet->payload_buffer| and only lack a leading start code are
+  // not copied; |packet->insertStartCode| tells whether one is needed.
   PacketAction CopyAndFixBitstream(VCMPacket* packet);
 
   void InsertSpsPpsNalus(const std::vector<uint8_t>& sps,
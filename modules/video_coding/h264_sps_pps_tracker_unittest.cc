@@ -14,6 +14,7 @@
 
 #include "common_video/h264/h264_common.h"
 #include "modules/video_coding/packet.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "test/gtest.h"
 
 namespace webrtc {
@@ -134,6 +135,24 @@ TEST_F(TestH264SpsPpsTracker, FuAFirstPacket) {
   delete[] packet.dataPtr;
 }
 
+TEST_F(TestH264SpsPpsTracker, FuAFirstPacketWithReferencedPayload) {
+  const uint8_t data[] = {1, 2, 3};
+  rtc::CopyOnWriteBuffer received(data);
+  H264VcmPacket packet;
+  packet.h264().packetization_type = kH264FuA;
+  packet.video_header.is_first_packet_in_frame = true;
+  packet.dataPtr = received.cdata();
+  packet.sizeBytes = received.size();
+  packet.payload_buffer = received;
+
+  // The payload is left in place and the start code is inserted when the
+  // frame is assembled.
+  EXPECT_EQ(H264SpsPpsTracker::kInsert, tracker_.CopyAndFixBitstream(&packet));
+  EXPECT_EQ(packet.dataPtr, received.cdata());
+  EXPECT_EQ(packet.sizeBytes, sizeof(data));
+  EXPECT_TRUE(packet.insertStartCode);
+}
+
 TEST_F(TestH264SpsPpsTracker, StapAIncorrectSegmentLength) {
   uint8_t data[] = {0, 0, 2, 0};
   H264VcmPacket packet;
@@ -28,16 +28,45 @@ const int kProcessFrequency = 50;
 const int kProcessIntervalMs = 1000 / kProcessFrequency;
 const int kMaxReorderedPackets = 128;
 const int kNumReorderingBuckets = 10;
+
+// Ring capacities are powers of two and multiples of the bitmap word size.
+// The largest ring needed holds kMaxPacketAge + 1 packets.
+const size_t kBitsPerWord = 64;
+const size_t kInitialRingSize = 1024;
+const size_t kMaxRingSize = 16384;
+static_assert(kMaxRingSize > kMaxPacketAge, "Ring must cover kMaxPacketAge");
+
+int CountTrailingZeros(uint64_t word) {
+  RTC_DCHECK_NE(word, 0);
+#if defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  int count = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+int CountOnes(uint64_t word) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word != 0; word &= word - 1)
+    ++count;
+  return count;
+#endif
+}
 }  // namespace
 
 NackModule::NackInfo::NackInfo()
-    : seq_num(0), send_at_seq_num(0), sent_at_time(-1), retries(0) {}
+    : send_at_seq_num(0), sent_at_time(-1), retries(0) {}
 
-NackModule::NackInfo::NackInfo(uint16_t seq_num, uint16_t send_at_seq_num)
-    : seq_num(seq_num),
-      send_at_seq_num(send_at_seq_num),
-      sent_at_time(-1),
-      retries(0) {}
+NackModule::NackInfo::NackInfo(uint16_t send_at_seq_num)
+    : send_at_seq_num(send_at_seq_num), sent_at_time(-1), retries(0) {}
 
 NackModule::NackModule(Clock* clock,
                        NackSender* nack_sender,
@@ -45,6 +74,11 @@ NackModule::NackModule(Clock* clock,
     : clock_(clock),
       nack_sender_(nack_sender),
       keyframe_request_sender_(keyframe_request_sender),
+      nack_infos_(kInitialRingSize),
+      nack_bits_(kInitialRingSize / kBitsPerWord),
+      unsent_bits_(kInitialRingSize / kBitsPerWord),
+      keyframe_bits_(kInitialRingSize / kBitsPerWord),
+      num_nacks_(0),
       reordering_histogram_(kNumReorderingBuckets, kMaxReorderedPackets),
       initialized_(false),
       rtt_ms_(kDefaultRttMs),
@@ -66,7 +100,7 @@ int NackModule::OnReceivedPacket(uint16_t seq_num, bool is_keyframe) {
   if (!initialized_) {
     newest_seq_num_ = seq_num;
     if (is_keyframe)
-      keyframe_list_.insert(seq_num);
+      SetBit(&keyframe_bits_, seq_num);
     initialized_ = true;
     return 0;
   }
@@ -78,27 +112,22 @@ int NackModule::OnReceivedPacket(uint16_t seq_num, bool is_keyframe) {
 
   if (AheadOf(newest_seq_num_, seq_num)) {
     // An out of order packet has been received.
-    auto nack_list_it = nack_list_.find(seq_num);
     int nacks_sent_for_packet = 0;
-    if (nack_list_it != nack_list_.end()) {
-      nacks_sent_for_packet = nack_list_it->second.retries;
-      nack_list_.erase(nack_list_it);
+    if (ForwardDiff(seq_num, newest_seq_num_) < nack_infos_.size() &&
+        IsSet(nack_bits_, seq_num)) {
+      nacks_sent_for_packet = nack_infos_[Index(seq_num)].retries;
+      EraseNack(seq_num);
     }
     if (!is_retransmitted)
       UpdateReorderingStatistics(seq_num);
     return nacks_sent_for_packet;
   }
   AddPacketsToNack(newest_seq_num_ + 1, seq_num);
-  newest_seq_num_ = seq_num;
+  RTC_DCHECK_EQ(newest_seq_num_, seq_num);
 
-  // Keep track of new keyframes.
+  // Keep track of new keyframes. Old ones are dropped as the window moves.
   if (is_keyframe)
-    keyframe_list_.insert(seq_num);
-
-  // And remove old ones so we don't accumulate keyframes.
-  auto it = keyframe_list_.lower_bound(seq_num - kMaxPacketAge);
-  if (it != keyframe_list_.begin())
-    keyframe_list_.erase(keyframe_list_.begin(), it);
+    SetBit(&keyframe_bits_, seq_num);
 
   // Are there any nacks that are waiting for this seq_num.
   std::vector<uint16_t> nack_batch = GetNackBatch(kSeqNumOnly);
@@ -110,9 +139,8 @@ int NackModule::OnReceivedPacket(uint16_t seq_num, bool is_keyframe) {
 
 void NackModule::ClearUpTo(uint16_t seq_num) {
   rtc::CritScope lock(&crit_);
-  nack_list_.erase(nack_list_.begin(), nack_list_.lower_bound(seq_num));
-  keyframe_list_.erase(keyframe_list_.begin(),
-                       keyframe_list_.lower_bound(seq_num));
+  EraseNacksOlderThan(seq_num);
+  ClearBitsOlderThan(&keyframe_bits_, seq_num);
 }
 
 void NackModule::UpdateRtt(int64_t rtt_ms) {
@@ -122,8 +150,10 @@ void NackModule::UpdateRtt(int64_t rtt_ms) {
 
 void NackModule::Clear() {
   rtc::CritScope lock(&crit_);
-  nack_list_.clear();
-  keyframe_list_.clear();
+  std::fill(nack_bits_.begin(), nack_bits_.end(), 0);
+  std::fill(unsent_bits_.begin(), unsent_bits_.end(), 0);
+  std::fill(keyframe_bits_.begin(), keyframe_bits_.end(), 0);
+  num_nacks_ = 0;
 }
 
 int64_t NackModule::TimeUntilNextProcess() {
@@ -158,41 +188,40 @@ void NackModule::Process() {
 }
 
 bool NackModule::RemovePacketsUntilKeyFrame() {
-  while (!keyframe_list_.empty()) {
-    auto it = nack_list_.lower_bound(*keyframe_list_.begin());
-
-    if (it != nack_list_.begin()) {
-      // We have found a keyframe that actually is newer than at least one
-      // packet in the nack list.
-      RTC_DCHECK(it != nack_list_.end());
-      nack_list_.erase(nack_list_.begin(), it);
-      return true;
-    }
-
-    // If this keyframe is so old it does not remove any packets from the list,
-    // remove it from the list of keyframes and try the next keyframe.
-    keyframe_list_.erase(keyframe_list_.begin());
-  }
-  return false;
+  absl::optional<uint16_t> oldest_nack = NextSetBit(nack_bits_, WindowStart());
+  if (!oldest_nack)
+    return false;
+
+  // Keyframes older than the oldest packet in the nack list do not remove any
+  // packets, so look for the first one after it.
+  absl::optional<uint16_t> keyframe =
+      NextSetBit(keyframe_bits_, *oldest_nack + 1);
+  if (!keyframe)
+    return false;
+
+  EraseNacks(*oldest_nack, ForwardDiff(*oldest_nack, *keyframe));
+  return true;
 }
 
 void NackModule::AddPacketsToNack(uint16_t seq_num_start,
                                   uint16_t seq_num_end) {
   // Remove old packets.
-  auto it = nack_list_.lower_bound(seq_num_end - kMaxPacketAge);
-  nack_list_.erase(nack_list_.begin(), it);
+  EraseNacksOlderThan(seq_num_end - kMaxPacketAge);
 
   // If the nack list is too large, remove packets from the nack list until
   // the latest first packet of a keyframe. If the list is still too large,
   // clear it and request a keyframe.
   uint16_t num_new_nacks = ForwardDiff(seq_num_start, seq_num_end);
-  if (nack_list_.size() + num_new_nacks > kMaxNackPackets) {
+  if (num_nacks_ + num_new_nacks > kMaxNackPackets) {
     while (RemovePacketsUntilKeyFrame() &&
-           nack_list_.size() + num_new_nacks > kMaxNackPackets) {
+           num_nacks_ + num_new_nacks > kMaxNackPackets) {
     }
 
-    if (nack_list_.size() + num_new_nacks > kMaxNackPackets) {
-      nack_list_.clear();
+    if (num_nacks_ + num_new_nacks > kMaxNackPackets) {
+      std::fill(nack_bits_.begin(), nack_bits_.end(), 0);
+      std::fill(unsent_bits_.begin(), unsent_bits_.end(), 0);
+      num_nacks_ = 0;
+      AdvanceWindow(seq_num_end);
       RTC_LOG(LS_WARNING) << "NACK list full, clearing NACK"
                              " list and requesting keyframe.";
       keyframe_request_sender_->RequestKeyFrame();
@@ -200,11 +229,15 @@ void NackModule::AddPacketsToNack(uint16_t seq_num_start,
     }
   }
 
+  AdvanceWindow(seq_num_end);
+  const uint16_t send_at_offset = WaitNumberOfPackets(0.5);
   for (uint16_t seq_num = seq_num_start; seq_num != seq_num_end; ++seq_num) {
-    NackInfo nack_info(seq_num, seq_num + WaitNumberOfPackets(0.5));
-    RTC_DCHECK(nack_list_.find(seq_num) == nack_list_.end());
-    nack_list_[seq_num] = nack_info;
+    RTC_DCHECK(!IsSet(nack_bits_, seq_num));
+    nack_infos_[Index(seq_num)] = NackInfo(seq_num + send_at_offset);
+    SetBit(&nack_bits_, seq_num);
+    SetBit(&unsent_bits_, seq_num);
   }
+  num_nacks_ += num_new_nacks;
 }
 
 std::vector<uint16_t> NackModule::GetNackBatch(NackFilterOptions options) {
@@ -212,41 +245,186 @@ std::vector<uint16_t> NackModule::GetNackBatch(NackFilterOptions options) {
   bool consider_timestamp = options != kSeqNumOnly;
   int64_t now_ms = clock_->TimeInMilliseconds();
   std::vector<uint16_t> nack_batch;
-  auto it = nack_list_.begin();
-  while (it != nack_list_.end()) {
-    if (consider_seq_num && it->second.sent_at_time == -1 &&
-        AheadOrAt(newest_seq_num_, it->second.send_at_seq_num)) {
-      nack_batch.emplace_back(it->second.seq_num);
-      ++it->second.retries;
-      it->second.sent_at_time = now_ms;
-      if (it->second.retries >= kMaxNackRetries) {
-        RTC_LOG(LS_WARNING) << "Sequence number " << it->second.seq_num
-                            << " removed from NACK list due to max retries.";
-        it = nack_list_.erase(it);
-      } else {
-        ++it;
-      }
+  if (num_nacks_ == 0)
+    return nack_batch;
+  // Only packets that have not been nacked yet can be sent based on sequence
+  // number, so those are all that need to be visited in that case.
+  const std::vector<uint64_t>& candidates =
+      consider_timestamp ? nack_bits_ : unsent_bits_;
+  for (absl::optional<uint16_t> seq_num = NextSetBit(candidates, WindowStart());
+       seq_num; seq_num = NextSetBit(candidates, *seq_num + 1)) {
+    NackInfo& info = nack_infos_[Index(*seq_num)];
+    bool send_now =
+        (consider_seq_num && info.sent_at_time == -1 &&
+         AheadOrAt(newest_seq_num_, info.send_at_seq_num)) ||
+        (consider_timestamp && info.sent_at_time + rtt_ms_ <= now_ms);
+    if (!send_now)
       continue;
-    }
 
-    if (consider_timestamp && it->second.sent_at_time + rtt_ms_ <= now_ms) {
-      nack_batch.emplace_back(it->second.seq_num);
-      ++it->second.retries;
-      it->second.sent_at_time = now_ms;
-      if (it->second.retries >= kMaxNackRetries) {
-        RTC_LOG(LS_WARNING) << "Sequence number " << it->second.seq_num
-                            << " removed from NACK list due to max retries.";
-        it = nack_list_.erase(it);
-      } else {
-        ++it;
-      }
-      continue;
+    nack_batch.emplace_back(*seq_num);
+    ++info.retries;
+    info.sent_at_time = now_ms;
+    ClearBits(&unsent_bits_, *seq_num, 1);
+    if (info.retries >= kMaxNackRetries) {
+      RTC_LOG(LS_WARNING) << "Sequence number " << *seq_num
+                          << " removed from NACK list due to max retries.";
+      EraseNack(*seq_num);
     }
-    ++it;
   }
   return nack_batch;
 }
 
+void NackModule::AdvanceWindow(uint16_t seq_num) {
+  RTC_DCHECK(AheadOf(seq_num, newest_seq_num_));
+  const uint16_t advance = ForwardDiff(newest_seq_num_, seq_num);
+  if (num_nacks_ > 0) {
+    uint16_t oldest_nack = *NextSetBit(nack_bits_, WindowStart());
+    size_t span = ForwardDiff(oldest_nack, seq_num) + 1;
+    if (span > nack_infos_.size())
+      Grow(span);
+  }
+
+  // The slots entering the window belong to the oldest sequence numbers of
+  // the current one. None of those are in the nack list since the ring covers
+  // all of it, but old keyframes are dropped.
+  size_t count = std::min<size_t>(advance, nack_infos_.size());
+  ClearBits(&keyframe_bits_, newest_seq_num_ + 1, count);
+  newest_seq_num_ = seq_num;
+}
+
+void NackModule::Grow(size_t min_capacity) {
+  size_t capacity = nack_infos_.size();
+  while (capacity < min_capacity)
+    capacity *= 2;
+  RTC_DCHECK_LE(capacity, kMaxRingSize);
+
+  std::vector<uint16_t> nacks;
+  nacks.reserve(num_nacks_);
+  for (absl::optional<uint16_t> seq_num = NextSetBit(nack_bits_, WindowStart());
+       seq_num; seq_num = NextSetBit(nack_bits_, *seq_num + 1)) {
+    nacks.push_back(*seq_num);
+  }
+  std::vector<uint16_t> keyframes;
+  for (absl::optional<uint16_t> seq_num =
+           NextSetBit(keyframe_bits_, WindowStart());
+       seq_num; seq_num = NextSetBit(keyframe_bits_, *seq_num + 1)) {
+    keyframes.push_back(*seq_num);
+  }
+
+  std::vector<NackInfo> old_infos(capacity);
+  old_infos.swap(nack_infos_);
+  const size_t old_mask = old_infos.size() - 1;
+  nack_bits_.assign(capacity / kBitsPerWord, 0);
+  unsent_bits_.assign(capacity / kBitsPerWord, 0);
+  keyframe_bits_.assign(capacity / kBitsPerWord, 0);
+  for (uint16_t seq_num : nacks) {
+    const NackInfo& info = old_infos[seq_num & old_mask];
+    nack_infos_[Index(seq_num)] = info;
+    SetBit(&nack_bits_, seq_num);
+    if (info.sent_at_time == -1)
+      SetBit(&unsent_bits_, seq_num);
+  }
+  for (uint16_t seq_num : keyframes)
+    SetBit(&keyframe_bits_, seq_num);
+}
+
+void NackModule::EraseNacks(uint16_t seq_num, size_t count) {
+  num_nacks_ -= ClearBits(&nack_bits_, seq_num, count);
+  ClearBits(&unsent_bits_, seq_num, count);
+}
+
+void NackModule::EraseNack(uint16_t seq_num) {
+  EraseNacks(seq_num, 1);
+}
+
+void NackModule::EraseNacksOlderThan(uint16_t seq_num) {
+  if (num_nacks_ == 0)
+    return;
+  num_nacks_ -= ClearBitsOlderThan(&nack_bits_, seq_num);
+  ClearBitsOlderThan(&unsent_bits_, seq_num);
+}
+
+size_t NackModule::Index(uint16_t seq_num) const {
+  return seq_num & (nack_infos_.size() - 1);
+}
+
+uint16_t NackModule::WindowStart() const {
+  return newest_seq_num_ - nack_infos_.size() + 1;
+}
+
+bool NackModule::IsSet(const std::vector<uint64_t>& bits,
+                       uint16_t seq_num) const {
+  const size_t index = Index(seq_num);
+  return (bits[index / kBitsPerWord] >> (index % kBitsPerWord)) & 1;
+}
+
+void NackModule::SetBit(std::vector<uint64_t>* bits, uint16_t seq_num) {
+  const size_t index = Index(seq_num);
+  (*bits)[index / kBitsPerWord] |= uint64_t{1} << (index % kBitsPerWord);
+}
+
+absl::optional<uint16_t> NackModule::NextSetBit(
+    const std::vector<uint64_t>& bits,
+    uint16_t seq_num) const {
+  const size_t capacity = nack_infos_.size();
+  // Position of |seq_num| in the window, counted from its oldest end. The
+  // ring wraps at a word boundary, so a word never straddles the wrap.
+  size_t offset = ForwardDiff(WindowStart(), seq_num);
+  while (offset < capacity) {
+    const uint16_t current = WindowStart() + offset;
+    const size_t index = Index(current);
+    const uint64_t word = bits[index / kBitsPerWord] >> (index % kBitsPerWord);
+    if (word != 0) {
+      const size_t skip = CountTrailingZeros(word);
+      if (offset + skip >= capacity)
+        return absl::nullopt;
+      return static_cast<uint16_t>(current + skip);
+    }
+    offset += kBitsPerWord - index % kBitsPerWord;
+  }
+  return absl::nullopt;
+}
+
+size_t NackModule::ClearBits(std::vector<uint64_t>* bits,
+                             uint16_t seq_num,
+                             size_t count) {
+  RTC_DCHECK_LE(count, nack_infos_.size());
+  size_t index = Index(seq_num);
+  size_t cleared = 0;
+  while (count > 0) {
+    const size_t shift = index % kBitsPerWord;
+    const size_t num_bits = std::min(count, kBitsPerWord - shift);
+    const uint64_t mask =
+        (num_bits == kBitsPerWord ? ~uint64_t{0}
+                                  : (uint64_t{1} << num_bits) - 1)
+        << shift;
+    uint64_t& word = (*bits)[index / kBitsPerWord];
+    cleared += CountOnes(word & mask);
+    word &= ~mask;
+    count -= num_bits;
+    index = (index + num_bits) & (nack_infos_.size() - 1);
+  }
+  return cleared;
+}
+
+size_t NackModule::ClearBitsOlderThan(std::vector<uint64_t>* bits,
+                                      uint16_t seq_num) {
+  const uint16_t window_start = WindowStart();
+  const size_t offset = ForwardDiff(window_start, seq_num);
+  if (offset <= nack_infos_.size())
+    return ClearBits(bits, window_start, offset);
+
+  // |seq_num| is outside of the window, so clear bits from the oldest end
+  // for as long as they are older than it.
+  size_t cleared = 0;
+  for (absl::optional<uint16_t> it = NextSetBit(*bits, window_start);
+       it && AheadOf(seq_num, *it); it = NextSetBit(*bits, *it + 1)) {
+    ClearBits(bits, *it, 1);
+    ++cleared;
+  }
+  return cleared;
+}
+
 void NackModule::UpdateReorderingStatistics(uint16_t seq_num) {
   RTC_DCHECK(AheadOf(newest_seq_num_, seq_num));
   uint16_t diff = ReverseDiff(newest_seq_num_, seq_num);
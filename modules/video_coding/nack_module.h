@@ -11,10 +11,9 @@
 #ifndef MODULES_VIDEO_CODING_NACK_MODULE_H_
 #define MODULES_VIDEO_CODING_NACK_MODULE_H_
 
-#include <map>
-#include <set>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "modules/include/module.h"
 #include "modules/include/module_common_types.h"
 #include "modules/video_coding/histogram.h"
@@ -45,18 +44,19 @@ class NackModule : public Module {
   // GetNackBatch.
   enum NackFilterOptions { kSeqNumOnly, kTimeOnly, kSeqNumAndTime };
 
-  // This class holds the sequence number of the packet that is in the nack list
-  // as well as the meta data about when it should be nacked and how many times
-  // we have tried to nack this packet.
+  // This class holds the meta data about when a packet in the nack list
+  // should be nacked and how many times we have tried to nack it.
   struct NackInfo {
     NackInfo();
-    NackInfo(uint16_t seq_num, uint16_t send_at_seq_num);
+    explicit NackInfo(uint16_t send_at_seq_num);
 
-    uint16_t seq_num;
     uint16_t send_at_seq_num;
     int64_t sent_at_time;
     int retries;
   };
+
+  // Adds the packets in [|seq_num_start|, |seq_num_end|) to the nack list and
+  // moves |newest_seq_num_| to |seq_num_end|.
   void AddPacketsToNack(uint16_t seq_num_start, uint16_t seq_num_end)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
@@ -66,6 +66,39 @@ class NackModule : public Module {
   std::vector<uint16_t> GetNackBatch(NackFilterOptions options)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
+  // Moves the window to end at |seq_num|, growing the ring if the oldest
+  // packet in the nack list would otherwise fall out of it.
+  void AdvanceWindow(uint16_t seq_num) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void Grow(size_t min_capacity) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Removes |count| packets starting at |seq_num| from the nack list.
+  void EraseNacks(uint16_t seq_num, size_t count)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void EraseNack(uint16_t seq_num) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void EraseNacksOlderThan(uint16_t seq_num)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Helpers for the bitmaps below, which are indexed by sequence number
+  // modulo the ring capacity.
+  size_t Index(uint16_t seq_num) const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  uint16_t WindowStart() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  bool IsSet(const std::vector<uint64_t>& bits, uint16_t seq_num) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void SetBit(std::vector<uint64_t>* bits, uint16_t seq_num)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Returns the oldest sequence number in [|seq_num|, |newest_seq_num_|]
+  // with its bit set.
+  absl::optional<uint16_t> NextSetBit(const std::vector<uint64_t>& bits,
+                                      uint16_t seq_num) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Clears |count| bits starting at |seq_num| and returns how many were set.
+  size_t ClearBits(std::vector<uint64_t>* bits, uint16_t seq_num, size_t count)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Clears the bits of all sequence numbers older than |seq_num| and returns
+  // how many were set.
+  size_t ClearBitsOlderThan(std::vector<uint64_t>* bits, uint16_t seq_num)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Update the reordering distribution.
   void UpdateReorderingStatistics(uint16_t seq_num)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
@@ -83,10 +116,17 @@ class NackModule : public Module {
   // TODO(philipel): Some of the variables below are consistently used on a
   // known thread (e.g. see |initialized_|). Those probably do not need
   // synchronized access.
-  std::map<uint16_t, NackInfo, DescendingSeqNumComp<uint16_t>> nack_list_
-      RTC_GUARDED_BY(crit_);
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> keyframe_list_
-      RTC_GUARDED_BY(crit_);
+  // The nack list and the first packets of keyframes are kept as bitmaps over
+  // a ring of the |nack_infos_.size()| most recent sequence numbers, ending
+  // at |newest_seq_num_|. The ring grows as needed to always cover the oldest
+  // packet in the nack list; keyframes that fall out of it are older than
+  // every nacked packet and could not clear any of them anyway.
+  std::vector<NackInfo> nack_infos_ RTC_GUARDED_BY(crit_);
+  std::vector<uint64_t> nack_bits_ RTC_GUARDED_BY(crit_);
+  // Packets in the nack list that have not been nacked yet.
+  std::vector<uint64_t> unsent_bits_ RTC_GUARDED_BY(crit_);
+  std::vector<uint64_t> keyframe_bits_ RTC_GUARDED_BY(crit_);
+  size_t num_nacks_ RTC_GUARDED_BY(crit_);
   video_coding::Histogram reordering_histogram_ RTC_GUARDED_BY(crit_);
   bool initialized_ RTC_GUARDED_BY(crit_);
   int64_t rtt_ms_ RTC_GUARDED_BY(crit_);
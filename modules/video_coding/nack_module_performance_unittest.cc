@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "modules/include/module_common_types.h"
+#include "modules/video_coding/nack_module.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumPackets = 500000;
+constexpr int kQuickNumPackets = 20000;
+// One packet per millisecond, and a keyframe every 300 packets.
+constexpr int kPacketIntervalMs = 1;
+constexpr int kKeyFrameInterval = 300;
+constexpr int kBurstInterval = 10000;
+constexpr int kLostPacketsPerBurst = 2000;
+
+enum class LossPattern {
+  // 10% of the packets are lost at random.
+  kRandom,
+  // Every other packet is lost until 2000 packets are lost, so that the nack
+  // list overflows and is cleared up to the latest keyframes.
+  kInterleavedBurst,
+  // 2000 consecutive packets are lost, so that the nack list is cleared and
+  // a keyframe is requested.
+  kContiguousBurst,
+};
+
+class NullSender : public NackSender, public KeyFrameRequestSender {
+ public:
+  void SendNack(const std::vector<uint16_t>& sequence_numbers) override {
+    num_nacks_ += sequence_numbers.size();
+  }
+  void RequestKeyFrame() override { ++num_keyframe_requests_; }
+
+  size_t num_nacks_ = 0;
+  int num_keyframe_requests_ = 0;
+};
+
+bool IsLost(LossPattern pattern, int packet, Random* random) {
+  const int position_in_burst = packet % kBurstInterval;
+  switch (pattern) {
+    case LossPattern::kRandom:
+      return random->Rand(1, 10) == 1;
+    case LossPattern::kInterleavedBurst:
+      return position_in_burst < 2 * kLostPacketsPerBurst &&
+             position_in_burst % 2 == 1;
+    case LossPattern::kContiguousBurst:
+      return position_in_burst > 0 &&
+             position_in_burst <= kLostPacketsPerBurst;
+  }
+  return false;
+}
+
+// Feeds a 1000 packets per second stream with the given loss pattern through
+// a NackModule, calling Process() as often as the process thread would.
+// Returns the average time per packet in nanoseconds.
+double RunStream(LossPattern pattern) {
+  SimulatedClock clock(0);
+  NullSender sender;
+  NackModule nack_module(&clock, &sender, &sender);
+  Random random(0x5eed);
+  const int num_packets = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                              ? kQuickNumPackets
+                              : kNumPackets;
+
+  int64_t start_ns = rtc::TimeNanos();
+  for (int packet = 0; packet < num_packets; ++packet) {
+    clock.AdvanceTimeMilliseconds(kPacketIntervalMs);
+    if (nack_module.TimeUntilNextProcess() == 0)
+      nack_module.Process();
+    if (IsLost(pattern, packet, &random))
+      continue;
+    nack_module.OnReceivedPacket(static_cast<uint16_t>(packet),
+                                 packet % kKeyFrameInterval == 0);
+  }
+  const double ns_per_packet =
+      static_cast<double>(rtc::TimeNanos() - start_ns) / num_packets;
+  EXPECT_TRUE(sender.num_nacks_ > 0 || sender.num_keyframe_requests_ > 0);
+  return ns_per_packet;
+}
+
+void RunAndReport(LossPattern pattern, const std::string& trace) {
+  test::PrintResult("nack_module_packet", "", trace, RunStream(pattern), "ns",
+                    true);
+}
+
+}  // namespace
+
+TEST(NackModulePerformanceTest, RandomLoss) {
+  RunAndReport(LossPattern::kRandom, "random_loss");
+}
+
+TEST(NackModulePerformanceTest, InterleavedLossBurst) {
+  RunAndReport(LossPattern::kInterleavedBurst, "interleaved_2000_loss_burst");
+}
+
+TEST(NackModulePerformanceTest, ContiguousLossBurst) {
+  RunAndReport(LossPattern::kContiguousBurst, "contiguous_2000_loss_burst");
+}
+
+}  // namespace webrtc
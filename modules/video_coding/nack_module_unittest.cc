@@ -262,4 +262,35 @@ TEST_F(TestNackModule, PacketNackCount) {
   EXPECT_EQ(0, nack_module_.OnReceivedPacket(4, false));
 }
 
+TEST_F(TestNackModule, SparseLossesSpanningMaxPacketAge) {
+  // Lose every 20th packet, wrapping the sequence number, until the oldest
+  // losses are more than 10000 packets old.
+  const uint16_t kFirstSeqNum = 60000;
+  nack_module_.OnReceivedPacket(kFirstSeqNum, false);
+  for (int i = 1; i <= 10045; ++i) {
+    if (i % 20 != 0)
+      nack_module_.OnReceivedPacket(kFirstSeqNum + i, false);
+  }
+  EXPECT_EQ(502u, sent_nacks_.size());
+  EXPECT_EQ(0, keyframes_requested_);
+
+  // The two oldest losses are too old to be nacked again.
+  sent_nacks_.clear();
+  clock_->AdvanceTimeMilliseconds(100);
+  nack_module_.Process();
+  ASSERT_EQ(500u, sent_nacks_.size());
+  for (size_t i = 0; i < sent_nacks_.size(); ++i) {
+    EXPECT_EQ(static_cast<uint16_t>(kFirstSeqNum + 60 + 20 * i),
+              sent_nacks_[i]);
+  }
+
+  sent_nacks_.clear();
+  clock_->AdvanceTimeMilliseconds(100);
+  nack_module_.ClearUpTo(static_cast<uint16_t>(kFirstSeqNum + 10001));
+  nack_module_.Process();
+  ASSERT_EQ(2u, sent_nacks_.size());
+  EXPECT_EQ(static_cast<uint16_t>(kFirstSeqNum + 10020), sent_nacks_[0]);
+  EXPECT_EQ(static_cast<uint16_t>(kFirstSeqNum + 10040), sent_nacks_[1]);
+}
+
 }  // namespace webrtc
@@ -12,6 +12,7 @@
 #define MODULES_VIDEO_CODING_PACKET_H_
 
 #include "modules/include/module_common_types.h"
+#include "rtc_base/copyonwritebuffer.h"
 
 namespace webrtc {
 
@@ -29,6 +30,9 @@ class VCMPacket {
   uint16_t seqNum;
   const uint8_t* dataPtr;
   size_t sizeBytes;
+  // If not empty, |dataPtr| points into this buffer, typically the buffer the
+  // RTP packet was received in, instead of to memory owned by the packet.
+  rtc::CopyOnWriteBuffer payload_buffer;
   bool markerBit;
   int timesNacked;
 
@@ -25,6 +25,33 @@
 namespace webrtc {
 namespace video_coding {
 
+namespace {
+constexpr int64_t kNoPacketReceived = std::numeric_limits<int64_t>::min();
+constexpr int kNoPendingClear = -1;
+// Number of bitstream buffers of destroyed frames kept for reuse.
+constexpr size_t kMaxPooledBitstreamBuffers = 8;
+constexpr uint8_t kH264StartCode[] = {0, 0, 0, 1};
+
+// Size of the payload of |packet| in the bitstream of a frame. Payloads that
+// reference the buffer they were received in do not contain H.264 start
+// codes, those are inserted when the frame is assembled.
+size_t BitstreamSize(const VCMPacket& packet) {
+  if (packet.payload_buffer.size() > 0 && packet.insertStartCode)
+    return sizeof(kH264StartCode) + packet.sizeBytes;
+  return packet.sizeBytes;
+}
+
+// Releases the payload of |packet|, which is either owned by the packet
+// buffer or a reference to the buffer the packet was received in.
+void ReleasePayload(VCMPacket* packet) {
+  if (packet->payload_buffer.size() > 0)
+    packet->payload_buffer = rtc::CopyOnWriteBuffer();
+  else
+    delete[] packet->dataPtr;
+  packet->dataPtr = nullptr;
+}
+}  // namespace
+
 rtc::scoped_refptr<PacketBuffer> PacketBuffer::Create(
     Clock* clock,
     size_t start_buffer_size,
@@ -47,7 +74,11 @@ PacketBuffer::PacketBuffer(Clock* clock,
       data_buffer_(start_buffer_size),
       sequence_buffer_(start_buffer_size),
       received_frame_callback_(received_frame_callback),
+      last_received_packet_ms_(kNoPacketReceived),
+      last_received_keyframe_packet_ms_(kNoPacketReceived),
       unique_frames_seen_(0),
+      pending_clear_to_(kNoPendingClear),
+      returned_frames_(nullptr),
       sps_pps_idr_is_h264_keyframe_(
           field_trial::IsEnabled("WebRTC-SpsPpsIdrIsH264Keyframe")) {
   RTC_DCHECK_LE(start_buffer_size, max_buffer_size);
@@ -58,12 +89,14 @@ PacketBuffer::PacketBuffer(Clock* clock,
 
 PacketBuffer::~PacketBuffer() {
   Clear();
+  RTC_DCHECK(!returned_frames_.load());
 }
 
 bool PacketBuffer::InsertPacket(VCMPacket* packet) {
   std::vector<std::unique_ptr<RtpFrameObject>> found_frames;
   {
     rtc::CritScope lock(&crit_);
+    ApplyDeferredUpdates();
 
     OnTimestampReceived(packet->timestamp);
 
@@ -77,8 +110,7 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
       // If we have explicitly cleared past this packet then it's old,
       // don't insert it.
       if (is_cleared_to_first_seq_num_) {
-        delete[] packet->dataPtr;
-        packet->dataPtr = nullptr;
+        ReleasePayload(packet);
         return false;
       }
 
@@ -88,8 +120,7 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
     if (sequence_buffer_[index].used) {
       // Duplicate packet, just delete the payload.
       if (data_buffer_[index].seqNum == packet->seqNum) {
-        delete[] packet->dataPtr;
-        packet->dataPtr = nullptr;
+        ReleasePayload(packet);
         return true;
       }
 
@@ -100,8 +131,7 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
 
       // Packet buffer is still full.
       if (sequence_buffer_[index].used) {
-        delete[] packet->dataPtr;
-        packet->dataPtr = nullptr;
+        ReleasePayload(packet);
         return false;
       }
     }
@@ -114,6 +144,7 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
     sequence_buffer_[index].used = true;
     data_buffer_[index] = *packet;
     packet->dataPtr = nullptr;
+    packet->payload_buffer = rtc::CopyOnWriteBuffer();
 
     UpdateMissingPackets(packet->seqNum);
 
@@ -132,7 +163,19 @@ bool PacketBuffer::InsertPacket(VCMPacket* packet) {
 }
 
 void PacketBuffer::ClearTo(uint16_t seq_num) {
-  rtc::CritScope lock(&crit_);
+  // Only the newest pending sequence number needs to be applied, since
+  // clearing to an older one after it has no effect.
+  int pending = pending_clear_to_.load(std::memory_order_relaxed);
+  do {
+    if (pending != kNoPendingClear &&
+        AheadOf<uint16_t>(static_cast<uint16_t>(pending), seq_num)) {
+      return;
+    }
+  } while (!pending_clear_to_.compare_exchange_weak(
+      pending, seq_num, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void PacketBuffer::ClearToInternal(uint16_t seq_num) {
   // We have already cleared past this sequence number, no need to do anything.
   if (is_cleared_to_first_seq_num_ &&
       AheadOf<uint16_t>(first_seq_num_, seq_num)) {
@@ -152,8 +195,7 @@ void PacketBuffer::ClearTo(uint16_t seq_num) {
     size_t index = first_seq_num_ % size_;
     RTC_DCHECK_EQ(data_buffer_[index].seqNum, sequence_buffer_[index].seq_num);
     if (AheadOf<uint16_t>(seq_num, sequence_buffer_[index].seq_num)) {
-      delete[] data_buffer_[index].dataPtr;
-      data_buffer_[index].dataPtr = nullptr;
+      ReleasePayload(&data_buffer_[index]);
       sequence_buffer_[index].used = false;
     }
     ++first_seq_num_;
@@ -173,16 +215,16 @@ void PacketBuffer::ClearTo(uint16_t seq_num) {
 
 void PacketBuffer::Clear() {
   rtc::CritScope lock(&crit_);
+  ApplyDeferredUpdates();
   for (size_t i = 0; i < size_; ++i) {
-    delete[] data_buffer_[i].dataPtr;
-    data_buffer_[i].dataPtr = nullptr;
+    ReleasePayload(&data_buffer_[i]);
     sequence_buffer_[i].used = false;
   }
 
   first_packet_received_ = false;
   is_cleared_to_first_seq_num_ = false;
-  last_received_packet_ms_.reset();
-  last_received_keyframe_packet_ms_.reset();
+  last_received_packet_ms_ = kNoPacketReceived;
+  last_received_keyframe_packet_ms_ = kNoPacketReceived;
   newest_inserted_seq_num_.reset();
   missing_packets_.clear();
 }
@@ -191,6 +233,7 @@ void PacketBuffer::PaddingReceived(uint16_t seq_num) {
   std::vector<std::unique_ptr<RtpFrameObject>> found_frames;
   {
     rtc::CritScope lock(&crit_);
+    ApplyDeferredUpdates();
     UpdateMissingPackets(seq_num);
     found_frames = FindFrames(static_cast<uint16_t>(seq_num + 1));
   }
@@ -200,20 +243,81 @@ void PacketBuffer::PaddingReceived(uint16_t seq_num) {
 }
 
 absl::optional<int64_t> PacketBuffer::LastReceivedPacketMs() const {
-  rtc::CritScope lock(&crit_);
-  return last_received_packet_ms_;
+  int64_t last_received_packet_ms = last_received_packet_ms_;
+  if (last_received_packet_ms == kNoPacketReceived)
+    return absl::nullopt;
+  return last_received_packet_ms;
 }
 
 absl::optional<int64_t> PacketBuffer::LastReceivedKeyframePacketMs() const {
-  rtc::CritScope lock(&crit_);
-  return last_received_keyframe_packet_ms_;
+  int64_t last_received_keyframe_packet_ms = last_received_keyframe_packet_ms_;
+  if (last_received_keyframe_packet_ms == kNoPacketReceived)
+    return absl::nullopt;
+  return last_received_keyframe_packet_ms;
 }
 
 int PacketBuffer::GetUniqueFramesSeen() const {
-  rtc::CritScope lock(&crit_);
   return unique_frames_seen_;
 }
 
+void PacketBuffer::ApplyDeferredUpdates() {
+  ReturnedFrame* frame = returned_frames_.exchange(nullptr);
+  while (frame) {
+    FreeSlots(frame->first_seq_num, frame->last_seq_num);
+    if (frame->bitstream_buffer) {
+      RecycleBitstreamBuffer(std::move(frame->bitstream_buffer),
+                             frame->bitstream_capacity);
+    }
+    ReturnedFrame* next = frame->next;
+    delete frame;
+    frame = next;
+  }
+
+  int clear_to = pending_clear_to_.exchange(kNoPendingClear);
+  if (clear_to != kNoPendingClear)
+    ClearToInternal(static_cast<uint16_t>(clear_to));
+}
+
+uint8_t* PacketBuffer::AcquireBitstreamBuffer(size_t size, size_t* capacity) {
+  rtc::CritScope lock(&crit_);
+  // Use the smallest pooled buffer that is large enough.
+  auto best = bitstream_buffers_.end();
+  for (auto it = bitstream_buffers_.begin(); it != bitstream_buffers_.end();
+       ++it) {
+    if (it->capacity >= size &&
+        (best == bitstream_buffers_.end() || it->capacity < best->capacity)) {
+      best = it;
+    }
+  }
+  if (best == bitstream_buffers_.end()) {
+    // Leave room for somewhat larger frames to reuse the buffer.
+    *capacity = size + size / 4;
+    return new uint8_t[*capacity];
+  }
+
+  *capacity = best->capacity;
+  uint8_t* buffer = best->data.release();
+  bitstream_buffers_.erase(best);
+  return buffer;
+}
+
+void PacketBuffer::RecycleBitstreamBuffer(std::unique_ptr<uint8_t[]> buffer,
+                                          size_t capacity) {
+  if (bitstream_buffers_.size() < kMaxPooledBitstreamBuffers) {
+    bitstream_buffers_.push_back(BitstreamBuffer{std::move(buffer), capacity});
+    return;
+  }
+
+  // Keep the largest buffers, which are the most expensive to allocate.
+  auto smallest = std::min_element(
+      bitstream_buffers_.begin(), bitstream_buffers_.end(),
+      [](const BitstreamBuffer& a, const BitstreamBuffer& b) {
+        return a.capacity < b.capacity;
+      });
+  if (smallest->capacity < capacity)
+    *smallest = BitstreamBuffer{std::move(buffer), capacity};
+}
+
 bool PacketBuffer::ExpandBufferSize() {
   if (size_ == max_size_) {
     RTC_LOG(LS_WARNING) << "PacketBuffer is already at max size (" << max_size_
@@ -294,7 +398,7 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
 
       while (true) {
         ++tested_packets;
-        frame_size += data_buffer_[start_index].sizeBytes;
+        frame_size += BitstreamSize(data_buffer_[start_index]);
         max_nack_count =
             std::max(max_nack_count, data_buffer_[start_index].timesNacked);
         sequence_buffer_[start_index].frame_created = true;
@@ -394,14 +498,25 @@ std::vector<std::unique_ptr<RtpFrameObject>> PacketBuffer::FindFrames(
 }
 
 void PacketBuffer::ReturnFrame(RtpFrameObject* frame) {
-  rtc::CritScope lock(&crit_);
-  size_t index = frame->first_seq_num() % size_;
-  size_t end = (frame->last_seq_num() + 1) % size_;
-  uint16_t seq_num = frame->first_seq_num();
+  ReturnedFrame* returned = new ReturnedFrame();
+  returned->first_seq_num = frame->first_seq_num();
+  returned->last_seq_num = frame->last_seq_num();
+  returned->bitstream_buffer =
+      frame->TakeBitstreamBuffer(&returned->bitstream_capacity);
+  returned->next = returned_frames_.load(std::memory_order_relaxed);
+  while (!returned_frames_.compare_exchange_weak(returned->next, returned,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+  }
+}
+
+void PacketBuffer::FreeSlots(uint16_t first_seq_num, uint16_t last_seq_num) {
+  size_t index = first_seq_num % size_;
+  size_t end = (last_seq_num + 1) % size_;
+  uint16_t seq_num = first_seq_num;
   while (index != end) {
     if (sequence_buffer_[index].seq_num == seq_num) {
-      delete[] data_buffer_[index].dataPtr;
-      data_buffer_[index].dataPtr = nullptr;
+      ReleasePayload(&data_buffer_[index]);
       sequence_buffer_[index].used = false;
     }
 
@@ -426,7 +541,8 @@ bool PacketBuffer::GetBitstream(const RtpFrameObject& frame,
     }
 
     RTC_DCHECK_EQ(data_buffer_[index].seqNum, sequence_buffer_[index].seq_num);
-    size_t length = data_buffer_[index].sizeBytes;
+    const VCMPacket& packet = data_buffer_[index];
+    size_t length = BitstreamSize(packet);
     if (destination + length > destination_end) {
       RTC_LOG(LS_WARNING) << "Frame (" << frame.id.picture_id << ":"
                           << static_cast<int>(frame.id.spatial_layer) << ")"
@@ -434,9 +550,12 @@ bool PacketBuffer::GetBitstream(const RtpFrameObject& frame,
       return false;
     }
 
-    const uint8_t* source = data_buffer_[index].dataPtr;
-    memcpy(destination, source, length);
-    destination += length;
+    if (length != packet.sizeBytes) {
+      memcpy(destination, kH264StartCode, sizeof(kH264StartCode));
+      destination += sizeof(kH264StartCode);
+    }
+    memcpy(destination, packet.dataPtr, packet.sizeBytes);
+    destination += packet.sizeBytes;
     index = (index + 1) % size_;
     ++seq_num;
   } while (index != end);
@@ -11,6 +11,7 @@
 #ifndef MODULES_VIDEO_CODING_PACKET_BUFFER_H_
 #define MODULES_VIDEO_CODING_PACKET_BUFFER_H_
 
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
@@ -51,8 +52,12 @@ class PacketBuffer {
 
   // Returns true if |packet| is inserted into the packet buffer, false
   // otherwise. The PacketBuffer will always take ownership of the
-  // |packet.dataPtr| when this function is called. Made virtual for testing.
+  // |packet.dataPtr| when this function is called, or of a reference to
+  // |packet.payload_buffer| if that is set. Made virtual for testing.
   virtual bool InsertPacket(VCMPacket* packet);
+  // Unlike the other methods, ClearTo() does not block on packet insertion and
+  // is meant to be called from the decoding side. It takes effect before the
+  // next packet is inserted.
   void ClearTo(uint16_t seq_num);
   void Clear();
   void PaddingReceived(uint16_t seq_num);
@@ -99,8 +104,36 @@ class PacketBuffer {
     bool frame_created = false;
   };
 
+  // A frame that has been destroyed, possibly on another thread. The slots of
+  // its packets are freed and its bitstream buffer is reused once the packet
+  // buffer is next used from the network side.
+  struct ReturnedFrame {
+    uint16_t first_seq_num = 0;
+    uint16_t last_seq_num = 0;
+    std::unique_ptr<uint8_t[]> bitstream_buffer;
+    size_t bitstream_capacity = 0;
+    ReturnedFrame* next = nullptr;
+  };
+
+  struct BitstreamBuffer {
+    std::unique_ptr<uint8_t[]> data;
+    size_t capacity = 0;
+  };
+
   Clock* const clock_;
 
+  // Applies the ClearTo() calls made and frees the frames returned since the
+  // last call.
+  void ApplyDeferredUpdates() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void ClearToInternal(uint16_t seq_num) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Returns a buffer of at least |size| bytes for the bitstream of a frame and
+  // sets |capacity| to its actual size. Buffers of destroyed frames are reused.
+  uint8_t* AcquireBitstreamBuffer(size_t size, size_t* capacity);
+  void RecycleBitstreamBuffer(std::unique_ptr<uint8_t[]> buffer,
+                              size_t capacity)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Tries to expand the buffer.
   bool ExpandBufferSize() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
@@ -122,10 +155,16 @@ class PacketBuffer {
   virtual VCMPacket* GetPacket(uint16_t seq_num)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
-  // Mark all slots used by |frame| as not used.
+  // Mark all slots used by |frame| as not used. Does not block, the slots
+  // are freed on the next insertion.
   // Virtual for testing.
   virtual void ReturnFrame(RtpFrameObject* frame);
 
+  // Mark the slots of the packets in [|first_seq_num|, |last_seq_num|] as not
+  // used.
+  void FreeSlots(uint16_t first_seq_num, uint16_t last_seq_num)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   void UpdateMissingPackets(uint16_t seq_num)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
@@ -158,12 +197,22 @@ class PacketBuffer {
   // Called when a received frame is found.
   OnReceivedFrameCallback* const received_frame_callback_;
 
-  // Timestamp (not RTP timestamp) of the last received packet/keyframe packet.
-  absl::optional<int64_t> last_received_packet_ms_ RTC_GUARDED_BY(crit_);
-  absl::optional<int64_t> last_received_keyframe_packet_ms_
-      RTC_GUARDED_BY(crit_);
+  // Timestamp (not RTP timestamp) of the last received packet/keyframe packet,
+  // or kNoPacketReceived. Atomic since these are polled from the decoding side.
+  std::atomic<int64_t> last_received_packet_ms_;
+  std::atomic<int64_t> last_received_keyframe_packet_ms_;
+
+  std::atomic<int> unique_frames_seen_;
+
+  // Sequence number of the latest ClearTo() call not yet applied, or
+  // kNoPendingClear.
+  std::atomic<int> pending_clear_to_;
+
+  // Stack of frames returned since ApplyDeferredUpdates() was last called.
+  std::atomic<ReturnedFrame*> returned_frames_;
 
-  int unique_frames_seen_ RTC_GUARDED_BY(crit_);
+  // Bitstream buffers of destroyed frames, kept for reuse.
+  std::vector<BitstreamBuffer> bitstream_buffers_ RTC_GUARDED_BY(crit_);
 
   absl::optional<uint16_t> newest_inserted_seq_num_ RTC_GUARDED_BY(crit_);
   std::set<uint16_t, DescendingSeqNumComp<uint16_t>> missing_packets_
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modules/video_coding/frame_object.h"
+#include "modules/video_coding/packet.h"
+#include "modules/video_coding/packet_buffer.h"
+#include "rtc_base/copyonwritebuffer.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace video_coding {
+namespace {
+
+// Roughly the size of a 4K key frame at a moderate bitrate.
+constexpr size_t kFrameSize = 400000;
+constexpr size_t kPayloadSize = 1200;
+constexpr size_t kHeaderSize = 12;
+constexpr int kNumFrames = 1000;
+constexpr int kQuickNumFrames = 20;
+// The sizes RtpVideoStreamReceiver uses.
+constexpr size_t kStartBufferSize = 512;
+constexpr size_t kMaxBufferSize = 2048;
+
+class FrameSink : public OnReceivedFrameCallback {
+ public:
+  void OnReceivedFrame(std::unique_ptr<RtpFrameObject> frame) override {
+    bytes_ += frame->size();
+    ++frames_;
+  }
+
+  size_t bytes_ = 0;
+  int frames_ = 0;
+};
+
+// Inserts the packets of 4K frames into a PacketBuffer the way
+// RtpVideoStreamReceiver does, either copying every payload out of the
+// buffer it was received in or referencing it. Frames are released as soon
+// as they are assembled. Returns the average time per frame in microseconds.
+double AssembleFrames(bool reference_payload) {
+  SimulatedClock clock(0);
+  FrameSink sink;
+  rtc::scoped_refptr<PacketBuffer> packet_buffer = PacketBuffer::Create(
+      &clock, kStartBufferSize, kMaxBufferSize, &sink);
+
+  // The received packets of one frame, reused for every frame.
+  const size_t packets_per_frame =
+      (kFrameSize + kPayloadSize - 1) / kPayloadSize;
+  std::vector<rtc::CopyOnWriteBuffer> received(packets_per_frame);
+  for (size_t i = 0; i < packets_per_frame; ++i) {
+    received[i].SetSize(kHeaderSize + kPayloadSize);
+    memset(received[i].data(), static_cast<int>(i), received[i].size());
+  }
+
+  const int frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                         ? kQuickNumFrames
+                         : kNumFrames;
+  uint16_t seq_num = 0;
+  int64_t start_us = rtc::TimeMicros();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (size_t i = 0; i < packets_per_frame; ++i) {
+      VCMPacket packet;
+      packet.codec = kVideoCodecGeneric;
+      packet.timestamp = frame * 3000;
+      packet.seqNum = seq_num++;
+      packet.frameType = kVideoFrameKey;
+      packet.is_first_packet_in_frame = i == 0;
+      packet.is_last_packet_in_frame = i == packets_per_frame - 1;
+      packet.sizeBytes = kPayloadSize;
+      if (reference_payload) {
+        packet.dataPtr = received[i].cdata() + kHeaderSize;
+        packet.payload_buffer = received[i];
+      } else {
+        uint8_t* data = new uint8_t[kPayloadSize];
+        memcpy(data, received[i].cdata() + kHeaderSize, kPayloadSize);
+        packet.dataPtr = data;
+      }
+      packet_buffer->InsertPacket(&packet);
+    }
+  }
+  const double us_per_frame =
+      static_cast<double>(rtc::TimeMicros() - start_us) / frames;
+  EXPECT_EQ(sink.frames_, frames);
+  EXPECT_EQ(sink.bytes_, frames * packets_per_frame * kPayloadSize);
+  return us_per_frame;
+}
+
+void RunAndReport(bool reference_payload, const std::string& trace) {
+  test::PrintResult("packet_buffer_assemble_4k_frame", "", trace,
+                    AssembleFrames(reference_payload), "us", true);
+}
+
+}  // namespace
+
+TEST(PacketBufferPerformanceTest, AssembleFramesWithCopiedPayload) {
+  RunAndReport(false, "copied_payload");
+}
+
+TEST(PacketBufferPerformanceTest, AssembleFramesWithReferencedPayload) {
+  RunAndReport(true, "referenced_payload");
+}
+
+}  // namespace video_coding
+}  // namespace webrtc
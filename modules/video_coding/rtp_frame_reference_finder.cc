@@ -18,17 +18,38 @@
 #include "modules/video_coding/packet_buffer.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
-#include "rtc_base/system/fallthrough.h"
 
 namespace webrtc {
 namespace video_coding {
 
+namespace {
+
+// A wait key is what a stashed frame waits for in the top byte, and the value
+// it waits for in the remaining bits.
+constexpr int kWaitForShift = 56;
+constexpr uint64_t kWaitValueMask = (uint64_t{1} << kWaitForShift) - 1;
+
+}  // namespace
+
 RtpFrameReferenceFinder::RtpFrameReferenceFinder(
     OnCompleteFrameCallback* frame_callback)
-    : last_picture_id_(-1),
+    : num_gops_(0),
+      last_picture_id_(-1),
+      free_stash_slot_(0),
+      num_stashed_frames_(0),
+      stash_order_(0),
+      wait_key_(0),
+      retry_queue_start_(0),
+      retry_queue_size_(0),
       current_ss_idx_(0),
       cleared_to_seq_num_(-1),
-      frame_callback_(frame_callback) {}
+      frame_callback_(frame_callback) {
+  stashed_padding_.fill(-1);
+  not_yet_received_frames_.fill(-1);
+  stash_buckets_.fill(-1);
+  for (int i = 0; i < kMaxStashedFrames; ++i)
+    stashed_frames_[i].next = i + 1 < kMaxStashedFrames ? i + 1 : -1;
+}
 
 RtpFrameReferenceFinder::~RtpFrameReferenceFinder() = default;
 
@@ -46,40 +67,142 @@ void RtpFrameReferenceFinder::ManageFrame(
 
   switch (decision) {
     case kStash:
-      if (stashed_frames_.size() > kMaxStashedFrames)
-        stashed_frames_.pop_back();
-      stashed_frames_.push_front(std::move(frame));
+      StashFrame(std::move(frame));
       break;
     case kHandOff:
       frame_callback_->OnCompleteFrame(std::move(frame));
-      RetryStashedFrames();
       break;
     case kDrop:
       break;
   }
+  // Managing the frame may have woken stashed frames, also when it was
+  // stashed itself.
+  RetryStashedFrames();
 }
 
-void RtpFrameReferenceFinder::RetryStashedFrames() {
-  bool complete_frame = false;
-  do {
-    complete_frame = false;
-    for (auto frame_it = stashed_frames_.begin();
-         frame_it != stashed_frames_.end();) {
-      FrameDecision decision = ManageFrameInternal(frame_it->get());
-
-      switch (decision) {
-        case kStash:
-          ++frame_it;
-          break;
-        case kHandOff:
-          complete_frame = true;
-          frame_callback_->OnCompleteFrame(std::move(*frame_it));
-          RTC_FALLTHROUGH();
-        case kDrop:
-          frame_it = stashed_frames_.erase(frame_it);
+RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::StashUntil(
+    WaitFor wait_for,
+    int64_t value) {
+  wait_key_ = (static_cast<uint64_t>(wait_for) << kWaitForShift) |
+              (static_cast<uint64_t>(value) & kWaitValueMask);
+  return kStash;
+}
+
+void RtpFrameReferenceFinder::StashFrame(
+    std::unique_ptr<RtpFrameObject> frame) {
+  if (num_stashed_frames_ == kMaxStashedFrames) {
+    // Drop the oldest stashed frame that is not about to be retried.
+    int oldest = -1;
+    for (int slot = 0; slot < kMaxStashedFrames; ++slot) {
+      const StashedFrame& stashed = stashed_frames_[slot];
+      if (!stashed.queued &&
+          (oldest == -1 || stashed.order < stashed_frames_[oldest].order)) {
+        oldest = slot;
       }
     }
-  } while (complete_frame);
+    if (oldest == -1)
+      return;
+    UnlinkStashedFrame(oldest);
+    FreeStashedFrame(oldest);
+  }
+
+  const int slot = free_stash_slot_;
+  StashedFrame& stashed = stashed_frames_[slot];
+  free_stash_slot_ = stashed.next;
+  stashed.frame = std::move(frame);
+  stashed.order = stash_order_++;
+  ++num_stashed_frames_;
+  LinkStashedFrame(slot, wait_key_);
+}
+
+void RtpFrameReferenceFinder::LinkStashedFrame(int slot, uint64_t wait_key) {
+  StashedFrame& stashed = stashed_frames_[slot];
+  const size_t bucket = wait_key % kStashBuckets;
+  stashed.wait_key = wait_key;
+  stashed.next = stash_buckets_[bucket];
+  stash_buckets_[bucket] = slot;
+}
+
+void RtpFrameReferenceFinder::UnlinkStashedFrame(int slot) {
+  int* link = &stash_buckets_[stashed_frames_[slot].wait_key % kStashBuckets];
+  while (*link != slot) {
+    RTC_DCHECK_NE(*link, -1);
+    link = &stashed_frames_[*link].next;
+  }
+  *link = stashed_frames_[slot].next;
+  stashed_frames_[slot].next = -1;
+}
+
+void RtpFrameReferenceFinder::QueueStashedFrame(int slot) {
+  RTC_DCHECK_LT(retry_queue_size_, kMaxStashedFrames);
+  stashed_frames_[slot].queued = true;
+  retry_queue_[(retry_queue_start_ + retry_queue_size_) % kMaxStashedFrames] =
+      slot;
+  ++retry_queue_size_;
+}
+
+void RtpFrameReferenceFinder::FreeStashedFrame(int slot) {
+  StashedFrame& stashed = stashed_frames_[slot];
+  stashed.frame.reset();
+  stashed.queued = false;
+  stashed.next = free_stash_slot_;
+  free_stash_slot_ = slot;
+  --num_stashed_frames_;
+}
+
+void RtpFrameReferenceFinder::Wake(WaitFor wait_for, int64_t value) {
+  const uint64_t wait_key =
+      (static_cast<uint64_t>(wait_for) << kWaitForShift) |
+      (static_cast<uint64_t>(value) & kWaitValueMask);
+  int* link = &stash_buckets_[wait_key % kStashBuckets];
+  while (*link != -1) {
+    const int slot = *link;
+    StashedFrame& stashed = stashed_frames_[slot];
+    if (stashed.wait_key != wait_key) {
+      link = &stashed.next;
+      continue;
+    }
+    *link = stashed.next;
+    stashed.next = -1;
+    QueueStashedFrame(slot);
+  }
+}
+
+void RtpFrameReferenceFinder::WakeAll(WaitFor wait_for) {
+  for (int slot = 0; slot < kMaxStashedFrames; ++slot) {
+    const StashedFrame& stashed = stashed_frames_[slot];
+    if (stashed.frame && !stashed.queued &&
+        stashed.wait_key >> kWaitForShift ==
+            static_cast<uint64_t>(wait_for)) {
+      UnlinkStashedFrame(slot);
+      QueueStashedFrame(slot);
+    }
+  }
+}
+
+void RtpFrameReferenceFinder::RetryStashedFrames() {
+  while (retry_queue_size_ > 0) {
+    const int slot = retry_queue_[retry_queue_start_];
+    retry_queue_start_ = (retry_queue_start_ + 1) % kMaxStashedFrames;
+    --retry_queue_size_;
+
+    StashedFrame& stashed = stashed_frames_[slot];
+    stashed.queued = false;
+    FrameDecision decision = ManageFrameInternal(stashed.frame.get());
+
+    switch (decision) {
+      case kStash:
+        LinkStashedFrame(slot, wait_key_);
+        break;
+      case kHandOff:
+        frame_callback_->OnCompleteFrame(std::move(stashed.frame));
+        FreeStashedFrame(slot);
+        break;
+      case kDrop:
+        FreeStashedFrame(slot);
+        break;
+    }
+  }
 }
 
 RtpFrameReferenceFinder::FrameDecision
@@ -102,10 +225,12 @@ RtpFrameReferenceFinder::ManageFrameInternal(RtpFrameObject* frame) {
 
 void RtpFrameReferenceFinder::PaddingReceived(uint16_t seq_num) {
   rtc::CritScope lock(&crit_);
-  auto clean_padding_to =
-      stashed_padding_.lower_bound(seq_num - kMaxPaddingAge);
-  stashed_padding_.erase(stashed_padding_.begin(), clean_padding_to);
-  stashed_padding_.insert(seq_num);
+  const uint16_t clean_padding_to = seq_num - kMaxPaddingAge;
+  for (int& padding : stashed_padding_) {
+    if (padding != -1 && AheadOf<uint16_t>(clean_padding_to, padding))
+      padding = -1;
+  }
+  stashed_padding_[seq_num % kPaddingTableSize] = seq_num;
   UpdateLastPictureIdWithPadding(seq_num);
   RetryStashedFrames();
 }
@@ -114,50 +239,83 @@ void RtpFrameReferenceFinder::ClearTo(uint16_t seq_num) {
   rtc::CritScope lock(&crit_);
   cleared_to_seq_num_ = seq_num;
 
-  auto it = stashed_frames_.begin();
-  while (it != stashed_frames_.end()) {
-    if (AheadOf<uint16_t>(cleared_to_seq_num_, (*it)->first_seq_num())) {
-      it = stashed_frames_.erase(it);
-    } else {
-      ++it;
+  for (int slot = 0; slot < kMaxStashedFrames; ++slot) {
+    const StashedFrame& stashed = stashed_frames_[slot];
+    if (stashed.frame && AheadOf<uint16_t>(cleared_to_seq_num_,
+                                           stashed.frame->first_seq_num())) {
+      UnlinkStashedFrame(slot);
+      FreeStashedFrame(slot);
     }
   }
 }
 
 void RtpFrameReferenceFinder::UpdateLastPictureIdWithPadding(uint16_t seq_num) {
-  auto gop_seq_num_it = last_seq_num_gop_.upper_bound(seq_num);
+  GopInfo* gop = FindGop(seq_num);
 
   // If this padding packet "belongs" to a group of pictures that we don't track
   // anymore, do nothing.
-  if (gop_seq_num_it == last_seq_num_gop_.begin())
+  if (!gop)
     return;
-  --gop_seq_num_it;
 
   // Calculate the next contiuous sequence number and search for it in
   // the padding packets we have stashed.
-  uint16_t next_seq_num_with_padding = gop_seq_num_it->second.second + 1;
-  auto padding_seq_num_it =
-      stashed_padding_.lower_bound(next_seq_num_with_padding);
+  uint16_t next_seq_num_with_padding = gop->last_seq_num_with_padding + 1;
 
   // While there still are padding packets and those padding packets are
   // continuous, then advance the "last-picture-id-with-padding" and remove
   // the stashed padding packet.
-  while (padding_seq_num_it != stashed_padding_.end() &&
-         *padding_seq_num_it == next_seq_num_with_padding) {
-    gop_seq_num_it->second.second = next_seq_num_with_padding;
+  int* padding =
+      &stashed_padding_[next_seq_num_with_padding % kPaddingTableSize];
+  while (*padding == next_seq_num_with_padding) {
+    gop->last_seq_num_with_padding = next_seq_num_with_padding;
+    *padding = -1;
     ++next_seq_num_with_padding;
-    padding_seq_num_it = stashed_padding_.erase(padding_seq_num_it);
+    padding = &stashed_padding_[next_seq_num_with_padding % kPaddingTableSize];
   }
+  // A delta frame that starts right after is now continuous.
+  Wake(WaitFor::kSeqNum, gop->last_seq_num_with_padding);
 
   // In the case where the stream has been continuous without any new keyframes
   // for a while there is a risk that new frames will appear to be older than
   // the keyframe they belong to due to wrapping sequence number. In order
   // to prevent this we advance the picture id of the keyframe every so often.
-  if (ForwardDiff(gop_seq_num_it->first, seq_num) > 10000) {
-    RTC_DCHECK_EQ(1ul, last_seq_num_gop_.size());
-    last_seq_num_gop_[seq_num] = gop_seq_num_it->second;
-    last_seq_num_gop_.erase(gop_seq_num_it);
+  if (ForwardDiff(gop->key_frame_seq_num, seq_num) > 10000) {
+    RTC_DCHECK_EQ(1, num_gops_);
+    gop->key_frame_seq_num = seq_num;
+  }
+}
+
+RtpFrameReferenceFinder::GopInfo* RtpFrameReferenceFinder::FindGop(
+    uint16_t seq_num) {
+  for (int i = num_gops_ - 1; i >= 0; --i) {
+    if (!AheadOf(gops_[i].key_frame_seq_num, seq_num))
+      return &gops_[i];
+  }
+  return nullptr;
+}
+
+void RtpFrameReferenceFinder::InsertGop(uint16_t key_frame_seq_num) {
+  // Keep the groups of pictures ordered, oldest first.
+  int index = num_gops_;
+  while (index > 0 &&
+         AheadOf(gops_[index - 1].key_frame_seq_num, key_frame_seq_num)) {
+    --index;
+  }
+  if (index > 0 && gops_[index - 1].key_frame_seq_num == key_frame_seq_num)
+    return;
+
+  if (num_gops_ == kMaxGopsSaved) {
+    // Forget the oldest group of pictures, unless it is this one.
+    if (index == 0)
+      return;
+    std::copy(gops_.begin() + 1, gops_.begin() + num_gops_, gops_.begin());
+    --num_gops_;
+    --index;
   }
+  std::copy_backward(gops_.begin() + index, gops_.begin() + num_gops_,
+                     gops_.begin() + num_gops_ + 1);
+  gops_[index] = {key_frame_seq_num, key_frame_seq_num, key_frame_seq_num};
+  ++num_gops_;
 }
 
 RtpFrameReferenceFinder::FrameDecision
@@ -173,47 +331,49 @@ RtpFrameReferenceFinder::ManageFrameGeneric(RtpFrameObject* frame,
   }
 
   if (frame->frame_type() == kVideoFrameKey) {
-    last_seq_num_gop_.insert(std::make_pair(
-        frame->last_seq_num(),
-        std::make_pair(frame->last_seq_num(), frame->last_seq_num())));
+    InsertGop(frame->last_seq_num());
+    Wake(WaitFor::kKeyFrame, 0);
   }
 
   // We have received a frame but not yet a keyframe, stash this frame.
-  if (last_seq_num_gop_.empty())
-    return kStash;
+  if (num_gops_ == 0)
+    return StashUntil(WaitFor::kKeyFrame, 0);
 
   // Clean up info for old keyframes but make sure to keep info
   // for the last keyframe.
-  auto clean_to = last_seq_num_gop_.lower_bound(frame->last_seq_num() - 100);
-  for (auto it = last_seq_num_gop_.begin();
-       it != clean_to && last_seq_num_gop_.size() > 1;) {
-    it = last_seq_num_gop_.erase(it);
+  const uint16_t clean_to = frame->last_seq_num() - 100;
+  int num_old_gops = 0;
+  while (num_old_gops < num_gops_ - 1 &&
+         AheadOf(clean_to, gops_[num_old_gops].key_frame_seq_num)) {
+    ++num_old_gops;
   }
+  std::copy(gops_.begin() + num_old_gops, gops_.begin() + num_gops_,
+            gops_.begin());
+  num_gops_ -= num_old_gops;
 
   // Find the last sequence number of the last frame for the keyframe
   // that this frame indirectly references.
-  auto seq_num_it = last_seq_num_gop_.upper_bound(frame->last_seq_num());
-  if (seq_num_it == last_seq_num_gop_.begin()) {
+  GopInfo* gop = FindGop(frame->last_seq_num());
+  if (!gop) {
     RTC_LOG(LS_WARNING) << "Generic frame with packet range ["
                         << frame->first_seq_num() << ", "
                         << frame->last_seq_num()
                         << "] has no GoP, dropping frame.";
     return kDrop;
   }
-  seq_num_it--;
 
   // Make sure the packet sequence numbers are continuous, otherwise stash
   // this frame.
-  uint16_t last_picture_id_gop = seq_num_it->second.first;
-  uint16_t last_picture_id_with_padding_gop = seq_num_it->second.second;
+  uint16_t last_picture_id_gop = gop->last_seq_num;
+  uint16_t last_picture_id_with_padding_gop = gop->last_seq_num_with_padding;
   if (frame->frame_type() == kVideoFrameDelta) {
     uint16_t prev_seq_num = frame->first_seq_num() - 1;
 
     if (prev_seq_num != last_picture_id_with_padding_gop)
-      return kStash;
+      return StashUntil(WaitFor::kSeqNum, prev_seq_num);
   }
 
-  RTC_DCHECK(AheadOrAt(frame->last_seq_num(), seq_num_it->first));
+  RTC_DCHECK(AheadOrAt(frame->last_seq_num(), gop->key_frame_seq_num));
 
   // Since keyframes can cause reordering we can't simply assign the
   // picture id according to some incrementing counter.
@@ -221,8 +381,8 @@ RtpFrameReferenceFinder::ManageFrameGeneric(RtpFrameObject* frame,
   frame->num_references = frame->frame_type() == kVideoFrameDelta;
   frame->references[0] = generic_unwrapper_.Unwrap(last_picture_id_gop);
   if (AheadOf<uint16_t>(frame->id.picture_id, last_picture_id_gop)) {
-    seq_num_it->second.first = frame->id.picture_id;
-    seq_num_it->second.second = frame->id.picture_id;
+    gop->last_seq_num = frame->id.picture_id;
+    gop->last_seq_num_with_padding = frame->id.picture_id;
   }
 
   last_picture_id_ = frame->id.picture_id;
@@ -258,48 +418,69 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
   // Find if there has been a gap in fully received frames and save the picture
   // id of those frames in |not_yet_received_frames_|.
   if (AheadOf<uint16_t, kPicIdLength>(frame->id.picture_id, last_picture_id_)) {
+    const uint16_t diff = ForwardDiff<uint16_t, kPicIdLength>(
+        last_picture_id_, frame->id.picture_id);
+
+    // Frames older than |kMaxNotYetReceivedFrames| are no longer waited for,
+    // so retry the frames that waited for them.
+    if (diff >= kNotYetReceivedTableSize) {
+      WakeAll(WaitFor::kPictureId);
+    } else {
+      const uint16_t expired_from = Subtract<kPicIdLength>(
+          last_picture_id_, kMaxNotYetReceivedFrames);
+      for (uint16_t i = 0; i < diff; ++i)
+        Wake(WaitFor::kPictureId, Add<kPicIdLength>(expired_from, i));
+    }
+
+    // Only the most recent frames fit in the table.
+    last_picture_id_ =
+        diff > kNotYetReceivedTableSize
+            ? Subtract<kPicIdLength>(frame->id.picture_id,
+                                     kNotYetReceivedTableSize)
+            : last_picture_id_;
     do {
       last_picture_id_ = Add<kPicIdLength>(last_picture_id_, 1);
-      not_yet_received_frames_.insert(last_picture_id_);
+      not_yet_received_frames_[last_picture_id_ % kNotYetReceivedTableSize] =
+          last_picture_id_;
     } while (last_picture_id_ != frame->id.picture_id);
   }
 
   int64_t unwrapped_tl0 = tl0_unwrapper_.Unwrap(codec_header.tl0PicIdx);
 
-  // Clean up info for base layers that are too old.
-  int64_t old_tl0_pic_idx = unwrapped_tl0 - kMaxLayerInfo;
-  auto clean_layer_info_to = layer_info_.lower_bound(old_tl0_pic_idx);
-  layer_info_.erase(layer_info_.begin(), clean_layer_info_to);
-
-  // Clean up info about not yet received frames that are too old.
-  uint16_t old_picture_id =
-      Subtract<kPicIdLength>(frame->id.picture_id, kMaxNotYetReceivedFrames);
-  auto clean_frames_to = not_yet_received_frames_.lower_bound(old_picture_id);
-  not_yet_received_frames_.erase(not_yet_received_frames_.begin(),
-                                 clean_frames_to);
-
   if (frame->frame_type() == kVideoFrameKey) {
     frame->num_references = 0;
-    layer_info_[unwrapped_tl0].fill(-1);
+    bool inserted;
+    LayerInfo* layer_info = layer_info_.Insert(unwrapped_tl0, &inserted);
+    if (layer_info) {
+      layer_info->fill(-1);
+      Wake(WaitFor::kTl0PicIdx, unwrapped_tl0);
+    }
     UpdateLayerInfoVp8(frame, unwrapped_tl0, codec_header.temporalIdx);
     return kHandOff;
   }
 
-  auto layer_info_it = layer_info_.find(
-      codec_header.temporalIdx == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0);
+  const int64_t base_tl0 =
+      codec_header.temporalIdx == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0;
+  LayerInfo* layer_info = layer_info_.Find(base_tl0);
 
   // If we don't have the base layer frame yet, stash this frame.
-  if (layer_info_it == layer_info_.end())
-    return kStash;
+  if (!layer_info)
+    return StashUntil(WaitFor::kTl0PicIdx, base_tl0);
 
   // A non keyframe base layer frame has been received, copy the layer info
   // from the previous base layer frame and set a reference to the previous
   // base layer frame.
   if (codec_header.temporalIdx == 0) {
-    layer_info_it =
-        layer_info_.emplace(unwrapped_tl0, layer_info_it->second).first;
+    bool inserted;
+    LayerInfo* base_layer_info = layer_info_.Insert(unwrapped_tl0, &inserted);
+    if (!base_layer_info)
+      return kDrop;
+    if (inserted) {
+      *base_layer_info = *layer_info;
+      Wake(WaitFor::kTl0PicIdx, unwrapped_tl0);
+    }
     frame->num_references = 1;
-    frame->references[0] = layer_info_it->second[0];
+    frame->references[0] = (*base_layer_info)[0];
     UpdateLayerInfoVp8(frame, unwrapped_tl0, codec_header.temporalIdx);
     return kHandOff;
   }
@@ -307,7 +488,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
   // Layer sync frame, this frame only references its base layer frame.
   if (codec_header.layerSync) {
     frame->num_references = 1;
-    frame->references[0] = layer_info_it->second[0];
+    frame->references[0] = (*layer_info)[0];
 
     UpdateLayerInfoVp8(frame, unwrapped_tl0, codec_header.temporalIdx);
     return kHandOff;
@@ -318,29 +499,28 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
   for (uint8_t layer = 0; layer <= codec_header.temporalIdx; ++layer) {
     // If we have not yet received a previous frame on this temporal layer,
     // stash this frame.
-    if (layer_info_it->second[layer] == -1)
-      return kStash;
+    if ((*layer_info)[layer] == -1) {
+      return StashUntil(WaitFor::kTemporalLayer,
+                        unwrapped_tl0 * kMaxTemporalLayers + layer);
+    }
 
     // If the last frame on this layer is ahead of this frame it means that
     // a layer sync frame has been received after this frame for the same
     // base layer frame, drop this frame.
-    if (AheadOf<uint16_t, kPicIdLength>(layer_info_it->second[layer],
+    if (AheadOf<uint16_t, kPicIdLength>((*layer_info)[layer],
                                         frame->id.picture_id)) {
       return kDrop;
     }
 
     // If we have not yet received a frame between this frame and the referenced
     // frame then we have to wait for that frame to be completed first.
-    auto not_received_frame_it =
-        not_yet_received_frames_.upper_bound(layer_info_it->second[layer]);
-    if (not_received_frame_it != not_yet_received_frames_.end() &&
-        AheadOf<uint16_t, kPicIdLength>(frame->id.picture_id,
-                                        *not_received_frame_it)) {
-      return kStash;
-    }
+    int not_received_frame =
+        NotYetReceivedFrameVp8((*layer_info)[layer], frame->id.picture_id);
+    if (not_received_frame != -1)
+      return StashUntil(WaitFor::kPictureId, not_received_frame);
 
     if (!(AheadOf<uint16_t, kPicIdLength>(frame->id.picture_id,
-                                          layer_info_it->second[layer]))) {
+                                          (*layer_info)[layer]))) {
       RTC_LOG(LS_WARNING) << "Frame with picture id " << frame->id.picture_id
                           << " and packet range [" << frame->first_seq_num()
                           << ", " << frame->last_seq_num()
@@ -350,7 +530,7 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
     }
 
     ++frame->num_references;
-    frame->references[layer] = layer_info_it->second[layer];
+    frame->references[layer] = (*layer_info)[layer];
   }
 
   UpdateLayerInfoVp8(frame, unwrapped_tl0, codec_header.temporalIdx);
@@ -360,27 +540,60 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp8(
 void RtpFrameReferenceFinder::UpdateLayerInfoVp8(RtpFrameObject* frame,
                                                  int64_t unwrapped_tl0,
                                                  uint8_t temporal_idx) {
-  auto layer_info_it = layer_info_.find(unwrapped_tl0);
+  LayerInfo* layer_info = layer_info_.Find(unwrapped_tl0);
 
   // Update this layer info and newer.
-  while (layer_info_it != layer_info_.end()) {
-    if (layer_info_it->second[temporal_idx] != -1 &&
-        AheadOf<uint16_t, kPicIdLength>(layer_info_it->second[temporal_idx],
+  while (layer_info) {
+    if ((*layer_info)[temporal_idx] != -1 &&
+        AheadOf<uint16_t, kPicIdLength>((*layer_info)[temporal_idx],
                                         frame->id.picture_id)) {
       // The frame was not newer, then no subsequent layer info have to be
       // update.
       break;
     }
 
-    layer_info_it->second[temporal_idx] = frame->id.picture_id;
+    (*layer_info)[temporal_idx] = frame->id.picture_id;
+    Wake(WaitFor::kTemporalLayer,
+         unwrapped_tl0 * kMaxTemporalLayers + temporal_idx);
     ++unwrapped_tl0;
-    layer_info_it = layer_info_.find(unwrapped_tl0);
+    layer_info = layer_info_.Find(unwrapped_tl0);
+  }
+
+  int16_t& not_yet_received_frame =
+      not_yet_received_frames_[frame->id.picture_id %
+                               kNotYetReceivedTableSize];
+  if (not_yet_received_frame == frame->id.picture_id) {
+    not_yet_received_frame = -1;
+    Wake(WaitFor::kPictureId, frame->id.picture_id);
   }
-  not_yet_received_frames_.erase(frame->id.picture_id);
 
   UnwrapPictureIds(frame);
 }
 
+int RtpFrameReferenceFinder::NotYetReceivedFrameVp8(uint16_t pid_ref,
+                                                    uint16_t picture_id) {
+  // Frames older than |kMaxNotYetReceivedFrames| before this frame, or before
+  // the most recent frame, are no longer waited for.
+  uint16_t oldest =
+      Subtract<kPicIdLength>(picture_id, kMaxNotYetReceivedFrames);
+  const uint16_t oldest_for_last_picture_id =
+      Subtract<kPicIdLength>(last_picture_id_, kMaxNotYetReceivedFrames);
+  if (AheadOf<uint16_t, kPicIdLength>(oldest_for_last_picture_id, oldest))
+    oldest = oldest_for_last_picture_id;
+  uint16_t candidate = Add<kPicIdLength>(pid_ref, 1);
+  if (AheadOf<uint16_t, kPicIdLength>(oldest, candidate))
+    candidate = oldest;
+
+  for (; AheadOf<uint16_t, kPicIdLength>(picture_id, candidate);
+       candidate = Add<kPicIdLength>(candidate, 1)) {
+    if (not_yet_received_frames_[candidate % kNotYetReceivedTableSize] ==
+        candidate) {
+      return candidate;
+    }
+  }
+  return -1;
+}
+
 RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
     RtpFrameObject* frame) {
   absl::optional<RTPVideoHeader> video_header = frame->GetRtpVideoHeader();
@@ -444,16 +657,18 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
       current_ss_idx_ = Add<kMaxGofSaved>(current_ss_idx_, 1);
       scalability_structures_[current_ss_idx_] = gof;
       scalability_structures_[current_ss_idx_].pid_start = frame->id.picture_id;
-      gof_info_.emplace(unwrapped_tl0,
-                        GofInfo(&scalability_structures_[current_ss_idx_],
-                                frame->id.picture_id));
+      bool inserted;
+      GofInfo* gof_info = gof_info_.Insert(unwrapped_tl0, &inserted);
+      if (inserted) {
+        *gof_info = GofInfo(&scalability_structures_[current_ss_idx_],
+                            frame->id.picture_id);
+        Wake(WaitFor::kTl0PicIdx, unwrapped_tl0);
+      }
     }
 
-    const auto gof_info_it = gof_info_.find(unwrapped_tl0);
-    if (gof_info_it == gof_info_.end())
-      return kStash;
-
-    info = &gof_info_it->second;
+    info = gof_info_.Find(unwrapped_tl0);
+    if (!info)
+      return StashUntil(WaitFor::kTl0PicIdx, unwrapped_tl0);
 
     if (frame->frame_type() == kVideoFrameKey) {
       frame->num_references = 0;
@@ -467,42 +682,47 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
       return kDrop;
     }
 
-    auto gof_info_it = gof_info_.find(
-        (codec_header.temporal_idx == 0) ? unwrapped_tl0 - 1 : unwrapped_tl0);
+    const int64_t base_tl0 =
+        codec_header.temporal_idx == 0 ? unwrapped_tl0 - 1 : unwrapped_tl0;
+    info = gof_info_.Find(base_tl0);
 
     // Gof info for this frame is not available yet, stash this frame.
-    if (gof_info_it == gof_info_.end())
-      return kStash;
+    if (!info)
+      return StashUntil(WaitFor::kTl0PicIdx, base_tl0);
 
     if (codec_header.temporal_idx == 0) {
-      gof_info_it = gof_info_
-                        .emplace(unwrapped_tl0, GofInfo(gof_info_it->second.gof,
-                                                        frame->id.picture_id))
-                        .first;
+      bool inserted;
+      GofInfo* base_info = gof_info_.Insert(unwrapped_tl0, &inserted);
+      if (!base_info)
+        return kDrop;
+      if (inserted) {
+        *base_info = GofInfo(info->gof, frame->id.picture_id);
+        Wake(WaitFor::kTl0PicIdx, unwrapped_tl0);
+      }
+      info = base_info;
     }
-
-    info = &gof_info_it->second;
   }
 
-  // Clean up info for base layers that are too old.
-  int64_t old_tl0_pic_idx = unwrapped_tl0 - kMaxGofSaved;
-  auto clean_gof_info_to = gof_info_.lower_bound(old_tl0_pic_idx);
-  gof_info_.erase(gof_info_.begin(), clean_gof_info_to);
-
   FrameReceivedVp9(frame->id.picture_id, info);
 
   // Make sure we don't miss any frame that could potentially have the
   // up switch flag set.
-  if (MissingRequiredFrameVp9(frame->id.picture_id, *info))
-    return kStash;
-
-  if (codec_header.temporal_up_switch)
-    up_switch_.emplace(frame->id.picture_id, codec_header.temporal_idx);
+  absl::optional<uint16_t> missing_picture_id;
+  if (MissingRequiredFrameVp9(frame->id.picture_id, *info,
+                              &missing_picture_id)) {
+    return missing_picture_id
+               ? StashUntil(WaitFor::kPictureId, *missing_picture_id)
+               : StashUntil(WaitFor::kNothing, 0);
+  }
 
-  // Clean out old info about up switch frames.
-  uint16_t old_picture_id = Subtract<kPicIdLength>(frame->id.picture_id, 50);
-  auto up_switch_erase_to = up_switch_.lower_bound(old_picture_id);
-  up_switch_.erase(up_switch_.begin(), up_switch_erase_to);
+  if (codec_header.temporal_up_switch) {
+    UpSwitch& up_switch =
+        up_switch_[frame->id.picture_id % kUpSwitchTableSize];
+    if (up_switch.picture_id != frame->id.picture_id) {
+      up_switch.picture_id = frame->id.picture_id;
+      up_switch.temporal_idx = codec_header.temporal_idx;
+    }
+  }
 
   size_t diff = ForwardDiff<uint16_t, kPicIdLength>(info->gof->pid_start,
                                                     frame->id.picture_id);
@@ -526,8 +746,10 @@ RtpFrameReferenceFinder::FrameDecision RtpFrameReferenceFinder::ManageFrameVp9(
   return kHandOff;
 }
 
-bool RtpFrameReferenceFinder::MissingRequiredFrameVp9(uint16_t picture_id,
-                                                      const GofInfo& info) {
+bool RtpFrameReferenceFinder::MissingRequiredFrameVp9(
+    uint16_t picture_id,
+    const GofInfo& info,
+    absl::optional<uint16_t>* missing_picture_id) {
   size_t diff =
       ForwardDiff<uint16_t, kPicIdLength>(info.gof->pid_start, picture_id);
   size_t gof_idx = diff % info.gof->num_frames_in_gof;
@@ -540,16 +762,19 @@ bool RtpFrameReferenceFinder::MissingRequiredFrameVp9(uint16_t picture_id,
   }
 
   // For every reference this frame has, check if there is a frame missing in
-  // the interval (|ref_pid|, |picture_id|) in any of the lower temporal
-  // layers. If so, we are missing a required frame.
+  // the interval [|ref_pid|, |picture_id|) in any of the lower temporal
+  // layers. If so, we are missing a required frame. The picture id
+  // difference is less than the size of |missing_frames_|.
   uint8_t num_references = info.gof->num_ref_pics[gof_idx];
   for (size_t i = 0; i < num_references; ++i) {
-    uint16_t ref_pid =
-        Subtract<kPicIdLength>(picture_id, info.gof->pid_diff[gof_idx][i]);
-    for (size_t l = 0; l < temporal_idx; ++l) {
-      auto missing_frame_it = missing_frames_for_layer_[l].lower_bound(ref_pid);
-      if (missing_frame_it != missing_frames_for_layer_[l].end() &&
-          AheadOf<uint16_t, kPicIdLength>(picture_id, *missing_frame_it)) {
+    for (uint16_t pid = Subtract<kPicIdLength>(picture_id,
+                                               info.gof->pid_diff[gof_idx][i]);
+         pid != picture_id; pid = Add<kPicIdLength>(pid, 1)) {
+      const MissingFrame& missing_frame =
+          missing_frames_[pid % kMissingFramesTableSize];
+      if (missing_frame.picture_id == pid &&
+          missing_frame.temporal_idx < temporal_idx) {
+        *missing_picture_id = pid;
         return true;
       }
     }
@@ -568,9 +793,16 @@ void RtpFrameReferenceFinder::FrameReceivedVp9(uint16_t picture_id,
   if (AheadOf<uint16_t, kPicIdLength>(picture_id, last_picture_id)) {
     size_t diff = ForwardDiff<uint16_t, kPicIdLength>(info->gof->pid_start,
                                                       last_picture_id);
-    size_t gof_idx = diff % gof_size;
-
-    last_picture_id = Add<kPicIdLength>(last_picture_id, 1);
+    // Only the most recent missing frames fit in the table.
+    const uint16_t num_missing = ForwardDiff<uint16_t, kPicIdLength>(
+                                     last_picture_id, picture_id) -
+                                 1;
+    const uint16_t skipped = num_missing > kMissingFramesTableSize
+                                 ? num_missing - kMissingFramesTableSize
+                                 : 0;
+    size_t gof_idx = (diff + skipped) % gof_size;
+
+    last_picture_id = Add<kPicIdLength>(last_picture_id, 1 + skipped);
     while (last_picture_id != picture_id) {
       gof_idx = (gof_idx + 1) % gof_size;
       RTC_CHECK(gof_idx < kMaxVp9FramesInGof);
@@ -582,7 +814,10 @@ void RtpFrameReferenceFinder::FrameReceivedVp9(uint16_t picture_id,
         return;
       }
 
-      missing_frames_for_layer_[temporal_idx].insert(last_picture_id);
+      MissingFrame& missing_frame =
+          missing_frames_[last_picture_id % kMissingFramesTableSize];
+      missing_frame.picture_id = last_picture_id;
+      missing_frame.temporal_idx = temporal_idx;
       last_picture_id = Add<kPicIdLength>(last_picture_id, 1);
     }
 
@@ -600,18 +835,29 @@ void RtpFrameReferenceFinder::FrameReceivedVp9(uint16_t picture_id,
       return;
     }
 
-    missing_frames_for_layer_[temporal_idx].erase(picture_id);
+    MissingFrame& missing_frame =
+        missing_frames_[picture_id % kMissingFramesTableSize];
+    if (missing_frame.picture_id == picture_id &&
+        missing_frame.temporal_idx == temporal_idx) {
+      missing_frame.picture_id = -1;
+      Wake(WaitFor::kPictureId, picture_id);
+    }
   }
 }
 
 bool RtpFrameReferenceFinder::UpSwitchInIntervalVp9(uint16_t picture_id,
                                                     uint8_t temporal_idx,
                                                     uint16_t pid_ref) {
-  for (auto up_switch_it = up_switch_.upper_bound(pid_ref);
-       up_switch_it != up_switch_.end() &&
-       AheadOf<uint16_t, kPicIdLength>(picture_id, up_switch_it->first);
-       ++up_switch_it) {
-    if (up_switch_it->second < temporal_idx)
+  // Up switch frames older than 50 frames before this frame are forgotten.
+  uint16_t pid = Add<kPicIdLength>(pid_ref, 1);
+  const uint16_t oldest = Subtract<kPicIdLength>(picture_id, 50);
+  if (AheadOf<uint16_t, kPicIdLength>(oldest, pid))
+    pid = oldest;
+
+  for (; AheadOf<uint16_t, kPicIdLength>(picture_id, pid);
+       pid = Add<kPicIdLength>(pid, 1)) {
+    const UpSwitch& up_switch = up_switch_[pid % kUpSwitchTableSize];
+    if (up_switch.picture_id == pid && up_switch.temporal_idx < temporal_idx)
       return true;
   }
 
@@ -12,12 +12,9 @@
 #define MODULES_VIDEO_CODING_RTP_FRAME_REFERENCE_FINDER_H_
 
 #include <array>
-#include <deque>
-#include <map>
 #include <memory>
-#include <set>
-#include <utility>
 
+#include "absl/types/optional.h"
 #include "modules/include/module_common_types.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/numerics/sequence_number_util.h"
@@ -46,7 +43,7 @@ class RtpFrameReferenceFinder {
   //  - We have all information needed to determine its references, after
   //    which |frame_callback_| is called with the completed frame, or
   //  - We have too many stashed frames (determined by |kMaxStashedFrames|)
-  //    so we drop this frame, or
+  //    so we drop the oldest stashed frame, or
   //  - It gets cleared by ClearTo, which also means we drop it.
   void ManageFrame(std::unique_ptr<RtpFrameObject> frame);
 
@@ -60,30 +57,157 @@ class RtpFrameReferenceFinder {
  private:
   static const uint16_t kPicIdLength = 1 << 15;
   static const uint8_t kMaxTemporalLayers = 5;
-  static const int kMaxLayerInfo = 50;
   static const int kMaxStashedFrames = 100;
   static const int kMaxNotYetReceivedFrames = 100;
   static const int kMaxGofSaved = 50;
   static const int kMaxPaddingAge = 100;
+  static const int kMaxGopsSaved = 32;
+
+  // Sizes of the circular tables. Entries are stored at their key modulo the
+  // size, so every table covers at least the age its entries are kept for.
+  static const size_t kTl0TableSize = 64;
+  static const size_t kPaddingTableSize = 128;
+  static const size_t kNotYetReceivedTableSize = 128;
+  static const size_t kMissingFramesTableSize = 256;
+  static const size_t kUpSwitchTableSize = 64;
+  static const size_t kStashBuckets = 128;
 
   enum FrameDecision { kStash, kHandOff, kDrop };
 
+  // What a stashed frame waits for. A stashed frame is only retried when
+  // what it waits for has happened, so the work per frame does not grow with
+  // the number of stashed frames.
+  enum class WaitFor : uint8_t {
+    // Nothing that will happen, the frame is kept until it is dropped.
+    kNothing,
+    // The first key frame of a generic stream.
+    kKeyFrame,
+    // The group of pictures of a generic frame to be continuous up to a
+    // sequence number.
+    kSeqNum,
+    // The layer info (VP8) or GOF info (VP9) of an unwrapped TL0PICIDX.
+    kTl0PicIdx,
+    // A VP8 frame on a temporal layer for an unwrapped TL0PICIDX.
+    kTemporalLayer,
+    // A frame with a picture id.
+    kPictureId,
+  };
+
   struct GofInfo {
+    GofInfo() : gof(nullptr), last_picture_id(0) {}
     GofInfo(GofInfoVP9* gof, uint16_t last_picture_id)
         : gof(gof), last_picture_id(last_picture_id) {}
     GofInfoVP9* gof;
     uint16_t last_picture_id;
   };
 
+  // For a group of pictures, the sequence number of the last packet of its
+  // key frame, of the last packet of the last completed frame, and of the
+  // last completed frame advanced by any potential continuous packets of
+  // padding.
+  struct GopInfo {
+    uint16_t key_frame_seq_num;
+    uint16_t last_seq_num;
+    uint16_t last_seq_num_with_padding;
+  };
+
+  struct StashedFrame {
+    std::unique_ptr<RtpFrameObject> frame;
+    uint64_t wait_key = 0;
+    // Order in which the frames were first stashed, the oldest frame is
+    // dropped when the stash is full.
+    uint64_t order = 0;
+    // The next frame in the same bucket, or the next free slot.
+    int next = -1;
+    // Set while the frame is waiting to be retried.
+    bool queued = false;
+  };
+
+  struct MissingFrame {
+    int16_t picture_id = -1;
+    uint8_t temporal_idx = 0;
+  };
+
+  struct UpSwitch {
+    int16_t picture_id = -1;
+    uint8_t temporal_idx = 0;
+  };
+
+  // The |kTl0TableSize| most recent entries keyed by unwrapped TL0PICIDX.
+  template <typename T>
+  class Tl0Table {
+   public:
+    T* Find(int64_t tl0) {
+      Entry& entry = entries_[Index(tl0)];
+      return entry.tl0 == tl0 ? &entry.value : nullptr;
+    }
+
+    // Returns the entry of |tl0|, which is added if there is none, or null if
+    // |tl0| is too old to be added.
+    T* Insert(int64_t tl0, bool* inserted) {
+      Entry& entry = entries_[Index(tl0)];
+      *inserted = false;
+      if (entry.tl0 == tl0)
+        return &entry.value;
+      if (entry.tl0 > tl0)
+        return nullptr;
+      entry.tl0 = tl0;
+      entry.value = T();
+      *inserted = true;
+      return &entry.value;
+    }
+
+   private:
+    struct Entry {
+      int64_t tl0 = -1;
+      T value;
+    };
+
+    static size_t Index(int64_t tl0) {
+      return static_cast<uint64_t>(tl0) % kTl0TableSize;
+    }
+
+    std::array<Entry, kTl0TableSize> entries_;
+  };
+
+  using LayerInfo = std::array<int16_t, kMaxTemporalLayers>;
+
   rtc::CriticalSection crit_;
 
+  // Sets what the frame being managed waits for and returns kStash.
+  FrameDecision StashUntil(WaitFor wait_for, int64_t value)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Stashes |frame| until what it waits for has happened. Drops the oldest
+  // stashed frame if the stash is full.
+  void StashFrame(std::unique_ptr<RtpFrameObject> frame)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Queues the stashed frames waiting for |wait_for| with |value| to be
+  // retried, or with any value for WakeAll().
+  void Wake(WaitFor wait_for, int64_t value)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void WakeAll(WaitFor wait_for) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // Retry queued frames until no more frames are queued.
+  void RetryStashedFrames() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  void LinkStashedFrame(int slot, uint64_t wait_key)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void UnlinkStashedFrame(int slot) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void QueueStashedFrame(int slot) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void FreeStashedFrame(int slot) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Find the relevant group of pictures and update its "last-picture-id-with
   // padding" sequence number.
   void UpdateLastPictureIdWithPadding(uint16_t seq_num)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
-  // Retry stashed frames until no more complete frames are found.
-  void RetryStashedFrames() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Returns the newest group of pictures whose key frame is not newer than
+  // |seq_num|, if any.
+  GopInfo* FindGop(uint16_t seq_num) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void InsertGop(uint16_t key_frame_seq_num)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   FrameDecision ManageFrameInternal(RtpFrameObject* frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
@@ -105,18 +229,26 @@ class RtpFrameReferenceFinder {
                           uint8_t temporal_idx)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
+  // Returns the oldest frame in the interval (|pid_ref|, |picture_id|) that
+  // has not yet been received, or -1 if there is none.
+  int NotYetReceivedFrameVp8(uint16_t pid_ref, uint16_t picture_id)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // Find references for Vp9 frames
   FrameDecision ManageFrameVp9(RtpFrameObject* frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Check if we are missing a frame necessary to determine the references
-  // for this frame.
-  bool MissingRequiredFrameVp9(uint16_t picture_id, const GofInfo& info)
+  // for this frame. If so, |missing_picture_id| is set to the missing frame
+  // unless the frame can't be handled at all.
+  bool MissingRequiredFrameVp9(uint16_t picture_id,
+                               const GofInfo& info,
+                               absl::optional<uint16_t>* missing_picture_id)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Updates which frames that have been received. If there is a gap,
-  // missing frames will be added to |missing_frames_for_layer_| or
-  // if this is an already missing frame then it will be removed.
+  // missing frames will be added to |missing_frames_| or if this is an
+  // already missing frame then it will be removed.
   void FrameReceivedVp9(uint16_t picture_id, GofInfo* info)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
@@ -131,38 +263,44 @@ class RtpFrameReferenceFinder {
   void UnwrapPictureIds(RtpFrameObject* frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
-  // For every group of pictures, hold two sequence numbers. The first being
-  // the sequence number of the last packet of the last completed frame, and
-  // the second being the sequence number of the last packet of the last
-  // completed frame advanced by any potential continuous packets of padding.
-  std::map<uint16_t,
-           std::pair<uint16_t, uint16_t>,
-           DescendingSeqNumComp<uint16_t>>
-      last_seq_num_gop_ RTC_GUARDED_BY(crit_);
+  // The groups of pictures, oldest first.
+  std::array<GopInfo, kMaxGopsSaved> gops_ RTC_GUARDED_BY(crit_);
+  int num_gops_ RTC_GUARDED_BY(crit_);
 
   // Save the last picture id in order to detect when there is a gap in frames
   // that have not yet been fully received.
   int last_picture_id_ RTC_GUARDED_BY(crit_);
 
   // Padding packets that have been received but that are not yet continuous
-  // with any group of pictures.
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> stashed_padding_
-      RTC_GUARDED_BY(crit_);
+  // with any group of pictures, at their sequence number modulo the table
+  // size. Free entries are -1.
+  std::array<int, kPaddingTableSize> stashed_padding_ RTC_GUARDED_BY(crit_);
 
   // Frames earlier than the last received frame that have not yet been
-  // fully received.
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t, kPicIdLength>>
-      not_yet_received_frames_ RTC_GUARDED_BY(crit_);
+  // fully received, at their picture id modulo the table size.
+  std::array<int16_t, kNotYetReceivedTableSize> not_yet_received_frames_
+      RTC_GUARDED_BY(crit_);
 
   // Frames that have been fully received but didn't have all the information
-  // needed to determine their references.
-  std::deque<std::unique_ptr<RtpFrameObject>> stashed_frames_
+  // needed to determine their references. Frames waiting for the same thing
+  // are linked from the bucket of their wait key.
+  std::array<StashedFrame, kMaxStashedFrames> stashed_frames_
       RTC_GUARDED_BY(crit_);
+  std::array<int, kStashBuckets> stash_buckets_ RTC_GUARDED_BY(crit_);
+  int free_stash_slot_ RTC_GUARDED_BY(crit_);
+  int num_stashed_frames_ RTC_GUARDED_BY(crit_);
+  uint64_t stash_order_ RTC_GUARDED_BY(crit_);
+  // What the frame being managed waits for, if it is stashed.
+  uint64_t wait_key_ RTC_GUARDED_BY(crit_);
+
+  // Slots of the stashed frames to retry, in the order they were woken.
+  std::array<int, kMaxStashedFrames> retry_queue_ RTC_GUARDED_BY(crit_);
+  int retry_queue_start_ RTC_GUARDED_BY(crit_);
+  int retry_queue_size_ RTC_GUARDED_BY(crit_);
 
   // Holds the information about the last completed frame for a given temporal
   // layer given an unwrapped Tl0 picture index.
-  std::map<int64_t, std::array<int16_t, kMaxTemporalLayers>> layer_info_
-      RTC_GUARDED_BY(crit_);
+  Tl0Table<LayerInfo> layer_info_ RTC_GUARDED_BY(crit_);
 
   // Where the current scalability structure is in the
   // |scalability_structures_| array.
@@ -173,17 +311,16 @@ class RtpFrameReferenceFinder {
       RTC_GUARDED_BY(crit_);
 
   // Holds the the Gof information for a given unwrapped TL0 picture index.
-  std::map<int64_t, GofInfo> gof_info_ RTC_GUARDED_BY(crit_);
+  Tl0Table<GofInfo> gof_info_ RTC_GUARDED_BY(crit_);
 
   // Keep track of which picture id and which temporal layer that had the
-  // up switch flag set.
-  std::map<uint16_t, uint8_t, DescendingSeqNumComp<uint16_t, kPicIdLength>>
-      up_switch_ RTC_GUARDED_BY(crit_);
-
-  // For every temporal layer, keep a set of which frames that are missing.
-  std::array<std::set<uint16_t, DescendingSeqNumComp<uint16_t, kPicIdLength>>,
-             kMaxTemporalLayers>
-      missing_frames_for_layer_ RTC_GUARDED_BY(crit_);
+  // up switch flag set, at the picture id modulo the table size.
+  std::array<UpSwitch, kUpSwitchTableSize> up_switch_ RTC_GUARDED_BY(crit_);
+
+  // The frames that are missing and their temporal layer, at the picture id
+  // modulo the table size.
+  std::array<MissingFrame, kMissingFramesTableSize> missing_frames_
+      RTC_GUARDED_BY(crit_);
 
   // How far frames have been cleared by sequence number. A frame will be
   // cleared if it contains a packet with a sequence number older than
@@ -0,0 +1,172 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modules/video_coding/frame_object.h"
+#include "modules/video_coding/legacy_rtp_frame_reference_finder.h"
+#include "modules/video_coding/packet_buffer.h"
+#include "modules/video_coding/rtp_frame_reference_finder.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace video_coding {
+namespace {
+
+constexpr int kNumFrames = 20000;
+constexpr int kQuickNumFrames = 200;
+constexpr int kKeyFrameInterval = 300;
+// A lost frame is retransmitted this many frames later, unless the
+// retransmission is lost too.
+constexpr int kRetransmissionDelayFrames = 5;
+constexpr int kLossPercents[] = {0, 1, 5, 10, 20};
+// The temporal layers of the 0-2-1-2 pattern.
+constexpr uint8_t kTemporalPattern[] = {0, 2, 1, 2};
+
+class FakePacketBuffer : public PacketBuffer {
+ public:
+  FakePacketBuffer() : PacketBuffer(nullptr, 0, 0, nullptr) {}
+
+  VCMPacket* GetPacket(uint16_t seq_num) override {
+    auto packet_it = packets_.find(seq_num);
+    return packet_it == packets_.end() ? nullptr : &packet_it->second;
+  }
+
+  bool InsertPacket(VCMPacket* packet) override {
+    packets_[packet->seqNum] = *packet;
+    return true;
+  }
+
+  bool GetBitstream(const RtpFrameObject& frame,
+                    uint8_t* destination) override {
+    return true;
+  }
+
+  void ReturnFrame(RtpFrameObject* frame) override {}
+
+ private:
+  std::map<uint16_t, VCMPacket> packets_;
+};
+
+class FrameCounter : public OnCompleteFrameCallback {
+ public:
+  void OnCompleteFrame(std::unique_ptr<EncodedFrame> frame) override {
+    ++frames_;
+  }
+
+  int frames_ = 0;
+};
+
+// Builds the one packet frames of a VP8 stream with three temporal layers in
+// the order they are received with |loss_percent| random packet loss.
+std::vector<std::unique_ptr<RtpFrameObject>> CreateFrames(int loss_percent,
+                                                          int num_frames) {
+  rtc::scoped_refptr<FakePacketBuffer> packet_buffer(new FakePacketBuffer());
+  Random random(0x3a1d5e);
+  // Indexed by the frame at which a lost frame is received.
+  std::multimap<int, int> retransmissions;
+  std::vector<std::unique_ptr<RtpFrameObject>> frames;
+
+  for (int i = 0; i < num_frames + kRetransmissionDelayFrames; ++i) {
+    std::vector<int> received;
+    auto range = retransmissions.equal_range(i);
+    for (auto it = range.first; it != range.second; ++it)
+      received.push_back(it->second);
+    retransmissions.erase(i);
+
+    if (i < num_frames) {
+      if (static_cast<int>(random.Rand(99)) < loss_percent) {
+        if (static_cast<int>(random.Rand(99)) >= loss_percent)
+          retransmissions.emplace(i + kRetransmissionDelayFrames, i);
+      } else {
+        received.push_back(i);
+      }
+    }
+
+    for (int frame : received) {
+      VCMPacket packet;
+      packet.codec = kVideoCodecVP8;
+      packet.seqNum = static_cast<uint16_t>(frame);
+      packet.is_first_packet_in_frame = true;
+      packet.is_last_packet_in_frame = true;
+      packet.frameType =
+          frame % kKeyFrameInterval == 0 ? kVideoFrameKey : kVideoFrameDelta;
+      auto& vp8_header =
+          packet.video_header.video_type_header.emplace<RTPVideoHeaderVP8>();
+      vp8_header.pictureId = frame % (1 << 15);
+      vp8_header.temporalIdx = kTemporalPattern[frame % 4];
+      vp8_header.tl0PicIdx = static_cast<uint8_t>(frame / 4);
+      // The upper layers restart from the base layer after a key frame.
+      vp8_header.layerSync = frame % kKeyFrameInterval < 3;
+      packet_buffer->InsertPacket(&packet);
+      frames.emplace_back(new RtpFrameObject(packet_buffer, packet.seqNum,
+                                             packet.seqNum, 0, 0, 0));
+    }
+  }
+  return frames;
+}
+
+// Passes the frames of a lossy stream to a FinderT, clearing stashed frames
+// older than every key frame the way RtpVideoStreamReceiver does once the key
+// frame is decoded. Returns the average time per frame in microseconds.
+template <typename FinderT>
+double FindReferences(int loss_percent) {
+  const int num_frames = field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                             ? kQuickNumFrames
+                             : kNumFrames;
+  std::vector<std::unique_ptr<RtpFrameObject>> frames =
+      CreateFrames(loss_percent, num_frames);
+  const int num_received_frames = frames.size();
+  FrameCounter counter;
+  FinderT reference_finder(&counter);
+
+  int64_t start_us = rtc::TimeMicros();
+  for (std::unique_ptr<RtpFrameObject>& frame : frames) {
+    const bool key_frame = frame->frame_type() == kVideoFrameKey;
+    const uint16_t seq_num = frame->first_seq_num();
+    reference_finder.ManageFrame(std::move(frame));
+    if (key_frame)
+      reference_finder.ClearTo(seq_num);
+  }
+  const double us_per_frame =
+      static_cast<double>(rtc::TimeMicros() - start_us) / num_received_frames;
+  EXPECT_GT(counter.frames_, 0);
+  return us_per_frame;
+}
+
+template <typename FinderT>
+void RunLossSweep(const std::string& implementation) {
+  for (int loss_percent : kLossPercents) {
+    test::PrintResult(
+        "rtp_frame_reference_finder_vp8", "",
+        implementation + "_loss_" + std::to_string(loss_percent) + "_percent",
+        FindReferences<FinderT>(loss_percent), "us", true);
+  }
+}
+
+}  // namespace
+
+TEST(RtpFrameReferenceFinderPerformanceTest, LossSweep) {
+  RunLossSweep<RtpFrameReferenceFinder>("current");
+}
+
+TEST(RtpFrameReferenceFinderPerformanceTest, LegacyLossSweep) {
+  RunLossSweep<LegacyRtpFrameReferenceFinder>("legacy");
+}
+
+}  // namespace video_coding
+}  // namespace webrtc
@@ -184,6 +184,10 @@ class VideoReceiver : public Module {
   // See |IsDecoderThreadRunning()| for more details.
   void DecoderThreadStarting();
   void DecoderThreadStopped();
+  // Called on the decoder thread when decoding has moved to another thread,
+  // e.g. of a thread pool shared by many streams. Decoding must still never
+  // happen on more than one thread at a time.
+  void DecoderThreadChanged();
 
  protected:
   int32_t Decode(const webrtc::VCMEncodedFrame& frame);
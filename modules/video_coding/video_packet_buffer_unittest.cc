@@ -16,6 +16,7 @@
 #include "common_video/h264/h264_common.h"
 #include "modules/video_coding/frame_object.h"
 #include "modules/video_coding/packet_buffer.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "rtc_base/random.h"
 #include "system_wrappers/include/clock.h"
 #include "test/field_trial.h"
@@ -708,6 +709,71 @@ TEST_F(TestPacketBuffer, DontLeakPayloadData) {
   EXPECT_TRUE(Insert(2 + kMaxSize, kKeyFrame, kFirst, kNotLast, 5, data4));
 }
 
+TEST_F(TestPacketBuffer, GetBitstreamWithReferencedPayloads) {
+  // Payloads stay in the buffers they were received in, after a fake header.
+  const uint8_t kHeader[] = {0x80, 0x60, 0x00, 0x01};
+  rtc::CopyOnWriteBuffer received[2];
+  received[0].AppendData(kHeader);
+  received[0].AppendData("many ", 5);
+  received[1].AppendData(kHeader);
+  received[1].AppendData("data", 5);
+
+  for (int i = 0; i < 2; ++i) {
+    VCMPacket packet;
+    packet.codec = kVideoCodecGeneric;
+    packet.seqNum = 10 + i;
+    packet.frameType = kVideoFrameKey;
+    packet.is_first_packet_in_frame = i == 0;
+    packet.is_last_packet_in_frame = i == 1;
+    packet.dataPtr = received[i].cdata() + sizeof(kHeader);
+    packet.sizeBytes = received[i].size() - sizeof(kHeader);
+    packet.payload_buffer = received[i];
+    EXPECT_TRUE(packet_buffer_->InsertPacket(&packet));
+  }
+
+  ASSERT_EQ(1UL, frames_from_callback_.size());
+  CheckFrame(10);
+  uint8_t result[10];
+  EXPECT_EQ(frames_from_callback_[10]->size(), sizeof(result));
+  EXPECT_TRUE(frames_from_callback_[10]->GetBitstream(result));
+  EXPECT_EQ(memcmp(result, "many data", sizeof(result)), 0);
+}
+
+TEST_F(TestPacketBuffer, InsertStartCodeForReferencedPayload) {
+  const uint8_t kNalu[] = {0x65, 0x88, 0x84};
+  rtc::CopyOnWriteBuffer received(kNalu);
+
+  VCMPacket packet;
+  packet.codec = kVideoCodecGeneric;
+  packet.seqNum = 0;
+  packet.frameType = kVideoFrameKey;
+  packet.is_first_packet_in_frame = true;
+  packet.is_last_packet_in_frame = true;
+  packet.insertStartCode = true;
+  packet.dataPtr = received.cdata();
+  packet.sizeBytes = received.size();
+  packet.payload_buffer = received;
+  EXPECT_TRUE(packet_buffer_->InsertPacket(&packet));
+
+  ASSERT_EQ(1UL, frames_from_callback_.size());
+  const uint8_t kExpected[] = {0, 0, 0, 1, 0x65, 0x88, 0x84};
+  uint8_t result[sizeof(kExpected)];
+  EXPECT_EQ(frames_from_callback_[0]->size(), sizeof(kExpected));
+  EXPECT_TRUE(frames_from_callback_[0]->GetBitstream(result));
+  EXPECT_EQ(memcmp(result, kExpected, sizeof(kExpected)), 0);
+}
+
+TEST_F(TestPacketBuffer, ReuseBitstreamBufferOfDestroyedFrame) {
+  EXPECT_TRUE(Insert(0, kKeyFrame, kFirst, kLast, 100, new uint8_t[100]));
+  ASSERT_EQ(1UL, frames_from_callback_.size());
+  const uint8_t* buffer = frames_from_callback_[0]->Buffer();
+  frames_from_callback_.clear();
+
+  EXPECT_TRUE(Insert(1, kDeltaFrame, kFirst, kLast, 80, new uint8_t[80]));
+  ASSERT_EQ(1UL, frames_from_callback_.size());
+  EXPECT_EQ(buffer, frames_from_callback_[1]->Buffer());
+}
+
 TEST_F(TestPacketBuffer, ContinuousSeqNumDoubleMarkerBit) {
   Insert(2, kKeyFrame, kNotFirst, kNotLast);
   Insert(1, kKeyFrame, kFirst, kLast);
@@ -263,6 +263,10 @@ void VideoReceiver::DecoderThreadStopped() {
 #endif
 }
 
+void VideoReceiver::DecoderThreadChanged() {
+  decoder_thread_checker_.DetachFromThread();
+}
+
 // Decode next frame, blocking.
 // Should be called as often as possible to get the most out of the decoder.
 int32_t VideoReceiver::Decode(uint16_t maxWaitTimeMs) {
@@ -0,0 +1,33 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/seqlock.h"
+
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace webrtc {
+namespace seqlock_impl {
+
+void YieldToWriter() {
+#if defined(WEBRTC_WIN)
+  // Sleep(0) only yields to threads of equal priority.
+  ::Sleep(1);
+#else
+  static const struct timespec kShortSleep = {0, 50 * 1000};
+  nanosleep(&kShortSleep, nullptr);
+#endif
+}
+
+}  // namespace seqlock_impl
+}  // namespace webrtc
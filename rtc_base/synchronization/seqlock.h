@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_SYNCHRONIZATION_SEQLOCK_H_
+#define RTC_BASE_SYNCHRONIZATION_SEQLOCK_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+namespace webrtc {
+namespace seqlock_impl {
+// Briefly blocks the calling thread, so that a writer preempted in the middle
+// of Store() gets to run even if the reader has a higher (e.g. realtime)
+// priority.
+void YieldToWriter();
+}  // namespace seqlock_impl
+
+// Publishes snapshots of a value of type T from a single writer to any number
+// of readers. The writer never blocks and never waits for readers; a reader
+// retries its copy if it overlapped with a Store(), so Load() always returns a
+// value that was passed to a single Store() call.
+//
+// The value is kept in an array of atomic words, which makes the concurrent
+// copies well defined (and race detector clean) at the cost of copying T word
+// by word. This is intended for small structs of counters that are updated
+// often and read rarely, e.g. per-packet statistics read by a timer.
+//
+// Store() must not be called concurrently with itself; Load() is thread safe.
+template <typename T>
+class SeqLock {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type.");
+
+  SeqLock() : SeqLock(T()) {}
+  explicit SeqLock(const T& value) { StoreWords(value); }
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  void Store(const T& value) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    // An odd sequence number marks a write in progress.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    StoreWords(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T Load() const {
+    uint64_t words[kNumWords];
+    uint32_t before;
+    uint32_t after;
+    int attempts = 0;
+    do {
+      if (++attempts > kSpinsBeforeYield)
+        seqlock_impl::YieldToWriter();
+      before = sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kNumWords; ++i)
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = sequence_.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+    T value;
+    memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+ private:
+  static constexpr int kSpinsBeforeYield = 100;
+  static constexpr size_t kNumWords =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  void StoreWords(const T& value) {
+    uint64_t words[kNumWords] = {};
+    memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < kNumWords; ++i)
+      words_[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  std::atomic<uint32_t> sequence_{0};
+  std::atomic<uint64_t> words_[kNumWords];
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_SYNCHRONIZATION_SEQLOCK_H_
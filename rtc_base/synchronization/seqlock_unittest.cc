@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/synchronization/seqlock.h"
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+// Odd size, to exercise the padding of the last word.
+struct Triplet {
+  uint64_t a;
+  uint32_t b;
+  uint16_t c;
+};
+
+struct ReaderState {
+  const SeqLock<Triplet>* seqlock;
+  rtc::Event* stop;
+  int inconsistent_reads = 0;
+  uint64_t last_value = 0;
+  bool went_backwards = false;
+};
+
+void ReadUntilStopped(void* obj) {
+  ReaderState* state = static_cast<ReaderState*>(obj);
+  // Read in bursts; the pause lets the writer run even if readers are
+  // scheduled with a higher priority on a single core.
+  do {
+    for (int i = 0; i < 1000; ++i) {
+      Triplet value = state->seqlock->Load();
+      if (value.b != static_cast<uint32_t>(value.a) ||
+          value.c != static_cast<uint16_t>(value.a)) {
+        ++state->inconsistent_reads;
+      }
+      if (value.a < state->last_value)
+        state->went_backwards = true;
+      state->last_value = value.a;
+    }
+  } while (!state->stop->Wait(1));
+}
+
+}  // namespace
+
+TEST(SeqLockTest, LoadReturnsInitialValue) {
+  SeqLock<Triplet> seqlock(Triplet{7, 8, 9});
+  Triplet value = seqlock.Load();
+  EXPECT_EQ(value.a, 7u);
+  EXPECT_EQ(value.b, 8u);
+  EXPECT_EQ(value.c, 9u);
+}
+
+TEST(SeqLockTest, LoadReturnsLastStoredValue) {
+  SeqLock<Triplet> seqlock;
+  EXPECT_EQ(seqlock.Load().a, 0u);
+  seqlock.Store(Triplet{1, 2, 3});
+  seqlock.Store(Triplet{4, 5, 6});
+  Triplet value = seqlock.Load();
+  EXPECT_EQ(value.a, 4u);
+  EXPECT_EQ(value.b, 5u);
+  EXPECT_EQ(value.c, 6u);
+}
+
+TEST(SeqLockTest, ReadersNeverSeeTornOrStaleValues) {
+  constexpr int kNumReaders = 4;
+  SeqLock<Triplet> seqlock;
+  rtc::Event stop(/*manual_reset=*/true, /*initially_signaled=*/false);
+  std::vector<std::unique_ptr<ReaderState>> states;
+  std::vector<std::unique_ptr<rtc::PlatformThread>> readers;
+  for (int i = 0; i < kNumReaders; ++i) {
+    states.push_back(std::unique_ptr<ReaderState>(new ReaderState()));
+    states.back()->seqlock = &seqlock;
+    states.back()->stop = &stop;
+    readers.emplace_back(new rtc::PlatformThread(
+        &ReadUntilStopped, states.back().get(), "SeqLockReader"));
+    readers.back()->Start();
+  }
+
+  for (uint64_t i = 1; i <= 200000; ++i) {
+    seqlock.Store(
+        Triplet{i, static_cast<uint32_t>(i), static_cast<uint16_t>(i)});
+  }
+
+  stop.Set();
+  for (int i = 0; i < kNumReaders; ++i) {
+    readers[i]->Stop();
+    EXPECT_EQ(states[i]->inconsistent_reads, 0);
+    EXPECT_FALSE(states[i]->went_backwards);
+  }
+  EXPECT_EQ(seqlock.Load().a, 200000u);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,190 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_UINT32_HASH_MAP_H_
+#define RTC_BASE_UINT32_HASH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+// Hash map from uint32_t keys (typically SSRCs) to values of type T, stored in
+// a single flat array using open addressing with linear probing. Compared to
+// std::map and std::unordered_map, a lookup does not chase pointers and
+// usually touches a single cache line, which makes it suitable for per-packet
+// lookups. Memory is only allocated when the table grows, which happens on
+// Insert() when the load factor would exceed 1/2.
+//
+// Erase() uses backward shift deletion, so there are no tombstones and lookup
+// cost does not degrade with churn.
+//
+// T must be default constructible and movable. Pointers returned by Find() and
+// Insert() are invalidated by any subsequent call to Insert(), Erase() or
+// Clear(). This class is not thread safe.
+template <typename T>
+class Uint32HashMap {
+ public:
+  Uint32HashMap() : Uint32HashMap(0) {}
+  // Preallocates room for |expected_size| entries without rehashing.
+  explicit Uint32HashMap(size_t expected_size) {
+    size_t capacity = kMinCapacity;
+    while (capacity < 2 * expected_size)
+      capacity *= 2;
+    Reset(capacity);
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns a pointer to the value associated with |key|, or null if |key| is
+  // not present.
+  T* Find(uint32_t key) {
+    size_t index = IndexOf(key);
+    while (slots_[index].occupied) {
+      if (slots_[index].key == key)
+        return &slots_[index].value;
+      index = (index + 1) & mask_;
+    }
+    return nullptr;
+  }
+  const T* Find(uint32_t key) const {
+    return const_cast<Uint32HashMap*>(this)->Find(key);
+  }
+
+  // Associates |value| with |key|, replacing any previous value. Returns a
+  // pointer to the stored value.
+  T* Insert(uint32_t key, T value) {
+    T* existing = Find(key);
+    if (existing) {
+      *existing = std::move(value);
+      return existing;
+    }
+    if (2 * (size_ + 1) > slots_.size())
+      Grow();
+    size_t index = IndexOf(key);
+    while (slots_[index].occupied)
+      index = (index + 1) & mask_;
+    Slot& slot = slots_[index];
+    slot.occupied = true;
+    slot.key = key;
+    slot.value = std::move(value);
+    ++size_;
+    return &slot.value;
+  }
+
+  // Removes |key|. Returns true if it was present.
+  bool Erase(uint32_t key) {
+    size_t index = IndexOf(key);
+    while (slots_[index].key != key || !slots_[index].occupied) {
+      if (!slots_[index].occupied)
+        return false;
+      index = (index + 1) & mask_;
+    }
+    // Backward shift deletion: move later entries of the same probe sequence
+    // into the hole so that lookups never stop early.
+    size_t hole = index;
+    size_t next = (hole + 1) & mask_;
+    while (slots_[next].occupied) {
+      size_t home = IndexOf(slots_[next].key);
+      // Move the entry at |next| if its home slot is not cyclically in
+      // (hole, next].
+      if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+        slots_[hole].key = slots_[next].key;
+        slots_[hole].value = std::move(slots_[next].value);
+        hole = next;
+      }
+      next = (next + 1) & mask_;
+    }
+    slots_[hole].occupied = false;
+    slots_[hole].value = T();
+    --size_;
+    return true;
+  }
+
+  // Removes all entries, but keeps the allocated table.
+  void Clear() {
+    if (size_ == 0)
+      return;
+    for (Slot& slot : slots_) {
+      slot.occupied = false;
+      slot.value = T();
+    }
+    size_ = 0;
+  }
+
+  // Calls |callback(key, value)| for every entry, in unspecified order. The
+  // callback must not modify the map.
+  template <typename Callback>
+  void ForEach(Callback callback) {
+    for (Slot& slot : slots_) {
+      if (slot.occupied)
+        callback(slot.key, slot.value);
+    }
+  }
+  template <typename Callback>
+  void ForEach(Callback callback) const {
+    for (const Slot& slot : slots_) {
+      if (slot.occupied)
+        callback(slot.key, slot.value);
+    }
+  }
+
+ private:
+  static constexpr size_t kMinCapacity = 16;
+
+  struct Slot {
+    uint32_t key = 0;
+    bool occupied = false;
+    T value;
+  };
+
+  // Fibonacci hashing; uses the high bits of the product, which depend on all
+  // bits of the key.
+  size_t IndexOf(uint32_t key) const {
+    return static_cast<uint32_t>(key * 2654435769u) >> shift_;
+  }
+
+  void Reset(size_t capacity) {
+    RTC_DCHECK_EQ(capacity & (capacity - 1), 0);
+    slots_.clear();
+    slots_.resize(capacity);
+    mask_ = capacity - 1;
+    shift_ = 32;
+    while (capacity > 1) {
+      capacity >>= 1;
+      --shift_;
+    }
+    size_ = 0;
+  }
+
+  void Grow() {
+    std::vector<Slot> old_slots = std::move(slots_);
+    Reset(2 * old_slots.size());
+    for (Slot& slot : old_slots) {
+      if (slot.occupied)
+        Insert(slot.key, std::move(slot.value));
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+  int shift_ = 32;
+  size_t size_ = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_UINT32_HASH_MAP_H_
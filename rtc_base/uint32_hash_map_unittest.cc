@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/uint32_hash_map.h"
+
+#include <map>
+#include <memory>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+TEST(Uint32HashMapTest, EmptyMap) {
+  Uint32HashMap<int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.Find(0), nullptr);
+  EXPECT_EQ(map.Find(1234), nullptr);
+  EXPECT_FALSE(map.Erase(1234));
+}
+
+TEST(Uint32HashMapTest, InsertFindErase) {
+  Uint32HashMap<int> map;
+  map.Insert(0, 10);
+  map.Insert(0xFFFFFFFF, 20);
+  ASSERT_NE(map.Find(0), nullptr);
+  EXPECT_EQ(*map.Find(0), 10);
+  ASSERT_NE(map.Find(0xFFFFFFFF), nullptr);
+  EXPECT_EQ(*map.Find(0xFFFFFFFF), 20);
+  EXPECT_EQ(map.size(), 2u);
+
+  EXPECT_TRUE(map.Erase(0));
+  EXPECT_EQ(map.Find(0), nullptr);
+  EXPECT_FALSE(map.Erase(0));
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(Uint32HashMapTest, InsertReplacesValue) {
+  Uint32HashMap<int> map;
+  map.Insert(17, 1);
+  int* value = map.Insert(17, 2);
+  EXPECT_EQ(*value, 2);
+  EXPECT_EQ(*map.Find(17), 2);
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(Uint32HashMapTest, SupportsMoveOnlyValues) {
+  Uint32HashMap<std::unique_ptr<int>> map;
+  map.Insert(1, std::unique_ptr<int>(new int(5)));
+  ASSERT_NE(map.Find(1), nullptr);
+  EXPECT_EQ(**map.Find(1), 5);
+  EXPECT_TRUE(map.Erase(1));
+}
+
+TEST(Uint32HashMapTest, ClearRemovesAllEntries) {
+  Uint32HashMap<int> map;
+  for (uint32_t i = 0; i < 100; ++i)
+    map.Insert(i, i);
+  map.Clear();
+  EXPECT_TRUE(map.empty());
+  for (uint32_t i = 0; i < 100; ++i)
+    EXPECT_EQ(map.Find(i), nullptr);
+}
+
+TEST(Uint32HashMapTest, ForEachVisitsAllEntries) {
+  Uint32HashMap<int> map;
+  for (uint32_t i = 0; i < 50; ++i)
+    map.Insert(i * 1000, i);
+  int sum = 0;
+  size_t count = 0;
+  map.ForEach([&](uint32_t key, int value) {
+    EXPECT_EQ(key, static_cast<uint32_t>(value) * 1000);
+    sum += value;
+    ++count;
+  });
+  EXPECT_EQ(count, 50u);
+  EXPECT_EQ(sum, 49 * 50 / 2);
+}
+
+// Compares against std::map under random inserts and erases. The small key
+// space forces many collisions and exercises backward shift deletion.
+TEST(Uint32HashMapTest, MatchesStdMapUnderChurn) {
+  Random random(0x1234);
+  Uint32HashMap<uint32_t> map;
+  std::map<uint32_t, uint32_t> reference;
+  for (int i = 0; i < 20000; ++i) {
+    uint32_t key = random.Rand(0, 300) * 0x10000;
+    if (random.Rand(0, 2) == 0) {
+      EXPECT_EQ(map.Erase(key), reference.erase(key) == 1);
+    } else {
+      uint32_t value = random.Rand<uint32_t>();
+      map.Insert(key, value);
+      reference[key] = value;
+    }
+    ASSERT_EQ(map.size(), reference.size());
+  }
+  for (uint32_t key = 0; key <= 300; ++key) {
+    auto it = reference.find(key * 0x10000);
+    const uint32_t* value = map.Find(key * 0x10000);
+    if (it == reference.end()) {
+      EXPECT_EQ(value, nullptr);
+    } else {
+      ASSERT_NE(value, nullptr);
+      EXPECT_EQ(*value, it->second);
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -28,23 +28,34 @@ int GetCPUInfoNoASM(CPUFeature feature) {
 #ifndef _MSC_VER
 // Intrinsic for "cpuid".
 #if defined(__pic__) && defined(__i386__)
-static inline void __cpuid(int cpu_info[4], int info_type) {
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
   __asm__ volatile(
       "mov %%ebx, %%edi\n"
       "cpuid\n"
       "xchg %%edi, %%ebx\n"
       : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
         "=d"(cpu_info[3])
-      : "a"(info_type));
+      : "a"(info_type), "c"(sub_type));
 }
 #else
-static inline void __cpuid(int cpu_info[4], int info_type) {
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
   __asm__ volatile("cpuid\n"
                    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
                      "=d"(cpu_info[3])
-                   : "a"(info_type));
+                   : "a"(info_type), "c"(sub_type));
 }
 #endif
+static inline void __cpuid(int cpu_info[4], int info_type) {
+  __cpuidex(cpu_info, info_type, 0);
+}
+
+// Intrinsic for "xgetbv". The encoding is used directly since older
+// assemblers do not know the instruction.
+static inline uint64_t _xgetbv(unsigned int xcr) {
+  unsigned int eax, edx;
+  __asm__ volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
 #endif  // _MSC_VER
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
@@ -59,6 +70,22 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  // AVX registers are only usable if the OS saves them on context switches,
+  // which is signaled by OSXSAVE and the XMM and YMM bits of XCR0.
+  const bool avx_usable = (cpu_info[2] & 0x18000000) == 0x18000000 &&
+                          (_xgetbv(0) & 0x6) == 0x6;
+  if (feature == kFMA3) {
+    return avx_usable && 0 != (cpu_info[2] & 0x00001000);
+  }
+  if (feature == kAVX2) {
+    int max_info_type[4];
+    __cpuid(max_info_type, 0);
+    if (!avx_usable || max_info_type[0] < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info, 7, 0);
+    return 0 != (cpu_info[1] & 0x00000020);
+  }
   return 0;
 }
 #else
@@ -11,7 +11,9 @@
 #include "modules/video_coding/frame_buffer2.h"
 
 #include "modules/video_coding/jitter_estimator.h"
+#include "modules/video_coding/legacy_frame_buffer2.h"
 #include "modules/video_coding/timing.h"
+#include "rtc_base/checks.h"
 #include "system_wrappers/include/clock.h"
 
 namespace webrtc {
@@ -60,37 +62,78 @@ class FuzzyFrameObject : public video_coding::EncodedFrame {
   int64_t ReceivedTime() const override { return 0; }
   int64_t RenderTime() const override { return _renderTimeMs; }
 };
+
+// Wraps a FrameBuffer implementation together with its own timing state, so
+// that both implementations can be fed the same input.
+template <typename FrameBufferT>
+class FuzzedFrameBuffer {
+ public:
+  explicit FuzzedFrameBuffer(Clock* clock)
+      : jitter_estimator_(clock, 0, 0),
+        timing_(clock),
+        frame_buffer_(clock, &jitter_estimator_, &timing_, nullptr) {}
+
+  int64_t InsertFrame(const video_coding::EncodedFrame& input) {
+    std::unique_ptr<FuzzyFrameObject> frame(new FuzzyFrameObject());
+    frame->id = input.id;
+    frame->SetTimestamp(input.Timestamp());
+    frame->num_references = input.num_references;
+    for (size_t r = 0; r < frame->num_references; ++r)
+      frame->references[r] = input.references[r];
+    return frame_buffer_.InsertFrame(std::move(frame));
+  }
+
+  // Returns the id of the next frame, or a default constructed id if there
+  // is none.
+  video_coding::VideoLayerFrameId NextFrame(bool keyframe_required) {
+    // Since we are not trying to trigger race conditions it does not make
+    // sense to have a wait time > 0.
+    const int kWaitTimeMs = 0;
+
+    std::unique_ptr<video_coding::EncodedFrame> frame;
+    frame_buffer_.NextFrame(kWaitTimeMs, &frame, keyframe_required);
+    return frame ? frame->id : video_coding::VideoLayerFrameId();
+  }
+
+ private:
+  VCMJitterEstimator jitter_estimator_;
+  VCMTiming timing_;
+  FrameBufferT frame_buffer_;
+};
 }  // namespace
 
 void FuzzOneInput(const uint8_t* data, size_t size) {
   DataReader reader(data, size);
-  Clock* clock = Clock::GetRealTimeClock();
-  VCMJitterEstimator jitter_estimator(clock, 0, 0);
-  VCMTiming timing(clock);
-  video_coding::FrameBuffer frame_buffer(clock, &jitter_estimator, &timing,
-                                         nullptr);
+  // A simulated clock makes the outcome of both implementations depend on
+  // the input only. It is advanced between calls to NextFrame so that frames
+  // become due for decoding.
+  const int64_t kTimeStepMs = 10;
+  SimulatedClock clock(0);
+  // The same input is run through the current and the legacy implementation,
+  // which must insert and return the same frames.
+  FuzzedFrameBuffer<video_coding::FrameBuffer> frame_buffer(&clock);
+  FuzzedFrameBuffer<video_coding::LegacyFrameBuffer> legacy_frame_buffer(
+      &clock);
 
   while (reader.MoreToRead()) {
     if (reader.GetNum<uint8_t>() & 1) {
-      std::unique_ptr<FuzzyFrameObject> frame(new FuzzyFrameObject());
-      frame->id.picture_id = reader.GetNum<int64_t>();
-      frame->id.spatial_layer = reader.GetNum<uint8_t>();
-      frame->SetTimestamp(reader.GetNum<uint32_t>());
-      frame->num_references = reader.GetNum<uint8_t>() %
-                              video_coding::EncodedFrame::kMaxFrameReferences;
-
-      for (size_t r = 0; r < frame->num_references; ++r)
-        frame->references[r] = reader.GetNum<int64_t>();
-
-      frame_buffer.InsertFrame(std::move(frame));
+      FuzzyFrameObject frame;
+      frame.id.picture_id = reader.GetNum<int64_t>();
+      frame.id.spatial_layer = reader.GetNum<uint8_t>();
+      frame.SetTimestamp(reader.GetNum<uint32_t>());
+      frame.num_references = reader.GetNum<uint8_t>() %
+                             video_coding::EncodedFrame::kMaxFrameReferences;
+
+      for (size_t r = 0; r < frame.num_references; ++r)
+        frame.references[r] = reader.GetNum<int64_t>();
+
+      RTC_CHECK_EQ(frame_buffer.InsertFrame(frame),
+                   legacy_frame_buffer.InsertFrame(frame));
     } else {
-      // Since we are not trying to trigger race conditions it does not make
-      // sense to have a wait time > 0.
-      const int kWaitTimeMs = 0;
-
-      std::unique_ptr<video_coding::EncodedFrame> frame(new FuzzyFrameObject());
       bool keyframe_required = reader.GetNum<uint8_t>() % 2;
-      frame_buffer.NextFrame(kWaitTimeMs, &frame, keyframe_required);
+      RTC_CHECK(frame_buffer.NextFrame(keyframe_required) ==
+                legacy_frame_buffer.NextFrame(keyframe_required));
+      clock.AdvanceTimeMilliseconds(kTimeStepMs);
     }
   }
 }
@@ -10,9 +10,19 @@
 
 #include "modules/video_coding/rtp_frame_reference_finder.h"
 
+#include <array>
+#include <map>
+#include <set>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
+#include "modules/video_coding/codecs/vp9/include/vp9_globals.h"
 #include "modules/video_coding/frame_object.h"
+#include "modules/video_coding/legacy_rtp_frame_reference_finder.h"
 #include "modules/video_coding/packet_buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/numerics/sequence_number_util.h"
 #include "system_wrappers/include/clock.h"
 
 namespace webrtc {
@@ -82,6 +92,11 @@ class FuzzyPacketBuffer : public video_coding::PacketBuffer {
     VCMPacket* packet = &packets[seq_num];
     packet->codec = codec;
     packet->markerBit = true;
+    packet->is_last_packet_in_frame = true;
+    if (codec == kVideoCodecVP8)
+      packet->video_header.video_type_header.emplace<RTPVideoHeaderVP8>();
+    else if (codec == kVideoCodecVP9)
+      packet->video_header.video_type_header.emplace<RTPVideoHeaderVP9>();
     reader->CopyTo(packet, sizeof(packet));
     return packet;
   }
@@ -98,19 +113,252 @@ class FuzzyPacketBuffer : public video_coding::PacketBuffer {
   VideoCodecType codec;
   DataReader* const reader;
 };
-}  // namespace
 
-void FuzzOneInput(const uint8_t* data, size_t size) {
+// Packet buffer holding the packets of a well formed stream.
+class StreamPacketBuffer : public video_coding::PacketBuffer {
+ public:
+  StreamPacketBuffer() : PacketBuffer(nullptr, 2, 4, nullptr) {}
+
+  void AddPacket(const VCMPacket& packet) { packets[packet.seqNum] = packet; }
+
+  VCMPacket* GetPacket(uint16_t seq_num) override {
+    auto packet_it = packets.find(seq_num);
+    return packet_it != packets.end() ? &packet_it->second : nullptr;
+  }
+
+  bool GetBitstream(const video_coding::RtpFrameObject& frame,
+                    uint8_t* destination) override {
+    return true;
+  }
+
+  void ReturnFrame(video_coding::RtpFrameObject* frame) override {}
+
+ private:
+  std::map<uint16_t, VCMPacket> packets;
+};
+
+struct StreamFrame {
+  uint16_t first_seq_num;
+  uint16_t last_seq_num;
+  int index;
+  bool key_frame;
+};
+
+struct CompleteFrame {
+  int64_t picture_id;
+  std::vector<int64_t> references;
+};
+
+// Records the frames handed off, keyed by their index in the stream which is
+// passed as receive time.
+class RecordingCallback : public video_coding::OnCompleteFrameCallback {
+ public:
+  explicit RecordingCallback(bool check_references)
+      : check_references_(check_references) {}
+
+  void OnCompleteFrame(
+      std::unique_ptr<video_coding::EncodedFrame> frame) override {
+    for (size_t i = 0; check_references_ && i < frame->num_references; ++i)
+      RTC_CHECK(picture_ids_.count(frame->references[i]));
+    picture_ids_.insert(frame->id.picture_id);
+
+    CompleteFrame& complete_frame = frames[frame->ReceivedTime()];
+    complete_frame.picture_id = frame->id.picture_id;
+    complete_frame.references.assign(
+        frame->references, frame->references + frame->num_references);
+  }
+
+  std::map<int64_t, CompleteFrame> frames;
+
+ private:
+  const bool check_references_;
+  std::set<int64_t> picture_ids_;
+};
+
+// Arbitrary packets, only checks that the reference finder does not crash.
+void FuzzArbitraryPackets(const uint8_t* data, size_t size) {
   DataReader reader(data, size);
   rtc::scoped_refptr<FuzzyPacketBuffer> pb(new FuzzyPacketBuffer(&reader));
   NullCallback cb;
   video_coding::RtpFrameReferenceFinder reference_finder(&cb);
 
   while (reader.MoreToRead()) {
-    auto frame = absl::make_unique<video_coding::RtpFrameObject>(
-        pb, reader.GetNum<uint16_t>(), reader.GetNum<uint16_t>(), 0, 0, 0);
-    reference_finder.ManageFrame(std::move(frame));
+    uint16_t first_seq_num = reader.GetNum<uint16_t>();
+    uint16_t last_seq_num = reader.GetNum<uint16_t>();
+    reference_finder.ManageFrame(
+        absl::make_unique<video_coding::RtpFrameObject>(
+            pb, first_seq_num, last_seq_num, 0, 0, 0));
   }
 }
 
+// Builds a well formed generic, VP8 or VP9 stream out of the input and runs
+// it through the current and the legacy implementation. Generic frames may be
+// lost, reordered and followed by padding, and both implementations must hand
+// off the same frames with the same references. VP8 and VP9 frames are
+// delivered in order and compared the same way, unless the input enables loss.
+// With loss the legacy implementation is allowed to diverge: it retries
+// stashed frames newest first, so a VP8 frame may be resolved against an older
+// frame of its layer, and it keeps retrying frames that can never be completed,
+// which makes its tl0 unwrapping alias a base layer 256 frames back. The
+// current implementation must then only reference frames it has handed off.
+void FuzzStream(const uint8_t* data, size_t size) {
+  static const uint8_t kTemporalPattern[3][4] = {
+      {0, 0, 0, 0}, {0, 1, 0, 1}, {0, 2, 1, 2}};
+  static const TemporalStructureMode kTemporalStructureMode[3] = {
+      kTemporalStructureMode1, kTemporalStructureMode2,
+      kTemporalStructureMode3};
+
+  DataReader reader(data, size);
+  rtc::scoped_refptr<StreamPacketBuffer> pb(new StreamPacketBuffer());
+  RecordingCallback callback(/*check_references=*/true);
+  RecordingCallback legacy_callback(/*check_references=*/false);
+  video_coding::RtpFrameReferenceFinder reference_finder(&callback);
+  video_coding::LegacyRtpFrameReferenceFinder legacy_reference_finder(
+      &legacy_callback);
+
+  VideoCodecType codec;
+  switch (reader.GetNum<uint8_t>() % 3) {
+    case 0:
+      codec = kVideoCodecGeneric;
+      break;
+    case 1:
+      codec = kVideoCodecVP8;
+      break;
+    default:
+      codec = kVideoCodecVP9;
+      break;
+  }
+  const int structure = reader.GetNum<uint8_t>() % 3;
+  GofInfoVP9 gof;
+  gof.SetGofInfoVP9(kTemporalStructureMode[structure]);
+  uint16_t seq_num = reader.GetNum<uint16_t>();
+  const uint16_t first_picture_id =
+      reader.GetNum<uint16_t>() & kMaxTwoBytePictureId;
+  uint8_t tl0_pic_idx = reader.GetNum<uint8_t>();
+  // Whether a VP8 frame has been sent on the temporal layer since the last key
+  // frame. The first frame on each layer after a key frame is a layer sync.
+  std::array<bool, 3> layer_started = {};
+  const bool lossy =
+      (reader.GetNum<uint8_t>() & 0x1) || codec == kVideoCodecGeneric;
+
+  // Frames delayed by reordering, keyed by the index they are delivered at.
+  std::multimap<int, StreamFrame> delayed_frames;
+  for (int index = 0; reader.MoreToRead() || !delayed_frames.empty();
+       ++index) {
+    std::vector<StreamFrame> frames;
+    auto delayed = delayed_frames.equal_range(index);
+    for (auto it = delayed.first; it != delayed.second; ++it)
+      frames.push_back(it->second);
+    delayed_frames.erase(index);
+
+    absl::optional<uint16_t> padding_seq_num;
+    if (reader.MoreToRead()) {
+      const uint8_t flags = reader.GetNum<uint8_t>();
+      // Key frames start a new group of frames, which is at most four frames
+      // long, so the temporal structure stays in phase if one is lost.
+      const bool key_frame =
+          index % 4 == 0 && (index == 0 || flags >> 5 == 0x7);
+      const bool lost = lossy && (flags & 0x7) == 0;
+      const int delay =
+          codec == kVideoCodecGeneric && !lost ? (flags >> 3) & 0x3 : 0;
+      const int num_packets =
+          codec == kVideoCodecGeneric ? 1 + ((flags >> 5) & 0x1) : 1;
+
+      uint8_t temporal_idx =
+          codec == kVideoCodecVP9
+              ? gof.temporal_idx[index % gof.num_frames_in_gof]
+              : kTemporalPattern[structure][index % 4];
+      if (key_frame) {
+        temporal_idx = 0;
+        layer_started.fill(false);
+      }
+      if (index > 0 && temporal_idx == 0)
+        ++tl0_pic_idx;
+      const uint16_t picture_id =
+          (first_picture_id + index) & kMaxTwoBytePictureId;
+
+      for (int i = 0; i < num_packets; ++i) {
+        VCMPacket packet;
+        packet.seqNum = seq_num + i;
+        packet.codec = codec;
+        packet.frameType = key_frame ? kVideoFrameKey : kVideoFrameDelta;
+        packet.is_first_packet_in_frame = i == 0;
+        packet.is_last_packet_in_frame = i == num_packets - 1;
+        if (codec == kVideoCodecVP8) {
+          auto& vp8_header = packet.video_header.video_type_header
+                                 .emplace<RTPVideoHeaderVP8>();
+          vp8_header.InitRTPVideoHeaderVP8();
+          vp8_header.pictureId = picture_id;
+          vp8_header.temporalIdx = temporal_idx;
+          vp8_header.tl0PicIdx = tl0_pic_idx;
+          vp8_header.layerSync = temporal_idx > 0 &&
+                                 (!layer_started[temporal_idx] || flags & 0x80);
+        } else if (codec == kVideoCodecVP9) {
+          auto& vp9_header = packet.video_header.video_type_header
+                                 .emplace<RTPVideoHeaderVP9>();
+          vp9_header.InitRTPVideoHeaderVP9();
+          vp9_header.flexible_mode = false;
+          vp9_header.picture_id = picture_id;
+          vp9_header.temporal_idx = temporal_idx;
+          vp9_header.tl0_pic_idx = tl0_pic_idx;
+          vp9_header.spatial_idx = 0;
+          vp9_header.temporal_up_switch =
+              gof.temporal_up_switch[index % gof.num_frames_in_gof];
+          if (key_frame) {
+            vp9_header.ss_data_available = true;
+            vp9_header.gof = gof;
+          }
+        }
+        pb->AddPacket(packet);
+      }
+      layer_started[temporal_idx] = true;
+
+      const StreamFrame frame = {
+          seq_num, static_cast<uint16_t>(seq_num + num_packets - 1), index,
+          key_frame};
+      seq_num += num_packets;
+      if (codec == kVideoCodecGeneric && (flags >> 6) == 0x3)
+        padding_seq_num = seq_num++;
+      if (delay > 0)
+        delayed_frames.emplace(index + delay, frame);
+      else if (!lost)
+        frames.push_back(frame);
+    }
+
+    for (const StreamFrame& frame : frames) {
+      reference_finder.ManageFrame(
+          absl::make_unique<video_coding::RtpFrameObject>(
+              pb, frame.first_seq_num, frame.last_seq_num, 0, 0, frame.index));
+      legacy_reference_finder.ManageFrame(
+          absl::make_unique<video_coding::RtpFrameObject>(
+              pb, frame.first_seq_num, frame.last_seq_num, 0, 0, frame.index));
+      if (frame.key_frame) {
+        reference_finder.ClearTo(frame.first_seq_num);
+        legacy_reference_finder.ClearTo(frame.first_seq_num);
+      }
+    }
+    if (padding_seq_num) {
+      reference_finder.PaddingReceived(*padding_seq_num);
+      legacy_reference_finder.PaddingReceived(*padding_seq_num);
+    }
+  }
+
+  if (lossy && codec != kVideoCodecGeneric)
+    return;
+
+  RTC_CHECK_EQ(callback.frames.size(), legacy_callback.frames.size());
+  for (const auto& legacy_frame : legacy_callback.frames) {
+    const auto frame = callback.frames.find(legacy_frame.first);
+    RTC_CHECK(frame != callback.frames.end());
+    RTC_CHECK_EQ(frame->second.picture_id, legacy_frame.second.picture_id);
+    RTC_CHECK(frame->second.references == legacy_frame.second.references);
+  }
+}
+}  // namespace
+
+void FuzzOneInput(const uint8_t* data, size_t size) {
+  FuzzArbitraryPackets(data, size);
+  FuzzStream(data, size);
+}
+
 }  // namespace webrtc
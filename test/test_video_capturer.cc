@@ -10,6 +10,8 @@
 
 #include "test/test_video_capturer.h"
 
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
 #include "rtc_base/constructormagic.h"
 
 namespace webrtc {
@@ -36,9 +38,19 @@ absl::optional<VideoFrame> TestVideoCapturer::AdaptFrame(
   if (out_height != frame.height() || out_width != frame.width()) {
     // Video adapter has requested a down-scale. Allocate a new buffer and
     // return scaled version.
-    rtc::scoped_refptr<I420Buffer> scaled_buffer =
-        I420Buffer::Create(out_width, out_height);
-    scaled_buffer->ScaleFrom(*frame.video_frame_buffer()->ToI420());
+    // NV12 is scaled as NV12 so that it reaches the encoder unconverted.
+    rtc::scoped_refptr<VideoFrameBuffer> scaled_buffer;
+    if (frame.video_frame_buffer()->type() == VideoFrameBuffer::Type::kNV12) {
+      rtc::scoped_refptr<NV12Buffer> nv12_buffer =
+          NV12Buffer::Create(out_width, out_height);
+      nv12_buffer->ScaleFrom(*frame.video_frame_buffer()->GetNV12());
+      scaled_buffer = nv12_buffer;
+    } else {
+      rtc::scoped_refptr<I420Buffer> i420_buffer =
+          I420Buffer::Create(out_width, out_height);
+      i420_buffer->ScaleFrom(*frame.video_frame_buffer()->ToI420());
+      scaled_buffer = i420_buffer;
+    }
     out_frame.emplace(
         VideoFrame(scaled_buffer, kVideoRotation_0, frame.timestamp_us()));
   } else {
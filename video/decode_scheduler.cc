@@ -0,0 +1,208 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/decode_scheduler.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/trace_event.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+namespace {
+// Upper bound of the time a thread sleeps, so that a bogus delay returned by
+// a stream can not put all threads to sleep for good.
+constexpr int64_t kMaxWaitMs = 3000;
+
+rtc::GlobalLockPod g_shared_scheduler_lock;
+DecodeScheduler* g_shared_scheduler = nullptr;
+int g_shared_scheduler_usage_count = 0;
+}  // namespace
+
+DecodeScheduler::DecodeScheduler(int num_threads)
+    : wake_up_event_(false, false) {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < std::max(num_threads, 1); ++i) {
+    char name[32];
+    snprintf(name, sizeof(name), "DecodingThread%d", i);
+    threads_.emplace_back(new rtc::PlatformThread(
+        &DecodeThreadFunction, this, name, rtc::kHighestPriority));
+    threads_.back()->Start();
+  }
+}
+
+DecodeScheduler::~DecodeScheduler() {
+  {
+    rtc::CritScope lock(&crit_);
+    RTC_DCHECK(streams_.empty());
+    stopped_ = true;
+  }
+  wake_up_event_.Set();
+  for (auto& thread : threads_)
+    thread->Stop();
+}
+
+DecodeScheduler* DecodeScheduler::AcquireShared() {
+  rtc::GlobalLockScope lock(&g_shared_scheduler_lock);
+  if (g_shared_scheduler_usage_count++ == 0) {
+    RTC_DCHECK(!g_shared_scheduler);
+    g_shared_scheduler = new DecodeScheduler(CpuInfo::DetectNumberOfCores());
+  }
+  return g_shared_scheduler;
+}
+
+void DecodeScheduler::ReleaseShared() {
+  DecodeScheduler* scheduler = nullptr;
+  {
+    rtc::GlobalLockScope lock(&g_shared_scheduler_lock);
+    RTC_DCHECK_GT(g_shared_scheduler_usage_count, 0);
+    if (--g_shared_scheduler_usage_count == 0) {
+      scheduler = g_shared_scheduler;
+      g_shared_scheduler = nullptr;
+    }
+  }
+  // Joining the threads is done outside of the lock, so that other users can
+  // come and go in the meantime.
+  delete scheduler;
+}
+
+void DecodeScheduler::AddStream(Stream* stream) {
+  {
+    rtc::CritScope lock(&crit_);
+    RTC_DCHECK(!FindStream(stream));
+    streams_.emplace_back(new StreamState(stream));
+    streams_.back()->next_run_ms = rtc::TimeMillis();
+  }
+  wake_up_event_.Set();
+}
+
+void DecodeScheduler::RemoveStream(Stream* stream) {
+  StreamState* state;
+  {
+    rtc::CritScope lock(&crit_);
+    state = FindStream(stream);
+    RTC_DCHECK(state);
+    if (!state)
+      return;
+    // Keep the stream from being picked up again while waiting for it.
+    state->removed = true;
+    if (!state->running) {
+      EraseStream(state);
+      return;
+    }
+  }
+  // The state is only erased here, so it is safe to wait on it unlocked.
+  state->done_event.Wait(rtc::Event::kForever);
+  rtc::CritScope lock(&crit_);
+  EraseStream(state);
+}
+
+void DecodeScheduler::Wake(Stream* stream) {
+  {
+    rtc::CritScope lock(&crit_);
+    StreamState* state = FindStream(stream);
+    if (!state || state->removed)
+      return;
+    if (state->running) {
+      state->woken = true;
+      return;
+    }
+    state->next_run_ms = std::min(state->next_run_ms, rtc::TimeMillis());
+  }
+  wake_up_event_.Set();
+}
+
+void DecodeScheduler::DecodeThreadFunction(void* ptr) {
+  static_cast<DecodeScheduler*>(ptr)->Run();
+}
+
+void DecodeScheduler::Run() {
+  while (true) {
+    StreamState* state = nullptr;
+    int64_t wait_ms = kMaxWaitMs;
+    {
+      rtc::CritScope lock(&crit_);
+      if (stopped_)
+        break;
+
+      // Pick the stream that has been due for the longest time.
+      const int64_t now_ms = rtc::TimeMillis();
+      StreamState* next = nullptr;
+      int num_due = 0;
+      for (const auto& candidate : streams_) {
+        if (candidate->running || candidate->removed)
+          continue;
+        if (candidate->next_run_ms <= now_ms)
+          ++num_due;
+        if (!next || candidate->next_run_ms < next->next_run_ms)
+          next = candidate.get();
+      }
+
+      if (next && next->next_run_ms <= now_ms) {
+        state = next;
+        state->running = true;
+        state->woken = false;
+        // Let another thread take care of the other streams that are due.
+        if (num_due > 1)
+          wake_up_event_.Set();
+      } else if (next) {
+        wait_ms = std::min(wait_ms, next->next_run_ms - now_ms);
+      }
+    }
+
+    if (!state) {
+      wake_up_event_.Wait(static_cast<int>(wait_ms));
+      continue;
+    }
+
+    int64_t delay_ms;
+    {
+      TRACE_EVENT0("webrtc", "DecodeScheduler::DecodeNextFrame");
+      delay_ms = state->stream->DecodeNextFrame();
+    }
+    {
+      rtc::CritScope lock(&crit_);
+      state->running = false;
+      state->next_run_ms = rtc::TimeMillis();
+      if (!state->woken)
+        state->next_run_ms += std::max<int64_t>(delay_ms, 0);
+      // Signaled under the lock, as the state is erased as soon as the
+      // remover can take the lock.
+      if (state->removed)
+        state->done_event.Set();
+    }
+    // This thread may pick up another stream that takes long to decode, so
+    // let a waiting thread know when this stream is due again.
+    wake_up_event_.Set();
+  }
+  // Pass the stop on to the other threads.
+  wake_up_event_.Set();
+}
+
+DecodeScheduler::StreamState* DecodeScheduler::FindStream(Stream* stream) {
+  for (const auto& state : streams_) {
+    if (state->stream == stream)
+      return state.get();
+  }
+  return nullptr;
+}
+
+void DecodeScheduler::EraseStream(StreamState* state) {
+  streams_.erase(std::find_if(streams_.begin(), streams_.end(),
+                              [state](const std::unique_ptr<StreamState>& s) {
+                                return s.get() == state;
+                              }));
+}
+
+}  // namespace webrtc
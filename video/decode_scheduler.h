@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_DECODE_SCHEDULER_H_
+#define VIDEO_DECODE_SCHEDULER_H_
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Runs the decoding of many video receive streams on a shared pool of
+// threads, instead of on a thread per stream. A stream is never run on more
+// than one thread at a time, so its frames are still decoded in order, but a
+// stream that is slow to decode does not hold up the other streams as long
+// as there are idle threads.
+class DecodeScheduler {
+ public:
+  class Stream {
+   public:
+    // Decodes the next frame of the stream if one is due. Returns the time in
+    // ms until the stream should run again, unless it is woken up earlier.
+    virtual int64_t DecodeNextFrame() = 0;
+
+   protected:
+    virtual ~Stream() {}
+  };
+
+  // Creates a scheduler that decodes on |num_threads| threads, typically one
+  // per core.
+  explicit DecodeScheduler(int num_threads);
+  ~DecodeScheduler();
+
+  // Returns the scheduler that is shared by all Calls in the process, and
+  // creates it with a thread per core on first use. Each call must be matched
+  // by a call to ReleaseShared(). The scheduler is destroyed when the last
+  // user has released it.
+  static DecodeScheduler* AcquireShared();
+  static void ReleaseShared();
+
+  // Starts running |stream|. The first run is as soon as possible.
+  void AddStream(Stream* stream);
+
+  // Stops running |stream|. If |stream| is running on another thread, blocks
+  // until it has returned. Streams may be added and removed on any thread.
+  void RemoveStream(Stream* stream);
+
+  // Runs |stream| as soon as possible, e.g. because a new frame may be
+  // decodable. If |stream| is running it is run again once it returns. Has no
+  // effect if |stream| has not been added.
+  void Wake(Stream* stream);
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+ private:
+  struct StreamState {
+    explicit StreamState(Stream* stream) : stream(stream) {}
+
+    Stream* const stream;
+    int64_t next_run_ms = 0;
+    // Set while DecodeNextFrame is called for the stream.
+    bool running = false;
+    // Set if the stream is woken up while it is running.
+    bool woken = false;
+    // Set once RemoveStream has been called for the stream.
+    bool removed = false;
+    // Signaled when the stream has finished running after being removed.
+    rtc::Event done_event{false, false};
+  };
+
+  static void DecodeThreadFunction(void* ptr);
+  void Run();
+
+  StreamState* FindStream(Stream* stream) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void EraseStream(StreamState* state) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  rtc::CriticalSection crit_;
+  // Owned by pointer so that a thread can keep using the state of the stream
+  // it runs while other streams are added and removed.
+  std::vector<std::unique_ptr<StreamState>> streams_ RTC_GUARDED_BY(crit_);
+  bool stopped_ RTC_GUARDED_BY(crit_) = false;
+
+  // Wakes up a thread waiting for a stream to become due.
+  rtc::Event wake_up_event_;
+
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(DecodeScheduler);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_DECODE_SCHEDULER_H_
@@ -0,0 +1,215 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/video/video_frame.h"
+#include "api/video_codecs/video_decoder.h"
+#include "api/video_codecs/video_encoder.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "modules/video_coding/codecs/vp8/include/vp8.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/event.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/cpu_info.h"
+#include "system_wrappers/include/field_trial.h"
+#include "test/frame_generator.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+#include "test/video_codec_settings.h"
+#include "video/decode_scheduler.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+constexpr int kFramerate = 30;
+constexpr int kBitrateKbps = 4000;
+constexpr int kNumStreams = 8;
+constexpr int kNumFrames = 90;
+constexpr int kQuickNumFrames = 3;
+constexpr int kTimeoutMs = 10 * 60 * 1000;
+
+struct EncodedFrameData {
+  std::vector<uint8_t> data;
+  FrameType frame_type;
+  uint32_t timestamp;
+};
+
+class FrameCollector : public EncodedImageCallback {
+ public:
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info,
+                        const RTPFragmentationHeader* fragmentation) override {
+    EncodedFrameData frame;
+    frame.data.assign(encoded_image._buffer,
+                      encoded_image._buffer + encoded_image._length);
+    frame.frame_type = encoded_image._frameType;
+    frame.timestamp = encoded_image.Timestamp();
+    frames_.push_back(std::move(frame));
+    return Result(Result::OK);
+  }
+
+  std::vector<EncodedFrameData> frames_;
+};
+
+VideoCodec CodecSettings() {
+  VideoCodec codec;
+  test::CodecSettings(kVideoCodecVP8, &codec);
+  codec.width = kWidth;
+  codec.height = kHeight;
+  codec.maxFramerate = kFramerate;
+  codec.startBitrate = kBitrateKbps;
+  codec.maxBitrate = kBitrateKbps;
+  return codec;
+}
+
+// Encodes a 1080p clip once, for every stream to decode.
+std::vector<EncodedFrameData> EncodeClip(int num_frames) {
+  VideoCodec codec = CodecSettings();
+  std::unique_ptr<VideoEncoder> encoder = VP8Encoder::Create();
+  FrameCollector collector;
+  encoder->RegisterEncodeCompleteCallback(&collector);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder->InitEncode(&codec, 1 /* number of cores */,
+                                1200 /* max payload size */));
+
+  std::unique_ptr<test::FrameGenerator> frame_generator =
+      test::FrameGenerator::CreateSquareGenerator(
+          kWidth, kHeight, test::FrameGenerator::OutputType::I420,
+          absl::nullopt);
+  for (int i = 0; i < num_frames; ++i) {
+    VideoFrame* frame = frame_generator->NextFrame();
+    frame->set_timestamp(static_cast<uint32_t>((i + 1) * 90000 / kFramerate));
+    std::vector<FrameType> frame_types(
+        1, i == 0 ? kVideoFrameKey : kVideoFrameDelta);
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              encoder->Encode(*frame, nullptr, &frame_types));
+  }
+  encoder->Release();
+  EXPECT_EQ(static_cast<size_t>(num_frames), collector.frames_.size());
+  return std::move(collector.frames_);
+}
+
+// Decodes the clip as fast as the scheduler runs it.
+class DecodingStream : public DecodeScheduler::Stream,
+                       public DecodedImageCallback {
+ public:
+  DecodingStream(const std::vector<EncodedFrameData>* clip,
+                 int decoder_cores,
+                 std::atomic<int>* streams_left,
+                 rtc::Event* done_event)
+      : clip_(clip),
+        streams_left_(streams_left),
+        done_event_(done_event),
+        decoder_(VP8Decoder::Create()) {
+    VideoCodec codec = CodecSettings();
+    decoder_->RegisterDecodeCompleteCallback(this);
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              decoder_->InitDecode(&codec, decoder_cores));
+  }
+  ~DecodingStream() override { decoder_->Release(); }
+
+  int64_t DecodeNextFrame() override {
+    if (next_frame_ == clip_->size())
+      return kTimeoutMs;
+
+    const EncodedFrameData& frame = (*clip_)[next_frame_++];
+    EncodedImage encoded_image(const_cast<uint8_t*>(frame.data.data()),
+                               frame.data.size(), frame.data.size());
+    encoded_image._frameType = frame.frame_type;
+    encoded_image._completeFrame = true;
+    encoded_image._encodedWidth = kWidth;
+    encoded_image._encodedHeight = kHeight;
+    encoded_image.SetTimestamp(frame.timestamp);
+    EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+              decoder_->Decode(encoded_image, false, nullptr, 0));
+
+    if (next_frame_ == clip_->size() && --*streams_left_ == 0)
+      done_event_->Set();
+    return 0;
+  }
+
+  int32_t Decoded(VideoFrame& decoded_image) override {
+    ++num_decoded_frames_;
+    return 0;
+  }
+
+  int num_decoded_frames() const { return num_decoded_frames_; }
+
+ private:
+  const std::vector<EncodedFrameData>* const clip_;
+  std::atomic<int>* const streams_left_;
+  rtc::Event* const done_event_;
+  const std::unique_ptr<VideoDecoder> decoder_;
+  size_t next_frame_ = 0;
+  int num_decoded_frames_ = 0;
+};
+
+// Decodes the clip on |kNumStreams| streams at the same time, using
+// |num_threads| scheduler threads and giving every decoder |decoder_cores|
+// cores. Returns the number of frames decoded per second by all streams.
+double DecodeStreams(const std::vector<EncodedFrameData>& clip,
+                     int num_threads,
+                     int decoder_cores) {
+  std::atomic<int> streams_left(kNumStreams);
+  rtc::Event done_event(false, false);
+  std::vector<std::unique_ptr<DecodingStream>> streams;
+  for (int i = 0; i < kNumStreams; ++i) {
+    streams.emplace_back(
+        new DecodingStream(&clip, decoder_cores, &streams_left, &done_event));
+  }
+
+  DecodeScheduler scheduler(num_threads);
+  int64_t start_us = rtc::TimeMicros();
+  for (auto& stream : streams)
+    scheduler.AddStream(stream.get());
+  EXPECT_TRUE(done_event.Wait(kTimeoutMs));
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  for (auto& stream : streams) {
+    scheduler.RemoveStream(stream.get());
+    EXPECT_EQ(static_cast<int>(clip.size()), stream->num_decoded_frames());
+  }
+  return kNumStreams * clip.size() * 1e6 / std::max<int64_t>(elapsed_us, 1);
+}
+
+void RunAndReport(int num_threads,
+                  int decoder_cores,
+                  const std::string& trace) {
+  const std::vector<EncodedFrameData> clip =
+      EncodeClip(field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                     ? kQuickNumFrames
+                     : kNumFrames);
+  test::PrintResult("decode_1080p_streams", "", trace,
+                    DecodeStreams(clip, num_threads, decoder_cores), "fps",
+                    true);
+}
+
+}  // namespace
+
+TEST(DecodeSchedulerPerformanceTest, ThreadPerStream) {
+  RunAndReport(kNumStreams, 1, "8_streams_thread_per_stream");
+}
+
+TEST(DecodeSchedulerPerformanceTest, ThreadPerCore) {
+  RunAndReport(CpuInfo::DetectNumberOfCores(), 1, "8_streams_thread_per_core");
+}
+
+TEST(DecodeSchedulerPerformanceTest, ThreadPerCoreWithThreadedDecoders) {
+  RunAndReport(CpuInfo::DetectNumberOfCores(), CpuInfo::DetectNumberOfCores(),
+               "8_streams_thread_per_core_threaded_decoders");
+}
+
+}  // namespace webrtc
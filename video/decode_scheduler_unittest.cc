@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/decode_scheduler.h"
+
+#include <atomic>
+
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kTimeoutMs = 5000;
+
+class FakeStream : public DecodeScheduler::Stream {
+ public:
+  explicit FakeStream(int64_t delay_ms) : delay_ms_(delay_ms) {}
+
+  int64_t DecodeNextFrame() override {
+    if (++concurrent_runs_ > 1)
+      ran_concurrently_ = true;
+    if (decode_time_ms_ > 0)
+      SleepMs(decode_time_ms_);
+    ++num_runs_;
+    --concurrent_runs_;
+    ran_event_.Set();
+    return delay_ms_;
+  }
+
+  const int64_t delay_ms_;
+  int decode_time_ms_ = 0;
+  std::atomic<int> num_runs_{0};
+  std::atomic<int> concurrent_runs_{0};
+  std::atomic<bool> ran_concurrently_{false};
+  rtc::Event ran_event_{false, false};
+};
+
+// Waits in DecodeNextFrame until another stream is running at the same time.
+class RendezvousStream : public DecodeScheduler::Stream {
+ public:
+  explicit RendezvousStream(std::atomic<int>* num_running)
+      : num_running_(num_running) {}
+
+  int64_t DecodeNextFrame() override {
+    ++*num_running_;
+    for (int i = 0; i < kTimeoutMs && *num_running_ < 2; ++i)
+      SleepMs(1);
+    met_other_stream_ = *num_running_ >= 2;
+    done_event_.Set();
+    return 100000;
+  }
+
+  std::atomic<int>* const num_running_;
+  std::atomic<bool> met_other_stream_{false};
+  rtc::Event done_event_{false, false};
+};
+
+}  // namespace
+
+TEST(DecodeSchedulerTest, RunsAddedStream) {
+  DecodeScheduler scheduler(2);
+  EXPECT_EQ(2, scheduler.num_threads());
+  FakeStream stream(100000);
+  scheduler.AddStream(&stream);
+  EXPECT_TRUE(stream.ran_event_.Wait(kTimeoutMs));
+  scheduler.RemoveStream(&stream);
+  EXPECT_EQ(1, stream.num_runs_);
+}
+
+TEST(DecodeSchedulerTest, RunsStreamAgainAfterReturnedDelay) {
+  DecodeScheduler scheduler(1);
+  FakeStream stream(10);
+  scheduler.AddStream(&stream);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_TRUE(stream.ran_event_.Wait(kTimeoutMs));
+  scheduler.RemoveStream(&stream);
+}
+
+TEST(DecodeSchedulerTest, WakeRunsStreamBeforeReturnedDelay) {
+  DecodeScheduler scheduler(1);
+  FakeStream stream(100000);
+  scheduler.AddStream(&stream);
+  ASSERT_TRUE(stream.ran_event_.Wait(kTimeoutMs));
+  scheduler.Wake(&stream);
+  EXPECT_TRUE(stream.ran_event_.Wait(kTimeoutMs));
+  scheduler.RemoveStream(&stream);
+  EXPECT_EQ(2, stream.num_runs_);
+}
+
+TEST(DecodeSchedulerTest, WakeIgnoresUnknownStream) {
+  DecodeScheduler scheduler(1);
+  FakeStream stream(0);
+  scheduler.Wake(&stream);
+  EXPECT_FALSE(stream.ran_event_.Wait(10));
+}
+
+TEST(DecodeSchedulerTest, NeverRunsStreamConcurrently) {
+  DecodeScheduler scheduler(4);
+  FakeStream stream(0);
+  stream.decode_time_ms_ = 1;
+  scheduler.AddStream(&stream);
+  for (int i = 0; i < 50; ++i) {
+    scheduler.Wake(&stream);
+    SleepMs(1);
+  }
+  scheduler.RemoveStream(&stream);
+  EXPECT_GT(stream.num_runs_, 0);
+  EXPECT_FALSE(stream.ran_concurrently_);
+}
+
+TEST(DecodeSchedulerTest, RunsStreamsInParallel) {
+  DecodeScheduler scheduler(2);
+  std::atomic<int> num_running{0};
+  RendezvousStream stream1(&num_running);
+  RendezvousStream stream2(&num_running);
+  scheduler.AddStream(&stream1);
+  scheduler.AddStream(&stream2);
+  EXPECT_TRUE(stream1.done_event_.Wait(kTimeoutMs));
+  EXPECT_TRUE(stream2.done_event_.Wait(kTimeoutMs));
+  scheduler.RemoveStream(&stream1);
+  scheduler.RemoveStream(&stream2);
+  EXPECT_TRUE(stream1.met_other_stream_);
+  EXPECT_TRUE(stream2.met_other_stream_);
+}
+
+TEST(DecodeSchedulerTest, RemoveStreamWaitsForRunningStream) {
+  DecodeScheduler scheduler(1);
+  FakeStream stream(0);
+  stream.decode_time_ms_ = 20;
+  scheduler.AddStream(&stream);
+  while (stream.concurrent_runs_ == 0)
+    SleepMs(1);
+  scheduler.RemoveStream(&stream);
+  EXPECT_EQ(0, stream.concurrent_runs_);
+  const int num_runs = stream.num_runs_;
+  SleepMs(50);
+  EXPECT_EQ(num_runs, stream.num_runs_);
+}
+
+TEST(DecodeSchedulerTest, RemovesRunningStreamsFromSeveralThreads) {
+  DecodeScheduler scheduler(2);
+  FakeStream stream1(0);
+  FakeStream stream2(0);
+  stream1.decode_time_ms_ = 20;
+  stream2.decode_time_ms_ = 20;
+  scheduler.AddStream(&stream1);
+  scheduler.AddStream(&stream2);
+  while (stream1.concurrent_runs_ == 0 || stream2.concurrent_runs_ == 0)
+    SleepMs(1);
+
+  struct Remover {
+    static void Run(void* obj) {
+      Remover* remover = static_cast<Remover*>(obj);
+      remover->scheduler->RemoveStream(remover->stream);
+    }
+    DecodeScheduler* scheduler;
+    FakeStream* stream;
+  };
+  Remover remover{&scheduler, &stream2};
+  rtc::PlatformThread thread(&Remover::Run, &remover, "Remover");
+  thread.Start();
+  scheduler.RemoveStream(&stream1);
+  thread.Stop();
+
+  const int num_runs1 = stream1.num_runs_;
+  const int num_runs2 = stream2.num_runs_;
+  SleepMs(50);
+  EXPECT_EQ(num_runs1, stream1.num_runs_);
+  EXPECT_EQ(num_runs2, stream2.num_runs_);
+}
+
+TEST(DecodeSchedulerTest, SharedSchedulerLivesUntilLastRelease) {
+  DecodeScheduler* scheduler = DecodeScheduler::AcquireShared();
+  EXPECT_EQ(scheduler, DecodeScheduler::AcquireShared());
+  EXPECT_GT(scheduler->num_threads(), 0);
+  DecodeScheduler::ReleaseShared();
+
+  FakeStream stream(100000);
+  scheduler->AddStream(&stream);
+  EXPECT_TRUE(stream.ran_event_.Wait(kTimeoutMs));
+  scheduler->RemoveStream(&stream);
+  DecodeScheduler::ReleaseShared();
+}
+
+}  // namespace webrtc
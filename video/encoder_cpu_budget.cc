@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/encoder_cpu_budget.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+
+const int64_t EncoderCpuBudget::kPixelsPerSecondPerCore = 1280 * 720 * 30;
+
+EncoderCpuBudget* EncoderCpuBudget::Global() {
+  static EncoderCpuBudget* const budget =
+      new EncoderCpuBudget(CpuInfo::DetectNumberOfCores());
+  return budget;
+}
+
+EncoderCpuBudget::EncoderCpuBudget(int num_cores)
+    : num_cores_(std::max(num_cores, 1)) {
+  RTC_DCHECK_GT(num_cores, 0);
+}
+
+EncoderCpuBudget::~EncoderCpuBudget() {
+  RTC_DCHECK(clients_.empty());
+}
+
+EncoderCpuBudget::Allocation EncoderCpuBudget::SetDemand(
+    Client* client,
+    int64_t pixels_per_second) {
+  RTC_DCHECK(client);
+  RTC_DCHECK_GE(pixels_per_second, 0);
+  rtc::CritScope lock(&crit_);
+  auto it = std::find_if(
+      clients_.begin(), clients_.end(),
+      [client](const ClientState& state) { return state.client == client; });
+  if (it == clients_.end()) {
+    clients_.push_back({client, pixels_per_second, Allocation()});
+    it = clients_.end() - 1;
+  } else {
+    it->pixels_per_second = pixels_per_second;
+  }
+  Rebalance(client);
+  return it->allocation;
+}
+
+void EncoderCpuBudget::RemoveClient(Client* client) {
+  rtc::CritScope lock(&crit_);
+  auto it = std::find_if(
+      clients_.begin(), clients_.end(),
+      [client](const ClientState& state) { return state.client == client; });
+  if (it == clients_.end())
+    return;
+  clients_.erase(it);
+  Rebalance(nullptr);
+}
+
+void EncoderCpuBudget::Rebalance(Client* caller) {
+  if (clients_.empty())
+    return;
+
+  // Clients that do not encode anything yet still count a little, so that
+  // the cores are shared evenly if no client has a demand.
+  int64_t total_weight = 0;
+  int64_t total_pixels_per_second = 0;
+  for (const ClientState& state : clients_) {
+    total_weight += std::max<int64_t>(state.pixels_per_second, 1);
+    total_pixels_per_second += state.pixels_per_second;
+  }
+  const bool reduced_complexity =
+      total_pixels_per_second > num_cores_ * kPixelsPerSecondPerCore;
+
+  std::vector<double> shares(clients_.size());
+  std::vector<int> cores(clients_.size());
+  int assigned_cores = 0;
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    shares[i] = static_cast<double>(num_cores_) *
+                std::max<int64_t>(clients_[i].pixels_per_second, 1) /
+                total_weight;
+    cores[i] = std::max(1, static_cast<int>(shares[i]));
+    assigned_cores += cores[i];
+  }
+  // Hand out the cores lost to rounding down, to the clients that lost the
+  // most.
+  while (assigned_cores < num_cores_) {
+    size_t best = 0;
+    for (size_t i = 1; i < clients_.size(); ++i) {
+      if (shares[i] - cores[i] > shares[best] - cores[best])
+        best = i;
+    }
+    ++cores[best];
+    ++assigned_cores;
+  }
+
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    Allocation allocation;
+    allocation.cores = cores[i];
+    allocation.reduced_complexity = reduced_complexity;
+    if (allocation == clients_[i].allocation)
+      continue;
+    clients_[i].allocation = allocation;
+    if (clients_[i].client != caller)
+      clients_[i].client->OnCpuBudgetChanged(allocation);
+  }
+
+  if (assigned_cores > num_cores_) {
+    RTC_LOG(LS_INFO) << clients_.size() << " encoders share " << num_cores_
+                     << " cores, every encoder keeps one core.";
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_ENCODER_CPU_BUDGET_H_
+#define VIDEO_ENCODER_CPU_BUDGET_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Shares the cores of the machine between the video encoders of a process,
+// so that many encoders together do not start more threads than there are
+// cores. Every encoder gets a share of the cores in proportion to the number
+// of pixels per second it encodes, and at least one core. If the encoders
+// together encode more pixels than the cores can take at the default encoder
+// speed, they are also told to reduce their complexity. The shares are
+// re-balanced whenever an encoder starts, stops or changes its demand.
+class EncoderCpuBudget {
+ public:
+  struct Allocation {
+    bool operator==(const Allocation& other) const {
+      return cores == other.cores &&
+             reduced_complexity == other.reduced_complexity;
+    }
+    bool operator!=(const Allocation& other) const { return !(*this == other); }
+
+    // The number of cores to pass to VideoEncoder::InitEncode.
+    int cores = 1;
+    // Set if the encoder should use a faster, less complex, speed preset.
+    bool reduced_complexity = false;
+  };
+
+  class Client {
+   public:
+    // Called when the allocation of the client has changed because another
+    // client was added, removed or changed its demand. Called on the thread of
+    // that other client, with the budget locked, so must not call back into
+    // the budget.
+    virtual void OnCpuBudgetChanged(const Allocation& allocation) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  // The number of pixels per second one core is assumed to encode at the
+  // default encoder speed, roughly 720p at 30 fps.
+  static const int64_t kPixelsPerSecondPerCore;
+
+  // Returns the budget shared by all encoders of the process, with all cores
+  // of the machine.
+  static EncoderCpuBudget* Global();
+
+  explicit EncoderCpuBudget(int num_cores);
+  ~EncoderCpuBudget();
+
+  // Adds |client| if it is not known yet and sets the number of pixels per
+  // second it encodes. Returns the new allocation of |client|. Other clients
+  // whose allocation changes are notified.
+  Allocation SetDemand(Client* client, int64_t pixels_per_second);
+
+  // Removes |client| and notifies the other clients whose allocation changes.
+  // After this returns |client| is not notified again. Has no effect if
+  // |client| is not known.
+  void RemoveClient(Client* client);
+
+  int num_cores() const { return num_cores_; }
+
+ private:
+  struct ClientState {
+    Client* client;
+    int64_t pixels_per_second;
+    Allocation allocation;
+  };
+
+  // Re-computes the allocations of all clients and notifies the clients,
+  // other than |caller|, whose allocation changed.
+  void Rebalance(Client* caller) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  const int num_cores_;
+  rtc::CriticalSection crit_;
+  std::vector<ClientState> clients_ RTC_GUARDED_BY(crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(EncoderCpuBudget);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_ENCODER_CPU_BUDGET_H_
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/encoder_cpu_budget.h"
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int64_t k1080p30 = 1920 * 1080 * 30;
+constexpr int64_t k360p30 = 640 * 360 * 30;
+
+class FakeClient : public EncoderCpuBudget::Client {
+ public:
+  void OnCpuBudgetChanged(
+      const EncoderCpuBudget::Allocation& allocation) override {
+    allocation_ = allocation;
+    ++num_changes_;
+  }
+
+  EncoderCpuBudget::Allocation allocation_;
+  int num_changes_ = 0;
+};
+
+}  // namespace
+
+TEST(EncoderCpuBudgetTest, SingleClientGetsAllCores) {
+  EncoderCpuBudget budget(8);
+  FakeClient client;
+  EncoderCpuBudget::Allocation allocation = budget.SetDemand(&client, k360p30);
+  EXPECT_EQ(8, allocation.cores);
+  EXPECT_FALSE(allocation.reduced_complexity);
+  EXPECT_EQ(0, client.num_changes_);
+  budget.RemoveClient(&client);
+}
+
+TEST(EncoderCpuBudgetTest, SharesCoresByPixelRate) {
+  EncoderCpuBudget budget(8);
+  FakeClient client1;
+  FakeClient client2;
+  budget.SetDemand(&client1, k1080p30);
+  EncoderCpuBudget::Allocation allocation = budget.SetDemand(&client2, k360p30);
+  // 1080p has nine times the pixels of 360p.
+  EXPECT_EQ(1, allocation.cores);
+  EXPECT_EQ(7, client1.allocation_.cores);
+  EXPECT_EQ(1, client1.num_changes_);
+  budget.RemoveClient(&client1);
+  budget.RemoveClient(&client2);
+}
+
+TEST(EncoderCpuBudgetTest, HandsOutCoresLostToRounding) {
+  EncoderCpuBudget budget(4);
+  FakeClient client1;
+  FakeClient client2;
+  FakeClient client3;
+  budget.SetDemand(&client1, k360p30);
+  budget.SetDemand(&client2, k360p30);
+  EncoderCpuBudget::Allocation allocation = budget.SetDemand(&client3, k360p30);
+  EXPECT_EQ(4, client1.allocation_.cores + client2.allocation_.cores +
+                   allocation.cores);
+  budget.RemoveClient(&client1);
+  budget.RemoveClient(&client2);
+  budget.RemoveClient(&client3);
+}
+
+TEST(EncoderCpuBudgetTest, EveryClientKeepsOneCore) {
+  EncoderCpuBudget budget(2);
+  FakeClient clients[4];
+  for (FakeClient& client : clients)
+    budget.SetDemand(&client, k360p30);
+  EXPECT_EQ(1, clients[0].allocation_.cores);
+  EXPECT_EQ(1, budget.SetDemand(&clients[3], k360p30).cores);
+  for (FakeClient& client : clients)
+    budget.RemoveClient(&client);
+}
+
+TEST(EncoderCpuBudgetTest, ReducesComplexityWhenOversubscribed) {
+  EncoderCpuBudget budget(4);
+  FakeClient client1;
+  FakeClient client2;
+  EXPECT_FALSE(budget.SetDemand(&client1, k1080p30).reduced_complexity);
+  EXPECT_TRUE(budget.SetDemand(&client2, k1080p30).reduced_complexity);
+  EXPECT_TRUE(client1.allocation_.reduced_complexity);
+
+  budget.RemoveClient(&client2);
+  EXPECT_FALSE(client1.allocation_.reduced_complexity);
+  EXPECT_EQ(4, client1.allocation_.cores);
+  budget.RemoveClient(&client1);
+}
+
+TEST(EncoderCpuBudgetTest, RebalancesWhenDemandChanges) {
+  EncoderCpuBudget budget(4);
+  FakeClient client1;
+  FakeClient client2;
+  budget.SetDemand(&client1, k360p30);
+  budget.SetDemand(&client2, k360p30);
+  EXPECT_EQ(2, client1.allocation_.cores);
+
+  EXPECT_EQ(1, budget.SetDemand(&client2, k360p30 / 9).cores);
+  EXPECT_EQ(3, client1.allocation_.cores);
+  budget.RemoveClient(&client1);
+  budget.RemoveClient(&client2);
+}
+
+TEST(EncoderCpuBudgetTest, NotifiesOnlyClientsWhoseAllocationChanged) {
+  EncoderCpuBudget budget(4);
+  FakeClient client1;
+  FakeClient client2;
+  budget.SetDemand(&client1, k360p30);
+  budget.SetDemand(&client2, k360p30);
+  EXPECT_EQ(1, client1.num_changes_);
+  EXPECT_EQ(0, client2.num_changes_);
+
+  // The same demand again does not change anything.
+  budget.SetDemand(&client2, k360p30);
+  EXPECT_EQ(1, client1.num_changes_);
+  EXPECT_EQ(0, client2.num_changes_);
+
+  budget.RemoveClient(&client2);
+  EXPECT_EQ(2, client1.num_changes_);
+  EXPECT_EQ(4, client1.allocation_.cores);
+  EXPECT_EQ(0, client2.num_changes_);
+  budget.RemoveClient(&client1);
+}
+
+TEST(EncoderCpuBudgetTest, RemoveUnknownClientHasNoEffect) {
+  EncoderCpuBudget budget(4);
+  FakeClient client1;
+  FakeClient client2;
+  budget.SetDemand(&client1, k360p30);
+  budget.RemoveClient(&client2);
+  EXPECT_EQ(0, client1.num_changes_);
+  budget.RemoveClient(&client1);
+}
+
+}  // namespace webrtc
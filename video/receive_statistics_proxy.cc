@@ -878,6 +878,10 @@ void ReceiveStatisticsProxy::DecoderThreadStopped() {
   decode_thread_.DetachFromThread();
 }
 
+void ReceiveStatisticsProxy::DecoderThreadChanged() {
+  decode_thread_.DetachFromThread();
+}
+
 ReceiveStatisticsProxy::ContentSpecificStats::ContentSpecificStats()
     : interframe_delay_percentiles(kMaxCommonInterframeDelayMs) {}
 
@@ -107,6 +107,8 @@ class ReceiveStatisticsProxy : public VCMReceiveStatisticsCallback,
   // threading assumptions. These are called by VideoReceiveStream.
   void DecoderThreadStarting();
   void DecoderThreadStopped();
+  // Called on the decode thread when decoding has moved to another thread.
+  void DecoderThreadChanged();
 
  private:
   struct QpCounters {
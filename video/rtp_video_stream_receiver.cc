@@ -113,7 +113,9 @@ RtpVideoStreamReceiver::RtpVideoStreamReceiver(
                                     packet_router)),
       complete_frame_callback_(complete_frame_callback),
       keyframe_request_sender_(keyframe_request_sender),
-      has_received_frame_(false) {
+      has_received_frame_(false),
+      reference_received_payloads_(
+          field_trial::IsEnabled("WebRTC-Video-ReferenceReceivedPayloads")) {
   constexpr bool remb_candidate = true;
   packet_router_->AddReceiveRtpModule(rtp_rtcp_.get(), remb_candidate);
   rtp_receive_statistics_->RegisterRtpStatisticsCallback(receive_stats_proxy);
@@ -201,18 +203,32 @@ int32_t RtpVideoStreamReceiver::OnReceivedPayloadData(
     const uint8_t* payload_data,
     size_t payload_size,
     const WebRtcRTPHeader* rtp_header) {
-  WebRtcRTPHeader rtp_header_with_ntp = *rtp_header;
+  return InsertPayload(payload_data, payload_size, *rtp_header,
+                       rtc::CopyOnWriteBuffer());
+}
+
+int32_t RtpVideoStreamReceiver::InsertPayload(
+    const uint8_t* payload_data,
+    size_t payload_size,
+    const WebRtcRTPHeader& rtp_header,
+    const rtc::CopyOnWriteBuffer& received_buffer) {
+  WebRtcRTPHeader rtp_header_with_ntp = rtp_header;
   rtp_header_with_ntp.ntp_time_ms =
-      ntp_estimator_.Estimate(rtp_header->header.timestamp);
+      ntp_estimator_.Estimate(rtp_header.header.timestamp);
 
   VCMPacket packet(payload_data, payload_size, rtp_header_with_ntp);
+  if (received_buffer.size() > 0 && payload_data >= received_buffer.cdata() &&
+      payload_data + payload_size <=
+          received_buffer.cdata() + received_buffer.size()) {
+    packet.payload_buffer = received_buffer;
+  }
   if (nack_module_) {
     const bool is_keyframe =
-        rtp_header->video_header().is_first_packet_in_frame &&
-        rtp_header->frameType == kVideoFrameKey;
+        rtp_header.video_header().is_first_packet_in_frame &&
+        rtp_header.frameType == kVideoFrameKey;
 
     packet.timesNacked = nack_module_->OnReceivedPacket(
-        rtp_header->header.sequenceNumber, is_keyframe);
+        rtp_header.header.sequenceNumber, is_keyframe);
   } else {
     packet.timesNacked = -1;
   }
@@ -242,7 +258,7 @@ int32_t RtpVideoStreamReceiver::OnReceivedPayloadData(
         break;
     }
 
-  } else {
+  } else if (packet.payload_buffer.size() == 0) {
     uint8_t* data = new uint8_t[packet.sizeBytes];
     memcpy(data, packet.dataPtr, packet.sizeBytes);
     packet.dataPtr = data;
@@ -502,8 +518,12 @@ void RtpVideoStreamReceiver::ReceivePacket(const RtpPacketReceived& packet) {
     }
   }
 
-  OnReceivedPayloadData(parsed_payload.payload, parsed_payload.payload_length,
-                        &webrtc_rtp_header);
+  // The depacketizer points into the received packet, which can then be
+  // referenced until its frame has been assembled instead of being copied.
+  InsertPayload(parsed_payload.payload, parsed_payload.payload_length,
+                webrtc_rtp_header,
+                reference_received_payloads_ ? packet.Buffer()
+                                             : rtc::CopyOnWriteBuffer());
 }
 
 void RtpVideoStreamReceiver::ParseAndHandleEncapsulatingHeader(
@@ -34,6 +34,7 @@
 #include "modules/video_coding/packet_buffer.h"
 #include "modules/video_coding/rtp_frame_reference_finder.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/copyonwritebuffer.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/numerics/sequence_number_util.h"
 #include "rtc_base/sequenced_task_checker.h"
@@ -143,6 +144,12 @@ class RtpVideoStreamReceiver : public RtpData,
   void ParseAndHandleEncapsulatingHeader(const uint8_t* packet,
                                          size_t packet_length,
                                          const RTPHeader& header);
+  // Inserts a depacketized payload into the packet buffer. The payload is
+  // referenced rather than copied if it lies within |received_buffer|.
+  int32_t InsertPayload(const uint8_t* payload_data,
+                        size_t payload_size,
+                        const WebRtcRTPHeader& rtp_header,
+                        const rtc::CopyOnWriteBuffer& received_buffer);
   void NotifyReceiverOfEmptyPacket(uint16_t seq_num);
   void UpdateHistograms();
   bool IsRedEnabled() const;
@@ -190,6 +197,10 @@ class RtpVideoStreamReceiver : public RtpData,
 
   bool has_received_frame_;
 
+  // If payloads are kept in the buffers they were received in until their
+  // frame has been assembled, rather than copied on arrival.
+  const bool reference_received_payloads_;
+
   std::vector<RtpPacketSinkInterface*> secondary_sinks_
       RTC_GUARDED_BY(worker_task_checker_);
 };
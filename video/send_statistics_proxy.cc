@@ -681,6 +681,13 @@ void SendStatisticsProxy::OnEncodedFrameTimeMeasured(int encode_time_ms,
   stats_.encode_usage_percent = encode_usage_percent;
 }
 
+void SendStatisticsProxy::OnEncoderCpuBudgetChanged(int cores,
+                                                    bool reduced_complexity) {
+  rtc::CritScope lock(&crit_);
+  stats_.encoder_cpu_budget_cores = cores;
+  stats_.encoder_cpu_budget_reduced_complexity = reduced_complexity;
+}
+
 void SendStatisticsProxy::OnSuspendChange(bool is_suspended) {
   int64_t now_ms = clock_->TimeInMilliseconds();
   rtc::CritScope lock(&crit_);
@@ -68,6 +68,7 @@ class SendStatisticsProxy : public VideoStreamEncoderObserver,
   void OnInitialQualityResolutionAdaptDown() override;
 
   void OnSuspendChange(bool is_suspended) override;
+  void OnEncoderCpuBudgetChanged(int cores, bool reduced_complexity) override;
   void OnInactiveSsrc(uint32_t ssrc);
 
   // Used to indicate change in content type, which may require a change in
@@ -317,6 +317,14 @@ TEST_F(SendStatisticsProxyTest, OnEncodedFrameTimeMeasured) {
   EXPECT_EQ(encode_usage_percent, stats.encode_usage_percent);
 }
 
+TEST_F(SendStatisticsProxyTest, OnEncoderCpuBudgetChanged) {
+  statistics_proxy_->OnEncoderCpuBudgetChanged(2, true);
+
+  VideoSendStream::Stats stats = statistics_proxy_->GetStats();
+  EXPECT_EQ(2, stats.encoder_cpu_budget_cores);
+  EXPECT_TRUE(stats.encoder_cpu_budget_reduced_complexity);
+}
+
 TEST_F(SendStatisticsProxyTest, OnSendEncodedImageIncreasesFramesEncoded) {
   EncodedImage encoded_image;
   CodecSpecificInfo codec_info;
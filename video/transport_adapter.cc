@@ -31,6 +31,15 @@ bool TransportAdapter::SendRtp(const uint8_t* packet,
   return transport_->SendRtp(packet, length, options);
 }
 
+bool TransportAdapter::SendRtpFragments(
+    rtc::ArrayView<const rtc::ArrayView<const uint8_t>> fragments,
+    const PacketOptions& options) {
+  if (!enabled_.load())
+    return false;
+
+  return transport_->SendRtpFragments(fragments, options);
+}
+
 bool TransportAdapter::SendRtcp(const uint8_t* packet, size_t length) {
   if (!enabled_.load())
     return false;
@@ -26,6 +26,9 @@ class TransportAdapter : public Transport {
   bool SendRtp(const uint8_t* packet,
                size_t length,
                const PacketOptions& options) override;
+  bool SendRtpFragments(
+      rtc::ArrayView<const rtc::ArrayView<const uint8_t>> fragments,
+      const PacketOptions& options) override;
   bool SendRtcp(const uint8_t* packet, size_t length) override;
 
   void Enable();
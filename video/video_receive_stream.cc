@@ -12,6 +12,7 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <utility>
@@ -43,6 +44,9 @@
 namespace webrtc {
 
 namespace {
+constexpr int kMaxWaitForFrameMs = 3000;
+constexpr int kMaxWaitForKeyFrameMs = 200;
+
 VideoCodec CreateDecoderVideoCodec(const VideoReceiveStream::Decoder& decoder) {
   VideoCodec codec;
   memset(&codec, 0, sizeof(codec));
@@ -85,7 +89,8 @@ VideoReceiveStream::VideoReceiveStream(
     PacketRouter* packet_router,
     VideoReceiveStream::Config config,
     ProcessThread* process_thread,
-    CallStats* call_stats)
+    CallStats* call_stats,
+    DecodeScheduler* decode_scheduler)
     : transport_adapter_(config.rtcp_send_transport),
       config_(std::move(config)),
       num_cpu_cores_(num_cpu_cores),
@@ -95,6 +100,7 @@ VideoReceiveStream::VideoReceiveStream(
                      this,
                      "DecodingThread",
                      rtc::kHighestPriority),
+      decode_scheduler_(decode_scheduler),
       call_stats_(call_stats),
       rtp_receive_statistics_(ReceiveStatistics::Create(clock_)),
       timing_(new VCMTiming(clock_)),
@@ -176,7 +182,7 @@ void VideoReceiveStream::SetSync(Syncable* audio_syncable) {
 
 void VideoReceiveStream::Start() {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&worker_sequence_checker_);
-  if (decode_thread_.IsRunning())
+  if (decode_thread_.IsRunning() || scheduled_)
     return;
 
   bool protected_by_fec = config_.rtp.protected_by_flexfec ||
@@ -227,7 +233,13 @@ void VideoReceiveStream::Start() {
   // Start the decode thread
   video_receiver_.DecoderThreadStarting();
   stats_proxy_.DecoderThreadStarting();
-  decode_thread_.Start();
+  if (decode_scheduler_) {
+    frame_deadline_ms_ = clock_->TimeInMilliseconds() + MaxWaitForFrameMs();
+    decode_scheduler_->AddStream(this);
+    scheduled_ = true;
+  } else {
+    decode_thread_.Start();
+  }
   rtp_video_stream_receiver_.StartReceive();
 }
 
@@ -242,13 +254,18 @@ void VideoReceiveStream::Stop() {
   call_stats_->DeregisterStatsObserver(this);
   process_thread_->DeRegisterModule(&video_receiver_);
 
-  if (decode_thread_.IsRunning()) {
+  if (decode_thread_.IsRunning() || scheduled_) {
     // TriggerDecoderShutdown will release any waiting decoder thread and make
     // it stop immediately, instead of waiting for a timeout. Needs to be called
     // before joining the decoder thread.
     video_receiver_.TriggerDecoderShutdown();
 
-    decode_thread_.Stop();
+    if (scheduled_) {
+      decode_scheduler_->RemoveStream(this);
+      scheduled_ = false;
+    } else {
+      decode_thread_.Stop();
+    }
     video_receiver_.DecoderThreadStopped();
     stats_proxy_.DecoderThreadStopped();
     // Deregister external decoders so they are no longer running during
@@ -352,8 +369,11 @@ void VideoReceiveStream::OnCompleteFrame(
   frame->id.spatial_layer = 0;
 
   int64_t last_continuous_pid = frame_buffer_->InsertFrame(std::move(frame));
-  if (last_continuous_pid != -1)
+  if (last_continuous_pid != -1) {
     rtp_video_stream_receiver_.FrameContinuous(last_continuous_pid);
+    if (decode_scheduler_)
+      decode_scheduler_->Wake(this);
+  }
 }
 
 void VideoReceiveStream::OnRttUpdate(int64_t avg_rtt_ms, int64_t max_rtt_ms) {
@@ -397,10 +417,7 @@ void VideoReceiveStream::DecodeThreadFunction(void* ptr) {
 
 bool VideoReceiveStream::Decode() {
   TRACE_EVENT0("webrtc", "VideoReceiveStream::Decode");
-  static const int kMaxWaitForFrameMs = 3000;
-  static const int kMaxWaitForKeyFrameMs = 200;
-
-  int wait_ms = keyframe_required_ ? kMaxWaitForKeyFrameMs : kMaxWaitForFrameMs;
+  int wait_ms = MaxWaitForFrameMs();
   std::unique_ptr<video_coding::EncodedFrame> frame;
   // TODO(philipel): Call NextFrame with |keyframe_required| argument when
   //                 downstream project has been fixed.
@@ -412,52 +429,107 @@ bool VideoReceiveStream::Decode() {
   }
 
   if (frame) {
-    int64_t now_ms = clock_->TimeInMilliseconds();
     RTC_DCHECK_EQ(res, video_coding::FrameBuffer::ReturnReason::kFrameFound);
-    int decode_result = video_receiver_.Decode(frame.get());
-    if (decode_result == WEBRTC_VIDEO_CODEC_OK ||
-        decode_result == WEBRTC_VIDEO_CODEC_OK_REQUEST_KEYFRAME) {
-      keyframe_required_ = false;
-      frame_decoded_ = true;
-      rtp_video_stream_receiver_.FrameDecoded(frame->id.picture_id);
-
-      if (decode_result == WEBRTC_VIDEO_CODEC_OK_REQUEST_KEYFRAME)
-        RequestKeyFrame();
-    } else if (!frame_decoded_ || !keyframe_required_ ||
-               (last_keyframe_request_ms_ + kMaxWaitForKeyFrameMs < now_ms)) {
-      keyframe_required_ = true;
-      // TODO(philipel): Remove this keyframe request when downstream project
-      //                 has been fixed.
-      RequestKeyFrame();
-      last_keyframe_request_ms_ = now_ms;
-    }
+    HandleEncodedFrame(std::move(frame));
   } else {
     RTC_DCHECK_EQ(res, video_coding::FrameBuffer::ReturnReason::kTimeout);
-    int64_t now_ms = clock_->TimeInMilliseconds();
-    absl::optional<int64_t> last_packet_ms =
-        rtp_video_stream_receiver_.LastReceivedPacketMs();
-    absl::optional<int64_t> last_keyframe_packet_ms =
-        rtp_video_stream_receiver_.LastReceivedKeyframePacketMs();
-
-    // To avoid spamming keyframe requests for a stream that is not active we
-    // check if we have received a packet within the last 5 seconds.
-    bool stream_is_active = last_packet_ms && now_ms - *last_packet_ms < 5000;
-    if (!stream_is_active)
-      stats_proxy_.OnStreamInactive();
-
-    // If we recently have been receiving packets belonging to a keyframe then
-    // we assume a keyframe is currently being received.
-    bool receiving_keyframe =
-        last_keyframe_packet_ms &&
-        now_ms - *last_keyframe_packet_ms < kMaxWaitForKeyFrameMs;
-
-    if (stream_is_active && !receiving_keyframe) {
-      RTC_LOG(LS_WARNING) << "No decodable frame in " << wait_ms
-                          << " ms, requesting keyframe.";
-      RequestKeyFrame();
-    }
+    HandleFrameBufferTimeout(wait_ms);
   }
   return true;
 }
+
+int64_t VideoReceiveStream::DecodeNextFrame() {
+  TRACE_EVENT0("webrtc", "VideoReceiveStream::DecodeNextFrame");
+  // The scheduler may run the stream on any of its threads, but never on more
+  // than one at a time.
+  const rtc::PlatformThreadRef current_thread = rtc::CurrentThreadRef();
+  if (!rtc::IsThreadRefEqual(current_thread, last_decode_thread_)) {
+    video_receiver_.DecoderThreadChanged();
+    stats_proxy_.DecoderThreadChanged();
+    last_decode_thread_ = current_thread;
+  }
+
+  std::unique_ptr<video_coding::EncodedFrame> frame;
+  int64_t frame_wait_ms = -1;
+  video_coding::FrameBuffer::ReturnReason res =
+      frame_buffer_->TryNextFrame(&frame, &frame_wait_ms);
+
+  if (res == video_coding::FrameBuffer::ReturnReason::kStopped) {
+    // Stop() removes the stream from the scheduler.
+    return kMaxWaitForFrameMs;
+  }
+
+  if (frame) {
+    RTC_DCHECK_EQ(res, video_coding::FrameBuffer::ReturnReason::kFrameFound);
+    HandleEncodedFrame(std::move(frame));
+    frame_deadline_ms_ = clock_->TimeInMilliseconds() + MaxWaitForFrameMs();
+    // Another frame may already be due.
+    return 0;
+  }
+
+  RTC_DCHECK_EQ(res, video_coding::FrameBuffer::ReturnReason::kTimeout);
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  if (now_ms >= frame_deadline_ms_) {
+    const int wait_ms = MaxWaitForFrameMs();
+    HandleFrameBufferTimeout(wait_ms);
+    frame_deadline_ms_ = now_ms + wait_ms;
+  }
+  int64_t delay_ms = frame_deadline_ms_ - now_ms;
+  if (frame_wait_ms >= 0)
+    delay_ms = std::min(delay_ms, frame_wait_ms);
+  return delay_ms;
+}
+
+void VideoReceiveStream::HandleEncodedFrame(
+    std::unique_ptr<video_coding::EncodedFrame> frame) {
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  int decode_result = video_receiver_.Decode(frame.get());
+  if (decode_result == WEBRTC_VIDEO_CODEC_OK ||
+      decode_result == WEBRTC_VIDEO_CODEC_OK_REQUEST_KEYFRAME) {
+    keyframe_required_ = false;
+    frame_decoded_ = true;
+    rtp_video_stream_receiver_.FrameDecoded(frame->id.picture_id);
+
+    if (decode_result == WEBRTC_VIDEO_CODEC_OK_REQUEST_KEYFRAME)
+      RequestKeyFrame();
+  } else if (!frame_decoded_ || !keyframe_required_ ||
+             (last_keyframe_request_ms_ + kMaxWaitForKeyFrameMs < now_ms)) {
+    keyframe_required_ = true;
+    // TODO(philipel): Remove this keyframe request when downstream project
+    //                 has been fixed.
+    RequestKeyFrame();
+    last_keyframe_request_ms_ = now_ms;
+  }
+}
+
+void VideoReceiveStream::HandleFrameBufferTimeout(int wait_ms) {
+  int64_t now_ms = clock_->TimeInMilliseconds();
+  absl::optional<int64_t> last_packet_ms =
+      rtp_video_stream_receiver_.LastReceivedPacketMs();
+  absl::optional<int64_t> last_keyframe_packet_ms =
+      rtp_video_stream_receiver_.LastReceivedKeyframePacketMs();
+
+  // To avoid spamming keyframe requests for a stream that is not active we
+  // check if we have received a packet within the last 5 seconds.
+  bool stream_is_active = last_packet_ms && now_ms - *last_packet_ms < 5000;
+  if (!stream_is_active)
+    stats_proxy_.OnStreamInactive();
+
+  // If we recently have been receiving packets belonging to a keyframe then
+  // we assume a keyframe is currently being received.
+  bool receiving_keyframe =
+      last_keyframe_packet_ms &&
+      now_ms - *last_keyframe_packet_ms < kMaxWaitForKeyFrameMs;
+
+  if (stream_is_active && !receiving_keyframe) {
+    RTC_LOG(LS_WARNING) << "No decodable frame in " << wait_ms
+                        << " ms, requesting keyframe.";
+    RequestKeyFrame();
+  }
+}
+
+int VideoReceiveStream::MaxWaitForFrameMs() const {
+  return keyframe_required_ ? kMaxWaitForKeyFrameMs : kMaxWaitForFrameMs;
+}
 }  // namespace internal
 }  // namespace webrtc
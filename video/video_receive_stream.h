@@ -23,6 +23,7 @@
 #include "modules/video_coding/video_coding_impl.h"
 #include "rtc_base/sequenced_task_checker.h"
 #include "system_wrappers/include/clock.h"
+#include "video/decode_scheduler.h"
 #include "video/receive_statistics_proxy.h"
 #include "video/rtp_streams_synchronizer.h"
 #include "video/rtp_video_stream_receiver.h"
@@ -50,14 +51,17 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
                            public KeyFrameRequestSender,
                            public video_coding::OnCompleteFrameCallback,
                            public Syncable,
-                           public CallStatsObserver {
+                           public CallStatsObserver,
+                           public DecodeScheduler::Stream {
  public:
+  // If |decode_scheduler| is null the stream decodes on a thread of its own.
   VideoReceiveStream(RtpStreamReceiverControllerInterface* receiver_controller,
                      int num_cpu_cores,
                      PacketRouter* packet_router,
                      VideoReceiveStream::Config config,
                      ProcessThread* process_thread,
-                     CallStats* call_stats);
+                     CallStats* call_stats,
+                     DecodeScheduler* decode_scheduler);
   ~VideoReceiveStream() override;
 
   const Config& config() const { return config_; }
@@ -112,9 +116,15 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
   uint32_t GetPlayoutTimestamp() const override;
   void SetMinimumPlayoutDelay(int delay_ms) override;
 
+  // Implements DecodeScheduler::Stream.
+  int64_t DecodeNextFrame() override;
+
  private:
   static void DecodeThreadFunction(void* ptr);
   bool Decode();
+  void HandleEncodedFrame(std::unique_ptr<video_coding::EncodedFrame> frame);
+  void HandleFrameBufferTimeout(int wait_ms);
+  int MaxWaitForFrameMs() const;
 
   rtc::SequencedTaskChecker worker_sequence_checker_;
   rtc::SequencedTaskChecker module_process_sequence_checker_;
@@ -126,6 +136,9 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
   Clock* const clock_;
 
   rtc::PlatformThread decode_thread_;
+  DecodeScheduler* const decode_scheduler_;
+  // Set while the stream is decoding on |decode_scheduler_|.
+  bool scheduled_ = false;
 
   CallStats* const call_stats_;
 
@@ -160,6 +173,11 @@ class VideoReceiveStream : public webrtc::VideoReceiveStream,
   bool frame_decoded_ = false;
 
   int64_t last_keyframe_request_ms_ = 0;
+
+  // When decoding on |decode_scheduler_|, the time at which to give up
+  // waiting for a decodable frame, and the thread that decoded last.
+  int64_t frame_deadline_ms_ = 0;
+  rtc::PlatformThreadRef last_decode_thread_ = {};
 };
 }  // namespace internal
 }  // namespace webrtc
@@ -87,7 +87,7 @@ class VideoReceiveStreamTest : public testing::Test {
 
     video_receive_stream_.reset(new webrtc::internal::VideoReceiveStream(
         &rtp_stream_receiver_controller_, kDefaultNumCpuCores, &packet_router_,
-        config_.Copy(), process_thread_.get(), &call_stats_));
+        config_.Copy(), process_thread_.get(), &call_stats_, nullptr));
   }
 
  protected:
@@ -16,6 +16,7 @@
 #include <utility>
 
 #include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
 #include "common_video/include/video_frame.h"
 #include "modules/video_coding/include/video_codec_initializer.h"
 #include "modules/video_coding/include/video_coding.h"
@@ -51,6 +52,12 @@ const int kMaxInitialFramedrop = 4;
 // enable DropFrameDueToSize logic.
 const float kFramedropThreshold = 0.3;
 
+// Re-initializing the encoder produces a key frame, so a new allocation from
+// the CPU budget is applied at the next requested key frame, or at most this
+// often. Otherwise every rebalancing would cause a key frame from all
+// encoders at once.
+const int64_t kMinCpuBudgetReconfigurationIntervalMs = 20000;
+
 // Initial limits for BALANCED degradation preference.
 int MinFps(int pixels) {
   if (pixels <= 320 * 240) {
@@ -346,9 +353,11 @@ VideoStreamEncoder::VideoStreamEncoder(
     VideoStreamEncoderObserver* encoder_stats_observer,
     const VideoStreamEncoderSettings& settings,
     rtc::VideoSinkInterface<VideoFrame>* pre_encode_callback,
-    std::unique_ptr<OveruseFrameDetector> overuse_detector)
+    std::unique_ptr<OveruseFrameDetector> overuse_detector,
+    EncoderCpuBudget* cpu_budget)
     : shutdown_event_(true /* manual_reset */, false),
       number_of_cores_(number_of_cores),
+      cpu_budget_(cpu_budget),
       initial_framedrop_(0),
       initial_framedrop_on_bwe_enabled_(
           webrtc::field_trial::IsEnabled(kInitialFramedropFieldTrial)),
@@ -393,6 +402,12 @@ void VideoStreamEncoder::Stop() {
   source_proxy_->SetSource(nullptr, DegradationPreference());
   encoder_queue_.PostTask([this] {
     RTC_DCHECK_RUN_ON(&encoder_queue_);
+    // Removed on the encoder queue, so that a reconfiguration that is still
+    // queued can not add the encoder to the budget again.
+    if (cpu_budget_) {
+      cpu_budget_->RemoveClient(this);
+      cpu_budget_ = nullptr;
+    }
     overuse_detector_->StopCheckForOveruse();
     rate_allocator_.reset();
     bitrate_observer_ = nullptr;
@@ -595,10 +610,35 @@ void VideoStreamEncoder::ReconfigureEncoder() {
     video_sender_.RegisterExternalEncoder(encoder_.get(),
                                           info.has_internal_source);
   }
+  int number_of_cores = number_of_cores_;
+  if (cpu_budget_) {
+    int64_t pixels_per_second = 0;
+    for (const auto& stream : streams) {
+      if (stream.active) {
+        pixels_per_second += static_cast<int64_t>(stream.width) *
+                             stream.height * stream.max_framerate;
+      }
+    }
+    const EncoderCpuBudget::Allocation allocation =
+        cpu_budget_->SetDemand(this, pixels_per_second);
+    cpu_budget_allocation_ = allocation;
+    pending_cpu_budget_allocation_.reset();
+    number_of_cores = allocation.cores;
+    if (allocation.reduced_complexity) {
+      if (codec.codecType == kVideoCodecVP8) {
+        codec.VP8()->complexity = VideoCodecComplexity::kComplexityLow;
+      } else if (codec.codecType == kVideoCodecVP9) {
+        codec.VP9()->complexity = VideoCodecComplexity::kComplexityLow;
+      }
+    }
+    encoder_stats_observer_->OnEncoderCpuBudgetChanged(
+        allocation.cores, allocation.reduced_complexity);
+  }
+
   // RegisterSendCodec implies an unconditional call to
   // encoder_->InitEncode().
   bool success = video_sender_.RegisterSendCodec(
-                     &codec, number_of_cores_,
+                     &codec, number_of_cores,
                      static_cast<uint32_t>(max_data_payload_length_)) == VCM_OK;
   if (!success) {
     RTC_LOG(LS_ERROR) << "Failed to configure encoder.";
@@ -611,6 +651,7 @@ void VideoStreamEncoder::ReconfigureEncoder() {
   encoder_stats_observer_->OnEncoderReconfigured(encoder_config_, streams);
 
   pending_encoder_reconfiguration_ = false;
+  last_encoder_reconfiguration_ms_ = clock_->TimeInMilliseconds();
 
   sink_->OnEncoderConfigurationChanged(
       std::move(streams), encoder_config_.min_transmit_bitrate_bps);
@@ -802,6 +843,11 @@ void VideoStreamEncoder::MaybeEncodeVideoFrame(const VideoFrame& video_frame,
   // from GetScalingSettings should enable or disable the frame drop.
 
   int64_t now_ms = clock_->TimeInMilliseconds();
+  if (pending_cpu_budget_allocation_ && !pending_encoder_reconfiguration_ &&
+      now_ms - last_encoder_reconfiguration_ms_ >=
+          kMinCpuBudgetReconfigurationIntervalMs) {
+    pending_encoder_reconfiguration_ = true;
+  }
   if (pending_encoder_reconfiguration_) {
     ReconfigureEncoder();
     last_parameters_update_ms_.emplace(now_ms);
@@ -864,17 +910,35 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
   if (crop_width_ > 0 || crop_height_ > 0) {
     int cropped_width = video_frame.width() - crop_width_;
     int cropped_height = video_frame.height() - crop_height_;
-    rtc::scoped_refptr<I420Buffer> cropped_buffer =
-        I420Buffer::Create(cropped_width, cropped_height);
+    rtc::scoped_refptr<VideoFrameBuffer> cropped_buffer;
     // TODO(ilnik): Remove scaling if cropping is too big, as it should never
     // happen after SinkWants signaled correctly from ReconfigureEncoder.
-    if (crop_width_ < 4 && crop_height_ < 4) {
-      cropped_buffer->CropAndScaleFrom(
-          *video_frame.video_frame_buffer()->ToI420(), crop_width_ / 2,
-          crop_height_ / 2, cropped_width, cropped_height);
+    if (video_frame.video_frame_buffer()->type() ==
+        VideoFrameBuffer::Type::kNV12) {
+      // Keep NV12 as is, the encoders can take it without a conversion.
+      rtc::scoped_refptr<NV12Buffer> nv12_buffer =
+          NV12Buffer::Create(cropped_width, cropped_height);
+      const NV12BufferInterface& src =
+          *video_frame.video_frame_buffer()->GetNV12();
+      if (crop_width_ < 4 && crop_height_ < 4) {
+        nv12_buffer->CropAndScaleFrom(src, crop_width_ / 2, crop_height_ / 2,
+                                      cropped_width, cropped_height);
+      } else {
+        nv12_buffer->ScaleFrom(src);
+      }
+      cropped_buffer = nv12_buffer;
     } else {
-      cropped_buffer->ScaleFrom(
-          *video_frame.video_frame_buffer()->ToI420().get());
+      rtc::scoped_refptr<I420Buffer> i420_buffer =
+          I420Buffer::Create(cropped_width, cropped_height);
+      if (crop_width_ < 4 && crop_height_ < 4) {
+        i420_buffer->CropAndScaleFrom(
+            *video_frame.video_frame_buffer()->ToI420(), crop_width_ / 2,
+            crop_height_ / 2, cropped_width, cropped_height);
+      } else {
+        i420_buffer->ScaleFrom(
+            *video_frame.video_frame_buffer()->ToI420().get());
+      }
+      cropped_buffer = i420_buffer;
     }
     out_frame =
         VideoFrame(cropped_buffer, video_frame.timestamp(),
@@ -897,6 +961,10 @@ void VideoStreamEncoder::SendKeyFrame() {
   }
   RTC_DCHECK_RUN_ON(&encoder_queue_);
   TRACE_EVENT0("webrtc", "OnKeyFrameRequest");
+  // A key frame is sent anyway, so this is a good time to re-initialize the
+  // encoder with its new allocation.
+  if (pending_cpu_budget_allocation_)
+    pending_encoder_reconfiguration_ = true;
   video_sender_.IntraFrameRequest(0);
 }
 
@@ -963,6 +1031,22 @@ void VideoStreamEncoder::OnDroppedFrame(DropReason reason) {
   }
 }
 
+void VideoStreamEncoder::OnCpuBudgetChanged(
+    const EncoderCpuBudget::Allocation& allocation) {
+  encoder_queue_.PostTask([this, allocation] {
+    RTC_DCHECK_RUN_ON(&encoder_queue_);
+    if (!encoder_)
+      return;
+    // Changes that cancel out before they are applied cause no
+    // re-initialization.
+    if (allocation == cpu_budget_allocation_) {
+      pending_cpu_budget_allocation_.reset();
+    } else {
+      pending_cpu_budget_allocation_ = allocation;
+    }
+  });
+}
+
 void VideoStreamEncoder::OnBitrateUpdated(uint32_t bitrate_bps,
                                           uint8_t fraction_lost,
                                           int64_t round_trip_time_ms) {
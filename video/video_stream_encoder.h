@@ -30,6 +30,7 @@
 #include "rtc_base/event.h"
 #include "rtc_base/sequenced_task_checker.h"
 #include "rtc_base/task_queue.h"
+#include "video/encoder_cpu_budget.h"
 #include "video/overuse_frame_detector.h"
 
 namespace webrtc {
@@ -42,8 +43,11 @@ namespace webrtc {
 //  Call SetSource.
 //  Call ConfigureEncoder with the codec settings.
 //  Call Stop() when done.
+// If |cpu_budget| is set, the encoder is initialized with the number of cores
+// it is allocated by the budget instead of |number_of_cores|.
 class VideoStreamEncoder : public VideoStreamEncoderInterface,
                            private EncodedImageCallback,
+                           private EncoderCpuBudget::Client,
                            // Protected only to provide access to tests.
                            protected AdaptationObserverInterface {
  public:
@@ -51,7 +55,8 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
                      VideoStreamEncoderObserver* encoder_stats_observer,
                      const VideoStreamEncoderSettings& settings,
                      rtc::VideoSinkInterface<VideoFrame>* pre_encode_callback,
-                     std::unique_ptr<OveruseFrameDetector> overuse_detector);
+                     std::unique_ptr<OveruseFrameDetector> overuse_detector,
+                     EncoderCpuBudget* cpu_budget);
   ~VideoStreamEncoder() override;
 
   void SetSource(rtc::VideoSourceInterface<VideoFrame>* source,
@@ -128,6 +133,10 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
 
   void OnDroppedFrame(EncodedImageCallback::DropReason reason) override;
 
+  // Implements EncoderCpuBudget::Client.
+  void OnCpuBudgetChanged(
+      const EncoderCpuBudget::Allocation& allocation) override;
+
   bool EncoderPaused() const;
   void TraceFrameDropStart();
   void TraceFrameDropEnd();
@@ -178,6 +187,14 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   rtc::Event shutdown_event_;
 
   const uint32_t number_of_cores_;
+  // Reset when the encoder is stopped.
+  EncoderCpuBudget* cpu_budget_ RTC_GUARDED_BY(&encoder_queue_);
+  // The allocation from |cpu_budget_| the encoder was configured with, and a
+  // different allocation that is waiting to be applied.
+  EncoderCpuBudget::Allocation cpu_budget_allocation_
+      RTC_GUARDED_BY(&encoder_queue_);
+  absl::optional<EncoderCpuBudget::Allocation> pending_cpu_budget_allocation_
+      RTC_GUARDED_BY(&encoder_queue_);
   // Counts how many frames we've dropped in the initial framedrop phase.
   int initial_framedrop_;
   const bool initial_framedrop_on_bwe_enabled_;
@@ -213,6 +230,8 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   // Set when ConfigureEncoder has been called in order to lazy reconfigure the
   // encoder on the next frame.
   bool pending_encoder_reconfiguration_ RTC_GUARDED_BY(&encoder_queue_);
+  int64_t last_encoder_reconfiguration_ms_ RTC_GUARDED_BY(&encoder_queue_) =
+      0;
   // Set when configuration must create a new encoder object, e.g.,
   // because of a codec change.
   bool pending_encoder_creation_ RTC_GUARDED_BY(&encoder_queue_);
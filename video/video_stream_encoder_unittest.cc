@@ -92,14 +92,16 @@ class CpuOveruseDetectorProxy : public OveruseFrameDetector {
 class VideoStreamEncoderUnderTest : public VideoStreamEncoder {
  public:
   VideoStreamEncoderUnderTest(SendStatisticsProxy* stats_proxy,
-                              const VideoStreamEncoderSettings& settings)
+                              const VideoStreamEncoderSettings& settings,
+                              EncoderCpuBudget* cpu_budget)
       : VideoStreamEncoder(1 /* number_of_cores */,
                            stats_proxy,
                            settings,
                            nullptr /* pre_encode_callback */,
                            std::unique_ptr<OveruseFrameDetector>(
                                overuse_detector_proxy_ =
-                                   new CpuOveruseDetectorProxy(stats_proxy))) {}
+                                   new CpuOveruseDetectorProxy(stats_proxy)),
+                           cpu_budget) {}
 
   void PostTaskAndWait(bool down, AdaptReason reason) {
     rtc::Event event(false, false);
@@ -310,7 +312,7 @@ class VideoStreamEncoderTest : public ::testing::Test {
     if (video_stream_encoder_)
       video_stream_encoder_->Stop();
     video_stream_encoder_.reset(new VideoStreamEncoderUnderTest(
-        stats_proxy_.get(), video_send_config_.encoder_settings));
+        stats_proxy_.get(), video_send_config_.encoder_settings, cpu_budget_));
     video_stream_encoder_->SetSink(&sink_, false /* rotation_applied */);
     video_stream_encoder_->SetSource(
         &video_source_, webrtc::DegradationPreference::MAINTAIN_FRAMERATE);
@@ -532,6 +534,16 @@ class VideoStreamEncoderTest : public ::testing::Test {
       force_init_encode_failed_ = force_failure;
     }
 
+    int number_of_cores() const {
+      rtc::CritScope lock(&local_crit_sect_);
+      return number_of_cores_;
+    }
+
+    int num_init_encodes() const {
+      rtc::CritScope lock(&local_crit_sect_);
+      return num_init_encodes_;
+    }
+
    private:
     int32_t Encode(const VideoFrame& input_image,
                    const CodecSpecificInfo* codec_specific_info,
@@ -563,6 +575,8 @@ class VideoStreamEncoderTest : public ::testing::Test {
       int res =
           FakeEncoder::InitEncode(config, number_of_cores, max_payload_size);
       rtc::CritScope lock(&local_crit_sect_);
+      number_of_cores_ = number_of_cores;
+      ++num_init_encodes_;
       if (config->codecType == kVideoCodecVP8) {
         // Simulate setting up temporal layers, in order to validate the life
         // cycle of these objects.
@@ -588,6 +602,8 @@ class VideoStreamEncoderTest : public ::testing::Test {
     std::vector<std::unique_ptr<TemporalLayers>> allocated_temporal_layers_
         RTC_GUARDED_BY(local_crit_sect_);
     bool force_init_encode_failed_ RTC_GUARDED_BY(local_crit_sect_) = false;
+    int number_of_cores_ RTC_GUARDED_BY(local_crit_sect_) = 0;
+    int num_init_encodes_ RTC_GUARDED_BY(local_crit_sect_) = 0;
   };
 
   class TestSink : public VideoStreamEncoder::EncoderSink {
@@ -695,6 +711,7 @@ class VideoStreamEncoderTest : public ::testing::Test {
   std::unique_ptr<MockableSendStatisticsProxy> stats_proxy_;
   TestSink sink_;
   AdaptingFrameForwarder video_source_;
+  EncoderCpuBudget* cpu_budget_ = nullptr;
   std::unique_ptr<VideoStreamEncoderUnderTest> video_stream_encoder_;
   rtc::ScopedFakeClock fake_clock_;
 };
@@ -708,6 +725,114 @@ TEST_F(VideoStreamEncoderTest, EncodeOneFrame) {
   video_stream_encoder_->Stop();
 }
 
+TEST_F(VideoStreamEncoderTest, InitializesEncoderWithCoresFromCpuBudget) {
+  class OtherEncoder : public EncoderCpuBudget::Client {
+    void OnCpuBudgetChanged(const EncoderCpuBudget::Allocation&) override {}
+  } other_encoder;
+  EncoderCpuBudget cpu_budget(4);
+  cpu_budget_ = &cpu_budget;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdated(kTargetBitrateBps, 0, 0);
+
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(1, codec_width_, codec_height_));
+  WaitForEncodedFrame(1);
+  EXPECT_EQ(4, fake_encoder_.number_of_cores());
+  EXPECT_EQ(4, stats_proxy_->GetStats().encoder_cpu_budget_cores);
+
+  // Another encoder with the same demand takes half of the cores. The encoder
+  // is re-initialized with the other half at the next key frame request.
+  cpu_budget.SetDemand(&other_encoder, static_cast<int64_t>(codec_width_) *
+                                           codec_height_ * max_framerate_);
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(2, codec_width_, codec_height_));
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(4, fake_encoder_.number_of_cores());
+
+  video_stream_encoder_->SendKeyFrame();
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(3, codec_width_, codec_height_));
+  WaitForEncodedFrame(3);
+  EXPECT_EQ(2, fake_encoder_.number_of_cores());
+  EXPECT_EQ(2, stats_proxy_->GetStats().encoder_cpu_budget_cores);
+  EXPECT_EQ(VideoCodecComplexity::kComplexityNormal,
+            fake_encoder_.codec_config().VP8()->complexity);
+
+  video_stream_encoder_->Stop();
+  cpu_budget.RemoveClient(&other_encoder);
+}
+
+TEST_F(VideoStreamEncoderTest, AppliesCpuBudgetChangesAtMostEvery20Seconds) {
+  class OtherEncoder : public EncoderCpuBudget::Client {
+    void OnCpuBudgetChanged(const EncoderCpuBudget::Allocation&) override {}
+  } other_encoder;
+  EncoderCpuBudget cpu_budget(4);
+  cpu_budget_ = &cpu_budget;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdated(kTargetBitrateBps, 0, 0);
+
+  int64_t timestamp_ms = 1;
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(timestamp_ms, codec_width_, codec_height_));
+  WaitForEncodedFrame(timestamp_ms);
+  EXPECT_EQ(4, fake_encoder_.number_of_cores());
+
+  const int64_t demand =
+      static_cast<int64_t>(codec_width_) * codec_height_ * max_framerate_;
+  cpu_budget.SetDemand(&other_encoder, demand);
+  fake_clock_.AdvanceTimeMicros(19 * rtc::kNumMicrosecsPerSec);
+  timestamp_ms += 19000;
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(timestamp_ms, codec_width_, codec_height_));
+  WaitForEncodedFrame(timestamp_ms);
+  EXPECT_EQ(4, fake_encoder_.number_of_cores());
+
+  fake_clock_.AdvanceTimeMicros(rtc::kNumMicrosecsPerSec);
+  timestamp_ms += 1000;
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(timestamp_ms, codec_width_, codec_height_));
+  WaitForEncodedFrame(timestamp_ms);
+  EXPECT_EQ(2, fake_encoder_.number_of_cores());
+
+  // A change that is undone before it is applied does not re-initialize the
+  // encoder.
+  const int num_inits = fake_encoder_.num_init_encodes();
+  cpu_budget.RemoveClient(&other_encoder);
+  cpu_budget.SetDemand(&other_encoder, demand);
+  fake_clock_.AdvanceTimeMicros(20 * rtc::kNumMicrosecsPerSec);
+  timestamp_ms += 20000;
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(timestamp_ms, codec_width_, codec_height_));
+  WaitForEncodedFrame(timestamp_ms);
+  EXPECT_EQ(num_inits, fake_encoder_.num_init_encodes());
+
+  video_stream_encoder_->Stop();
+  cpu_budget.RemoveClient(&other_encoder);
+}
+
+TEST_F(VideoStreamEncoderTest, ReducesComplexityWhenCpuBudgetIsExceeded) {
+  class OtherEncoder : public EncoderCpuBudget::Client {
+    void OnCpuBudgetChanged(const EncoderCpuBudget::Allocation&) override {}
+  } other_encoder;
+  EncoderCpuBudget cpu_budget(1);
+  cpu_budget.SetDemand(&other_encoder,
+                       EncoderCpuBudget::kPixelsPerSecondPerCore);
+  cpu_budget_ = &cpu_budget;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdated(kTargetBitrateBps, 0, 0);
+
+  video_source_.IncomingCapturedFrame(
+      CreateFrame(1, codec_width_, codec_height_));
+  WaitForEncodedFrame(1);
+  EXPECT_EQ(1, fake_encoder_.number_of_cores());
+  EXPECT_EQ(VideoCodecComplexity::kComplexityLow,
+            fake_encoder_.codec_config().VP8()->complexity);
+  EXPECT_TRUE(stats_proxy_->GetStats().encoder_cpu_budget_reduced_complexity);
+
+  video_stream_encoder_->Stop();
+  cpu_budget.RemoveClient(&other_encoder);
+}
+
 TEST_F(VideoStreamEncoderTest, DropsFramesBeforeFirstOnBitrateUpdated) {
   // Dropped since no target bitrate has been set.
   rtc::Event frame_destroyed_event(false, false);